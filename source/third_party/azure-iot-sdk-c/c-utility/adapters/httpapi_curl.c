@@ -6,6 +6,7 @@
 #include <string.h>
 #include <stddef.h>
 #include <ctype.h>
+#include <pthread.h>
 
 #include "azure_c_shared_utility/strings.h"
 #include "azure_c_shared_utility/httpapi.h"
@@ -51,27 +52,39 @@ typedef struct HTTP_RESPONSE_CONTENT_BUFFER_TAG
 } HTTP_RESPONSE_CONTENT_BUFFER;
 
 static size_t nUsersOfHTTPAPI = 0; /*used for reference counting (a weak one)*/
+/*HTTPAPIEX handles used from different threads (e.g. parallel blob uploads) init and deinit concurrently;
+statically initialized so that there is nothing to create before the first HTTPAPI_Init*/
+static pthread_mutex_t usersOfHTTPAPILock = PTHREAD_MUTEX_INITIALIZER;
 
 HTTPAPI_RESULT HTTPAPI_Init(void)
 {
     HTTPAPI_RESULT result;
-    if (nUsersOfHTTPAPI == 0)
+    if (pthread_mutex_lock(&usersOfHTTPAPILock) != 0)
     {
-        if (curl_global_init(CURL_GLOBAL_NOTHING) != 0)
+        result = HTTPAPI_INIT_FAILED;
+        LogError("unable to lock (result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+    }
+    else
+    {
+        if (nUsersOfHTTPAPI == 0)
         {
-            result = HTTPAPI_INIT_FAILED;
-            LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+            if (curl_global_init(CURL_GLOBAL_NOTHING) != 0)
+            {
+                result = HTTPAPI_INIT_FAILED;
+                LogError("(result = %s)", ENUM_TO_STRING(HTTPAPI_RESULT, result));
+            }
+            else
+            {
+                nUsersOfHTTPAPI++;
+                result = HTTPAPI_OK;
+            }
         }
         else
         {
             nUsersOfHTTPAPI++;
             result = HTTPAPI_OK;
         }
-    }
-    else
-    {
-        nUsersOfHTTPAPI++;
-        result = HTTPAPI_OK;
+        (void)pthread_mutex_unlock(&usersOfHTTPAPILock);
     }
 
     return result;
@@ -79,13 +92,21 @@ HTTPAPI_RESULT HTTPAPI_Init(void)
 
 void HTTPAPI_Deinit(void)
 {
-    if (nUsersOfHTTPAPI > 0)
+    if (pthread_mutex_lock(&usersOfHTTPAPILock) != 0)
     {
-        nUsersOfHTTPAPI--;
-        if (nUsersOfHTTPAPI == 0)
+        LogError("unable to lock");
+    }
+    else
+    {
+        if (nUsersOfHTTPAPI > 0)
         {
-            curl_global_cleanup();
+            nUsersOfHTTPAPI--;
+            if (nUsersOfHTTPAPI == 0)
+            {
+                curl_global_cleanup();
+            }
         }
+        (void)pthread_mutex_unlock(&usersOfHTTPAPILock);
     }
 }
 
@@ -0,0 +1,294 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/journal_storage_file.h"
+
+/* enough for any size_t in decimal */
+#define SEGMENT_SUFFIX_LENGTH 21
+
+typedef struct JOURNAL_STORAGE_FILE_INSTANCE_TAG
+{
+    char* name; /* the prefix followed by room for the segment number */
+    size_t prefix_length;
+    int write_fd;
+    int read_fd; /* the last segment read is kept open, replay reads it record by record */
+    size_t read_segment;
+} JOURNAL_STORAGE_FILE_INSTANCE;
+
+static const char* segment_name(JOURNAL_STORAGE_FILE_INSTANCE* instance, size_t segment)
+{
+    (void)sprintf(instance->name + instance->prefix_length, "%lu", (unsigned long)segment);
+    return instance->name;
+}
+
+static void close_read_fd(JOURNAL_STORAGE_FILE_INSTANCE* instance)
+{
+    if (instance->read_fd != -1)
+    {
+        (void)close(instance->read_fd);
+        instance->read_fd = -1;
+    }
+}
+
+CONCRETE_JOURNAL_STORAGE_HANDLE journal_storage_file_create(const void* parameters)
+{
+    JOURNAL_STORAGE_FILE_INSTANCE* result;
+    const char* prefix = (const char*)parameters;
+
+    if (prefix == NULL)
+    {
+        LogError("invalid argument: the segment name prefix is NULL");
+        result = NULL;
+    }
+    else if ((result = (JOURNAL_STORAGE_FILE_INSTANCE*)malloc(sizeof(JOURNAL_STORAGE_FILE_INSTANCE))) == NULL)
+    {
+        LogError("failure allocating JOURNAL_STORAGE_FILE_INSTANCE");
+    }
+    else
+    {
+        result->prefix_length = strlen(prefix);
+        if ((result->name = (char*)malloc(result->prefix_length + SEGMENT_SUFFIX_LENGTH)) == NULL)
+        {
+            LogError("failure allocating the segment name");
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            (void)memcpy(result->name, prefix, result->prefix_length);
+            result->write_fd = -1;
+            result->read_fd = -1;
+            result->read_segment = 0;
+        }
+    }
+
+    return result;
+}
+
+void journal_storage_file_destroy(CONCRETE_JOURNAL_STORAGE_HANDLE storage)
+{
+    if (storage != NULL)
+    {
+        JOURNAL_STORAGE_FILE_INSTANCE* instance = (JOURNAL_STORAGE_FILE_INSTANCE*)storage;
+        if (instance->write_fd != -1)
+        {
+            (void)close(instance->write_fd);
+        }
+        close_read_fd(instance);
+        free(instance->name);
+        free(instance);
+    }
+}
+
+int journal_storage_file_start_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t max_size)
+{
+    int result;
+    JOURNAL_STORAGE_FILE_INSTANCE* instance = (JOURNAL_STORAGE_FILE_INSTANCE*)storage;
+    (void)max_size;
+
+    if (instance == NULL)
+    {
+        LogError("invalid argument: storage is NULL");
+        result = __FAILURE__;
+    }
+    else if (instance->write_fd != -1)
+    {
+        LogError("a segment is already being written");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (instance->read_segment == segment)
+        {
+            close_read_fd(instance);
+        }
+
+        if ((instance->write_fd = open(segment_name(instance, segment), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0600)) == -1)
+        {
+            LogError("unable to create %s, errno=%d", instance->name, errno);
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int journal_storage_file_append(CONCRETE_JOURNAL_STORAGE_HANDLE storage, const unsigned char* bytes, size_t size)
+{
+    int result;
+    JOURNAL_STORAGE_FILE_INSTANCE* instance = (JOURNAL_STORAGE_FILE_INSTANCE*)storage;
+
+    if ((instance == NULL) || (bytes == NULL) || (instance->write_fd == -1))
+    {
+        LogError("invalid argument: storage=%p, bytes=%p or no segment is being written", storage, bytes);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+        while ((result == 0) && (size > 0))
+        {
+            ssize_t written = write(instance->write_fd, bytes, size);
+            if (written < 0)
+            {
+                if (errno != EINTR)
+                {
+                    LogError("write failed, errno=%d", errno);
+                    result = __FAILURE__;
+                }
+            }
+            else
+            {
+                bytes += written;
+                size -= (size_t)written;
+            }
+        }
+
+        if ((result == 0) && (fdatasync(instance->write_fd) != 0))
+        {
+            LogError("fdatasync failed, errno=%d", errno);
+            result = __FAILURE__;
+        }
+    }
+
+    return result;
+}
+
+int journal_storage_file_seal_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage)
+{
+    int result;
+    JOURNAL_STORAGE_FILE_INSTANCE* instance = (JOURNAL_STORAGE_FILE_INSTANCE*)storage;
+
+    if ((instance == NULL) || (instance->write_fd == -1))
+    {
+        LogError("invalid argument: storage=%p or no segment is being written", storage);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = (close(instance->write_fd) == 0) ? 0 : __FAILURE__;
+        instance->write_fd = -1;
+    }
+
+    return result;
+}
+
+int journal_storage_file_read(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t offset, unsigned char* buffer, size_t size, size_t* bytes_read)
+{
+    int result;
+    JOURNAL_STORAGE_FILE_INSTANCE* instance = (JOURNAL_STORAGE_FILE_INSTANCE*)storage;
+
+    if ((instance == NULL) || (buffer == NULL) || (bytes_read == NULL))
+    {
+        LogError("invalid argument: storage=%p, buffer=%p, bytes_read=%p", storage, buffer, bytes_read);
+        result = __FAILURE__;
+    }
+    else
+    {
+        *bytes_read = 0;
+        if ((instance->read_fd != -1) && (instance->read_segment != segment))
+        {
+            close_read_fd(instance);
+        }
+
+        if ((instance->read_fd == -1) &&
+            ((instance->read_fd = open(segment_name(instance, segment), O_RDONLY)) != -1))
+        {
+            instance->read_segment = segment;
+        }
+
+        if (instance->read_fd == -1)
+        {
+            /*a missing segment reads as empty*/
+            result = (errno == ENOENT) ? 0 : __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+            while ((result == 0) && (*bytes_read < size))
+            {
+                ssize_t got = pread(instance->read_fd, buffer + *bytes_read, size - *bytes_read, (off_t)(offset + *bytes_read));
+                if (got < 0)
+                {
+                    if (errno != EINTR)
+                    {
+                        LogError("pread failed, errno=%d", errno);
+                        result = __FAILURE__;
+                    }
+                }
+                else if (got == 0)
+                {
+                    break;
+                }
+                else
+                {
+                    *bytes_read += (size_t)got;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+int journal_storage_file_remove_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment)
+{
+    int result;
+    JOURNAL_STORAGE_FILE_INSTANCE* instance = (JOURNAL_STORAGE_FILE_INSTANCE*)storage;
+
+    if (instance == NULL)
+    {
+        LogError("invalid argument: storage is NULL");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (instance->read_segment == segment)
+        {
+            close_read_fd(instance);
+        }
+
+        if ((unlink(segment_name(instance, segment)) != 0) && (errno != ENOENT))
+        {
+            LogError("unable to remove %s, errno=%d", instance->name, errno);
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static const JOURNAL_STORAGE_INTERFACE_DESCRIPTION journal_storage_file_interface_description =
+{
+    journal_storage_file_create,
+    journal_storage_file_destroy,
+    journal_storage_file_start_segment,
+    journal_storage_file_append,
+    journal_storage_file_seal_segment,
+    journal_storage_file_read,
+    journal_storage_file_remove_segment
+};
+
+const JOURNAL_STORAGE_INTERFACE_DESCRIPTION* journal_storage_file_get_interface_description(void)
+{
+    return &journal_storage_file_interface_description;
+}
@@ -0,0 +1,301 @@
+// Copyright (c) Texas Instruments. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <ti/drivers/net/wifi/simplelink.h>
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/journal_storage_sl.h"
+
+/* enough for any size_t in decimal */
+#define SEGMENT_SUFFIX_LENGTH 21
+
+typedef struct JOURNAL_STORAGE_SL_INSTANCE_TAG
+{
+    char* name; /* the prefix followed by room for the segment number */
+    size_t prefix_length;
+    int32_t write_handle;
+    uint32_t write_offset;
+    int32_t read_handle; /* the last segment read is kept open, replay reads it record by record */
+    size_t read_segment;
+    uint32_t read_length; /* SimpleLink files are created at their maximum size, this is how much was written */
+} JOURNAL_STORAGE_SL_INSTANCE;
+
+static const unsigned char* segment_name(JOURNAL_STORAGE_SL_INSTANCE* instance, size_t segment)
+{
+    (void)sprintf(instance->name + instance->prefix_length, "%lu", (unsigned long)segment);
+    return (const unsigned char*)instance->name;
+}
+
+static void close_read_handle(JOURNAL_STORAGE_SL_INSTANCE* instance)
+{
+    if (instance->read_handle >= 0)
+    {
+        (void)sl_FsClose(instance->read_handle, NULL, NULL, 0);
+        instance->read_handle = -1;
+    }
+}
+
+CONCRETE_JOURNAL_STORAGE_HANDLE journal_storage_sl_create(const void* parameters)
+{
+    JOURNAL_STORAGE_SL_INSTANCE* result;
+    const char* prefix = (const char*)parameters;
+
+    if (prefix == NULL)
+    {
+        LogError("invalid argument: the segment name prefix is NULL");
+        result = NULL;
+    }
+    else if ((result = (JOURNAL_STORAGE_SL_INSTANCE*)malloc(sizeof(JOURNAL_STORAGE_SL_INSTANCE))) == NULL)
+    {
+        LogError("failure allocating JOURNAL_STORAGE_SL_INSTANCE");
+    }
+    else
+    {
+        result->prefix_length = strlen(prefix);
+        if ((result->name = (char*)malloc(result->prefix_length + SEGMENT_SUFFIX_LENGTH)) == NULL)
+        {
+            LogError("failure allocating the segment name");
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            (void)memcpy(result->name, prefix, result->prefix_length);
+            result->write_handle = -1;
+            result->write_offset = 0;
+            result->read_handle = -1;
+            result->read_segment = 0;
+            result->read_length = 0;
+        }
+    }
+
+    return result;
+}
+
+void journal_storage_sl_destroy(CONCRETE_JOURNAL_STORAGE_HANDLE storage)
+{
+    if (storage != NULL)
+    {
+        JOURNAL_STORAGE_SL_INSTANCE* instance = (JOURNAL_STORAGE_SL_INSTANCE*)storage;
+        if (instance->write_handle >= 0)
+        {
+            (void)sl_FsClose(instance->write_handle, NULL, NULL, 0);
+        }
+        close_read_handle(instance);
+        free(instance->name);
+        free(instance);
+    }
+}
+
+int journal_storage_sl_start_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t max_size)
+{
+    int result;
+    JOURNAL_STORAGE_SL_INSTANCE* instance = (JOURNAL_STORAGE_SL_INSTANCE*)storage;
+
+    if ((instance == NULL) || (max_size == 0))
+    {
+        LogError("invalid argument: storage=%p, max_size=%lu", storage, (unsigned long)max_size);
+        result = __FAILURE__;
+    }
+    else if (instance->write_handle >= 0)
+    {
+        LogError("a segment is already being written");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (instance->read_segment == segment)
+        {
+            close_read_handle(instance);
+        }
+
+        /*the whole segment is reserved up front, SimpleLink files cannot grow past the size they were created with*/
+        instance->write_handle = sl_FsOpen(segment_name(instance, segment),
+            SL_FS_CREATE | SL_FS_OVERWRITE | SL_FS_CREATE_NOSIGNATURE | SL_FS_CREATE_MAX_SIZE(max_size), NULL);
+        if (instance->write_handle < 0)
+        {
+            LogError("unable to create %s, error=%ld", instance->name, (long)instance->write_handle);
+            instance->write_handle = -1;
+            result = __FAILURE__;
+        }
+        else
+        {
+            instance->write_offset = 0;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int journal_storage_sl_append(CONCRETE_JOURNAL_STORAGE_HANDLE storage, const unsigned char* bytes, size_t size)
+{
+    int result;
+    JOURNAL_STORAGE_SL_INSTANCE* instance = (JOURNAL_STORAGE_SL_INSTANCE*)storage;
+
+    if ((instance == NULL) || (bytes == NULL) || (instance->write_handle < 0))
+    {
+        LogError("invalid argument: storage=%p, bytes=%p or no segment is being written", storage, bytes);
+        result = __FAILURE__;
+    }
+    else
+    {
+        int32_t written = sl_FsWrite(instance->write_handle, instance->write_offset, (unsigned char*)bytes, (uint32_t)size);
+        if ((written < 0) || ((size_t)written != size))
+        {
+            LogError("sl_FsWrite failed, result=%ld", (long)written);
+            result = __FAILURE__;
+        }
+        else
+        {
+            instance->write_offset += (uint32_t)written;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int journal_storage_sl_seal_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage)
+{
+    int result;
+    JOURNAL_STORAGE_SL_INSTANCE* instance = (JOURNAL_STORAGE_SL_INSTANCE*)storage;
+
+    if ((instance == NULL) || (instance->write_handle < 0))
+    {
+        LogError("invalid argument: storage=%p or no segment is being written", storage);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = (sl_FsClose(instance->write_handle, NULL, NULL, 0) < 0) ? __FAILURE__ : 0;
+        instance->write_handle = -1;
+    }
+
+    return result;
+}
+
+int journal_storage_sl_read(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t offset, unsigned char* buffer, size_t size, size_t* bytes_read)
+{
+    int result;
+    JOURNAL_STORAGE_SL_INSTANCE* instance = (JOURNAL_STORAGE_SL_INSTANCE*)storage;
+
+    if ((instance == NULL) || (buffer == NULL) || (bytes_read == NULL))
+    {
+        LogError("invalid argument: storage=%p, buffer=%p, bytes_read=%p", storage, buffer, bytes_read);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+        *bytes_read = 0;
+        if ((instance->read_handle >= 0) && (instance->read_segment != segment))
+        {
+            close_read_handle(instance);
+        }
+
+        if (instance->read_handle < 0)
+        {
+            SlFsFileInfo_t info;
+            int32_t info_result = sl_FsGetInfo(segment_name(instance, segment), 0, &info);
+            if (info_result == SL_ERROR_FS_FILE_NOT_EXISTS)
+            {
+                /*a missing segment reads as empty*/
+                result = 0;
+            }
+            else if (info_result < 0)
+            {
+                LogError("sl_FsGetInfo failed for %s, error=%ld", instance->name, (long)info_result);
+                result = __FAILURE__;
+            }
+            else if ((instance->read_handle = sl_FsOpen(segment_name(instance, segment), SL_FS_READ, NULL)) < 0)
+            {
+                LogError("unable to open %s, error=%ld", instance->name, (long)instance->read_handle);
+                instance->read_handle = -1;
+                result = __FAILURE__;
+            }
+            else
+            {
+                instance->read_segment = segment;
+                instance->read_length = info.Len;
+            }
+        }
+
+        if ((result == 0) && (instance->read_handle >= 0) && (offset < instance->read_length))
+        {
+            int32_t got;
+            if (size > instance->read_length - offset)
+            {
+                size = instance->read_length - offset;
+            }
+
+            if ((got = sl_FsRead(instance->read_handle, (uint32_t)offset, buffer, (uint32_t)size)) < 0)
+            {
+                LogError("sl_FsRead failed, error=%ld", (long)got);
+                result = __FAILURE__;
+            }
+            else
+            {
+                *bytes_read = (size_t)got;
+            }
+        }
+    }
+
+    return result;
+}
+
+int journal_storage_sl_remove_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment)
+{
+    int result;
+    JOURNAL_STORAGE_SL_INSTANCE* instance = (JOURNAL_STORAGE_SL_INSTANCE*)storage;
+
+    if (instance == NULL)
+    {
+        LogError("invalid argument: storage is NULL");
+        result = __FAILURE__;
+    }
+    else
+    {
+        int16_t del_result;
+        if (instance->read_segment == segment)
+        {
+            close_read_handle(instance);
+        }
+
+        del_result = sl_FsDel(segment_name(instance, segment), 0);
+        if ((del_result < 0) && (del_result != SL_ERROR_FS_FILE_NOT_EXISTS))
+        {
+            LogError("unable to remove %s, error=%d", instance->name, (int)del_result);
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static const JOURNAL_STORAGE_INTERFACE_DESCRIPTION journal_storage_sl_interface_description =
+{
+    journal_storage_sl_create,
+    journal_storage_sl_destroy,
+    journal_storage_sl_start_segment,
+    journal_storage_sl_append,
+    journal_storage_sl_seal_segment,
+    journal_storage_sl_read,
+    journal_storage_sl_remove_segment
+};
+
+const JOURNAL_STORAGE_INTERFACE_DESCRIPTION* journal_storage_sl_get_interface_description(void)
+{
+    return &journal_storage_sl_interface_description;
+}
@@ -4,6 +4,8 @@
 #include "azure_c_shared_utility/platform.h"
 #include "azure_c_shared_utility/xio.h"
 #include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/dns_cache.h"
+#include "azure_c_shared_utility/optimize_size.h"
 #ifdef USE_OPENSSL
 #include "azure_c_shared_utility/tlsio_openssl.h"
 #endif
@@ -26,6 +28,14 @@ int platform_init(void)
 #else
     result = 0;
 #endif
+    if ((result == 0) && (dns_cache_init() != 0))
+    {
+        LogError("Failed initializing the DNS cache");
+#ifdef USE_OPENSSL
+        tlsio_openssl_deinit();
+#endif
+        result = __FAILURE__;
+    }
     return result;
 }
 
@@ -62,6 +72,7 @@ STRING_HANDLE platform_get_platform_info(void)
 
 void platform_deinit(void)
 {
+    dns_cache_deinit();
 #ifdef USE_OPENSSL
     tlsio_openssl_deinit();
 #endif
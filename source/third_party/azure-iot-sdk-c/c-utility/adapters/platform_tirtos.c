@@ -3,10 +3,11 @@
 
 #include "azure_c_shared_utility/platform.h"
 #include "azure_c_shared_utility/tlsio_sl.h"
+#include "azure_c_shared_utility/dns_cache.h"
 
 int platform_init(void)
 {
-    return 0;
+    return dns_cache_init();
 }
 
 const IO_INTERFACE_DESCRIPTION* platform_get_default_tlsio(void)
@@ -21,5 +22,5 @@ STRING_HANDLE platform_get_platform_info(void)
 
 void platform_deinit(void)
 {
-    return;
+    dns_cache_deinit();
 }
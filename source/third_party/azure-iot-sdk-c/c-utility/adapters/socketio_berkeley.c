@@ -18,6 +18,7 @@
 #include <signal.h>
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
@@ -25,6 +26,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/select.h>
+#include <sys/uio.h>
 #ifdef TIZENRT
 #include <net/lwip/tcp.h>
 #else
@@ -34,8 +36,9 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
-#include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/dns_cache.h"
 #include "azure_c_shared_utility/gbnetwork.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/optionhandler.h"
@@ -45,6 +48,8 @@
 #include <sys/ioctl.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include "dns_async.h"
+#include "socket_poller.h"
 
 #define SOCKET_SUCCESS                 0
 #define INVALID_SOCKET                 -1
@@ -57,6 +62,12 @@
 // connect timeout in seconds
 #define CONNECT_TIMEOUT         10
 
+// smallest send ring allocated once a send has to be queued
+#ifndef SOCKETIO_SEND_BUFFER_INITIAL_SIZE
+#define SOCKETIO_SEND_BUFFER_INITIAL_SIZE 4096
+#endif
+#define PENDING_IO_INITIAL_CAPACITY 8
+
 typedef enum IO_STATE_TAG
 {
     IO_STATE_CLOSED,
@@ -66,13 +77,12 @@ typedef enum IO_STATE_TAG
     IO_STATE_ERROR
 } IO_STATE;
 
+/* a queued packet; its bytes live in the instance's send ring */
 typedef struct PENDING_SOCKET_IO_TAG
 {
-    unsigned char* bytes;
     size_t size;
     ON_SEND_COMPLETE on_send_complete;
     void* callback_context;
-    SINGLYLINKEDLIST_HANDLE pending_io_list;
 } PENDING_SOCKET_IO;
 
 typedef struct SOCKET_IO_INSTANCE_TAG
@@ -86,7 +96,23 @@ typedef struct SOCKET_IO_INSTANCE_TAG
     int port;
     char* target_mac_address;
     IO_STATE io_state;
-    SINGLYLINKEDLIST_HANDLE pending_io_list;
+    /* bytes of queued packets, back to back in one ring so a single sendmsg flushes several */
+    unsigned char* send_buffer;
+    size_t send_buffer_size;
+    size_t send_buffer_head;
+    size_t send_buffer_length;
+    /* ring of queued packets in send order, reporting completion as their bytes leave */
+    PENDING_SOCKET_IO* pending_ios;
+    size_t pending_io_capacity;
+    size_t pending_io_head;
+    size_t pending_io_count;
+    SOCKETIO_SEND_STATISTICS send_statistics;
+    ON_IO_OPEN_COMPLETE on_io_open_complete;
+    void* on_io_open_complete_context;
+    DNS_ASYNC_HANDLE dns;
+    time_t connect_start_time;
+    bool is_poller_initialized;
+    SOCKET_POLLER_REGISTRATION_HANDLE poller_registration;
     unsigned char recv_bytes[RECEIVE_BYTES_VALUE];
 } SOCKET_IO_INSTANCE;
 
@@ -201,45 +227,300 @@ static void indicate_error(SOCKET_IO_INSTANCE* socket_io_instance)
     }
 }
 
-static int add_pending_io(SOCKET_IO_INSTANCE* socket_io_instance, const unsigned char* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+/* Registers the socket with the shared poller. Without a registration dowork simply tries send and recv every time. */
+static void watch_socket(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    if (socket_io_instance->is_poller_initialized)
+    {
+        socket_io_instance->poller_registration = socket_poller_add(socket_io_instance->socket);
+    }
+}
+
+static unsigned int get_socket_events(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    unsigned int result;
+
+    if (socket_io_instance->poller_registration == NULL)
+    {
+        result = SOCKET_POLLER_READABLE | SOCKET_POLLER_WRITABLE;
+    }
+    else
+    {
+        result = socket_poller_get_events(socket_io_instance->poller_registration);
+    }
+
+    return result;
+}
+
+static void clear_socket_events(SOCKET_IO_INSTANCE* socket_io_instance, unsigned int events)
+{
+    if (socket_io_instance->poller_registration != NULL)
+    {
+        socket_poller_clear_events(socket_io_instance->poller_registration, events);
+    }
+}
+
+static int reserve_send_buffer(SOCKET_IO_INSTANCE* socket_io_instance, size_t size)
 {
     int result;
-    PENDING_SOCKET_IO* pending_socket_io = (PENDING_SOCKET_IO*)malloc(sizeof(PENDING_SOCKET_IO));
-    if (pending_socket_io == NULL)
+    size_t needed = socket_io_instance->send_buffer_length + size;
+
+    if (needed <= socket_io_instance->send_buffer_size)
+    {
+        result = 0;
+    }
+    else if (needed < size)
     {
+        LogError("Failure: send queue size overflow.");
         result = __FAILURE__;
     }
     else
     {
-        pending_socket_io->bytes = (unsigned char*)malloc(size);
-        if (pending_socket_io->bytes == NULL)
+        size_t new_size = socket_io_instance->send_buffer_size * 2;
+        unsigned char* new_buffer;
+
+        if (new_size < needed)
+        {
+            new_size = needed;
+        }
+        if (new_size < SOCKETIO_SEND_BUFFER_INITIAL_SIZE)
+        {
+            new_size = SOCKETIO_SEND_BUFFER_INITIAL_SIZE;
+        }
+
+        if ((new_buffer = (unsigned char*)malloc(new_size)) == NULL)
         {
-            LogError("Allocation Failure: Unable to allocate pending list.");
-            free(pending_socket_io);
+            LogError("Allocation Failure: Unable to grow the send queue to %lu bytes.", (unsigned long)new_size);
             result = __FAILURE__;
         }
         else
         {
-            pending_socket_io->size = size;
-            pending_socket_io->on_send_complete = on_send_complete;
-            pending_socket_io->callback_context = callback_context;
-            pending_socket_io->pending_io_list = socket_io_instance->pending_io_list;
-            (void)memcpy(pending_socket_io->bytes, buffer, size);
+            if (socket_io_instance->send_buffer_length > 0)
+            {
+                /* unwrap the queued bytes to the start of the new ring */
+                size_t first = socket_io_instance->send_buffer_size - socket_io_instance->send_buffer_head;
+                if (first > socket_io_instance->send_buffer_length)
+                {
+                    first = socket_io_instance->send_buffer_length;
+                }
+                (void)memcpy(new_buffer, socket_io_instance->send_buffer + socket_io_instance->send_buffer_head, first);
+                (void)memcpy(new_buffer + first, socket_io_instance->send_buffer, socket_io_instance->send_buffer_length - first);
+            }
+
+            free(socket_io_instance->send_buffer);
+            socket_io_instance->send_buffer = new_buffer;
+            socket_io_instance->send_buffer_size = new_size;
+            socket_io_instance->send_buffer_head = 0;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int reserve_pending_io(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    int result;
+
+    if (socket_io_instance->pending_io_count < socket_io_instance->pending_io_capacity)
+    {
+        result = 0;
+    }
+    else
+    {
+        size_t new_capacity = (socket_io_instance->pending_io_capacity == 0) ? PENDING_IO_INITIAL_CAPACITY : (socket_io_instance->pending_io_capacity * 2);
+        PENDING_SOCKET_IO* new_pending_ios = (PENDING_SOCKET_IO*)malloc(new_capacity * sizeof(PENDING_SOCKET_IO));
 
-            if (singlylinkedlist_add(socket_io_instance->pending_io_list, pending_socket_io) == NULL)
+        if (new_pending_ios == NULL)
+        {
+            LogError("Allocation Failure: Unable to grow the pending send list.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < socket_io_instance->pending_io_count; i++)
             {
-                LogError("Failure: Unable to add socket to pending list.");
-                free(pending_socket_io->bytes);
-                free(pending_socket_io);
-                result = __FAILURE__;
+                new_pending_ios[i] = socket_io_instance->pending_ios[(socket_io_instance->pending_io_head + i) % socket_io_instance->pending_io_capacity];
+            }
+
+            free(socket_io_instance->pending_ios);
+            socket_io_instance->pending_ios = new_pending_ios;
+            socket_io_instance->pending_io_capacity = new_capacity;
+            socket_io_instance->pending_io_head = 0;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/* Copies the bytes into the send ring and records the packet; neither allocates once the rings are big enough. */
+static int add_pending_io(SOCKET_IO_INSTANCE* socket_io_instance, const unsigned char* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    int result;
+
+    if ((reserve_send_buffer(socket_io_instance, size) != 0) ||
+        (reserve_pending_io(socket_io_instance) != 0))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t tail = (socket_io_instance->send_buffer_head + socket_io_instance->send_buffer_length) % socket_io_instance->send_buffer_size;
+        size_t first = socket_io_instance->send_buffer_size - tail;
+        PENDING_SOCKET_IO* pending_socket_io = &socket_io_instance->pending_ios[(socket_io_instance->pending_io_head + socket_io_instance->pending_io_count) % socket_io_instance->pending_io_capacity];
+
+        if (first > size)
+        {
+            first = size;
+        }
+        (void)memcpy(socket_io_instance->send_buffer + tail, buffer, first);
+        (void)memcpy(socket_io_instance->send_buffer, buffer + first, size - first);
+        socket_io_instance->send_buffer_length += size;
+
+        pending_socket_io->size = size;
+        pending_socket_io->on_send_complete = on_send_complete;
+        pending_socket_io->callback_context = callback_context;
+        socket_io_instance->pending_io_count++;
+
+        socket_io_instance->send_statistics.packets_queued++;
+        socket_io_instance->send_statistics.queued_bytes += size;
+        if (socket_io_instance->send_statistics.queued_bytes > socket_io_instance->send_statistics.peak_queued_bytes)
+        {
+            socket_io_instance->send_statistics.peak_queued_bytes = socket_io_instance->send_statistics.queued_bytes;
+        }
+        result = 0;
+    }
+
+    return result;
+}
+
+/* Drops sent bytes from the ring and reports every packet they finish. */
+static void consume_sent_bytes(SOCKET_IO_INSTANCE* socket_io_instance, size_t sent)
+{
+    socket_io_instance->send_buffer_head = (socket_io_instance->send_buffer_head + sent) % socket_io_instance->send_buffer_size;
+    socket_io_instance->send_buffer_length -= sent;
+    socket_io_instance->send_statistics.queued_bytes -= sent;
+    if (socket_io_instance->send_buffer_length == 0)
+    {
+        socket_io_instance->send_buffer_head = 0;
+    }
+
+    while ((sent > 0) && (socket_io_instance->pending_io_count > 0))
+    {
+        PENDING_SOCKET_IO* pending_socket_io = &socket_io_instance->pending_ios[socket_io_instance->pending_io_head];
+
+        if (sent < pending_socket_io->size)
+        {
+            pending_socket_io->size -= sent;
+            sent = 0;
+        }
+        else
+        {
+            ON_SEND_COMPLETE on_send_complete = pending_socket_io->on_send_complete;
+            void* callback_context = pending_socket_io->callback_context;
+
+            /* the callback may queue another send, so the record is released first */
+            sent -= pending_socket_io->size;
+            socket_io_instance->pending_io_head = (socket_io_instance->pending_io_head + 1) % socket_io_instance->pending_io_capacity;
+            socket_io_instance->pending_io_count--;
+            socket_io_instance->send_statistics.packets_flushed++;
+
+            if (on_send_complete != NULL)
+            {
+                on_send_complete(callback_context, IO_SEND_OK);
+            }
+        }
+    }
+}
+
+static void discard_pending_io(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    socket_io_instance->send_buffer_head = 0;
+    socket_io_instance->send_buffer_length = 0;
+    socket_io_instance->send_statistics.queued_bytes = 0;
+
+    while (socket_io_instance->pending_io_count > 0)
+    {
+        PENDING_SOCKET_IO* pending_socket_io = &socket_io_instance->pending_ios[socket_io_instance->pending_io_head];
+        ON_SEND_COMPLETE on_send_complete = pending_socket_io->on_send_complete;
+        void* callback_context = pending_socket_io->callback_context;
+
+        socket_io_instance->pending_io_head = (socket_io_instance->pending_io_head + 1) % socket_io_instance->pending_io_capacity;
+        socket_io_instance->pending_io_count--;
+
+        if (on_send_complete != NULL)
+        {
+            on_send_complete(callback_context, IO_SEND_CANCELLED);
+        }
+    }
+
+    socket_io_instance->pending_io_head = 0;
+}
+
+/* Sends as much of the queue as the socket takes, both halves of the ring in one call. */
+static void flush_pending_io(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    while ((socket_io_instance->io_state == IO_STATE_OPEN) && (socket_io_instance->send_buffer_length > 0))
+    {
+        struct iovec iov[2];
+        size_t first = socket_io_instance->send_buffer_size - socket_io_instance->send_buffer_head;
+        size_t offered;
+        ssize_t send_result;
+
+        if (first > socket_io_instance->send_buffer_length)
+        {
+            first = socket_io_instance->send_buffer_length;
+        }
+        iov[0].iov_base = socket_io_instance->send_buffer + socket_io_instance->send_buffer_head;
+        iov[0].iov_len = first;
+        iov[1].iov_base = socket_io_instance->send_buffer;
+        iov[1].iov_len = socket_io_instance->send_buffer_length - first;
+
+        signal(SIGPIPE, SIG_IGN);
+
+#ifdef TIZENRT
+        /* no sendmsg in the TizenRT socket layer; the wrapped half goes on the next pass */
+        offered = iov[0].iov_len;
+        send_result = send(socket_io_instance->socket, iov[0].iov_base, iov[0].iov_len, 0);
+#else
+        {
+            struct msghdr message;
+            (void)memset(&message, 0, sizeof(message));
+            message.msg_iov = iov;
+            message.msg_iovlen = (iov[1].iov_len > 0) ? 2 : 1;
+            offered = iov[0].iov_len + iov[1].iov_len;
+            send_result = sendmsg(socket_io_instance->socket, &message, 0);
+        }
+#endif
+        socket_io_instance->send_statistics.flush_calls++;
+
+        if (send_result < 0)
+        {
+            if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) /*send says "come back later" with EAGAIN - likely the socket buffer cannot accept more data*/
+            {
+                /*do nothing until the socket is writable again */
+                clear_socket_events(socket_io_instance, SOCKET_POLLER_WRITABLE);
             }
             else
             {
-                result = 0;
+                LogError("Failure: sending Socket information. errno=%d (%s).", errno, strerror(errno));
+                socket_io_instance->io_state = IO_STATE_ERROR;
+                indicate_error(socket_io_instance);
+            }
+            break;
+        }
+        else
+        {
+            consume_sent_bytes(socket_io_instance, (size_t)send_result);
+            if ((size_t)send_result < offered)
+            {
+                /* simply wait until next dowork */
+                break;
             }
         }
     }
-    return result;
 }
 
 static STATIC_VAR_UNUSED void signal_callback(int signum)
@@ -465,6 +746,188 @@ static int set_target_network_interface(int socket, char* mac_address)
 }
 #endif //__APPLE__
 
+static void close_socket(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    if (socket_io_instance->poller_registration != NULL)
+    {
+        socket_poller_remove(socket_io_instance->poller_registration);
+        socket_io_instance->poller_registration = NULL;
+    }
+
+    close(socket_io_instance->socket);
+    socket_io_instance->socket = INVALID_SOCKET;
+}
+
+static void indicate_open_complete(SOCKET_IO_INSTANCE* socket_io_instance, IO_OPEN_RESULT open_result)
+{
+    if (open_result == IO_OPEN_OK)
+    {
+        socket_io_instance->io_state = IO_STATE_OPEN;
+    }
+    else
+    {
+        if (socket_io_instance->dns != NULL)
+        {
+            dns_async_destroy(socket_io_instance->dns);
+            socket_io_instance->dns = NULL;
+        }
+
+        if (socket_io_instance->socket != INVALID_SOCKET)
+        {
+            close_socket(socket_io_instance);
+        }
+
+        socket_io_instance->io_state = IO_STATE_CLOSED;
+    }
+
+    if (socket_io_instance->on_io_open_complete != NULL)
+    {
+        socket_io_instance->on_io_open_complete(socket_io_instance->on_io_open_complete_context, open_result);
+    }
+}
+
+/* Creates the socket and starts a non-blocking connect to ipv4 (network byte order); poll_connect finishes it from dowork. */
+static int start_connect(SOCKET_IO_INSTANCE* socket_io_instance, uint32_t ipv4)
+{
+    int result;
+    int flags;
+
+    socket_io_instance->socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (socket_io_instance->socket < SOCKET_SUCCESS)
+    {
+        LogError("Failure: socket create failure %d.", socket_io_instance->socket);
+        socket_io_instance->socket = INVALID_SOCKET;
+        result = __FAILURE__;
+    }
+#ifndef __APPLE__
+    else if (socket_io_instance->target_mac_address != NULL &&
+             set_target_network_interface(socket_io_instance->socket, socket_io_instance->target_mac_address) != 0)
+    {
+        LogError("Failure: failed selecting target network interface (MACADDR=%s).", socket_io_instance->target_mac_address);
+        close_socket(socket_io_instance);
+        result = __FAILURE__;
+    }
+#endif //__APPLE__
+    else if ((-1 == (flags = fcntl(socket_io_instance->socket, F_GETFL, 0))) ||
+             (fcntl(socket_io_instance->socket, F_SETFL, flags | O_NONBLOCK) == -1))
+    {
+        LogError("Failure: fcntl failure.");
+        close_socket(socket_io_instance);
+        result = __FAILURE__;
+    }
+    else
+    {
+        struct sockaddr_in addr;
+
+        (void)memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)socket_io_instance->port);
+        addr.sin_addr.s_addr = ipv4;
+
+        if ((connect(socket_io_instance->socket, (struct sockaddr*)&addr, sizeof(addr)) != 0) && (errno != EINPROGRESS))
+        {
+            LogError("Failure: connect failure %d.", errno);
+            close_socket(socket_io_instance);
+            result = __FAILURE__;
+        }
+        else
+        {
+            socket_io_instance->connect_start_time = get_time(NULL);
+            watch_socket(socket_io_instance);
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/* dns_async resolves synchronously, so the first call blocks dowork for the whole lookup; the dns_cache
+   is what keeps reconnects from blocking */
+static void poll_dns(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    if (dns_async_is_lookup_complete(socket_io_instance->dns))
+    {
+        uint32_t ipv4 = dns_async_get_ipv4(socket_io_instance->dns);
+        dns_async_destroy(socket_io_instance->dns);
+        socket_io_instance->dns = NULL;
+
+        if (ipv4 == 0)
+        {
+            LogError("Failure: unable to resolve %s.", socket_io_instance->hostname);
+            indicate_open_complete(socket_io_instance, IO_OPEN_ERROR);
+        }
+        else
+        {
+            (void)dns_cache_add_ipv4(socket_io_instance->hostname, ipv4);
+
+            if (start_connect(socket_io_instance, ipv4) != 0)
+            {
+                indicate_open_complete(socket_io_instance, IO_OPEN_ERROR);
+            }
+        }
+    }
+}
+
+static void poll_connect(SOCKET_IO_INSTANCE* socket_io_instance)
+{
+    int retval;
+
+    if (socket_io_instance->poller_registration != NULL)
+    {
+        /* the shared poller reports the socket writable once the connect has finished */
+        retval = ((socket_poller_get_events(socket_io_instance->poller_registration) & SOCKET_POLLER_WRITABLE) != 0) ? 1 : 0;
+    }
+    else
+    {
+        fd_set fdset;
+        struct timeval tv;
+
+        FD_ZERO(&fdset);
+        FD_SET(socket_io_instance->socket, &fdset);
+        tv.tv_sec = 0;
+        tv.tv_usec = 0;
+
+        retval = select(socket_io_instance->socket + 1, NULL, &fdset, NULL, &tv);
+    }
+
+    if ((retval < 0) && (errno != EINTR))
+    {
+        LogError("Failure: select failure %d.", errno);
+        indicate_open_complete(socket_io_instance, IO_OPEN_ERROR);
+    }
+    else if (retval <= 0)
+    {
+        if (get_difftime(get_time(NULL), socket_io_instance->connect_start_time) >= CONNECT_TIMEOUT)
+        {
+            LogError("Failure: connect timed out.");
+            /* the cached address may be stale; resolve again on the next open */
+            dns_cache_remove(socket_io_instance->hostname);
+            indicate_open_complete(socket_io_instance, IO_OPEN_ERROR);
+        }
+    }
+    else
+    {
+        int so_error = 0;
+        socklen_t len = sizeof(so_error);
+
+        if (getsockopt(socket_io_instance->socket, SOL_SOCKET, SO_ERROR, &so_error, &len) != 0)
+        {
+            LogError("Failure: getsockopt failure %d.", errno);
+            indicate_open_complete(socket_io_instance, IO_OPEN_ERROR);
+        }
+        else if (so_error != 0)
+        {
+            LogError("Failure: connect failure %d.", so_error);
+            dns_cache_remove(socket_io_instance->hostname);
+            indicate_open_complete(socket_io_instance, IO_OPEN_ERROR);
+        }
+        else
+        {
+            indicate_open_complete(socket_io_instance, IO_OPEN_OK);
+        }
+    }
+}
+
 CONCRETE_IO_HANDLE socketio_create(void* io_create_parameters)
 {
     SOCKETIO_CONFIG* socket_io_config = io_create_parameters;
@@ -480,47 +943,57 @@ CONCRETE_IO_HANDLE socketio_create(void* io_create_parameters)
         result = malloc(sizeof(SOCKET_IO_INSTANCE));
         if (result != NULL)
         {
-            result->pending_io_list = singlylinkedlist_create();
-            if (result->pending_io_list == NULL)
+            if (socket_io_config->hostname != NULL)
+            {
+                result->hostname = (char*)malloc(strlen(socket_io_config->hostname) + 1);
+                if (result->hostname != NULL)
+                {
+                    (void)strcpy(result->hostname, socket_io_config->hostname);
+                }
+
+                result->socket = INVALID_SOCKET;
+            }
+            else
+            {
+                result->hostname = NULL;
+                result->socket = *((int*)socket_io_config->accepted_socket);
+            }
+
+            if ((result->hostname == NULL) && (result->socket == INVALID_SOCKET))
             {
-                LogError("Failure: singlylinkedlist_create unable to create pending list.");
+                LogError("Failure: hostname == NULL and socket is invalid.");
                 free(result);
                 result = NULL;
             }
             else
             {
-                if (socket_io_config->hostname != NULL)
-                {
-                    result->hostname = (char*)malloc(strlen(socket_io_config->hostname) + 1);
-                    if (result->hostname != NULL)
-                    {
-                        (void)strcpy(result->hostname, socket_io_config->hostname);
-                    }
-
-                    result->socket = INVALID_SOCKET;
-                }
-                else
+                result->port = socket_io_config->port;
+                result->target_mac_address = NULL;
+                result->on_bytes_received = NULL;
+                result->on_io_error = NULL;
+                result->on_bytes_received_context = NULL;
+                result->on_io_error_context = NULL;
+                result->on_io_open_complete = NULL;
+                result->on_io_open_complete_context = NULL;
+                result->dns = NULL;
+                result->poller_registration = NULL;
+                result->io_state = IO_STATE_CLOSED;
+                /* the send rings are only allocated once a send has to wait */
+                result->send_buffer = NULL;
+                result->send_buffer_size = 0;
+                result->send_buffer_head = 0;
+                result->send_buffer_length = 0;
+                result->pending_ios = NULL;
+                result->pending_io_capacity = 0;
+                result->pending_io_head = 0;
+                result->pending_io_count = 0;
+                (void)memset(&result->send_statistics, 0, sizeof(result->send_statistics));
+
+                /* all instances share one poller; failing to start it only costs the syscall savings */
+                result->is_poller_initialized = (socket_poller_init() == 0);
+                if (!result->is_poller_initialized)
                 {
-                    result->hostname = NULL;
-                    result->socket = *((int*)socket_io_config->accepted_socket);
-                }
-
-                if ((result->hostname == NULL) && (result->socket == INVALID_SOCKET))
-                {
-                    LogError("Failure: hostname == NULL and socket is invalid.");
-                    singlylinkedlist_destroy(result->pending_io_list);
-                    free(result);
-                    result = NULL;
-                }
-                else
-                {
-                    result->port = socket_io_config->port;
-                    result->target_mac_address = NULL;
-                    result->on_bytes_received = NULL;
-                    result->on_io_error = NULL;
-                    result->on_bytes_received_context = NULL;
-                    result->on_io_error_context = NULL;
-                    result->io_state = IO_STATE_CLOSED;
+                    LogInfo("Socket poller unavailable; polling each socket directly.");
                 }
             }
         }
@@ -541,25 +1014,23 @@ void socketio_destroy(CONCRETE_IO_HANDLE socket_io)
         /* we cannot do much if the close fails, so just ignore the result */
         if (socket_io_instance->socket != INVALID_SOCKET)
         {
-            close(socket_io_instance->socket);
+            close_socket(socket_io_instance);
         }
 
-        /* clear allpending IOs */
-        LIST_ITEM_HANDLE first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
-        while (first_pending_io != NULL)
+        if (socket_io_instance->dns != NULL)
         {
-            PENDING_SOCKET_IO* pending_socket_io = (PENDING_SOCKET_IO*)singlylinkedlist_item_get_value(first_pending_io);
-            if (pending_socket_io != NULL)
-            {
-                free(pending_socket_io->bytes);
-                free(pending_socket_io);
-            }
+            dns_async_destroy(socket_io_instance->dns);
+        }
 
-            (void)singlylinkedlist_remove(socket_io_instance->pending_io_list, first_pending_io);
-            first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
+        if (socket_io_instance->is_poller_initialized)
+        {
+            socket_poller_deinit();
         }
 
-        singlylinkedlist_destroy(socket_io_instance->pending_io_list);
+        /* clear all pending IOs */
+        discard_pending_io(socket_io_instance);
+        free(socket_io_instance->send_buffer);
+        free(socket_io_instance->pending_ios);
         free(socket_io_instance->hostname);
         free(socket_io_instance->target_mac_address);
         free(socket_io);
@@ -569,8 +1040,6 @@ void socketio_destroy(CONCRETE_IO_HANDLE socket_io)
 int socketio_open(CONCRETE_IO_HANDLE socket_io, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context)
 {
     int result;
-    int retval = -1;
-    int select_errno = 0;
 
     SOCKET_IO_INSTANCE* socket_io_instance = (SOCKET_IO_INSTANCE*)socket_io;
     if (socket_io == NULL)
@@ -585,150 +1054,61 @@ int socketio_open(CONCRETE_IO_HANDLE socket_io, ON_IO_OPEN_COMPLETE on_io_open_c
             LogError("Failure: socket state is not closed.");
             result = __FAILURE__;
         }
-        else if (socket_io_instance->socket != INVALID_SOCKET)
+        else
         {
-            // Opening an accepted socket
-            socket_io_instance->on_bytes_received_context = on_bytes_received_context;
             socket_io_instance->on_bytes_received = on_bytes_received;
+            socket_io_instance->on_bytes_received_context = on_bytes_received_context;
             socket_io_instance->on_io_error = on_io_error;
             socket_io_instance->on_io_error_context = on_io_error_context;
+            socket_io_instance->on_io_open_complete = on_io_open_complete;
+            socket_io_instance->on_io_open_complete_context = on_io_open_complete_context;
+            (void)memset(&socket_io_instance->send_statistics, 0, sizeof(socket_io_instance->send_statistics));
 
-            socket_io_instance->io_state = IO_STATE_OPEN;
-
-            result = 0;
-        }
-        else
-        {
-            struct addrinfo* addrInfo;
-            char portString[16];
-
-            socket_io_instance->socket = socket(AF_INET, SOCK_STREAM, 0);
-            if (socket_io_instance->socket < SOCKET_SUCCESS)
+            if (socket_io_instance->socket != INVALID_SOCKET)
             {
-                LogError("Failure: socket create failure %d.", socket_io_instance->socket);
-                result = __FAILURE__;
-            }
-#ifndef __APPLE__
-            else if (socket_io_instance->target_mac_address != NULL &&
-                     set_target_network_interface(socket_io_instance->socket, socket_io_instance->target_mac_address) != 0)
-            {
-                LogError("Failure: failed selecting target network interface (MACADDR=%s).", socket_io_instance->target_mac_address);
-                close(socket_io_instance->socket);
-                socket_io_instance->socket = INVALID_SOCKET;
-                result = __FAILURE__;
+                // Opening an accepted socket
+                watch_socket(socket_io_instance);
+                indicate_open_complete(socket_io_instance, IO_OPEN_OK);
+                result = 0;
             }
-#endif //__APPLE__
             else
             {
-                struct addrinfo addrHint = { 0 };
-                addrHint.ai_family = AF_INET;
-                addrHint.ai_socktype = SOCK_STREAM;
-                addrHint.ai_protocol = 0;
-
-                sprintf(portString, "%u", socket_io_instance->port);
-                int err = getaddrinfo(socket_io_instance->hostname, portString, &addrHint, &addrInfo);
-                if (err != 0)
-                {
-                    LogError("Failure: getaddrinfo failure %d.", err);
-                    close(socket_io_instance->socket);
-                    socket_io_instance->socket = INVALID_SOCKET;
-                    result = __FAILURE__;
-                }
-                else
+                uint32_t ipv4;
+
+                /* resolving and connecting are advanced from socketio_dowork, which reports the open result.
+                   On a cache miss the lookup itself still blocks that dowork, see poll_dns */
+                socket_io_instance->io_state = IO_STATE_OPENING;
+
+                if (dns_cache_get_ipv4(socket_io_instance->hostname, &ipv4) == 0)
                 {
-                    int flags;
-                    if ((-1 == (flags = fcntl(socket_io_instance->socket, F_GETFL, 0))) ||
-                        (fcntl(socket_io_instance->socket, F_SETFL, flags | O_NONBLOCK) == -1))
+                    /* a reconnect to a recently resolved host skips DNS entirely */
+                    if (start_connect(socket_io_instance, ipv4) != 0)
                     {
-                        LogError("Failure: fcntl failure.");
-                        close(socket_io_instance->socket);
-                        socket_io_instance->socket = INVALID_SOCKET;
+                        socket_io_instance->io_state = IO_STATE_CLOSED;
                         result = __FAILURE__;
                     }
                     else
                     {
-                        err = connect(socket_io_instance->socket, addrInfo->ai_addr, sizeof(*addrInfo->ai_addr));
-                        if ((err != 0) && (errno != EINPROGRESS))
-                        {
-                            LogError("Failure: connect failure %d.", errno);
-                            close(socket_io_instance->socket);
-                            socket_io_instance->socket = INVALID_SOCKET;
-                            result = __FAILURE__;
-                        }
-                        else
-                        {
-                            if (err != 0)
-                            {
-                                fd_set fdset;
-                                struct timeval tv;
-
-                                FD_ZERO(&fdset);
-                                FD_SET(socket_io_instance->socket, &fdset);
-                                tv.tv_sec = CONNECT_TIMEOUT;
-                                tv.tv_usec = 0;
-
-                                do
-                                {
-                                    retval = select(socket_io_instance->socket + 1, NULL, &fdset, NULL, &tv);
-
-                                    if (retval < 0)
-                                    {
-                                        select_errno = errno;
-                                    }
-                                } while (retval < 0 && select_errno == EINTR);
-                                
-                                if (retval != 1)
-                                {
-                                    LogError("Failure: select failure.");
-                                    close(socket_io_instance->socket);
-                                    socket_io_instance->socket = INVALID_SOCKET;
-                                    result = __FAILURE__;
-                                }
-                                else
-                                {
-                                    int so_error = 0;
-                                    socklen_t len = sizeof(so_error);
-                                    err = getsockopt(socket_io_instance->socket, SOL_SOCKET, SO_ERROR, &so_error, &len);
-                                    if (err != 0)
-                                    {
-                                        LogError("Failure: getsockopt failure %d.", errno);
-                                        close(socket_io_instance->socket);
-                                        socket_io_instance->socket = INVALID_SOCKET;
-                                        result = __FAILURE__;
-                                    }
-                                    else if (so_error != 0)
-                                    {
-                                        err = so_error;
-                                        LogError("Failure: connect failure %d.", so_error);
-                                        close(socket_io_instance->socket);
-                                        socket_io_instance->socket = INVALID_SOCKET;
-                                        result = __FAILURE__;
-                                    }
-                                }
-                            }
-                            if (err == 0)
-                            {
-                                socket_io_instance->on_bytes_received = on_bytes_received;
-                                socket_io_instance->on_bytes_received_context = on_bytes_received_context;
-
-                                socket_io_instance->on_io_error = on_io_error;
-                                socket_io_instance->on_io_error_context = on_io_error_context;
-
-                                socket_io_instance->io_state = IO_STATE_OPEN;
-
-                                result = 0;
-                            }
-                        }
+                        result = 0;
                     }
-                    freeaddrinfo(addrInfo);
+                }
+                else if ((socket_io_instance->dns = dns_async_create(socket_io_instance->hostname, NULL)) == NULL)
+                {
+                    LogError("Failure: dns_async_create failed.");
+                    socket_io_instance->io_state = IO_STATE_CLOSED;
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
                 }
             }
         }
     }
 
-    if (on_io_open_complete != NULL)
+    if ((result != 0) && (on_io_open_complete != NULL))
     {
-        on_io_open_complete(on_io_open_complete_context, result == 0 ? IO_OPEN_OK : IO_OPEN_ERROR);
+        on_io_open_complete(on_io_open_complete_context, IO_OPEN_ERROR);
     }
 
     return result;
@@ -748,10 +1128,17 @@ int socketio_close(CONCRETE_IO_HANDLE socket_io, ON_IO_CLOSE_COMPLETE on_io_clos
         if ((socket_io_instance->io_state != IO_STATE_CLOSED) && (socket_io_instance->io_state != IO_STATE_CLOSING))
         {
             // Only close if the socket isn't already in the closed or closing state
-            (void)shutdown(socket_io_instance->socket, SHUT_RDWR);
-            close(socket_io_instance->socket);
-            socket_io_instance->socket = INVALID_SOCKET;
-            socket_io_instance->io_state = IO_STATE_CLOSED;
+            if (socket_io_instance->io_state == IO_STATE_OPENING)
+            {
+                indicate_open_complete(socket_io_instance, IO_OPEN_CANCELLED);
+            }
+            else
+            {
+                (void)shutdown(socket_io_instance->socket, SHUT_RDWR);
+                close_socket(socket_io_instance);
+                socket_io_instance->io_state = IO_STATE_CLOSED;
+                discard_pending_io(socket_io_instance);
+            }
         }
 
         if (on_io_close_complete != NULL)
@@ -787,9 +1174,11 @@ int socketio_send(CONCRETE_IO_HANDLE socket_io, const void* buffer, size_t size,
         }
         else
         {
-            LIST_ITEM_HANDLE first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
-            if (first_pending_io != NULL)
+            socket_io_instance->send_statistics.packets_sent++;
+
+            if (socket_io_instance->pending_io_count > 0)
             {
+                /* keep the order: this packet goes out after the ones already waiting */
                 if (add_pending_io(socket_io_instance, buffer, size, on_send_complete, callback_context) != 0)
                 {
                     LogError("Failure: add_pending_io failed.");
@@ -804,26 +1193,28 @@ int socketio_send(CONCRETE_IO_HANDLE socket_io, const void* buffer, size_t size,
             {
                 signal(SIGPIPE, SIG_IGN);
 
-                int send_result = send(socket_io_instance->socket, buffer, size, 0);
-                if (send_result != size)
+                ssize_t send_result = send(socket_io_instance->socket, buffer, size, 0);
+                if (send_result != (ssize_t)size)
                 {
-                    if (send_result == INVALID_SOCKET)
+                    if ((send_result == INVALID_SOCKET) && (errno != EAGAIN) && (errno != EWOULDBLOCK))
+                    {
+                        LogError("Failure: sending socket failed. errno=%d (%s).", errno, strerror(errno));
+                        result = __FAILURE__;
+                    }
+                    else
                     {
-                        if (errno == EAGAIN) /*send says "come back later" with EAGAIN - likely the socket buffer cannot accept more data*/
+                        /* send says "come back later" with EAGAIN or took only part of the data - queue the rest */
+                        size_t sent = 0;
+                        if (send_result == INVALID_SOCKET)
                         {
-                            /*do nothing*/
-                            result = 0;
+                            clear_socket_events(socket_io_instance, SOCKET_POLLER_WRITABLE);
                         }
                         else
                         {
-                            LogError("Failure: sending socket failed. errno=%d (%s).", errno, strerror(errno));
-                            result = __FAILURE__;
+                            sent = (size_t)send_result;
                         }
-                    }
-                    else
-                    {
-                        /* queue data */
-                        if (add_pending_io(socket_io_instance, buffer + send_result, size - send_result, on_send_complete, callback_context) != 0)
+
+                        if (add_pending_io(socket_io_instance, (const unsigned char*)buffer + sent, size - sent, on_send_complete, callback_context) != 0)
                         {
                             LogError("Failure: add_pending_io failed.");
                             result = __FAILURE__;
@@ -855,95 +1246,57 @@ void socketio_dowork(CONCRETE_IO_HANDLE socket_io)
     if (socket_io != NULL)
     {
         SOCKET_IO_INSTANCE* socket_io_instance = (SOCKET_IO_INSTANCE*)socket_io;
-        LIST_ITEM_HANDLE first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
-        while (first_pending_io != NULL)
+        if (socket_io_instance->io_state == IO_STATE_OPENING)
         {
-            PENDING_SOCKET_IO* pending_socket_io = (PENDING_SOCKET_IO*)singlylinkedlist_item_get_value(first_pending_io);
-            if (pending_socket_io == NULL)
+            if (socket_io_instance->dns != NULL)
             {
-                socket_io_instance->io_state = IO_STATE_ERROR;
-                indicate_error(socket_io_instance);
-                LogError("Failure: retrieving socket from list");
-                break;
+                poll_dns(socket_io_instance);
+            }
+            else
+            {
+                poll_connect(socket_io_instance);
+            }
+        }
+        else
+        {
+            /* with the shared poller only a direction that reported readiness costs a system call */
+            unsigned int events = get_socket_events(socket_io_instance);
+            if ((socket_io_instance->pending_io_count > 0) && ((events & SOCKET_POLLER_WRITABLE) != 0))
+            {
+                flush_pending_io(socket_io_instance);
             }
 
-            signal(SIGPIPE, SIG_IGN);
-
-            int send_result = send(socket_io_instance->socket, pending_socket_io->bytes, pending_socket_io->size, 0);
-            if (send_result != pending_socket_io->size)
+            if ((socket_io_instance->io_state == IO_STATE_OPEN) && ((events & SOCKET_POLLER_READABLE) != 0))
             {
-                if (send_result == INVALID_SOCKET)
+                int received = 0;
+                do
                 {
-                    if (errno == EAGAIN) /*send says "come back later" with EAGAIN - likely the socket buffer cannot accept more data*/
+                    received = recv(socket_io_instance->socket, socket_io_instance->recv_bytes, RECEIVE_BYTES_VALUE, 0);
+                    if (received > 0)
                     {
-                        /*do nothing until next dowork */
-                        break;
+                        if (socket_io_instance->on_bytes_received != NULL)
+                        {
+                            /* Explicitly ignoring here the result of the callback */
+                            (void)socket_io_instance->on_bytes_received(socket_io_instance->on_bytes_received_context, socket_io_instance->recv_bytes, received);
+                        }
                     }
-                    else
+                    else if (received == 0)
                     {
-                        free(pending_socket_io->bytes);
-                        free(pending_socket_io);
-                        (void)singlylinkedlist_remove(socket_io_instance->pending_io_list, first_pending_io);
-
-                        LogError("Failure: sending Socket information. errno=%d (%s).", errno, strerror(errno));
-                        socket_io_instance->io_state = IO_STATE_ERROR;
+                        // Do not log error here due to this is probably the socket being closed on the other end
                         indicate_error(socket_io_instance);
                     }
-                }
-                else
-                {
-                    /* simply wait until next dowork */
-                    (void)memmove(pending_socket_io->bytes, pending_socket_io->bytes + send_result, pending_socket_io->size - send_result);
-                    pending_socket_io->size -= send_result;
-                    break;
-                }
-            }
-            else
-            {
-                if (pending_socket_io->on_send_complete != NULL)
-                {
-                    pending_socket_io->on_send_complete(pending_socket_io->callback_context, IO_SEND_OK);
-                }
-
-                free(pending_socket_io->bytes);
-                free(pending_socket_io);
-                if (singlylinkedlist_remove(socket_io_instance->pending_io_list, first_pending_io) != 0)
-                {
-                    socket_io_instance->io_state = IO_STATE_ERROR;
-                    indicate_error(socket_io_instance);
-                    LogError("Failure: unable to remove socket from list");
-                }
-            }
-
-            first_pending_io = singlylinkedlist_get_head_item(socket_io_instance->pending_io_list);
-        }
-
-        if (socket_io_instance->io_state == IO_STATE_OPEN)
-        {
-            int received = 0;
-            do
-            {
-                received = recv(socket_io_instance->socket, socket_io_instance->recv_bytes, RECEIVE_BYTES_VALUE, 0);
-                if (received > 0)
-                {
-                    if (socket_io_instance->on_bytes_received != NULL)
+                    else if (received < 0 && errno != EAGAIN)
                     {
-                        /* Explicitly ignoring here the result of the callback */
-                        (void)socket_io_instance->on_bytes_received(socket_io_instance->on_bytes_received_context, socket_io_instance->recv_bytes, received);
+                        LogError("Socketio_Failure: Receiving data from endpoint: errno=%d.", errno);
+                        indicate_error(socket_io_instance);
+                    }
+                    else if (received < 0)
+                    {
+                        clear_socket_events(socket_io_instance, SOCKET_POLLER_READABLE);
                     }
-                }
-                else if (received == 0)
-                {
-                    // Do not log error here due to this is probably the socket being closed on the other end
-                    indicate_error(socket_io_instance);
-                }
-                else if (received < 0 && errno != EAGAIN)
-                {
-                    LogError("Socketio_Failure: Receiving data from endpoint: errno=%d.", errno);
-                    indicate_error(socket_io_instance);
-                }
 
-            } while (received > 0 && socket_io_instance->io_state == IO_STATE_OPEN);
+                } while (received > 0 && socket_io_instance->io_state == IO_STATE_OPEN);
+            }
         }
     }
 }
@@ -970,6 +1323,24 @@ static void strtoup(char* str)
 }
 #endif // __APPLE__
 
+int socketio_get_send_statistics(CONCRETE_IO_HANDLE socket_io, SOCKETIO_SEND_STATISTICS* statistics)
+{
+    int result;
+
+    if ((socket_io == NULL) || (statistics == NULL))
+    {
+        LogError("Invalid argument: socket_io %p, statistics %p", socket_io, statistics);
+        result = __FAILURE__;
+    }
+    else
+    {
+        *statistics = ((SOCKET_IO_INSTANCE*)socket_io)->send_statistics;
+        result = 0;
+    }
+
+    return result;
+}
+
 int socketio_setoption(CONCRETE_IO_HANDLE socket_io, const char* optionName, const void* value)
 {
     int result;
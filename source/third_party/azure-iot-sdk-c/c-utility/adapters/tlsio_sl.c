@@ -4,6 +4,7 @@
 #include <stdlib.h>
 
 #include <errno.h>
+#include <sys/select.h>
 #include "ti/net/ssock.h"
 
 #include <stdio.h>
@@ -14,13 +15,28 @@
 #include "azure_c_shared_utility/tlsio.h"
 #include "azure_c_shared_utility/tlsio_sl.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
-#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/dns_cache.h"
 
 /* USER STEP: Flash the CA root certificate to this location */
 #define SL_SSL_CA_CERT "/cert/ms.der"
 #define SL_SSL_CERT "/cert/cert.der"
 #define SL_SSL_KEY "/cert/key.der"
 
+/* One TLS record of plaintext, so a whole record can be handed up in a single on_bytes_received */
+#ifndef TLSIO_SL_RECEIVE_BUFFER_SIZE
+#define TLSIO_SL_RECEIVE_BUFFER_SIZE 16384
+#endif
+
+#ifndef TLSIO_SL_RECEIVE_WAIT_MS
+#define TLSIO_SL_RECEIVE_WAIT_MS 0
+#endif
+
+#ifndef TLSIO_SL_CONNECT_TIMEOUT_SECONDS
+#define TLSIO_SL_CONNECT_TIMEOUT_SECONDS 10
+#endif
+
 typedef enum TLSIO_STATE_ENUM_TAG
 {
     TLSIO_STATE_NOT_OPEN,
@@ -30,6 +46,14 @@ typedef enum TLSIO_STATE_ENUM_TAG
     TLSIO_STATE_ERROR
 } TLSIO_STATE_ENUM;
 
+typedef struct PENDING_TLS_IO_TAG
+{
+    unsigned char* bytes;
+    size_t size;
+    ON_SEND_COMPLETE on_send_complete;
+    void* callback_context;
+} PENDING_TLS_IO;
+
 typedef struct TLS_IO_INSTANCE_TAG
 {
     ON_BYTES_RECEIVED on_bytes_received;
@@ -41,13 +65,22 @@ typedef struct TLS_IO_INSTANCE_TAG
     void* on_io_close_complete_context;
     void* on_io_error_context;
     TLSIO_STATE_ENUM tlsio_state;
-    ON_SEND_COMPLETE on_send_complete;
-    void* on_send_complete_callback_context;
+    SINGLYLINKEDLIST_HANDLE pending_io_list;
     TLS_Handle tls_handle;
     Ssock_Handle ssock_handle;
     char* hostname;
     int port;
     int sock;
+    bool connect_started;
+    struct sockaddr_in connect_addr;
+    time_t connect_start_time;
+    unsigned char* receive_buffer;
+    size_t receive_buffer_size;
+    unsigned int receive_wait_ms;
+    TLSIO_SL_RECEIVE_STATISTICS receive_statistics;
+    /* a callback made from tlsio_sl_dowork may destroy the io; the free is then left to the end of tlsio_sl_dowork */
+    bool is_in_dowork;
+    bool is_destroy_pending;
 } TLS_IO_INSTANCE;
 
 static const IO_INTERFACE_DESCRIPTION tlsio_sl_interface_description =
@@ -74,12 +107,17 @@ static int getErrno(int ret)
     }
 }
 
-static int init_sockaddr(struct sockaddr *addr, int port, const char *hostname)
+static bool is_would_block(int ret)
+{
+    int error = getErrno(ret);
+    return (error == SL_ERROR_BSD_EAGAIN) || (error == EAGAIN);
+}
+
+/* Resolves hostname to an address in network byte order. SimpleLink has no asynchronous resolver, so this blocks */
+static int resolve_ipv4(const char *hostname, uint32_t *ipv4)
 {
     struct hostent *dnsEntry;
-    struct sockaddr_in taddr = {0};
     struct in_addr **addr_list;
-    int ip;
 
     dnsEntry = gethostbyname(hostname);
     if (dnsEntry == NULL) {
@@ -88,12 +126,7 @@ static int init_sockaddr(struct sockaddr *addr, int port, const char *hostname)
 
     /* use the first IP address returned from DNS */
     addr_list = (struct in_addr **)dnsEntry->h_addr_list;
-    ip = (*addr_list[0]).s_addr;
-
-    taddr.sin_family = AF_INET;
-    taddr.sin_port = htons(port);
-    taddr.sin_addr.s_addr = htonl(ip);
-    *addr = *((struct sockaddr *)&taddr);
+    *ipv4 = htonl((*addr_list[0]).s_addr);
 
     return (0);
 }
@@ -104,6 +137,333 @@ OPTIONHANDLER_HANDLE tlsio_sl_retrieveoptions(CONCRETE_IO_HANDLE handle)
     return NULL;
 }
 
+static int add_pending_io(TLS_IO_INSTANCE* instance, const unsigned char* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    int result;
+    PENDING_TLS_IO* pending_tls_io = (PENDING_TLS_IO*)malloc(sizeof(PENDING_TLS_IO));
+    if (pending_tls_io == NULL)
+    {
+        LogError("Cannot allocate pending send");
+        result = __FAILURE__;
+    }
+    else
+    {
+        pending_tls_io->bytes = (unsigned char*)malloc(size);
+        if (pending_tls_io->bytes == NULL)
+        {
+            LogError("Cannot allocate %lu bytes of pending send", (unsigned long)size);
+            free(pending_tls_io);
+            result = __FAILURE__;
+        }
+        else
+        {
+            (void)memcpy(pending_tls_io->bytes, buffer, size);
+            pending_tls_io->size = size;
+            pending_tls_io->on_send_complete = on_send_complete;
+            pending_tls_io->callback_context = callback_context;
+
+            if (singlylinkedlist_add(instance->pending_io_list, pending_tls_io) == NULL)
+            {
+                LogError("Cannot add to pending send list");
+                free(pending_tls_io->bytes);
+                free(pending_tls_io);
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+/* Completes every queued send with send_result, in the order they were queued */
+static void complete_pending_ios(TLS_IO_INSTANCE* instance, IO_SEND_RESULT send_result)
+{
+    LIST_ITEM_HANDLE first_pending_io = singlylinkedlist_get_head_item(instance->pending_io_list);
+    while (first_pending_io != NULL)
+    {
+        PENDING_TLS_IO* pending_tls_io = (PENDING_TLS_IO*)singlylinkedlist_item_get_value(first_pending_io);
+        (void)singlylinkedlist_remove(instance->pending_io_list, first_pending_io);
+        if (pending_tls_io != NULL)
+        {
+            if (pending_tls_io->on_send_complete != NULL)
+            {
+                pending_tls_io->on_send_complete(pending_tls_io->callback_context, send_result);
+            }
+            free(pending_tls_io->bytes);
+            free(pending_tls_io);
+        }
+
+        first_pending_io = singlylinkedlist_get_head_item(instance->pending_io_list);
+    }
+}
+
+/* False once an upcall has closed, failed or destroyed the io */
+static bool is_still_open(TLS_IO_INSTANCE* instance)
+{
+    return (instance->tlsio_state == TLSIO_STATE_OPEN) && !instance->is_destroy_pending;
+}
+
+static void indicate_error(TLS_IO_INSTANCE* instance)
+{
+    instance->tlsio_state = TLSIO_STATE_ERROR;
+    if (instance->on_io_error != NULL)
+    {
+        instance->on_io_error(instance->on_io_error_context);
+    }
+}
+
+/* Called from tlsio_sl_send, so neither upcall may be followed by a use of the instance */
+static void indicate_partial_send_error(TLS_IO_INSTANCE* instance, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    ON_IO_ERROR on_io_error = instance->on_io_error;
+    void* on_io_error_context = instance->on_io_error_context;
+
+    instance->tlsio_state = TLSIO_STATE_ERROR;
+    if (on_io_error != NULL)
+    {
+        on_io_error(on_io_error_context);
+    }
+    if (on_send_complete != NULL)
+    {
+        on_send_complete(callback_context, IO_SEND_ERROR);
+    }
+}
+
+/* Writes as much of buffer as the socket takes without blocking; a full socket is not an error */
+static int send_nonblocking(TLS_IO_INSTANCE* instance, const unsigned char* buffer, size_t size, size_t* sent)
+{
+    int result = 0;
+
+    *sent = 0;
+    while (*sent < size)
+    {
+        int send_result = send(instance->sock, buffer + *sent, size - *sent, 0);
+        if (send_result > 0)
+        {
+            *sent += (size_t)send_result;
+        }
+        else
+        {
+            if ((send_result < 0) && !is_would_block(send_result))
+            {
+                LogError("send failed: %d", getErrno(send_result));
+                result = __FAILURE__;
+            }
+            break;
+        }
+    }
+
+    return result;
+}
+
+/* Sends queued bytes in order until the socket is full or an on_send_complete closes the io */
+static void send_pending_ios(TLS_IO_INSTANCE* instance)
+{
+    LIST_ITEM_HANDLE first_pending_io = singlylinkedlist_get_head_item(instance->pending_io_list);
+    while (first_pending_io != NULL)
+    {
+        PENDING_TLS_IO* pending_tls_io = (PENDING_TLS_IO*)singlylinkedlist_item_get_value(first_pending_io);
+        size_t sent;
+
+        if (pending_tls_io == NULL)
+        {
+            LogError("NULL pending send");
+            indicate_error(instance);
+            break;
+        }
+        else if (send_nonblocking(instance, pending_tls_io->bytes, pending_tls_io->size, &sent) != 0)
+        {
+            ON_SEND_COMPLETE on_send_complete = pending_tls_io->on_send_complete;
+            void* callback_context = pending_tls_io->callback_context;
+
+            (void)singlylinkedlist_remove(instance->pending_io_list, first_pending_io);
+            free(pending_tls_io->bytes);
+            free(pending_tls_io);
+
+            /* in error before the upcall, so a close from on_send_complete is not followed by on_io_error */
+            instance->tlsio_state = TLSIO_STATE_ERROR;
+            if (on_send_complete != NULL)
+            {
+                on_send_complete(callback_context, IO_SEND_ERROR);
+            }
+            if ((instance->tlsio_state == TLSIO_STATE_ERROR) && !instance->is_destroy_pending)
+            {
+                indicate_error(instance);
+            }
+            break;
+        }
+        else if (sent < pending_tls_io->size)
+        {
+            /* socket is full, pick up from here on the next dowork */
+            (void)memmove(pending_tls_io->bytes, pending_tls_io->bytes + sent, pending_tls_io->size - sent);
+            pending_tls_io->size -= sent;
+            break;
+        }
+        else
+        {
+            ON_SEND_COMPLETE on_send_complete = pending_tls_io->on_send_complete;
+            void* callback_context = pending_tls_io->callback_context;
+
+            (void)singlylinkedlist_remove(instance->pending_io_list, first_pending_io);
+            free(pending_tls_io->bytes);
+            free(pending_tls_io);
+
+            if (on_send_complete != NULL)
+            {
+                on_send_complete(callback_context, IO_SEND_OK);
+            }
+            if (!is_still_open(instance))
+            {
+                break;
+            }
+        }
+
+        first_pending_io = singlylinkedlist_get_head_item(instance->pending_io_list);
+    }
+}
+
+static void indicate_open_complete(TLS_IO_INSTANCE* instance, IO_OPEN_RESULT open_result)
+{
+    if (open_result == IO_OPEN_OK)
+    {
+        instance->tlsio_state = TLSIO_STATE_OPEN;
+    }
+    else
+    {
+        if (instance->connect_started)
+        {
+            Ssock_delete(&instance->ssock_handle);
+            close(instance->sock);
+        }
+        instance->tlsio_state = TLSIO_STATE_NOT_OPEN;
+    }
+    instance->connect_started = false;
+
+    if (instance->on_io_open_complete != NULL)
+    {
+        instance->on_io_open_complete(instance->on_io_open_complete_context, open_result);
+    }
+}
+
+/* Creates the secure socket in non-blocking mode; poll_connect drives the connect and handshake */
+static int start_connect(TLS_IO_INSTANCE* instance, uint32_t ipv4)
+{
+    int result;
+    int ret;
+
+    instance->sock = socket(AF_INET, SOCK_STREAM, SL_SEC_SOCKET);
+    if (instance->sock < 0)
+    {
+        LogError("Cannot open socket");
+        result = __FAILURE__;
+    }
+    else if ((instance->ssock_handle = Ssock_create(instance->sock)) == NULL)
+    {
+        LogError("Cannot create ssock");
+        close(instance->sock);
+        result = __FAILURE__;
+    }
+    else if ((ret = Ssock_startTLS(instance->ssock_handle, instance->tls_handle)) < 0)
+    {
+        LogError("Cannot start ssock TLS: %d", ret);
+        Ssock_delete(&instance->ssock_handle);
+        close(instance->sock);
+        result = __FAILURE__;
+    }
+    else
+    {
+        SlSockNonblocking_t blocking;
+        blocking.NonBlockingEnabled = 1;
+        setsockopt(instance->sock, SOL_SOCKET,
+                SO_NONBLOCKING, &blocking,
+                sizeof(blocking));
+
+        memset(&instance->connect_addr, 0, sizeof(instance->connect_addr));
+        instance->connect_addr.sin_family = AF_INET;
+        instance->connect_addr.sin_port = htons(instance->port);
+        instance->connect_addr.sin_addr.s_addr = ipv4;
+        instance->connect_start_time = get_time(NULL);
+        instance->connect_started = true;
+        result = 0;
+    }
+
+    return result;
+}
+
+/* A non-blocking SimpleLink connect reports EALREADY until the TCP connect and TLS handshake are done */
+static void poll_connect(TLS_IO_INSTANCE* instance)
+{
+    int ret = connect(instance->sock, (struct sockaddr *)&instance->connect_addr,
+                      sizeof(struct sockaddr_in));
+    int error = (ret < 0) ? getErrno(ret) : 0;
+
+    /*
+     *  SL returns unknown root CA error code if the CA certificate
+     *  is not found in its certificate store. This is a warning
+     *  code and not an error. So this error code is being ignored
+     *  till a better alternative is found.
+     */
+    if ((ret >= 0) || (error == SL_ERROR_BSD_ESECUNKNOWNROOTCA))
+    {
+        indicate_open_complete(instance, IO_OPEN_OK);
+    }
+    else if ((error == SL_ERROR_BSD_EALREADY) &&
+             (get_difftime(get_time(NULL), instance->connect_start_time) < TLSIO_SL_CONNECT_TIMEOUT_SECONDS))
+    {
+        /* still connecting, try again on the next dowork */
+    }
+    else
+    {
+        LogError("Cannot connect: %d", error);
+        /* the cached address may be stale; resolve again on the next open */
+        dns_cache_remove(instance->hostname);
+        indicate_open_complete(instance, IO_OPEN_ERROR);
+    }
+}
+
+static void open_dowork(TLS_IO_INSTANCE* instance)
+{
+    if (instance->connect_started)
+    {
+        poll_connect(instance);
+    }
+    else
+    {
+        uint32_t ipv4;
+
+        /* a reconnect to a recently resolved host skips DNS entirely */
+        if (dns_cache_get_ipv4(instance->hostname, &ipv4) != 0)
+        {
+            if (resolve_ipv4(instance->hostname, &ipv4) != 0)
+            {
+                ipv4 = 0;
+            }
+            else
+            {
+                (void)dns_cache_add_ipv4(instance->hostname, ipv4);
+            }
+        }
+
+        if (ipv4 == 0)
+        {
+            LogError("Cannot resolve hostname");
+            indicate_open_complete(instance, IO_OPEN_ERROR);
+        }
+        else if (start_connect(instance, ipv4) != 0)
+        {
+            indicate_open_complete(instance, IO_OPEN_ERROR);
+        }
+        else
+        {
+            poll_connect(instance);
+        }
+    }
+}
+
 CONCRETE_IO_HANDLE tlsio_sl_create(void* io_create_parameters)
 {
     TLSIO_CONFIG* tls_io_config = io_create_parameters;
@@ -154,6 +514,35 @@ CONCRETE_IO_HANDLE tlsio_sl_create(void* io_create_parameters)
                 return NULL;
             }
 
+            result->receive_buffer_size = TLSIO_SL_RECEIVE_BUFFER_SIZE;
+            result->receive_buffer = (unsigned char*)malloc(result->receive_buffer_size);
+            if (result->receive_buffer == NULL)
+            {
+                LogError("Cannot allocate %lu byte receive buffer", (unsigned long)result->receive_buffer_size);
+                TLS_delete(result->tls_handle);
+                if (result->hostname != NULL)
+                {
+                    free(result->hostname);
+                }
+                free(result);
+                return NULL;
+            }
+            result->receive_wait_ms = TLSIO_SL_RECEIVE_WAIT_MS;
+
+            result->pending_io_list = singlylinkedlist_create();
+            if (result->pending_io_list == NULL)
+            {
+                LogError("Cannot create pending send list");
+                free(result->receive_buffer);
+                TLS_delete(result->tls_handle);
+                if (result->hostname != NULL)
+                {
+                    free(result->hostname);
+                }
+                free(result);
+                return NULL;
+            }
+
             result->port = tls_io_config->port;
 
             result->on_bytes_received = NULL;
@@ -168,9 +557,6 @@ CONCRETE_IO_HANDLE tlsio_sl_create(void* io_create_parameters)
             result->on_io_error = NULL;
             result->on_io_error_context = NULL;
 
-            result->on_send_complete = NULL;
-            result->on_send_complete_callback_context = NULL;
-
             result->tlsio_state = TLSIO_STATE_NOT_OPEN;
         }
     }
@@ -178,6 +564,29 @@ CONCRETE_IO_HANDLE tlsio_sl_create(void* io_create_parameters)
     return result;
 }
 
+static void destroy_instance(TLS_IO_INSTANCE* tls_io_instance)
+{
+    if ((tls_io_instance->tlsio_state == TLSIO_STATE_OPENING) ||
+        (tls_io_instance->tlsio_state == TLSIO_STATE_OPEN) ||
+        (tls_io_instance->tlsio_state == TLSIO_STATE_CLOSING))
+    {
+        LogError("TLS destroyed with a SSL connection still active.");
+    }
+    if (tls_io_instance->connect_started)
+    {
+        Ssock_delete(&tls_io_instance->ssock_handle);
+        close(tls_io_instance->sock);
+    }
+    if (tls_io_instance->hostname != NULL)
+    {
+        free(tls_io_instance->hostname);
+    }
+    complete_pending_ios(tls_io_instance, IO_SEND_CANCELLED);
+    singlylinkedlist_destroy(tls_io_instance->pending_io_list);
+    free(tls_io_instance->receive_buffer);
+    free(tls_io_instance);
+}
+
 void tlsio_sl_destroy(CONCRETE_IO_HANDLE tls_io)
 {
     TLS_IO_INSTANCE* tls_io_instance = (TLS_IO_INSTANCE*)tls_io;
@@ -186,19 +595,14 @@ void tlsio_sl_destroy(CONCRETE_IO_HANDLE tls_io)
     {
         LogError("NULL tls_io");
     }
+    else if (tls_io_instance->is_in_dowork)
+    {
+        /* called back from tlsio_sl_dowork, which still uses the instance; it frees it before returning */
+        tls_io_instance->is_destroy_pending = true;
+    }
     else
     {
-        if ((tls_io_instance->tlsio_state == TLSIO_STATE_OPENING) ||
-            (tls_io_instance->tlsio_state == TLSIO_STATE_OPEN) ||
-            (tls_io_instance->tlsio_state == TLSIO_STATE_CLOSING))
-        {
-            LogError("TLS destroyed with a SSL connection still active.");
-        }
-        if (tls_io_instance->hostname != NULL)
-        {
-            free(tls_io_instance->hostname);
-        }
-        free(tls_io_instance);
+        destroy_instance(tls_io_instance);
     }
 }
 
@@ -219,7 +623,6 @@ int tlsio_sl_open(CONCRETE_IO_HANDLE tls_io,
     }
     else
     {
-        int ret;
         TLS_IO_INSTANCE* instance = (TLS_IO_INSTANCE*)tls_io;
 
         if (instance->tlsio_state != TLSIO_STATE_NOT_OPEN)
@@ -238,90 +641,10 @@ int tlsio_sl_open(CONCRETE_IO_HANDLE tls_io,
             instance->on_io_error = on_io_error;
             instance->on_io_error_context = on_io_error_context;
 
+            /* resolving, connecting and the handshake are advanced from tlsio_sl_dowork, which reports the open result */
             instance->tlsio_state = TLSIO_STATE_OPENING;
-
-            struct sockaddr sa;
-            ret = init_sockaddr(&sa, instance->port, instance->hostname);
-            if (ret != 0)
-            {
-                LogError("Cannot resolve hostname");
-                instance->tlsio_state = TLSIO_STATE_NOT_OPEN;
-                result = __FAILURE__;
-            }
-            else
-            {
-                instance->sock = socket(sa.sa_family, SOCK_STREAM,
-                                        SL_SEC_SOCKET);
-                if (socket >= 0)
-                {
-                    instance->ssock_handle = Ssock_create(instance->sock);
-                    if (instance->ssock_handle == NULL)
-                    {
-                        LogError("Cannot create ssock");
-                        instance->tlsio_state = TLSIO_STATE_NOT_OPEN;
-                        result = __FAILURE__;
-                        close(instance->sock);
-                    }
-                    else
-                    {
-                        ret = Ssock_startTLS(instance->ssock_handle,
-                                             instance->tls_handle);
-                        if (ret < 0)
-                        {
-                            LogError("Cannot start ssock TLS");
-                            instance->tlsio_state = TLSIO_STATE_NOT_OPEN;
-                            result = __FAILURE__;
-                            Ssock_delete(&instance->ssock_handle);
-                            close(instance->sock);
-                        }
-                        else
-                        {
-                            ret = connect(instance->sock, &sa,
-                                          sizeof(struct sockaddr_in));
-                            /*
-                             *  SL returns unknown root CA error code if the CA certificate
-                             *  is not found in its certificate store. This is a warning
-                             *  code and not an error. So this error code is being ignored
-                             *  till a better alternative is found.
-                             */
-                            if ((ret < 0) && (getErrno(ret) != SL_ERROR_BSD_ESECUNKNOWNROOTCA))
-                            {
-                                LogError("Cannot connect");
-                                instance->tlsio_state = TLSIO_STATE_NOT_OPEN;
-                                result = __FAILURE__;
-                                Ssock_delete(&instance->ssock_handle);
-                                close(instance->sock);
-
-                            }
-                            /* setup for nonblocking */
-                            SlSockNonblocking_t blocking;
-                            blocking.NonBlockingEnabled = 1;
-                            setsockopt(instance->sock, SOL_SOCKET,
-                                    SO_NONBLOCKING, &blocking,
-                                    sizeof(blocking));
-                        }
-                    }
-                }
-                else
-                {
-                    LogError("Cannot open socket");
-                    instance->tlsio_state = TLSIO_STATE_NOT_OPEN;
-                    result = __FAILURE__;
-                }
-            }
-
-            IO_OPEN_RESULT oresult = result == __FAILURE__ ? IO_OPEN_ERROR :
-                                                             IO_OPEN_OK;
-            instance->tlsio_state = TLSIO_STATE_OPEN;
-            instance->on_io_open_complete(instance->on_io_open_complete_context,
-                                          oresult);
-            if (oresult == IO_OPEN_ERROR)
-            {
-                if (on_io_error != NULL)
-                {
-                    (void)on_io_error(on_io_error_context);
-                }
-            }
+            instance->connect_started = false;
+            memset(&instance->receive_statistics, 0, sizeof(instance->receive_statistics));
         }
     }
 
@@ -349,12 +672,21 @@ int tlsio_sl_close(CONCRETE_IO_HANDLE tls_io,
         }
         else
         {
+            if (instance->tlsio_state == TLSIO_STATE_OPENING)
+            {
+                indicate_open_complete(instance, IO_OPEN_CANCELLED);
+            }
+            else
+            {
+                Ssock_delete(&instance->ssock_handle);
+                close(instance->sock);
+            }
+
             instance->tlsio_state = TLSIO_STATE_CLOSING;
             instance->on_io_close_complete = on_io_close_complete;
             instance->on_io_close_complete_context = callback_context;
 
-            Ssock_delete(&instance->ssock_handle);
-            close(instance->sock);
+            complete_pending_ios(instance, IO_SEND_CANCELLED);
 
             instance->tlsio_state = TLSIO_STATE_NOT_OPEN;
             instance->on_io_close_complete(
@@ -370,8 +702,9 @@ int tlsio_sl_send(CONCRETE_IO_HANDLE tls_io, const void* buffer, size_t size,
 {
     int result;
 
-    if (tls_io == NULL)
+    if ((tls_io == NULL) || (buffer == NULL) || (size == 0))
     {
+        LogError("Invalid argument: tls_io %p, buffer %p, size %lu", tls_io, buffer, (unsigned long)size);
         result = __FAILURE__;
     }
     else
@@ -382,66 +715,159 @@ int tlsio_sl_send(CONCRETE_IO_HANDLE tls_io, const void* buffer, size_t size,
         {
             result = __FAILURE__;
         }
+        else if (singlylinkedlist_get_head_item(instance->pending_io_list) != NULL)
+        {
+            /* keep the order: this packet goes out from tlsio_sl_dowork after the ones already waiting */
+            if (add_pending_io(instance, (const unsigned char*)buffer, size, on_send_complete, callback_context) != 0)
+            {
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = 0;
+            }
+        }
         else
         {
-            const char* buf = (const char*)buffer;
-            instance->on_send_complete = on_send_complete;
-            instance->on_send_complete_callback_context = callback_context;
+            size_t sent;
+            int send_result = send_nonblocking(instance, (const unsigned char*)buffer, size, &sent);
 
-            result = 0;
-            while (size)
+            if ((send_result == 0) && (sent == size))
             {
-                int res = send(instance->sock, buf, size, 0);
-                if (res < 0)
-                {
-                    result = __FAILURE__;
-                    break;
-                }
-                else if (size < res)
+                if (on_send_complete != NULL)
                 {
-                    /* no more space left, lets wait for more to become
-                     * available and try again.
-                     */
-                    ThreadAPI_Sleep(10);
+                    on_send_complete(callback_context, IO_SEND_OK);
                 }
-                size -= res;
-                buf += res;
+                result = 0;
+            }
+            else if ((send_result != 0) && (sent == 0))
+            {
+                /* nothing reached the socket, the caller still owns the packet */
+                result = __FAILURE__;
+            }
+            /* only the unsent remainder is queued; tlsio_sl_dowork sends it and calls on_send_complete */
+            else if ((send_result == 0) &&
+                (add_pending_io(instance, (const unsigned char*)buffer + sent, size - sent, on_send_complete, callback_context) == 0))
+            {
+                result = 0;
+            }
+            else if (sent == 0)
+            {
+                result = __FAILURE__;
+            }
+            else
+            {
+                /* part of the packet is already on the wire, so the stream is broken: fail the io, not the call */
+                indicate_partial_send_error(instance, on_send_complete, callback_context);
+                result = 0;
             }
-            IO_SEND_RESULT oresult = result == __FAILURE__ ? IO_SEND_ERROR :
-                                                             IO_SEND_OK;
-            instance->on_send_complete(
-                          instance->on_send_complete_callback_context, oresult);
         }
     }
 
     return result;
 }
 
+static void indicate_received_bytes(TLS_IO_INSTANCE* tls_io_instance, size_t size)
+{
+    tls_io_instance->receive_statistics.upcalls++;
+    tls_io_instance->receive_statistics.bytes_received += size;
+    if (size > tls_io_instance->receive_statistics.largest_upcall)
+    {
+        tls_io_instance->receive_statistics.largest_upcall = size;
+    }
+
+    if (tls_io_instance->on_bytes_received != NULL)
+    {
+        tls_io_instance->on_bytes_received(tls_io_instance->on_bytes_received_context,
+                                           tls_io_instance->receive_buffer, size);
+    }
+}
+
+static bool wait_until_readable(TLS_IO_INSTANCE* tls_io_instance)
+{
+    bool result;
+
+    if (tls_io_instance->receive_wait_ms == 0)
+    {
+        /* no readiness wait configured, a non-blocking receive tells whether there is data */
+        result = true;
+    }
+    else
+    {
+        fd_set read_fds;
+        struct timeval timeout;
+
+        FD_ZERO(&read_fds);
+        FD_SET(tls_io_instance->sock, &read_fds);
+        timeout.tv_sec = tls_io_instance->receive_wait_ms / 1000;
+        timeout.tv_usec = (tls_io_instance->receive_wait_ms % 1000) * 1000;
+
+        tls_io_instance->receive_statistics.readiness_waits++;
+        result = (select(tls_io_instance->sock + 1, &read_fds, NULL, NULL, &timeout) > 0) &&
+            FD_ISSET(tls_io_instance->sock, &read_fds);
+    }
+
+    return result;
+}
+
 void tlsio_sl_dowork(CONCRETE_IO_HANDLE tls_io)
 {
     if (tls_io != NULL)
     {
         TLS_IO_INSTANCE* tls_io_instance = (TLS_IO_INSTANCE*)tls_io;
 
-        if ((tls_io_instance->tlsio_state != TLSIO_STATE_NOT_OPEN) &&
-            (tls_io_instance->tlsio_state != TLSIO_STATE_ERROR))
+        tls_io_instance->is_in_dowork = true;
+
+        if (tls_io_instance->tlsio_state == TLSIO_STATE_OPENING)
+        {
+            open_dowork(tls_io_instance);
+        }
+
+        if (is_still_open(tls_io_instance))
+        {
+            send_pending_ios(tls_io_instance);
+        }
+
+        if (is_still_open(tls_io_instance) &&
+            wait_until_readable(tls_io_instance))
         {
-            unsigned char buffer[64];
-            int rcv_bytes = 1;
+            size_t filled = 0;
+            int rcv_bytes;
 
-            while (rcv_bytes > 0)
+            /* drain the socket, filling the whole buffer before each upcall; stop as soon as an upcall closes the io */
+            do
             {
-                rcv_bytes = Ssock_recv(tls_io_instance->ssock_handle, buffer, sizeof(buffer), 0);
+                rcv_bytes = Ssock_recv(tls_io_instance->ssock_handle,
+                                       tls_io_instance->receive_buffer + filled,
+                                       tls_io_instance->receive_buffer_size - filled, 0);
+                tls_io_instance->receive_statistics.receive_calls++;
                 if (rcv_bytes > 0)
                 {
-                    if (tls_io_instance->on_bytes_received != NULL)
+                    filled += (size_t)rcv_bytes;
+                    if (filled == tls_io_instance->receive_buffer_size)
                     {
-                        tls_io_instance->on_bytes_received(
-                                     tls_io_instance->on_bytes_received_context,
-                                     buffer, rcv_bytes);
+                        indicate_received_bytes(tls_io_instance, filled);
+                        filled = 0;
                     }
                 }
+            } while ((rcv_bytes > 0) && is_still_open(tls_io_instance));
+
+            if ((filled > 0) && is_still_open(tls_io_instance))
+            {
+                indicate_received_bytes(tls_io_instance, filled);
             }
+
+            if ((rcv_bytes < 0) && !is_would_block(rcv_bytes) && is_still_open(tls_io_instance))
+            {
+                LogError("Ssock_recv failed: %d", getErrno(rcv_bytes));
+                indicate_error(tls_io_instance);
+            }
+        }
+
+        tls_io_instance->is_in_dowork = false;
+        if (tls_io_instance->is_destroy_pending)
+        {
+            destroy_instance(tls_io_instance);
         }
     }
 }
@@ -464,5 +890,61 @@ int tlsio_sl_setoption(CONCRETE_IO_HANDLE tls_io, const char* optionName, const
     {
         result = TLS_setCertFile(inst->tls_handle, TLS_CERT_TYPE_KEY, TLS_CERT_FORMAT_DER, value);
     }
+    else if (strcmp(OPTION_TLSIO_SL_RECEIVE_BUFFER_SIZE, optionName) == 0)
+    {
+        size_t size = (value == NULL) ? 0 : *(const size_t*)value;
+        unsigned char* buffer;
+
+        if (size == 0)
+        {
+            LogError("Invalid receive buffer size");
+            result = __FAILURE__;
+        }
+        else if (inst->tlsio_state != TLSIO_STATE_NOT_OPEN)
+        {
+            LogError("Receive buffer size cannot change while open");
+            result = __FAILURE__;
+        }
+        else if ((buffer = (unsigned char*)realloc(inst->receive_buffer, size)) == NULL)
+        {
+            LogError("Cannot allocate %lu byte receive buffer", (unsigned long)size);
+            result = __FAILURE__;
+        }
+        else
+        {
+            inst->receive_buffer = buffer;
+            inst->receive_buffer_size = size;
+        }
+    }
+    else if (strcmp(OPTION_TLSIO_SL_RECEIVE_WAIT_MS, optionName) == 0)
+    {
+        if (value == NULL)
+        {
+            LogError("NULL receive wait");
+            result = __FAILURE__;
+        }
+        else
+        {
+            inst->receive_wait_ms = *(const unsigned int*)value;
+        }
+    }
+    return result;
+}
+
+int tlsio_sl_get_receive_statistics(CONCRETE_IO_HANDLE tls_io, TLSIO_SL_RECEIVE_STATISTICS* statistics)
+{
+    int result;
+
+    if ((tls_io == NULL) || (statistics == NULL))
+    {
+        LogError("Invalid argument: tls_io %p, statistics %p", tls_io, statistics);
+        result = __FAILURE__;
+    }
+    else
+    {
+        *statistics = ((TLS_IO_INSTANCE*)tls_io)->receive_statistics;
+        result = 0;
+    }
+
     return result;
 }
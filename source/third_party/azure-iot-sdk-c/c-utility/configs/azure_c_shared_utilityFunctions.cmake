@@ -580,7 +580,7 @@ function(set_platform_files c_shared_dir)
             set(PLATFORM_C_FILE ${c_shared_dir}/adapters/platform_linux.c PARENT_SCOPE)
         endif()
         if (${use_socketio})
-            set(SOCKETIO_C_FILE ${c_shared_dir}/adapters/socketio_berkeley.c PARENT_SCOPE)
+            set(SOCKETIO_C_FILE ${c_shared_dir}/adapters/socketio_berkeley.c ${c_shared_dir}/pal/dns_async.c ${c_shared_dir}/pal/socket_poller.c PARENT_SCOPE)
         endif()
         set(THREAD_C_FILE ${c_shared_dir}/adapters/threadapi_pthreads.c PARENT_SCOPE)
         set(TICKCOUTER_C_FILE ${c_shared_dir}/adapters/tickcounter_linux.c PARENT_SCOPE)
@@ -76,6 +76,39 @@ MOCKABLE_FUNCTION(, STRING_HANDLE, Base64_Encode_Bytes, const unsigned char*, so
  */
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, Base64_Decoder, const char*, source);
 
+/** @brief	Size of the buffer @c Base64_EncodeInto needs for @p size bytes, including the terminating '\0'. */
+#define BASE64_ENCODED_SIZE(size) ((((size) + 2) / 3) * 4 + 1)
+
+/** @brief	Largest count of bytes @c Base64_DecodeInto can produce from @p length base64 characters. */
+#define BASE64_DECODED_MAX_SIZE(length) (((length) / 4) * 3)
+
+/**
+ * @brief	Base64 encodes @p size bytes from @p source into the caller's buffer @p destination.
+ *
+ * @param	source         	The bytes to encode.
+ * @param	size           	The count of bytes to encode.
+ * @param	destination    	Receives the encoding, terminated by '\0'.
+ * @param	destinationSize	The size of @p destination, at least @c BASE64_ENCODED_SIZE(size).
+ *
+ * @return	0 on success, a non-zero value if an argument is NULL or @p destination is too small.
+ */
+MOCKABLE_FUNCTION(, int, Base64_EncodeInto, const unsigned char*, source, size_t, size, char*, destination, size_t, destinationSize);
+
+/**
+ * @brief	Base64 decodes @p sourceLength characters from @p source into the caller's buffer @p destination.
+ *
+ * @param	source         	The base64 characters; they need not be '\0' terminated.
+ * @param	sourceLength   	The count of characters, a multiple of 4.
+ * @param	destination    	Receives the decoded bytes.
+ * @param	destinationSize	The size of @p destination; @c BASE64_DECODED_MAX_SIZE(sourceLength) is always enough.
+ * @param	decodedSize    	Receives the count of bytes written to @p destination.
+ *
+ * 			Unlike @c Base64_Decoder, any character that is not base64 or final padding fails the call.
+ *
+ * @return	0 on success, a non-zero value otherwise.
+ */
+MOCKABLE_FUNCTION(, int, Base64_DecodeInto, const char*, source, size_t, sourceLength, unsigned char*, destination, size_t, destinationSize, size_t*, decodedSize);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,73 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file dns_cache.h
+*	@brief	Process wide cache of resolved IPv4 addresses, so IO adapters can reconnect without a DNS lookup.
+*/
+
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#ifdef __cplusplus
+#include <cstdint>
+extern "C" {
+#else
+#include <stdint.h>
+#endif
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+/** @brief	Number of host names the cache remembers; the least recently resolved one is replaced when full. */
+#ifndef DNS_CACHE_MAX_ENTRIES
+#define DNS_CACHE_MAX_ENTRIES 4
+#endif
+
+/** @brief	Seconds an address stays valid unless changed with @c dns_cache_set_ttl. */
+#ifndef DNS_CACHE_DEFAULT_TTL_SECONDS
+#define DNS_CACHE_DEFAULT_TTL_SECONDS 300
+#endif
+
+/**
+ * @brief	Creates the lock guarding the cache. Called from @c platform_init; calls nest.
+ *
+ * 			Until the cache is initialized every lookup misses and every add is dropped.
+ *
+ * @return	0 on success, a non-zero value otherwise.
+ */
+MOCKABLE_FUNCTION(, int, dns_cache_init);
+
+/** @brief	Undoes one @c dns_cache_init; the last call empties the cache and frees the lock. */
+MOCKABLE_FUNCTION(, void, dns_cache_deinit);
+
+/**
+ * @brief	Sets how many seconds addresses added from now on stay valid; 0 stops caching.
+ */
+MOCKABLE_FUNCTION(, void, dns_cache_set_ttl, uint32_t, ttl_seconds);
+
+/**
+ * @brief	Looks up @p hostname.
+ *
+ * @param	hostname	The host name to look up, compared case-insensitively.
+ * @param	ipv4    	Receives the cached address, in network byte order, on a hit.
+ *
+ * @return	0 when an unexpired address was found, a non-zero value otherwise.
+ */
+MOCKABLE_FUNCTION(, int, dns_cache_get_ipv4, const char*, hostname, uint32_t*, ipv4);
+
+/**
+ * @brief	Remembers that @p hostname resolved to @p ipv4, replacing any previous address.
+ *
+ * @return	0 on success, a non-zero value otherwise.
+ */
+MOCKABLE_FUNCTION(, int, dns_cache_add_ipv4, const char*, hostname, uint32_t, ipv4);
+
+/**
+ * @brief	Forgets @p hostname, for instance after connecting to its cached address failed.
+ */
+MOCKABLE_FUNCTION(, void, dns_cache_remove, const char*, hostname);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DNS_CACHE_H */
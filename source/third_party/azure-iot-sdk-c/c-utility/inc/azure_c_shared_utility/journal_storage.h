@@ -0,0 +1,48 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef JOURNAL_STORAGE_H
+#define JOURNAL_STORAGE_H
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif /* __cplusplus */
+
+/* A journal storage keeps numbered segments (0, 1, ...), each one a flat run of bytes of at most the size
+   given when it was started. Only one segment is written at a time and it is only ever appended to; once
+   sealed, a segment is read back at any offset until it is removed. Segments are never reopened for writing,
+   which is what lets the same interface sit on a plain file system and on SimpleLink FS. */
+typedef void* CONCRETE_JOURNAL_STORAGE_HANDLE;
+
+/* parameters is backend specific; both backends in this tree take a const char* prefix for the segment names */
+typedef CONCRETE_JOURNAL_STORAGE_HANDLE(*JOURNAL_STORAGE_CREATE)(const void* parameters);
+typedef void(*JOURNAL_STORAGE_DESTROY)(CONCRETE_JOURNAL_STORAGE_HANDLE storage);
+/* replaces the segment (if any) with an empty one of at most max_size bytes and makes it the one being written */
+typedef int(*JOURNAL_STORAGE_START_SEGMENT)(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t max_size);
+/* appends to the segment being written; the bytes shall be durable once this returns 0 */
+typedef int(*JOURNAL_STORAGE_APPEND)(CONCRETE_JOURNAL_STORAGE_HANDLE storage, const unsigned char* bytes, size_t size);
+/* closes the segment being written, after which it can only be read */
+typedef int(*JOURNAL_STORAGE_SEAL_SEGMENT)(CONCRETE_JOURNAL_STORAGE_HANDLE storage);
+/* copies out at most size bytes from offset of a sealed segment; a segment that does not exist reads as empty */
+typedef int(*JOURNAL_STORAGE_READ)(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t offset, unsigned char* buffer, size_t size, size_t* bytes_read);
+typedef int(*JOURNAL_STORAGE_REMOVE_SEGMENT)(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment);
+
+typedef struct JOURNAL_STORAGE_INTERFACE_DESCRIPTION_TAG
+{
+    JOURNAL_STORAGE_CREATE concrete_storage_create;
+    JOURNAL_STORAGE_DESTROY concrete_storage_destroy;
+    JOURNAL_STORAGE_START_SEGMENT concrete_storage_start_segment;
+    JOURNAL_STORAGE_APPEND concrete_storage_append;
+    JOURNAL_STORAGE_SEAL_SEGMENT concrete_storage_seal_segment;
+    JOURNAL_STORAGE_READ concrete_storage_read;
+    JOURNAL_STORAGE_REMOVE_SEGMENT concrete_storage_remove_segment;
+} JOURNAL_STORAGE_INTERFACE_DESCRIPTION;
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JOURNAL_STORAGE_H */
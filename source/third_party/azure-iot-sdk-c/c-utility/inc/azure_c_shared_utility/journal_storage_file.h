@@ -0,0 +1,29 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef JOURNAL_STORAGE_FILE_H
+#define JOURNAL_STORAGE_FILE_H
+
+#include "azure_c_shared_utility/journal_storage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Segments are the files <prefix><segment> (e.g. "/var/lib/telemetry/journal3" for the prefix
+   "/var/lib/telemetry/journal"); the directory has to exist. Appends are fdatasync'ed. */
+extern CONCRETE_JOURNAL_STORAGE_HANDLE journal_storage_file_create(const void* parameters);
+extern void journal_storage_file_destroy(CONCRETE_JOURNAL_STORAGE_HANDLE storage);
+extern int journal_storage_file_start_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t max_size);
+extern int journal_storage_file_append(CONCRETE_JOURNAL_STORAGE_HANDLE storage, const unsigned char* bytes, size_t size);
+extern int journal_storage_file_seal_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage);
+extern int journal_storage_file_read(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t offset, unsigned char* buffer, size_t size, size_t* bytes_read);
+extern int journal_storage_file_remove_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment);
+
+extern const JOURNAL_STORAGE_INTERFACE_DESCRIPTION* journal_storage_file_get_interface_description(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* JOURNAL_STORAGE_FILE_H */
@@ -55,6 +55,29 @@ typedef int (*MAP_FILTER_CALLBACK)(const char* mapProperty, const char* mapValue
  */
 MOCKABLE_FUNCTION(, MAP_HANDLE, Map_Create, MAP_FILTER_CALLBACK, mapFilterFunc);
 
+/**
+ * @brief   Returns how many bytes of storage ::Map_CreateInPlace needs for the
+ *          map and @p inlineEntries pairs, strings not included.
+ */
+MOCKABLE_FUNCTION(, size_t, Map_GetInPlaceSize, size_t, inlineEntries);
+
+/**
+ * @brief   Creates a new, empty map inside @p storage. The first
+ *          @p inlineEntries pairs, and as many keys and values as fit in the
+ *          rest of @p storage, are kept there without allocating; past that
+ *          the map allocates like one made by ::Map_Create. ::Map_Destroy
+ *          frees what was allocated but not @p storage, which must outlive
+ *          the map.
+ *
+ * @param   mapFilterFunc   Same as for ::Map_Create.
+ * @param   storage         Pointer aligned memory owned by the caller.
+ * @param   storageSize     At least ::Map_GetInPlaceSize of @p inlineEntries.
+ * @param   inlineEntries   The number of pairs the map holds in @p storage.
+ *
+ * @return  A valid @c MAP_HANDLE or @c NULL in case an error occurs.
+ */
+MOCKABLE_FUNCTION(, MAP_HANDLE, Map_CreateInPlace, MAP_FILTER_CALLBACK, mapFilterFunc, void*, storage, size_t, storageSize, size_t, inlineEntries);
+
 /**
  * @brief   Release all resources associated with the map.
  *
@@ -16,6 +16,15 @@ extern "C" {
     MOCKABLE_FUNCTION(, STRING_HANDLE, SASToken_Create, STRING_HANDLE, key, STRING_HANDLE, scope, STRING_HANDLE, keyName, size_t, expiry);
     MOCKABLE_FUNCTION(, STRING_HANDLE, SASToken_CreateString, const char*, key, const char*, scope, const char*, keyName, size_t, expiry);
 
+    /* A SAS signer decodes the key once and keeps the HMAC-SHA256 key schedule, so that every
+       token refresh only hashes scope and expiry and formats the token into a caller buffer. */
+    typedef struct SAS_SIGNER_TAG* SAS_SIGNER_HANDLE;
+
+    MOCKABLE_FUNCTION(, SAS_SIGNER_HANDLE, SASToken_CreateSigner, const char*, key);
+    MOCKABLE_FUNCTION(, void, SASToken_DestroySigner, SAS_SIGNER_HANDLE, signer);
+    MOCKABLE_FUNCTION(, size_t, SASToken_GetMaxTokenSize, const char*, scope, const char*, keyName);
+    MOCKABLE_FUNCTION(, int, SASToken_SignInto, SAS_SIGNER_HANDLE, signer, const char*, scope, const char*, keyName, size_t, expiry, char*, destination, size_t, destinationSize);
+
 #ifdef __cplusplus
 }
 #endif
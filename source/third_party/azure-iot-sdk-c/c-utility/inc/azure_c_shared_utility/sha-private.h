@@ -29,5 +29,24 @@
 
 #define SHA_Parity(x, y, z)  ((x) ^ (y) ^ (z))
 
+/*
+* Big-endian 32-bit load from a possibly unaligned address.
+* Compilers turn this into a single load and byte swap.
+*/
+#define SHA_LOAD_BE32(p)                                     \
+    ((((uint32_t)(p)[0]) << 24) | (((uint32_t)(p)[1]) << 16) | \
+     (((uint32_t)(p)[2]) << 8) | ((uint32_t)(p)[3]))
+
+/*
+* Block compression functions. SHA1ProcessBlocks and
+* SHA256ProcessBlocks dispatch to the active SHA_BACKEND
+* (sha_backend.c); the Portable variants are the C implementations
+* in sha1.c and sha224.c.
+*/
+extern void SHA1ProcessBlocks(uint32_t Intermediate_Hash[], const uint8_t *blocks, size_t block_count);
+extern void SHA1ProcessBlocksPortable(uint32_t Intermediate_Hash[], const uint8_t *blocks, size_t block_count);
+extern void SHA256ProcessBlocks(uint32_t Intermediate_Hash[], const uint8_t *blocks, size_t block_count);
+extern void SHA256ProcessBlocksPortable(uint32_t Intermediate_Hash[], const uint8_t *blocks, size_t block_count);
+
 #endif /* _SHA_PRIVATE__H */
 
@@ -32,6 +32,7 @@ extern "C"
  *              SHA-512         64 byte / 512 bit
  */
 
+#include <stddef.h>
 #include <stdint.h>
 /*
  * If you do not have the ISO standard stdint.h header file, then you
@@ -268,6 +269,32 @@ extern int hmacFinalBits(HMACContext *ctx, const uint8_t bits,
 extern int hmacResult(HMACContext *ctx,
                       uint8_t digest[USHAMaxHashSize]);
 
+/*
+ * Block compression backends for SHA-1 and SHA-224/256.
+ * A backend processes block_count consecutive 64 byte blocks into
+ * the 5 (SHA-1) or 8 (SHA-224/256) word intermediate hash, in the
+ * same word order as the Intermediate_Hash field of the contexts.
+ * A NULL entry selects the portable C code for that algorithm.
+ *
+ * By default the fastest backend built in and supported by the CPU
+ * is picked on first use (x86 SHA extensions, ARMv8 crypto
+ * extensions, or portable C). Platforms with a hardware hash engine
+ * register it with SHA_SetBackend before hashing anything;
+ * SHA_SetBackend(NULL) goes back to the automatic choice.
+ */
+typedef void (*SHA_PROCESS_BLOCKS)(uint32_t *Intermediate_Hash,
+                                   const uint8_t *blocks,
+                                   size_t block_count);
+
+typedef struct SHA_BACKEND {
+    const char *name;
+    SHA_PROCESS_BLOCKS sha1_process_blocks;
+    SHA_PROCESS_BLOCKS sha256_process_blocks;
+} SHA_BACKEND;
+
+extern const SHA_BACKEND *SHA_GetBackend(void);
+extern int SHA_SetBackend(const SHA_BACKEND *backend);
+
 
 #ifdef __cplusplus
 }
@@ -40,6 +40,13 @@ extern "C"
 
     static STATIC_VAR_UNUSED const char* const OPTION_TLS_VERSION = "tls_version";
 
+    /* bool*; when true (the default) a reconnect offers the TLS session of the previous connection;
+       the session only stays resumable if the previous connection was closed with xio_close and
+       xio_dowork was called until on_io_close_complete, so its close_notify reached the server */
+    static STATIC_VAR_UNUSED const char* const OPTION_TLS_SESSION_RESUMPTION = "tls_session_resumption";
+    /* opaque and tlsio specific; only meant to travel from xio_retrieveoptions to a new instance of the same tlsio */
+    static STATIC_VAR_UNUSED const char* const OPTION_TLS_SESSION = "tls_session";
+
 #ifdef __cplusplus
 }
 #endif
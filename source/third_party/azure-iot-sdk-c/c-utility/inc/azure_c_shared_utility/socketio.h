@@ -24,12 +24,30 @@ typedef struct SOCKETIO_CONFIG_TAG
 
 #define RECEIVE_BYTES_VALUE     64
 
+/* Send counters kept by socketio_berkeley since the last open. Sends that cannot be written at once
+   are copied into one per-socket ring and flushed with a single sendmsg per dowork, so
+   flush_calls / packets_flushed is the number of system calls spent per queued packet. */
+typedef struct SOCKETIO_SEND_STATISTICS_TAG
+{
+    size_t packets_sent;
+    size_t packets_queued;
+    size_t packets_flushed;
+    size_t flush_calls;
+    size_t queued_bytes;
+    size_t peak_queued_bytes;
+} SOCKETIO_SEND_STATISTICS;
+
+/* socketio_open returns at once; socketio_dowork resolves the host, connects without blocking and reports the
+   open result. The connect never blocks dowork, but the lookup does: pal/dns_async.c calls getaddrinfo
+   synchronously, so on a DNS cache miss the first socketio_dowork after open blocks for the whole lookup.
+   A host resolved within the dns_cache TTL skips the lookup. */
 MOCKABLE_FUNCTION(, CONCRETE_IO_HANDLE, socketio_create, void*, io_create_parameters);
 MOCKABLE_FUNCTION(, void, socketio_destroy, CONCRETE_IO_HANDLE, socket_io);
 MOCKABLE_FUNCTION(, int, socketio_open, CONCRETE_IO_HANDLE, socket_io, ON_IO_OPEN_COMPLETE, on_io_open_complete, void*, on_io_open_complete_context, ON_BYTES_RECEIVED, on_bytes_received, void*, on_bytes_received_context, ON_IO_ERROR, on_io_error, void*, on_io_error_context);
 MOCKABLE_FUNCTION(, int, socketio_close, CONCRETE_IO_HANDLE, socket_io, ON_IO_CLOSE_COMPLETE, on_io_close_complete, void*, callback_context);
 MOCKABLE_FUNCTION(, int, socketio_send, CONCRETE_IO_HANDLE, socket_io, const void*, buffer, size_t, size, ON_SEND_COMPLETE, on_send_complete, void*, callback_context);
 MOCKABLE_FUNCTION(, void, socketio_dowork, CONCRETE_IO_HANDLE, socket_io);
+MOCKABLE_FUNCTION(, int, socketio_get_send_statistics, CONCRETE_IO_HANDLE, socket_io, SOCKETIO_SEND_STATISTICS*, statistics);
 MOCKABLE_FUNCTION(, int, socketio_setoption, CONCRETE_IO_HANDLE, socket_io, const char*, optionName, const void*, value);
 
 MOCKABLE_FUNCTION(, const IO_INTERFACE_DESCRIPTION*, socketio_get_interface_description);
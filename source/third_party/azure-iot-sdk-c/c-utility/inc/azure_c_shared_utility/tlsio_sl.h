@@ -15,6 +15,20 @@ extern "C" {
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/optionhandler.h"
 
+/* size_t value: bytes of the per-connection receive buffer; takes effect while the IO is not open */
+#define OPTION_TLSIO_SL_RECEIVE_BUFFER_SIZE "tlsio_sl_receive_buffer_size"
+/* unsigned int value: milliseconds tlsio_sl_dowork waits in select for the socket to become readable, 0 to not wait */
+#define OPTION_TLSIO_SL_RECEIVE_WAIT_MS "tlsio_sl_receive_wait_ms"
+
+typedef struct TLSIO_SL_RECEIVE_STATISTICS_TAG
+{
+    size_t receive_calls;
+    size_t readiness_waits;
+    size_t upcalls;
+    size_t bytes_received;
+    size_t largest_upcall;
+} TLSIO_SL_RECEIVE_STATISTICS;
+
 extern CONCRETE_IO_HANDLE tlsio_sl_create(void* io_create_parameters);
 extern void tlsio_sl_destroy(CONCRETE_IO_HANDLE tls_io);
 extern int tlsio_sl_open(CONCRETE_IO_HANDLE tls_io, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context);
@@ -26,6 +40,9 @@ extern OPTIONHANDLER_HANDLE tlsio_sl_retrieveoptions(CONCRETE_IO_HANDLE handle);
 
 extern const IO_INTERFACE_DESCRIPTION* tlsio_sl_get_interface_description(void);
 
+/* Copies the receive counters accumulated since the connection was opened; bytes per upcall is bytes_received / upcalls. */
+extern int tlsio_sl_get_receive_statistics(CONCRETE_IO_HANDLE tls_io, TLSIO_SL_RECEIVE_STATISTICS* statistics);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -14,6 +14,9 @@ extern "C" {
 
     MOCKABLE_FUNCTION(, STRING_HANDLE, URL_EncodeString, const char*, textEncode);
     MOCKABLE_FUNCTION(, STRING_HANDLE, URL_Encode, STRING_HANDLE, input);
+    MOCKABLE_FUNCTION(, size_t, URL_EncodedLength, const char*, text, size_t, textLength);
+    MOCKABLE_FUNCTION(, int, URL_EncodeInto, const char*, text, size_t, textLength, char*, destination, size_t, destinationSize, size_t*, encodedLength);
+    MOCKABLE_FUNCTION(, int, URL_EncodeConcat, STRING_HANDLE, destination, const char*, text);
 
 #ifdef __cplusplus
 }
@@ -41,6 +41,8 @@ extern "C" {
 DEFINE_ENUM(WS_FRAME_TYPE, WS_FRAME_TYPE_VALUES);
 
 MOCKABLE_FUNCTION(, BUFFER_HANDLE, uws_frame_encoder_encode, WS_FRAME_TYPE, opcode, const unsigned char*, payload, size_t, length, bool, is_masked, bool, is_final, unsigned char, reserved);
+MOCKABLE_FUNCTION(, size_t, uws_frame_encoder_get_encoded_size, size_t, length, bool, is_masked);
+MOCKABLE_FUNCTION(, int, uws_frame_encoder_encode_into, unsigned char*, destination, size_t, destination_size, WS_FRAME_TYPE, opcode, const unsigned char*, payload, size_t, length, bool, is_masked, bool, is_final, unsigned char, reserved);
 
 #ifdef __cplusplus
 }
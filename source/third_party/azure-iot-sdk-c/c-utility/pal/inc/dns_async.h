@@ -31,6 +31,8 @@ extern "C" {
 
     /**
     * @brief	Continue the lookup process and report its completion state. Must be polled repeatedly for completion.
+    *           The present implementation resolves synchronously: the first call blocks for the whole lookup
+    *           and always returns true.
     *
     * @param   dns	The DNS_ASYNC_HANDLE.
     *
@@ -0,0 +1,88 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file socket_poller.h
+ *	@brief	 Shared readiness loop for the sockets of many socketio instances.
+ */
+
+#ifndef AZURE_IOT_SOCKET_POLLER_H
+#define AZURE_IOT_SOCKET_POLLER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#define SOCKET_POLLER_READABLE  0x01
+#define SOCKET_POLLER_WRITABLE  0x02
+
+    typedef struct SOCKET_POLLER_REGISTRATION_TAG* SOCKET_POLLER_REGISTRATION_HANDLE;
+
+    /**
+    * @brief	Create the shared loop. Calls are counted; only the first one creates it.
+    *           Like platform_init, this must not race with socket_poller_deinit.
+    *
+    * @return	@c 0 on success.
+    */
+    MOCKABLE_FUNCTION(, int, socket_poller_init);
+
+    /**
+    * @brief	Release one socket_poller_init; the last one closes the loop.
+    */
+    MOCKABLE_FUNCTION(, void, socket_poller_deinit);
+
+    /**
+    * @brief	Watch a non-blocking socket. It has no readiness until the next wait, which reports
+    *           whatever the socket is already ready for; a connecting socket turns writable once
+    *           the connect has finished.
+    *
+    * @param   socket	The socket descriptor.
+    *
+    * @return	@c The registration, or NULL on failure.
+    */
+    MOCKABLE_FUNCTION(, SOCKET_POLLER_REGISTRATION_HANDLE, socket_poller_add, int, socket);
+
+    /**
+    * @brief	Stop watching a socket. Call before closing the descriptor.
+    *
+    * @param   registration	The handle returned by socket_poller_add.
+    */
+    MOCKABLE_FUNCTION(, void, socket_poller_remove, SOCKET_POLLER_REGISTRATION_HANDLE, registration);
+
+    /**
+    * @brief	Return the readiness reported for the socket. Readiness is edge-triggered: it
+    *           stays set until the owner clears it after send or recv returns EAGAIN. When the
+    *           owner has already seen the latest poll, the loop polls all sockets once more
+    *           without waiting, so a round of dowork calls costs one system call.
+    *
+    * @param   registration	The handle returned by socket_poller_add.
+    *
+    * @return	@c A combination of SOCKET_POLLER_READABLE and SOCKET_POLLER_WRITABLE.
+    */
+    MOCKABLE_FUNCTION(, unsigned int, socket_poller_get_events, SOCKET_POLLER_REGISTRATION_HANDLE, registration);
+
+    /**
+    * @brief	Clear readiness after a send or recv on the socket returned EAGAIN.
+    *
+    * @param   registration	The handle returned by socket_poller_add.
+    * @param   events	The SOCKET_POLLER_READABLE and/or SOCKET_POLLER_WRITABLE bits to clear.
+    */
+    MOCKABLE_FUNCTION(, void, socket_poller_clear_events, SOCKET_POLLER_REGISTRATION_HANDLE, registration, unsigned int, events);
+
+    /**
+    * @brief	Block until any watched socket is ready or the timeout expires, recording the
+    *           readiness for the next dowork. Lets an idle application sleep instead of spinning.
+    *
+    * @param   timeout_ms	Longest time to wait, in milliseconds.
+    *
+    * @return	@c The number of sockets that became ready, or -1 on failure.
+    */
+    MOCKABLE_FUNCTION(, int, socket_poller_wait, unsigned int, timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AZURE_IOT_SOCKET_POLLER_H */
@@ -0,0 +1,602 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+
+#if defined(__linux__) && !defined(SOCKET_POLLER_USE_POLL)
+#include <sys/epoll.h>
+#define SOCKET_POLLER_USE_EPOLL
+#else
+#include <poll.h>
+#endif
+#include <unistd.h>
+
+#include "socket_poller.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#ifndef SOCKET_POLLER_MAX_EVENTS
+#define SOCKET_POLLER_MAX_EVENTS 64
+#endif
+
+#define SOCKET_POLLER_ALL_EVENTS (SOCKET_POLLER_READABLE | SOCKET_POLLER_WRITABLE)
+
+// A key packs the registration slot with a serial so that results of a wait that raced
+// with socket_poller_remove are dropped instead of landing on a reused slot.
+#define MAKE_KEY(slot, serial) ((((uint64_t)(serial)) << 32) | (uint64_t)(slot))
+#define KEY_SLOT(key) ((size_t)((key) & 0xFFFFFFFF))
+#define KEY_SERIAL(key) ((uint32_t)((key) >> 32))
+
+typedef struct SOCKET_POLLER_REGISTRATION_TAG
+{
+    int socket;
+    size_t slot;
+    uint32_t serial;
+    unsigned int events;
+    unsigned int edges_since_read;
+    size_t generation;
+} SOCKET_POLLER_REGISTRATION;
+
+// Statically initialized so that concurrent first calls to socket_poller_init cannot both
+// create poller_lock; it guards poller_init_count and the lifetime of poller_lock.
+static pthread_mutex_t poller_init_lock = PTHREAD_MUTEX_INITIALIZER;
+static LOCK_HANDLE poller_lock = NULL;
+static size_t poller_init_count = 0;
+static SOCKET_POLLER_REGISTRATION** registrations = NULL;
+static size_t registration_capacity = 0;
+static uint32_t next_serial = 0;
+static size_t poll_generation = 0;
+static bool is_polling = false;
+
+#ifdef SOCKET_POLLER_USE_EPOLL
+static int epoll_fd = -1;
+static struct epoll_event ready_events[SOCKET_POLLER_MAX_EVENTS];
+#else
+static struct pollfd* poll_fds = NULL;
+static uint64_t* poll_keys = NULL;
+static size_t poll_capacity = 0;
+#endif
+
+static int open_backend(void)
+{
+    int result;
+
+#ifdef SOCKET_POLLER_USE_EPOLL
+    if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+    {
+        LogError("epoll_create1 failed: errno=%d", errno);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+#else
+    result = 0;
+#endif
+
+    return result;
+}
+
+static void close_backend(void)
+{
+#ifdef SOCKET_POLLER_USE_EPOLL
+    (void)close(epoll_fd);
+    epoll_fd = -1;
+#else
+    free(poll_fds);
+    free(poll_keys);
+    poll_fds = NULL;
+    poll_keys = NULL;
+    poll_capacity = 0;
+#endif
+}
+
+static int watch_backend(SOCKET_POLLER_REGISTRATION* registration)
+{
+    int result;
+
+#ifdef SOCKET_POLLER_USE_EPOLL
+    struct epoll_event event;
+
+    /* Codes_SRS_SOCKET_POLLER_99_011: [ On Linux the socket shall be added to an epoll set with edge-triggered read and write interest. ]*/
+    event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+    event.data.u64 = MAKE_KEY(registration->slot, registration->serial);
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, registration->socket, &event) != 0)
+    {
+        LogError("epoll_ctl add failed: errno=%d", errno);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+#else
+    (void)registration;
+    result = 0;
+#endif
+
+    return result;
+}
+
+static void unwatch_backend(SOCKET_POLLER_REGISTRATION* registration)
+{
+#ifdef SOCKET_POLLER_USE_EPOLL
+    /* the event argument is ignored but must be non-NULL on kernels before 2.6.9 */
+    struct epoll_event event = { 0 };
+    (void)epoll_ctl(epoll_fd, EPOLL_CTL_DEL, registration->socket, &event);
+#else
+    (void)registration;
+#endif
+}
+
+static void record_events(uint64_t key, unsigned int events)
+{
+    size_t slot = KEY_SLOT(key);
+
+    if ((slot < registration_capacity) &&
+        (registrations[slot] != NULL) &&
+        (registrations[slot]->serial == KEY_SERIAL(key)))
+    {
+        registrations[slot]->events |= events;
+        registrations[slot]->edges_since_read |= events;
+    }
+}
+
+/* Builds the list to wait on under the lock. For poll only directions that are not already known
+   to be ready are asked for, which turns level-triggered poll into the edges epoll reports. */
+static int prepare_wait(size_t* count)
+{
+    int result;
+#ifdef SOCKET_POLLER_USE_EPOLL
+    *count = 0;
+    result = 0;
+#else
+    size_t i;
+
+    if (poll_capacity < registration_capacity)
+    {
+        struct pollfd* new_fds = realloc(poll_fds, registration_capacity * sizeof(struct pollfd));
+        uint64_t* new_keys = (new_fds == NULL) ? NULL : realloc(poll_keys, registration_capacity * sizeof(uint64_t));
+
+        if (new_fds != NULL)
+        {
+            poll_fds = new_fds;
+        }
+        if (new_keys != NULL)
+        {
+            poll_keys = new_keys;
+        }
+
+        if ((new_fds == NULL) || (new_keys == NULL))
+        {
+            LogError("Failed growing the poll list");
+            result = __FAILURE__;
+        }
+        else
+        {
+            poll_capacity = registration_capacity;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        *count = 0;
+        for (i = 0; i < registration_capacity; i++)
+        {
+            SOCKET_POLLER_REGISTRATION* registration = registrations[i];
+            if ((registration != NULL) && (registration->events != SOCKET_POLLER_ALL_EVENTS))
+            {
+                poll_fds[*count].fd = registration->socket;
+                poll_fds[*count].events = (short)((((registration->events & SOCKET_POLLER_READABLE) == 0) ? POLLIN : 0) |
+                    (((registration->events & SOCKET_POLLER_WRITABLE) == 0) ? POLLOUT : 0));
+                poll_fds[*count].revents = 0;
+                poll_keys[*count] = MAKE_KEY(registration->slot, registration->serial);
+                (*count)++;
+            }
+        }
+    }
+#endif
+
+    return result;
+}
+
+static int wait_backend(size_t count, int timeout_ms)
+{
+#ifdef SOCKET_POLLER_USE_EPOLL
+    (void)count;
+    return epoll_wait(epoll_fd, ready_events, SOCKET_POLLER_MAX_EVENTS, timeout_ms);
+#else
+    return poll(poll_fds, (nfds_t)count, timeout_ms);
+#endif
+}
+
+/* Records what the wait reported; called under the lock. Returns how many sockets became ready. */
+static int record_ready(size_t count, int ready)
+{
+    int result = 0;
+    int i;
+
+#ifdef SOCKET_POLLER_USE_EPOLL
+    (void)count;
+    for (i = 0; i < ready; i++)
+    {
+        unsigned int events = 0;
+
+        /* Codes_SRS_SOCKET_POLLER_99_022: [ Errors and hang-ups shall be reported as both readable and writable so that the owner's next send or recv surfaces them. ]*/
+        if ((ready_events[i].events & (EPOLLERR | EPOLLHUP)) != 0)
+        {
+            events = SOCKET_POLLER_ALL_EVENTS;
+        }
+        else
+        {
+            if ((ready_events[i].events & (EPOLLIN | EPOLLRDHUP)) != 0)
+            {
+                events |= SOCKET_POLLER_READABLE;
+            }
+            if ((ready_events[i].events & EPOLLOUT) != 0)
+            {
+                events |= SOCKET_POLLER_WRITABLE;
+            }
+        }
+
+        record_events(ready_events[i].data.u64, events);
+        result++;
+    }
+#else
+    for (i = 0; (i < (int)count) && (result < ready); i++)
+    {
+        unsigned int events = 0;
+
+        if (poll_fds[i].revents != 0)
+        {
+            /* Codes_SRS_SOCKET_POLLER_99_022: [ Errors and hang-ups shall be reported as both readable and writable so that the owner's next send or recv surfaces them. ]*/
+            if ((poll_fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0)
+            {
+                events = SOCKET_POLLER_ALL_EVENTS;
+            }
+            else
+            {
+                if ((poll_fds[i].revents & POLLIN) != 0)
+                {
+                    events |= SOCKET_POLLER_READABLE;
+                }
+                if ((poll_fds[i].revents & POLLOUT) != 0)
+                {
+                    events |= SOCKET_POLLER_WRITABLE;
+                }
+            }
+
+            record_events(poll_keys[i], events);
+            result++;
+        }
+    }
+#endif
+
+    return result;
+}
+
+/* Runs one wait on behalf of every registered socket. Only one thread waits at a time; the
+   others keep working from the readiness recorded by the previous wait. */
+static int poll_sockets(int timeout_ms)
+{
+    int result;
+    size_t count;
+
+    if (Lock(poller_lock) != LOCK_OK)
+    {
+        LogError("Failed locking the socket poller");
+        result = -1;
+    }
+    else if (is_polling)
+    {
+        (void)Unlock(poller_lock);
+        result = 0;
+    }
+    else if (prepare_wait(&count) != 0)
+    {
+        (void)Unlock(poller_lock);
+        result = -1;
+    }
+    else
+    {
+        int ready;
+
+        is_polling = true;
+        (void)Unlock(poller_lock);
+
+        ready = wait_backend(count, timeout_ms);
+
+        (void)Lock(poller_lock);
+        if (ready >= 0)
+        {
+            result = record_ready(count, ready);
+        }
+        else if (errno == EINTR)
+        {
+            result = 0;
+        }
+        else
+        {
+            LogError("Waiting for socket readiness failed: errno=%d", errno);
+            result = -1;
+        }
+
+        poll_generation++;
+        is_polling = false;
+        (void)Unlock(poller_lock);
+    }
+
+    return result;
+}
+
+int socket_poller_init(void)
+{
+    int result;
+
+    /* Codes_SRS_SOCKET_POLLER_99_006: [ socket_poller_init and socket_poller_deinit shall be serialized so that concurrent calls create the lock and the OS wait object only once. ]*/
+    if (pthread_mutex_lock(&poller_init_lock) != 0)
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_003: [ On any failure, socket_poller_init shall log an error and return a non-zero value. ]*/
+        LogError("Failed locking the socket poller initialization");
+        result = __FAILURE__;
+    }
+    else
+    {
+        if (poller_init_count > 0)
+        {
+            /* Codes_SRS_SOCKET_POLLER_99_002: [ If the poller is already initialized, socket_poller_init shall only count the call and return 0. ]*/
+            poller_init_count++;
+            result = 0;
+        }
+        /* Codes_SRS_SOCKET_POLLER_99_001: [ socket_poller_init shall create the lock guarding the poller and the OS wait object. ]*/
+        else if ((poller_lock = Lock_Init()) == NULL)
+        {
+            /* Codes_SRS_SOCKET_POLLER_99_003: [ On any failure, socket_poller_init shall log an error and return a non-zero value. ]*/
+            LogError("Failed creating the socket poller lock");
+            result = __FAILURE__;
+        }
+        else if (open_backend() != 0)
+        {
+            /* Codes_SRS_SOCKET_POLLER_99_003: [ On any failure, socket_poller_init shall log an error and return a non-zero value. ]*/
+            (void)Lock_Deinit(poller_lock);
+            poller_lock = NULL;
+            result = __FAILURE__;
+        }
+        else
+        {
+            poller_init_count = 1;
+            result = 0;
+        }
+        (void)pthread_mutex_unlock(&poller_init_lock);
+    }
+
+    return result;
+}
+
+void socket_poller_deinit(void)
+{
+    /* Codes_SRS_SOCKET_POLLER_99_006: [ socket_poller_init and socket_poller_deinit shall be serialized so that concurrent calls create the lock and the OS wait object only once. ]*/
+    if (pthread_mutex_lock(&poller_init_lock) != 0)
+    {
+        LogError("Failed locking the socket poller initialization");
+    }
+    else
+    {
+        if (poller_init_count == 0)
+        {
+            /* Codes_SRS_SOCKET_POLLER_99_005: [ If the poller is not initialized, socket_poller_deinit shall do nothing. ]*/
+            LogError("Socket poller is not initialized");
+        }
+        else if (--poller_init_count == 0)
+        {
+            size_t i;
+
+            /* Codes_SRS_SOCKET_POLLER_99_004: [ The socket_poller_deinit call matching the first socket_poller_init shall free every registration, the OS wait object and the lock. ]*/
+            for (i = 0; i < registration_capacity; i++)
+            {
+                free(registrations[i]);
+            }
+            free(registrations);
+            registrations = NULL;
+            registration_capacity = 0;
+            close_backend();
+            (void)Lock_Deinit(poller_lock);
+            poller_lock = NULL;
+        }
+        (void)pthread_mutex_unlock(&poller_init_lock);
+    }
+}
+
+SOCKET_POLLER_REGISTRATION_HANDLE socket_poller_add(int socket)
+{
+    SOCKET_POLLER_REGISTRATION* result;
+
+    if (socket < 0)
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_012: [ If socket is negative, socket_poller_add shall log an error and return NULL. ]*/
+        LogError("Invalid socket %d", socket);
+        result = NULL;
+    }
+    else if (poller_init_count == 0)
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_013: [ If the poller is not initialized, socket_poller_add shall return NULL. ]*/
+        result = NULL;
+    }
+    else if ((result = malloc(sizeof(SOCKET_POLLER_REGISTRATION))) == NULL)
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_014: [ On any failure, socket_poller_add shall log an error and return NULL. ]*/
+        LogError("Failed allocating the socket registration");
+    }
+    else if (Lock(poller_lock) != LOCK_OK)
+    {
+        LogError("Failed locking the socket poller");
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        size_t slot;
+
+        /* Codes_SRS_SOCKET_POLLER_99_015: [ socket_poller_add shall take a free slot, growing the slot table when none is left. ]*/
+        for (slot = 0; slot < registration_capacity; slot++)
+        {
+            if (registrations[slot] == NULL)
+            {
+                break;
+            }
+        }
+
+        if (slot == registration_capacity)
+        {
+            size_t new_capacity = (registration_capacity == 0) ? 8 : (registration_capacity * 2);
+            SOCKET_POLLER_REGISTRATION** new_registrations = realloc(registrations, new_capacity * sizeof(SOCKET_POLLER_REGISTRATION*));
+            if (new_registrations == NULL)
+            {
+                /* Codes_SRS_SOCKET_POLLER_99_014: [ On any failure, socket_poller_add shall log an error and return NULL. ]*/
+                LogError("Failed growing the socket registration table");
+                slot = SIZE_MAX;
+            }
+            else
+            {
+                size_t i;
+                for (i = registration_capacity; i < new_capacity; i++)
+                {
+                    new_registrations[i] = NULL;
+                }
+                registrations = new_registrations;
+                registration_capacity = new_capacity;
+            }
+        }
+
+        if (slot == SIZE_MAX)
+        {
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            /* Codes_SRS_SOCKET_POLLER_99_010: [ A new registration shall have no readiness until the next wait reports it. ]*/
+            result->socket = socket;
+            result->slot = slot;
+            result->serial = next_serial++;
+            result->events = 0;
+            result->edges_since_read = 0;
+            result->generation = poll_generation;
+
+            if (watch_backend(result) != 0)
+            {
+                /* Codes_SRS_SOCKET_POLLER_99_014: [ On any failure, socket_poller_add shall log an error and return NULL. ]*/
+                free(result);
+                result = NULL;
+            }
+            else
+            {
+                registrations[slot] = result;
+            }
+        }
+
+        (void)Unlock(poller_lock);
+    }
+
+    return result;
+}
+
+void socket_poller_remove(SOCKET_POLLER_REGISTRATION_HANDLE registration)
+{
+    if (registration == NULL)
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_020: [ If registration is NULL, socket_poller_remove shall log an error and do nothing. ]*/
+        LogError("NULL registration");
+    }
+    else
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_021: [ socket_poller_remove shall stop watching the socket and free the registration. ]*/
+        (void)Lock(poller_lock);
+        unwatch_backend(registration);
+        registrations[registration->slot] = NULL;
+        (void)Unlock(poller_lock);
+        free(registration);
+    }
+}
+
+unsigned int socket_poller_get_events(SOCKET_POLLER_REGISTRATION_HANDLE registration)
+{
+    unsigned int result;
+
+    if (registration == NULL)
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_030: [ If registration is NULL, socket_poller_get_events shall log an error and return 0. ]*/
+        LogError("NULL registration");
+        result = 0;
+    }
+    else
+    {
+        bool has_read_latest_wait;
+
+        (void)Lock(poller_lock);
+        has_read_latest_wait = (registration->generation == poll_generation);
+        (void)Unlock(poller_lock);
+
+        /* Codes_SRS_SOCKET_POLLER_99_031: [ If the registration has already read the results of the latest wait, socket_poller_get_events shall first wait with a zero timeout. ]*/
+        if (has_read_latest_wait)
+        {
+            (void)poll_sockets(0);
+        }
+
+        /* Codes_SRS_SOCKET_POLLER_99_032: [ socket_poller_get_events shall return the readiness recorded for the socket. ]*/
+        (void)Lock(poller_lock);
+        result = registration->events;
+        registration->edges_since_read = 0;
+        registration->generation = poll_generation;
+        (void)Unlock(poller_lock);
+    }
+
+    return result;
+}
+
+void socket_poller_clear_events(SOCKET_POLLER_REGISTRATION_HANDLE registration, unsigned int events)
+{
+    if (registration == NULL)
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_040: [ If registration is NULL, socket_poller_clear_events shall log an error and do nothing. ]*/
+        LogError("NULL registration");
+    }
+    else
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_041: [ socket_poller_clear_events shall clear the given readiness, except for edges reported since the owner last read its events. ]*/
+        (void)Lock(poller_lock);
+        registration->events &= ~(events & ~registration->edges_since_read);
+        (void)Unlock(poller_lock);
+    }
+}
+
+int socket_poller_wait(unsigned int timeout_ms)
+{
+    int result;
+
+    if (poller_init_count == 0)
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_050: [ If the poller is not initialized, socket_poller_wait shall log an error and return -1. ]*/
+        LogError("Socket poller is not initialized");
+        result = -1;
+    }
+    else
+    {
+        /* Codes_SRS_SOCKET_POLLER_99_051: [ socket_poller_wait shall wait up to timeout_ms for any registered socket and return how many became ready. ]*/
+        result = poll_sockets((timeout_ms > INT32_MAX) ? INT32_MAX : (int)timeout_ms);
+    }
+
+    return result;
+}
@@ -5,107 +5,342 @@
 #include "azure_c_shared_utility/gballoc.h"
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/xlogging.h"
 
+/*the bulk of the work can be done 12 (SSSE3) or 48 (NEON) input bytes at a time. Define NO_BASE64_ACCELERATION to use the tables only*/
+#if !defined(NO_BASE64_ACCELERATION) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define BASE64_SSSE3
+#include <cpuid.h>
+#include <tmmintrin.h>
+#endif
 
-#define splitInt(intVal, bytePos)   (char)((intVal >> (bytePos << 3)) & 0xFF)
-#define joinChars(a, b, c, d) (uint32_t)((uint32_t)a + ((uint32_t)b << 8) + ((uint32_t)c << 16) + ((uint32_t)d << 24))
+#if !defined(NO_BASE64_ACCELERATION) && defined(__aarch64__) && defined(__ARM_NEON)
+#define BASE64_NEON
+#include <arm_neon.h>
+#endif
 
-static char base64char(unsigned char val)
+#define BASE64_INVALID 0xFF
+
+static const char base64EncodeTable[64] =
 {
-    char result;
+    'A', 'B', 'C', 'D', 'E', 'F', 'G', 'H', 'I', 'J', 'K', 'L', 'M', 'N', 'O', 'P',
+    'Q', 'R', 'S', 'T', 'U', 'V', 'W', 'X', 'Y', 'Z', 'a', 'b', 'c', 'd', 'e', 'f',
+    'g', 'h', 'i', 'j', 'k', 'l', 'm', 'n', 'o', 'p', 'q', 'r', 's', 't', 'u', 'v',
+    'w', 'x', 'y', 'z', '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', '+', '/'
+};
 
-    if (val < 26)
-    {
-        result = 'A' + (char)val;
-    }
-    else if (val < 52)
-    {
-        result = 'a' + ((char)val - 26);
-    }
-    else if (val < 62)
+/*maps every character to its 6 bit value, or to BASE64_INVALID*/
+static const unsigned char base64DecodeTable[256] =
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,   62, 0xFF, 0xFF, 0xFF,   63,
+      52,   53,   54,   55,   56,   57,   58,   59,   60,   61, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF,    0,    1,    2,    3,    4,    5,    6,    7,    8,    9,   10,   11,   12,   13,   14,
+      15,   16,   17,   18,   19,   20,   21,   22,   23,   24,   25, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF,   26,   27,   28,   29,   30,   31,   32,   33,   34,   35,   36,   37,   38,   39,   40,
+      41,   42,   43,   44,   45,   46,   47,   48,   49,   50,   51, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+#ifdef BASE64_SSSE3
+
+#define BASE64_SSSE3_TARGET __attribute__((target("ssse3")))
+
+static int hasSSSE3 = -1;
+
+static int Base64_HasSSSE3(void)
+{
+    if (hasSSSE3 < 0)
     {
-        result = '0' + ((char)val - 52);
+        unsigned int eax, ebx, ecx, edx;
+        hasSSSE3 = ((__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0) && ((ecx & bit_SSSE3) != 0)) ? 1 : 0;
     }
-    else if (val == 62)
+    return hasSSSE3;
+}
+
+/*encodes 12 bytes into 16 characters at a time for as long as 16 bytes can be read. Returns the count of bytes consumed*/
+BASE64_SSSE3_TARGET
+static size_t Base64EncodeSSSE3(const unsigned char* source, size_t size, char* destination)
+{
+    const __m128i splitBytes = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+    const __m128i shiftLUT = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    size_t consumed = 0;
+
+    while (size - consumed >= 16)
     {
-        result = '+';
+        __m128i in = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(source + consumed)), splitBytes);
+        /*move each 6 bit group into its own byte*/
+        __m128i indices = _mm_or_si128(
+            _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040)),
+            _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010)));
+        /*0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12; then add the offset for that range*/
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+        _mm_storeu_si128((__m128i*)destination, _mm_add_epi8(indices, _mm_shuffle_epi8(shiftLUT, range)));
+
+        consumed += 12;
+        destination += 16;
     }
-    else
+
+    return consumed;
+}
+
+/*decodes 16 characters into 12 bytes at a time. Stops before the first 16 characters that are not all base64 characters. Returns the count of characters consumed*/
+BASE64_SSSE3_TARGET
+static size_t Base64DecodeSSSE3(const char* source, size_t length, unsigned char* destination)
+{
+    const __m128i packBytes = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    size_t consumed = 0;
+
+    while (length - consumed >= 16)
     {
-        result = '/';
+        __m128i in = _mm_loadu_si128((const __m128i*)(source + consumed));
+        /*signed compares, so characters above 0x7F fall outside every range*/
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), in));
+        __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), in));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), in));
+        __m128i plus = _mm_cmpeq_epi8(in, _mm_set1_epi8('+'));
+        __m128i slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+        __m128i valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus)), slash);
+        __m128i shift;
+        __m128i merged;
+        unsigned char decoded[16];
+
+        if (_mm_movemask_epi8(valid) != 0xFFFF)
+        {
+            break;
+        }
+
+        shift = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(upper, _mm_set1_epi8(-'A')), _mm_and_si128(lower, _mm_set1_epi8(26 - 'a'))),
+            _mm_or_si128(_mm_and_si128(digit, _mm_set1_epi8(52 - '0')),
+                _mm_or_si128(_mm_and_si128(plus, _mm_set1_epi8(62 - '+')), _mm_and_si128(slash, _mm_set1_epi8(63 - '/')))));
+
+        /*pack four 6 bit values into 3 bytes*/
+        merged = _mm_maddubs_epi16(_mm_add_epi8(in, shift), _mm_set1_epi32(0x01400140));
+        merged = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+        merged = _mm_shuffle_epi8(merged, packBytes);
+        if (length - consumed >= 24)
+        {
+            /*the 4 extra bytes land where the next characters decode to*/
+            _mm_storeu_si128((__m128i*)destination, merged);
+        }
+        else
+        {
+            _mm_storeu_si128((__m128i*)decoded, merged);
+            (void)memcpy(destination, decoded, 12);
+        }
+
+        consumed += 16;
+        destination += 12;
     }
 
+    return consumed;
+}
+
+#endif /*BASE64_SSSE3*/
+
+#ifdef BASE64_NEON
+
+static uint8x16x4_t Base64_NeonEncodeTable(void)
+{
+    uint8x16x4_t result;
+    result.val[0] = vld1q_u8((const uint8_t*)base64EncodeTable);
+    result.val[1] = vld1q_u8((const uint8_t*)base64EncodeTable + 16);
+    result.val[2] = vld1q_u8((const uint8_t*)base64EncodeTable + 32);
+    result.val[3] = vld1q_u8((const uint8_t*)base64EncodeTable + 48);
     return result;
 }
 
-static char base64b16(unsigned char val)
+/*encodes 48 bytes into 64 characters at a time. Returns the count of bytes consumed*/
+static size_t Base64EncodeNeon(const unsigned char* source, size_t size, char* destination)
 {
-    const uint32_t base64b16values[4] = {
-        joinChars('A', 'E', 'I', 'M'),
-        joinChars('Q', 'U', 'Y', 'c'),
-        joinChars('g', 'k', 'o', 's'),
-        joinChars('w', '0', '4', '8')
-    };
-    return splitInt(base64b16values[val >> 2], (val & 0x03));
+    const uint8x16x4_t table = Base64_NeonEncodeTable();
+    size_t consumed = 0;
+
+    while (size - consumed >= 48)
+    {
+        uint8x16x3_t in = vld3q_u8(source + consumed);
+        uint8x16x4_t out;
+
+        out.val[0] = vshrq_n_u8(in.val[0], 2);
+        out.val[1] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[0], vdupq_n_u8(0x03)), 4), vshrq_n_u8(in.val[1], 4));
+        out.val[2] = vorrq_u8(vshlq_n_u8(vandq_u8(in.val[1], vdupq_n_u8(0x0F)), 2), vshrq_n_u8(in.val[2], 6));
+        out.val[3] = vandq_u8(in.val[2], vdupq_n_u8(0x3F));
+
+        out.val[0] = vqtbl4q_u8(table, out.val[0]);
+        out.val[1] = vqtbl4q_u8(table, out.val[1]);
+        out.val[2] = vqtbl4q_u8(table, out.val[2]);
+        out.val[3] = vqtbl4q_u8(table, out.val[3]);
+        vst4q_u8((uint8_t*)destination, out);
+
+        consumed += 48;
+        destination += 64;
+    }
+
+    return consumed;
 }
 
-static char base64b8(unsigned char val)
+/*maps 16 characters to their 6 bit values; characters that are not base64 map to values above 63*/
+static uint8x16_t Base64_NeonDecodeValues(uint8x16_t in)
 {
-    const uint32_t base64b8values = joinChars('A', 'Q', 'g', 'w');
-    return splitInt(base64b8values, val);
+    uint8x16_t upper = vandq_u8(vcgeq_u8(in, vdupq_n_u8('A')), vcleq_u8(in, vdupq_n_u8('Z')));
+    uint8x16_t lower = vandq_u8(vcgeq_u8(in, vdupq_n_u8('a')), vcleq_u8(in, vdupq_n_u8('z')));
+    uint8x16_t digit = vandq_u8(vcgeq_u8(in, vdupq_n_u8('0')), vcleq_u8(in, vdupq_n_u8('9')));
+    uint8x16_t plus = vceqq_u8(in, vdupq_n_u8('+'));
+    uint8x16_t slash = vceqq_u8(in, vdupq_n_u8('/'));
+    uint8x16_t valid = vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(digit, plus)), slash);
+    uint8x16_t shift = vorrq_u8(
+        vorrq_u8(vandq_u8(upper, vdupq_n_u8((uint8_t)-'A')), vandq_u8(lower, vdupq_n_u8((uint8_t)(26 - 'a')))),
+        vorrq_u8(vandq_u8(digit, vdupq_n_u8((uint8_t)(52 - '0'))),
+            vorrq_u8(vandq_u8(plus, vdupq_n_u8((uint8_t)(62 - '+'))), vandq_u8(slash, vdupq_n_u8((uint8_t)(63 - '/'))))));
+
+    /*invalid characters become 0xFF*/
+    return vorrq_u8(vaddq_u8(in, shift), vmvnq_u8(valid));
 }
 
-static int base64toValue(char base64character, unsigned char* value)
+/*decodes 64 characters into 48 bytes at a time. Stops before the first 64 characters that are not all base64 characters. Returns the count of characters consumed*/
+static size_t Base64DecodeNeon(const char* source, size_t length, unsigned char* destination)
 {
-    int result = 0;
-    if (('A' <= base64character) && (base64character <= 'Z'))
-    {
-        *value = base64character - 'A';
-    }
-    else if (('a' <= base64character) && (base64character <= 'z'))
+    size_t consumed = 0;
+
+    while (length - consumed >= 64)
     {
-        *value = ('Z' - 'A') + 1 + (base64character - 'a');
+        uint8x16x4_t in = vld4q_u8((const uint8_t*)source + consumed);
+        uint8x16x3_t out;
+
+        in.val[0] = Base64_NeonDecodeValues(in.val[0]);
+        in.val[1] = Base64_NeonDecodeValues(in.val[1]);
+        in.val[2] = Base64_NeonDecodeValues(in.val[2]);
+        in.val[3] = Base64_NeonDecodeValues(in.val[3]);
+
+        if (vmaxvq_u8(vorrq_u8(vorrq_u8(in.val[0], in.val[1]), vorrq_u8(in.val[2], in.val[3]))) > 63)
+        {
+            break;
+        }
+
+        out.val[0] = vorrq_u8(vshlq_n_u8(in.val[0], 2), vshrq_n_u8(in.val[1], 4));
+        out.val[1] = vorrq_u8(vshlq_n_u8(in.val[1], 4), vshrq_n_u8(in.val[2], 2));
+        out.val[2] = vorrq_u8(vshlq_n_u8(in.val[2], 6), in.val[3]);
+        vst3q_u8(destination, out);
+
+        consumed += 64;
+        destination += 48;
     }
-    else if (('0' <= base64character) && (base64character <= '9'))
+
+    return consumed;
+}
+
+#endif /*BASE64_NEON*/
+
+/*writes the base64 encoding of source, with padding, to destination. Returns the count of characters written (no '\0' is written)*/
+static size_t Base64encode(const unsigned char* source, size_t size, char* destination)
+{
+    size_t currentPosition = 0;
+    size_t destinationPosition = 0;
+
+#if defined(BASE64_SSSE3)
+    if (Base64_HasSSSE3())
     {
-        *value = ('Z' - 'A') + 1 + ('z' - 'a') + 1 + (base64character - '0');
+        currentPosition = Base64EncodeSSSE3(source, size, destination);
+        destinationPosition = currentPosition / 3 * 4;
     }
-    else if ('+' == base64character)
+#elif defined(BASE64_NEON)
+    currentPosition = Base64EncodeNeon(source, size, destination);
+    destinationPosition = currentPosition / 3 * 4;
+#endif
+
+    /*b0            b1(+1)          b2(+2)
+    7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0
+    |----c1---| |----c2---| |----c3---| |----c4---|
+    */
+    while (size - currentPosition >= 3)
     {
-        *value = 62;
+        uint32_t group = ((uint32_t)source[currentPosition] << 16) |
+            ((uint32_t)source[currentPosition + 1] << 8) |
+            (uint32_t)source[currentPosition + 2];
+        destination[destinationPosition] = base64EncodeTable[group >> 18];
+        destination[destinationPosition + 1] = base64EncodeTable[(group >> 12) & 0x3F];
+        destination[destinationPosition + 2] = base64EncodeTable[(group >> 6) & 0x3F];
+        destination[destinationPosition + 3] = base64EncodeTable[group & 0x3F];
+        currentPosition += 3;
+        destinationPosition += 4;
     }
-    else if ('/' == base64character)
+
+    if (size - currentPosition == 2)
     {
-        *value = 63;
+        uint32_t group = ((uint32_t)source[currentPosition] << 16) |
+            ((uint32_t)source[currentPosition + 1] << 8);
+        destination[destinationPosition++] = base64EncodeTable[group >> 18];
+        destination[destinationPosition++] = base64EncodeTable[(group >> 12) & 0x3F];
+        destination[destinationPosition++] = base64EncodeTable[(group >> 6) & 0x3F];
+        destination[destinationPosition++] = '=';
     }
-    else
+    else if (size - currentPosition == 1)
     {
-        *value = 0;
-        result = -1;
+        uint32_t group = (uint32_t)source[currentPosition] << 16;
+        destination[destinationPosition++] = base64EncodeTable[group >> 18];
+        destination[destinationPosition++] = base64EncodeTable[(group >> 12) & 0x3F];
+        destination[destinationPosition++] = '=';
+        destination[destinationPosition++] = '=';
     }
-    return result;
+
+    return destinationPosition;
 }
 
-static size_t numberOfBase64Characters(const char* encodedString)
+/*decodes up to quartetCount groups of 4 base64 characters. Stops at the first group that contains something else (such as padding). Returns the count of groups decoded*/
+static size_t Base64decodeQuartets(const char* source, size_t quartetCount, unsigned char* destination)
 {
-    size_t length = 0;
-    unsigned char junkChar;
-    while (base64toValue(encodedString[length],&junkChar) != -1)
+    size_t consumed = 0;
+    size_t length = quartetCount * 4;
+
+#if defined(BASE64_SSSE3)
+    if (Base64_HasSSSE3())
     {
-        length++;
+        consumed = Base64DecodeSSSE3(source, length, destination);
     }
-    return length;
+#elif defined(BASE64_NEON)
+    consumed = Base64DecodeNeon(source, length, destination);
+#endif
+
+    destination += consumed / 4 * 3;
+    while (consumed < length)
+    {
+        unsigned char c1 = base64DecodeTable[(unsigned char)source[consumed]];
+        unsigned char c2 = base64DecodeTable[(unsigned char)source[consumed + 1]];
+        unsigned char c3 = base64DecodeTable[(unsigned char)source[consumed + 2]];
+        unsigned char c4 = base64DecodeTable[(unsigned char)source[consumed + 3]];
+        if ((c1 | c2 | c3 | c4) == BASE64_INVALID)
+        {
+            break;
+        }
+        destination[0] = (unsigned char)((c1 << 2) | (c2 >> 4));
+        destination[1] = (unsigned char)((c2 << 4) | (c3 >> 2));
+        destination[2] = (unsigned char)((c3 << 6) | c4);
+        destination += 3;
+        consumed += 4;
+    }
+
+    return consumed / 4;
 }
 
 /*returns the count of original bytes before being base64 encoded*/
 /*notice NO validation of the content of encodedString. Its length is validated to be a multiple of 4.*/
-static size_t Base64decode_len(const char *encodedString)
+static size_t Base64decode_len(const char *encodedString, size_t sourceLength)
 {
     size_t result;
-    size_t sourceLength = strlen(encodedString);
-    
+
     if (sourceLength == 0)
     {
         result = 0;
@@ -125,62 +360,42 @@ static size_t Base64decode_len(const char *encodedString)
     return result;
 }
 
-static void Base64decode(unsigned char *decodedString, const char *base64String)
+/*decodes the base64 characters of base64String up to the first character that is not one*/
+static void Base64decode(unsigned char *decodedString, const char *base64String, size_t sourceLength)
 {
-
-    size_t numberOfEncodedChars;
     size_t indexOfFirstEncodedChar;
     size_t decodedIndex;
+    size_t numberOfEncodedChars;
 
-    //
-    // We can only operate on individual bytes.  If we attempt to work
-    // on anything larger we could get an alignment fault on some
-    // architectures
-    //
+    /*all the groups but the last one hold no padding*/
+    indexOfFirstEncodedChar = (sourceLength < 4) ? 0 : (Base64decodeQuartets(base64String, sourceLength / 4 - 1, decodedString) * 4);
+    decodedIndex = indexOfFirstEncodedChar / 4 * 3;
+
+    numberOfEncodedChars = 0;
+    while ((indexOfFirstEncodedChar + numberOfEncodedChars < sourceLength) &&
+        (base64DecodeTable[(unsigned char)base64String[indexOfFirstEncodedChar + numberOfEncodedChars]] != BASE64_INVALID))
+    {
+        numberOfEncodedChars++;
+    }
 
-    numberOfEncodedChars = numberOfBase64Characters(base64String);
-    indexOfFirstEncodedChar = 0;
-    decodedIndex = 0;
     while (numberOfEncodedChars >= 4)
     {
-        unsigned char c1;
-        unsigned char c2;
-        unsigned char c3;
-        unsigned char c4;
-        (void)base64toValue(base64String[indexOfFirstEncodedChar], &c1);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 1], &c2);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 2], &c3);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 3], &c4);
-        decodedString[decodedIndex] = (c1 << 2) | (c2 >> 4);
-        decodedIndex++;
-        decodedString[decodedIndex] = ((c2 & 0x0f) << 4) | (c3 >> 2);
-        decodedIndex++;
-        decodedString[decodedIndex] = ((c3 & 0x03) << 6) | c4;
-        decodedIndex++;
+        (void)Base64decodeQuartets(base64String + indexOfFirstEncodedChar, 1, decodedString + decodedIndex);
+        decodedIndex += 3;
         numberOfEncodedChars -= 4;
         indexOfFirstEncodedChar += 4;
-
     }
 
-    if (numberOfEncodedChars == 2)
+    if (numberOfEncodedChars >= 2)
     {
-        unsigned char c1;
-        unsigned char c2;
-        (void)base64toValue(base64String[indexOfFirstEncodedChar], &c1);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 1], &c2);
-        decodedString[decodedIndex] = (c1 << 2) | (c2 >> 4);
-    }
-    else if (numberOfEncodedChars == 3)
-    {
-        unsigned char c1;
-        unsigned char c2;
-        unsigned char c3;
-        (void)base64toValue(base64String[indexOfFirstEncodedChar], &c1);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 1], &c2);
-        (void)base64toValue(base64String[indexOfFirstEncodedChar + 2], &c3);
-        decodedString[decodedIndex] = (c1 << 2) | (c2 >> 4);
-        decodedIndex++;
-        decodedString[decodedIndex] = ((c2 & 0x0f) << 4) | (c3 >> 2);
+        unsigned char c1 = base64DecodeTable[(unsigned char)base64String[indexOfFirstEncodedChar]];
+        unsigned char c2 = base64DecodeTable[(unsigned char)base64String[indexOfFirstEncodedChar + 1]];
+        decodedString[decodedIndex] = (unsigned char)((c1 << 2) | (c2 >> 4));
+        if (numberOfEncodedChars == 3)
+        {
+            unsigned char c3 = base64DecodeTable[(unsigned char)base64String[indexOfFirstEncodedChar + 2]];
+            decodedString[decodedIndex + 1] = (unsigned char)((c2 << 4) | (c3 >> 2));
+        }
     }
 }
 
@@ -195,7 +410,8 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
     }
     else
     {
-        if ((strlen(source) % 4) != 0)
+        size_t sourceLength = strlen(source);
+        if ((sourceLength % 4) != 0)
         {
             /*Codes_SRS_BASE64_06_011: [If the source string has an invalid length for a base 64 encoded string then Base64_Decode shall return NULL.]*/
             LogError("Invalid length Base64 string!");
@@ -210,7 +426,7 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
             }
             else
             {
-                size_t sizeOfOutputBuffer = Base64decode_len(source);
+                size_t sizeOfOutputBuffer = Base64decode_len(source, sourceLength);
                 /*Codes_SRS_BASE64_06_009: [If the string pointed to by source is zero length then the handle returned shall refer to a zero length buffer.]*/
                 if (sizeOfOutputBuffer > 0)
                 {
@@ -223,7 +439,7 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
                     }
                     else
                     {
-                        Base64decode(BUFFER_u_char(result), source);
+                        Base64decode(BUFFER_u_char(result), source, sourceLength);
                     }
                 }
             }
@@ -236,13 +452,9 @@ BUFFER_HANDLE Base64_Decoder(const char* source)
 static STRING_HANDLE Base64_Encode_Internal(const unsigned char* source, size_t size)
 {
     STRING_HANDLE result;
-    size_t neededSize = 0;
     char* encoded;
-    size_t currentPosition = 0;
-    neededSize += (size == 0) ? (0) : ((((size - 1) / 3) + 1) * 4);
-    neededSize += 1; /*+1 because \0 at the end of the string*/
     /*Codes_SRS_BASE64_06_006: [If when allocating memory to produce the encoding a failure occurs then Base64_Encoder shall return NULL.]*/
-    encoded = (char*)malloc(neededSize);
+    encoded = (char*)malloc(BASE64_ENCODED_SIZE(size));
     if (encoded == NULL)
     {
         result = NULL;
@@ -250,58 +462,8 @@ static STRING_HANDLE Base64_Encode_Internal(const unsigned char* source, size_t
     }
     else
     {
-        /*b0            b1(+1)          b2(+2)
-        7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0 7 6 5 4 3 2 1 0
-        |----c1---| |----c2---| |----c3---| |----c4---|
-        */
-
-        size_t destinationPosition = 0;
-        while (size - currentPosition >= 3)
-        {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64char(
-                ((source[currentPosition] & 3) << 4) |
-                    (source[currentPosition + 1] >> 4)
-            );
-            char c3 = base64char(
-                ((source[currentPosition + 1] & 0x0F) << 2) |
-                    ((source[currentPosition + 2] >> 6) & 3)
-            );
-            char c4 = base64char(
-                source[currentPosition + 2] & 0x3F
-            );
-            currentPosition += 3;
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = c3;
-            encoded[destinationPosition++] = c4;
-
-        }
-        if (size - currentPosition == 2)
-        {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64char(
-                ((source[currentPosition] & 0x03) << 4) |
-                    (source[currentPosition + 1] >> 4)
-            );
-            char c3 = base64b16(source[currentPosition + 1] & 0x0F);
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = c3;
-            encoded[destinationPosition++] = '=';
-        }
-        else if (size - currentPosition == 1)
-        {
-            char c1 = base64char(source[currentPosition] >> 2);
-            char c2 = base64b8(source[currentPosition] & 0x03);
-            encoded[destinationPosition++] = c1;
-            encoded[destinationPosition++] = c2;
-            encoded[destinationPosition++] = '=';
-            encoded[destinationPosition++] = '=';
-        }
-
         /*null terminating the string*/
-        encoded[destinationPosition] = '\0';
+        encoded[Base64encode(source, size, encoded)] = '\0';
         /*Codes_SRS_BASE64_06_007: [Otherwise Base64_Encoder shall return a pointer to STRING, that string contains the base 64 encoding of input.]*/
         result = STRING_new_with_memory(encoded);
         if (result == NULL)
@@ -366,3 +528,102 @@ STRING_HANDLE Base64_Encoder(BUFFER_HANDLE input)
     }
     return result;
 }
+
+int Base64_EncodeInto(const unsigned char* source, size_t size, char* destination, size_t destinationSize)
+{
+    int result;
+
+    /*Codes_SRS_BASE64_99_001: [ If source or destination is NULL then Base64_EncodeInto shall fail and return a non-zero value. ]*/
+    if ((source == NULL) ||
+        (destination == NULL))
+    {
+        LogError("invalid arg const unsigned char* source=%p, char* destination=%p", source, destination);
+        result = __FAILURE__;
+    }
+    /*Codes_SRS_BASE64_99_002: [ If destinationSize is smaller than BASE64_ENCODED_SIZE(size) then Base64_EncodeInto shall fail and return a non-zero value. ]*/
+    else if (destinationSize < BASE64_ENCODED_SIZE(size))
+    {
+        LogError("destination too small: %lu bytes, %lu needed", (unsigned long)destinationSize, (unsigned long)BASE64_ENCODED_SIZE(size));
+        result = __FAILURE__;
+    }
+    else
+    {
+        /*Codes_SRS_BASE64_99_003: [ Otherwise Base64_EncodeInto shall write the base64 encoding of the size bytes at source followed by a '\0' to destination and return 0. ]*/
+        destination[Base64encode(source, size, destination)] = '\0';
+        result = 0;
+    }
+
+    return result;
+}
+
+int Base64_DecodeInto(const char* source, size_t sourceLength, unsigned char* destination, size_t destinationSize, size_t* decodedSize)
+{
+    int result;
+
+    /*Codes_SRS_BASE64_99_004: [ If source, destination or decodedSize is NULL then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+    if ((source == NULL) ||
+        (destination == NULL) ||
+        (decodedSize == NULL))
+    {
+        LogError("invalid arg const char* source=%p, unsigned char* destination=%p, size_t* decodedSize=%p", source, destination, decodedSize);
+        result = __FAILURE__;
+    }
+    /*Codes_SRS_BASE64_99_005: [ If sourceLength is not a multiple of 4 then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+    else if ((sourceLength % 4) != 0)
+    {
+        LogError("Invalid length Base64 string!");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t neededSize = Base64decode_len(source, sourceLength);
+
+        /*Codes_SRS_BASE64_99_006: [ If destinationSize is smaller than the size of the decoded data then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+        if (destinationSize < neededSize)
+        {
+            LogError("destination too small: %lu bytes, %lu needed", (unsigned long)destinationSize, (unsigned long)neededSize);
+            result = __FAILURE__;
+        }
+        else if (sourceLength == 0)
+        {
+            *decodedSize = 0;
+            result = 0;
+        }
+        else
+        {
+            size_t fullQuartets = sourceLength / 4 - 1;
+            const char* last = source + fullQuartets * 4;
+            unsigned char c1 = base64DecodeTable[(unsigned char)last[0]];
+            unsigned char c2 = base64DecodeTable[(unsigned char)last[1]];
+            unsigned char c3 = (last[2] == '=') ? 0 : base64DecodeTable[(unsigned char)last[2]];
+            unsigned char c4 = (last[3] == '=') ? 0 : base64DecodeTable[(unsigned char)last[3]];
+
+            /*Codes_SRS_BASE64_99_007: [ If source contains anything but base64 characters and one or two '=' at its end then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+            if ((Base64decodeQuartets(source, fullQuartets, destination) != fullQuartets) ||
+                ((c1 | c2 | c3 | c4) == BASE64_INVALID) ||
+                ((last[2] == '=') && (last[3] != '=')))
+            {
+                LogError("Invalid character in Base64 string");
+                result = __FAILURE__;
+            }
+            else
+            {
+                /*Codes_SRS_BASE64_99_008: [ Otherwise Base64_DecodeInto shall write the decoded bytes to destination, set decodedSize to their count and return 0. ]*/
+                unsigned char* tail = destination + fullQuartets * 3;
+                tail[0] = (unsigned char)((c1 << 2) | (c2 >> 4));
+                if (last[2] != '=')
+                {
+                    tail[1] = (unsigned char)((c2 << 4) | (c3 >> 2));
+                    if (last[3] != '=')
+                    {
+                        tail[2] = (unsigned char)((c3 << 6) | c4);
+                    }
+                }
+                *decodedSize = neededSize;
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,270 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <time.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/dns_cache.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+typedef struct DNS_CACHE_ENTRY_TAG
+{
+    char* hostname;
+    uint32_t ipv4;
+    time_t resolved_time;
+    uint32_t ttl_seconds;
+} DNS_CACHE_ENTRY;
+
+static LOCK_HANDLE dns_cache_lock = NULL;
+static size_t dns_cache_init_count = 0;
+static uint32_t dns_cache_ttl_seconds = DNS_CACHE_DEFAULT_TTL_SECONDS;
+static DNS_CACHE_ENTRY dns_cache_entries[DNS_CACHE_MAX_ENTRIES];
+
+static bool hostname_equals(const char* left, const char* right)
+{
+    while ((*left != '\0') && (tolower((unsigned char)*left) == tolower((unsigned char)*right)))
+    {
+        left++;
+        right++;
+    }
+
+    return tolower((unsigned char)*left) == tolower((unsigned char)*right);
+}
+
+static DNS_CACHE_ENTRY* find_entry(const char* hostname)
+{
+    DNS_CACHE_ENTRY* result = NULL;
+    size_t i;
+
+    for (i = 0; i < DNS_CACHE_MAX_ENTRIES; i++)
+    {
+        if ((dns_cache_entries[i].hostname != NULL) && hostname_equals(dns_cache_entries[i].hostname, hostname))
+        {
+            result = &dns_cache_entries[i];
+            break;
+        }
+    }
+
+    return result;
+}
+
+static void clear_entry(DNS_CACHE_ENTRY* entry)
+{
+    if (entry->hostname != NULL)
+    {
+        free(entry->hostname);
+        entry->hostname = NULL;
+        entry->ipv4 = 0;
+    }
+}
+
+static bool is_expired(const DNS_CACHE_ENTRY* entry, time_t now)
+{
+    bool result;
+
+    if ((entry->resolved_time == (time_t)-1) || (now == (time_t)-1))
+    {
+        result = true;
+    }
+    else
+    {
+        double age = get_difftime(now, entry->resolved_time);
+        result = (age < 0) || (age >= (double)entry->ttl_seconds);
+    }
+
+    return result;
+}
+
+int dns_cache_init(void)
+{
+    int result;
+
+    if (dns_cache_init_count > 0)
+    {
+        /* Codes_SRS_DNS_CACHE_99_002: [ If the cache is already initialized, dns_cache_init shall only count the call and return 0. ]*/
+        dns_cache_init_count++;
+        result = 0;
+    }
+    /* Codes_SRS_DNS_CACHE_99_001: [ dns_cache_init shall create the lock guarding the cache. ]*/
+    else if ((dns_cache_lock = Lock_Init()) == NULL)
+    {
+        /* Codes_SRS_DNS_CACHE_99_003: [ If Lock_Init fails, dns_cache_init shall log an error and return a non-zero value. ]*/
+        LogError("Failed creating the DNS cache lock");
+        result = __FAILURE__;
+    }
+    else
+    {
+        dns_cache_init_count = 1;
+        result = 0;
+    }
+
+    return result;
+}
+
+void dns_cache_deinit(void)
+{
+    if (dns_cache_init_count == 0)
+    {
+        /* Codes_SRS_DNS_CACHE_99_005: [ If the cache is not initialized, dns_cache_deinit shall do nothing. ]*/
+        LogError("DNS cache is not initialized");
+    }
+    else if (--dns_cache_init_count == 0)
+    {
+        size_t i;
+
+        /* Codes_SRS_DNS_CACHE_99_004: [ The dns_cache_deinit call matching the first dns_cache_init shall free every entry and the lock. ]*/
+        for (i = 0; i < DNS_CACHE_MAX_ENTRIES; i++)
+        {
+            clear_entry(&dns_cache_entries[i]);
+        }
+        (void)Lock_Deinit(dns_cache_lock);
+        dns_cache_lock = NULL;
+    }
+}
+
+void dns_cache_set_ttl(uint32_t ttl_seconds)
+{
+    /* Codes_SRS_DNS_CACHE_99_006: [ dns_cache_set_ttl shall set the time to live of addresses added afterwards. ]*/
+    dns_cache_ttl_seconds = ttl_seconds;
+}
+
+int dns_cache_get_ipv4(const char* hostname, uint32_t* ipv4)
+{
+    int result;
+
+    if ((hostname == NULL) || (ipv4 == NULL))
+    {
+        /* Codes_SRS_DNS_CACHE_99_010: [ If hostname or ipv4 is NULL, dns_cache_get_ipv4 shall log an error and return a non-zero value. ]*/
+        LogError("Invalid argument: hostname %p, ipv4 %p", hostname, ipv4);
+        result = __FAILURE__;
+    }
+    else if (dns_cache_init_count == 0)
+    {
+        /* Codes_SRS_DNS_CACHE_99_011: [ If the cache is not initialized, dns_cache_get_ipv4 shall return a non-zero value. ]*/
+        result = __FAILURE__;
+    }
+    else if (Lock(dns_cache_lock) != LOCK_OK)
+    {
+        LogError("Failed locking the DNS cache");
+        result = __FAILURE__;
+    }
+    else
+    {
+        DNS_CACHE_ENTRY* entry = find_entry(hostname);
+        if (entry == NULL)
+        {
+            /* Codes_SRS_DNS_CACHE_99_013: [ If hostname is not cached, dns_cache_get_ipv4 shall return a non-zero value. ]*/
+            result = __FAILURE__;
+        }
+        else if (is_expired(entry, get_time(NULL)))
+        {
+            /* Codes_SRS_DNS_CACHE_99_014: [ If the cached address is at least its time to live old, dns_cache_get_ipv4 shall drop it and return a non-zero value. ]*/
+            clear_entry(entry);
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_DNS_CACHE_99_012: [ If hostname has an unexpired address, dns_cache_get_ipv4 shall store it in ipv4 and return 0. ]*/
+            *ipv4 = entry->ipv4;
+            result = 0;
+        }
+        (void)Unlock(dns_cache_lock);
+    }
+
+    return result;
+}
+
+int dns_cache_add_ipv4(const char* hostname, uint32_t ipv4)
+{
+    int result;
+
+    if ((hostname == NULL) || (ipv4 == 0))
+    {
+        /* Codes_SRS_DNS_CACHE_99_020: [ If hostname is NULL or ipv4 is 0, dns_cache_add_ipv4 shall log an error and return a non-zero value. ]*/
+        LogError("Invalid argument: hostname %p, ipv4 %lu", hostname, (unsigned long)ipv4);
+        result = __FAILURE__;
+    }
+    else if ((dns_cache_init_count == 0) || (dns_cache_ttl_seconds == 0))
+    {
+        /* Codes_SRS_DNS_CACHE_99_021: [ If the cache is not initialized or the time to live is 0, dns_cache_add_ipv4 shall return a non-zero value. ]*/
+        result = __FAILURE__;
+    }
+    else if (Lock(dns_cache_lock) != LOCK_OK)
+    {
+        LogError("Failed locking the DNS cache");
+        result = __FAILURE__;
+    }
+    else
+    {
+        DNS_CACHE_ENTRY* entry = find_entry(hostname);
+
+        if (entry == NULL)
+        {
+            size_t i;
+
+            /* Codes_SRS_DNS_CACHE_99_023: [ A new host name shall take a free entry or else the least recently resolved one. ]*/
+            entry = &dns_cache_entries[0];
+            for (i = 0; i < DNS_CACHE_MAX_ENTRIES; i++)
+            {
+                if (dns_cache_entries[i].hostname == NULL)
+                {
+                    entry = &dns_cache_entries[i];
+                    break;
+                }
+                else if (get_difftime(dns_cache_entries[i].resolved_time, entry->resolved_time) < 0)
+                {
+                    entry = &dns_cache_entries[i];
+                }
+            }
+            clear_entry(entry);
+
+            if (mallocAndStrcpy_s(&entry->hostname, hostname) != 0)
+            {
+                /* Codes_SRS_DNS_CACHE_99_024: [ If copying hostname fails, dns_cache_add_ipv4 shall log an error and return a non-zero value. ]*/
+                LogError("Failed copying the host name");
+                entry = NULL;
+            }
+        }
+
+        if (entry == NULL)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            /* Codes_SRS_DNS_CACHE_99_022: [ dns_cache_add_ipv4 shall store ipv4 for hostname with the current time and time to live and return 0. ]*/
+            entry->ipv4 = ipv4;
+            entry->resolved_time = get_time(NULL);
+            entry->ttl_seconds = dns_cache_ttl_seconds;
+            result = 0;
+        }
+        (void)Unlock(dns_cache_lock);
+    }
+
+    return result;
+}
+
+void dns_cache_remove(const char* hostname)
+{
+    if (hostname == NULL)
+    {
+        /* Codes_SRS_DNS_CACHE_99_030: [ If hostname is NULL, dns_cache_remove shall log an error and do nothing. ]*/
+        LogError("NULL hostname");
+    }
+    else if ((dns_cache_init_count != 0) && (Lock(dns_cache_lock) == LOCK_OK))
+    {
+        /* Codes_SRS_DNS_CACHE_99_031: [ dns_cache_remove shall drop the address cached for hostname, if any. ]*/
+        DNS_CACHE_ENTRY* entry = find_entry(hostname);
+        if (entry != NULL)
+        {
+            clear_entry(entry);
+        }
+        (void)Unlock(dns_cache_lock);
+    }
+}
@@ -79,9 +79,10 @@ HTTPAPIEX_HANDLE HTTPAPIEX_Create(const char* hostName)
 }
 
 /*this function builds the default request http headers if none are specified*/
+/*Content-Length is the size of requestContent, or contentLength when requestContent is NULL*/
 /*returns 0 if no error*/
 /*any other code is error*/
-static int buildRequestHttpHeadersHandle(HTTPAPIEX_HANDLE_DATA *handleData, BUFFER_HANDLE requestContent, HTTP_HEADERS_HANDLE originalRequestHttpHeadersHandle, bool* isOriginalRequestHttpHeadersHandle, HTTP_HEADERS_HANDLE* toBeUsedRequestHttpHeadersHandle)
+static int buildRequestHttpHeadersHandle(HTTPAPIEX_HANDLE_DATA *handleData, BUFFER_HANDLE requestContent, size_t contentLength, HTTP_HEADERS_HANDLE originalRequestHttpHeadersHandle, bool* isOriginalRequestHttpHeadersHandle, HTTP_HEADERS_HANDLE* toBeUsedRequestHttpHeadersHandle)
 {
     int result;
 
@@ -110,7 +111,7 @@ static int buildRequestHttpHeadersHandle(HTTPAPIEX_HANDLE_DATA *handleData, BUFF
     else
     {
         char temp[22] = { 0 };
-        (void)size_tToString(temp, 22, BUFFER_length(requestContent)); /*cannot fail, MAX_uint64 has 19 digits*/
+        (void)size_tToString(temp, 22, (requestContent != NULL) ? BUFFER_length(requestContent) : contentLength); /*cannot fail, MAX_uint64 has 19 digits*/
         /*Codes_SRS_HTTPAPIEX_02_011: [If parameter requestHttpHeadersHandle is not NULL then HTTPAPIEX_ExecuteRequest shall create or update the following headers of the request:
         Host:{hostname}
         Content-Length:the size of the requestContent parameter, and shall use the so constructed HTTPHEADERS object to all calls to HTTPAPI_ExecuteRequest as parameter httpHeadersHandle.]
@@ -213,7 +214,7 @@ static int buildAllRequests(HTTPAPIEX_HANDLE_DATA* handle, HTTPAPI_REQUEST_TYPE
     }
     else
     {
-        if (buildRequestHttpHeadersHandle(handle, *toBeUsedRequestContent, requestHttpHeadersHandle, isOriginalRequestHttpHeadersHandle, toBeUsedRequestHttpHeadersHandle) != 0)
+        if (buildRequestHttpHeadersHandle(handle, *toBeUsedRequestContent, 0, requestHttpHeadersHandle, isOriginalRequestHttpHeadersHandle, toBeUsedRequestHttpHeadersHandle) != 0)
         {
             /*Codes_SRS_HTTPAPIEX_02_010: [If any of the operations in SRS_HTTAPIEX_02_009 fails, then HTTPAPIEX_ExecuteRequest shall return HTTPAPIEX_ERROR.] */
             if (*isOriginalRequestContent == false) 
@@ -294,6 +295,155 @@ static int buildAllRequests(HTTPAPIEX_HANDLE_DATA* handle, HTTPAPI_REQUEST_TYPE
     return result;
 }
 
+/*runs HTTPAPI_Init, HTTPAPI_CreateConnection and HTTPAPI_ExecuteRequest, going back a step when one fails*/
+/*the body is read from requestBuffer at every attempt when requestBuffer is not NULL, otherwise content and contentLength are sent as they are*/
+static HTTPAPIEX_RESULT executeWithRecovery(HTTPAPIEX_HANDLE_DATA* handleData, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestBuffer, const unsigned char* content, size_t contentLength, unsigned int* statusCode,
+    HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    HTTPAPIEX_RESULT result = HTTPAPIEX_RECOVERYFAILED;
+    bool isDone = false;
+
+    /*Codes_SRS_HTTPAPIEX_02_023: [HTTPAPIEX_ExecuteRequest shall try to execute the HTTP call by ensuring the following API call sequence is respected:]*/
+    /*Codes_SRS_HTTPAPIEX_02_024: [If any point in the sequence fails, HTTPAPIEX_ExecuteRequest shall attempt to recover by going back to the previous step and retrying that step.]*/
+    /*Codes_SRS_HTTPAPIEX_02_025: [If the first step fails, then the sequence fails.]*/
+    /*Codes_SRS_HTTPAPIEX_02_026: [A step shall be retried at most once.]*/
+    /*Codes_SRS_HTTPAPIEX_02_027: [If a step has been retried then all subsequent steps shall be retried too.]*/
+    bool st[3] = { false, false, false }; /*the three levels of possible failure in resilient send: HTTAPI_Init, HTTPAPI_CreateConnection, HTTPAPI_ExecuteRequest*/
+    if (handleData->k == -1)
+    {
+        handleData->k = 0;
+    }
+
+    do
+    {
+        bool goOn;
+
+        if (handleData->k > 2)
+        {
+            /* error */
+            break;
+        }
+
+        if (st[handleData->k] == true) /*already been tried*/
+        {
+            goOn = false;
+        }
+        else
+        {
+            switch (handleData->k)
+            {
+            case 0:
+            {
+                if (HTTPAPI_Init() != HTTPAPI_OK)
+                {
+                    goOn = false;
+                }
+                else
+                {
+                    goOn = true;
+                }
+                break;
+            }
+            case 1:
+            {
+                if ((handleData->httpHandle = HTTPAPI_CreateConnection(STRING_c_str(handleData->hostName))) == NULL)
+                {
+                    goOn = false;
+                }
+                else
+                {
+                    size_t i;
+                    size_t vectorSize = VECTOR_size(handleData->savedOptions);
+                    for (i = 0; i < vectorSize; i++)
+                    {
+                        /*Codes_SRS_HTTPAPIEX_02_035: [HTTPAPIEX_ExecuteRequest shall pass all the saved options (see HTTPAPIEX_SetOption) to the newly create HTTPAPI_HANDLE in step 2 by calling HTTPAPI_SetOption.]*/
+                        /*Codes_SRS_HTTPAPIEX_02_036: [If setting the option fails, then the failure shall be ignored.] */
+                        HTTPAPIEX_SAVED_OPTION* option = (HTTPAPIEX_SAVED_OPTION*)VECTOR_element(handleData->savedOptions, i);
+                        if (HTTPAPI_SetOption(handleData->httpHandle, option->optionName, option->value) != HTTPAPI_OK)
+                        {
+                            LogError("HTTPAPI_SetOption failed when called for option %s", option->optionName);
+                        }
+                    }
+                    goOn = true;
+                }
+                break;
+            }
+            case 2:
+            {
+                size_t length = (requestBuffer != NULL) ? BUFFER_length(requestBuffer) : contentLength;
+                const unsigned char* buffer = (requestBuffer != NULL) ? BUFFER_u_char(requestBuffer) : content;
+                if (HTTPAPI_ExecuteRequest(handleData->httpHandle, requestType, relativePath, requestHttpHeadersHandle, buffer, length, statusCode, responseHttpHeadersHandle, responseContent) != HTTPAPI_OK)
+                {
+                    goOn = false;
+                }
+                else
+                {
+                    goOn = true;
+                }
+                break;
+            }
+            default:
+            {
+                /*serious error*/
+                goOn = false;
+                break;
+            }
+            }
+        }
+
+        if (goOn)
+        {
+            if (handleData->k == 2)
+            {
+                /*Codes_SRS_HTTPAPIEX_02_028: [HTTPAPIEX_ExecuteRequest shall return HTTPAPIEX_OK when a call to HTTPAPI_ExecuteRequest has been completed successfully.]*/
+                result = HTTPAPIEX_OK;
+                isDone = true;
+            }
+            else
+            {
+                st[handleData->k] = true;
+                handleData->k++;
+                st[handleData->k] = false;
+            }
+        }
+        else
+        {
+            st[handleData->k] = false;
+            handleData->k--;
+            switch (handleData->k)
+            {
+            case 0:
+            {
+                HTTPAPI_Deinit();
+                break;
+            }
+            case 1:
+            {
+                HTTPAPI_CloseConnection(handleData->httpHandle);
+                handleData->httpHandle = NULL;
+                break;
+            }
+            case 2:
+            {
+                break;
+            }
+            default:
+            {
+                break;
+            }
+            }
+        }
+    } while (!isDone && (handleData->k >= 0));
+
+    if (!isDone)
+    {
+        /*Codes_SRS_HTTPAPIEX_02_029: [Otherwise, HTTAPIEX_ExecuteRequest shall return HTTPAPIEX_RECOVERYFAILED.] */
+        LogError("unable to recover sending to a working state");
+    }
+    return result;
+}
+
 HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
     HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode,
     HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
@@ -338,142 +488,7 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
             }
             else
             {
-
-                /*Codes_SRS_HTTPAPIEX_02_023: [HTTPAPIEX_ExecuteRequest shall try to execute the HTTP call by ensuring the following API call sequence is respected:]*/
-                /*Codes_SRS_HTTPAPIEX_02_024: [If any point in the sequence fails, HTTPAPIEX_ExecuteRequest shall attempt to recover by going back to the previous step and retrying that step.]*/
-                /*Codes_SRS_HTTPAPIEX_02_025: [If the first step fails, then the sequence fails.]*/
-                /*Codes_SRS_HTTPAPIEX_02_026: [A step shall be retried at most once.]*/
-                /*Codes_SRS_HTTPAPIEX_02_027: [If a step has been retried then all subsequent steps shall be retried too.]*/
-                bool st[3] = { false, false, false }; /*the three levels of possible failure in resilient send: HTTAPI_Init, HTTPAPI_CreateConnection, HTTPAPI_ExecuteRequest*/
-                if (handleData->k == -1)
-                {
-                    handleData->k = 0;
-                }
-
-                do
-                {
-                    bool goOn;
-
-                    if (handleData->k > 2)
-                    {
-                        /* error */
-                        break;
-                    }
-
-                    if (st[handleData->k] == true) /*already been tried*/
-                    {
-                        goOn = false;
-                    }
-                    else
-                    {
-                        switch (handleData->k)
-                        {
-                        case 0:
-                        {
-                            if (HTTPAPI_Init() != HTTPAPI_OK)
-                            {
-                                goOn = false;
-                            }
-                            else
-                            {
-                                goOn = true;
-                            }
-                            break;
-                        }
-                        case 1:
-                        {
-                            if ((handleData->httpHandle = HTTPAPI_CreateConnection(STRING_c_str(handleData->hostName))) == NULL)
-                            {
-                                goOn = false;
-                            }
-                            else
-                            {
-                                size_t i;
-                                size_t vectorSize = VECTOR_size(handleData->savedOptions);
-                                for (i = 0; i < vectorSize; i++)
-                                {
-                                    /*Codes_SRS_HTTPAPIEX_02_035: [HTTPAPIEX_ExecuteRequest shall pass all the saved options (see HTTPAPIEX_SetOption) to the newly create HTTPAPI_HANDLE in step 2 by calling HTTPAPI_SetOption.]*/
-                                    /*Codes_SRS_HTTPAPIEX_02_036: [If setting the option fails, then the failure shall be ignored.] */
-                                    HTTPAPIEX_SAVED_OPTION* option = (HTTPAPIEX_SAVED_OPTION*)VECTOR_element(handleData->savedOptions, i);
-                                    if (HTTPAPI_SetOption(handleData->httpHandle, option->optionName, option->value) != HTTPAPI_OK)
-                                    {
-                                        LogError("HTTPAPI_SetOption failed when called for option %s", option->optionName);
-                                    }
-                                }
-                                goOn = true;
-                            }
-                            break;
-                        }
-                        case 2:
-                        {
-                            size_t length = BUFFER_length(toBeUsedRequestContent);
-                            unsigned char* buffer = BUFFER_u_char(toBeUsedRequestContent);
-                            if (HTTPAPI_ExecuteRequest(handleData->httpHandle, requestType, toBeUsedRelativePath, toBeUsedRequestHttpHeadersHandle, buffer, length, toBeUsedStatusCode, toBeUsedResponseHttpHeadersHandle, toBeUsedResponseContent) != HTTPAPI_OK)
-                            {
-                                goOn = false;
-                            }
-                            else
-                            {
-                                goOn = true;
-                            }
-                            break;
-                        }
-                        default:
-                        {
-                            /*serious error*/
-                            goOn = false;
-                            break;
-                        }
-                        }
-                    }
-
-                    if (goOn)
-                    {
-                        if (handleData->k == 2)
-                        {
-                            /*Codes_SRS_HTTPAPIEX_02_028: [HTTPAPIEX_ExecuteRequest shall return HTTPAPIEX_OK when a call to HTTPAPI_ExecuteRequest has been completed successfully.]*/
-                            result = HTTPAPIEX_OK;
-                            goto out;
-                        }
-                        else
-                        {
-                            st[handleData->k] = true;
-                            handleData->k++;
-                            st[handleData->k] = false;
-                        }
-                    }
-                    else
-                    {
-                        st[handleData->k] = false;
-                        handleData->k--;
-                        switch (handleData->k)
-                        {
-                        case 0:
-                        {
-                            HTTPAPI_Deinit();
-                            break;
-                        }
-                        case 1:
-                        {
-                            HTTPAPI_CloseConnection(handleData->httpHandle);
-                            handleData->httpHandle = NULL;
-                            break;
-                        }
-                        case 2:
-                        {
-                            break;
-                        }
-                        default:
-                        {
-                            break;
-                        }
-                        }
-                    }
-                } while (handleData->k >= 0);
-                /*Codes_SRS_HTTPAPIEX_02_029: [Otherwise, HTTAPIEX_ExecuteRequest shall return HTTPAPIEX_RECOVERYFAILED.] */
-                result = HTTPAPIEX_RECOVERYFAILED;
-                LogError("unable to recover sending to a working state");
-            out:;
+                result = executeWithRecovery(handleData, requestType, toBeUsedRelativePath, toBeUsedRequestHttpHeadersHandle, toBeUsedRequestContent, NULL, 0, toBeUsedStatusCode, toBeUsedResponseHttpHeadersHandle, toBeUsedResponseContent);
                 /*in all cases, unbuild the temporaries*/
                 if (isOriginalRequestContent == false)
                 {
@@ -497,6 +512,80 @@ HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUE
     return result;
 }
 
+HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequestWithContent(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE requestHttpHeadersHandle, const unsigned char* content, size_t contentLength, unsigned int* statusCode,
+    HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    HTTPAPIEX_RESULT result;
+    /*Codes_SRS_HTTPAPIEX_99_001: [ If handle is NULL, requestType does not indicate a valid request, or content is NULL and contentLength is not 0, then HTTPAPIEX_ExecuteRequestWithContent shall fail and return HTTPAPIEX_INVALID_ARG. ]*/
+    if ((handle == NULL) ||
+        (requestType >= COUNT_ARG(HTTPAPI_REQUEST_TYPE_VALUES)) ||
+        ((content == NULL) && (contentLength != 0)))
+    {
+        result = HTTPAPIEX_INVALID_ARG;
+        LOG_HTTAPIEX_ERROR();
+    }
+    else
+    {
+        HTTPAPIEX_HANDLE_DATA *handleData = (HTTPAPIEX_HANDLE_DATA *)handle;
+        HTTP_HEADERS_HANDLE toBeUsedRequestHttpHeadersHandle; bool isOriginalRequestHttpHeadersHandle;
+        HTTP_HEADERS_HANDLE toBeUsedResponseHttpHeadersHandle; bool isOriginalResponseHttpHeadersHandle;
+        BUFFER_HANDLE toBeUsedResponseContent; bool isOriginalResponseContent;
+
+        /*Codes_SRS_HTTPAPIEX_99_002: [ HTTPAPIEX_ExecuteRequestWithContent shall build the request headers, relative path, status code, response headers and response content as HTTPAPIEX_ExecuteRequest does, using contentLength for Content-Length. ]*/
+        if (buildRequestHttpHeadersHandle(handleData, NULL, contentLength, requestHttpHeadersHandle, &isOriginalRequestHttpHeadersHandle, &toBeUsedRequestHttpHeadersHandle) != 0)
+        {
+            /*Codes_SRS_HTTPAPIEX_99_003: [ If building any of them fails, HTTPAPIEX_ExecuteRequestWithContent shall fail and return HTTPAPIEX_ERROR. ]*/
+            result = HTTPAPIEX_ERROR;
+            LOG_HTTAPIEX_ERROR();
+        }
+        else if (buildResponseHttpHeadersHandle(responseHttpHeadersHandle, &isOriginalResponseHttpHeadersHandle, &toBeUsedResponseHttpHeadersHandle) != 0)
+        {
+            /*Codes_SRS_HTTPAPIEX_99_003: [ If building any of them fails, HTTPAPIEX_ExecuteRequestWithContent shall fail and return HTTPAPIEX_ERROR. ]*/
+            if (isOriginalRequestHttpHeadersHandle == false)
+            {
+                HTTPHeaders_Free(toBeUsedRequestHttpHeadersHandle);
+            }
+            result = HTTPAPIEX_ERROR;
+            LOG_HTTAPIEX_ERROR();
+        }
+        else if (buildBufferIfNotExist(responseContent, &isOriginalResponseContent, &toBeUsedResponseContent) != 0)
+        {
+            /*Codes_SRS_HTTPAPIEX_99_003: [ If building any of them fails, HTTPAPIEX_ExecuteRequestWithContent shall fail and return HTTPAPIEX_ERROR. ]*/
+            if (isOriginalRequestHttpHeadersHandle == false)
+            {
+                HTTPHeaders_Free(toBeUsedRequestHttpHeadersHandle);
+            }
+            if (isOriginalResponseHttpHeadersHandle == false)
+            {
+                HTTPHeaders_Free(toBeUsedResponseHttpHeadersHandle);
+            }
+            result = HTTPAPIEX_ERROR;
+            LOG_HTTAPIEX_ERROR();
+        }
+        else
+        {
+            /*Codes_SRS_HTTPAPIEX_99_004: [ HTTPAPIEX_ExecuteRequestWithContent shall pass content and contentLength, without copying them, to every HTTPAPI_ExecuteRequest call and shall recover from failures as HTTPAPIEX_ExecuteRequest does. ]*/
+            result = executeWithRecovery(handleData, requestType, (relativePath == NULL) ? "" : relativePath, toBeUsedRequestHttpHeadersHandle, NULL, content, contentLength,
+                (statusCode == NULL) ? &dummyStatusCode : statusCode, toBeUsedResponseHttpHeadersHandle, toBeUsedResponseContent);
+
+            if (isOriginalRequestHttpHeadersHandle == false)
+            {
+                HTTPHeaders_Free(toBeUsedRequestHttpHeadersHandle);
+            }
+            if (isOriginalResponseContent == false)
+            {
+                BUFFER_delete(toBeUsedResponseContent);
+            }
+            if (isOriginalResponseHttpHeadersHandle == false)
+            {
+                HTTPHeaders_Free(toBeUsedResponseHttpHeadersHandle);
+            }
+        }
+    }
+    return result;
+}
+
 
 void HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
 {
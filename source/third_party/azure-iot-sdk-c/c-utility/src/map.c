@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/map.h"
 #include "azure_c_shared_utility/optimize_size.h"
@@ -16,10 +17,58 @@ typedef struct MAP_HANDLE_DATA_TAG
     char** values;
     size_t count;
     MAP_FILTER_CALLBACK mapFilterCallback;
+    /*only for maps made by Map_CreateInPlace: the map, its first entries and as many strings as fit live in storage*/
+    unsigned char* storage;
+    size_t storageSize;
+    size_t storageUsed;
+    size_t inlineEntries;
 }MAP_HANDLE_DATA;
 
 #define LOG_MAP_ERROR LogError("result = %s", ENUM_TO_STRING(MAP_RESULT, result));
 
+#define MAP_ALIGN_TO_POINTER(size) (((size) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+static bool isInStorage(const MAP_HANDLE_DATA* handleData, const void* pointer)
+{
+    const unsigned char* bytes = (const unsigned char*)pointer;
+    return (handleData->storage != NULL) &&
+        (bytes >= handleData->storage) &&
+        (bytes < handleData->storage + handleData->storageSize);
+}
+
+/*strings go in the storage while it has room, the heap otherwise*/
+static int copyString(MAP_HANDLE_DATA* handleData, char** destination, const char* source)
+{
+    int result;
+    size_t size;
+    if ((handleData->storage != NULL) &&
+        ((size = strlen(source) + 1) <= handleData->storageSize - handleData->storageUsed))
+    {
+        *destination = (char*)handleData->storage + handleData->storageUsed;
+        (void)memcpy(*destination, source, size);
+        handleData->storageUsed += size;
+        result = 0;
+    }
+    else
+    {
+        result = mallocAndStrcpy_s(destination, source);
+    }
+    return result;
+}
+
+/*room in the storage is only given back when the string is the last one placed*/
+static void releaseString(MAP_HANDLE_DATA* handleData, char* string)
+{
+    if (!isInStorage(handleData, string))
+    {
+        free(string);
+    }
+    else if ((unsigned char*)string + strlen(string) + 1 == handleData->storage + handleData->storageUsed)
+    {
+        handleData->storageUsed = (unsigned char*)string - handleData->storage;
+    }
+}
+
 MAP_HANDLE Map_Create(MAP_FILTER_CALLBACK mapFilterFunc)
 {
     /*Codes_SRS_MAP_02_001: [Map_Create shall create a new, empty map.]*/
@@ -32,6 +81,44 @@ MAP_HANDLE Map_Create(MAP_FILTER_CALLBACK mapFilterFunc)
         result->values = NULL;
         result->count = 0;
         result->mapFilterCallback = mapFilterFunc;
+        result->storage = NULL;
+        result->storageSize = 0;
+        result->storageUsed = 0;
+        result->inlineEntries = 0;
+    }
+    return (MAP_HANDLE)result;
+}
+
+size_t Map_GetInPlaceSize(size_t inlineEntries)
+{
+    /*Codes_SRS_MAP_99_001: [ Map_GetInPlaceSize shall return the bytes of storage taken by the map and the arrays of inlineEntries keys and values, before any string. ]*/
+    return MAP_ALIGN_TO_POINTER(sizeof(MAP_HANDLE_DATA)) + 2 * inlineEntries * sizeof(char*);
+}
+
+MAP_HANDLE Map_CreateInPlace(MAP_FILTER_CALLBACK mapFilterFunc, void* storage, size_t storageSize, size_t inlineEntries)
+{
+    MAP_HANDLE_DATA* result;
+    /*Codes_SRS_MAP_99_002: [ If storage is NULL or not aligned to a pointer, or storageSize is smaller than Map_GetInPlaceSize(inlineEntries), Map_CreateInPlace shall return NULL. ]*/
+    if ((storage == NULL) ||
+        (((uintptr_t)storage % sizeof(void*)) != 0) ||
+        (inlineEntries > (SIZE_MAX - MAP_ALIGN_TO_POINTER(sizeof(MAP_HANDLE_DATA))) / (2 * sizeof(char*))) ||
+        (storageSize < Map_GetInPlaceSize(inlineEntries)))
+    {
+        LogError("invalid arg to Map_CreateInPlace (storage=%p, storageSize=%lu, inlineEntries=%lu)", storage, (unsigned long)storageSize, (unsigned long)inlineEntries);
+        result = NULL;
+    }
+    else
+    {
+        /*Codes_SRS_MAP_99_003: [ Otherwise Map_CreateInPlace shall create an empty map in storage that keeps its first inlineEntries pairs, and as many keys and values as fit, in storage without allocating. ]*/
+        result = (MAP_HANDLE_DATA*)storage;
+        result->storage = (unsigned char*)storage;
+        result->storageSize = storageSize;
+        result->storageUsed = Map_GetInPlaceSize(inlineEntries);
+        result->inlineEntries = inlineEntries;
+        result->keys = (char**)(result->storage + MAP_ALIGN_TO_POINTER(sizeof(MAP_HANDLE_DATA)));
+        result->values = result->keys + inlineEntries;
+        result->count = 0;
+        result->mapFilterCallback = mapFilterFunc;
     }
     return (MAP_HANDLE)result;
 }
@@ -47,12 +134,25 @@ void Map_Destroy(MAP_HANDLE handle)
 
         for (i = 0; i < handleData->count; i++)
         {
-            free(handleData->keys[i]);
-            free(handleData->values[i]);
+            releaseString(handleData, handleData->keys[i]);
+            releaseString(handleData, handleData->values[i]);
+        }
+
+        if (handleData->storage != NULL)
+        {
+            /*Codes_SRS_MAP_99_004: [ Map_Destroy shall only free what a map made by Map_CreateInPlace allocated past its storage. ]*/
+            if (!isInStorage(handleData, handleData->keys))
+            {
+                free(handleData->keys);
+                free(handleData->values);
+            }
+        }
+        else
+        {
+            free(handleData->keys);
+            free(handleData->values);
+            free(handleData);
         }
-        free(handleData->keys);
-        free(handleData->values);
-        free(handleData);
     }
 }
 
@@ -117,6 +217,11 @@ MAP_HANDLE Map_Clone(MAP_HANDLE handle)
         }
         else
         {
+            /*a clone is always allocated, whatever the storage of the map it copies*/
+            result->storage = NULL;
+            result->storageSize = 0;
+            result->storageUsed = 0;
+            result->inlineEntries = 0;
             if (handleData->count == 0)
             {
                 result->count = 0;
@@ -158,6 +263,46 @@ MAP_HANDLE Map_Clone(MAP_HANDLE handle)
     return (MAP_HANDLE)result;
 }
 
+/*the arrays of a map made by Map_CreateInPlace move to the heap once its inline entries are used*/
+static int Map_IncreaseInPlaceKeysValues(MAP_HANDLE_DATA* handleData)
+{
+    int result;
+    if (handleData->count < handleData->inlineEntries)
+    {
+        handleData->keys[handleData->count] = NULL;
+        handleData->values[handleData->count] = NULL;
+        handleData->count++;
+        result = 0;
+    }
+    else
+    {
+        char** newKeys = (char**)malloc((handleData->count + 1) * sizeof(char*));
+        char** newValues = (char**)malloc((handleData->count + 1) * sizeof(char*));
+        if ((newKeys == NULL) || (newValues == NULL))
+        {
+            LogError("malloc error");
+            free(newKeys);
+            free(newValues);
+            result = __FAILURE__;
+        }
+        else
+        {
+            if (handleData->count != 0)
+            {
+                (void)memcpy(newKeys, handleData->keys, handleData->count * sizeof(char*));
+                (void)memcpy(newValues, handleData->values, handleData->count * sizeof(char*));
+            }
+            newKeys[handleData->count] = NULL;
+            newValues[handleData->count] = NULL;
+            handleData->keys = newKeys;
+            handleData->values = newValues;
+            handleData->count++;
+            result = 0;
+        }
+    }
+    return result;
+}
+
 static int Map_IncreaseStorageKeysValues(MAP_HANDLE_DATA* handleData)
 {
     int result;
@@ -208,7 +353,12 @@ static int Map_IncreaseStorageKeysValues(MAP_HANDLE_DATA* handleData)
 
 static void Map_DecreaseStorageKeysValues(MAP_HANDLE_DATA* handleData)
 {
-    if (handleData->count == 1)
+    if (handleData->storage != NULL)
+    {
+        /*a map made by Map_CreateInPlace keeps its arrays for the next insert*/
+        handleData->count--;
+    }
+    else if (handleData->count == 1)
     {
         free(handleData->keys);
         handleData->keys = NULL;
@@ -294,13 +444,14 @@ static char** findValue(MAP_HANDLE_DATA* handleData, const char* value)
 static int insertNewKeyValue(MAP_HANDLE_DATA* handleData, const char* key, const char* value)
 {
     int result;
-    if (Map_IncreaseStorageKeysValues(handleData) != 0) /*this increases handleData->count*/
+    /*this increases handleData->count*/
+    if ((isInStorage(handleData, handleData->keys) ? Map_IncreaseInPlaceKeysValues(handleData) : Map_IncreaseStorageKeysValues(handleData)) != 0)
     {
         result = __FAILURE__;
     }
     else
     {
-        if (mallocAndStrcpy_s(&(handleData->keys[handleData->count - 1]), key) != 0)
+        if (copyString(handleData, &(handleData->keys[handleData->count - 1]), key) != 0)
         {
             Map_DecreaseStorageKeysValues(handleData);
             LogError("unable to mallocAndStrcpy_s");
@@ -308,9 +459,9 @@ static int insertNewKeyValue(MAP_HANDLE_DATA* handleData, const char* key, const
         }
         else
         {
-            if (mallocAndStrcpy_s(&(handleData->values[handleData->count - 1]), value) != 0)
+            if (copyString(handleData, &(handleData->values[handleData->count - 1]), value) != 0)
             {
-                free(handleData->keys[handleData->count - 1]);
+                releaseString(handleData, handleData->keys[handleData->count - 1]);
                 Map_DecreaseStorageKeysValues(handleData);
                 LogError("unable to mallocAndStrcpy_s");
                 result = __FAILURE__;
@@ -419,8 +570,29 @@ MAP_RESULT Map_AddOrUpdate(MAP_HANDLE handle, const char* key, const char* value
                 /*Codes_SRS_MAP_02_016: [If the key already exists, then Map_AddOrUpdate shall overwrite the value of the existing key with parameter value.]*/
                 size_t index = whereIsIt - handleData->keys;
                 size_t valueLength = strlen(value);
-                /*try to realloc value of this key*/
-                char* newValue = (char*)realloc(handleData->values[index],valueLength  + 1);
+                char* newValue;
+                if (isInStorage(handleData, handleData->values[index]))
+                {
+                    /*Codes_SRS_MAP_99_005: [ A value kept in the storage of a map made by Map_CreateInPlace shall be overwritten where it is when the new value is not longer, and copied again otherwise. ]*/
+                    if (strlen(handleData->values[index]) >= valueLength)
+                    {
+                        newValue = handleData->values[index];
+                    }
+                    else if (copyString(handleData, &newValue, value) != 0)
+                    {
+                        newValue = NULL;
+                    }
+                    else
+                    {
+                        releaseString(handleData, handleData->values[index]);
+                    }
+                }
+                else
+                {
+                    /*try to realloc value of this key*/
+                    newValue = (char*)realloc(handleData->values[index], valueLength + 1);
+                }
+
                 if (newValue == NULL)
                 {
                     result = MAP_ERROR;
@@ -465,8 +637,8 @@ MAP_RESULT Map_Delete(MAP_HANDLE handle, const char* key)
         {
             /*Codes_SRS_MAP_02_023: [Otherwise, Map_Delete shall remove the key and its associated value from the map and return MAP_OK.]*/
             size_t index = whereIsIt - handleData->keys;
-            free(handleData->keys[index]);
-            free(handleData->values[index]);
+            releaseString(handleData, handleData->keys[index]);
+            releaseString(handleData, handleData->values[index]);
             memmove(handleData->keys + index, handleData->keys + index + 1, (handleData->count - index - 1)*sizeof(char*)); /*if order doesn't matter... then this can be optimized*/
             memmove(handleData->values + index, handleData->values + index + 1, (handleData->count - index - 1)*sizeof(char*));
             Map_DecreaseStorageKeysValues(handleData);
@@ -14,6 +14,26 @@
 #include "azure_c_shared_utility/buffer_.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/sha.h"
+
+#define SAS_TOKEN_PREFIX "SharedAccessSignature sr="
+#define SAS_TOKEN_SIGNATURE "&sig="
+#define SAS_TOKEN_EXPIRY "&se="
+#define SAS_TOKEN_KEY_NAME "&skn="
+/* a base64 encoded SHA-256 digest is 44 characters; url encoding expands each of them to at most 3 */
+#define SAS_SIGNATURE_MAX_LENGTH (((SHA256HashSize + 2) / 3) * 4 * 3)
+#define SAS_EXPIRY_MAX_LENGTH (sizeof(size_t) * 3)
+#define HMAC_INNER_PAD 0x36
+#define HMAC_OUTER_PAD 0x5c
+
+typedef struct SAS_SIGNER_TAG
+{
+    /* SHA-256 states after absorbing the key XOR ipad and key XOR opad blocks */
+    SHA256Context innerContext;
+    SHA256Context outerContext;
+} SAS_SIGNER;
+
+static const char base64Alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
 static double getExpiryValue(const char* expiryASCII)
 {
@@ -344,3 +364,319 @@ STRING_HANDLE SASToken_CreateString(const char* key, const char* scope, const ch
     }
     return result;
 }
+
+static int initialize_signer(SAS_SIGNER* signer, const unsigned char* key, size_t keyLength)
+{
+    int result;
+    unsigned char keyBlock[SHA256_Message_Block_Size];
+    unsigned char pad[SHA256_Message_Block_Size];
+    size_t i;
+
+    (void)memset(keyBlock, 0, sizeof(keyBlock));
+
+    /*Codes_SRS_SASTOKEN_99_004: [ A decoded key longer than the SHA-256 block size shall be replaced by its SHA-256 hash. ]*/
+    if (keyLength > SHA256_Message_Block_Size)
+    {
+        SHA256Context keyContext;
+        if ((SHA256Reset(&keyContext) != shaSuccess) ||
+            (SHA256Input(&keyContext, key, (unsigned int)keyLength) != shaSuccess) ||
+            (SHA256Result(&keyContext, keyBlock) != shaSuccess))
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+        (void)memset(&keyContext, 0, sizeof(keyContext));
+    }
+    else
+    {
+        (void)memcpy(keyBlock, key, keyLength);
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        /*Codes_SRS_SASTOKEN_99_005: [ SASToken_CreateSigner shall hash the key XOR ipad block and the key XOR opad block into two SHA-256 contexts kept by the signer. ]*/
+        for (i = 0; i < SHA256_Message_Block_Size; i++)
+        {
+            pad[i] = keyBlock[i] ^ HMAC_INNER_PAD;
+        }
+
+        if ((SHA256Reset(&signer->innerContext) != shaSuccess) ||
+            (SHA256Input(&signer->innerContext, pad, SHA256_Message_Block_Size) != shaSuccess))
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            for (i = 0; i < SHA256_Message_Block_Size; i++)
+            {
+                pad[i] = keyBlock[i] ^ HMAC_OUTER_PAD;
+            }
+
+            if ((SHA256Reset(&signer->outerContext) != shaSuccess) ||
+                (SHA256Input(&signer->outerContext, pad, SHA256_Message_Block_Size) != shaSuccess))
+            {
+                result = __FAILURE__;
+            }
+        }
+
+        (void)memset(pad, 0, sizeof(pad));
+    }
+
+    (void)memset(keyBlock, 0, sizeof(keyBlock));
+
+    return result;
+}
+
+SAS_SIGNER_HANDLE SASToken_CreateSigner(const char* key)
+{
+    SAS_SIGNER* result;
+
+    /*Codes_SRS_SASTOKEN_99_001: [ If key is NULL then SASToken_CreateSigner shall fail and return NULL. ]*/
+    if (key == NULL)
+    {
+        LogError("Invalid Parameter to SASToken_CreateSigner. key: %p", key);
+        result = NULL;
+    }
+    else
+    {
+        BUFFER_HANDLE decodedKey;
+
+        /*Codes_SRS_SASTOKEN_99_002: [ SASToken_CreateSigner shall decode key from base64. ]*/
+        if ((decodedKey = Base64_Decoder(key)) == NULL)
+        {
+            /*Codes_SRS_SASTOKEN_99_003: [ If the decoding fails then SASToken_CreateSigner shall fail and return NULL. ]*/
+            LogError("Unable to decode the key for the SAS signer.");
+            result = NULL;
+        }
+        else
+        {
+            unsigned char* keyBytes = BUFFER_u_char(decodedKey);
+            size_t keyLength = BUFFER_length(decodedKey);
+
+            if ((keyBytes == NULL) && (keyLength != 0))
+            {
+                /*Codes_SRS_SASTOKEN_99_007: [ If any other error occurs, SASToken_CreateSigner shall fail and return NULL. ]*/
+                LogError("Unable to get the decoded key for the SAS signer.");
+                result = NULL;
+            }
+            else if ((result = (SAS_SIGNER*)malloc(sizeof(SAS_SIGNER))) == NULL)
+            {
+                /*Codes_SRS_SASTOKEN_99_007: [ If any other error occurs, SASToken_CreateSigner shall fail and return NULL. ]*/
+                LogError("Unable to allocate the SAS signer.");
+            }
+            else if (initialize_signer(result, keyBytes, keyLength) != 0)
+            {
+                /*Codes_SRS_SASTOKEN_99_007: [ If any other error occurs, SASToken_CreateSigner shall fail and return NULL. ]*/
+                LogError("Unable to compute the HMAC key schedule for the SAS signer.");
+                (void)memset(result, 0, sizeof(SAS_SIGNER));
+                free(result);
+                result = NULL;
+            }
+            else
+            {
+                /* all is fine */
+            }
+
+            /*Codes_SRS_SASTOKEN_99_006: [ SASToken_CreateSigner shall clear the decoded key before releasing it. ]*/
+            if (keyBytes != NULL)
+            {
+                (void)memset(keyBytes, 0, keyLength);
+            }
+            BUFFER_delete(decodedKey);
+        }
+    }
+
+    return result;
+}
+
+void SASToken_DestroySigner(SAS_SIGNER_HANDLE signer)
+{
+    /*Codes_SRS_SASTOKEN_99_008: [ If signer is NULL, SASToken_DestroySigner shall do nothing. ]*/
+    if (signer != NULL)
+    {
+        /*Codes_SRS_SASTOKEN_99_009: [ SASToken_DestroySigner shall clear and free the signer. ]*/
+        (void)memset(signer, 0, sizeof(SAS_SIGNER));
+        free(signer);
+    }
+}
+
+size_t SASToken_GetMaxTokenSize(const char* scope, const char* keyName)
+{
+    size_t result;
+
+    /*Codes_SRS_SASTOKEN_99_010: [ If scope is NULL, SASToken_GetMaxTokenSize shall return 0. ]*/
+    if (scope == NULL)
+    {
+        LogError("Invalid Parameter to SASToken_GetMaxTokenSize. scope: %p", scope);
+        result = 0;
+    }
+    else
+    {
+        /*Codes_SRS_SASTOKEN_99_011: [ Otherwise SASToken_GetMaxTokenSize shall return the size, including the terminating '\0', of the longest token SASToken_SignInto can produce for scope and keyName. ]*/
+        result = (sizeof(SAS_TOKEN_PREFIX) - 1) + strlen(scope) +
+            (sizeof(SAS_TOKEN_SIGNATURE) - 1) + SAS_SIGNATURE_MAX_LENGTH +
+            (sizeof(SAS_TOKEN_EXPIRY) - 1) + SAS_EXPIRY_MAX_LENGTH +
+            ((keyName == NULL) ? 0 : ((sizeof(SAS_TOKEN_KEY_NAME) - 1) + strlen(keyName))) +
+            1;
+    }
+
+    return result;
+}
+
+static char* write_text(char* destination, const char* text, size_t length)
+{
+    (void)memcpy(destination, text, length);
+    return destination + length;
+}
+
+static char* write_decimal(char* destination, size_t value)
+{
+    char digits[SAS_EXPIRY_MAX_LENGTH];
+    size_t digitCount = 0;
+
+    do
+    {
+        digits[digitCount++] = (char)('0' + (value % 10));
+        value /= 10;
+    } while (value != 0);
+
+    while (digitCount > 0)
+    {
+        *destination++ = digits[--digitCount];
+    }
+
+    return destination;
+}
+
+/* base64 encodes one character and url encodes it the way URL_Encode does */
+static char* write_signature_char(char* destination, unsigned char sextet)
+{
+    char c = base64Alphabet[sextet];
+    if (c == '+')
+    {
+        destination = write_text(destination, "%2b", 3);
+    }
+    else if (c == '/')
+    {
+        destination = write_text(destination, "%2f", 3);
+    }
+    else
+    {
+        *destination++ = c;
+    }
+    return destination;
+}
+
+static char* write_signature(char* destination, const unsigned char digest[SHA256HashSize])
+{
+    size_t i;
+
+    for (i = 0; i + 3 <= SHA256HashSize; i += 3)
+    {
+        destination = write_signature_char(destination, digest[i] >> 2);
+        destination = write_signature_char(destination, (unsigned char)(((digest[i] & 0x03) << 4) | (digest[i + 1] >> 4)));
+        destination = write_signature_char(destination, (unsigned char)(((digest[i + 1] & 0x0F) << 2) | (digest[i + 2] >> 6)));
+        destination = write_signature_char(destination, digest[i + 2] & 0x3F);
+    }
+
+    /* SHA256HashSize leaves 2 bytes: 3 characters and one url encoded '=' */
+    destination = write_signature_char(destination, digest[i] >> 2);
+    destination = write_signature_char(destination, (unsigned char)(((digest[i] & 0x03) << 4) | (digest[i + 1] >> 4)));
+    destination = write_signature_char(destination, (unsigned char)((digest[i + 1] & 0x0F) << 2));
+    destination = write_text(destination, "%3d", 3);
+
+    return destination;
+}
+
+static int compute_outer_hash(SAS_SIGNER* signer, SHA256Context* context, unsigned char digest[SHA256HashSize])
+{
+    int result;
+
+    *context = signer->outerContext;
+    if ((SHA256Input(context, digest, SHA256HashSize) != shaSuccess) ||
+        (SHA256Result(context, digest) != shaSuccess))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+int SASToken_SignInto(SAS_SIGNER_HANDLE signer, const char* scope, const char* keyName, size_t expiry, char* destination, size_t destinationSize)
+{
+    int result;
+
+    /*Codes_SRS_SASTOKEN_99_012: [ If signer, scope or destination is NULL, SASToken_SignInto shall fail and return a non-zero value. ]*/
+    if ((signer == NULL) ||
+        (scope == NULL) ||
+        (destination == NULL))
+    {
+        LogError("Invalid Parameter to SASToken_SignInto. signer: %p, scope: %p, destination: %p", signer, scope, destination);
+        result = __FAILURE__;
+    }
+    /*Codes_SRS_SASTOKEN_99_013: [ If destinationSize is smaller than SASToken_GetMaxTokenSize(scope, keyName), SASToken_SignInto shall fail and return a non-zero value. ]*/
+    else if (destinationSize < SASToken_GetMaxTokenSize(scope, keyName))
+    {
+        LogError("SASToken_SignInto destination is too small (%lu bytes, %lu needed).", (unsigned long)destinationSize, (unsigned long)SASToken_GetMaxTokenSize(scope, keyName));
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t scopeLength = strlen(scope);
+        unsigned char digest[SHA256HashSize];
+        SHA256Context context;
+        char* expiryText;
+        char* expiryEnd;
+        char* current;
+
+        /* the expiry is formatted straight into its place in the token and hashed from there */
+        current = write_text(destination, SAS_TOKEN_PREFIX, sizeof(SAS_TOKEN_PREFIX) - 1);
+        current = write_text(current, scope, scopeLength);
+        current = write_text(current, SAS_TOKEN_SIGNATURE, sizeof(SAS_TOKEN_SIGNATURE) - 1);
+        expiryText = current + SAS_SIGNATURE_MAX_LENGTH + (sizeof(SAS_TOKEN_EXPIRY) - 1);
+        expiryEnd = write_decimal(expiryText, expiry);
+
+        /*Codes_SRS_SASTOKEN_99_014: [ SASToken_SignInto shall compute the HMAC-SHA256 of scope, "\n" and the decimal expiry, starting from copies of the signer's SHA-256 contexts. ]*/
+        context = signer->innerContext;
+        if ((SHA256Input(&context, (const uint8_t*)scope, (unsigned int)scopeLength) != shaSuccess) ||
+            (SHA256Input(&context, (const uint8_t*)"\n", 1) != shaSuccess) ||
+            (SHA256Input(&context, (const uint8_t*)expiryText, (unsigned int)(expiryEnd - expiryText)) != shaSuccess) ||
+            (SHA256Result(&context, digest) != shaSuccess) ||
+            (compute_outer_hash(signer, &context, digest) != 0))
+        {
+            /*Codes_SRS_SASTOKEN_99_016: [ If computing the HMAC fails, SASToken_SignInto shall fail and return a non-zero value. ]*/
+            LogError("Unable to compute the SAS signature.");
+            destination[0] = '\0';
+            result = __FAILURE__;
+        }
+        else
+        {
+            /*Codes_SRS_SASTOKEN_99_015: [ SASToken_SignInto shall write "SharedAccessSignature sr=", scope, "&sig=", the base64 and url encoded signature, "&se=", the decimal expiry and, if keyName is not NULL, "&skn=" and keyName, followed by a '\0', and return 0. ]*/
+            size_t expiryLength = (size_t)(expiryEnd - expiryText);
+            current = write_signature(current, digest);
+            current = write_text(current, SAS_TOKEN_EXPIRY, sizeof(SAS_TOKEN_EXPIRY) - 1);
+            (void)memmove(current, expiryText, expiryLength);
+            current += expiryLength;
+            if (keyName != NULL)
+            {
+                current = write_text(current, SAS_TOKEN_KEY_NAME, sizeof(SAS_TOKEN_KEY_NAME) - 1);
+                current = write_text(current, keyName, strlen(keyName));
+            }
+            *current = '\0';
+            result = 0;
+        }
+
+        (void)memset(&context, 0, sizeof(context));
+        (void)memset(digest, 0, sizeof(digest));
+    }
+
+    return result;
+}
@@ -43,6 +43,7 @@
 
 #include "azure_c_shared_utility/sha.h"
 #include "azure_c_shared_utility/sha-private.h"
+#include <string.h>
 
 /*
 *  Define the SHA1 circular left shift macro
@@ -59,6 +60,28 @@
         (((context)->Length_Low += (length)) < addTemp) && \
         (++(context)->Length_High == 0) ? 1 : 0)
 
+/*
+* add "length" bytes to the length, flagging messages of 2^64 bits or more
+*/
+static int SHA1AddByteLength(SHA1Context *context, unsigned int length)
+{
+    uint32_t low_bits = (uint32_t)length << 3;
+    uint32_t high_bits = (uint32_t)(length >> 29);
+
+    context->Length_Low += low_bits;
+    if (context->Length_Low < low_bits)
+        high_bits++;
+
+    if (high_bits != 0) {
+        uint32_t previous_high = context->Length_High;
+        context->Length_High += high_bits;
+        if (context->Length_High < previous_high)
+            context->Corrupted = shaInputTooLong;
+    }
+
+    return context->Corrupted;
+}
+
 /* Local Function Prototypes */
 static void SHA1Finalize(SHA1Context *context, uint8_t Pad_Byte);
 static void SHA1PadMessage(SHA1Context *, uint8_t Pad_Byte);
@@ -125,7 +148,7 @@ int SHA1Reset(SHA1Context *context)
 int SHA1Input(SHA1Context *context,
     const uint8_t *message_array, unsigned length)
 {
-    uint32_t addTemp;
+    unsigned int block_bytes;
     if (!length)
         return shaSuccess;
 
@@ -140,15 +163,36 @@ int SHA1Input(SHA1Context *context,
     if (context->Corrupted)
         return context->Corrupted;
 
-    while (length-- && !context->Corrupted) {
-        context->Message_Block[context->Message_Block_Index++] =
-            (*message_array & 0xFF);
+    if (SHA1AddByteLength(context, length) != 0)
+        return context->Corrupted;
 
-        if (!SHA1AddLength(context, 8) &&
-            (context->Message_Block_Index == SHA1_Message_Block_Size))
+    /*
+    * Top up a partially filled block first, then hand every whole
+    * block straight from message_array to the compression function
+    * and keep only the tail in Message_Block.
+    */
+    if (context->Message_Block_Index > 0) {
+        unsigned int space = SHA1_Message_Block_Size - context->Message_Block_Index;
+        unsigned int count = (length < space) ? length : space;
+        (void)memcpy(&context->Message_Block[context->Message_Block_Index], message_array, count);
+        context->Message_Block_Index += (int_least16_t)count;
+        message_array += count;
+        length -= count;
+
+        if (context->Message_Block_Index == SHA1_Message_Block_Size)
             SHA1ProcessMessageBlock(context);
+    }
 
-        message_array++;
+    block_bytes = length - (length % SHA1_Message_Block_Size);
+    if (block_bytes > 0) {
+        SHA1ProcessBlocks(context->Intermediate_Hash, message_array, block_bytes / SHA1_Message_Block_Size);
+        message_array += block_bytes;
+        length -= block_bytes;
+    }
+
+    if (length > 0) {
+        (void)memcpy(context->Message_Block, message_array, length);
+        context->Message_Block_Index = (int_least16_t)length;
     }
 
     return shaSuccess;
@@ -356,85 +400,97 @@ static void SHA1PadMessage(SHA1Context *context, uint8_t Pad_Byte)
 *
 * Returns:
 *   Nothing.
+*/
+static void SHA1ProcessMessageBlock(SHA1Context *context)
+{
+    SHA1ProcessBlocks(context->Intermediate_Hash, context->Message_Block, 1);
+    context->Message_Block_Index = 0;
+}
+
+/*
+* The message schedule is kept in a 16 word circular buffer.
+* W[t & 15] holds W[t - 16] until it is replaced by W[t].
+*/
+#define SHA1_W(t)                                               \
+    (((t) < 16) ? W[(t)] :                                      \
+    (W[(t) & 15] = SHA1_ROTL(1, W[((t) + 13) & 15] ^            \
+        W[((t) + 8) & 15] ^ W[((t) + 2) & 15] ^ W[(t) & 15])))
+
+/*
+* One round; instead of shifting the five working variables the
+* callers rotate the names, so the new A lands in the old E.
+*/
+#define SHA1_ROUND(a, b, c, d, e, f, k, t)                      \
+    e += SHA1_ROTL(5, a) + f(b, c, d) + (k) + SHA1_W(t);        \
+    b = SHA1_ROTL(30, b)
+
+#define SHA1_ROUNDS5(t, f, k)                                   \
+    SHA1_ROUND(A, B, C, D, E, f, k, (t));                       \
+    SHA1_ROUND(E, A, B, C, D, f, k, (t) + 1);                   \
+    SHA1_ROUND(D, E, A, B, C, f, k, (t) + 2);                   \
+    SHA1_ROUND(C, D, E, A, B, f, k, (t) + 3);                   \
+    SHA1_ROUND(B, C, D, E, A, f, k, (t) + 4)
+
+/*
+* SHA1ProcessBlocksPortable
+*
+* Description:
+*   Processes block_count consecutive 512 bit blocks into
+*   Intermediate_Hash. This is the C implementation used when no
+*   accelerated backend is available (see sha_backend.c).
 *
 * Comments:
 *   Many of the variable names in this code, especially the
 *   single character names, were used because those were the
 *   names used in the publication.
 */
-static void SHA1ProcessMessageBlock(SHA1Context *context)
+void SHA1ProcessBlocksPortable(uint32_t Intermediate_Hash[], const uint8_t *blocks, size_t block_count)
 {
     /* Constants defined in FIPS-180-2, section 4.2.1 */
-    const uint32_t K[4] = {
-        0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6
-    };
-    int        t;               /* Loop counter */
-    uint32_t   temp;            /* Temporary word value */
-    uint32_t   W[80];           /* Word sequence */
+    static const uint32_t K0 = 0x5A827999;
+    static const uint32_t K1 = 0x6ED9EBA1;
+    static const uint32_t K2 = 0x8F1BBCDC;
+    static const uint32_t K3 = 0xCA62C1D6;
+    uint32_t   W[16];           /* Message schedule */
     uint32_t   A, B, C, D, E;   /* Word buffers */
-
-    /*
-    * Initialize the first 16 words in the array W
-    */
-    for (t = 0; t < 16; t++) {
-        W[t] = ((uint32_t)context->Message_Block[t * 4]) << 24;
-        W[t] |= ((uint32_t)context->Message_Block[t * 4 + 1]) << 16;
-        W[t] |= ((uint32_t)context->Message_Block[t * 4 + 2]) << 8;
-        W[t] |= ((uint32_t)context->Message_Block[t * 4 + 3]);
-    }
-
-    for (t = 16; t < 80; t++)
-        W[t] = SHA1_ROTL(1, W[t - 3] ^ W[t - 8] ^ W[t - 14] ^ W[t - 16]);
-
-    A = context->Intermediate_Hash[0];
-    B = context->Intermediate_Hash[1];
-    C = context->Intermediate_Hash[2];
-    D = context->Intermediate_Hash[3];
-    E = context->Intermediate_Hash[4];
-
-    for (t = 0; t < 20; t++) {
-        temp = SHA1_ROTL(5, A) + SHA_Ch(B, C, D) + E + W[t] + K[0];
-        E = D;
-        D = C;
-        C = SHA1_ROTL(30, B);
-        B = A;
-        A = temp;
-    }
-
-    for (t = 20; t < 40; t++) {
-        temp = SHA1_ROTL(5, A) + SHA_Parity(B, C, D) + E + W[t] + K[1];
-        E = D;
-        D = C;
-        C = SHA1_ROTL(30, B);
-        B = A;
-        A = temp;
-    }
-
-    for (t = 40; t < 60; t++) {
-        temp = SHA1_ROTL(5, A) + SHA_Maj(B, C, D) + E + W[t] + K[2];
-        E = D;
-        D = C;
-        C = SHA1_ROTL(30, B);
-        B = A;
-        A = temp;
-    }
-
-    for (t = 60; t < 80; t++) {
-        temp = SHA1_ROTL(5, A) + SHA_Parity(B, C, D) + E + W[t] + K[3];
-        E = D;
-        D = C;
-        C = SHA1_ROTL(30, B);
-        B = A;
-        A = temp;
+    int        t;
+
+    while (block_count-- > 0) {
+        for (t = 0; t < 16; t++)
+            W[t] = SHA_LOAD_BE32(&blocks[t * 4]);
+
+        A = Intermediate_Hash[0];
+        B = Intermediate_Hash[1];
+        C = Intermediate_Hash[2];
+        D = Intermediate_Hash[3];
+        E = Intermediate_Hash[4];
+
+        SHA1_ROUNDS5(0, SHA_Ch, K0);
+        SHA1_ROUNDS5(5, SHA_Ch, K0);
+        SHA1_ROUNDS5(10, SHA_Ch, K0);
+        SHA1_ROUNDS5(15, SHA_Ch, K0);
+
+        SHA1_ROUNDS5(20, SHA_Parity, K1);
+        SHA1_ROUNDS5(25, SHA_Parity, K1);
+        SHA1_ROUNDS5(30, SHA_Parity, K1);
+        SHA1_ROUNDS5(35, SHA_Parity, K1);
+
+        SHA1_ROUNDS5(40, SHA_Maj, K2);
+        SHA1_ROUNDS5(45, SHA_Maj, K2);
+        SHA1_ROUNDS5(50, SHA_Maj, K2);
+        SHA1_ROUNDS5(55, SHA_Maj, K2);
+
+        SHA1_ROUNDS5(60, SHA_Parity, K3);
+        SHA1_ROUNDS5(65, SHA_Parity, K3);
+        SHA1_ROUNDS5(70, SHA_Parity, K3);
+        SHA1_ROUNDS5(75, SHA_Parity, K3);
+
+        Intermediate_Hash[0] += A;
+        Intermediate_Hash[1] += B;
+        Intermediate_Hash[2] += C;
+        Intermediate_Hash[3] += D;
+        Intermediate_Hash[4] += E;
+
+        blocks += SHA1_Message_Block_Size;
     }
-
-    context->Intermediate_Hash[0] += A;
-    context->Intermediate_Hash[1] += B;
-    context->Intermediate_Hash[2] += C;
-
-    context->Intermediate_Hash[3] += D;
-    context->Intermediate_Hash[4] += E;
-
-    context->Message_Block_Index = 0;
 }
-
@@ -44,6 +44,8 @@
 
 #include "azure_c_shared_utility/sha.h"
 #include "azure_c_shared_utility/sha-private.h"
+#include <string.h>
+
 /* Define the SHA shift, rotate left and rotate right macro */
 #define SHA256_SHR(bits,word)      ((word) >> (bits))
 #define SHA256_ROTL(bits,word)                         \
@@ -69,6 +71,28 @@
     (((context)->Length_Low += (length)) < addTemp) &&     \
     (++(context)->Length_High == 0) ? 1 : 0)
 
+/*
+* add "length" bytes to the length, flagging messages of 2^64 bits or more
+*/
+static int SHA224_256AddByteLength(SHA256Context *context, unsigned int length)
+{
+    uint32_t low_bits = (uint32_t)length << 3;
+    uint32_t high_bits = (uint32_t)(length >> 29);
+
+    context->Length_Low += low_bits;
+    if (context->Length_Low < low_bits)
+        high_bits++;
+
+    if (high_bits != 0) {
+        uint32_t previous_high = context->Length_High;
+        context->Length_High += high_bits;
+        if (context->Length_High < previous_high)
+            context->Corrupted = shaInputTooLong;
+    }
+
+    return context->Corrupted;
+}
+
 /* Local Function Prototypes */
 static void SHA224_256Finalize(SHA256Context *context,
     uint8_t Pad_Byte);
@@ -226,7 +250,7 @@ int SHA256Reset(SHA256Context *context)
 int SHA256Input(SHA256Context *context, const uint8_t *message_array,
     unsigned int length)
 {
-    uint32_t addTemp;
+    unsigned int block_bytes;
     if (!length)
         return shaSuccess;
 
@@ -241,19 +265,39 @@ int SHA256Input(SHA256Context *context, const uint8_t *message_array,
     if (context->Corrupted)
         return context->Corrupted;
 
-    while (length-- && !context->Corrupted) {
-        context->Message_Block[context->Message_Block_Index++] =
-            (*message_array & 0xFF);
+    if (SHA224_256AddByteLength(context, length) != 0)
+        return context->Corrupted;
 
-        if (!SHA224_256AddLength(context, 8) &&
-            (context->Message_Block_Index == SHA256_Message_Block_Size))
+    /*
+    * Top up a partially filled block first, then hand every whole
+    * block straight from message_array to the compression function
+    * and keep only the tail in Message_Block.
+    */
+    if (context->Message_Block_Index > 0) {
+        unsigned int space = SHA256_Message_Block_Size - context->Message_Block_Index;
+        unsigned int count = (length < space) ? length : space;
+        (void)memcpy(&context->Message_Block[context->Message_Block_Index], message_array, count);
+        context->Message_Block_Index += (int_least16_t)count;
+        message_array += count;
+        length -= count;
+
+        if (context->Message_Block_Index == SHA256_Message_Block_Size)
             SHA224_256ProcessMessageBlock(context);
+    }
 
-        message_array++;
+    block_bytes = length - (length % SHA256_Message_Block_Size);
+    if (block_bytes > 0) {
+        SHA256ProcessBlocks(context->Intermediate_Hash, message_array, block_bytes / SHA256_Message_Block_Size);
+        message_array += block_bytes;
+        length -= block_bytes;
     }
 
-    return shaSuccess;
+    if (length > 0) {
+        (void)memcpy(context->Message_Block, message_array, length);
+        context->Message_Block_Index = (int_least16_t)length;
+    }
 
+    return shaSuccess;
 }
 
 /*
@@ -441,80 +485,118 @@ static void SHA224_256PadMessage(SHA256Context *context,
 *
 * Returns:
 *   Nothing.
+*/
+static void SHA224_256ProcessMessageBlock(SHA256Context *context)
+{
+    SHA256ProcessBlocks(context->Intermediate_Hash, context->Message_Block, 1);
+    context->Message_Block_Index = 0;
+}
+
+/* Constants defined in FIPS-180-2, section 4.2.2 */
+static const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
+    0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+    0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
+    0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
+    0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+    0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
+    0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+    0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
+    0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/*
+* The message schedule is kept in a 16 word circular buffer.
+* W[j] holds W[t + j - 16] until it is replaced by W[t + j].
+*/
+#define SHA256_W_LOAD(j)    W[(j)]
+#define SHA256_W_EXPAND(j)                                      \
+    (W[(j)] += SHA256_sigma1(W[((j) + 14) & 15]) +              \
+        W[((j) + 9) & 15] + SHA256_sigma0(W[((j) + 1) & 15]))
+
+/*
+* One round; instead of shifting the eight working variables the
+* callers rotate the names, so the new A lands in the old H.
+*/
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, j, w)              \
+    h += SHA256_SIGMA1(e) + SHA_Ch(e, f, g) + SHA256_K[t + (j)] + w(j); \
+    d += h;                                                     \
+    h += SHA256_SIGMA0(a) + SHA_Maj(a, b, c)
+
+#define SHA256_ROUNDS16(w)                                      \
+    SHA256_ROUND(A, B, C, D, E, F, G, H, 0, w);                 \
+    SHA256_ROUND(H, A, B, C, D, E, F, G, 1, w);                 \
+    SHA256_ROUND(G, H, A, B, C, D, E, F, 2, w);                 \
+    SHA256_ROUND(F, G, H, A, B, C, D, E, 3, w);                 \
+    SHA256_ROUND(E, F, G, H, A, B, C, D, 4, w);                 \
+    SHA256_ROUND(D, E, F, G, H, A, B, C, 5, w);                 \
+    SHA256_ROUND(C, D, E, F, G, H, A, B, 6, w);                 \
+    SHA256_ROUND(B, C, D, E, F, G, H, A, 7, w);                 \
+    SHA256_ROUND(A, B, C, D, E, F, G, H, 8, w);                 \
+    SHA256_ROUND(H, A, B, C, D, E, F, G, 9, w);                 \
+    SHA256_ROUND(G, H, A, B, C, D, E, F, 10, w);                \
+    SHA256_ROUND(F, G, H, A, B, C, D, E, 11, w);                \
+    SHA256_ROUND(E, F, G, H, A, B, C, D, 12, w);                \
+    SHA256_ROUND(D, E, F, G, H, A, B, C, 13, w);                \
+    SHA256_ROUND(C, D, E, F, G, H, A, B, 14, w);                \
+    SHA256_ROUND(B, C, D, E, F, G, H, A, 15, w)
+
+/*
+* SHA256ProcessBlocksPortable
+*
+* Description:
+*   Processes block_count consecutive 512 bit blocks into
+*   Intermediate_Hash. This is the C implementation used when no
+*   accelerated backend is available (see sha_backend.c).
+*   The first 16 rounds are unrolled on the loaded words; the other
+*   48 run as three unrolled passes of 16 rounds, which keeps the
+*   code small enough for microcontroller flash.
 *
 * Comments:
 *   Many of the variable names in this code, especially the
 *   single character names, were used because those were the
 *   names used in the publication.
 */
-static void SHA224_256ProcessMessageBlock(SHA256Context *context)
+void SHA256ProcessBlocksPortable(uint32_t Intermediate_Hash[], const uint8_t *blocks, size_t block_count)
 {
-    /* Constants defined in FIPS-180-2, section 4.2.2 */
-    static const uint32_t K[64] = {
-        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b,
-        0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
-        0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7,
-        0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-        0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152,
-        0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-        0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
-        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819,
-        0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
-        0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f,
-        0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
-    };
-    int        t, t4;                   /* Loop counter */
-    uint32_t   temp1, temp2;            /* Temporary word value */
-    uint32_t   W[64];                   /* Word sequence */
+    uint32_t   W[16];                   /* Message schedule */
     uint32_t   A, B, C, D, E, F, G, H;  /* Word buffers */
-
-    /*
-    * Initialize the first 16 words in the array W
-    */
-    for (t = t4 = 0; t < 16; t++, t4 += 4)
-        W[t] = (((uint32_t)context->Message_Block[t4]) << 24) |
-        (((uint32_t)context->Message_Block[t4 + 1]) << 16) |
-        (((uint32_t)context->Message_Block[t4 + 2]) << 8) |
-        (((uint32_t)context->Message_Block[t4 + 3]));
-
-    for (t = 16; t < 64; t++)
-        W[t] = SHA256_sigma1(W[t - 2]) + W[t - 7] +
-        SHA256_sigma0(W[t - 15]) + W[t - 16];
-
-    A = context->Intermediate_Hash[0];
-    B = context->Intermediate_Hash[1];
-    C = context->Intermediate_Hash[2];
-    D = context->Intermediate_Hash[3];
-    E = context->Intermediate_Hash[4];
-    F = context->Intermediate_Hash[5];
-    G = context->Intermediate_Hash[6];
-    H = context->Intermediate_Hash[7];
-
-    for (t = 0; t < 64; t++) {
-        temp1 = H + SHA256_SIGMA1(E) + SHA_Ch(E, F, G) + K[t] + W[t];
-        temp2 = SHA256_SIGMA0(A) + SHA_Maj(A, B, C);
-        H = G;
-        G = F;
-        F = E;
-        E = D + temp1;
-        D = C;
-        C = B;
-        B = A;
-        A = temp1 + temp2;
+    int        t;
+
+    while (block_count-- > 0) {
+        for (t = 0; t < 16; t++)
+            W[t] = SHA_LOAD_BE32(&blocks[t * 4]);
+
+        A = Intermediate_Hash[0];
+        B = Intermediate_Hash[1];
+        C = Intermediate_Hash[2];
+        D = Intermediate_Hash[3];
+        E = Intermediate_Hash[4];
+        F = Intermediate_Hash[5];
+        G = Intermediate_Hash[6];
+        H = Intermediate_Hash[7];
+
+        t = 0;
+        SHA256_ROUNDS16(SHA256_W_LOAD);
+        for (t = 16; t < 64; t += 16) {
+            SHA256_ROUNDS16(SHA256_W_EXPAND);
+        }
+
+        Intermediate_Hash[0] += A;
+        Intermediate_Hash[1] += B;
+        Intermediate_Hash[2] += C;
+        Intermediate_Hash[3] += D;
+        Intermediate_Hash[4] += E;
+        Intermediate_Hash[5] += F;
+        Intermediate_Hash[6] += G;
+        Intermediate_Hash[7] += H;
+
+        blocks += SHA256_Message_Block_Size;
     }
-
-    context->Intermediate_Hash[0] += A;
-    context->Intermediate_Hash[1] += B;
-    context->Intermediate_Hash[2] += C;
-    context->Intermediate_Hash[3] += D;
-    context->Intermediate_Hash[4] += E;
-    context->Intermediate_Hash[5] += F;
-    context->Intermediate_Hash[6] += G;
-    context->Intermediate_Hash[7] += H;
-
-    context->Message_Block_Index = 0;
 }
 
 /*
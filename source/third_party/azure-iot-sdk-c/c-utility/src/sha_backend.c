@@ -0,0 +1,390 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*
+* Selection of the SHA-1 and SHA-224/256 block compression backend.
+*
+* The portable C code lives in sha1.c and sha224.c. This file adds
+* the x86 SHA extensions (SHA-NI) and the ARMv8 cryptography
+* extensions when the compiler can build them, picks one at first
+* use, and lets platforms install their own (e.g. a hardware hash
+* engine) through SHA_SetBackend.
+*
+* Define NO_SHA_ACCELERATION to build the portable code only.
+*/
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include "azure_c_shared_utility/sha.h"
+#include "azure_c_shared_utility/sha-private.h"
+
+#if !defined(NO_SHA_ACCELERATION) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SHA_BACKEND_X86_SHANI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if !defined(NO_SHA_ACCELERATION) && (defined(__ARM_FEATURE_CRYPTO) || (defined(__ARM_FEATURE_SHA2) && defined(__ARM_FEATURE_SHA1)))
+#define SHA_BACKEND_ARMV8
+#include <arm_neon.h>
+#if defined(__linux__) && defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+static const SHA_BACKEND portable_backend = {
+    "portable",
+    SHA1ProcessBlocksPortable,
+    SHA256ProcessBlocksPortable
+};
+
+#ifdef SHA_BACKEND_X86_SHANI
+
+#define SHANI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+
+/*
+* One group of four SHA-1 rounds. E[] alternates between the E value
+* feeding this group and the saved A of the previous one; MSG[] is the
+* circular message schedule, four words per register.
+*/
+#define SHANI_SHA1_GROUP(g, f)                                              \
+    if ((g) == 0)                                                           \
+        E[0] = _mm_add_epi32(E[0], MSG[0]);                                 \
+    else                                                                    \
+        E[(g) & 1] = _mm_sha1nexte_epu32(E[(g) & 1], MSG[(g) & 3]);         \
+    E[((g) + 1) & 1] = ABCD;                                                \
+    if (((g) >= 3) && ((g) <= 18))                                          \
+        MSG[((g) + 1) & 3] = _mm_sha1msg2_epu32(MSG[((g) + 1) & 3], MSG[(g) & 3]); \
+    ABCD = _mm_sha1rnds4_epu32(ABCD, E[(g) & 1], f);                        \
+    if (((g) >= 1) && ((g) <= 16))                                          \
+        MSG[((g) + 3) & 3] = _mm_sha1msg1_epu32(MSG[((g) + 3) & 3], MSG[(g) & 3]); \
+    if (((g) >= 2) && ((g) <= 17))                                          \
+        MSG[((g) + 2) & 3] = _mm_xor_si128(MSG[((g) + 2) & 3], MSG[(g) & 3])
+
+SHANI_TARGET
+static void SHA1ProcessBlocksShaNi(uint32_t *Intermediate_Hash, const uint8_t *blocks, size_t block_count)
+{
+    const __m128i MASK = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+    __m128i ABCD, ABCD_SAVE, E0_SAVE;
+    __m128i E[2];
+    __m128i MSG[4];
+    int i;
+
+    ABCD = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)Intermediate_Hash), 0x1B);
+    E[0] = _mm_set_epi32((int)Intermediate_Hash[4], 0, 0, 0);
+    E[1] = _mm_setzero_si128();
+
+    while (block_count-- > 0) {
+        ABCD_SAVE = ABCD;
+        E0_SAVE = E[0];
+
+        for (i = 0; i < 4; i++)
+            MSG[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(blocks + 16 * i)), MASK);
+
+        SHANI_SHA1_GROUP(0, 0);
+        SHANI_SHA1_GROUP(1, 0);
+        SHANI_SHA1_GROUP(2, 0);
+        SHANI_SHA1_GROUP(3, 0);
+        SHANI_SHA1_GROUP(4, 0);
+        SHANI_SHA1_GROUP(5, 1);
+        SHANI_SHA1_GROUP(6, 1);
+        SHANI_SHA1_GROUP(7, 1);
+        SHANI_SHA1_GROUP(8, 1);
+        SHANI_SHA1_GROUP(9, 1);
+        SHANI_SHA1_GROUP(10, 2);
+        SHANI_SHA1_GROUP(11, 2);
+        SHANI_SHA1_GROUP(12, 2);
+        SHANI_SHA1_GROUP(13, 2);
+        SHANI_SHA1_GROUP(14, 2);
+        SHANI_SHA1_GROUP(15, 3);
+        SHANI_SHA1_GROUP(16, 3);
+        SHANI_SHA1_GROUP(17, 3);
+        SHANI_SHA1_GROUP(18, 3);
+        SHANI_SHA1_GROUP(19, 3);
+
+        E[0] = _mm_sha1nexte_epu32(E[0], E0_SAVE);
+        ABCD = _mm_add_epi32(ABCD, ABCD_SAVE);
+
+        blocks += SHA1_Message_Block_Size;
+    }
+
+    _mm_storeu_si128((__m128i *)Intermediate_Hash, _mm_shuffle_epi32(ABCD, 0x1B));
+    Intermediate_Hash[4] = (uint32_t)_mm_extract_epi32(E[0], 3);
+}
+
+SHANI_TARGET
+static void SHA256ProcessBlocksShaNi(uint32_t *Intermediate_Hash, const uint8_t *blocks, size_t block_count)
+{
+    static const uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+    const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i STATE0, STATE1, TMP, WK, ABEF_SAVE, CDGH_SAVE;
+    __m128i MSG[4];
+    int i;
+
+    /* the SHA-NI instructions want the state as ABEF and CDGH */
+    TMP = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&Intermediate_Hash[0]), 0xB1);
+    STATE1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&Intermediate_Hash[4]), 0x1B);
+    STATE0 = _mm_alignr_epi8(TMP, STATE1, 8);
+    STATE1 = _mm_blend_epi16(STATE1, TMP, 0xF0);
+
+    while (block_count-- > 0) {
+        ABEF_SAVE = STATE0;
+        CDGH_SAVE = STATE1;
+
+        for (i = 0; i < 4; i++)
+            MSG[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(blocks + 16 * i)), MASK);
+
+        /* 16 groups of four rounds; MSG[] is the circular message schedule */
+        for (i = 0; i < 16; i++) {
+            WK = _mm_add_epi32(MSG[i & 3], _mm_loadu_si128((const __m128i *)&K[4 * i]));
+            STATE1 = _mm_sha256rnds2_epu32(STATE1, STATE0, WK);
+            if ((i >= 3) && (i <= 14)) {
+                TMP = _mm_alignr_epi8(MSG[i & 3], MSG[(i + 3) & 3], 4);
+                MSG[(i + 1) & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(MSG[(i + 1) & 3], TMP), MSG[i & 3]);
+            }
+            STATE0 = _mm_sha256rnds2_epu32(STATE0, STATE1, _mm_shuffle_epi32(WK, 0x0E));
+            if ((i >= 1) && (i <= 12))
+                MSG[(i + 3) & 3] = _mm_sha256msg1_epu32(MSG[(i + 3) & 3], MSG[i & 3]);
+        }
+
+        STATE0 = _mm_add_epi32(STATE0, ABEF_SAVE);
+        STATE1 = _mm_add_epi32(STATE1, CDGH_SAVE);
+
+        blocks += SHA256_Message_Block_Size;
+    }
+
+    TMP = _mm_shuffle_epi32(STATE0, 0x1B);
+    STATE1 = _mm_shuffle_epi32(STATE1, 0xB1);
+    _mm_storeu_si128((__m128i *)&Intermediate_Hash[0], _mm_blend_epi16(TMP, STATE1, 0xF0));
+    _mm_storeu_si128((__m128i *)&Intermediate_Hash[4], _mm_alignr_epi8(STATE1, TMP, 8));
+}
+
+static const SHA_BACKEND x86_shani_backend = {
+    "x86-sha",
+    SHA1ProcessBlocksShaNi,
+    SHA256ProcessBlocksShaNi
+};
+
+static int x86_has_sha_extensions(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    int result = 0;
+
+    if ((__get_cpuid(1, &eax, &ebx, &ecx, &edx) != 0) &&
+        ((ecx & bit_SSSE3) != 0) &&
+        ((ecx & bit_SSE4_1) != 0) &&
+        (__get_cpuid_max(0, NULL) >= 7)) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        result = ((ebx & (1u << 29)) != 0);
+    }
+
+    return result;
+}
+
+#endif /* SHA_BACKEND_X86_SHANI */
+
+#ifdef SHA_BACKEND_ARMV8
+
+static uint32x4_t armv8_load_block_words(const uint8_t *bytes)
+{
+    return vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(bytes)));
+}
+
+static void SHA1ProcessBlocksArmV8(uint32_t *Intermediate_Hash, const uint8_t *blocks, size_t block_count)
+{
+    uint32x4_t K[4];
+    uint32x4_t ABCD, ABCD_SAVE, WK;
+    uint32x4_t MSG[4];
+    uint32_t E0, E1, E0_SAVE;
+    int g;
+
+    K[0] = vdupq_n_u32(0x5A827999);
+    K[1] = vdupq_n_u32(0x6ED9EBA1);
+    K[2] = vdupq_n_u32(0x8F1BBCDC);
+    K[3] = vdupq_n_u32(0xCA62C1D6);
+
+    ABCD = vld1q_u32(Intermediate_Hash);
+    E0 = Intermediate_Hash[4];
+
+    while (block_count-- > 0) {
+        ABCD_SAVE = ABCD;
+        E0_SAVE = E0;
+
+        for (g = 0; g < 4; g++)
+            MSG[g] = armv8_load_block_words(blocks + 16 * g);
+
+        /* 20 groups of four rounds; MSG[] is the circular message schedule */
+        for (g = 0; g < 20; g++) {
+            WK = vaddq_u32(MSG[g & 3], K[g / 5]);
+            E1 = vsha1h_u32(vgetq_lane_u32(ABCD, 0));
+            if (g < 5)
+                ABCD = vsha1cq_u32(ABCD, E0, WK);
+            else if ((g < 10) || (g >= 15))
+                ABCD = vsha1pq_u32(ABCD, E0, WK);
+            else
+                ABCD = vsha1mq_u32(ABCD, E0, WK);
+            E0 = E1;
+            if (g < 16)
+                MSG[g & 3] = vsha1su1q_u32(vsha1su0q_u32(MSG[g & 3], MSG[(g + 1) & 3], MSG[(g + 2) & 3]), MSG[(g + 3) & 3]);
+        }
+
+        E0 += E0_SAVE;
+        ABCD = vaddq_u32(ABCD_SAVE, ABCD);
+
+        blocks += SHA1_Message_Block_Size;
+    }
+
+    vst1q_u32(Intermediate_Hash, ABCD);
+    Intermediate_Hash[4] = E0;
+}
+
+static void SHA256ProcessBlocksArmV8(uint32_t *Intermediate_Hash, const uint8_t *blocks, size_t block_count)
+{
+    static const uint32_t K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+    uint32x4_t STATE0, STATE1, ABCD_SAVE, EFGH_SAVE, TMP, WK;
+    uint32x4_t MSG[4];
+    int i;
+
+    STATE0 = vld1q_u32(&Intermediate_Hash[0]);
+    STATE1 = vld1q_u32(&Intermediate_Hash[4]);
+
+    while (block_count-- > 0) {
+        ABCD_SAVE = STATE0;
+        EFGH_SAVE = STATE1;
+
+        for (i = 0; i < 4; i++)
+            MSG[i] = armv8_load_block_words(blocks + 16 * i);
+
+        /* 16 groups of four rounds; MSG[] is the circular message schedule */
+        for (i = 0; i < 16; i++) {
+            WK = vaddq_u32(MSG[i & 3], vld1q_u32(&K[4 * i]));
+            TMP = STATE0;
+            STATE0 = vsha256hq_u32(STATE0, STATE1, WK);
+            STATE1 = vsha256h2q_u32(STATE1, TMP, WK);
+            if (i < 12)
+                MSG[i & 3] = vsha256su1q_u32(vsha256su0q_u32(MSG[i & 3], MSG[(i + 1) & 3]), MSG[(i + 2) & 3], MSG[(i + 3) & 3]);
+        }
+
+        STATE0 = vaddq_u32(STATE0, ABCD_SAVE);
+        STATE1 = vaddq_u32(STATE1, EFGH_SAVE);
+
+        blocks += SHA256_Message_Block_Size;
+    }
+
+    vst1q_u32(&Intermediate_Hash[0], STATE0);
+    vst1q_u32(&Intermediate_Hash[4], STATE1);
+}
+
+static const SHA_BACKEND armv8_backend = {
+    "armv8-crypto",
+    SHA1ProcessBlocksArmV8,
+    SHA256ProcessBlocksArmV8
+};
+
+static int armv8_has_sha_extensions(void)
+{
+#if defined(__linux__) && defined(__aarch64__)
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    return ((hwcap & HWCAP_SHA1) != 0) && ((hwcap & HWCAP_SHA2) != 0);
+#else
+    /* the compiler was told the target has the extensions */
+    return 1;
+#endif
+}
+
+#endif /* SHA_BACKEND_ARMV8 */
+
+/*
+* The active backend. It is chosen on first use; selecting twice is
+* harmless, so no lock is needed. SHA_SetBackend is meant to be called
+* during platform initialization, before any hashing starts.
+*/
+static const SHA_BACKEND *active_backend = NULL;
+
+static const SHA_BACKEND *select_backend(void)
+{
+    const SHA_BACKEND *result = &portable_backend;
+
+#ifdef SHA_BACKEND_X86_SHANI
+    if (x86_has_sha_extensions())
+        result = &x86_shani_backend;
+#endif
+
+#ifdef SHA_BACKEND_ARMV8
+    if (armv8_has_sha_extensions())
+        result = &armv8_backend;
+#endif
+
+    return result;
+}
+
+/*
+* SHA_GetBackend
+*
+* Description:
+*   Returns the backend used for SHA-1 and SHA-224/256 blocks,
+*   selecting the default one if none was chosen yet.
+*/
+const SHA_BACKEND *SHA_GetBackend(void)
+{
+    if (active_backend == NULL)
+        active_backend = select_backend();
+
+    return active_backend;
+}
+
+/*
+* SHA_SetBackend
+*
+* Description:
+*   Installs backend for all later SHA-1 and SHA-224/256 block
+*   processing. NULL restores the automatic selection.
+*
+* Returns:
+*   sha Error Code.
+*/
+int SHA_SetBackend(const SHA_BACKEND *backend)
+{
+    active_backend = (backend == NULL) ? select_backend() : backend;
+    return shaSuccess;
+}
+
+void SHA1ProcessBlocks(uint32_t Intermediate_Hash[], const uint8_t *blocks, size_t block_count)
+{
+    const SHA_BACKEND *backend = SHA_GetBackend();
+
+    if (backend->sha1_process_blocks != NULL)
+        backend->sha1_process_blocks(Intermediate_Hash, blocks, block_count);
+    else
+        SHA1ProcessBlocksPortable(Intermediate_Hash, blocks, block_count);
+}
+
+void SHA256ProcessBlocks(uint32_t Intermediate_Hash[], const uint8_t *blocks, size_t block_count)
+{
+    const SHA_BACKEND *backend = SHA_GetBackend();
+
+    if (backend->sha256_process_blocks != NULL)
+        backend->sha256_process_blocks(Intermediate_Hash, blocks, block_count);
+    else
+        SHA256ProcessBlocksPortable(Intermediate_Hash, blocks, block_count);
+}
@@ -75,6 +75,9 @@ typedef struct TLS_IO_INSTANCE_TAG
     TLSIO_VERSION tls_version;
     TLS_CERTIFICATE_VALIDATION_CALLBACK tls_validation_callback;
     void* tls_validation_callback_data;
+    bool session_resumption;
+    SSL_SESSION* session;
+    bool close_notify_in_flight;
 } TLS_IO_INSTANCE;
 
 struct CRYPTO_dynlock_value
@@ -85,6 +88,25 @@ struct CRYPTO_dynlock_value
 #define OPTION_UNDERLYING_IO_OPTIONS        "underlying_io_options"
 #define SSL_DO_HANDSHAKE_SUCCESS 1
 
+static SSL_SESSION* add_session_reference(SSL_SESSION* session)
+{
+#if (OPENSSL_VERSION_NUMBER < 0x10100000L)
+    (void)CRYPTO_add(&session->references, 1, CRYPTO_LOCK_SSL_SESSION);
+#else
+    (void)SSL_SESSION_up_ref(session);
+#endif
+    return session;
+}
+
+static void set_session(TLS_IO_INSTANCE* tls_io_instance, SSL_SESSION* session)
+{
+    if (tls_io_instance->session != NULL)
+    {
+        SSL_SESSION_free(tls_io_instance->session);
+    }
+    tls_io_instance->session = session;
+}
+
 
 /*this function will clone an option given by name and value*/
 static void* tlsio_openssl_CloneOption(const char* name, const void* value)
@@ -212,6 +234,26 @@ static void* tlsio_openssl_CloneOption(const char* name, const void* value)
         {
             result = (void*)value;
         }
+        else if (strcmp(name, OPTION_TLS_SESSION_RESUMPTION) == 0)
+        {
+            bool* value_clone;
+
+            if ((value_clone = (bool*)malloc(sizeof(bool))) == NULL)
+            {
+                LogError("Failed clonning tls_session_resumption option");
+            }
+            else
+            {
+                *value_clone = *(const bool*)value;
+            }
+
+            result = value_clone;
+        }
+        else if (strcmp(name, OPTION_TLS_SESSION) == 0)
+        {
+            /*sessions are reference counted, the clone is one more reference to the same session*/
+            result = add_session_reference((SSL_SESSION*)value);
+        }
         else
         {
             LogError("not handled option : %s", name);
@@ -239,11 +281,16 @@ static void tlsio_openssl_DestroyOption(const char* name, const void* value)
             (strcmp(name, SU_OPTION_X509_PRIVATE_KEY) == 0) ||
             (strcmp(name, OPTION_X509_ECC_CERT) == 0) ||
             (strcmp(name, OPTION_X509_ECC_KEY) == 0) ||
-            (strcmp(name, OPTION_TLS_VERSION) == 0)
+            (strcmp(name, OPTION_TLS_VERSION) == 0) ||
+            (strcmp(name, OPTION_TLS_SESSION_RESUMPTION) == 0)
             )
         {
             free((void*)value);
         }
+        else if (strcmp(name, OPTION_TLS_SESSION) == 0)
+        {
+            SSL_SESSION_free((SSL_SESSION*)value);
+        }
         else if (
             (strcmp(name, "tls_validation_callback") == 0) ||
             (strcmp(name, "tls_validation_callback_data") == 0)
@@ -337,6 +384,24 @@ static OPTIONHANDLER_HANDLE tlsio_openssl_retrieveoptions(CONCRETE_IO_HANDLE han
                 OptionHandler_Destroy(result);
                 result = NULL;
             }
+            else if (
+                (!tls_io_instance->session_resumption) &&
+                (OptionHandler_AddOption(result, OPTION_TLS_SESSION_RESUMPTION, &tls_io_instance->session_resumption) != OPTIONHANDLER_OK)
+                )
+            {
+                LogError("unable to save tls_session_resumption option");
+                OptionHandler_Destroy(result);
+                result = NULL;
+            }
+            else if (
+                (tls_io_instance->session != NULL) &&
+                (OptionHandler_AddOption(result, OPTION_TLS_SESSION, tls_io_instance->session) != OPTIONHANDLER_OK)
+                )
+            {
+                LogError("unable to save tls_session option");
+                OptionHandler_Destroy(result);
+                result = NULL;
+            }
             else if (tls_io_instance->tls_version != 0)
             {
                 if (OptionHandler_AddOption(result, OPTION_TLS_VERSION, &tls_io_instance->tls_version) != OPTIONHANDLER_OK)
@@ -689,6 +754,10 @@ static void close_openssl_instance(TLS_IO_INSTANCE* tls_io_instance)
 {
     if (tls_io_instance->ssl != NULL)
     {
+        // OpenSSL drops the session of a connection freed without SSL_SENT_SHUTDOWN from the cache, which marks it
+        // not resumable. The session is still kept for the next connection, so a destroy or a forced close that
+        // did not send the close_notify counts as a quiet shutdown.
+        SSL_set_shutdown(tls_io_instance->ssl, SSL_SENT_SHUTDOWN);
         SSL_free(tls_io_instance->ssl);
         tls_io_instance->ssl = NULL;
     }
@@ -731,6 +800,31 @@ static void on_underlying_io_close_complete(void* context)
     close_openssl_instance(tls_io_instance);
 }
 
+static void close_underlying_io(TLS_IO_INSTANCE* tls_io_instance)
+{
+    // xio_close is guaranteed to succeed from the open state, and the callback completes the 
+    // transition into TLSIO_STATE_NOT_OPEN
+    if (xio_close(tls_io_instance->underlying_io, on_underlying_io_close_complete, tls_io_instance) != 0)
+    {
+        close_openssl_instance(tls_io_instance);
+        tls_io_instance->tlsio_state = TLSIO_STATE_NOT_OPEN;
+    }
+}
+
+static void on_close_notify_send_complete(void* context, IO_SEND_RESULT send_result)
+{
+    TLS_IO_INSTANCE* tls_io_instance = (TLS_IO_INSTANCE*)context;
+
+    // whatever became of the close_notify, the underlying io can only be closed once it left the send queue,
+    // closing it earlier would cancel the close_notify and leave the session not resumable
+    (void)send_result;
+    if (tls_io_instance->close_notify_in_flight)
+    {
+        tls_io_instance->close_notify_in_flight = false;
+        close_underlying_io(tls_io_instance);
+    }
+}
+
 static void on_underlying_io_open_complete(void* context, IO_OPEN_RESULT open_result)
 {
     TLS_IO_INSTANCE* tls_io_instance = (TLS_IO_INSTANCE*)context;
@@ -922,6 +1016,16 @@ static int add_certificate_to_store(TLS_IO_INSTANCE* tls_io_instance, const char
     return result;
 }
 
+/*OpenSSL calls this once the server issued a session, after the handshake for TLS 1.2 and from a session ticket for TLS 1.3*/
+static int on_new_session(SSL* ssl, SSL_SESSION* session)
+{
+    TLS_IO_INSTANCE* tls_io_instance = (TLS_IO_INSTANCE*)SSL_get_app_data(ssl);
+
+    /*returning 1 keeps the reference OpenSSL handed over*/
+    set_session(tls_io_instance, session);
+    return 1;
+}
+
 static int create_openssl_instance(TLS_IO_INSTANCE* tlsInstance)
 {
     int result;
@@ -1043,6 +1147,22 @@ static int create_openssl_instance(TLS_IO_INSTANCE* tlsInstance)
                     {
                         SSL_set_bio(tlsInstance->ssl, tlsInstance->in_bio, tlsInstance->out_bio);
                         SSL_set_connect_state(tlsInstance->ssl);
+
+                        if (tlsInstance->session_resumption)
+                        {
+                            /*the session is kept on the tlsio, so it survives the context and travels with the options*/
+                            SSL_set_app_data(tlsInstance->ssl, tlsInstance);
+                            (void)SSL_CTX_set_session_cache_mode(tlsInstance->ssl_context, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+                            SSL_CTX_sess_set_new_cb(tlsInstance->ssl_context, on_new_session);
+
+                            if ((tlsInstance->session != NULL) &&
+                                (SSL_set_session(tlsInstance->ssl, tlsInstance->session) != 1))
+                            {
+                                /*not fatal, the handshake is simply a full one*/
+                                log_ERR_get_error("Failed offering the previous TLS session.");
+                                set_session(tlsInstance, NULL);
+                            }
+                        }
                         result = 0;
                     }
                 }
@@ -1159,6 +1279,9 @@ CONCRETE_IO_HANDLE tlsio_openssl_create(void* io_create_parameters)
                 result->x509privatekey = NULL;
                 result->x509_ecc_cert = NULL;
                 result->x509_ecc_aliaskey = NULL;
+                result->session_resumption = true;
+                result->session = NULL;
+                result->close_notify_in_flight = false;
 
                 result->tls_version = VERSION_1_0;
 
@@ -1199,6 +1322,9 @@ void tlsio_openssl_destroy(CONCRETE_IO_HANDLE tls_io)
         free((void*)tls_io_instance->x509_ecc_cert);
         free((void*)tls_io_instance->x509_ecc_aliaskey);
         close_openssl_instance(tls_io_instance);
+        set_session(tls_io_instance, NULL);
+        // destroying the underlying io cancels a close_notify still queued, do not close from that callback
+        tls_io_instance->close_notify_in_flight = false;
         if (tls_io_instance->underlying_io != NULL)
         {
             xio_destroy(tls_io_instance->underlying_io);
@@ -1300,17 +1426,28 @@ int tlsio_openssl_close(CONCRETE_IO_HANDLE tls_io, ON_IO_CLOSE_COMPLETE on_io_cl
             tls_io_instance->tlsio_state = TLSIO_STATE_CLOSING;
             tls_io_instance->on_io_close_complete = on_io_close_complete;
             tls_io_instance->on_io_close_complete_context = callback_context;
-            // xio_close is guaranteed to succeed from the open state, and the callback completes the 
-            // transition into TLSIO_STATE_NOT_OPEN
-            if (xio_close(tls_io_instance->underlying_io, on_underlying_io_close_complete, tls_io_instance) != 0)
+            // OpenSSL marks the session of a connection freed without a close_notify as not resumable.
+            // The underlying io may queue the close_notify, so it is closed once the close_notify was sent.
+            (void)SSL_shutdown(tls_io_instance->ssl);
+            if (BIO_ctrl_pending(tls_io_instance->out_bio) == 0)
             {
-                close_openssl_instance(tls_io_instance);
-                tls_io_instance->tlsio_state = TLSIO_STATE_NOT_OPEN;
+                close_underlying_io(tls_io_instance);
+            }
+            else
+            {
+                tls_io_instance->close_notify_in_flight = true;
+                if ((write_outgoing_bytes(tls_io_instance, on_close_notify_send_complete, tls_io_instance) != 0) &&
+                    (tls_io_instance->close_notify_in_flight))
+                {
+                    tls_io_instance->close_notify_in_flight = false;
+                    close_underlying_io(tls_io_instance);
+                }
             }
         }
         else
         {
-            // Just force the shutdown
+            // Just force the shutdown, this also drops a close_notify still waiting to be sent
+            tls_io_instance->close_notify_in_flight = false;
             /* Codes_SRS_TLSIO_30_056: [ On success the adapter shall enter TLSIO_STATE_EX_CLOSING. ]*/
             /* Codes_SRS_TLSIO_30_051: [ On success, if the underlying TLS does not support asynchronous closing or if the adapter is not in TLSIO_STATE_EXT_OPEN, then the adapter shall enter TLSIO_STATE_EXT_CLOSED immediately after entering TLSIO_STATE_EXT_CLOSING. ]*/
             // Current implementations of xio_close will fail if not in the open state, but we don't care
@@ -1421,6 +1558,8 @@ void tlsio_openssl_dowork(CONCRETE_IO_HANDLE tls_io)
                 // 
                 // Set the state to TLSIO_STATE_ERROR so close won't gripe about the state
                 tls_io_instance->tlsio_state = TLSIO_STATE_ERROR;
+                /*do not offer a session to a server that just refused this connection*/
+                set_session(tls_io_instance, NULL);
                 tlsio_openssl_close(tls_io_instance, NULL, NULL);
                 indicate_open_complete(tls_io_instance, IO_OPEN_ERROR);
             }
@@ -1623,6 +1762,41 @@ int tlsio_openssl_setoption(CONCRETE_IO_HANDLE tls_io, const char* optionName, c
                 result = 0;
             }
         }
+        else if (strcmp(OPTION_TLS_SESSION_RESUMPTION, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("NULL tls_session_resumption value");
+                result = __FAILURE__;
+            }
+            else
+            {
+                tls_io_instance->session_resumption = *(const bool*)value;
+                if (!tls_io_instance->session_resumption)
+                {
+                    set_session(tls_io_instance, NULL);
+                }
+                result = 0;
+            }
+        }
+        else if (strcmp(OPTION_TLS_SESSION, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("NULL tls_session value");
+                result = __FAILURE__;
+            }
+            else if (tls_io_instance->ssl != NULL)
+            {
+                LogError("Unable to set the tls session after the tls connection is established");
+                result = __FAILURE__;
+            }
+            else
+            {
+                set_session(tls_io_instance, add_session_reference((SSL_SESSION*)value));
+                result = 0;
+            }
+        }
         else if (strcmp(optionName, OPTION_UNDERLYING_IO_OPTIONS) == 0)
         {
             if (OptionHandler_FeedOptions((OPTIONHANDLER_HANDLE)value, (void*)tls_io_instance->underlying_io) != OPTIONHANDLER_OK)
@@ -49,6 +49,8 @@ typedef struct TLS_IO_INSTANCE_TAG
     char* certificate;
     char* x509certificate;
     char* x509privatekey;
+    bool session_resumption;
+    WOLFSSL_SESSION* session;
 } TLS_IO_INSTANCE;
 
 /*this function will clone an option given by name and value*/
@@ -98,6 +100,26 @@ static void* tlsio_wolfssl_CloneOption(const char* name, const void* value)
                 /*return as is*/
             }
         }
+        else if (strcmp(name, OPTION_TLS_SESSION_RESUMPTION) == 0)
+        {
+            bool* value_clone;
+
+            if ((value_clone = (bool*)malloc(sizeof(bool))) == NULL)
+            {
+                LogError("unable to clone tls_session_resumption value");
+            }
+            else
+            {
+                *value_clone = *(const bool*)value;
+            }
+
+            result = value_clone;
+        }
+        else if (strcmp(name, OPTION_TLS_SESSION) == 0)
+        {
+            /*the session lives in wolfSSL's client session cache, only the pointer is passed along*/
+            result = (void*)value;
+        }
         else
         {
             LogError("not handled option : %s", name);
@@ -119,10 +141,15 @@ static void tlsio_wolfssl_DestroyOption(const char* name, const void* value)
     {
         if ((strcmp(name, OPTION_TRUSTED_CERT) == 0) ||
             (strcmp(name, SU_OPTION_X509_CERT) == 0) ||
-            (strcmp(name, SU_OPTION_X509_PRIVATE_KEY) == 0))
+            (strcmp(name, SU_OPTION_X509_PRIVATE_KEY) == 0) ||
+            (strcmp(name, OPTION_TLS_SESSION_RESUMPTION) == 0))
         {
             free((void*)value);
         }
+        else if (strcmp(name, OPTION_TLS_SESSION) == 0)
+        {
+            /*owned by wolfSSL's session cache*/
+        }
         else
         {
             LogError("not handled option : %s", name);
@@ -177,6 +204,24 @@ static OPTIONHANDLER_HANDLE tlsio_wolfssl_retrieveoptions(CONCRETE_IO_HANDLE tls
                 OptionHandler_Destroy(result);
                 result = NULL;
             }
+            else if (
+                (!tls_io_instance->session_resumption) &&
+                (OptionHandler_AddOption(result, OPTION_TLS_SESSION_RESUMPTION, &tls_io_instance->session_resumption) != 0)
+                )
+            {
+                LogError("unable to save tls_session_resumption option");
+                OptionHandler_Destroy(result);
+                result = NULL;
+            }
+            else if (
+                (tls_io_instance->session != NULL) &&
+                (OptionHandler_AddOption(result, OPTION_TLS_SESSION, tls_io_instance->session) != 0)
+                )
+            {
+                LogError("unable to save tls_session option");
+                OptionHandler_Destroy(result);
+                result = NULL;
+            }
             else
             {
                 /*all is fine, all interesting options have been saved*/
@@ -431,6 +476,13 @@ static int on_handshake_done(WOLFSSL* ssl, void* context)
     }
     else
     {
+#ifndef NO_SESSION_CACHE
+        if (tls_io_instance->session_resumption)
+        {
+            /*remembered so the next open, or the next tlsio fed with our options, can resume it*/
+            tls_io_instance->session = wolfSSL_get_session(ssl);
+        }
+#endif
         tls_io_instance->tlsio_state = TLSIO_STATE_OPEN;
         indicate_open_complete(tls_io_instance, IO_OPEN_OK);
     }
@@ -544,6 +596,16 @@ static int prepare_wolfssl_open(TLS_IO_INSTANCE* tls_io_instance)
     }
     else
     {
+#ifndef NO_SESSION_CACHE
+        if ((tls_io_instance->session_resumption) &&
+            (tls_io_instance->session != NULL) &&
+            (wolfSSL_set_session(tls_io_instance->ssl, tls_io_instance->session) != SSL_SUCCESS))
+        {
+            /*not fatal, the handshake is simply a full one*/
+            LogInfo("Unable to offer the previous TLS session");
+            tls_io_instance->session = NULL;
+        }
+#endif
         result = 0;
     }
     return result;
@@ -583,6 +645,7 @@ CONCRETE_IO_HANDLE tlsio_wolfssl_create(void* io_create_parameters)
         {
             (void)memset(result, 0, sizeof(TLS_IO_INSTANCE));
             result->tlsio_state = TLSIO_STATE_NOT_OPEN;
+            result->session_resumption = true;
 
             result->ssl_context = wolfSSL_CTX_new(wolfTLSv1_2_client_method());
             if (result->ssl_context == NULL)
@@ -890,6 +953,36 @@ int tlsio_wolfssl_setoption(CONCRETE_IO_HANDLE tls_io, const char* optionName, c
         {
             result = process_option(&tls_io_instance->x509privatekey, optionName, value);
         }
+        else if (strcmp(OPTION_TLS_SESSION_RESUMPTION, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("NULL tls_session_resumption value");
+                result = __FAILURE__;
+            }
+            else
+            {
+                tls_io_instance->session_resumption = *(const bool*)value;
+                if (!tls_io_instance->session_resumption)
+                {
+                    tls_io_instance->session = NULL;
+                }
+                result = 0;
+            }
+        }
+        else if (strcmp(OPTION_TLS_SESSION, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("NULL tls_session value");
+                result = __FAILURE__;
+            }
+            else
+            {
+                tls_io_instance->session = (WOLFSSL_SESSION*)value;
+                result = 0;
+            }
+        }
         else
         {
             if (tls_io_instance->socket_io == NULL)
@@ -9,89 +9,114 @@
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/strings.h"
 
-#define NIBBLE_STR(c) (char)(c < 10 ? c + '0' : c - 10 + 'a')
-#define IS_PRINTABLE(c) (                           \
-    (c == 0) ||                                     \
-    (c == '!') ||                                   \
-    (c == '(') || (c == ')') || (c == '*') ||       \
-    (c == '-') || (c == '.') ||                     \
-    ((c >= '0') && (c <= '9')) ||                   \
-    ((c >= 'A') && (c <= 'Z')) ||                   \
-    (c == '_') ||                                   \
-    ((c >= 'a') && (c <= 'z'))                      \
-)
-
-static size_t URL_PrintableChar(unsigned char charVal, char* buffer)
-{
-    size_t size;
-    if (IS_PRINTABLE(charVal))
-    {
-        buffer[0] = (char)charVal;
-        size = 1;
-    }
-    else
-    {
-        char bigNibbleStr;
-        char littleNibbleStr;
-        unsigned char bigNibbleVal = charVal >> 4;
-        unsigned char littleNibbleVal = charVal & 0x0F;
+/*encodings up to this size are built on the stack by URL_EncodeConcat*/
+#define URL_ENCODE_STACK_BUFFER_SIZE 128
 
-        if (bigNibbleVal >= 0x0C)
-        {
-            bigNibbleVal -= 0x04;
-        }
+/*length of the encoding of every byte value: 1 for the characters passed as they are, 3 for %xx and 6 for %c2%xx or %c3%xx*/
+static const unsigned char urlEncodedLengthTable[256] =
+{
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, /* 0x00 */
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, /* 0x10 */
+    3, 1, 3, 3, 3, 3, 3, 3, 1, 1, 1, 3, 3, 1, 1, 3, /* 0x20 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3, 3, /* 0x30 */
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* 0x40 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 1, /* 0x50 */
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, /* 0x60 */
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 3, 3, 3, 3, 3, /* 0x70 */
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, /* 0x80 */
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, /* 0x90 */
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, /* 0xA0 */
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, /* 0xB0 */
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, /* 0xC0 */
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, /* 0xD0 */
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, /* 0xE0 */
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6  /* 0xF0 */
+};
 
-        bigNibbleStr = NIBBLE_STR(bigNibbleVal);
-        littleNibbleStr = NIBBLE_STR(littleNibbleVal);
+static const char urlNibbleTable[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
 
-        buffer[0] = '%';
+static size_t URL_EncodedLengthOf(const unsigned char* text, size_t textLength)
+{
+    size_t result = 0;
+    size_t i;
+    for (i = 0; i < textLength; i++)
+    {
+        result += urlEncodedLengthTable[text[i]];
+    }
+    return result;
+}
 
-        if (charVal < 0x80)
-        {
-            buffer[1] = bigNibbleStr;
-            buffer[2] = littleNibbleStr;
-            size = 3;
-        }
-        else
+/*writes the encoding of textLength bytes to destination, which has room for it; returns the count of characters written*/
+static size_t URL_EncodeBytes(const unsigned char* text, size_t textLength, char* destination)
+{
+    char* current = destination;
+    size_t i;
+    for (i = 0; i < textLength; i++)
+    {
+        unsigned char charVal = text[i];
+        switch (urlEncodedLengthTable[charVal])
         {
-            buffer[1] = 'c';
-            buffer[3] = '%';
-            buffer[4] = bigNibbleStr;
-            buffer[5] = littleNibbleStr;
-            if (charVal < 0xC0)
-            {
-                buffer[2] = '2';
-            }
-            else
-            {
-                buffer[2] = '3';
-            }
-            size = 6;
+        case 1:
+            *current++ = (char)charVal;
+            break;
+        case 3:
+            current[0] = '%';
+            current[1] = urlNibbleTable[charVal >> 4];
+            current[2] = urlNibbleTable[charVal & 0x0F];
+            current += 3;
+            break;
+        default:
+            /*bytes above 0x7F are taken as Latin-1 and written as their 2 byte UTF-8 sequence*/
+            current[0] = '%';
+            current[1] = 'c';
+            current[2] = (charVal < 0xC0) ? '2' : '3';
+            current[3] = '%';
+            current[4] = urlNibbleTable[(charVal >> 4) - ((charVal < 0xC0) ? 0 : 4)];
+            current[5] = urlNibbleTable[charVal & 0x0F];
+            current += 6;
+            break;
         }
     }
-
-    return size;
+    return (size_t)(current - destination);
 }
 
-static size_t URL_PrintableCharSize(unsigned char charVal)
+static STRING_HANDLE URL_EncodeToNewString(const char* text)
 {
-    size_t size;
-    if (IS_PRINTABLE(charVal))
+    STRING_HANDLE result;
+    size_t textLength = strlen(text);
+    size_t encodedLength = URL_EncodedLengthOf((const unsigned char*)text, textLength);
+
+    if (encodedLength == textLength)
     {
-        size = 1;
+        /*Codes_SRS_URL_ENCODE_99_005: [ If no character of the text needs escaping the text is copied as it is, without being encoded. ]*/
+        result = STRING_construct(text);
+        if (result == NULL)
+        {
+            LogError("URL_Encode:: MALLOC failure on encode.");
+        }
     }
     else
     {
-        if (charVal < 0x80)
+        char* encodedURL;
+        if ((encodedURL = (char*)malloc(encodedLength + 1)) == NULL)
         {
-            size = 3;
+            /*Codes_SRS_URL_ENCODE_06_002: [If an error occurs during the encoding of input then URL_Encode will return NULL.]*/
+            result = NULL;
+            LogError("URL_Encode:: MALLOC failure on encode.");
         }
         else
         {
-            size = 6;
+            encodedURL[URL_EncodeBytes((const unsigned char*)text, textLength, encodedURL)] = '\0';
+
+            result = STRING_new_with_memory(encodedURL);
+            if (result == NULL)
+            {
+                LogError("URL_Encode:: MALLOC failure on encode.");
+                free(encodedURL);
+            }
         }
     }
-    return size;
+    return result;
 }
 
 STRING_HANDLE URL_EncodeString(const char* textEncode)
@@ -103,16 +128,7 @@ STRING_HANDLE URL_EncodeString(const char* textEncode)
     }
     else
     {
-        STRING_HANDLE tempString = STRING_construct(textEncode);
-        if (tempString == NULL)
-        {
-            result = NULL;
-        }
-        else
-        {
-            result = URL_Encode(tempString);
-            STRING_delete(tempString);
-        }
+        result = URL_EncodeToNewString(textEncode);
     }
     return result;
 }
@@ -128,39 +144,129 @@ STRING_HANDLE URL_Encode(STRING_HANDLE input)
     }
     else
     {
-        size_t lengthOfResult = 0;
-        char* encodedURL;
-        const char* currentInput;
-        unsigned char currentUnsignedChar;
-        currentInput = STRING_c_str(input);
         /*Codes_SRS_URL_ENCODE_06_003: [If input is a zero length string then URL_Encode will return a zero length string.]*/
-        do
+        result = URL_EncodeToNewString(STRING_c_str(input));
+    }
+    return result;
+}
+
+size_t URL_EncodedLength(const char* text, size_t textLength)
+{
+    size_t result;
+    if (text == NULL)
+    {
+        /*Codes_SRS_URL_ENCODE_99_001: [ If text is NULL then URL_EncodedLength shall return 0. ]*/
+        result = 0;
+    }
+    else
+    {
+        /*Codes_SRS_URL_ENCODE_99_002: [ URL_EncodedLength shall return the count of characters the encoding of the first textLength characters of text takes, not counting a terminating '\0'. ]*/
+        result = URL_EncodedLengthOf((const unsigned char*)text, textLength);
+    }
+    return result;
+}
+
+int URL_EncodeInto(const char* text, size_t textLength, char* destination, size_t destinationSize, size_t* encodedLength)
+{
+    int result;
+    if ((text == NULL) || (destination == NULL))
+    {
+        /*Codes_SRS_URL_ENCODE_99_003: [ If text or destination is NULL then URL_EncodeInto shall fail and return a non-zero value. ]*/
+        LogError("URL_EncodeInto:: invalid argument text=%p, destination=%p", text, destination);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t length = URL_EncodedLengthOf((const unsigned char*)text, textLength);
+        if (length >= destinationSize)
         {
-            currentUnsignedChar = (unsigned char)(*currentInput++);
-            lengthOfResult += URL_PrintableCharSize(currentUnsignedChar);
-        } while (currentUnsignedChar != 0);
-        if ((encodedURL = (char*)malloc(lengthOfResult)) == NULL)
+            /*Codes_SRS_URL_ENCODE_99_004: [ If destinationSize is smaller than the encoded length plus one then URL_EncodeInto shall fail and return a non-zero value without writing to destination. ]*/
+            LogError("URL_EncodeInto:: destination too small, %lu bytes needed", (unsigned long)(length + 1));
+            result = __FAILURE__;
+        }
+        else
         {
-            /*Codes_SRS_URL_ENCODE_06_002: [If an error occurs during the encoding of input then URL_Encode will return NULL.]*/
-            result = NULL;
-            LogError("URL_Encode:: MALLOC failure on encode.");
+            /*Codes_SRS_URL_ENCODE_99_005: [ If no character of the text needs escaping the text is copied as it is, without being encoded. ]*/
+            if (length == textLength)
+            {
+                (void)memcpy(destination, text, textLength);
+            }
+            else
+            {
+                (void)URL_EncodeBytes((const unsigned char*)text, textLength, destination);
+            }
+
+            /*Codes_SRS_URL_ENCODE_99_006: [ On success URL_EncodeInto shall write the encoding of the first textLength characters of text followed by '\0' to destination, store the encoded length in encodedLength when it is not NULL and return 0. ]*/
+            destination[length] = '\0';
+            if (encodedLength != NULL)
+            {
+                *encodedLength = length;
+            }
+            result = 0;
+        }
+    }
+    return result;
+}
+
+int URL_EncodeConcat(STRING_HANDLE destination, const char* text)
+{
+    int result;
+    if ((destination == NULL) || (text == NULL))
+    {
+        /*Codes_SRS_URL_ENCODE_99_007: [ If destination or text is NULL then URL_EncodeConcat shall fail and return a non-zero value. ]*/
+        LogError("URL_EncodeConcat:: invalid argument destination=%p, text=%p", destination, text);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t textLength = strlen(text);
+        size_t encodedLength = URL_EncodedLengthOf((const unsigned char*)text, textLength);
+
+        if (encodedLength == textLength)
+        {
+            /*Codes_SRS_URL_ENCODE_99_005: [ If no character of the text needs escaping the text is copied as it is, without being encoded. ]*/
+            /*Codes_SRS_URL_ENCODE_99_008: [ URL_EncodeConcat shall append the encoding of text to destination and return 0. ]*/
+            result = STRING_concat(destination, text);
         }
         else
         {
-            size_t currentEncodePosition = 0;
-            currentInput = STRING_c_str(input);
-            do
+            char stackBuffer[URL_ENCODE_STACK_BUFFER_SIZE];
+            char* encodedText;
+
+            if (encodedLength < sizeof(stackBuffer))
+            {
+                encodedText = stackBuffer;
+            }
+            else
             {
-                currentUnsignedChar = (unsigned char)(*currentInput++);
-                currentEncodePosition += URL_PrintableChar(currentUnsignedChar, &encodedURL[currentEncodePosition]);
-            } while (currentUnsignedChar != 0);
+                encodedText = (char*)malloc(encodedLength + 1);
+            }
 
-            result = STRING_new_with_memory(encodedURL);
-            if (result == NULL)
+            if (encodedText == NULL)
             {
-                LogError("URL_Encode:: MALLOC failure on encode.");
-                free(encodedURL);
+                /*Codes_SRS_URL_ENCODE_99_009: [ If any error occurs URL_EncodeConcat shall fail and return a non-zero value, leaving destination as it was. ]*/
+                LogError("URL_EncodeConcat:: MALLOC failure on encode.");
+                result = __FAILURE__;
             }
+            else
+            {
+                encodedText[URL_EncodeBytes((const unsigned char*)text, textLength, encodedText)] = '\0';
+
+                /*Codes_SRS_URL_ENCODE_99_008: [ URL_EncodeConcat shall append the encoding of text to destination and return 0. ]*/
+                result = STRING_concat(destination, encodedText);
+
+                if (encodedText != stackBuffer)
+                {
+                    free(encodedText);
+                }
+            }
+        }
+
+        if (result != 0)
+        {
+            /*Codes_SRS_URL_ENCODE_99_009: [ If any error occurs URL_EncodeConcat shall fail and return a non-zero value, leaving destination as it was. ]*/
+            LogError("URL_EncodeConcat:: failed appending the encoded text");
+            result = __FAILURE__;
         }
     }
     return result;
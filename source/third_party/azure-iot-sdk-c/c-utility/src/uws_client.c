@@ -24,6 +24,13 @@
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/optionhandler.h"
 
+#ifndef UWS_CLIENT_RECEIVE_BUFFER_SIZE
+#define UWS_CLIENT_RECEIVE_BUFFER_SIZE 4096
+#endif
+
+/* masked control frames carry at most 125 payload bytes, so they are encoded on the stack */
+#define UWS_CLIENT_MAX_CONTROL_FRAME_SIZE (2 + 4 + 125)
+
 static const char* UWS_CLIENT_OPTIONS = "uWSClientOptions";
 
 /* Requirements not needed as they are optional:
@@ -96,7 +103,9 @@ typedef struct UWS_CLIENT_INSTANCE_TAG
     ON_WS_CLOSE_COMPLETE on_ws_close_complete;
     void* on_ws_close_complete_context;
     unsigned char* received_bytes;
+    size_t received_bytes_offset;
     size_t received_bytes_count;
+    size_t received_bytes_capacity;
     UWS_FRAME_DECODER_STATE frame_decoder_state;
 } UWS_CLIENT_INSTANCE;
 
@@ -266,7 +275,9 @@ UWS_CLIENT_HANDLE uws_client_create(const char* hostname, unsigned int port, con
                                 result->on_ws_close_complete = NULL;
                                 result->on_ws_close_complete_context = NULL;
                                 result->received_bytes = NULL;
+                                result->received_bytes_offset = 0;
                                 result->received_bytes_count = 0;
+                                result->received_bytes_capacity = 0;
 
                                 result->protocol_count = protocol_count;
 
@@ -440,7 +451,9 @@ UWS_CLIENT_HANDLE uws_client_create_with_io(const IO_INTERFACE_DESCRIPTION* io_i
                                 result->on_ws_close_complete = NULL;
                                 result->on_ws_close_complete_context = NULL;
                                 result->received_bytes = NULL;
+                                result->received_bytes_offset = 0;
                                 result->received_bytes_count = 0;
+                                result->received_bytes_capacity = 0;
 
                                 result->protocol_count = protocol_count;
 
@@ -603,39 +616,31 @@ static void unchecked_on_send_complete(void* context, IO_SEND_RESULT send_result
 
 static int send_close_frame(UWS_CLIENT_INSTANCE* uws_client, unsigned int close_error_code)
 {
-    unsigned char* close_frame;
+    unsigned char close_frame[UWS_CLIENT_MAX_CONTROL_FRAME_SIZE];
     unsigned char close_frame_payload[2];
     size_t close_frame_length;
     int result;
-    BUFFER_HANDLE close_frame_buffer;
 
     close_frame_payload[0] = (unsigned char)(close_error_code >> 8);
     close_frame_payload[1] = (unsigned char)(close_error_code & 0xFF);
 
+    /* Codes_SRS_UWS_CLIENT_99_006: [ Control frames shall be encoded into a buffer on the stack by calling `uws_frame_encoder_encode_into`. ]*/
     /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-    close_frame_buffer = uws_frame_encoder_encode(WS_CLOSE_FRAME, close_frame_payload, sizeof(close_frame_payload), true, true, 0);
-    if (close_frame_buffer == NULL)
+    close_frame_length = uws_frame_encoder_get_encoded_size(sizeof(close_frame_payload), true);
+    if (uws_frame_encoder_encode_into(close_frame, sizeof(close_frame), WS_CLOSE_FRAME, close_frame_payload, sizeof(close_frame_payload), true, true, 0) != 0)
     {
         LogError("Encoding of CLOSE failed.");
         result = __FAILURE__;
     }
+    /* Codes_SRS_UWS_CLIENT_01_471: [ The callback `on_underlying_io_close_sent` shall be passed as argument to `xio_send`. ]*/
+    else if (xio_send(uws_client->underlying_io, close_frame, close_frame_length, unchecked_on_send_complete, NULL) != 0)
+    {
+        LogError("Sending CLOSE frame failed.");
+        result = __FAILURE__;
+    }
     else
     {
-        close_frame = BUFFER_u_char(close_frame_buffer);
-        close_frame_length = BUFFER_length(close_frame_buffer);
-
-        /* Codes_SRS_UWS_CLIENT_01_471: [ The callback `on_underlying_io_close_sent` shall be passed as argument to `xio_send`. ]*/
-        if (xio_send(uws_client->underlying_io, close_frame, close_frame_length, unchecked_on_send_complete, NULL) != 0)
-        {
-            LogError("Sending CLOSE frame failed.");
-            result = __FAILURE__;
-        }
-        else
-        {
-            result = 0;
-        }
-
-        BUFFER_delete(close_frame_buffer);
+        result = 0;
     }
 
     return result;
@@ -785,14 +790,81 @@ static void on_underlying_io_open_complete(void* context, IO_OPEN_RESULT open_re
     }
 }
 
-static void consume_received_bytes(UWS_CLIENT_INSTANCE* uws_client, size_t consumed_bytes)
+static int append_received_bytes(UWS_CLIENT_INSTANCE* uws_client, const unsigned char* buffer, size_t size)
 {
-    if (consumed_bytes < uws_client->received_bytes_count)
+    int result;
+
+    /* one extra byte is kept so the upgrade response can be zero terminated in place */
+    size_t needed_bytes = uws_client->received_bytes_count + size + 1;
+
+    if (uws_client->received_bytes_offset + needed_bytes > uws_client->received_bytes_capacity)
     {
-        (void)memmove(uws_client->received_bytes, uws_client->received_bytes + consumed_bytes, uws_client->received_bytes_count - consumed_bytes);
+        /* Codes_SRS_UWS_CLIENT_99_002: [ If the received bytes do not fit after the unconsumed bytes, the unconsumed bytes shall be moved to the start of the buffer. ]*/
+        if ((uws_client->received_bytes_offset > 0) &&
+            (uws_client->received_bytes_count > 0))
+        {
+            (void)memmove(uws_client->received_bytes, uws_client->received_bytes + uws_client->received_bytes_offset, uws_client->received_bytes_count);
+        }
+
+        uws_client->received_bytes_offset = 0;
     }
 
+    if (needed_bytes > uws_client->received_bytes_capacity)
+    {
+        /* Codes_SRS_UWS_CLIENT_99_003: [ If the buffer is still too small, it shall be grown to the larger of twice its capacity and the needed size, and to at least `UWS_CLIENT_RECEIVE_BUFFER_SIZE` bytes. ]*/
+        size_t new_capacity = uws_client->received_bytes_capacity * 2;
+        unsigned char* new_received_bytes;
+
+        if (new_capacity < needed_bytes)
+        {
+            new_capacity = needed_bytes;
+        }
+
+        if (new_capacity < UWS_CLIENT_RECEIVE_BUFFER_SIZE)
+        {
+            new_capacity = UWS_CLIENT_RECEIVE_BUFFER_SIZE;
+        }
+
+        new_received_bytes = (unsigned char*)realloc(uws_client->received_bytes, new_capacity);
+        if (new_received_bytes == NULL)
+        {
+            LogError("Cannot grow the receive buffer to %u bytes", (unsigned int)new_capacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            uws_client->received_bytes = new_received_bytes;
+            uws_client->received_bytes_capacity = new_capacity;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        /* Codes_SRS_UWS_CLIENT_99_001: [ Received bytes shall be copied after the unconsumed bytes in the receive buffer, without reallocating it while they fit. ]*/
+        (void)memcpy(uws_client->received_bytes + uws_client->received_bytes_offset + uws_client->received_bytes_count, buffer, size);
+        uws_client->received_bytes_count += size;
+    }
+
+    return result;
+}
+
+static void consume_received_bytes(UWS_CLIENT_INSTANCE* uws_client, size_t consumed_bytes)
+{
+    /* Codes_SRS_UWS_CLIENT_99_004: [ Consuming a decoded frame shall only advance the start of the unconsumed bytes, without moving any bytes. ]*/
     uws_client->received_bytes_count -= consumed_bytes;
+    if (uws_client->received_bytes_count == 0)
+    {
+        uws_client->received_bytes_offset = 0;
+    }
+    else
+    {
+        uws_client->received_bytes_offset += consumed_bytes;
+    }
 }
 
 static void on_underlying_io_close_complete(void* context)
@@ -975,8 +1047,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
             case UWS_STATE_WAITING_FOR_UPGRADE_RESPONSE:
             {
                 /* Codes_SRS_UWS_CLIENT_01_378: [ When `on_underlying_io_bytes_received` is called while the uws is OPENING, the received bytes shall be accumulated in order to attempt parsing the WebSocket Upgrade response. ]*/
-                unsigned char* new_received_bytes = (unsigned char*)realloc(uws_client->received_bytes, uws_client->received_bytes_count + size + 1);
-                if (new_received_bytes == NULL)
+                if (append_received_bytes(uws_client, buffer, size) != 0)
                 {
                     /* Codes_SRS_UWS_CLIENT_01_379: [ If allocating memory for accumulating the bytes fails, uws shall report that the open failed by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_NOT_ENOUGH_MEMORY`. ]*/
                     indicate_ws_open_complete_error_and_close(uws_client, WS_OPEN_ERROR_NOT_ENOUGH_MEMORY);
@@ -984,10 +1055,6 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                 }
                 else
                 {
-                    uws_client->received_bytes = new_received_bytes;
-                    (void)memcpy(uws_client->received_bytes + uws_client->received_bytes_count, buffer, size);
-                    uws_client->received_bytes_count += size;
-
                     decode_stream = 1;
                 }
 
@@ -998,8 +1065,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
             case UWS_STATE_CLOSING_WAITING_FOR_CLOSE:
             {
                 /* Codes_SRS_UWS_CLIENT_01_385: [ If the state of the uws instance is OPEN, the received bytes shall be used for decoding WebSocket frames. ]*/
-                unsigned char* new_received_bytes = (unsigned char*)realloc(uws_client->received_bytes, uws_client->received_bytes_count + size + 1);
-                if (new_received_bytes == NULL)
+                if (append_received_bytes(uws_client, buffer, size) != 0)
                 {
                     /* Codes_SRS_UWS_CLIENT_01_418: [ If allocating memory for the bytes accumulated for decoding WebSocket frames fails, an error shall be indicated by calling the `on_ws_error` callback with `WS_ERROR_NOT_ENOUGH_MEMORY`. ]*/
                     LogError("Cannot allocate memory for received data");
@@ -1009,10 +1075,6 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                 }
                 else
                 {
-                    uws_client->received_bytes = new_received_bytes;
-                    (void)memcpy(uws_client->received_bytes + uws_client->received_bytes_count, buffer, size);
-                    uws_client->received_bytes_count += size;
-                
                     decode_stream = 1;
                 }
 
@@ -1037,15 +1099,17 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
 
                 case UWS_STATE_WAITING_FOR_UPGRADE_RESPONSE:
                 {
+                    /* Codes_SRS_UWS_CLIENT_99_005: [ Frames and the upgrade response shall be decoded in place, starting at the first unconsumed byte of the receive buffer. ]*/
+                    unsigned char* received_bytes = uws_client->received_bytes + uws_client->received_bytes_offset;
                     const char* request_end_ptr;
 
                     /* Make sure it is zero terminated */
-                    uws_client->received_bytes[uws_client->received_bytes_count] = '\0';
+                    received_bytes[uws_client->received_bytes_count] = '\0';
 
                     /* Codes_SRS_UWS_CLIENT_01_380: [ If an WebSocket Upgrade request can be parsed from the accumulated bytes, the status shall be read from the WebSocket upgrade response. ]*/
                     /* Codes_SRS_UWS_CLIENT_01_381: [ If the status is 101, uws shall be considered OPEN and this shall be indicated by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `IO_OPEN_OK`. ]*/
                     if ((uws_client->received_bytes_count >= 4) &&
-                        ((request_end_ptr = strstr((const char*)uws_client->received_bytes, "\r\n\r\n")) != NULL))
+                        ((request_end_ptr = strstr((const char*)received_bytes, "\r\n\r\n")) != NULL))
                     {
                         int status_code;
 
@@ -1054,7 +1118,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
 
                         /* Codes_SRS_UWS_CLIENT_01_382: [ If a negative status is decoded from the WebSocket upgrade request, an error shall be indicated by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_BAD_RESPONSE_STATUS`. ]*/
                         /* Codes_SRS_UWS_CLIENT_01_478: [ A Status-Line with a 101 response code as per RFC 2616 [RFC2616]. ]*/
-                        if (ParseHttpResponse((const char*)uws_client->received_bytes, &status_code) != 0)
+                        if (ParseHttpResponse((const char*)received_bytes, &status_code) != 0)
                         {
                             /* Codes_SRS_UWS_CLIENT_01_383: [ If the WebSocket upgrade request cannot be decoded an error shall be indicated by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `WS_OPEN_ERROR_BAD_UPGRADE_RESPONSE`. ]*/
                             LogError("Cannot decode HTTP response");
@@ -1069,7 +1133,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                         else
                         {
                             /* Codes_SRS_UWS_CLIENT_01_384: [ Any extra bytes that are left unconsumed after decoding a succesfull WebSocket upgrade response shall be used for decoding WebSocket frames ]*/
-                            consume_received_bytes(uws_client, request_end_ptr - (char*)uws_client->received_bytes + 4);
+                            consume_received_bytes(uws_client, request_end_ptr - (char*)received_bytes + 4);
 
                             /* Codes_SRS_UWS_CLIENT_01_381: [ If the status is 101, uws shall be considered OPEN and this shall be indicated by calling the `on_ws_open_complete` callback passed to `uws_client_open_async` with `IO_OPEN_OK`. ]*/
                             uws_client->uws_state = UWS_STATE_OPEN;
@@ -1088,6 +1152,8 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                 case UWS_STATE_OPEN:
                 case UWS_STATE_CLOSING_WAITING_FOR_CLOSE:
                 {
+                    /* Codes_SRS_UWS_CLIENT_99_005: [ Frames and the upgrade response shall be decoded in place, starting at the first unconsumed byte of the receive buffer. ]*/
+                    unsigned char* received_bytes = uws_client->received_bytes + uws_client->received_bytes_offset;
                     size_t needed_bytes = 2;
                     size_t length;
 
@@ -1098,7 +1164,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                         unsigned char has_error = 0;
 
                         /* Codes_SRS_UWS_CLIENT_01_160: [ Defines whether the "Payload data" is masked. ]*/
-                        if ((uws_client->received_bytes[1] & 0x80) != 0)
+                        if ((received_bytes[1] & 0x80) != 0)
                         {
                             /* Codes_SRS_UWS_CLIENT_01_144: [ A client MUST close a connection if it detects a masked frame. ]*/
                             /* Codes_SRS_UWS_CLIENT_01_145: [ In this case, it MAY use the status code 1002 (protocol error) as defined in Section 7.4.1. (These rules might be relaxed in a future specification.) ]*/
@@ -1108,7 +1174,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
 
                         /* Codes_SRS_UWS_CLIENT_01_163: [ The length of the "Payload data", in bytes: ]*/
                         /* Codes_SRS_UWS_CLIENT_01_164: [ if 0-125, that is the payload length. ]*/
-                        length = uws_client->received_bytes[1];
+                        length = received_bytes[1];
 
                         if (length == 126)
                         {
@@ -1117,7 +1183,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                             if (uws_client->received_bytes_count >= needed_bytes)
                             {
                                 /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-                                length = ((size_t)(uws_client->received_bytes[2]) << 8) + (size_t)uws_client->received_bytes[3];
+                                length = ((size_t)(received_bytes[2]) << 8) + (size_t)received_bytes[3];
 
                                 if (length < 126)
                                 {
@@ -1140,7 +1206,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                             needed_bytes += 8;
                             if (uws_client->received_bytes_count >= needed_bytes)
                             {
-                                if ((uws_client->received_bytes[2] & 0x80) != 0)
+                                if ((received_bytes[2] & 0x80) != 0)
                                 {
                                     LogError("Bad frame: received a 64 bit length frame with the highest bit set");
 
@@ -1151,14 +1217,14 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 else
                                 {
                                     /* Codes_SRS_UWS_CLIENT_01_167: [ Multibyte length quantities are expressed in network byte order. ]*/
-                                    length = (size_t)(((uint64_t)(uws_client->received_bytes[2]) << 56) +
-                                        (((uint64_t)uws_client->received_bytes[3]) << 48) +
-                                        (((uint64_t)uws_client->received_bytes[4]) << 40) +
-                                        (((uint64_t)uws_client->received_bytes[5]) << 32) +
-                                        (((uint64_t)uws_client->received_bytes[6]) << 24) +
-                                        (((uint64_t)uws_client->received_bytes[7]) << 16) +
-                                        (((uint64_t)uws_client->received_bytes[8]) << 8) +
-                                        (uint64_t)(uws_client->received_bytes[9]));
+                                    length = (size_t)(((uint64_t)(received_bytes[2]) << 56) +
+                                        (((uint64_t)received_bytes[3]) << 48) +
+                                        (((uint64_t)received_bytes[4]) << 40) +
+                                        (((uint64_t)received_bytes[5]) << 32) +
+                                        (((uint64_t)received_bytes[6]) << 24) +
+                                        (((uint64_t)received_bytes[7]) << 16) +
+                                        (((uint64_t)received_bytes[8]) << 8) +
+                                        (uint64_t)(received_bytes[9]));
 
                                     if (length < 65536)
                                     {
@@ -1184,7 +1250,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                         if ((has_error == 0) &&
                             (uws_client->received_bytes_count >= needed_bytes))
                         {
-                            unsigned char opcode = uws_client->received_bytes[0] & 0xF;
+                            unsigned char opcode = received_bytes[0] & 0xF;
 
                             switch (opcode)
                             {
@@ -1200,7 +1266,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
-                                uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_TEXT, uws_client->received_bytes + needed_bytes - length, length);
+                                uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_TEXT, received_bytes + needed_bytes - length, length);
                                 decode_stream = 1;
                                 break;
 
@@ -1213,7 +1279,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 /* Codes_SRS_UWS_CLIENT_01_280: [ Upon receiving a data frame (Section 5.6), the endpoint MUST note the /type/ of the data as defined by the opcode (frame-opcode) from Section 5.2. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_281: [ The "Application data" from this frame is defined as the /data/ of the message. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_282: [ If the frame comprises an unfragmented message (Section 5.4), it is said that _A WebSocket Message Has Been Received_ with type /type/ and data /data/. ]*/
-                                uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_BINARY, uws_client->received_bytes + needed_bytes - length, length);
+                                uws_client->on_ws_frame_received(uws_client->on_ws_frame_received_context, WS_FRAME_TYPE_BINARY, received_bytes + needed_bytes - length, length);
                                 decode_stream = 1;
                                 break;
 
@@ -1223,11 +1289,9 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                             {
                                 uint16_t close_code;
                                 uint16_t* close_code_ptr;
-                                const unsigned char* data_ptr = uws_client->received_bytes + needed_bytes - length;
+                                const unsigned char* data_ptr = received_bytes + needed_bytes - length;
                                 const unsigned char* extra_data_ptr;
                                 size_t extra_data_length;
-                                unsigned char* close_frame_bytes;
-                                size_t close_frame_length;
                                 bool utf8_error = false;
 
                                 /* Codes_SRS_UWS_CLIENT_01_235: [ The Close frame MAY contain a body (the "Application data" portion of the frame) that indicates a reason for closing, such as an endpoint shutting down, an endpoint having received a frame too large, or an endpoint having received a frame that does not conform to the format expected by the endpoint. ]*/
@@ -1279,7 +1343,8 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                 }
                                 else
                                 {
-                                    BUFFER_HANDLE close_frame_buffer;
+                                    unsigned char close_frame[UWS_CLIENT_MAX_CONTROL_FRAME_SIZE];
+                                    size_t close_frame_length;
 
                                     if (uws_client->uws_state == UWS_STATE_CLOSING_WAITING_FOR_CLOSE)
                                     {
@@ -1301,8 +1366,9 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     /* Codes_SRS_UWS_CLIENT_01_242: [ It SHOULD do so as soon as practical. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_239: [ Close frames sent from client to server must be masked as per Section 5.3. ]*/
                                     /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-                                    close_frame_buffer = uws_frame_encoder_encode(WS_CLOSE_FRAME, NULL, 0, true, true, 0);
-                                    if (close_frame_buffer == NULL)
+                                    /* Codes_SRS_UWS_CLIENT_99_006: [ Control frames shall be encoded into a buffer on the stack by calling `uws_frame_encoder_encode_into`. ]*/
+                                    close_frame_length = uws_frame_encoder_get_encoded_size(0, true);
+                                    if (uws_frame_encoder_encode_into(close_frame, sizeof(close_frame), WS_CLOSE_FRAME, NULL, 0, true, true, 0) != 0)
                                     {
                                         LogError("Cannot encode the response CLOSE frame");
 
@@ -1317,9 +1383,7 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                     }
                                     else
                                     {
-                                        close_frame_bytes = BUFFER_u_char(close_frame_buffer);
-                                        close_frame_length = BUFFER_length(close_frame_buffer);
-                                        if (xio_send(uws_client->underlying_io, close_frame_bytes, close_frame_length, on_underlying_io_close_sent, uws_client) != 0)
+                                        if (xio_send(uws_client->underlying_io, close_frame, close_frame_length, on_underlying_io_close_sent, uws_client) != 0)
                                         {
                                             LogError("Cannot send the response CLOSE frame");
 
@@ -1332,8 +1396,6 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                                                 uws_client->uws_state = UWS_STATE_CLOSED;
                                             }
                                         }
-
-                                        BUFFER_delete(close_frame_buffer);
                                     }
                                 }
 
@@ -1350,29 +1412,22 @@ static void on_underlying_io_bytes_received(void* context, const unsigned char*
                             {
                                 /* Codes_SRS_UWS_CLIENT_01_249: [ Upon receipt of a Ping frame, an endpoint MUST send a Pong frame in response ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_250: [ It SHOULD respond with Pong frame as soon as is practical. ]*/
-                                unsigned char* pong_frame;
+                                unsigned char pong_frame[UWS_CLIENT_MAX_CONTROL_FRAME_SIZE];
                                 size_t pong_frame_length;
-                                BUFFER_HANDLE pong_frame_buffer;
 
                                 uws_client->uws_state = UWS_STATE_ERROR;
 
+                                /* Codes_SRS_UWS_CLIENT_99_006: [ Control frames shall be encoded into a buffer on the stack by calling `uws_frame_encoder_encode_into`. ]*/
                                 /* Codes_SRS_UWS_CLIENT_01_140: [ To avoid confusing network intermediaries (such as intercepting proxies) and for security reasons that are further discussed in Section 10.3, a client MUST mask all frames that it sends to the server (see Section 5.3 for further details). ]*/
-                                pong_frame_buffer = uws_frame_encoder_encode(WS_PONG_FRAME, uws_client->received_bytes + needed_bytes - length, length, true, true, 0);
-                                if (pong_frame_buffer == NULL)
+                                /* Codes_SRS_UWS_CLIENT_01_248: [ A Ping frame MAY include "Application data". ]*/
+                                pong_frame_length = uws_frame_encoder_get_encoded_size(length, true);
+                                if (uws_frame_encoder_encode_into(pong_frame, sizeof(pong_frame), WS_PONG_FRAME, received_bytes + needed_bytes - length, length, true, true, 0) != 0)
                                 {
                                     LogError("Encoding of PONG failed.");
                                 }
-                                else
+                                else if (xio_send(uws_client->underlying_io, pong_frame, pong_frame_length, unchecked_on_send_complete, NULL) != 0)
                                 {
-                                    /* Codes_SRS_UWS_CLIENT_01_248: [ A Ping frame MAY include "Application data". ]*/
-                                    pong_frame = BUFFER_u_char(pong_frame_buffer);
-                                    pong_frame_length = BUFFER_length(pong_frame_buffer);
-                                    if (xio_send(uws_client->underlying_io, pong_frame, pong_frame_length, unchecked_on_send_complete, NULL) != 0)
-                                    {
-                                        LogError("Sending CLOSE frame failed.");
-                                    }
-
-                                    BUFFER_delete(pong_frame_buffer);
+                                    LogError("Sending PONG frame failed.");
                                 }
 
                                 break;
@@ -1459,6 +1514,7 @@ int uws_client_open_async(UWS_CLIENT_HANDLE uws_client, ON_WS_OPEN_COMPLETE on_w
         {
             uws_client->uws_state = UWS_STATE_OPENING_UNDERLYING_IO;
 
+            uws_client->received_bytes_offset = 0;
             uws_client->received_bytes_count = 0;
 
             uws_client->on_ws_open_complete = on_ws_open_complete;
@@ -1729,31 +1785,34 @@ int uws_client_send_frame_async(UWS_CLIENT_HANDLE uws_client, unsigned char fram
         }
         else
         {
-            BUFFER_HANDLE non_control_frame_buffer;
+            /* Codes_SRS_UWS_CLIENT_01_428: [ The encoded frame size shall be obtained by calling `uws_frame_encoder_get_encoded_size` with `size` and `is_masked` set to true. ]*/
+            size_t encoded_frame_length = uws_frame_encoder_get_encoded_size(size, true);
 
-            /* Codes_SRS_UWS_CLIENT_01_425: [ Encoding shall be done by calling `uws_frame_encoder_encode` and passing to it the `buffer` and `size` argument for payload, the `is_final` flag and setting `is_masked` to true. ]*/
+            /* Codes_SRS_UWS_CLIENT_01_429: [ The memory for the encoded frame shall be allocated with a single `malloc` of that size. ]*/
+            unsigned char* encoded_frame = (unsigned char*)malloc(encoded_frame_length);
+            if (encoded_frame == NULL)
+            {
+                /* Codes_SRS_UWS_CLIENT_99_007: [ If allocating memory for the encoded frame fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+                LogError("Cannot allocate memory for the encoded frame");
+                free(ws_pending_send);
+                result = __FAILURE__;
+            }
+            /* Codes_SRS_UWS_CLIENT_01_425: [ Encoding shall be done by calling `uws_frame_encoder_encode_into` and passing to it the encoded frame memory, the `buffer` and `size` argument for payload, the `is_final` flag and setting `is_masked` to true. ]*/
             /* Codes_SRS_UWS_CLIENT_01_270: [ An endpoint MUST encapsulate the /data/ in a WebSocket frame as defined in Section 5.2. ]*/
             /* Codes_SRS_UWS_CLIENT_01_272: [ The opcode (frame-opcode) of the first frame containing the data MUST be set to the appropriate value from Section 5.2 for data that is to be interpreted by the recipient as text or binary data. ]*/
             /* Codes_SRS_UWS_CLIENT_01_274: [ If the data is being sent by the client, the frame(s) MUST be masked as defined in Section 5.3. ]*/
-            non_control_frame_buffer = uws_frame_encoder_encode((WS_FRAME_TYPE)frame_type, buffer, size, true, is_final, 0);
-            if (non_control_frame_buffer == NULL)
+            else if (uws_frame_encoder_encode_into(encoded_frame, encoded_frame_length, (WS_FRAME_TYPE)frame_type, buffer, size, true, is_final, 0) != 0)
             {
-                /* Codes_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
+                /* Codes_SRS_UWS_CLIENT_01_426: [ If `uws_frame_encoder_encode_into` fails, `uws_client_send_frame_async` shall fail and return a non-zero value. ]*/
                 LogError("Failed encoding WebSocket frame");
+                free(encoded_frame);
                 free(ws_pending_send);
                 result = __FAILURE__;
             }
             else
             {
-                const unsigned char* encoded_frame;
-                size_t encoded_frame_length;
                 LIST_ITEM_HANDLE new_pending_send_list_item;
 
-                /* Codes_SRS_UWS_CLIENT_01_428: [ The encoded frame buffer memory shall be obtained by calling `BUFFER_u_char` on the encode buffer. ]*/
-                encoded_frame = BUFFER_u_char(non_control_frame_buffer);
-                /* Codes_SRS_UWS_CLIENT_01_429: [ The encoded frame size shall be obtained by calling `BUFFER_length` on the encode buffer. ]*/
-                encoded_frame_length = BUFFER_length(non_control_frame_buffer);
-
                 /* Codes_SRS_UWS_CLIENT_01_038: [ `uws_client_send_frame_async` shall create and queue a structure that contains: ]*/
                 /* Codes_SRS_UWS_CLIENT_01_050: [ The argument `on_ws_send_frame_complete` shall be optional, if NULL is passed by the caller then no send complete callback shall be triggered. ]*/
                 /* Codes_SRS_UWS_CLIENT_01_040: [ - the send complete callback `on_ws_send_frame_complete` ]*/
@@ -1802,7 +1861,8 @@ int uws_client_send_frame_async(UWS_CLIENT_HANDLE uws_client, unsigned char fram
                     }
                 }
 
-                BUFFER_delete(non_control_frame_buffer);
+                /* Codes_SRS_UWS_CLIENT_99_008: [ The encoded frame memory shall be freed once `xio_send` returns. ]*/
+                free(encoded_frame);
             }
         }
     }
@@ -0,0 +1,152 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Encodes and decodes buffers of several sizes with the allocating API (Base64_Encode_Bytes/Base64_Decoder)
+   and with the caller buffer API (Base64_EncodeInto/Base64_DecodeInto), reporting MB/s of binary data for each. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "azure_c_shared_utility/base64.h"
+
+#define DEFAULT_MEGABYTES 64
+#define MAX_BUFFER_SIZE (16 * 1024)
+
+typedef enum BASE64_PERF_API_TAG
+{
+    BASE64_PERF_ENCODE_BYTES,
+    BASE64_PERF_ENCODE_INTO,
+    BASE64_PERF_DECODER,
+    BASE64_PERF_DECODE_INTO
+} BASE64_PERF_API;
+
+static const char* const api_names[] = { "Base64_Encode_Bytes", "Base64_EncodeInto", "Base64_Decoder", "Base64_DecodeInto" };
+
+static const size_t buffer_sizes[] = { 32, 256, 1024, MAX_BUFFER_SIZE };
+
+static unsigned char binary[MAX_BUFFER_SIZE];
+static char encoded[BASE64_ENCODED_SIZE(MAX_BUFFER_SIZE)];
+static unsigned char decoded[MAX_BUFFER_SIZE];
+
+static int run_once(BASE64_PERF_API api, size_t size)
+{
+    int result = 0;
+
+    switch (api)
+    {
+    case BASE64_PERF_ENCODE_BYTES:
+    {
+        STRING_HANDLE string = Base64_Encode_Bytes(binary, size);
+        if (string == NULL)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            STRING_delete(string);
+        }
+        break;
+    }
+    case BASE64_PERF_ENCODE_INTO:
+        result = Base64_EncodeInto(binary, size, encoded, sizeof(encoded));
+        break;
+    case BASE64_PERF_DECODER:
+    {
+        BUFFER_HANDLE buffer = Base64_Decoder(encoded);
+        if (buffer == NULL)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            BUFFER_delete(buffer);
+        }
+        break;
+    }
+    default:
+    {
+        size_t decodedSize;
+        result = Base64_DecodeInto(encoded, BASE64_ENCODED_SIZE(size) - 1, decoded, sizeof(decoded), &decodedSize);
+        break;
+    }
+    }
+
+    return result;
+}
+
+static int run_api(BASE64_PERF_API api, size_t size, size_t megabytes)
+{
+    int result = 0;
+    size_t iterations = (megabytes * 1024 * 1024) / size;
+    clock_t start_time;
+    double seconds;
+    size_t i;
+
+    /* the decoders read what the encoder left in encoded */
+    if (Base64_EncodeInto(binary, size, encoded, sizeof(encoded)) != 0)
+    {
+        (void)printf("Base64_EncodeInto failed\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        start_time = clock();
+        for (i = 0; i < iterations; i++)
+        {
+            if ((result = run_once(api, size)) != 0)
+            {
+                (void)printf("%s failed at iteration %lu\r\n", api_names[api], (unsigned long)i);
+                break;
+            }
+        }
+        seconds = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+        if (seconds <= 0.0)
+        {
+            seconds = 1.0 / CLOCKS_PER_SEC;
+        }
+
+        if (result == 0)
+        {
+            (void)printf("%-20s %6lu bytes: %8.1f MB/s\r\n", api_names[api], (unsigned long)size,
+                ((double)iterations * (double)size) / (1024.0 * 1024.0) / seconds);
+        }
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int result = 0;
+    size_t megabytes = DEFAULT_MEGABYTES;
+    size_t i;
+    size_t j;
+
+    if (argc > 1)
+    {
+        megabytes = (size_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (megabytes == 0)
+    {
+        (void)printf("usage: base64_perf [megabytes per run]\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        for (i = 0; i < sizeof(binary); i++)
+        {
+            binary[i] = (unsigned char)(i * 167 + 13);
+        }
+
+        for (i = 0; (result == 0) && (i < sizeof(api_names) / sizeof(api_names[0])); i++)
+        {
+            for (j = 0; (result == 0) && (j < sizeof(buffer_sizes) / sizeof(buffer_sizes[0])); j++)
+            {
+                result = run_api((BASE64_PERF_API)i, buffer_sizes[j], megabytes);
+            }
+        }
+    }
+
+    return result;
+}
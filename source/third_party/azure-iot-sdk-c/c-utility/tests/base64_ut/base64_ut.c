@@ -1807,4 +1807,300 @@ TEST_FUNCTION(Base64_Decoder_invalid_length_fails_6)
 }
 
 
+/* reference encoder, one bit at a time, for the long inputs that go through the vectorized code */
+static void reference_base64_encode(const unsigned char* source, size_t size, char* destination)
+{
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t bit;
+    size_t written = 0;
+
+    for (bit = 0; bit < size * 8; bit += 6)
+    {
+        unsigned int value = 0;
+        size_t i;
+        for (i = bit; i < bit + 6; i++)
+        {
+            value <<= 1;
+            if ((i < size * 8) && ((source[i / 8] >> (7 - (i % 8))) & 1))
+            {
+                value |= 1;
+            }
+        }
+        destination[written++] = alphabet[value];
+    }
+    while ((written % 4) != 0)
+    {
+        destination[written++] = '=';
+    }
+    destination[written] = '\0';
+}
+
+/*Tests_SRS_BASE64_99_001: [ If source or destination is NULL then Base64_EncodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_EncodeInto_with_NULL_source_fails)
+{
+    ///arrange
+    char destination[8];
+
+    ///act
+    int result = Base64_EncodeInto(NULL, 1, destination, sizeof(destination));
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_BASE64_99_001: [ If source or destination is NULL then Base64_EncodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_EncodeInto_with_NULL_destination_fails)
+{
+    ///act
+    int result = Base64_EncodeInto((const unsigned char*)"a", 1, NULL, 8);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_BASE64_99_002: [ If destinationSize is smaller than BASE64_ENCODED_SIZE(size) then Base64_EncodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_EncodeInto_with_too_small_destination_fails)
+{
+    ///arrange
+    char destination[8];
+
+    ///act
+    int result = Base64_EncodeInto((const unsigned char*)"abcd", 4, destination, BASE64_ENCODED_SIZE(4) - 1);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_BASE64_99_003: [ Otherwise Base64_EncodeInto shall write the base64 encoding of the size bytes at source followed by a '\0' to destination and return 0. ]*/
+TEST_FUNCTION(Base64_EncodeInto_with_zero_size_writes_empty_string)
+{
+    ///arrange
+    char destination[1] = { 'x' };
+
+    ///act
+    int result = Base64_EncodeInto((const unsigned char*)"a", 0, destination, sizeof(destination));
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "", destination);
+}
+
+/*Tests_SRS_BASE64_99_003: [ Otherwise Base64_EncodeInto shall write the base64 encoding of the size bytes at source followed by a '\0' to destination and return 0. ]*/
+TEST_FUNCTION(Base64_EncodeInto_exhaustive_succeeds)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(testVector_BINARY_with_equal_signs) / sizeof(testVector_BINARY_with_equal_signs[0]); i++)
+    {
+        ///arrange
+        char destination[BASE64_ENCODED_SIZE(10)];
+
+        ///act
+        int result = Base64_EncodeInto(testVector_BINARY_with_equal_signs[i].inputData, testVector_BINARY_with_equal_signs[i].inputLength, destination, BASE64_ENCODED_SIZE(testVector_BINARY_with_equal_signs[i].inputLength));
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, testVector_BINARY_with_equal_signs[i].expectedOutput, destination);
+    }
+}
+
+/*Tests_SRS_BASE64_99_003: [ Otherwise Base64_EncodeInto shall write the base64 encoding of the size bytes at source followed by a '\0' to destination and return 0. ]*/
+TEST_FUNCTION(Base64_EncodeInto_long_inputs_match_the_reference_encoding)
+{
+    unsigned char source[300];
+    size_t size;
+
+    for (size = 0; size < sizeof(source); size++)
+    {
+        source[size] = (unsigned char)(size * 167 + 13);
+    }
+
+    for (size = 0; size <= sizeof(source); size++)
+    {
+        ///arrange
+        char expected[BASE64_ENCODED_SIZE(300)];
+        char destination[BASE64_ENCODED_SIZE(300)];
+        reference_base64_encode(source, size, expected);
+
+        ///act
+        int result = Base64_EncodeInto(source, size, destination, BASE64_ENCODED_SIZE(size));
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, expected, destination);
+    }
+}
+
+/*Tests_SRS_BASE64_99_004: [ If source, destination or decodedSize is NULL then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_NULL_arguments_fails)
+{
+    ///arrange
+    unsigned char destination[3];
+    size_t decodedSize;
+
+    ///act
+    int result1 = Base64_DecodeInto(NULL, 4, destination, sizeof(destination), &decodedSize);
+    int result2 = Base64_DecodeInto("QUJD", 4, NULL, sizeof(destination), &decodedSize);
+    int result3 = Base64_DecodeInto("QUJD", 4, destination, sizeof(destination), NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+}
+
+/*Tests_SRS_BASE64_99_005: [ If sourceLength is not a multiple of 4 then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_invalid_length_fails)
+{
+    ///arrange
+    unsigned char destination[3];
+    size_t decodedSize;
+
+    ///act
+    int result = Base64_DecodeInto("QUJDR", 5, destination, sizeof(destination), &decodedSize);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_BASE64_99_006: [ If destinationSize is smaller than the size of the decoded data then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_too_small_destination_fails)
+{
+    ///arrange
+    unsigned char destination[3];
+    size_t decodedSize;
+
+    ///act
+    int result = Base64_DecodeInto("QUJD", 4, destination, 2, &decodedSize);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_BASE64_99_006: [ If destinationSize is smaller than the size of the decoded data then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_destination_the_size_of_the_padded_data_succeeds)
+{
+    ///arrange
+    unsigned char destination[1];
+    size_t decodedSize;
+
+    ///act
+    int result = Base64_DecodeInto("QQ==", 4, destination, sizeof(destination), &decodedSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, decodedSize);
+    ASSERT_ARE_EQUAL(int, 'A', destination[0]);
+}
+
+/*Tests_SRS_BASE64_99_007: [ If source contains anything but base64 characters and one or two '=' at its end then Base64_DecodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(Base64_DecodeInto_with_invalid_characters_fails)
+{
+    static const char* const invalid[] =
+    {
+        "QU*D",
+        "Q===",
+        "QQ=A",
+        "====",
+        "QQ==QUJD",
+        "QUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQU\x80" "DQUJD",
+        "QUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJDQUJ DQUJD"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++)
+    {
+        ///arrange
+        unsigned char destination[64];
+        size_t decodedSize;
+
+        ///act
+        int result = Base64_DecodeInto(invalid[i], strlen(invalid[i]), destination, sizeof(destination), &decodedSize);
+
+        ///assert
+        ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    }
+}
+
+/*Tests_SRS_BASE64_99_008: [ Otherwise Base64_DecodeInto shall write the decoded bytes to destination, set decodedSize to their count and return 0. ]*/
+TEST_FUNCTION(Base64_DecodeInto_exhaustive_succeeds)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(testVector_BINARY_with_equal_signs) / sizeof(testVector_BINARY_with_equal_signs[0]); i++)
+    {
+        ///arrange
+        unsigned char destination[BASE64_DECODED_MAX_SIZE(16)];
+        size_t decodedSize = 0;
+        const char* source = testVector_BINARY_with_equal_signs[i].expectedOutput;
+
+        ///act
+        int result = Base64_DecodeInto(source, strlen(source), destination, sizeof(destination), &decodedSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, testVector_BINARY_with_equal_signs[i].inputLength, decodedSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, testVector_BINARY_with_equal_signs[i].inputData, decodedSize));
+    }
+}
+
+/*Tests_SRS_BASE64_99_008: [ Otherwise Base64_DecodeInto shall write the decoded bytes to destination, set decodedSize to their count and return 0. ]*/
+TEST_FUNCTION(Base64_DecodeInto_long_inputs_round_trip)
+{
+    unsigned char source[300];
+    size_t size;
+
+    for (size = 0; size < sizeof(source); size++)
+    {
+        source[size] = (unsigned char)(size * 167 + 13);
+    }
+
+    for (size = 0; size <= sizeof(source); size++)
+    {
+        ///arrange
+        char encoded[BASE64_ENCODED_SIZE(300)];
+        unsigned char destination[BASE64_DECODED_MAX_SIZE(BASE64_ENCODED_SIZE(300))];
+        size_t decodedSize = 0;
+        reference_base64_encode(source, size, encoded);
+
+        ///act
+        int result = Base64_DecodeInto(encoded, strlen(encoded), destination, sizeof(destination), &decodedSize);
+
+        ///assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(size_t, size, decodedSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, source, size));
+    }
+}
+
+TEST_FUNCTION(Base64_Decoder_long_inputs_round_trip)
+{
+    unsigned char source[300];
+    size_t size;
+
+    for (size = 0; size < sizeof(source); size++)
+    {
+        source[size] = (unsigned char)(size * 167 + 13);
+    }
+
+    for (size = 1; size <= sizeof(source); size++)
+    {
+        ///arrange
+        char encoded[BASE64_ENCODED_SIZE(300)];
+        BUFFER_HANDLE result;
+        reference_base64_encode(source, size, encoded);
+
+        ///act
+        result = Base64_Decoder(encoded);
+
+        ///assert
+        ASSERT_IS_NOT_NULL(result);
+        ASSERT_ARE_EQUAL(size_t, size, BUFFER_length(result));
+        ASSERT_ARE_EQUAL(int, 0, memcmp(BUFFER_u_char(result), source, size));
+
+        ///cleanup
+        BUFFER_delete(result);
+    }
+}
+
 END_TEST_SUITE(base64_unittests);
@@ -0,0 +1,471 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstdint>
+#include <ctime>
+#else
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#endif
+
+void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/agenttime.h"
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/dns_cache.h"
+
+#define TEST_LOCK_HANDLE (LOCK_HANDLE)0x4242
+#define TEST_IPV4 0x0A000001
+#define TEST_OTHER_IPV4 0x0A000002
+
+static time_t test_now;
+
+static time_t my_get_time(time_t* currentTime)
+{
+    (void)currentTime;
+    return test_now;
+}
+
+static double my_get_difftime(time_t stopTime, time_t startTime)
+{
+    return (double)(stopTime - startTime);
+}
+
+IMPLEMENT_UMOCK_C_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+BEGIN_TEST_SUITE(dns_cache_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(time_t, long);
+    REGISTER_TYPE(LOCK_RESULT, LOCK_RESULT);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_HOOK(get_time, my_get_time);
+    REGISTER_GLOBAL_MOCK_HOOK(get_difftime, my_get_difftime);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    test_now = 1000;
+    dns_cache_set_ttl(DNS_CACHE_DEFAULT_TTL_SECONDS);
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* Tests_SRS_DNS_CACHE_99_001: [ dns_cache_init shall create the lock guarding the cache. ]*/
+TEST_FUNCTION(dns_cache_init_creates_the_lock)
+{
+    ///arrange
+    int result;
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    ///act
+    result = dns_cache_init();
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_002: [ If the cache is already initialized, dns_cache_init shall only count the call and return 0. ]*/
+/* Tests_SRS_DNS_CACHE_99_004: [ The dns_cache_deinit call matching the first dns_cache_init shall free every entry and the lock. ]*/
+TEST_FUNCTION(dns_cache_init_nests)
+{
+    ///arrange
+    int result;
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+
+    ///act
+    result = dns_cache_init();
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    dns_cache_deinit();
+    dns_cache_deinit();
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_DNS_CACHE_99_003: [ If Lock_Init fails, dns_cache_init shall log an error and return a non-zero value. ]*/
+TEST_FUNCTION(dns_cache_init_fails_when_Lock_Init_fails)
+{
+    ///arrange
+    int result;
+    uint32_t ipv4;
+    STRICT_EXPECTED_CALL(Lock_Init()).SetReturn(NULL);
+
+    ///act
+    result = dns_cache_init();
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, dns_cache_get_ipv4("host.example", &ipv4));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_DNS_CACHE_99_005: [ If the cache is not initialized, dns_cache_deinit shall do nothing. ]*/
+TEST_FUNCTION(dns_cache_deinit_without_init_does_nothing)
+{
+    ///act
+    dns_cache_deinit();
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_DNS_CACHE_99_011: [ If the cache is not initialized, dns_cache_get_ipv4 shall return a non-zero value. ]*/
+/* Tests_SRS_DNS_CACHE_99_021: [ If the cache is not initialized or the time to live is 0, dns_cache_add_ipv4 shall return a non-zero value. ]*/
+TEST_FUNCTION(dns_cache_without_init_always_misses)
+{
+    ///arrange
+    uint32_t ipv4;
+
+    ///act
+    int add_result = dns_cache_add_ipv4("host.example", TEST_IPV4);
+    int get_result = dns_cache_get_ipv4("host.example", &ipv4);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, add_result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, get_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_DNS_CACHE_99_010: [ If hostname or ipv4 is NULL, dns_cache_get_ipv4 shall log an error and return a non-zero value. ]*/
+TEST_FUNCTION(dns_cache_get_ipv4_NULL_arguments_fail)
+{
+    ///arrange
+    uint32_t ipv4;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    umock_c_reset_all_calls();
+
+    ///act
+    int null_hostname_result = dns_cache_get_ipv4(NULL, &ipv4);
+    int null_ipv4_result = dns_cache_get_ipv4("host.example", NULL);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, null_hostname_result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, null_ipv4_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_020: [ If hostname is NULL or ipv4 is 0, dns_cache_add_ipv4 shall log an error and return a non-zero value. ]*/
+TEST_FUNCTION(dns_cache_add_ipv4_invalid_arguments_fail)
+{
+    ///arrange
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    umock_c_reset_all_calls();
+
+    ///act
+    int null_hostname_result = dns_cache_add_ipv4(NULL, TEST_IPV4);
+    int zero_ipv4_result = dns_cache_add_ipv4("host.example", 0);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, null_hostname_result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, zero_ipv4_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_022: [ dns_cache_add_ipv4 shall store ipv4 for hostname with the current time and time to live and return 0. ]*/
+/* Tests_SRS_DNS_CACHE_99_012: [ If hostname has an unexpired address, dns_cache_get_ipv4 shall store it in ipv4 and return 0. ]*/
+TEST_FUNCTION(dns_cache_get_ipv4_returns_the_added_address)
+{
+    ///arrange
+    uint32_t ipv4 = 0;
+    int result;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_add_ipv4("host.example", TEST_IPV4));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = dns_cache_get_ipv4("HOST.example", &ipv4);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(uint32_t, TEST_IPV4, ipv4);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_022: [ dns_cache_add_ipv4 shall store ipv4 for hostname with the current time and time to live and return 0. ]*/
+TEST_FUNCTION(dns_cache_add_ipv4_replaces_the_address_of_a_cached_host)
+{
+    ///arrange
+    uint32_t ipv4 = 0;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_add_ipv4("host.example", TEST_IPV4));
+
+    ///act
+    int result = dns_cache_add_ipv4("host.example", TEST_OTHER_IPV4);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_get_ipv4("host.example", &ipv4));
+    ASSERT_ARE_EQUAL(uint32_t, TEST_OTHER_IPV4, ipv4);
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_013: [ If hostname is not cached, dns_cache_get_ipv4 shall return a non-zero value. ]*/
+TEST_FUNCTION(dns_cache_get_ipv4_misses_an_unknown_host)
+{
+    ///arrange
+    uint32_t ipv4;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_add_ipv4("host.example", TEST_IPV4));
+
+    ///act
+    int result = dns_cache_get_ipv4("other.example", &ipv4);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_014: [ If the cached address is at least its time to live old, dns_cache_get_ipv4 shall drop it and return a non-zero value. ]*/
+TEST_FUNCTION(dns_cache_get_ipv4_drops_an_expired_address)
+{
+    ///arrange
+    uint32_t ipv4;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_add_ipv4("host.example", TEST_IPV4));
+    test_now += DNS_CACHE_DEFAULT_TTL_SECONDS - 1;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_get_ipv4("host.example", &ipv4));
+    test_now += 1;
+
+    ///act
+    int result = dns_cache_get_ipv4("host.example", &ipv4);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    test_now -= DNS_CACHE_DEFAULT_TTL_SECONDS;
+    ASSERT_ARE_NOT_EQUAL(int, 0, dns_cache_get_ipv4("host.example", &ipv4));
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_006: [ dns_cache_set_ttl shall set the time to live of addresses added afterwards. ]*/
+TEST_FUNCTION(dns_cache_set_ttl_applies_to_later_adds)
+{
+    ///arrange
+    uint32_t ipv4;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    dns_cache_set_ttl(10);
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_add_ipv4("host.example", TEST_IPV4));
+    test_now += 10;
+
+    ///act
+    int result = dns_cache_get_ipv4("host.example", &ipv4);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_021: [ If the cache is not initialized or the time to live is 0, dns_cache_add_ipv4 shall return a non-zero value. ]*/
+TEST_FUNCTION(dns_cache_add_ipv4_with_zero_ttl_does_not_cache)
+{
+    ///arrange
+    uint32_t ipv4;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    dns_cache_set_ttl(0);
+    umock_c_reset_all_calls();
+
+    ///act
+    int result = dns_cache_add_ipv4("host.example", TEST_IPV4);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, dns_cache_get_ipv4("host.example", &ipv4));
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_023: [ A new host name shall take a free entry or else the least recently resolved one. ]*/
+TEST_FUNCTION(dns_cache_add_ipv4_replaces_the_least_recently_resolved_host_when_full)
+{
+    ///arrange
+    char hostname[32];
+    uint32_t ipv4;
+    size_t i;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    for (i = 0; i < DNS_CACHE_MAX_ENTRIES; i++)
+    {
+        (void)sprintf(hostname, "host%u.example", (unsigned int)i);
+        ASSERT_ARE_EQUAL(int, 0, dns_cache_add_ipv4(hostname, (uint32_t)(TEST_IPV4 + i)));
+        test_now++;
+    }
+    /* refreshing host0 makes host1 the oldest */
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_add_ipv4("host0.example", TEST_IPV4));
+    test_now++;
+
+    ///act
+    int result = dns_cache_add_ipv4("new.example", TEST_OTHER_IPV4);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_NOT_EQUAL(int, 0, dns_cache_get_ipv4("host1.example", &ipv4));
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_get_ipv4("host0.example", &ipv4));
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_get_ipv4("new.example", &ipv4));
+    ASSERT_ARE_EQUAL(uint32_t, TEST_OTHER_IPV4, ipv4);
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_024: [ If copying hostname fails, dns_cache_add_ipv4 shall log an error and return a non-zero value. ]*/
+TEST_FUNCTION(dns_cache_add_ipv4_fails_when_copying_the_hostname_fails)
+{
+    ///arrange
+    uint32_t ipv4;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    int result = dns_cache_add_ipv4("host.example", TEST_IPV4);
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, dns_cache_get_ipv4("host.example", &ipv4));
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_031: [ dns_cache_remove shall drop the address cached for hostname, if any. ]*/
+TEST_FUNCTION(dns_cache_remove_drops_the_host)
+{
+    ///arrange
+    uint32_t ipv4;
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_add_ipv4("host.example", TEST_IPV4));
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_add_ipv4("other.example", TEST_OTHER_IPV4));
+
+    ///act
+    dns_cache_remove("Host.Example");
+    dns_cache_remove("unknown.example");
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, dns_cache_get_ipv4("host.example", &ipv4));
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_get_ipv4("other.example", &ipv4));
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+/* Tests_SRS_DNS_CACHE_99_030: [ If hostname is NULL, dns_cache_remove shall log an error and do nothing. ]*/
+TEST_FUNCTION(dns_cache_remove_NULL_hostname_does_nothing)
+{
+    ///arrange
+    ASSERT_ARE_EQUAL(int, 0, dns_cache_init());
+    umock_c_reset_all_calls();
+
+    ///act
+    dns_cache_remove(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    dns_cache_deinit();
+}
+
+END_TEST_SUITE(dns_cache_ut)
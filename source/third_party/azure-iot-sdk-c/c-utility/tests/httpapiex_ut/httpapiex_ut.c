@@ -2765,6 +2765,192 @@ TEST_FUNCTION(HTTPAPIEX_ExecuteRequest_TestCase_F6) /*refer to httpapiex_retry_m
     HTTPAPIEX_Destroy(httpapiexhandle);
 }
 
+/*Tests_SRS_HTTPAPIEX_99_001: [ If handle is NULL, requestType does not indicate a valid request, or content is NULL and contentLength is not 0, then HTTPAPIEX_ExecuteRequestWithContent shall fail and return HTTPAPIEX_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestWithContent_with_NULL_handle_fails)
+{
+    /// arrange
+    HTTPAPIEX_RESULT result;
+    unsigned int httpStatusCode;
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestWithContent(NULL, HTTPAPI_REQUEST_PUT, TEST_RELATIVE_PATH, NULL, TEST_BUFFER, TEST_BUFFER_SIZE, &httpStatusCode, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_HTTPAPIEX_99_001: [ If handle is NULL, requestType does not indicate a valid request, or content is NULL and contentLength is not 0, then HTTPAPIEX_ExecuteRequestWithContent shall fail and return HTTPAPIEX_INVALID_ARG. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestWithContent_with_NULL_content_and_non_zero_length_fails)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    HTTPAPIEX_RESULT result;
+    unsigned int httpStatusCode;
+    umock_c_reset_all_calls();
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestWithContent(httpapiexhandle, HTTPAPI_REQUEST_PUT, TEST_RELATIVE_PATH, NULL, NULL, TEST_BUFFER_SIZE, &httpStatusCode, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_002: [ HTTPAPIEX_ExecuteRequestWithContent shall build the request headers, relative path, status code, response headers and response content as HTTPAPIEX_ExecuteRequest does, using contentLength for Content-Length. ]*/
+/*Tests_SRS_HTTPAPIEX_99_004: [ HTTPAPIEX_ExecuteRequestWithContent shall pass content and contentLength, without copying them, to every HTTPAPI_ExecuteRequest call and shall recover from failures as HTTPAPIEX_ExecuteRequest does. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestWithContent_passes_the_content_to_HTTPAPI_ExecuteRequest_without_a_BUFFER)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    HTTPAPIEX_RESULT result;
+
+    unsigned int httpStatusCode;
+    unsigned int asGivenByHttpApi = 201;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    umock_c_reset_all_calls();
+
+    /*this is building the host and content-length for the http request headers; there is no BUFFER to ask for the length*/
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, TEST_BUFFER_SIZE))
+        .IgnoreArgument(1).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(IGNORED_PTR_ARG, "Host", TEST_HOSTNAME))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(IGNORED_PTR_ARG, "Content-Length", TOSTRING(TEST_BUFFER_SIZE)))
+        .IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(HTTPAPI_Init());
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_CreateConnection(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)) /*this is passing the options*/ /*there are none saved in the regular sequences*/
+        .IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(HTTPAPI_ExecuteRequest(
+        IGNORED_PTR_ARG,
+        HTTPAPI_REQUEST_PUT,
+        TEST_RELATIVE_PATH,
+        requestHttpHeaders,
+        IGNORED_PTR_ARG,
+        TEST_BUFFER_SIZE,
+        IGNORED_PTR_ARG,
+        responseHttpHeaders,
+        responseHttpBody))
+        .IgnoreArgument(1)
+        .IgnoreArgument(5)
+        .IgnoreArgument(7)
+        .ValidateArgumentBuffer(5, TEST_BUFFER, TEST_BUFFER_SIZE)
+        .CopyOutArgumentBuffer(7, &asGivenByHttpApi, sizeof(asGivenByHttpApi))
+        ;
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestWithContent(httpapiexhandle, HTTPAPI_REQUEST_PUT, TEST_RELATIVE_PATH, requestHttpHeaders, TEST_BUFFER, TEST_BUFFER_SIZE, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(int, 201, (int)httpStatusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_004: [ HTTPAPIEX_ExecuteRequestWithContent shall pass content and contentLength, without copying them, to every HTTPAPI_ExecuteRequest call and shall recover from failures as HTTPAPIEX_ExecuteRequest does. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestWithContent_sends_the_same_content_again_after_reconnecting)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    HTTPAPIEX_RESULT result;
+
+    unsigned int httpStatusCode;
+    unsigned int asGivenByHttpApi = 23;
+    HTTP_HEADERS_HANDLE requestHttpHeaders;
+    HTTP_HEADERS_HANDLE responseHttpHeaders;
+    BUFFER_HANDLE responseHttpBody = TEST_BUFFER_RESP_BODY;
+    createHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    (void)HTTPAPIEX_ExecuteRequestWithContent(httpapiexhandle, HTTPAPI_REQUEST_PUT, TEST_RELATIVE_PATH, requestHttpHeaders, TEST_BUFFER, TEST_BUFFER_SIZE, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, TEST_BUFFER_SIZE))
+        .IgnoreArgument(1).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(IGNORED_PTR_ARG, "Host", TEST_HOSTNAME))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(IGNORED_PTR_ARG, "Content-Length", TOSTRING(TEST_BUFFER_SIZE)))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, TEST_RELATIVE_PATH, requestHttpHeaders, IGNORED_PTR_ARG, TEST_BUFFER_SIZE, IGNORED_PTR_ARG, responseHttpHeaders, responseHttpBody))
+        .IgnoreArgument(1)
+        .IgnoreArgument(5)
+        .IgnoreArgument(7)
+        .SetReturn(HTTPAPI_ERROR);
+
+    STRICT_EXPECTED_CALL(HTTPAPI_CloseConnection(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_CreateConnection(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPI_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, TEST_RELATIVE_PATH, requestHttpHeaders, IGNORED_PTR_ARG, TEST_BUFFER_SIZE, IGNORED_PTR_ARG, responseHttpHeaders, responseHttpBody))
+        .IgnoreArgument(1)
+        .IgnoreArgument(5)
+        .IgnoreArgument(7)
+        .ValidateArgumentBuffer(5, TEST_BUFFER, TEST_BUFFER_SIZE)
+        .CopyOutArgumentBuffer(7, &asGivenByHttpApi, sizeof(asGivenByHttpApi));
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestWithContent(httpapiexhandle, HTTPAPI_REQUEST_PUT, TEST_RELATIVE_PATH, requestHttpHeaders, TEST_BUFFER, TEST_BUFFER_SIZE, &httpStatusCode, responseHttpHeaders, responseHttpBody);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_OK, result);
+    ASSERT_ARE_EQUAL(int, 23, (int)httpStatusCode);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    destroyHttpObjects(&requestHttpHeaders, &responseHttpHeaders);
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
+/*Tests_SRS_HTTPAPIEX_99_003: [ If building any of them fails, HTTPAPIEX_ExecuteRequestWithContent shall fail and return HTTPAPIEX_ERROR. ]*/
+TEST_FUNCTION(HTTPAPIEX_ExecuteRequestWithContent_with_NULL_request_headers_fails_when_HTTPHeaders_ReplaceHeaderNameValuePair_fails)
+{
+    /// arrange
+    HTTPAPIEX_HANDLE httpapiexhandle = HTTPAPIEX_Create(TEST_HOSTNAME);
+    HTTPAPIEX_RESULT result;
+    unsigned int httpStatusCode;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc()); /*because it makes fakes request headers*/
+    STRICT_EXPECTED_CALL(size_tToString(IGNORED_PTR_ARG, IGNORED_NUM_ARG, TEST_BUFFER_SIZE))
+        .IgnoreArgument(1).IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPHeaders_ReplaceHeaderNameValuePair(IGNORED_PTR_ARG, "Host", TEST_HOSTNAME))
+        .IgnoreArgument(1)
+        .SetReturn(HTTP_HEADERS_ERROR);
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+
+    /// act
+    result = HTTPAPIEX_ExecuteRequestWithContent(httpapiexhandle, HTTPAPI_REQUEST_PUT, TEST_RELATIVE_PATH, NULL, TEST_BUFFER, TEST_BUFFER_SIZE, &httpStatusCode, NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(HTTPAPIEX_RESULT, HTTPAPIEX_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///destroy
+    HTTPAPIEX_Destroy(httpapiexhandle);
+}
+
 /*Tests_SRS_HTTPAPIEX_02_032: [If parameter handle is NULL then HTTPAPIEX_SetOption shall return HTTPAPIEX_INVALID_ARG.] */
 TEST_FUNCTION(HTTPAPIEX_SetOption_fails_with_NULL_handle)
 {
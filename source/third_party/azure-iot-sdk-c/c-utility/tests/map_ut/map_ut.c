@@ -3854,4 +3854,139 @@ BEGIN_TEST_SUITE(map_unittests)
     }
 
     
+    /*Tests_SRS_MAP_99_002: [ If storage is NULL or not aligned to a pointer, or storageSize is smaller than Map_GetInPlaceSize(inlineEntries), Map_CreateInPlace shall return NULL. ]*/
+    TEST_FUNCTION(Map_CreateInPlace_with_invalid_storage_fails)
+    {
+        ///arrange
+        void* storage[32];
+        MAP_HANDLE nullStorage;
+        MAP_HANDLE unaligned;
+        MAP_HANDLE tooSmall;
+
+        ///act
+        nullStorage = Map_CreateInPlace(NULL, NULL, sizeof(storage), 1);
+        unaligned = Map_CreateInPlace(NULL, (unsigned char*)storage + 1, sizeof(storage) - 1, 1);
+        tooSmall = Map_CreateInPlace(NULL, storage, Map_GetInPlaceSize(2) - 1, 2);
+
+        ///assert
+        ASSERT_IS_NULL(nullStorage);
+        ASSERT_IS_NULL(unaligned);
+        ASSERT_IS_NULL(tooSmall);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_MAP_99_001: [ Map_GetInPlaceSize shall return the bytes of storage taken by the map and the arrays of inlineEntries keys and values, before any string. ]*/
+    /*Tests_SRS_MAP_99_003: [ Otherwise Map_CreateInPlace shall create an empty map in storage that keeps its first inlineEntries pairs, and as many keys and values as fit, in storage without allocating. ]*/
+    /*Tests_SRS_MAP_99_004: [ Map_Destroy shall only free what a map made by Map_CreateInPlace allocated past its storage. ]*/
+    TEST_FUNCTION(Map_CreateInPlace_keeps_its_entries_in_storage)
+    {
+        ///arrange
+        void* storage[32];
+        MAP_HANDLE handle;
+        const char*const* keys;
+        const char*const* values;
+        size_t count;
+
+        ///act
+        handle = Map_CreateInPlace(NULL, storage, sizeof(storage), 2);
+        (void)Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+        (void)Map_Add(handle, TEST_YELLOWKEY, TEST_YELLOWVALUE);
+        (void)Map_GetInternals(handle, &keys, &values, &count);
+
+        ///assert
+        ASSERT_ARE_EQUAL(void_ptr, (void*)storage, (void*)handle);
+        ASSERT_ARE_EQUAL(size_t, 2, count);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDKEY, keys[0]);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_YELLOWVALUE, values[1]);
+        ASSERT_IS_TRUE((unsigned char*)keys[1] >= (unsigned char*)storage + Map_GetInPlaceSize(2));
+        ASSERT_IS_TRUE((unsigned char*)values[1] < (unsigned char*)storage + sizeof(storage));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        Map_Destroy(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_MAP_99_003: [ Otherwise Map_CreateInPlace shall create an empty map in storage that keeps its first inlineEntries pairs, and as many keys and values as fit, in storage without allocating. ]*/
+    TEST_FUNCTION(Map_CreateInPlace_allocates_the_strings_that_do_not_fit)
+    {
+        ///arrange
+        void* storage[32];
+        MAP_HANDLE handle = Map_CreateInPlace(NULL, storage, Map_GetInPlaceSize(1) + strlen(TEST_REDKEY) + 1, 1);
+        MAP_RESULT result;
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_REDVALUE) + 1));
+
+        ///act
+        result = Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDVALUE, Map_GetValueFromKey(handle, TEST_REDKEY));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+        Map_Destroy(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_MAP_99_004: [ Map_Destroy shall only free what a map made by Map_CreateInPlace allocated past its storage. ]*/
+    TEST_FUNCTION(Map_CreateInPlace_moves_the_arrays_to_the_heap_past_inlineEntries)
+    {
+        ///arrange
+        void* storage[32];
+        MAP_HANDLE handle = Map_CreateInPlace(NULL, storage, sizeof(storage), 1);
+        MAP_RESULT result;
+        (void)Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(gballoc_malloc(2 * sizeof(char*))); /*keys*/
+        STRICT_EXPECTED_CALL(gballoc_malloc(2 * sizeof(char*))); /*values*/
+
+        ///act
+        result = Map_Add(handle, TEST_YELLOWKEY, TEST_YELLOWVALUE);
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, TEST_REDVALUE, Map_GetValueFromKey(handle, TEST_REDKEY));
+        ASSERT_ARE_EQUAL(char_ptr, TEST_YELLOWVALUE, Map_GetValueFromKey(handle, TEST_YELLOWKEY));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        umock_c_reset_all_calls();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*keys*/
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*values*/
+        Map_Destroy(handle);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_MAP_99_005: [ A value kept in the storage of a map made by Map_CreateInPlace shall be overwritten where it is when the new value is not longer, and copied again otherwise. ]*/
+    TEST_FUNCTION(Map_AddOrUpdate_in_place_overwrites_a_value_in_storage)
+    {
+        ///arrange
+        void* storage[32];
+        MAP_HANDLE handle = Map_CreateInPlace(NULL, storage, sizeof(storage), 2);
+        const char* before;
+        MAP_RESULT shorter;
+        MAP_RESULT longer;
+        (void)Map_Add(handle, TEST_REDKEY, TEST_REDVALUE);
+        before = Map_GetValueFromKey(handle, TEST_REDKEY);
+
+        ///act
+        shorter = Map_AddOrUpdate(handle, TEST_REDKEY, "a");
+        longer = Map_AddOrUpdate(handle, TEST_REDKEY, "testRedValueThatIsLonger");
+
+        ///assert
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, shorter);
+        ASSERT_ARE_EQUAL(MAP_RESULT, MAP_OK, longer);
+        ASSERT_ARE_NOT_EQUAL(void_ptr, (void*)before, (void*)Map_GetValueFromKey(handle, TEST_REDKEY));
+        ASSERT_ARE_EQUAL(char_ptr, "testRedValueThatIsLonger", Map_GetValueFromKey(handle, TEST_REDKEY));
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+        ///cleanup
+        Map_Destroy(handle);
+    }
+
 END_TEST_SUITE(map_unittests)
@@ -110,6 +110,15 @@ static char TEST_CHAR_ARRAY[10] = "ABCD";
 static unsigned char TEST_UNSIGNED_CHAR_ARRAY[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09 };
 static char TEST_TOKEN_EXPIRATION_TIME[32] = "7200";
 
+/* the expected tokens below were computed with an independent HMAC-SHA256 implementation */
+static const char* TEST_SIGNER_KEY = "AQIDBAUGBwgJCgsMDQ4PEBESExQVFhcYGRobHB0eHyA=";
+static const char* TEST_SIGNER_SCOPE = "myhub.azure-devices.net/devices/dev1";
+static const char* TEST_SIGNER_TOKEN_NO_KEY_NAME = "SharedAccessSignature sr=myhub.azure-devices.net/devices/dev1&sig=NHAAcV2ysADzgOfUM%2f%2fccLAZu9pyq4szfCiEJi5HY%2bw%3d&se=1500000002";
+static const char* TEST_SIGNER_TOKEN_EMPTY_KEY_NAME = "SharedAccessSignature sr=myhub.azure-devices.net/devices/dev1&sig=X%2bgBdsKLnBXUyu456RfOsNhdR1%2fKOIzK%2b9ShLstAE0s%3d&se=0&skn=";
+static const char* TEST_SIGNER_TOKEN_LONG_KEY = "SharedAccessSignature sr=myhub.azure-devices.net/devices/dev1&sig=Qf3MnWGIP502%2bTIZC1NTDCiJr0EIA6g%2fCXVh0lbMmxE%3d&se=1500000000&skn=policy";
+static const char* TEST_SIGNER_TOKEN_EMPTY_KEY = "SharedAccessSignature sr=myhub.azure-devices.net/devices/dev1&sig=3ovHBm8nIj6PG%2f4JQtE3qPn0EB8psXuRsxAwBZchqLo%3d&se=1";
+static unsigned char g_decoded_key[100];
+
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
 
@@ -1800,4 +1809,322 @@ TEST_FUNCTION(SASToken_CreateString_succeeds)
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 }
 
+static void fill_short_key(void)
+{
+    size_t i;
+    for (i = 0; i < 32; i++)
+    {
+        g_decoded_key[i] = (unsigned char)(i + 1);
+    }
+}
+
+static void fill_long_key(void)
+{
+    size_t i;
+    for (i = 0; i < sizeof(g_decoded_key); i++)
+    {
+        g_decoded_key[i] = (unsigned char)((i * 7 + 3) & 0xFF);
+    }
+}
+
+static SAS_SIGNER_HANDLE create_test_signer(size_t keyLength)
+{
+    STRICT_EXPECTED_CALL(Base64_Decoder(TEST_SIGNER_KEY)).SetReturn(TEST_DECODEDKEY_HANDLE);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE)).SetReturn(g_decoded_key);
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(keyLength);
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+
+    return SASToken_CreateSigner(TEST_SIGNER_KEY);
+}
+
+/*Tests_SRS_SASTOKEN_99_001: [ If key is NULL then SASToken_CreateSigner shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_CreateSigner_with_NULL_key_fails)
+{
+    // arrange
+    SAS_SIGNER_HANDLE signer;
+
+    // act
+    signer = SASToken_CreateSigner(NULL);
+
+    // assert
+    ASSERT_IS_NULL(signer);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_003: [ If the decoding fails then SASToken_CreateSigner shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_CreateSigner_when_Base64_Decoder_fails_fails)
+{
+    // arrange
+    SAS_SIGNER_HANDLE signer;
+    STRICT_EXPECTED_CALL(Base64_Decoder(TEST_SIGNER_KEY)).SetReturn(NULL);
+
+    // act
+    signer = SASToken_CreateSigner(TEST_SIGNER_KEY);
+
+    // assert
+    ASSERT_IS_NULL(signer);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_006: [ SASToken_CreateSigner shall clear the decoded key before releasing it. ]*/
+/*Tests_SRS_SASTOKEN_99_007: [ If any other error occurs, SASToken_CreateSigner shall fail and return NULL. ]*/
+TEST_FUNCTION(SASToken_CreateSigner_when_malloc_fails_fails)
+{
+    // arrange
+    SAS_SIGNER_HANDLE signer;
+    fill_short_key();
+    STRICT_EXPECTED_CALL(Base64_Decoder(TEST_SIGNER_KEY)).SetReturn(TEST_DECODEDKEY_HANDLE);
+    STRICT_EXPECTED_CALL(BUFFER_u_char(TEST_DECODEDKEY_HANDLE)).SetReturn(g_decoded_key);
+    STRICT_EXPECTED_CALL(BUFFER_length(TEST_DECODEDKEY_HANDLE)).SetReturn(32);
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(BUFFER_delete(TEST_DECODEDKEY_HANDLE));
+
+    // act
+    signer = SASToken_CreateSigner(TEST_SIGNER_KEY);
+
+    // assert
+    ASSERT_IS_NULL(signer);
+    ASSERT_ARE_EQUAL(int, 0, (int)g_decoded_key[0]);
+    ASSERT_ARE_EQUAL(int, 0, (int)g_decoded_key[31]);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_002: [ SASToken_CreateSigner shall decode key from base64. ]*/
+/*Tests_SRS_SASTOKEN_99_005: [ SASToken_CreateSigner shall hash the key XOR ipad block and the key XOR opad block into two SHA-256 contexts kept by the signer. ]*/
+/*Tests_SRS_SASTOKEN_99_006: [ SASToken_CreateSigner shall clear the decoded key before releasing it. ]*/
+TEST_FUNCTION(SASToken_CreateSigner_succeeds)
+{
+    // arrange
+    SAS_SIGNER_HANDLE signer;
+    fill_short_key();
+
+    // act
+    signer = create_test_signer(32);
+
+    // assert
+    ASSERT_IS_NOT_NULL(signer);
+    ASSERT_ARE_EQUAL(int, 0, (int)g_decoded_key[0]);
+    ASSERT_ARE_EQUAL(int, 0, (int)g_decoded_key[31]);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASToken_DestroySigner(signer);
+}
+
+/*Tests_SRS_SASTOKEN_99_008: [ If signer is NULL, SASToken_DestroySigner shall do nothing. ]*/
+TEST_FUNCTION(SASToken_DestroySigner_with_NULL_signer_does_nothing)
+{
+    // act
+    SASToken_DestroySigner(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_009: [ SASToken_DestroySigner shall clear and free the signer. ]*/
+TEST_FUNCTION(SASToken_DestroySigner_frees_the_signer)
+{
+    // arrange
+    SAS_SIGNER_HANDLE signer;
+    fill_short_key();
+    signer = create_test_signer(32);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    SASToken_DestroySigner(signer);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_SASTOKEN_99_010: [ If scope is NULL, SASToken_GetMaxTokenSize shall return 0. ]*/
+TEST_FUNCTION(SASToken_GetMaxTokenSize_with_NULL_scope_returns_0)
+{
+    // act
+    size_t size = SASToken_GetMaxTokenSize(NULL, "policy");
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 0, size);
+}
+
+/*Tests_SRS_SASTOKEN_99_011: [ Otherwise SASToken_GetMaxTokenSize shall return the size, including the terminating '\0', of the longest token SASToken_SignInto can produce for scope and keyName. ]*/
+TEST_FUNCTION(SASToken_GetMaxTokenSize_accounts_for_the_key_name)
+{
+    // act
+    size_t withoutKeyName = SASToken_GetMaxTokenSize(TEST_SIGNER_SCOPE, NULL);
+    size_t withEmptyKeyName = SASToken_GetMaxTokenSize(TEST_SIGNER_SCOPE, "");
+    size_t withKeyName = SASToken_GetMaxTokenSize(TEST_SIGNER_SCOPE, "policy");
+
+    // assert
+    ASSERT_IS_TRUE(withoutKeyName > strlen(TEST_SIGNER_TOKEN_NO_KEY_NAME));
+    ASSERT_ARE_EQUAL(size_t, withoutKeyName + strlen("&skn="), withEmptyKeyName);
+    ASSERT_ARE_EQUAL(size_t, withEmptyKeyName + strlen("policy"), withKeyName);
+}
+
+/*Tests_SRS_SASTOKEN_99_012: [ If signer, scope or destination is NULL, SASToken_SignInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(SASToken_SignInto_with_NULL_arguments_fails)
+{
+    // arrange
+    char token[256];
+    SAS_SIGNER_HANDLE signer;
+    fill_short_key();
+    signer = create_test_signer(32);
+    umock_c_reset_all_calls();
+
+    // act
+    int result1 = SASToken_SignInto(NULL, TEST_SIGNER_SCOPE, NULL, 1, token, sizeof(token));
+    int result2 = SASToken_SignInto(signer, NULL, NULL, 1, token, sizeof(token));
+    int result3 = SASToken_SignInto(signer, TEST_SIGNER_SCOPE, NULL, 1, NULL, sizeof(token));
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+    ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASToken_DestroySigner(signer);
+}
+
+/*Tests_SRS_SASTOKEN_99_013: [ If destinationSize is smaller than SASToken_GetMaxTokenSize(scope, keyName), SASToken_SignInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(SASToken_SignInto_with_too_small_destination_fails)
+{
+    // arrange
+    char token[256];
+    int result;
+    size_t size = SASToken_GetMaxTokenSize(TEST_SIGNER_SCOPE, "policy");
+    SAS_SIGNER_HANDLE signer;
+    fill_short_key();
+    signer = create_test_signer(32);
+    umock_c_reset_all_calls();
+    (void)memset(token, 'x', sizeof(token));
+
+    // act
+    result = SASToken_SignInto(signer, TEST_SIGNER_SCOPE, "policy", 1500000000, token, size - 1);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 'x', token[0]);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASToken_DestroySigner(signer);
+}
+
+/*Tests_SRS_SASTOKEN_99_014: [ SASToken_SignInto shall compute the HMAC-SHA256 of scope, "\n" and the decimal expiry, starting from copies of the signer's SHA-256 contexts. ]*/
+/*Tests_SRS_SASTOKEN_99_015: [ SASToken_SignInto shall write "SharedAccessSignature sr=", scope, "&sig=", the base64 and url encoded signature, "&se=", the decimal expiry and, if keyName is not NULL, "&skn=" and keyName, followed by a '\0', and return 0. ]*/
+TEST_FUNCTION(SASToken_SignInto_without_key_name_succeeds)
+{
+    // arrange
+    char token[256];
+    int result;
+    SAS_SIGNER_HANDLE signer;
+    fill_short_key();
+    signer = create_test_signer(32);
+    umock_c_reset_all_calls();
+
+    // act
+    result = SASToken_SignInto(signer, TEST_SIGNER_SCOPE, NULL, 1500000002, token, SASToken_GetMaxTokenSize(TEST_SIGNER_SCOPE, NULL));
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SIGNER_TOKEN_NO_KEY_NAME, token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    SASToken_DestroySigner(signer);
+}
+
+/*Tests_SRS_SASTOKEN_99_015: [ SASToken_SignInto shall write "SharedAccessSignature sr=", scope, "&sig=", the base64 and url encoded signature, "&se=", the decimal expiry and, if keyName is not NULL, "&skn=" and keyName, followed by a '\0', and return 0. ]*/
+TEST_FUNCTION(SASToken_SignInto_with_empty_key_name_and_0_expiry_succeeds)
+{
+    // arrange
+    char token[256];
+    int result;
+    SAS_SIGNER_HANDLE signer;
+    fill_short_key();
+    signer = create_test_signer(32);
+    umock_c_reset_all_calls();
+
+    // act
+    result = SASToken_SignInto(signer, TEST_SIGNER_SCOPE, "", 0, token, sizeof(token));
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SIGNER_TOKEN_EMPTY_KEY_NAME, token);
+
+    // cleanup
+    SASToken_DestroySigner(signer);
+}
+
+/*Tests_SRS_SASTOKEN_99_014: [ SASToken_SignInto shall compute the HMAC-SHA256 of scope, "\n" and the decimal expiry, starting from copies of the signer's SHA-256 contexts. ]*/
+TEST_FUNCTION(SASToken_SignInto_can_be_called_repeatedly)
+{
+    // arrange
+    char token[256];
+    int result1;
+    int result2;
+    SAS_SIGNER_HANDLE signer;
+    fill_short_key();
+    signer = create_test_signer(32);
+    umock_c_reset_all_calls();
+
+    // act
+    result1 = SASToken_SignInto(signer, TEST_SIGNER_SCOPE, "", 0, token, sizeof(token));
+    result2 = SASToken_SignInto(signer, TEST_SIGNER_SCOPE, NULL, 1500000002, token, sizeof(token));
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result1);
+    ASSERT_ARE_EQUAL(int, 0, result2);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SIGNER_TOKEN_NO_KEY_NAME, token);
+
+    // cleanup
+    SASToken_DestroySigner(signer);
+}
+
+/*Tests_SRS_SASTOKEN_99_004: [ A decoded key longer than the SHA-256 block size shall be replaced by its SHA-256 hash. ]*/
+TEST_FUNCTION(SASToken_SignInto_with_key_longer_than_a_block_succeeds)
+{
+    // arrange
+    char token[256];
+    int result;
+    SAS_SIGNER_HANDLE signer;
+    fill_long_key();
+    signer = create_test_signer(sizeof(g_decoded_key));
+    umock_c_reset_all_calls();
+
+    // act
+    result = SASToken_SignInto(signer, TEST_SIGNER_SCOPE, "policy", 1500000000, token, sizeof(token));
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SIGNER_TOKEN_LONG_KEY, token);
+
+    // cleanup
+    SASToken_DestroySigner(signer);
+}
+
+TEST_FUNCTION(SASToken_SignInto_with_empty_key_succeeds)
+{
+    // arrange
+    char token[256];
+    int result;
+    SAS_SIGNER_HANDLE signer;
+    signer = create_test_signer(0);
+    umock_c_reset_all_calls();
+
+    // act
+    result = SASToken_SignInto(signer, TEST_SIGNER_SCOPE, NULL, 1, token, sizeof(token));
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SIGNER_TOKEN_EMPTY_KEY, token);
+
+    // cleanup
+    SASToken_DestroySigner(signer);
+}
+
 END_TEST_SUITE(sastoken_unittests)
@@ -0,0 +1,134 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Hashes buffers of several sizes with SHA-1 and SHA-256, first with the portable C code and then with
+   the backend picked for this machine, reporting MB/s for each. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "azure_c_shared_utility/sha.h"
+
+#define DEFAULT_MEGABYTES 64
+#define MAX_BUFFER_SIZE (16 * 1024)
+
+typedef enum SHA_PERF_ALGORITHM_TAG
+{
+    SHA_PERF_SHA1,
+    SHA_PERF_SHA256
+} SHA_PERF_ALGORITHM;
+
+static const SHA_BACKEND portable_backend = { "portable", NULL, NULL };
+
+static const size_t buffer_sizes[] = { 64, 1024, MAX_BUFFER_SIZE };
+
+static unsigned char buffer[MAX_BUFFER_SIZE];
+
+static int hash_buffer(SHA_PERF_ALGORITHM algorithm, size_t size)
+{
+    int result;
+    uint8_t digest[USHAMaxHashSize];
+
+    if (algorithm == SHA_PERF_SHA1)
+    {
+        SHA1Context context;
+        result = ((SHA1Reset(&context) != shaSuccess) ||
+            (SHA1Input(&context, buffer, (unsigned int)size) != shaSuccess) ||
+            (SHA1Result(&context, digest) != shaSuccess)) ? __LINE__ : 0;
+    }
+    else
+    {
+        SHA256Context context;
+        result = ((SHA256Reset(&context) != shaSuccess) ||
+            (SHA256Input(&context, buffer, (unsigned int)size) != shaSuccess) ||
+            (SHA256Result(&context, digest) != shaSuccess)) ? __LINE__ : 0;
+    }
+
+    return result;
+}
+
+static int run_hash(SHA_PERF_ALGORITHM algorithm, size_t size, size_t megabytes)
+{
+    int result = 0;
+    size_t iterations = (megabytes * 1024 * 1024) / size;
+    clock_t start_time;
+    double seconds;
+    size_t i;
+
+    start_time = clock();
+    for (i = 0; i < iterations; i++)
+    {
+        if ((result = hash_buffer(algorithm, size)) != 0)
+        {
+            (void)printf("hashing failed at iteration %lu\r\n", (unsigned long)i);
+            break;
+        }
+    }
+    seconds = (double)(clock() - start_time) / CLOCKS_PER_SEC;
+    if (seconds <= 0.0)
+    {
+        seconds = 1.0 / CLOCKS_PER_SEC;
+    }
+
+    if (result == 0)
+    {
+        (void)printf("%-14s %-7s %6lu bytes: %8.1f MB/s\r\n", SHA_GetBackend()->name,
+            (algorithm == SHA_PERF_SHA1) ? "SHA-1" : "SHA-256", (unsigned long)size,
+            ((double)iterations * (double)size) / (1024.0 * 1024.0) / seconds);
+    }
+
+    return result;
+}
+
+static int run_backend(const SHA_BACKEND* backend, size_t megabytes)
+{
+    int result = 0;
+    size_t i;
+
+    (void)SHA_SetBackend(backend);
+
+    for (i = 0; (result == 0) && (i < sizeof(buffer_sizes) / sizeof(buffer_sizes[0])); i++)
+    {
+        result = run_hash(SHA_PERF_SHA1, buffer_sizes[i], megabytes);
+    }
+    for (i = 0; (result == 0) && (i < sizeof(buffer_sizes) / sizeof(buffer_sizes[0])); i++)
+    {
+        result = run_hash(SHA_PERF_SHA256, buffer_sizes[i], megabytes);
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    size_t megabytes = DEFAULT_MEGABYTES;
+    size_t i;
+
+    if (argc > 1)
+    {
+        megabytes = (size_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (megabytes == 0)
+    {
+        (void)printf("usage: sha_perf [megabytes per run]\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        for (i = 0; i < sizeof(buffer); i++)
+        {
+            buffer[i] = (unsigned char)(i * 131 + 7);
+        }
+
+        result = run_backend(&portable_backend, megabytes);
+        if (result == 0)
+        {
+            /* NULL selects the fastest backend available on this machine */
+            result = run_backend(NULL, megabytes);
+        }
+    }
+
+    return result;
+}
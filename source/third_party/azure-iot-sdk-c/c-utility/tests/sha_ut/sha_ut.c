@@ -0,0 +1,376 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "azure_c_shared_utility/sha.h"
+#include "azure_c_shared_utility/sha-private.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+/* FIPS 180-2 appendix A and B test vectors */
+static const char TEST_ABC[] = "abc";
+static const char TEST_448_BITS[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+static const uint8_t SHA1_ABC[SHA1HashSize] = {
+    0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+    0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d
+};
+static const uint8_t SHA1_448_BITS[SHA1HashSize] = {
+    0x84, 0x98, 0x3e, 0x44, 0x1c, 0x3b, 0xd2, 0x6e, 0xba, 0xae,
+    0x4a, 0xa1, 0xf9, 0x51, 0x29, 0xe5, 0xe5, 0x46, 0x70, 0xf1
+};
+static const uint8_t SHA1_MILLION_A[SHA1HashSize] = {
+    0x34, 0xaa, 0x97, 0x3c, 0xd4, 0xc4, 0xda, 0xa4, 0xf6, 0x1e,
+    0xeb, 0x2b, 0xdb, 0xad, 0x27, 0x31, 0x65, 0x34, 0x01, 0x6f
+};
+static const uint8_t SHA224_ABC[SHA224HashSize] = {
+    0x23, 0x09, 0x7d, 0x22, 0x34, 0x05, 0xd8, 0x22, 0x86, 0x42, 0xa4, 0x77, 0xbd, 0xa2,
+    0x55, 0xb3, 0x2a, 0xad, 0xbc, 0xe4, 0xbd, 0xa0, 0xb3, 0xf7, 0xe3, 0x6c, 0x9d, 0xa7
+};
+static const uint8_t SHA256_ABC[SHA256HashSize] = {
+    0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+    0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+};
+static const uint8_t SHA256_448_BITS[SHA256HashSize] = {
+    0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+    0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1
+};
+static const uint8_t SHA256_MILLION_A[SHA256HashSize] = {
+    0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+    0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+};
+
+#define TEST_MESSAGE_SIZE 1100
+
+static uint8_t test_message[TEST_MESSAGE_SIZE + 1];
+
+static size_t sha1_blocks_seen;
+static size_t sha256_blocks_seen;
+
+static void counting_sha1_process_blocks(uint32_t *Intermediate_Hash, const uint8_t *blocks, size_t block_count)
+{
+    sha1_blocks_seen += block_count;
+    SHA1ProcessBlocksPortable(Intermediate_Hash, blocks, block_count);
+}
+
+static void counting_sha256_process_blocks(uint32_t *Intermediate_Hash, const uint8_t *blocks, size_t block_count)
+{
+    sha256_blocks_seen += block_count;
+    SHA256ProcessBlocksPortable(Intermediate_Hash, blocks, block_count);
+}
+
+static const SHA_BACKEND portable_backend = { "test-portable", NULL, NULL };
+static const SHA_BACKEND counting_backend = { "test-counting", counting_sha1_process_blocks, counting_sha256_process_blocks };
+
+/* hashes length bytes starting at an odd offset, fed in chunks of odd sizes so every path of the Input functions runs */
+static void sha1_chunked(const uint8_t *message, size_t length, uint8_t digest[SHA1HashSize])
+{
+    SHA1Context context;
+    size_t chunk = 1;
+    size_t position = 0;
+
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA1Reset(&context));
+    while (position < length)
+    {
+        size_t this_chunk = (length - position < chunk) ? (length - position) : chunk;
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA1Input(&context, message + position, (unsigned int)this_chunk));
+        position += this_chunk;
+        chunk = (chunk * 7 + 3) % 150;
+    }
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA1Result(&context, digest));
+}
+
+static void sha256_chunked(const uint8_t *message, size_t length, uint8_t digest[SHA256HashSize])
+{
+    SHA256Context context;
+    size_t chunk = 1;
+    size_t position = 0;
+
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Reset(&context));
+    while (position < length)
+    {
+        size_t this_chunk = (length - position < chunk) ? (length - position) : chunk;
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Input(&context, message + position, (unsigned int)this_chunk));
+        position += this_chunk;
+        chunk = (chunk * 7 + 3) % 150;
+    }
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Result(&context, digest));
+}
+
+BEGIN_TEST_SUITE(sha_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    size_t i;
+
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    for (i = 0; i < sizeof(test_message); i++)
+    {
+        test_message[i] = (uint8_t)(i * 131 + 7);
+    }
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    sha1_blocks_seen = 0;
+    sha256_blocks_seen = 0;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    (void)SHA_SetBackend(NULL);
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* SHA_GetBackend */
+
+TEST_FUNCTION(SHA_GetBackend_returns_a_backend_with_a_name)
+{
+    // act
+    const SHA_BACKEND *backend = SHA_GetBackend();
+
+    // assert
+    ASSERT_IS_NOT_NULL(backend);
+    ASSERT_IS_NOT_NULL(backend->name);
+}
+
+/* SHA_SetBackend */
+
+TEST_FUNCTION(SHA_SetBackend_installs_the_backend)
+{
+    // act
+    int result = SHA_SetBackend(&counting_backend);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, shaSuccess, result);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)&counting_backend, (void*)SHA_GetBackend());
+}
+
+TEST_FUNCTION(SHA_SetBackend_with_NULL_restores_the_default_backend)
+{
+    // arrange
+    const SHA_BACKEND *default_backend = SHA_GetBackend();
+    (void)SHA_SetBackend(&counting_backend);
+
+    // act
+    int result = SHA_SetBackend(NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, shaSuccess, result);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)default_backend, (void*)SHA_GetBackend());
+}
+
+TEST_FUNCTION(SHA_installed_backend_processes_every_block)
+{
+    // arrange
+    uint8_t digest[SHA256HashSize];
+    (void)SHA_SetBackend(&counting_backend);
+
+    // act
+    sha1_chunked(test_message, 1000, digest);
+    sha256_chunked(test_message, 1000, digest);
+
+    // assert
+    /* 1000 bytes plus padding and length is 16 blocks */
+    ASSERT_ARE_EQUAL(size_t, 16, sha1_blocks_seen);
+    ASSERT_ARE_EQUAL(size_t, 16, sha256_blocks_seen);
+}
+
+TEST_FUNCTION(SHA_backend_with_NULL_entries_uses_the_portable_code)
+{
+    // arrange
+    uint8_t digest[SHA256HashSize];
+    (void)SHA_SetBackend(&portable_backend);
+
+    // act
+    sha1_chunked((const uint8_t*)TEST_ABC, sizeof(TEST_ABC) - 1, digest);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, memcmp(SHA1_ABC, digest, SHA1HashSize));
+
+    // act
+    sha256_chunked((const uint8_t*)TEST_ABC, sizeof(TEST_ABC) - 1, digest);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, memcmp(SHA256_ABC, digest, SHA256HashSize));
+}
+
+/* test vectors, run with the default backend */
+
+TEST_FUNCTION(SHA1_abc_produces_the_FIPS_180_digest)
+{
+    // arrange
+    uint8_t digest[SHA1HashSize];
+
+    // act
+    sha1_chunked((const uint8_t*)TEST_ABC, sizeof(TEST_ABC) - 1, digest);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, memcmp(SHA1_ABC, digest, SHA1HashSize));
+}
+
+TEST_FUNCTION(SHA1_448_bit_message_produces_the_FIPS_180_digest)
+{
+    // arrange
+    uint8_t digest[SHA1HashSize];
+
+    // act
+    sha1_chunked((const uint8_t*)TEST_448_BITS, sizeof(TEST_448_BITS) - 1, digest);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, memcmp(SHA1_448_BITS, digest, SHA1HashSize));
+}
+
+TEST_FUNCTION(SHA1_one_million_a_produces_the_FIPS_180_digest)
+{
+    // arrange
+    uint8_t a_block[1000];
+    uint8_t digest[SHA1HashSize];
+    SHA1Context context;
+    int i;
+    (void)memset(a_block, 'a', sizeof(a_block));
+
+    // act
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA1Reset(&context));
+    for (i = 0; i < 1000; i++)
+    {
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA1Input(&context, a_block, sizeof(a_block)));
+    }
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA1Result(&context, digest));
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, memcmp(SHA1_MILLION_A, digest, SHA1HashSize));
+}
+
+TEST_FUNCTION(SHA224_abc_produces_the_FIPS_180_digest)
+{
+    // arrange
+    uint8_t digest[SHA224HashSize];
+    SHA224Context context;
+
+    // act
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA224Reset(&context));
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA224Input(&context, (const uint8_t*)TEST_ABC, sizeof(TEST_ABC) - 1));
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA224Result(&context, digest));
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, memcmp(SHA224_ABC, digest, SHA224HashSize));
+}
+
+TEST_FUNCTION(SHA256_abc_produces_the_FIPS_180_digest)
+{
+    // arrange
+    uint8_t digest[SHA256HashSize];
+
+    // act
+    sha256_chunked((const uint8_t*)TEST_ABC, sizeof(TEST_ABC) - 1, digest);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, memcmp(SHA256_ABC, digest, SHA256HashSize));
+}
+
+TEST_FUNCTION(SHA256_448_bit_message_produces_the_FIPS_180_digest)
+{
+    // arrange
+    uint8_t digest[SHA256HashSize];
+
+    // act
+    sha256_chunked((const uint8_t*)TEST_448_BITS, sizeof(TEST_448_BITS) - 1, digest);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, memcmp(SHA256_448_BITS, digest, SHA256HashSize));
+}
+
+TEST_FUNCTION(SHA256_one_million_a_produces_the_FIPS_180_digest)
+{
+    // arrange
+    uint8_t a_block[1000];
+    uint8_t digest[SHA256HashSize];
+    SHA256Context context;
+    int i;
+    (void)memset(a_block, 'a', sizeof(a_block));
+
+    // act
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Reset(&context));
+    for (i = 0; i < 1000; i++)
+    {
+        ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Input(&context, a_block, sizeof(a_block)));
+    }
+    ASSERT_ARE_EQUAL(int, shaSuccess, SHA256Result(&context, digest));
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, memcmp(SHA256_MILLION_A, digest, SHA256HashSize));
+}
+
+/* the default backend against the portable code */
+
+TEST_FUNCTION(SHA1_default_backend_matches_portable_for_all_lengths)
+{
+    // arrange
+    size_t length;
+
+    for (length = 0; length <= TEST_MESSAGE_SIZE; length += 3)
+    {
+        uint8_t expected[SHA1HashSize];
+        uint8_t actual[SHA1HashSize];
+
+        (void)SHA_SetBackend(&portable_backend);
+        sha1_chunked(test_message + 1, length, expected);
+
+        // act
+        (void)SHA_SetBackend(NULL);
+        sha1_chunked(test_message + 1, length, actual);
+
+        // assert
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expected, actual, SHA1HashSize));
+    }
+}
+
+TEST_FUNCTION(SHA256_default_backend_matches_portable_for_all_lengths)
+{
+    // arrange
+    size_t length;
+
+    for (length = 0; length <= TEST_MESSAGE_SIZE; length += 3)
+    {
+        uint8_t expected[SHA256HashSize];
+        uint8_t actual[SHA256HashSize];
+
+        (void)SHA_SetBackend(&portable_backend);
+        sha256_chunked(test_message + 1, length, expected);
+
+        // act
+        (void)SHA_SetBackend(NULL);
+        sha256_chunked(test_message + 1, length, actual);
+
+        // assert
+        ASSERT_ARE_EQUAL(int, 0, memcmp(expected, actual, SHA256HashSize));
+    }
+}
+
+END_TEST_SUITE(sha_ut)
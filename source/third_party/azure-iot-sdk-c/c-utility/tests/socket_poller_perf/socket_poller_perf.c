@@ -0,0 +1,397 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Opens N socketio connections to a local listener and measures the CPU the process spends driving
+   them: first idle, then with the server writing to every connection. Idle is run three ways: calling
+   dowork on every instance in a tight loop, a loop issuing one recv per socket per round (the floor of
+   what socketio_dowork cost before the shared poller), and blocking in socket_poller_wait between rounds
+   the way an application with nothing else to do can. A last phase floods every connection with small
+   sends while the server drains them, and reports how many sendmsg calls each queued packet cost. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/socketio.h"
+#include "socket_poller.h"
+
+#define DEFAULT_CONNECTIONS 200
+#define PHASE_MS 2000
+#define OPEN_TIMEOUT_MS 10000
+#define WAIT_TIMEOUT_MS 10
+#define TRAFFIC_CHUNK_SIZE 512
+#define SEND_PACKET_SIZE 100
+#define SEND_PACKETS_PER_ROUND 64
+#define SEND_QUEUE_LIMIT (256 * 1024)
+
+typedef enum LOOP_MODE_TAG
+{
+    LOOP_MODE_DOWORK,
+    LOOP_MODE_DIRECT,
+    LOOP_MODE_WAIT
+} LOOP_MODE;
+
+typedef struct CONNECTION_TAG
+{
+    CONCRETE_IO_HANDLE io;
+    int server_socket;
+    bool is_open;
+    bool is_failed;
+} CONNECTION;
+
+static size_t bytes_received;
+static size_t packets_completed;
+
+static double now_ms(void)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1000000.0;
+}
+
+static double cpu_ms(void)
+{
+    struct rusage usage;
+    (void)getrusage(RUSAGE_SELF, &usage);
+    return (double)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000.0 +
+        (double)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000.0;
+}
+
+static void on_open_complete(void* context, IO_OPEN_RESULT open_result)
+{
+    CONNECTION* connection = (CONNECTION*)context;
+    connection->is_open = (open_result == IO_OPEN_OK);
+    connection->is_failed = (open_result != IO_OPEN_OK);
+}
+
+static void on_bytes_received(void* context, const unsigned char* buffer, size_t size)
+{
+    (void)context;
+    (void)buffer;
+    bytes_received += size;
+}
+
+static void on_send_complete(void* context, IO_SEND_RESULT send_result)
+{
+    (void)context;
+    if (send_result == IO_SEND_OK)
+    {
+        packets_completed++;
+    }
+}
+
+static void on_io_error(void* context)
+{
+    ((CONNECTION*)context)->is_failed = true;
+}
+
+static int set_non_blocking(int socket)
+{
+    int flags = fcntl(socket, F_GETFL, 0);
+    return ((flags == -1) || (fcntl(socket, F_SETFL, flags | O_NONBLOCK) == -1)) ? __LINE__ : 0;
+}
+
+static int start_listener(int* listen_socket, int* port)
+{
+    int result;
+    struct sockaddr_in address;
+    socklen_t address_length = sizeof(address);
+
+    (void)memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    if ((*listen_socket = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+    {
+        result = __LINE__;
+    }
+    else if ((bind(*listen_socket, (struct sockaddr*)&address, sizeof(address)) != 0) ||
+        (listen(*listen_socket, SOMAXCONN) != 0) ||
+        (getsockname(*listen_socket, (struct sockaddr*)&address, &address_length) != 0) ||
+        (set_non_blocking(*listen_socket) != 0))
+    {
+        (void)close(*listen_socket);
+        result = __LINE__;
+    }
+    else
+    {
+        *port = ntohs(address.sin_port);
+        result = 0;
+    }
+
+    return result;
+}
+
+/* opens every connection and accepts its server side; connects complete from dowork */
+static int open_connections(CONNECTION* connections, size_t count, int listen_socket, int port)
+{
+    int result = 0;
+    SOCKETIO_CONFIG config;
+    size_t accepted = 0;
+    size_t opened = 0;
+    double start_time = now_ms();
+    size_t i;
+
+    config.hostname = "127.0.0.1";
+    config.port = port;
+    config.accepted_socket = NULL;
+
+    for (i = 0; (result == 0) && (i < count); i++)
+    {
+        connections[i].server_socket = -1;
+        connections[i].is_open = false;
+        connections[i].is_failed = false;
+        if (((connections[i].io = socketio_create(&config)) == NULL) ||
+            (socketio_open(connections[i].io, on_open_complete, &connections[i], on_bytes_received, &connections[i], on_io_error, &connections[i]) != 0))
+        {
+            result = __LINE__;
+        }
+    }
+
+    while ((result == 0) && ((accepted < count) || (opened < count)))
+    {
+        int server_socket;
+
+        while ((accepted < count) && ((server_socket = accept(listen_socket, NULL, NULL)) >= 0))
+        {
+            (void)set_non_blocking(server_socket);
+            connections[accepted++].server_socket = server_socket;
+        }
+
+        opened = 0;
+        for (i = 0; i < count; i++)
+        {
+            socketio_dowork(connections[i].io);
+            if (connections[i].is_failed)
+            {
+                result = __LINE__;
+            }
+            else if (connections[i].is_open)
+            {
+                opened++;
+            }
+        }
+
+        if (now_ms() - start_time > OPEN_TIMEOUT_MS)
+        {
+            result = __LINE__;
+        }
+    }
+
+    return result;
+}
+
+static void close_connections(CONNECTION* connections, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        if (connections[i].io != NULL)
+        {
+            (void)socketio_close(connections[i].io, NULL, NULL);
+            socketio_destroy(connections[i].io);
+        }
+        if (connections[i].server_socket >= 0)
+        {
+            (void)close(connections[i].server_socket);
+        }
+    }
+}
+
+/* the recv every socketio_dowork issued before the shared poller, whether or not data had arrived;
+   the idle server sockets cost the same to read as the client ones */
+static void direct_round(CONNECTION* connections, size_t count)
+{
+    unsigned char buffer[64];
+    size_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        (void)recv(connections[i].server_socket, buffer, sizeof(buffer), 0);
+    }
+}
+
+static void run_phase(const char* load, LOOP_MODE mode, CONNECTION* connections, size_t count, bool with_traffic)
+{
+    static const unsigned char chunk[TRAFFIC_CHUNK_SIZE] = { 0 };
+    double start_time = now_ms();
+    double start_cpu = cpu_ms();
+    double next_send_time = start_time;
+    double elapsed;
+    size_t rounds = 0;
+    size_t i;
+
+    bytes_received = 0;
+    do
+    {
+        if (with_traffic)
+        {
+            /* one chunk per connection per millisecond at most, so every mode sees the same offered load */
+            double now = now_ms();
+            if (now >= next_send_time)
+            {
+                for (i = 0; i < count; i++)
+                {
+                    (void)send(connections[i].server_socket, chunk, sizeof(chunk), 0);
+                }
+                next_send_time = now + 1.0;
+            }
+        }
+
+        switch (mode)
+        {
+        case LOOP_MODE_WAIT:
+            (void)socket_poller_wait(with_traffic ? 1 : WAIT_TIMEOUT_MS);
+            /* fall through */
+        case LOOP_MODE_DOWORK:
+            for (i = 0; i < count; i++)
+            {
+                socketio_dowork(connections[i].io);
+            }
+            break;
+        case LOOP_MODE_DIRECT:
+            direct_round(connections, count);
+            break;
+        }
+
+        rounds++;
+        elapsed = now_ms() - start_time;
+    } while (elapsed < PHASE_MS);
+
+    (void)printf("%-8s %-22s %6lu rounds, %8.2f us CPU per round, %5.1f%% CPU, %8.2f MB/s received\r\n",
+        load,
+        (mode == LOOP_MODE_DOWORK) ? "dowork (shared poller)" : (mode == LOOP_MODE_DIRECT) ? "recv per socket" : "socket_poller_wait",
+        (unsigned long)rounds, (cpu_ms() - start_cpu) * 1000.0 / (double)rounds, (cpu_ms() - start_cpu) * 100.0 / elapsed,
+        (double)bytes_received / 1048576.0 / (elapsed / 1000.0));
+}
+
+/* each round the server drains a quarter of what every connection sends, so once the socket buffers are full
+   sends back up into the ring; a connection stops sending while its queue is over the limit */
+static void run_send_phase(CONNECTION* connections, size_t count)
+{
+    static const unsigned char packet[SEND_PACKET_SIZE] = { 0 };
+    unsigned char drain[SEND_PACKET_SIZE * SEND_PACKETS_PER_ROUND / 4];
+    SOCKETIO_SEND_STATISTICS totals;
+    double start_time = now_ms();
+    double elapsed;
+    size_t packets_sent = 0;
+    size_t i;
+    size_t j;
+
+    (void)memset(&totals, 0, sizeof(totals));
+    packets_completed = 0;
+    do
+    {
+        for (i = 0; i < count; i++)
+        {
+            SOCKETIO_SEND_STATISTICS statistics;
+            for (j = 0; (j < SEND_PACKETS_PER_ROUND) &&
+                (socketio_get_send_statistics(connections[i].io, &statistics) == 0) && (statistics.queued_bytes < SEND_QUEUE_LIMIT); j++)
+            {
+                if (socketio_send(connections[i].io, packet, sizeof(packet), on_send_complete, NULL) == 0)
+                {
+                    packets_sent++;
+                }
+            }
+            (void)recv(connections[i].server_socket, drain, sizeof(drain), 0);
+            socketio_dowork(connections[i].io);
+        }
+
+        elapsed = now_ms() - start_time;
+    } while (elapsed < PHASE_MS);
+
+    for (i = 0; i < count; i++)
+    {
+        SOCKETIO_SEND_STATISTICS statistics;
+        if (socketio_get_send_statistics(connections[i].io, &statistics) == 0)
+        {
+            totals.packets_queued += statistics.packets_queued;
+            totals.packets_flushed += statistics.packets_flushed;
+            totals.flush_calls += statistics.flush_calls;
+            if (statistics.peak_queued_bytes > totals.peak_queued_bytes)
+            {
+                totals.peak_queued_bytes = statistics.peak_queued_bytes;
+            }
+        }
+    }
+
+    (void)printf("send     %lu packets sent, %lu completed, %lu queued, %lu flushed in %lu calls (%.3f calls per packet), peak queue %lu bytes\r\n",
+        (unsigned long)packets_sent, (unsigned long)packets_completed, (unsigned long)totals.packets_queued,
+        (unsigned long)totals.packets_flushed, (unsigned long)totals.flush_calls,
+        (totals.packets_flushed == 0) ? 0.0 : (double)totals.flush_calls / (double)totals.packets_flushed,
+        (unsigned long)totals.peak_queued_bytes);
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    size_t count = DEFAULT_CONNECTIONS;
+
+    if (argc > 1)
+    {
+        count = (size_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (count == 0)
+    {
+        (void)printf("usage: socket_poller_perf [connections]\r\n");
+        result = __LINE__;
+    }
+    else if (platform_init() != 0)
+    {
+        (void)printf("platform_init failed\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        CONNECTION* connections = (CONNECTION*)calloc(count, sizeof(CONNECTION));
+        int listen_socket;
+        int port;
+
+        if (connections == NULL)
+        {
+            (void)printf("setup failed\r\n");
+            result = __LINE__;
+        }
+        else if ((result = start_listener(&listen_socket, &port)) != 0)
+        {
+            (void)printf("starting the listener failed\r\n");
+        }
+        else
+        {
+            if ((result = open_connections(connections, count, listen_socket, port)) != 0)
+            {
+                (void)printf("opening %lu connections failed\r\n", (unsigned long)count);
+            }
+            else
+            {
+                (void)printf("%lu loopback connections, %d ms per phase\r\n", (unsigned long)count, PHASE_MS);
+                run_phase("idle", LOOP_MODE_DOWORK, connections, count, false);
+                run_phase("idle", LOOP_MODE_DIRECT, connections, count, false);
+                run_phase("idle", LOOP_MODE_WAIT, connections, count, false);
+                run_phase("traffic", LOOP_MODE_DOWORK, connections, count, true);
+                run_phase("traffic", LOOP_MODE_WAIT, connections, count, true);
+                run_send_phase(connections, count);
+            }
+
+            close_connections(connections, count);
+            (void)close(listen_socket);
+        }
+
+        free(connections);
+        platform_deinit();
+    }
+
+    return result;
+}
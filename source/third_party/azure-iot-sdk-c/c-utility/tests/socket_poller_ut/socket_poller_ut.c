@@ -0,0 +1,561 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#define _DEFAULT_SOURCE
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstdint>
+#else
+#include <stdlib.h>
+#include <stdint.h>
+#endif
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+
+void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#undef ENABLE_MOCKS
+
+#include "socket_poller.h"
+
+#define TEST_LOCK_HANDLE (LOCK_HANDLE)0x4242
+#define TEST_INIT_THREADS 4
+
+static size_t lock_init_calls;
+static useconds_t lock_init_delay_us;
+
+static LOCK_HANDLE my_Lock_Init(void)
+{
+    lock_init_calls++;
+    if (lock_init_delay_us > 0)
+    {
+        /* widens the window in which other threads run socket_poller_init */
+        (void)usleep(lock_init_delay_us);
+    }
+    return TEST_LOCK_HANDLE;
+}
+
+static void* init_poller_thread(void* arg)
+{
+    *(int*)arg = socket_poller_init();
+    return NULL;
+}
+
+/* the poller is exercised against a real, non-blocking socket pair */
+static int test_sockets[2];
+
+static void create_test_sockets(void)
+{
+    int i;
+
+    ASSERT_ARE_EQUAL(int, 0, socketpair(AF_UNIX, SOCK_STREAM, 0, test_sockets));
+    for (i = 0; i < 2; i++)
+    {
+        int flags = fcntl(test_sockets[i], F_GETFL, 0);
+        ASSERT_ARE_EQUAL(int, 0, fcntl(test_sockets[i], F_SETFL, flags | O_NONBLOCK));
+    }
+}
+
+static void close_test_sockets(void)
+{
+    (void)close(test_sockets[0]);
+    (void)close(test_sockets[1]);
+}
+
+static void drain(int socket)
+{
+    unsigned char buffer[64];
+    while (read(socket, buffer, sizeof(buffer)) > 0)
+    {
+    }
+}
+
+IMPLEMENT_UMOCK_C_ENUM_TYPE(LOCK_RESULT, LOCK_RESULT_VALUES);
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+BEGIN_TEST_SUITE(socket_poller_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_TYPE(LOCK_RESULT, LOCK_RESULT);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_HOOK(Lock_Init, my_Lock_Init);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Deinit, LOCK_OK);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    umock_c_reset_all_calls();
+    lock_init_calls = 0;
+    lock_init_delay_us = 0;
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_001: [ socket_poller_init shall create the lock guarding the poller and the OS wait object. ]*/
+/* Tests_SRS_SOCKET_POLLER_99_002: [ If the poller is already initialized, socket_poller_init shall only count the call and return 0. ]*/
+/* Tests_SRS_SOCKET_POLLER_99_004: [ The socket_poller_deinit call matching the first socket_poller_init shall free every registration, the OS wait object and the lock. ]*/
+TEST_FUNCTION(socket_poller_init_creates_the_lock_once)
+{
+    ///arrange
+    int result1;
+    int result2;
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    ///act
+    result1 = socket_poller_init();
+    result2 = socket_poller_init();
+    socket_poller_deinit();
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result1);
+    ASSERT_ARE_EQUAL(int, 0, result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    socket_poller_deinit();
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_006: [ socket_poller_init and socket_poller_deinit shall be serialized so that concurrent calls create the lock and the OS wait object only once. ]*/
+TEST_FUNCTION(concurrent_socket_poller_init_creates_the_lock_once)
+{
+    ///arrange
+    pthread_t threads[TEST_INIT_THREADS];
+    int results[TEST_INIT_THREADS];
+    size_t i;
+    lock_init_delay_us = 50000;
+
+    ///act
+    for (i = 0; i < TEST_INIT_THREADS; i++)
+    {
+        results[i] = -1;
+        ASSERT_ARE_EQUAL(int, 0, pthread_create(&threads[i], NULL, init_poller_thread, &results[i]));
+    }
+    for (i = 0; i < TEST_INIT_THREADS; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, pthread_join(threads[i], NULL));
+    }
+
+    ///assert
+    ASSERT_ARE_EQUAL(size_t, 1, lock_init_calls);
+    for (i = 0; i < TEST_INIT_THREADS; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, results[i]);
+    }
+
+    umock_c_reset_all_calls();
+    for (i = 0; i < TEST_INIT_THREADS - 1; i++)
+    {
+        socket_poller_deinit();
+    }
+    ASSERT_ARE_EQUAL(char_ptr, "", umock_c_get_actual_calls());
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    socket_poller_deinit();
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_003: [ On any failure, socket_poller_init shall log an error and return a non-zero value. ]*/
+TEST_FUNCTION(when_Lock_Init_fails_socket_poller_init_fails)
+{
+    ///arrange
+    int result;
+    STRICT_EXPECTED_CALL(Lock_Init()).SetReturn(NULL);
+
+    ///act
+    result = socket_poller_init();
+
+    ///assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_NULL(socket_poller_add(0));
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_005: [ If the poller is not initialized, socket_poller_deinit shall do nothing. ]*/
+TEST_FUNCTION(socket_poller_deinit_when_not_initialized_does_nothing)
+{
+    ///act
+    socket_poller_deinit();
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_012: [ If socket is negative, socket_poller_add shall log an error and return NULL. ]*/
+TEST_FUNCTION(socket_poller_add_with_negative_socket_fails)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE result;
+    ASSERT_ARE_EQUAL(int, 0, socket_poller_init());
+    umock_c_reset_all_calls();
+
+    ///act
+    result = socket_poller_add(-1);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socket_poller_deinit();
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_013: [ If the poller is not initialized, socket_poller_add shall return NULL. ]*/
+TEST_FUNCTION(socket_poller_add_when_not_initialized_fails)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE result;
+    create_test_sockets();
+
+    ///act
+    result = socket_poller_add(test_sockets[0]);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+
+    ///cleanup
+    close_test_sockets();
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_014: [ On any failure, socket_poller_add shall log an error and return NULL. ]*/
+TEST_FUNCTION(when_allocating_the_registration_fails_socket_poller_add_fails)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE result;
+    create_test_sockets();
+    ASSERT_ARE_EQUAL(int, 0, socket_poller_init());
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)).SetReturn(NULL);
+
+    ///act
+    result = socket_poller_add(test_sockets[0]);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socket_poller_deinit();
+    close_test_sockets();
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_014: [ On any failure, socket_poller_add shall log an error and return NULL. ]*/
+TEST_FUNCTION(when_growing_the_slot_table_fails_socket_poller_add_fails)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE result;
+    create_test_sockets();
+    ASSERT_ARE_EQUAL(int, 0, socket_poller_init());
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    result = socket_poller_add(test_sockets[0]);
+
+    ///assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    socket_poller_deinit();
+    close_test_sockets();
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_010: [ A new registration shall have no readiness until the next wait reports it. ]*/
+/* Tests_SRS_SOCKET_POLLER_99_031: [ If the registration has already read the results of the latest wait, socket_poller_get_events shall first wait with a zero timeout. ]*/
+/* Tests_SRS_SOCKET_POLLER_99_032: [ socket_poller_get_events shall return the readiness recorded for the socket. ]*/
+TEST_FUNCTION(socket_poller_get_events_reports_an_idle_socket_as_writable)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE registration;
+    unsigned int events;
+    create_test_sockets();
+    ASSERT_ARE_EQUAL(int, 0, socket_poller_init());
+    registration = socket_poller_add(test_sockets[0]);
+    ASSERT_IS_NOT_NULL(registration);
+
+    ///act
+    events = socket_poller_get_events(registration);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, SOCKET_POLLER_WRITABLE, (int)events);
+
+    ///cleanup
+    socket_poller_remove(registration);
+    socket_poller_deinit();
+    close_test_sockets();
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_032: [ socket_poller_get_events shall return the readiness recorded for the socket. ]*/
+/* Tests_SRS_SOCKET_POLLER_99_041: [ socket_poller_clear_events shall clear the given readiness, except for edges reported since the owner last read its events. ]*/
+TEST_FUNCTION(socket_poller_reports_readable_until_the_owner_clears_it)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE registration;
+    unsigned int events_after_write;
+    unsigned int events_before_clear;
+    unsigned int events_after_clear;
+    create_test_sockets();
+    ASSERT_ARE_EQUAL(int, 0, socket_poller_init());
+    registration = socket_poller_add(test_sockets[0]);
+    ASSERT_IS_NOT_NULL(registration);
+    (void)socket_poller_get_events(registration);
+    ASSERT_ARE_EQUAL(int, 1, (int)write(test_sockets[1], "x", 1));
+
+    ///act
+    events_after_write = socket_poller_get_events(registration);
+    events_before_clear = socket_poller_get_events(registration);
+    drain(test_sockets[0]);
+    socket_poller_clear_events(registration, SOCKET_POLLER_READABLE);
+    events_after_clear = socket_poller_get_events(registration);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, SOCKET_POLLER_READABLE | SOCKET_POLLER_WRITABLE, (int)events_after_write);
+    ASSERT_ARE_EQUAL(int, SOCKET_POLLER_READABLE | SOCKET_POLLER_WRITABLE, (int)events_before_clear);
+    ASSERT_ARE_EQUAL(int, SOCKET_POLLER_WRITABLE, (int)events_after_clear);
+
+    ///cleanup
+    socket_poller_remove(registration);
+    socket_poller_deinit();
+    close_test_sockets();
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_041: [ socket_poller_clear_events shall clear the given readiness, except for edges reported since the owner last read its events. ]*/
+TEST_FUNCTION(socket_poller_clear_events_keeps_an_edge_reported_after_the_owner_read_its_events)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE registration;
+    unsigned int events;
+    create_test_sockets();
+    ASSERT_ARE_EQUAL(int, 0, socket_poller_init());
+    registration = socket_poller_add(test_sockets[0]);
+    ASSERT_IS_NOT_NULL(registration);
+    (void)socket_poller_get_events(registration);
+    ASSERT_ARE_EQUAL(int, 1, (int)write(test_sockets[1], "x", 1));
+    ASSERT_ARE_EQUAL(int, 1, socket_poller_wait(0));
+
+    ///act
+    socket_poller_clear_events(registration, SOCKET_POLLER_READABLE);
+    events = socket_poller_get_events(registration);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, SOCKET_POLLER_READABLE, (int)(events & SOCKET_POLLER_READABLE));
+
+    ///cleanup
+    socket_poller_remove(registration);
+    socket_poller_deinit();
+    close_test_sockets();
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_022: [ Errors and hang-ups shall be reported as both readable and writable so that the owner's next send or recv surfaces them. ]*/
+TEST_FUNCTION(socket_poller_reports_a_hang_up_as_readable_and_writable)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE registration;
+    unsigned int events;
+    create_test_sockets();
+    ASSERT_ARE_EQUAL(int, 0, socket_poller_init());
+    registration = socket_poller_add(test_sockets[0]);
+    ASSERT_IS_NOT_NULL(registration);
+    (void)socket_poller_get_events(registration);
+    socket_poller_clear_events(registration, SOCKET_POLLER_WRITABLE);
+    (void)close(test_sockets[1]);
+
+    ///act
+    events = socket_poller_get_events(registration);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, SOCKET_POLLER_READABLE | SOCKET_POLLER_WRITABLE, (int)events);
+
+    ///cleanup
+    socket_poller_remove(registration);
+    socket_poller_deinit();
+    (void)close(test_sockets[0]);
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_015: [ socket_poller_add shall take a free slot, growing the slot table when none is left. ]*/
+/* Tests_SRS_SOCKET_POLLER_99_021: [ socket_poller_remove shall stop watching the socket and free the registration. ]*/
+TEST_FUNCTION(socket_poller_tracks_more_sockets_than_the_initial_slot_table)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE registrations[20];
+    int pairs[20][2];
+    size_t i;
+    ASSERT_ARE_EQUAL(int, 0, socket_poller_init());
+    for (i = 0; i < 20; i++)
+    {
+        ASSERT_ARE_EQUAL(int, 0, socketpair(AF_UNIX, SOCK_STREAM, 0, pairs[i]));
+        registrations[i] = socket_poller_add(pairs[i][0]);
+        ASSERT_IS_NOT_NULL(registrations[i]);
+    }
+
+    ///act
+    for (i = 0; i < 20; i++)
+    {
+        ASSERT_ARE_EQUAL(int, SOCKET_POLLER_WRITABLE, (int)socket_poller_get_events(registrations[i]));
+        socket_poller_clear_events(registrations[i], SOCKET_POLLER_WRITABLE);
+    }
+    ASSERT_ARE_EQUAL(int, 1, (int)write(pairs[17][1], "x", 1));
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 1, socket_poller_wait(1000));
+    ASSERT_ARE_EQUAL(int, SOCKET_POLLER_READABLE, (int)(socket_poller_get_events(registrations[17]) & SOCKET_POLLER_READABLE));
+    ASSERT_ARE_EQUAL(int, 0, (int)socket_poller_get_events(registrations[3]));
+
+    ///cleanup
+    for (i = 0; i < 20; i++)
+    {
+        socket_poller_remove(registrations[i]);
+        (void)close(pairs[i][0]);
+        (void)close(pairs[i][1]);
+    }
+    socket_poller_deinit();
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_020: [ If registration is NULL, socket_poller_remove shall log an error and do nothing. ]*/
+TEST_FUNCTION(socket_poller_remove_with_NULL_registration_does_nothing)
+{
+    ///act
+    socket_poller_remove(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_030: [ If registration is NULL, socket_poller_get_events shall log an error and return 0. ]*/
+TEST_FUNCTION(socket_poller_get_events_with_NULL_registration_returns_0)
+{
+    ///act
+    unsigned int result = socket_poller_get_events(NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, (int)result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_040: [ If registration is NULL, socket_poller_clear_events shall log an error and do nothing. ]*/
+TEST_FUNCTION(socket_poller_clear_events_with_NULL_registration_does_nothing)
+{
+    ///act
+    socket_poller_clear_events(NULL, SOCKET_POLLER_READABLE);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_050: [ If the poller is not initialized, socket_poller_wait shall log an error and return -1. ]*/
+TEST_FUNCTION(socket_poller_wait_when_not_initialized_fails)
+{
+    ///act
+    int result = socket_poller_wait(0);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, -1, result);
+}
+
+/* Tests_SRS_SOCKET_POLLER_99_051: [ socket_poller_wait shall wait up to timeout_ms for any registered socket and return how many became ready. ]*/
+TEST_FUNCTION(socket_poller_wait_times_out_when_no_socket_is_ready)
+{
+    ///arrange
+    SOCKET_POLLER_REGISTRATION_HANDLE registration;
+    int result;
+    create_test_sockets();
+    ASSERT_ARE_EQUAL(int, 0, socket_poller_init());
+    registration = socket_poller_add(test_sockets[0]);
+    ASSERT_IS_NOT_NULL(registration);
+    (void)socket_poller_get_events(registration);
+    socket_poller_clear_events(registration, SOCKET_POLLER_WRITABLE);
+
+    ///act
+    result = socket_poller_wait(10);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, (int)socket_poller_get_events(registration));
+
+    ///cleanup
+    socket_poller_remove(registration);
+    socket_poller_deinit();
+    close_test_sockets();
+}
+
+END_TEST_SUITE(socket_poller_ut)
@@ -2,665 +2,1177 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #else
+#include <stdlib.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
 #endif
 
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/uio.h>
+#include <netdb.h>
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
 #include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+#include "azure_c_shared_utility/macro_utils.h"
 
 #define ENABLE_MOCKS
-
-#include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/dns_cache.h"
+#include "dns_async.h"
+#include "socket_poller.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    MOCKABLE_FUNCTION(, int, socket, int, af, int, type, int, protocol);
+    MOCKABLE_FUNCTION(, int, connect, int, sockfd, const struct sockaddr*, addr, socklen_t, addrlen);
+    MOCKABLE_FUNCTION(, int, select, int, nfds, fd_set*, readfds, fd_set*, writefds, fd_set*, exceptfds, struct timeval*, timeout);
+    MOCKABLE_FUNCTION(, int, getsockopt, int, sockfd, int, level, int, optname, void*, optval, socklen_t*, optlen);
+    MOCKABLE_FUNCTION(, int, setsockopt, int, sockfd, int, level, int, optname, const void*, optval, socklen_t, optlen);
+    MOCKABLE_FUNCTION(, ssize_t, send, int, sockfd, const void*, buf, size_t, len, int, flags);
+    MOCKABLE_FUNCTION(, ssize_t, sendmsg, int, sockfd, const struct msghdr*, msg, int, flags);
+    MOCKABLE_FUNCTION(, ssize_t, recv, int, sockfd, void*, buf, size_t, len, int, flags);
+    MOCKABLE_FUNCTION(, int, shutdown, int, sockfd, int, how);
+    MOCKABLE_FUNCTION(, int, close, int, sockfd);
+#ifdef __cplusplus
+}
+#endif
 
 #undef ENABLE_MOCKS
 
 #include "azure_c_shared_utility/socketio.h"
 
-#include <sys/types.h>
-#include <sys/socket.h>
-#include <netdb.h>
+// A non-tested function from fcntl.h
+int fcntl(int fd, int cmd, ... /* arg */) { (void)fd; (void)cmd; return 0; }
 
-TEST_MUTEX_HANDLE test_serialize_mutex;
+#define TEST_SOCKET 42
+#define TEST_WIRE_SIZE 256
+#define TEST_HOSTNAME "test.azure-devices.net"
+#define TEST_PORT 8883
+#define TEST_IPV4 0x0100007F
 
-BEGIN_TEST_SUITE(socketio_berkeley_unittests)
+static DNS_ASYNC_HANDLE TEST_DNS = (DNS_ASYNC_HANDLE)0x0101;
+static SOCKET_POLLER_REGISTRATION_HANDLE TEST_REGISTRATION = (SOCKET_POLLER_REGISTRATION_HANDLE)0x0102;
+
+static int g_accepted_socket = TEST_SOCKET;
 
-#if 0
+/* what the socket buffer still takes; once it is full send and sendmsg fail with EAGAIN */
+static size_t g_socket_space;
+static unsigned char g_wire[TEST_WIRE_SIZE];
+static size_t g_wire_length;
 
-// SOCKETIO_SETOPTION TESTS WERE WORKING BEFORE SWITCH TO umock_c...need to finish the conversion
+static size_t write_to_wire(const void* buf, size_t len)
+{
+    size_t written = (len < g_socket_space) ? len : g_socket_space;
+    (void)memcpy(g_wire + g_wire_length, buf, written);
+    g_wire_length += written;
+    g_socket_space -= written;
+    return written;
+}
 
-// socketio_setoption tests
+static ssize_t my_send(int sockfd, const void* buf, size_t len, int flags)
+{
+    ssize_t result;
+    (void)sockfd;
+    (void)flags;
+    if (g_socket_space == 0)
+    {
+        errno = EAGAIN;
+        result = -1;
+    }
+    else
+    {
+        result = (ssize_t)write_to_wire(buf, len);
+    }
+    return result;
+}
+
+static ssize_t my_sendmsg(int sockfd, const struct msghdr* msg, int flags)
+{
+    ssize_t result;
+    (void)sockfd;
+    (void)flags;
+    if (g_socket_space == 0)
+    {
+        errno = EAGAIN;
+        result = -1;
+    }
+    else
+    {
+        size_t i;
+        result = 0;
+        for (i = 0; i < (size_t)msg->msg_iovlen; i++)
+        {
+            result += (ssize_t)write_to_wire(msg->msg_iov[i].iov_base, msg->msg_iov[i].iov_len);
+        }
+    }
+    return result;
+}
+
+static ssize_t my_recv(int sockfd, void* buf, size_t len, int flags)
+{
+    (void)sockfd;
+    (void)buf;
+    (void)len;
+    (void)flags;
+    errno = EAGAIN;
+    return -1;
+}
 
-static CONCRETE_IO_HANDLE setup_socket()
+/* a non-blocking connect only gets started */
+static int my_connect(int sockfd, const struct sockaddr* addr, socklen_t addrlen)
 {
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
-    int result = socketio_open(ioHandle, test_on_io_open_complete, &callbackContext,
-        test_on_bytes_received, &callbackContext, test_on_io_error, &callbackContext);
+    (void)sockfd;
+    (void)addr;
+    (void)addrlen;
+    errno = EINPROGRESS;
+    return -1;
+}
+
+static int g_so_error;
+
+static int my_getsockopt(int sockfd, int level, int optname, void* optval, socklen_t* optlen)
+{
+    (void)sockfd;
+    (void)level;
+    (void)optname;
+    (void)optlen;
+    *(int*)optval = g_so_error;
+    return 0;
+}
+
+/* NULL leaves the instance without a registration, so dowork tries send and recv every time */
+static SOCKET_POLLER_REGISTRATION_HANDLE g_poller_registration;
+
+static SOCKET_POLLER_REGISTRATION_HANDLE my_socket_poller_add(int socket)
+{
+    (void)socket;
+    return g_poller_registration;
+}
+
+MOCK_FUNCTION_WITH_CODE(, void, test_on_io_open_complete, void*, context, IO_OPEN_RESULT, open_result)
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_bytes_received, void*, context, const unsigned char*, buffer, size_t, size)
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_io_error, void*, context)
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_io_close_complete, void*, context)
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_send_complete, void*, context, IO_SEND_RESULT, send_result)
+MOCK_FUNCTION_END()
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static CONCRETE_IO_HANDLE create_accepted_socketio(void)
+{
+    SOCKETIO_CONFIG socket_io_config = { NULL, 0, &g_accepted_socket };
+    CONCRETE_IO_HANDLE result = socketio_create(&socket_io_config);
+    (void)socketio_open(result, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+    umock_c_reset_all_calls();
+    return result;
+}
+
+/* opens by hostname; the address is not cached, so the open waits for the lookup */
+static CONCRETE_IO_HANDLE create_resolving_socketio(void)
+{
+    SOCKETIO_CONFIG socket_io_config = { TEST_HOSTNAME, TEST_PORT, NULL };
+    CONCRETE_IO_HANDLE result = socketio_create(&socket_io_config);
+    (void)socketio_open(result, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+    umock_c_reset_all_calls();
+    return result;
+}
+
+/* resolves and leaves the connect in progress */
+static CONCRETE_IO_HANDLE create_connecting_socketio(void)
+{
+    CONCRETE_IO_HANDLE result = create_resolving_socketio();
+    STRICT_EXPECTED_CALL(dns_async_is_lookup_complete(TEST_DNS))
+        .SetReturn(true);
+    STRICT_EXPECTED_CALL(dns_async_get_ipv4(TEST_DNS))
+        .SetReturn(TEST_IPV4);
+    socketio_dowork(result);
+    umock_c_reset_all_calls();
+    return result;
+}
+
+/* queues two packets behind a full socket buffer */
+static CONCRETE_IO_HANDLE create_socketio_with_two_queued_packets(void)
+{
+    CONCRETE_IO_HANDLE result = create_accepted_socketio();
+    g_socket_space = 0;
+    (void)socketio_send(result, "abcd", 4, test_on_send_complete, (void*)0x01);
+    (void)socketio_send(result, "efgh", 4, test_on_send_complete, (void*)0x02);
+    umock_c_reset_all_calls();
+    return result;
+}
+
+BEGIN_TEST_SUITE(socketio_berkeley_unittests)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+    size_t type_size;
+
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
     ASSERT_ARE_EQUAL(int, 0, result);
-    return ioHandle;
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // Unnatural type_size variable exists to avoid "conditional expression is constant" warning
+    type_size = sizeof(ssize_t);
+    if (type_size == sizeof(int32_t))
+    {
+        REGISTER_UMOCK_ALIAS_TYPE(ssize_t, int32_t);
+    }
+    else
+    {
+        REGISTER_UMOCK_ALIAS_TYPE(ssize_t, int64_t);
+    }
+    REGISTER_UMOCK_ALIAS_TYPE(socklen_t, uint32_t);
+    REGISTER_UMOCK_ALIAS_TYPE(socklen_t*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const struct sockaddr*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const struct msghdr*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(fd_set*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(struct timeval*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(time_t, long);
+    REGISTER_UMOCK_ALIAS_TYPE(time_t*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(DNS_ASYNC_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(DNS_ASYNC_OPTIONS*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SOCKET_POLLER_REGISTRATION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(OPTIONHANDLER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IO_OPEN_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IO_SEND_RESULT, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_RETURN(socket, TEST_SOCKET);
+    REGISTER_GLOBAL_MOCK_HOOK(send, my_send);
+    REGISTER_GLOBAL_MOCK_HOOK(sendmsg, my_sendmsg);
+    REGISTER_GLOBAL_MOCK_HOOK(recv, my_recv);
+    REGISTER_GLOBAL_MOCK_HOOK(connect, my_connect);
+    REGISTER_GLOBAL_MOCK_HOOK(getsockopt, my_getsockopt);
+    REGISTER_GLOBAL_MOCK_RETURN(dns_cache_get_ipv4, 1);
+    REGISTER_GLOBAL_MOCK_RETURN(dns_async_create, TEST_DNS);
+    REGISTER_GLOBAL_MOCK_HOOK(socket_poller_add, my_socket_poller_add);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    g_socket_space = TEST_WIRE_SIZE;
+    g_wire_length = 0;
+    g_so_error = 0;
+    g_poller_registration = NULL;
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
 }
 
-static void verify_mocks_and_destroy_socket(CONCRETE_IO_HANDLE ioHandle)
+/* socketio_send */
+
+TEST_FUNCTION(socketio_send_completes_a_packet_the_socket_takes_at_once)
 {
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socketio();
+
+    STRICT_EXPECTED_CALL(send(TEST_SOCKET, IGNORED_PTR_ARG, 4, 0));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x01, IO_SEND_OK));
+
+    // act
+    int result = socketio_send(socket_io, "abcd", 4, test_on_send_complete, (void*)0x01);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-    socketio_destroy(ioHandle);
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_setoption_fails_when_handle_is_null)
+TEST_FUNCTION(socketio_send_queues_the_rest_of_a_partial_send)
 {
     // arrange
-    int irrelevant = 1;
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socketio();
+    SOCKETIO_SEND_STATISTICS statistics;
+    g_socket_space = 3;
+
+    STRICT_EXPECTED_CALL(send(TEST_SOCKET, IGNORED_PTR_ARG, 6, 0));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
 
     // act
-    int result = socketio_setoption(NULL, "tcp_keepalive", &irrelevant);
+    int result = socketio_send(socket_io, "abcdef", 6, test_on_send_complete, (void*)0x01);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    (void)socketio_get_send_statistics(socket_io, &statistics);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.packets_queued);
+    ASSERT_ARE_EQUAL(size_t, 3, statistics.queued_bytes);
+
+    // cleanup
+    g_socket_space = TEST_WIRE_SIZE;
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_setoption_fails_when_option_name_is_null)
+TEST_FUNCTION(socketio_send_queues_the_whole_packet_when_send_returns_EAGAIN)
 {
     // arrange
-    int irrelevant = 1;
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socketio();
+    SOCKETIO_SEND_STATISTICS statistics;
+    g_socket_space = 0;
+
+    STRICT_EXPECTED_CALL(send(TEST_SOCKET, IGNORED_PTR_ARG, 6, 0));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+
+    // act
+    int result = socketio_send(socket_io, "abcdef", 6, test_on_send_complete, (void*)0x01);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    (void)socketio_get_send_statistics(socket_io, &statistics);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.packets_queued);
+    ASSERT_ARE_EQUAL(size_t, 6, statistics.queued_bytes);
 
-    CONCRETE_IO_HANDLE ioHandle = setup_socket();
+    // cleanup
+    socketio_destroy(socket_io);
+}
 
+TEST_FUNCTION(socketio_send_behind_a_queued_packet_queues_without_calling_send)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socketio();
+    SOCKETIO_SEND_STATISTICS statistics;
+    g_socket_space = 0;
+    (void)socketio_send(socket_io, "abcd", 4, test_on_send_complete, (void*)0x01);
+    g_socket_space = TEST_WIRE_SIZE;
     umock_c_reset_all_calls();
 
     // act
-    int result = socketio_setoption(ioHandle, NULL, &irrelevant);
+    int result = socketio_send(socket_io, "efgh", 4, test_on_send_complete, (void*)0x02);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    verify_mocks_and_destroy_socket(ioHandle);
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_wire_length);
+    (void)socketio_get_send_statistics(socket_io, &statistics);
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.packets_queued);
+    ASSERT_ARE_EQUAL(size_t, 8, statistics.queued_bytes);
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_setoption_fails_when_value_is_null)
+TEST_FUNCTION(when_send_fails_socketio_send_fails_and_queues_nothing)
 {
     // arrange
-    CONCRETE_IO_HANDLE ioHandle = setup_socket();
+    CONCRETE_IO_HANDLE socket_io = create_accepted_socketio();
+    SOCKETIO_SEND_STATISTICS statistics;
 
-    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(send(TEST_SOCKET, IGNORED_PTR_ARG, 4, 0))
+        .SetReturn(-1);
 
     // act
-    int result = socketio_setoption(ioHandle, "tcp_keepalive", NULL);
+    errno = ECONNRESET;
+    int result = socketio_send(socket_io, "abcd", 4, test_on_send_complete, (void*)0x01);
 
     // assert
     ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    verify_mocks_and_destroy_socket(ioHandle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    (void)socketio_get_send_statistics(socket_io, &statistics);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.packets_queued);
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_setoption_fails_when_it_receives_an_unsupported_option)
+/* socketio_dowork */
+
+TEST_FUNCTION(socketio_dowork_flushes_queued_packets_with_one_sendmsg_and_completes_them_in_order)
 {
     // arrange
-    int irrelevant = 1;
-
-    CONCRETE_IO_HANDLE ioHandle = setup_socket();
+    CONCRETE_IO_HANDLE socket_io = create_socketio_with_two_queued_packets();
+    SOCKETIO_SEND_STATISTICS statistics;
+    g_socket_space = TEST_WIRE_SIZE;
 
-    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x01, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x02, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0));
 
     // act
-    int result = socketio_setoption(ioHandle, "unsupported_option_name", &irrelevant);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    verify_mocks_and_destroy_socket(ioHandle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 8, g_wire_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(g_wire, "abcdefgh", 8));
+    (void)socketio_get_send_statistics(socket_io, &statistics);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.flush_calls);
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.packets_flushed);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.queued_bytes);
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_setoption_passes_tcp_keepalive_to_setsockopt)
+TEST_FUNCTION(socketio_dowork_completes_only_the_packets_whose_last_byte_was_sent)
 {
     // arrange
-    CONCRETE_IO_HANDLE ioHandle = setup_socket();
+    CONCRETE_IO_HANDLE socket_io = create_socketio_with_two_queued_packets();
+    g_socket_space = 6;
+
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x01, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0));
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 6, g_wire_length);
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
 
+TEST_FUNCTION(socketio_dowork_sends_the_rest_of_a_partially_flushed_packet_next_time)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio_with_two_queued_packets();
+    g_socket_space = 6;
+    socketio_dowork(socket_io);
+    g_socket_space = TEST_WIRE_SIZE;
     umock_c_reset_all_calls();
 
-    int onoff = -42;
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x02, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0));
 
-    STRICT_EXPECTED_CALL(setsockopt(*(int*)ioHandle, SOL_SOCKET, SO_KEEPALIVE,
-        &onoff, sizeof(int)));
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 8, g_wire_length);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(g_wire, "abcdefgh", 8));
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(when_sendmsg_returns_EAGAIN_socketio_dowork_keeps_the_queue)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio_with_two_queued_packets();
+    SOCKETIO_SEND_STATISTICS statistics;
+
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0));
 
     // act
-    int result = socketio_setoption(ioHandle, "tcp_keepalive", &onoff);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_ARE_EQUAL(int, 0, result);
-    verify_mocks_and_destroy_socket(ioHandle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    (void)socketio_get_send_statistics(socket_io, &statistics);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.packets_flushed);
+    ASSERT_ARE_EQUAL(size_t, 8, statistics.queued_bytes);
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_setoption_passes_tcp_keepalive_time_to_setsockopt)
+TEST_FUNCTION(when_sendmsg_fails_socketio_dowork_indicates_an_error)
 {
     // arrange
-    CONCRETE_IO_HANDLE ioHandle = setup_socket();
+    CONCRETE_IO_HANDLE socket_io = create_socketio_with_two_queued_packets();
 
-    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, 0))
+        .SetReturn(-1);
+    STRICT_EXPECTED_CALL(test_on_io_error((void*)0x4244));
 
-    int time = 3;
+    // act
+    errno = ECONNRESET;
+    socketio_dowork(socket_io);
 
-    STRICT_EXPECTED_CALL(setsockopt(*(int*)ioHandle, SOL_TCP, TCP_KEEPIDLE,
-        &time, sizeof(int)));
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+/* socketio_close */
+
+TEST_FUNCTION(socketio_close_cancels_the_queued_packets_in_order)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio_with_two_queued_packets();
+
+    STRICT_EXPECTED_CALL(shutdown(TEST_SOCKET, SHUT_RDWR));
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x01, IO_SEND_CANCELLED));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x02, IO_SEND_CANCELLED));
+    STRICT_EXPECTED_CALL(test_on_io_close_complete((void*)0x4245));
 
     // act
-    int result = socketio_setoption(ioHandle, "tcp_keepalive_time", &time);
+    int result = socketio_close(socket_io, test_on_io_close_complete, (void*)0x4245);
 
     // assert
     ASSERT_ARE_EQUAL(int, 0, result);
-    verify_mocks_and_destroy_socket(ioHandle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_setoption_passes_tcp_keepalive_interval_to_setsockopt)
+TEST_FUNCTION(socketio_close_cancels_the_rest_of_a_partially_flushed_packet)
 {
     // arrange
-    CONCRETE_IO_HANDLE ioHandle = setup_socket();
-
+    CONCRETE_IO_HANDLE socket_io = create_socketio_with_two_queued_packets();
+    g_socket_space = 6;
+    socketio_dowork(socket_io);
     umock_c_reset_all_calls();
 
-    int interval = 15;
-
-    STRICT_EXPECTED_CALL(setsockopt(*(int*)ioHandle, SOL_TCP, TCP_KEEPINTVL,
-        &interval, sizeof(int)));
+    STRICT_EXPECTED_CALL(shutdown(TEST_SOCKET, SHUT_RDWR));
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x02, IO_SEND_CANCELLED));
+    STRICT_EXPECTED_CALL(test_on_io_close_complete((void*)0x4245));
 
     // act
-    int result = socketio_setoption(ioHandle, "tcp_keepalive_interval", &interval);
+    int result = socketio_close(socket_io, test_on_io_close_complete, (void*)0x4245);
 
     // assert
     ASSERT_ARE_EQUAL(int, 0, result);
-    verify_mocks_and_destroy_socket(ioHandle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-#endif
+/* socketio_open */
 
-/* Seems like the below tests require a full blown rewrite */
+TEST_FUNCTION(socketio_open_starts_a_lookup_and_returns_before_it_completes)
+{
+    // arrange
+    SOCKETIO_CONFIG socket_io_config = { TEST_HOSTNAME, TEST_PORT, NULL };
+    CONCRETE_IO_HANDLE socket_io = socketio_create(&socket_io_config);
+    umock_c_reset_all_calls();
 
-#if 0
+    STRICT_EXPECTED_CALL(dns_cache_get_ipv4(TEST_HOSTNAME, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(dns_async_create(TEST_HOSTNAME, NULL));
 
-TEST_SUITE_INITIALIZE(suite_init)
-{
-    test_serialize_mutex = MicroMockCreateMutex();
-    ASSERT_IS_NOT_NULL(test_serialize_mutex);
-}
+    // act
+    int result = socketio_open(socket_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
 
-TEST_SUITE_CLEANUP(suite_cleanup)
-{
-    MicroMockDestroyMutex(test_serialize_mutex);
-}
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-TEST_FUNCTION_INITIALIZE(method_init)
-{
-    if (!MicroMockAcquireMutex(test_serialize_mutex))
-    {
-        ASSERT_FAIL("Could not acquire test serialization mutex.");
-    }
-    list_head_count = 0;
-    list_add_called = false;
-    g_addrinfo_call_fail = false;
-    //g_socket_send_size_value = -1;
-    g_socket_recv_size_value = -1;
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION_CLEANUP(method_cleanup)
+TEST_FUNCTION(socketio_open_with_a_cached_address_connects_without_a_lookup)
 {
-    if (!MicroMockReleaseMutex(test_serialize_mutex))
-    {
-        ASSERT_FAIL("Could not release test serialization mutex.");
-    }
-}
+    // arrange
+    SOCKETIO_CONFIG socket_io_config = { TEST_HOSTNAME, TEST_PORT, NULL };
+    CONCRETE_IO_HANDLE socket_io = socketio_create(&socket_io_config);
+    uint32_t cached_ipv4 = TEST_IPV4;
+    umock_c_reset_all_calls();
 
-static void OnBytesReceived(void* context, const unsigned char* buffer, size_t size)
-{
-    (void)context;
-    (void)buffer;
-    (void)size;
+    STRICT_EXPECTED_CALL(dns_cache_get_ipv4(TEST_HOSTNAME, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_ipv4(&cached_ipv4, sizeof(cached_ipv4))
+        .SetReturn(0);
+    STRICT_EXPECTED_CALL(socket(AF_INET, SOCK_STREAM, 0));
+    STRICT_EXPECTED_CALL(connect(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(socket_poller_add(TEST_SOCKET));
+
+    // act
+    int result = socketio_open(socket_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-static void PrintLogFunction(unsigned int options, char* format, ...)
+TEST_FUNCTION(when_dns_async_create_fails_socketio_open_fails)
 {
-    (void)options;
-    (void)format;
+    // arrange
+    SOCKETIO_CONFIG socket_io_config = { TEST_HOSTNAME, TEST_PORT, NULL };
+    CONCRETE_IO_HANDLE socket_io = socketio_create(&socket_io_config);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(dns_cache_get_ipv4(TEST_HOSTNAME, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(dns_async_create(TEST_HOSTNAME, NULL))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
+
+    // act
+    int result = socketio_open(socket_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-static void OnSendComplete(void* context, IO_SEND_RESULT send_result)
+/* socketio_dowork while opening */
+
+TEST_FUNCTION(socketio_dowork_does_not_connect_while_the_lookup_runs)
 {
-    (void)context;
-    (void)send_result;
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_resolving_socketio();
+
+    STRICT_EXPECTED_CALL(dns_async_is_lookup_complete(TEST_DNS))
+        .SetReturn(false);
+
+    // act
+    socketio_dowork(socket_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-/* socketio_win32_create */
-TEST_FUNCTION(socketio_create_io_create_parameters_NULL_fails)
+TEST_FUNCTION(socketio_dowork_caches_the_resolved_address_and_starts_the_connect)
 {
     // arrange
-    socketio_mocks mocks;
+    CONCRETE_IO_HANDLE socket_io = create_resolving_socketio();
+
+    STRICT_EXPECTED_CALL(dns_async_is_lookup_complete(TEST_DNS))
+        .SetReturn(true);
+    STRICT_EXPECTED_CALL(dns_async_get_ipv4(TEST_DNS))
+        .SetReturn(TEST_IPV4);
+    STRICT_EXPECTED_CALL(dns_async_destroy(TEST_DNS));
+    STRICT_EXPECTED_CALL(dns_cache_add_ipv4(TEST_HOSTNAME, TEST_IPV4));
+    STRICT_EXPECTED_CALL(socket(AF_INET, SOCK_STREAM, 0));
+    STRICT_EXPECTED_CALL(connect(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(socket_poller_add(TEST_SOCKET));
 
     // act
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(NULL, PrintLogFunction);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_IS_NULL(ioHandle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_create_list_create_fails)
+TEST_FUNCTION(when_the_lookup_fails_socketio_dowork_indicates_an_open_error)
 {
     // arrange
-    socketio_mocks mocks;
+    CONCRETE_IO_HANDLE socket_io = create_resolving_socketio();
 
-    EXPECTED_CALL(mocks, gballoc_malloc(IGNORED_NUM_ARG));
-    EXPECTED_CALL(mocks, singlylinkedlist_create()).SetReturn((SINGLYLINKEDLIST_HANDLE)NULL);
-    EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG));
-
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
+    STRICT_EXPECTED_CALL(dns_async_is_lookup_complete(TEST_DNS))
+        .SetReturn(true);
+    STRICT_EXPECTED_CALL(dns_async_get_ipv4(TEST_DNS))
+        .SetReturn(0);
+    STRICT_EXPECTED_CALL(dns_async_destroy(TEST_DNS));
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
 
     // act
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_IS_NULL(ioHandle);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_create_succeeds)
+TEST_FUNCTION(socketio_dowork_keeps_waiting_for_a_connect_that_has_not_timed_out)
 {
     // arrange
-    socketio_mocks mocks;
+    CONCRETE_IO_HANDLE socket_io = create_connecting_socketio();
 
-    EXPECTED_CALL(mocks, gballoc_malloc(IGNORED_NUM_ARG));
-    EXPECTED_CALL(mocks, singlylinkedlist_create());
-    EXPECTED_CALL(mocks, gballoc_malloc(IGNORED_NUM_ARG));
-
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
+    STRICT_EXPECTED_CALL(select(TEST_SOCKET + 1, NULL, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        .SetReturn(0);
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG))
+        .SetReturn(9.0);
 
     // act
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_IS_NOT_NULL(ioHandle);
-    mocks.AssertActualAndExpectedCalls();
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-    socketio_destroy(ioHandle);
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-// socketio_win32_destroy 
-TEST_FUNCTION(socketio_destroy_socket_io_NULL_succeeds)
+TEST_FUNCTION(when_the_connect_times_out_socketio_dowork_forgets_the_address_and_indicates_an_open_error)
 {
     // arrange
-    socketio_mocks mocks;
+    CONCRETE_IO_HANDLE socket_io = create_connecting_socketio();
+
+    STRICT_EXPECTED_CALL(select(TEST_SOCKET + 1, NULL, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        .SetReturn(0);
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG))
+        .SetReturn(10.0);
+    STRICT_EXPECTED_CALL(dns_cache_remove(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
 
     // act
-    socketio_destroy(NULL);
+    socketio_dowork(socket_io);
 
     // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_destroy_socket_succeeds)
+TEST_FUNCTION(when_the_connect_completes_socketio_dowork_indicates_the_open)
 {
     // arrange
-    socketio_mocks mocks;
+    CONCRETE_IO_HANDLE socket_io = create_connecting_socketio();
+
+    STRICT_EXPECTED_CALL(select(TEST_SOCKET + 1, NULL, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(getsockopt(TEST_SOCKET, SOL_SOCKET, SO_ERROR, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
+
+    // act
+    socketio_dowork(socket_io);
 
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-    mocks.ResetAllCalls();
+    // cleanup
+    socketio_destroy(socket_io);
+}
 
-    EXPECTED_CALL(mocks, close(IGNORED_NUM_ARG));
-    EXPECTED_CALL(mocks, singlylinkedlist_get_head_item(IGNORED_PTR_ARG))
-        .ExpectedAtLeastTimes(2);
-    EXPECTED_CALL(mocks, singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, singlylinkedlist_remove(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, singlylinkedlist_destroy(IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG));
+TEST_FUNCTION(when_the_connect_is_refused_socketio_dowork_forgets_the_address_and_indicates_an_open_error)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_connecting_socketio();
+    g_so_error = ECONNREFUSED;
 
-    list_head_count = 1;
+    STRICT_EXPECTED_CALL(select(TEST_SOCKET + 1, NULL, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(getsockopt(TEST_SOCKET, SOL_SOCKET, SO_ERROR, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(dns_cache_remove(TEST_HOSTNAME));
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_ERROR));
 
     // act
-    socketio_destroy(ioHandle);
+    socketio_dowork(socket_io);
 
     // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_open_socket_io_NULL_fails)
+/* socketio_close while opening */
+
+TEST_FUNCTION(socketio_close_during_the_lookup_cancels_the_open)
 {
     // arrange
-    socketio_mocks mocks;
-
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
+    CONCRETE_IO_HANDLE socket_io = create_resolving_socketio();
 
-    mocks.ResetAllCalls();
+    STRICT_EXPECTED_CALL(dns_async_destroy(TEST_DNS));
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_CANCELLED));
+    STRICT_EXPECTED_CALL(test_on_io_close_complete((void*)0x4245));
 
     // act
-    int result = socketio_open(NULL, OnBytesReceived, OnIoStateChanged, &callbackContext);
+    int result = socketio_close(socket_io, test_on_io_close_complete, (void*)0x4245);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_open_socket_fails)
+TEST_FUNCTION(socketio_close_during_the_connect_cancels_the_open)
 {
     // arrange
-    socketio_mocks mocks;
+    CONCRETE_IO_HANDLE socket_io = create_connecting_socketio();
 
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_CANCELLED));
+    STRICT_EXPECTED_CALL(test_on_io_close_complete((void*)0x4245));
 
-    mocks.ResetAllCalls();
+    // act
+    int result = socketio_close(socket_io, test_on_io_close_complete, (void*)0x4245);
 
-    EXPECTED_CALL(mocks, socket(IGNORED_NUM_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG))
-        .SetReturn(-1);
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(socketio_dowork_after_a_cancelled_open_does_nothing)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_resolving_socketio();
+    (void)socketio_close(socket_io, test_on_io_close_complete, (void*)0x4245);
+    umock_c_reset_all_calls();
 
     // act
-    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    mocks.AssertActualAndExpectedCalls();
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-    socketio_destroy(ioHandle);
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
+/* socket poller */
 
-TEST_FUNCTION(socketio_open_getaddrinfo_fails)
+TEST_FUNCTION(socketio_open_of_an_accepted_socket_registers_it_with_the_poller)
 {
     // arrange
-    socketio_mocks mocks;
-
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
-
-    mocks.ResetAllCalls();
+    SOCKETIO_CONFIG socket_io_config = { NULL, 0, &g_accepted_socket };
+    CONCRETE_IO_HANDLE socket_io = socketio_create(&socket_io_config);
+    g_poller_registration = TEST_REGISTRATION;
+    umock_c_reset_all_calls();
 
-    g_addrinfo_call_fail = true;
-    EXPECTED_CALL(mocks, socket(IGNORED_NUM_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(mocks, getaddrinfo(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, close(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(socket_poller_add(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
 
     // act
-    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
+    int result = socketio_open(socket_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    mocks.AssertActualAndExpectedCalls();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-    socketio_destroy(ioHandle);
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_open_connect_fails)
+TEST_FUNCTION(when_the_poller_is_unavailable_socketio_polls_the_socket_directly)
 {
     // arrange
-    socketio_mocks mocks;
+    SOCKETIO_CONFIG socket_io_config = { NULL, 0, &g_accepted_socket };
+    CONCRETE_IO_HANDLE socket_io;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(socket_poller_init())
+        .SetReturn(1);
+    socket_io = socketio_create(&socket_io_config);
+    g_poller_registration = TEST_REGISTRATION;
+    umock_c_reset_all_calls();
 
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0));
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(socket_io));
 
-    mocks.ResetAllCalls();
+    // act
+    (void)socketio_open(socket_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+    socketio_dowork(socket_io);
+    socketio_destroy(socket_io);
 
-    EXPECTED_CALL(mocks, socket(IGNORED_NUM_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(mocks, getaddrinfo(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, connect(IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG))
-        .SetReturn(-1);
-    EXPECTED_CALL(mocks, close(IGNORED_NUM_ARG));
-    EXPECTED_CALL(mocks, freeaddrinfo(IGNORED_PTR_ARG));
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+TEST_FUNCTION(socketio_dowork_without_readiness_makes_no_socket_calls)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io;
+    g_poller_registration = TEST_REGISTRATION;
+    socket_io = create_socketio_with_two_queued_packets();
+    g_socket_space = TEST_WIRE_SIZE;
+
+    STRICT_EXPECTED_CALL(socket_poller_get_events(TEST_REGISTRATION))
+        .SetReturn(0);
 
     // act
-    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    mocks.AssertActualAndExpectedCalls();
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_wire_length);
 
-    socketio_destroy(ioHandle);
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_open_ioctlsocket_fails)
+TEST_FUNCTION(socketio_dowork_on_a_readable_socket_only_receives)
 {
     // arrange
-    socketio_mocks mocks;
-
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
-
-    mocks.ResetAllCalls();
+    CONCRETE_IO_HANDLE socket_io;
+    g_poller_registration = TEST_REGISTRATION;
+    socket_io = create_socketio_with_two_queued_packets();
+    g_socket_space = TEST_WIRE_SIZE;
 
-    EXPECTED_CALL(mocks, socket(IGNORED_NUM_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
-    EXPECTED_CALL(mocks, getaddrinfo(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, connect(IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    //EXPECTED_CALL(mocks, fcntl(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG))
-    //    .SetReturn(-1);
-    EXPECTED_CALL(mocks, freeaddrinfo(IGNORED_PTR_ARG));
-    EXPECTED_CALL(mocks, close(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(socket_poller_get_events(TEST_REGISTRATION))
+        .SetReturn(SOCKET_POLLER_READABLE);
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0));
+    STRICT_EXPECTED_CALL(socket_poller_clear_events(TEST_REGISTRATION, SOCKET_POLLER_READABLE));
 
     // act
-    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
-    mocks.AssertActualAndExpectedCalls();
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-    socketio_destroy(ioHandle);
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-//TEST_FUNCTION(socketio_open_succeeds)
-//{
-//    // arrange
-//    socketio_mocks mocks;
-//
-//    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-//    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
-//
-//    mocks.ResetAllCalls();
-//
-//    EXPECTED_CALL(mocks, socket(IGNORED_NUM_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
-//    EXPECTED_CALL(mocks, getaddrinfo(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-//    EXPECTED_CALL(mocks, connect(IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-//    EXPECTED_CALL(mocks, freeaddrinfo(IGNORED_PTR_ARG));
-//
-//    // act
-//    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
-//
-//    // assert
-//    ASSERT_ARE_EQUAL(int, 0, result);
-//    mocks.AssertActualAndExpectedCalls();
-//
-//    socketio_destroy(ioHandle);
-//}
-
-TEST_FUNCTION(socketio_close_socket_io_NULL_fails)
+TEST_FUNCTION(socketio_dowork_on_a_writable_socket_only_flushes)
 {
     // arrange
-    socketio_mocks mocks;
+    CONCRETE_IO_HANDLE socket_io;
+    g_poller_registration = TEST_REGISTRATION;
+    socket_io = create_socketio_with_two_queued_packets();
+    g_socket_space = TEST_WIRE_SIZE;
+
+    STRICT_EXPECTED_CALL(socket_poller_get_events(TEST_REGISTRATION))
+        .SetReturn(SOCKET_POLLER_WRITABLE);
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x01, IO_SEND_OK));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x02, IO_SEND_OK));
 
     // act
-    int result = socketio_close(NULL);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_close_Succeeds)
+TEST_FUNCTION(when_send_returns_EAGAIN_socketio_send_clears_the_writable_readiness)
 {
     // arrange
-    socketio_mocks mocks;
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
+    CONCRETE_IO_HANDLE socket_io;
+    g_poller_registration = TEST_REGISTRATION;
+    socket_io = create_accepted_socketio();
+    g_socket_space = 0;
+
+    STRICT_EXPECTED_CALL(send(TEST_SOCKET, IGNORED_PTR_ARG, 4, 0));
+    STRICT_EXPECTED_CALL(socket_poller_clear_events(TEST_REGISTRATION, SOCKET_POLLER_WRITABLE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
 
-    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
+    // act
+    int result = socketio_send(socket_io, "abcd", 4, test_on_send_complete, (void*)0x01);
 
-    mocks.ResetAllCalls();
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-    EXPECTED_CALL(mocks, close(IGNORED_NUM_ARG));
+    // cleanup
+    socketio_destroy(socket_io);
+}
+
+TEST_FUNCTION(when_sendmsg_returns_EAGAIN_socketio_dowork_clears_the_writable_readiness)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io;
+    g_poller_registration = TEST_REGISTRATION;
+    socket_io = create_socketio_with_two_queued_packets();
+
+    STRICT_EXPECTED_CALL(socket_poller_get_events(TEST_REGISTRATION))
+        .SetReturn(SOCKET_POLLER_READABLE | SOCKET_POLLER_WRITABLE);
+    STRICT_EXPECTED_CALL(sendmsg(TEST_SOCKET, IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(socket_poller_clear_events(TEST_REGISTRATION, SOCKET_POLLER_WRITABLE));
+    STRICT_EXPECTED_CALL(recv(TEST_SOCKET, IGNORED_PTR_ARG, IGNORED_NUM_ARG, 0));
+    STRICT_EXPECTED_CALL(socket_poller_clear_events(TEST_REGISTRATION, SOCKET_POLLER_READABLE));
 
     // act
-    result = socketio_close(ioHandle);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_send_socket_io_fails)
+TEST_FUNCTION(socketio_dowork_waits_for_the_poller_to_report_a_connect_without_calling_select)
 {
     // arrange
-    socketio_mocks mocks;
+    CONCRETE_IO_HANDLE socket_io;
+    g_poller_registration = TEST_REGISTRATION;
+    socket_io = create_connecting_socketio();
+
+    STRICT_EXPECTED_CALL(socket_poller_get_events(TEST_REGISTRATION))
+        .SetReturn(SOCKET_POLLER_READABLE);
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
 
     // act
-    int result = socketio_send(NULL, (const void*)TEST_BUFFER_VALUE, TEST_BUFFER_SIZE, OnSendComplete, (void*)TEST_CALLBACK_CONTEXT);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_send_buffer_NULL_fails)
+TEST_FUNCTION(when_the_poller_reports_the_connecting_socket_writable_socketio_dowork_indicates_the_open)
 {
     // arrange
-    socketio_mocks mocks;
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
-
-    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
+    CONCRETE_IO_HANDLE socket_io;
+    g_poller_registration = TEST_REGISTRATION;
+    socket_io = create_connecting_socketio();
 
-    mocks.ResetAllCalls();
+    STRICT_EXPECTED_CALL(socket_poller_get_events(TEST_REGISTRATION))
+        .SetReturn(SOCKET_POLLER_WRITABLE);
+    STRICT_EXPECTED_CALL(getsockopt(TEST_SOCKET, SOL_SOCKET, SO_ERROR, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_io_open_complete((void*)0x4242, IO_OPEN_OK));
 
     // act
-    result = socketio_send(ioHandle, NULL, TEST_BUFFER_SIZE, OnSendComplete, (void*)TEST_CALLBACK_CONTEXT);
+    socketio_dowork(socket_io);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-TEST_FUNCTION(socketio_send_size_zero_fails)
+TEST_FUNCTION(socketio_close_stops_watching_the_socket_before_closing_it)
 {
     // arrange
-    socketio_mocks mocks;
-    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
+    CONCRETE_IO_HANDLE socket_io;
+    g_poller_registration = TEST_REGISTRATION;
+    socket_io = create_accepted_socketio();
 
-    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
-
-    mocks.ResetAllCalls();
+    STRICT_EXPECTED_CALL(shutdown(TEST_SOCKET, SHUT_RDWR));
+    STRICT_EXPECTED_CALL(socket_poller_remove(TEST_REGISTRATION));
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(test_on_io_close_complete((void*)0x4245));
 
     // act
-    result = socketio_send(ioHandle, (const void*)TEST_BUFFER_VALUE, 0, OnSendComplete, (void*)TEST_CALLBACK_CONTEXT);
+    int result = socketio_close(socket_io, test_on_io_close_complete, (void*)0x4245);
 
     // assert
-    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    socketio_destroy(socket_io);
 }
 
-// TBD:  To be implemented when fcntl is mocked
-//TEST_FUNCTION(socketio_send_succeeds)
-//{
-//    // arrange
-//    socketio_mocks mocks;
-//    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-//    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
-//
-//    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
-//
-//    mocks.ResetAllCalls();
-//
-//    EXPECTED_CALL(mocks, singlylinkedlist_get_head_item(IGNORED_PTR_ARG));
-//    EXPECTED_CALL(mocks, send(IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
-//
-//    // act
-//    result = socketio_send(ioHandle, (const void*)TEST_BUFFER_VALUE, TEST_BUFFER_SIZE, OnSendComplete, (void*)TEST_CALLBACK_CONTEXT);
-//
-//    // assert
-//    ASSERT_ARE_EQUAL(int, 0, result);
-//    mocks.AssertActualAndExpectedCalls();
-//
-//    socketio_destroy(ioHandle);
-//}
-
-// TBD:  To be implemented when fcntl is mocked
-//TEST_FUNCTION(socketio_send_returns_1_succeeds)
-//{
-//    // arrange
-//    socketio_mocks mocks;
-//    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-//    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
-//
-//    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
-//    ASSERT_ARE_EQUAL(int, 0, result);
-//
-//    mocks.ResetAllCalls();
-//
-//    EXPECTED_CALL(mocks, singlylinkedlist_get_head_item(IGNORED_PTR_ARG));
-//    EXPECTED_CALL(mocks, send(IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(1);
-//    EXPECTED_CALL(mocks, gballoc_malloc(IGNORED_NUM_ARG));
-//    EXPECTED_CALL(mocks, gballoc_malloc(IGNORED_NUM_ARG));
-//    EXPECTED_CALL(mocks, singlylinkedlist_add(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-//
-//    // act
-//    result = socketio_send(ioHandle, (const void*)TEST_BUFFER_VALUE, TEST_BUFFER_SIZE, OnSendComplete, (void*)TEST_CALLBACK_CONTEXT);
-//
-//    // assert
-//    ASSERT_ARE_EQUAL(int, 0, result);
-//    mocks.AssertActualAndExpectedCalls();
-//
-//    socketio_destroy(ioHandle);
-//}
-
-TEST_FUNCTION(socketio_dowork_socket_io_NULL_fails)
-{
-    // arrange
-    socketio_mocks mocks;
-
-    // act
-    socketio_dowork(NULL);
-
-    // assert
-}
-
-// TBD:  To be implemented when fcntl is mocked
-//TEST_FUNCTION(socketio_dowork_succeeds)
-//{
-//    // arrange
-//    socketio_mocks mocks;
-//    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-//    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
-//
-//    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
-//
-//    mocks.ResetAllCalls();
-//
-//    EXPECTED_CALL(mocks, singlylinkedlist_get_head_item(IGNORED_PTR_ARG));
-//    EXPECTED_CALL(mocks, recv(IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
-//
-//    // act
-//    socketio_dowork(ioHandle);
-//
-//    // assert
-//    mocks.AssertActualAndExpectedCalls();
-//
-//    socketio_destroy(ioHandle);
-//}
-
-// TBD:  To be implemented when fcntl is mocked
-//TEST_FUNCTION(socketio_dowork_recv_bytes_succeeds)
-//{
-//    // arrange
-//    socketio_mocks mocks;
-//    SOCKETIO_CONFIG socketConfig = { HOSTNAME_ARG, PORT_NUM, NULL };
-//    CONCRETE_IO_HANDLE ioHandle = socketio_create(&socketConfig, PrintLogFunction);
-//
-//    int result = socketio_open(ioHandle, OnBytesReceived, OnIoStateChanged, &callbackContext);
-//
-//    mocks.ResetAllCalls();
-//
-//    EXPECTED_CALL(mocks, singlylinkedlist_get_head_item(IGNORED_PTR_ARG));
-//    EXPECTED_CALL(mocks, recv(IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG))
-//        .CopyOutArgumentBuffer(2, "t", 1)
-//        .SetReturn(1);
-//    EXPECTED_CALL(mocks, recv(IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_NUM_ARG));
-//
-//    // act
-//    socketio_dowork(ioHandle);
-//
-//    // assert
-//    mocks.AssertActualAndExpectedCalls();
-//
-//    socketio_destroy(ioHandle);
-//}
+/* socketio_destroy */
 
-#endif
+TEST_FUNCTION(socketio_destroy_cancels_the_queued_packets_in_order)
+{
+    // arrange
+    CONCRETE_IO_HANDLE socket_io = create_socketio_with_two_queued_packets();
+
+    STRICT_EXPECTED_CALL(close(TEST_SOCKET));
+    STRICT_EXPECTED_CALL(socket_poller_deinit());
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x01, IO_SEND_CANCELLED));
+    STRICT_EXPECTED_CALL(test_on_send_complete((void*)0x02, IO_SEND_CANCELLED));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(socket_io));
 
-END_TEST_SUITE(socketio_berkeley_unittests)
+    // act
+    socketio_destroy(socket_io);
 
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+END_TEST_SUITE(socketio_berkeley_unittests)
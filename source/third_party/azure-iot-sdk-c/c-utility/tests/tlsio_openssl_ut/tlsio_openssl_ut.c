@@ -0,0 +1,762 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+#include "azure_c_shared_utility/macro_utils.h"
+
+#include "openssl/ssl.h"
+#include "openssl/err.h"
+#include "openssl/crypto.h"
+#include "openssl/opensslv.h"
+#include "openssl/pem.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/socketio.h"
+#include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/x509_openssl.h"
+#include "azure_c_shared_utility/lock.h"
+
+/*the callbacks OpenSSL takes need a name to go through the mock macros*/
+typedef int(*NEW_SESSION_CALLBACK)(SSL*, SSL_SESSION*);
+typedef int(*CERT_VERIFY_CALLBACK)(X509_STORE_CTX*, void*);
+
+/*from openssl/ssl.h*/
+MOCKABLE_FUNCTION(, const SSL_METHOD*, TLSv1_method);
+MOCKABLE_FUNCTION(, const SSL_METHOD*, TLSv1_1_method);
+MOCKABLE_FUNCTION(, const SSL_METHOD*, TLSv1_2_method);
+MOCKABLE_FUNCTION(, SSL_CTX*, SSL_CTX_new, const SSL_METHOD*, meth);
+MOCKABLE_FUNCTION(, void, SSL_CTX_free, SSL_CTX*, ctx);
+MOCKABLE_FUNCTION(, long, SSL_CTX_ctrl, SSL_CTX*, ctx, int, cmd, long, larg, void*, parg);
+MOCKABLE_FUNCTION(, X509_STORE*, SSL_CTX_get_cert_store, const SSL_CTX*, ctx);
+MOCKABLE_FUNCTION(, void, SSL_CTX_sess_set_new_cb, SSL_CTX*, ctx, NEW_SESSION_CALLBACK, new_session_cb);
+MOCKABLE_FUNCTION(, void, SSL_CTX_set_cert_verify_callback, SSL_CTX*, ctx, CERT_VERIFY_CALLBACK, cb, void*, arg);
+MOCKABLE_FUNCTION(, int, SSL_CTX_set_default_verify_paths, SSL_CTX*, ctx);
+MOCKABLE_FUNCTION(, void, SSL_CTX_set_verify, SSL_CTX*, ctx, int, mode, SSL_verify_cb, callback);
+MOCKABLE_FUNCTION(, SSL*, SSL_new, SSL_CTX*, ctx);
+MOCKABLE_FUNCTION(, void, SSL_free, SSL*, ssl);
+MOCKABLE_FUNCTION(, void, SSL_set_bio, SSL*, s, BIO*, rbio, BIO*, wbio);
+MOCKABLE_FUNCTION(, void, SSL_set_connect_state, SSL*, s);
+MOCKABLE_FUNCTION(, int, SSL_set_ex_data, SSL*, ssl, int, idx, void*, data);
+MOCKABLE_FUNCTION(, void*, SSL_get_ex_data, const SSL*, ssl, int, idx);
+MOCKABLE_FUNCTION(, int, SSL_set_session, SSL*, to, SSL_SESSION*, session);
+MOCKABLE_FUNCTION(, int, SSL_SESSION_up_ref, SSL_SESSION*, ses);
+MOCKABLE_FUNCTION(, void, SSL_SESSION_free, SSL_SESSION*, ses);
+MOCKABLE_FUNCTION(, int, SSL_do_handshake, SSL*, s);
+MOCKABLE_FUNCTION(, int, SSL_get_error, const SSL*, s, int, ret_code);
+MOCKABLE_FUNCTION(, int, SSL_read, SSL*, ssl, void*, buf, int, num);
+MOCKABLE_FUNCTION(, int, SSL_write, SSL*, ssl, const void*, buf, int, num);
+MOCKABLE_FUNCTION(, int, SSL_shutdown, SSL*, s);
+MOCKABLE_FUNCTION(, void, SSL_set_shutdown, SSL*, ssl, int, mode);
+MOCKABLE_FUNCTION(, int, OPENSSL_init_ssl, uint64_t, opts, const OPENSSL_INIT_SETTINGS*, settings);
+
+/*from openssl/bio.h*/
+MOCKABLE_FUNCTION(, const BIO_METHOD*, BIO_s_mem);
+MOCKABLE_FUNCTION(, BIO*, BIO_new, const BIO_METHOD*, type);
+MOCKABLE_FUNCTION(, int, BIO_free, BIO*, a);
+MOCKABLE_FUNCTION(, long, BIO_ctrl, BIO*, bp, int, cmd, long, larg, void*, parg);
+MOCKABLE_FUNCTION(, size_t, BIO_ctrl_pending, BIO*, b);
+MOCKABLE_FUNCTION(, int, BIO_read, BIO*, b, void*, data, int, dlen);
+MOCKABLE_FUNCTION(, int, BIO_write, BIO*, b, const void*, data, int, dlen);
+MOCKABLE_FUNCTION(, int, BIO_puts, BIO*, bp, const char*, buf);
+
+/*from openssl/err.h, openssl/crypto.h, openssl/pem.h and openssl/x509_vfy.h*/
+MOCKABLE_FUNCTION(, void, ERR_clear_error);
+MOCKABLE_FUNCTION(, unsigned long, ERR_get_error);
+MOCKABLE_FUNCTION(, char*, ERR_error_string, unsigned long, e, char*, buf);
+MOCKABLE_FUNCTION(, int, ERR_load_BIO_strings);
+MOCKABLE_FUNCTION(, void, ERR_remove_thread_state, void*, tid);
+MOCKABLE_FUNCTION(, int, OPENSSL_init_crypto, uint64_t, opts, const OPENSSL_INIT_SETTINGS*, settings);
+MOCKABLE_FUNCTION(, X509*, PEM_read_bio_X509, BIO*, out, X509**, x, pem_password_cb*, cb, void*, u);
+MOCKABLE_FUNCTION(, int, X509_STORE_add_cert, X509_STORE*, ctx, X509*, x);
+MOCKABLE_FUNCTION(, void, X509_free, X509*, a);
+#undef ENABLE_MOCKS
+
+#include "azure_c_shared_utility/tlsio.h"
+#include "azure_c_shared_utility/tlsio_openssl.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+#define TEST_CLOSE_NOTIFY_SIZE 31
+
+static const SSL_METHOD* TEST_SSL_METHOD = (const SSL_METHOD*)0x0011;
+static SSL_CTX* TEST_SSL_CTX = (SSL_CTX*)0x0012;
+static SSL* TEST_SSL = (SSL*)0x0013;
+static BIO* TEST_IN_BIO = (BIO*)0x0014;
+static BIO* TEST_OUT_BIO = (BIO*)0x0015;
+static SSL_SESSION* TEST_SSL_SESSION = (SSL_SESSION*)0x0016;
+static SSL_SESSION* TEST_NEW_SSL_SESSION = (SSL_SESSION*)0x0017;
+static const IO_INTERFACE_DESCRIPTION* TEST_SOCKETIO_INTERFACE_DESCRIPTION = (const IO_INTERFACE_DESCRIPTION*)0x0018;
+static XIO_HANDLE TEST_UNDERLYING_IO = (XIO_HANDLE)0x0019;
+static OPTIONHANDLER_HANDLE TEST_OPTIONHANDLER = (OPTIONHANDLER_HANDLE)0x001A;
+static OPTIONHANDLER_HANDLE TEST_UNDERLYING_IO_OPTIONS = (OPTIONHANDLER_HANDLE)0x001B;
+
+static size_t g_out_bio_pending;
+static BIO* g_next_bio;
+static void* g_ssl_app_data;
+static NEW_SESSION_CALLBACK g_on_new_session;
+static ON_IO_OPEN_COMPLETE g_on_underlying_io_open_complete;
+static void* g_on_underlying_io_open_complete_context;
+static ON_SEND_COMPLETE g_on_underlying_io_send_complete;
+static void* g_on_underlying_io_send_complete_context;
+static ON_IO_CLOSE_COMPLETE g_on_underlying_io_close_complete;
+static void* g_on_underlying_io_close_complete_context;
+static int g_ssl_shutdown_mode;
+static bool g_session_not_resumable;
+static void* g_saved_session;
+
+static BIO* my_BIO_new(const BIO_METHOD* type)
+{
+    BIO* result = g_next_bio;
+    (void)type;
+    g_next_bio = TEST_OUT_BIO;
+    return result;
+}
+
+static size_t my_BIO_ctrl_pending(BIO* b)
+{
+    return (b == TEST_OUT_BIO) ? g_out_bio_pending : 0;
+}
+
+static int my_BIO_read(BIO* b, void* data, int dlen)
+{
+    (void)b;
+    (void)data;
+    g_out_bio_pending -= (size_t)dlen;
+    return dlen;
+}
+
+static int my_SSL_set_ex_data(SSL* ssl, int idx, void* data)
+{
+    (void)ssl;
+    (void)idx;
+    g_ssl_app_data = data;
+    return 1;
+}
+
+static void* my_SSL_get_ex_data(const SSL* ssl, int idx)
+{
+    (void)ssl;
+    (void)idx;
+    return g_ssl_app_data;
+}
+
+static void my_SSL_CTX_sess_set_new_cb(SSL_CTX* ctx, NEW_SESSION_CALLBACK new_session_cb)
+{
+    (void)ctx;
+    g_on_new_session = new_session_cb;
+}
+
+static int my_SSL_shutdown(SSL* s)
+{
+    (void)s;
+    /*OpenSSL writes the close_notify alert to the out BIO*/
+    g_out_bio_pending = TEST_CLOSE_NOTIFY_SIZE;
+    g_ssl_shutdown_mode |= SSL_SENT_SHUTDOWN;
+    return 0;
+}
+
+static void my_SSL_set_shutdown(SSL* ssl, int mode)
+{
+    (void)ssl;
+    g_ssl_shutdown_mode = mode;
+}
+
+static void my_SSL_free(SSL* ssl)
+{
+    (void)ssl;
+    /*OpenSSL removes the session of a connection freed without SSL_SENT_SHUTDOWN from the cache and marks it not resumable*/
+    if ((g_ssl_shutdown_mode & SSL_SENT_SHUTDOWN) == 0)
+    {
+        g_session_not_resumable = true;
+    }
+    g_ssl_shutdown_mode = 0;
+}
+
+static OPTIONHANDLER_RESULT my_OptionHandler_AddOption(OPTIONHANDLER_HANDLE handle, const char* name, const void* value)
+{
+    (void)handle;
+    if (strcmp(name, OPTION_TLS_SESSION) == 0)
+    {
+        g_saved_session = (void*)value;
+    }
+    return OPTIONHANDLER_OK;
+}
+
+static int my_xio_open(XIO_HANDLE xio, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context)
+{
+    (void)xio;
+    (void)on_bytes_received;
+    (void)on_bytes_received_context;
+    (void)on_io_error;
+    (void)on_io_error_context;
+    g_on_underlying_io_open_complete = on_io_open_complete;
+    g_on_underlying_io_open_complete_context = on_io_open_complete_context;
+    return 0;
+}
+
+static int my_xio_send(XIO_HANDLE xio, const void* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    (void)xio;
+    (void)buffer;
+    (void)size;
+    /*the send is queued, as by a socketio that got EAGAIN*/
+    g_on_underlying_io_send_complete = on_send_complete;
+    g_on_underlying_io_send_complete_context = callback_context;
+    return 0;
+}
+
+static int my_xio_close(XIO_HANDLE xio, ON_IO_CLOSE_COMPLETE on_io_close_complete, void* callback_context)
+{
+    (void)xio;
+    g_on_underlying_io_close_complete = on_io_close_complete;
+    g_on_underlying_io_close_complete_context = callback_context;
+    return 0;
+}
+
+static void my_xio_destroy(XIO_HANDLE xio)
+{
+    (void)xio;
+    /*a socketio cancels what is still queued when it is destroyed*/
+    if (g_on_underlying_io_send_complete != NULL)
+    {
+        g_on_underlying_io_send_complete(g_on_underlying_io_send_complete_context, IO_SEND_CANCELLED);
+    }
+}
+
+MOCK_FUNCTION_WITH_CODE(, void, test_on_io_open_complete, void*, context, IO_OPEN_RESULT, open_result)
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_bytes_received, void*, context, const unsigned char*, buffer, size_t, size)
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_io_error, void*, context)
+MOCK_FUNCTION_END()
+MOCK_FUNCTION_WITH_CODE(, void, test_on_io_close_complete, void*, context)
+MOCK_FUNCTION_END()
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static CONCRETE_IO_HANDLE create_tlsio(void)
+{
+    TLSIO_CONFIG tls_io_config = { "test_hostname", 443, NULL, NULL };
+    return tlsio_openssl_get_interface_description()->concrete_io_create(&tls_io_config);
+}
+
+static void open_tlsio(CONCRETE_IO_HANDLE tls_io)
+{
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    (void)tlsio_interface->concrete_io_open(tls_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+    g_on_underlying_io_open_complete(g_on_underlying_io_open_complete_context, IO_OPEN_OK);
+}
+
+BEGIN_TEST_SUITE(tlsio_openssl_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(const SSL_METHOD*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SSL_CTX*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const SSL_CTX*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SSL*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const SSL*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SSL_SESSION*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BIO*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const BIO_METHOD*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(X509*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(X509**, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(X509_STORE*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(pem_password_cb*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const OPENSSL_INIT_SETTINGS*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(NEW_SESSION_CALLBACK, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CERT_VERIFY_CALLBACK, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SSL_verify_cb, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(XIO_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const IO_INTERFACE_DESCRIPTION*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_IO_OPEN_COMPLETE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_BYTES_RECEIVED, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_IO_ERROR, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_IO_CLOSE_COMPLETE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_SEND_COMPLETE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(OPTIONHANDLER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(pfCloneOption, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(pfDestroyOption, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(pfSetOption, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(OPTIONHANDLER_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IO_OPEN_RESULT, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_RETURN(TLSv1_method, TEST_SSL_METHOD);
+    REGISTER_GLOBAL_MOCK_RETURN(SSL_CTX_new, TEST_SSL_CTX);
+    REGISTER_GLOBAL_MOCK_RETURN(SSL_CTX_set_default_verify_paths, 1);
+    REGISTER_GLOBAL_MOCK_RETURN(SSL_new, TEST_SSL);
+    REGISTER_GLOBAL_MOCK_RETURN(SSL_set_session, 1);
+    REGISTER_GLOBAL_MOCK_RETURN(SSL_SESSION_up_ref, 1);
+    REGISTER_GLOBAL_MOCK_RETURN(SSL_do_handshake, 1);
+    REGISTER_GLOBAL_MOCK_HOOK(SSL_set_ex_data, my_SSL_set_ex_data);
+    REGISTER_GLOBAL_MOCK_HOOK(SSL_get_ex_data, my_SSL_get_ex_data);
+    REGISTER_GLOBAL_MOCK_HOOK(SSL_CTX_sess_set_new_cb, my_SSL_CTX_sess_set_new_cb);
+    REGISTER_GLOBAL_MOCK_HOOK(SSL_shutdown, my_SSL_shutdown);
+    REGISTER_GLOBAL_MOCK_HOOK(SSL_set_shutdown, my_SSL_set_shutdown);
+    REGISTER_GLOBAL_MOCK_HOOK(SSL_free, my_SSL_free);
+    REGISTER_GLOBAL_MOCK_HOOK(BIO_new, my_BIO_new);
+    REGISTER_GLOBAL_MOCK_RETURN(BIO_ctrl, 1);
+    REGISTER_GLOBAL_MOCK_HOOK(BIO_ctrl_pending, my_BIO_ctrl_pending);
+    REGISTER_GLOBAL_MOCK_HOOK(BIO_read, my_BIO_read);
+
+    REGISTER_GLOBAL_MOCK_RETURN(socketio_get_interface_description, TEST_SOCKETIO_INTERFACE_DESCRIPTION);
+    REGISTER_GLOBAL_MOCK_RETURN(xio_create, TEST_UNDERLYING_IO);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_open, my_xio_open);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_send, my_xio_send);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_close, my_xio_close);
+    REGISTER_GLOBAL_MOCK_HOOK(xio_destroy, my_xio_destroy);
+    REGISTER_GLOBAL_MOCK_RETURN(xio_retrieveoptions, TEST_UNDERLYING_IO_OPTIONS);
+    REGISTER_GLOBAL_MOCK_RETURN(OptionHandler_Create, TEST_OPTIONHANDLER);
+    REGISTER_GLOBAL_MOCK_HOOK(OptionHandler_AddOption, my_OptionHandler_AddOption);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    g_out_bio_pending = 0;
+    g_next_bio = TEST_IN_BIO;
+    g_ssl_app_data = NULL;
+    g_on_new_session = NULL;
+    g_on_underlying_io_open_complete = NULL;
+    g_on_underlying_io_open_complete_context = NULL;
+    g_on_underlying_io_send_complete = NULL;
+    g_on_underlying_io_send_complete_context = NULL;
+    g_on_underlying_io_close_complete = NULL;
+    g_on_underlying_io_close_complete_context = NULL;
+    g_ssl_shutdown_mode = 0;
+    g_session_not_resumable = false;
+    g_saved_session = NULL;
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* tlsio_openssl_setoption */
+
+TEST_FUNCTION(tlsio_openssl_setoption_tls_session_takes_a_reference_to_the_session)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SSL_SESSION_up_ref(TEST_SSL_SESSION));
+
+    // act
+    int result = tlsio_interface->concrete_io_setoption(tls_io, OPTION_TLS_SESSION, TEST_SSL_SESSION);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(tlsio_openssl_setoption_tls_session_with_NULL_value_fails)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    umock_c_reset_all_calls();
+
+    // act
+    int result = tlsio_interface->concrete_io_setoption(tls_io, OPTION_TLS_SESSION, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(tlsio_openssl_setoption_tls_session_after_open_fails)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    open_tlsio(tls_io);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = tlsio_interface->concrete_io_setoption(tls_io, OPTION_TLS_SESSION, TEST_SSL_SESSION);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(tlsio_openssl_setoption_tls_session_resumption_false_drops_the_saved_session)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    bool session_resumption = false;
+    (void)tlsio_interface->concrete_io_setoption(tls_io, OPTION_TLS_SESSION, TEST_SSL_SESSION);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SSL_SESSION_free(TEST_SSL_SESSION));
+
+    // act
+    int result = tlsio_interface->concrete_io_setoption(tls_io, OPTION_TLS_SESSION_RESUMPTION, &session_resumption);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+/* tlsio_openssl_open */
+
+TEST_FUNCTION(tlsio_openssl_open_offers_the_saved_session)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    (void)tlsio_interface->concrete_io_setoption(tls_io, OPTION_TLS_SESSION, TEST_SSL_SESSION);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = tlsio_interface->concrete_io_open(tls_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(g_ssl_app_data == tls_io);
+    ASSERT_IS_NOT_NULL(g_on_new_session);
+    ASSERT_IS_TRUE(strstr(umock_c_get_actual_calls(), "[SSL_set_session(0x13,0x16)]") != NULL);
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(tlsio_openssl_open_with_session_resumption_off_offers_no_session)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    bool session_resumption = false;
+    (void)tlsio_interface->concrete_io_setoption(tls_io, OPTION_TLS_SESSION_RESUMPTION, &session_resumption);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = tlsio_interface->concrete_io_open(tls_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_NULL(g_on_new_session);
+    ASSERT_IS_TRUE(strstr(umock_c_get_actual_calls(), "SSL_set_session") == NULL);
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+/* tlsio_openssl_retrieveoptions */
+
+TEST_FUNCTION(tlsio_openssl_retrieveoptions_saves_the_session_reported_by_OpenSSL)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    open_tlsio(tls_io);
+    (void)g_on_new_session(TEST_SSL, TEST_NEW_SSL_SESSION);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(OptionHandler_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(xio_retrieveoptions(TEST_UNDERLYING_IO));
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER, "underlying_io_options", TEST_UNDERLYING_IO_OPTIONS));
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER, OPTION_TLS_SESSION, TEST_NEW_SSL_SESSION));
+
+    // act
+    OPTIONHANDLER_HANDLE result = tlsio_interface->concrete_io_retrieveoptions(tls_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, TEST_OPTIONHANDLER, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(the_session_saved_before_destroy_is_resumed_by_the_next_tlsio)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    open_tlsio(tls_io);
+    (void)g_on_new_session(TEST_SSL, TEST_NEW_SSL_SESSION);
+    OPTIONHANDLER_HANDLE options = tlsio_interface->concrete_io_retrieveoptions(tls_io);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_OPTIONHANDLER, options);
+    ASSERT_ARE_EQUAL(void_ptr, TEST_NEW_SSL_SESSION, g_saved_session);
+    tlsio_interface->concrete_io_destroy(tls_io);
+    tls_io = create_tlsio();
+    (void)tlsio_interface->concrete_io_setoption(tls_io, OPTION_TLS_SESSION, g_saved_session);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = tlsio_interface->concrete_io_open(tls_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(strstr(umock_c_get_actual_calls(), "[SSL_set_session(0x13,0x17)]") != NULL);
+    ASSERT_IS_FALSE(g_session_not_resumable);
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(tlsio_openssl_forced_close_keeps_the_session_resumable)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    (void)tlsio_interface->concrete_io_open(tls_io, test_on_io_open_complete, (void*)0x4242, test_on_bytes_received, (void*)0x4243, test_on_io_error, (void*)0x4244);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = tlsio_interface->concrete_io_close(tls_io, test_on_io_close_complete, (void*)0x4245);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(strstr(umock_c_get_actual_calls(), "[SSL_free(0x13)]") != NULL);
+    ASSERT_IS_FALSE(g_session_not_resumable);
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(tlsio_openssl_retrieveoptions_saves_session_resumption_when_it_is_off)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    bool session_resumption = false;
+    (void)tlsio_interface->concrete_io_setoption(tls_io, OPTION_TLS_SESSION_RESUMPTION, &session_resumption);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(OptionHandler_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(xio_retrieveoptions(TEST_UNDERLYING_IO));
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER, "underlying_io_options", TEST_UNDERLYING_IO_OPTIONS));
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER, OPTION_TLS_SESSION_RESUMPTION, IGNORED_PTR_ARG));
+
+    // act
+    OPTIONHANDLER_HANDLE result = tlsio_interface->concrete_io_retrieveoptions(tls_io);
+
+    // assert
+    ASSERT_ARE_EQUAL(void_ptr, TEST_OPTIONHANDLER, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+/* tlsio_openssl_close */
+
+TEST_FUNCTION(tlsio_openssl_close_sends_close_notify_and_keeps_the_underlying_io_open_until_it_is_sent)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    open_tlsio(tls_io);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SSL_shutdown(TEST_SSL));
+    STRICT_EXPECTED_CALL(BIO_ctrl_pending(TEST_OUT_BIO));
+    STRICT_EXPECTED_CALL(BIO_ctrl_pending(TEST_OUT_BIO));
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_CLOSE_NOTIFY_SIZE));
+    STRICT_EXPECTED_CALL(BIO_read(TEST_OUT_BIO, IGNORED_PTR_ARG, TEST_CLOSE_NOTIFY_SIZE));
+    STRICT_EXPECTED_CALL(xio_send(TEST_UNDERLYING_IO, IGNORED_PTR_ARG, TEST_CLOSE_NOTIFY_SIZE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    int result = tlsio_interface->concrete_io_close(tls_io, test_on_io_close_complete, (void*)0x4245);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(when_the_close_notify_is_sent_tlsio_openssl_closes_the_underlying_io)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    open_tlsio(tls_io);
+    (void)tlsio_interface->concrete_io_close(tls_io, test_on_io_close_complete, (void*)0x4245);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_close(TEST_UNDERLYING_IO, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    // act
+    g_on_underlying_io_send_complete(g_on_underlying_io_send_complete_context, IO_SEND_OK);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    g_on_underlying_io_send_complete = NULL;
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(when_the_underlying_io_closes_after_the_close_notify_the_close_completes)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    open_tlsio(tls_io);
+    (void)tlsio_interface->concrete_io_close(tls_io, test_on_io_close_complete, (void*)0x4245);
+    g_on_underlying_io_send_complete(g_on_underlying_io_send_complete_context, IO_SEND_OK);
+    g_on_underlying_io_send_complete = NULL;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(test_on_io_close_complete((void*)0x4245));
+    STRICT_EXPECTED_CALL(SSL_set_shutdown(TEST_SSL, SSL_SENT_SHUTDOWN));
+    STRICT_EXPECTED_CALL(SSL_free(TEST_SSL));
+    STRICT_EXPECTED_CALL(SSL_CTX_free(TEST_SSL_CTX));
+
+    // act
+    g_on_underlying_io_close_complete(g_on_underlying_io_close_complete_context);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(when_the_close_notify_cannot_be_sent_tlsio_openssl_closes_the_underlying_io_right_away)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    open_tlsio(tls_io);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(SSL_shutdown(TEST_SSL));
+    STRICT_EXPECTED_CALL(BIO_ctrl_pending(TEST_OUT_BIO));
+    STRICT_EXPECTED_CALL(BIO_ctrl_pending(TEST_OUT_BIO));
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_CLOSE_NOTIFY_SIZE));
+    STRICT_EXPECTED_CALL(BIO_read(TEST_OUT_BIO, IGNORED_PTR_ARG, TEST_CLOSE_NOTIFY_SIZE));
+    STRICT_EXPECTED_CALL(xio_send(TEST_UNDERLYING_IO, IGNORED_PTR_ARG, TEST_CLOSE_NOTIFY_SIZE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(xio_close(TEST_UNDERLYING_IO, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    // act
+    int result = tlsio_interface->concrete_io_close(tls_io, test_on_io_close_complete, (void*)0x4245);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    tlsio_interface->concrete_io_destroy(tls_io);
+}
+
+TEST_FUNCTION(tlsio_openssl_destroy_while_the_close_notify_is_queued_does_not_close_the_underlying_io)
+{
+    // arrange
+    const IO_INTERFACE_DESCRIPTION* tlsio_interface = tlsio_openssl_get_interface_description();
+    CONCRETE_IO_HANDLE tls_io = create_tlsio();
+    open_tlsio(tls_io);
+    (void)tlsio_interface->concrete_io_close(tls_io, test_on_io_close_complete, (void*)0x4245);
+    umock_c_reset_all_calls();
+
+    // act
+    tlsio_interface->concrete_io_destroy(tls_io);
+
+    // assert
+    ASSERT_IS_TRUE(strstr(umock_c_get_actual_calls(), "xio_close") == NULL);
+    ASSERT_IS_TRUE(strstr(umock_c_get_actual_calls(), "test_on_io_close_complete") == NULL);
+}
+
+END_TEST_SUITE(tlsio_openssl_ut)
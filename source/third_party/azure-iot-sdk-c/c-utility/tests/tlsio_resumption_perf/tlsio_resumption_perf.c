@@ -0,0 +1,535 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Connects tlsio_openssl repeatedly to a local OpenSSL server, first with full handshakes and then
+   resuming the previous session the way the MQTT and AMQP transports do on reconnect (xio_retrieveoptions
+   from the old tlsio, OptionHandler_FeedOptions into the new one). Reports the average time to open and
+   the bytes exchanged during the handshake for both. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "openssl/ssl.h"
+#include "openssl/evp.h"
+#include "openssl/x509.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/tlsio.h"
+#include "azure_c_shared_utility/tlsio_openssl.h"
+#include "azure_c_shared_utility/socketio.h"
+#include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/threadapi.h"
+
+#define DEFAULT_CONNECTIONS 50
+#define OPEN_TIMEOUT_MS 10000
+
+typedef struct COUNTING_IO_INSTANCE_TAG
+{
+    XIO_HANDLE socket_io;
+    ON_IO_OPEN_COMPLETE on_io_open_complete;
+    void* on_io_open_complete_context;
+    ON_BYTES_RECEIVED on_bytes_received;
+    void* on_bytes_received_context;
+} COUNTING_IO_INSTANCE;
+
+typedef struct SERVER_TAG
+{
+    SSL_CTX* ssl_context;
+    int listen_socket;
+    size_t connections;
+} SERVER;
+
+typedef enum OPEN_STATE_TAG
+{
+    OPEN_STATE_PENDING,
+    OPEN_STATE_OPEN,
+    OPEN_STATE_FAILED
+} OPEN_STATE;
+
+static double now_ms(void)
+{
+    /* tickcounter only has second resolution on Linux, too coarse for a loopback handshake */
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1000.0 + (double)now.tv_nsec / 1000000.0;
+}
+
+static size_t bytes_sent;
+static size_t bytes_received;
+static double underlying_open_time;
+
+static int counting_io_setoption(CONCRETE_IO_HANDLE handle, const char* option_name, const void* value);
+
+static void* counting_io_clone_option(const char* name, const void* value)
+{
+    (void)name;
+    (void)value;
+    return NULL;
+}
+
+static void counting_io_destroy_option(const char* name, const void* value)
+{
+    (void)name;
+    (void)value;
+}
+
+/* a pass-through to socketio that counts what goes over the wire; socketio has no options worth saving */
+static OPTIONHANDLER_HANDLE counting_io_retrieveoptions(CONCRETE_IO_HANDLE handle)
+{
+    (void)handle;
+    return OptionHandler_Create(counting_io_clone_option, counting_io_destroy_option, counting_io_setoption);
+}
+
+static CONCRETE_IO_HANDLE counting_io_create(void* io_create_parameters)
+{
+    COUNTING_IO_INSTANCE* result = (COUNTING_IO_INSTANCE*)malloc(sizeof(COUNTING_IO_INSTANCE));
+    if (result != NULL)
+    {
+        if ((result->socket_io = xio_create(socketio_get_interface_description(), io_create_parameters)) == NULL)
+        {
+            free(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+static void counting_io_destroy(CONCRETE_IO_HANDLE handle)
+{
+    COUNTING_IO_INSTANCE* instance = (COUNTING_IO_INSTANCE*)handle;
+    xio_destroy(instance->socket_io);
+    free(instance);
+}
+
+static void counting_io_on_bytes_received(void* context, const unsigned char* buffer, size_t size)
+{
+    COUNTING_IO_INSTANCE* instance = (COUNTING_IO_INSTANCE*)context;
+    bytes_received += size;
+    instance->on_bytes_received(instance->on_bytes_received_context, buffer, size);
+}
+
+static void counting_io_on_open_complete(void* context, IO_OPEN_RESULT open_result)
+{
+    COUNTING_IO_INSTANCE* instance = (COUNTING_IO_INSTANCE*)context;
+    underlying_open_time = now_ms();
+    instance->on_io_open_complete(instance->on_io_open_complete_context, open_result);
+}
+
+static int counting_io_open(CONCRETE_IO_HANDLE handle, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context)
+{
+    COUNTING_IO_INSTANCE* instance = (COUNTING_IO_INSTANCE*)handle;
+    instance->on_io_open_complete = on_io_open_complete;
+    instance->on_io_open_complete_context = on_io_open_complete_context;
+    instance->on_bytes_received = on_bytes_received;
+    instance->on_bytes_received_context = on_bytes_received_context;
+    return xio_open(instance->socket_io, counting_io_on_open_complete, instance, counting_io_on_bytes_received, instance, on_io_error, on_io_error_context);
+}
+
+static int counting_io_close(CONCRETE_IO_HANDLE handle, ON_IO_CLOSE_COMPLETE on_io_close_complete, void* callback_context)
+{
+    return xio_close(((COUNTING_IO_INSTANCE*)handle)->socket_io, on_io_close_complete, callback_context);
+}
+
+static int counting_io_send(CONCRETE_IO_HANDLE handle, const void* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    bytes_sent += size;
+    return xio_send(((COUNTING_IO_INSTANCE*)handle)->socket_io, buffer, size, on_send_complete, callback_context);
+}
+
+static void counting_io_dowork(CONCRETE_IO_HANDLE handle)
+{
+    xio_dowork(((COUNTING_IO_INSTANCE*)handle)->socket_io);
+}
+
+static int counting_io_setoption(CONCRETE_IO_HANDLE handle, const char* option_name, const void* value)
+{
+    return xio_setoption(((COUNTING_IO_INSTANCE*)handle)->socket_io, option_name, value);
+}
+
+static const IO_INTERFACE_DESCRIPTION counting_io_interface =
+{
+    counting_io_retrieveoptions,
+    counting_io_create,
+    counting_io_destroy,
+    counting_io_open,
+    counting_io_close,
+    counting_io_send,
+    counting_io_dowork,
+    counting_io_setoption
+};
+
+/* a throwaway self-signed certificate, so the benchmark needs no files */
+static X509* create_certificate(EVP_PKEY** key)
+{
+    X509* result = NULL;
+    EVP_PKEY_CTX* key_context = EVP_PKEY_CTX_new_id(EVP_PKEY_RSA, NULL);
+
+    *key = NULL;
+    if ((key_context != NULL) &&
+        (EVP_PKEY_keygen_init(key_context) > 0) &&
+        (EVP_PKEY_CTX_set_rsa_keygen_bits(key_context, 2048) > 0) &&
+        (EVP_PKEY_keygen(key_context, key) > 0) &&
+        ((result = X509_new()) != NULL))
+    {
+        X509_NAME* name = X509_get_subject_name(result);
+
+        if ((X509_set_version(result, 2) != 1) ||
+            (ASN1_INTEGER_set(X509_get_serialNumber(result), 1) != 1) ||
+            (X509_gmtime_adj(X509_get_notBefore(result), -60) == NULL) ||
+            (X509_gmtime_adj(X509_get_notAfter(result), 24 * 60 * 60) == NULL) ||
+            (X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const unsigned char*)"localhost", -1, -1, 0) != 1) ||
+            (X509_set_issuer_name(result, name) != 1) ||
+            (X509_set_pubkey(result, *key) != 1) ||
+            (X509_sign(result, *key, EVP_sha256()) == 0))
+        {
+            X509_free(result);
+            result = NULL;
+        }
+    }
+    EVP_PKEY_CTX_free(key_context);
+
+    return result;
+}
+
+static char* certificate_to_pem(X509* certificate)
+{
+    char* result = NULL;
+    BIO* bio = BIO_new(BIO_s_mem());
+
+    if ((bio != NULL) && (PEM_write_bio_X509(bio, certificate) == 1))
+    {
+        char* data;
+        long length = BIO_get_mem_data(bio, &data);
+
+        if ((result = (char*)malloc((size_t)length + 1)) != NULL)
+        {
+            (void)memcpy(result, data, (size_t)length);
+            result[length] = '\0';
+        }
+    }
+    BIO_free(bio);
+
+    return result;
+}
+
+static int server_thread(void* context)
+{
+    SERVER* server = (SERVER*)context;
+    size_t i;
+
+    for (i = 0; i < server->connections; i++)
+    {
+        int client_socket = accept(server->listen_socket, NULL, NULL);
+        if (client_socket >= 0)
+        {
+            SSL* ssl = SSL_new(server->ssl_context);
+            int no_delay = 1;
+
+            /* keeps delayed ACKs from dominating the loopback timings */
+            (void)setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+            if (ssl != NULL)
+            {
+                (void)SSL_set_fd(ssl, client_socket);
+                if (SSL_accept(ssl) == 1)
+                {
+                    unsigned char buffer[256];
+
+                    /* hold the connection until the client closes it */
+                    while (SSL_read(ssl, buffer, sizeof(buffer)) > 0)
+                    {
+                    }
+                    (void)SSL_shutdown(ssl);
+                }
+                SSL_free(ssl);
+            }
+            (void)close(client_socket);
+        }
+    }
+
+    return 0;
+}
+
+static int start_server(SERVER* server, X509* certificate, EVP_PKEY* key, int* port)
+{
+    int result;
+    struct sockaddr_in address;
+    socklen_t address_length = sizeof(address);
+
+    (void)memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+
+    if ((server->ssl_context = SSL_CTX_new(SSLv23_server_method())) == NULL)
+    {
+        result = __LINE__;
+    }
+    else if ((SSL_CTX_use_certificate(server->ssl_context, certificate) != 1) ||
+        (SSL_CTX_use_PrivateKey(server->ssl_context, key) != 1) ||
+        (SSL_CTX_set_session_id_context(server->ssl_context, (const unsigned char*)"perf", 4) != 1))
+    {
+        SSL_CTX_free(server->ssl_context);
+        result = __LINE__;
+    }
+    else if ((server->listen_socket = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+    {
+        SSL_CTX_free(server->ssl_context);
+        result = __LINE__;
+    }
+    else if ((bind(server->listen_socket, (struct sockaddr*)&address, sizeof(address)) != 0) ||
+        (listen(server->listen_socket, 4) != 0) ||
+        (getsockname(server->listen_socket, (struct sockaddr*)&address, &address_length) != 0))
+    {
+        (void)close(server->listen_socket);
+        SSL_CTX_free(server->ssl_context);
+        result = __LINE__;
+    }
+    else
+    {
+        *port = ntohs(address.sin_port);
+        result = 0;
+    }
+
+    return result;
+}
+
+static void on_open_complete(void* context, IO_OPEN_RESULT open_result)
+{
+    *(OPEN_STATE*)context = (open_result == IO_OPEN_OK) ? OPEN_STATE_OPEN : OPEN_STATE_FAILED;
+}
+
+static void on_close_complete(void* context)
+{
+    *(bool*)context = true;
+}
+
+static void on_bytes_received(void* context, const unsigned char* buffer, size_t size)
+{
+    (void)context;
+    (void)buffer;
+    (void)size;
+}
+
+static void on_io_error(void* context)
+{
+    *(OPEN_STATE*)context = OPEN_STATE_FAILED;
+}
+
+/* opens and closes one connection; *options carries the previous connection's options in and this one's out */
+static int connect_once(const TLSIO_CONFIG* config, const char* trusted_certificate, bool resume, OPTIONHANDLER_HANDLE* options, double* open_ms, double* handshake_ms, size_t* handshake_bytes)
+{
+    int result;
+    XIO_HANDLE tlsio = xio_create(tlsio_openssl_get_interface_description(), config);
+    int tls_version = 12;
+
+    if (tlsio == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        OPEN_STATE open_state = OPEN_STATE_PENDING;
+        bool closed = false;
+        double start_time;
+        double now;
+
+        if (*options != NULL)
+        {
+            result = (OptionHandler_FeedOptions(*options, tlsio) == OPTIONHANDLER_OK) ? 0 : __LINE__;
+            OptionHandler_Destroy(*options);
+            *options = NULL;
+        }
+        else
+        {
+            result = ((xio_setoption(tlsio, OPTION_TRUSTED_CERT, trusted_certificate) != 0) ||
+                (xio_setoption(tlsio, OPTION_TLS_VERSION, &tls_version) != 0) ||
+                (xio_setoption(tlsio, OPTION_TLS_SESSION_RESUMPTION, &resume) != 0)) ? __LINE__ : 0;
+        }
+
+        bytes_sent = 0;
+        bytes_received = 0;
+        start_time = now_ms();
+        now = start_time;
+
+        if ((result == 0) &&
+            (xio_open(tlsio, on_open_complete, &open_state, on_bytes_received, NULL, on_io_error, &open_state) != 0))
+        {
+            result = __LINE__;
+        }
+
+        while ((result == 0) && (open_state == OPEN_STATE_PENDING) && (now - start_time < OPEN_TIMEOUT_MS))
+        {
+            xio_dowork(tlsio);
+            now = now_ms();
+        }
+
+        if (result == 0)
+        {
+            if (open_state != OPEN_STATE_OPEN)
+            {
+                (void)printf("open failed\r\n");
+                result = __LINE__;
+            }
+            else
+            {
+                /* open covers creating the SSL context as well, the handshake only starts once the socket is connected */
+                *open_ms = now - start_time;
+                *handshake_ms = now - underlying_open_time;
+                *handshake_bytes = bytes_sent + bytes_received;
+                /* what a transport saves before tearing the connection down */
+                *options = xio_retrieveoptions(tlsio);
+            }
+        }
+
+        /* only an open tlsio reports the end of its close */
+        if ((open_state == OPEN_STATE_OPEN) && (xio_close(tlsio, on_close_complete, &closed) == 0))
+        {
+            while (!closed)
+            {
+                xio_dowork(tlsio);
+            }
+        }
+        xio_destroy(tlsio);
+    }
+
+    return result;
+}
+
+static int run_connections(const TLSIO_CONFIG* config, const char* trusted_certificate, bool resume, size_t connections)
+{
+    int result = 0;
+    OPTIONHANDLER_HANDLE options = NULL;
+    double total_open_ms = 0.0;
+    double total_handshake_ms = 0.0;
+    size_t total_bytes = 0;
+    size_t i;
+
+    /* the first connection is a full handshake either way, it only seeds the session */
+    for (i = 0; (result == 0) && (i <= connections); i++)
+    {
+        double open_ms = 0.0;
+        double handshake_ms = 0.0;
+        size_t handshake_bytes = 0;
+
+        result = connect_once(config, trusted_certificate, resume, &options, &open_ms, &handshake_ms, &handshake_bytes);
+        if ((result == 0) && (i > 0))
+        {
+            total_open_ms += open_ms;
+            total_handshake_ms += handshake_ms;
+            total_bytes += handshake_bytes;
+        }
+    }
+
+    if (options != NULL)
+    {
+        OptionHandler_Destroy(options);
+    }
+
+    if (result == 0)
+    {
+        (void)printf("%-8s %4lu connections: open %8.2f ms, handshake %8.2f ms, %6lu handshake bytes per connection\r\n",
+            resume ? "resumed" : "full", (unsigned long)connections, total_open_ms / (double)connections,
+            total_handshake_ms / (double)connections, (unsigned long)(total_bytes / connections));
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    size_t connections = DEFAULT_CONNECTIONS;
+
+    if (argc > 1)
+    {
+        connections = (size_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (connections == 0)
+    {
+        (void)printf("usage: tlsio_resumption_perf [connections per run]\r\n");
+        result = __LINE__;
+    }
+    else if (platform_init() != 0)
+    {
+        (void)printf("platform_init failed\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        EVP_PKEY* key;
+        X509* certificate = create_certificate(&key);
+        char* trusted_certificate = (certificate == NULL) ? NULL : certificate_to_pem(certificate);
+        SERVER server;
+        int port;
+
+        if (trusted_certificate == NULL)
+        {
+            (void)printf("setup failed\r\n");
+            result = __LINE__;
+        }
+        else if ((result = start_server(&server, certificate, key, &port)) != 0)
+        {
+            (void)printf("starting the local TLS server failed\r\n");
+        }
+        else
+        {
+            THREAD_HANDLE thread;
+            SOCKETIO_CONFIG socketio_config;
+            TLSIO_CONFIG tlsio_config;
+
+            socketio_config.hostname = "127.0.0.1";
+            socketio_config.port = port;
+            socketio_config.accepted_socket = NULL;
+            tlsio_config.hostname = "127.0.0.1";
+            tlsio_config.port = port;
+            tlsio_config.underlying_io_interface = &counting_io_interface;
+            tlsio_config.underlying_io_parameters = &socketio_config;
+
+            server.connections = 2 * (connections + 1);
+            if (ThreadAPI_Create(&thread, server_thread, &server) != THREADAPI_OK)
+            {
+                (void)printf("starting the server thread failed\r\n");
+                result = __LINE__;
+            }
+            else
+            {
+                int server_result;
+
+                result = run_connections(&tlsio_config, trusted_certificate, false, connections);
+                if (result == 0)
+                {
+                    result = run_connections(&tlsio_config, trusted_certificate, true, connections);
+                }
+
+                /* a failed run leaves the server waiting for connections that never come */
+                if (result != 0)
+                {
+                    (void)shutdown(server.listen_socket, SHUT_RDWR);
+                }
+                (void)ThreadAPI_Join(thread, &server_result);
+            }
+
+            (void)close(server.listen_socket);
+            SSL_CTX_free(server.ssl_context);
+        }
+
+        free(trusted_certificate);
+        X509_free(certificate);
+        EVP_PKEY_free(key);
+        platform_deinit();
+    }
+
+    return result;
+}
@@ -57,6 +57,7 @@ static TEST_MUTEX_HANDLE g_dllByDll;
 static WOLFSSL_METHOD* TEST_WOLFSSL_CLIENT_METHOD = (WOLFSSL_METHOD*)0x0011;
 static WOLFSSL_CTX* TEST_WOLFSSL_CTX = (WOLFSSL_CTX*)0x0012;
 static WOLFSSL* TEST_WOLFSSL = (WOLFSSL*)0x0013;
+static WOLFSSL_SESSION* TEST_WOLFSSL_SESSION = (WOLFSSL_SESSION*)0x0016;
 static const IO_INTERFACE_DESCRIPTION* TEST_SOCKETIO_INTERFACE_DESCRIPTION = (const IO_INTERFACE_DESCRIPTION*)0x0014;
 static XIO_HANDLE TEST_IO_HANDLE = (XIO_HANDLE)0x0015;
 static const unsigned char TEST_BUFFER[] = { 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA };
@@ -115,6 +116,10 @@ MOCK_FUNCTION_WITH_CODE(WOLFSSL_API, int, wolfSSL_SetHsDoneCb, WOLFSSL*, ssl, Ha
     g_handshake_done_cb = hs_cb;
     g_handshake_done_ctx = ctx;
 MOCK_FUNCTION_END(0)
+MOCK_FUNCTION_WITH_CODE(WOLFSSL_API, WOLFSSL_SESSION*, wolfSSL_get_session, WOLFSSL*, ssl)
+MOCK_FUNCTION_END(TEST_WOLFSSL_SESSION)
+MOCK_FUNCTION_WITH_CODE(WOLFSSL_API, int, wolfSSL_set_session, WOLFSSL*, ssl, WOLFSSL_SESSION*, session)
+MOCK_FUNCTION_END(SSL_SUCCESS)
 #ifdef HAVE_SECURE_RENEGOTIATION
 MOCK_FUNCTION_WITH_CODE(WOLFSSL_API, int, wolfSSL_UseSecureRenegotiation, WOLFSSL*, ssl)
 MOCK_FUNCTION_END(0)
@@ -368,6 +373,83 @@ TEST_FUNCTION(tlsio_wolfssl_on_handshake_done_succeed)
     tlsio_wolfssl_destroy(io_handle);
 }
 
+TEST_FUNCTION(tlsio_wolfssl_on_handshake_done_saves_session)
+{
+    //arrange
+    TLSIO_CONFIG tls_io_config;
+    memset(&tls_io_config, 0, sizeof(tls_io_config));
+    CONCRETE_IO_HANDLE io_handle = tlsio_wolfssl_create(&tls_io_config);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_open(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(wolfSSL_connect(TEST_WOLFSSL));
+    STRICT_EXPECTED_CALL(wolfSSL_get_session(TEST_WOLFSSL));
+
+    //act
+    int test_result = tlsio_wolfssl_open(io_handle, on_io_open_complete, NULL, on_bytes_recv, NULL, on_error, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, test_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //clean
+    (void)tlsio_wolfssl_close(io_handle, on_close_complete, NULL);
+    tlsio_wolfssl_destroy(io_handle);
+}
+
+TEST_FUNCTION(tlsio_wolfssl_open_offers_tls_session)
+{
+    //arrange
+    TLSIO_CONFIG tls_io_config;
+    memset(&tls_io_config, 0, sizeof(tls_io_config));
+    CONCRETE_IO_HANDLE io_handle = tlsio_wolfssl_create(&tls_io_config);
+    (void)tlsio_wolfssl_setoption(io_handle, OPTION_TLS_SESSION, TEST_WOLFSSL_SESSION);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(wolfSSL_set_session(TEST_WOLFSSL, TEST_WOLFSSL_SESSION));
+    STRICT_EXPECTED_CALL(xio_open(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(wolfSSL_connect(TEST_WOLFSSL));
+    STRICT_EXPECTED_CALL(wolfSSL_get_session(TEST_WOLFSSL));
+
+    //act
+    int test_result = tlsio_wolfssl_open(io_handle, on_io_open_complete, NULL, on_bytes_recv, NULL, on_error, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, test_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //clean
+    (void)tlsio_wolfssl_close(io_handle, on_close_complete, NULL);
+    tlsio_wolfssl_destroy(io_handle);
+}
+
+TEST_FUNCTION(tlsio_wolfssl_open_session_resumption_off_does_not_offer_tls_session)
+{
+    //arrange
+    bool session_resumption = false;
+    TLSIO_CONFIG tls_io_config;
+    memset(&tls_io_config, 0, sizeof(tls_io_config));
+    CONCRETE_IO_HANDLE io_handle = tlsio_wolfssl_create(&tls_io_config);
+    (void)tlsio_wolfssl_setoption(io_handle, OPTION_TLS_SESSION, TEST_WOLFSSL_SESSION);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(xio_open(TEST_IO_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(wolfSSL_connect(TEST_WOLFSSL));
+
+    //act
+    int test_result = tlsio_wolfssl_setoption(io_handle, OPTION_TLS_SESSION_RESUMPTION, &session_resumption);
+    ASSERT_ARE_EQUAL(int, 0, test_result);
+    test_result = tlsio_wolfssl_open(io_handle, on_io_open_complete, NULL, on_bytes_recv, NULL, on_error, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, test_result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //clean
+    (void)tlsio_wolfssl_close(io_handle, on_close_complete, NULL);
+    tlsio_wolfssl_destroy(io_handle);
+}
+
 TEST_FUNCTION(tlsio_wolfssl_close_handle_NULL_fail)
 {
     //arrange
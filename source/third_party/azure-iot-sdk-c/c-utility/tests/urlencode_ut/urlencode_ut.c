@@ -5,10 +5,12 @@
 #include <cstdlib>
 #include <cstdio>
 #include <cstddef>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stdio.h>
 #include <stddef.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -584,4 +586,239 @@ TEST_FUNCTION(URL_Exhaustive_chars)
     }
 }
 
+/*Tests_SRS_URL_ENCODE_99_001: [ If text is NULL then URL_EncodedLength shall return 0. ]*/
+TEST_FUNCTION(URL_EncodedLength_with_NULL_text_returns_0)
+{
+    // arrange
+    // act
+    size_t length = URL_EncodedLength(NULL, 10);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 0, length);
+}
+
+/*Tests_SRS_URL_ENCODE_99_002: [ URL_EncodedLength shall return the count of characters the encoding of the first textLength characters of text takes, not counting a terminating '\0'. ]*/
+TEST_FUNCTION(URL_EncodedLength_counts_escapes)
+{
+    // arrange
+    const char* text = "a b\xe9/";
+
+    // act
+    size_t length = URL_EncodedLength(text, 4);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 11, length);
+}
+
+/*Tests_SRS_URL_ENCODE_99_002: [ URL_EncodedLength shall return the count of characters the encoding of the first textLength characters of text takes, not counting a terminating '\0'. ]*/
+TEST_FUNCTION(URL_EncodedLength_of_unreserved_chars_is_the_text_length)
+{
+    // arrange
+    // act
+    size_t length = URL_EncodedLength(UNRESERVED_CHAR, strlen(UNRESERVED_CHAR));
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, strlen(UNRESERVED_CHAR), length);
+}
+
+/*Tests_SRS_URL_ENCODE_99_003: [ If text or destination is NULL then URL_EncodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(URL_EncodeInto_with_NULL_text_fails)
+{
+    // arrange
+    char destination[16];
+
+    // act
+    int result = URL_EncodeInto(NULL, 0, destination, sizeof(destination), NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_URL_ENCODE_99_003: [ If text or destination is NULL then URL_EncodeInto shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(URL_EncodeInto_with_NULL_destination_fails)
+{
+    // arrange
+    // act
+    int result = URL_EncodeInto("abc", 3, NULL, 16, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_URL_ENCODE_99_004: [ If destinationSize is smaller than the encoded length plus one then URL_EncodeInto shall fail and return a non-zero value without writing to destination. ]*/
+TEST_FUNCTION(URL_EncodeInto_with_destination_too_small_fails)
+{
+    // arrange
+    char destination[14] = "untouched";
+
+    // act
+    int result = URL_EncodeInto("hello world!", 12, destination, sizeof(destination), NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "untouched", destination);
+}
+
+/*Tests_SRS_URL_ENCODE_99_006: [ On success URL_EncodeInto shall write the encoding of the first textLength characters of text followed by '\0' to destination, store the encoded length in encodedLength when it is not NULL and return 0. ]*/
+TEST_FUNCTION(URL_EncodeInto_with_destination_of_exact_size_succeeds)
+{
+    // arrange
+    char destination[16];
+    size_t encodedLength = 0;
+
+    // act
+    int result = URL_EncodeInto("hello world!", 12, destination, sizeof(destination), &encodedLength);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "hello%20world!", destination);
+    ASSERT_ARE_EQUAL(size_t, 14, encodedLength);
+}
+
+/*Tests_SRS_URL_ENCODE_99_005: [ If no character of the text needs escaping the text is copied as it is, without being encoded. ]*/
+TEST_FUNCTION(URL_EncodeInto_encodes_only_textLength_characters)
+{
+    // arrange
+    char destination[16];
+    size_t encodedLength = 0;
+
+    // act
+    int result = URL_EncodeInto("device1/modules", 7, destination, sizeof(destination), &encodedLength);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "device1", destination);
+    ASSERT_ARE_EQUAL(size_t, 7, encodedLength);
+}
+
+/*Tests_SRS_URL_ENCODE_99_006: [ On success URL_EncodeInto shall write the encoding of the first textLength characters of text followed by '\0' to destination, store the encoded length in encodedLength when it is not NULL and return 0. ]*/
+TEST_FUNCTION(URL_EncodeInto_Exhaustive_chars)
+{
+    size_t i;
+    size_t numberOfTests = sizeof(testVector) / sizeof(testVector[i]);
+    for (i = 0; i < numberOfTests; i++)
+    {
+        //arrange
+        char destination[8];
+        int result;
+
+        //act
+        result = URL_EncodeInto(testVector[i].inputData, 1, destination, sizeof(destination), NULL);
+
+        //assert
+        ASSERT_ARE_EQUAL(int, 0, result);
+        ASSERT_ARE_EQUAL(char_ptr, testVector[i].expectedOutput, destination);
+    }
+}
+
+/*Tests_SRS_URL_ENCODE_99_007: [ If destination or text is NULL then URL_EncodeConcat shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(URL_EncodeConcat_with_NULL_destination_fails)
+{
+    // arrange
+    // act
+    int result = URL_EncodeConcat(NULL, "abc");
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+}
+
+/*Tests_SRS_URL_ENCODE_99_007: [ If destination or text is NULL then URL_EncodeConcat shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(URL_EncodeConcat_with_NULL_text_fails)
+{
+    // arrange
+    STRING_HANDLE destination = STRING_construct("/devices/");
+
+    // act
+    int result = URL_EncodeConcat(destination, NULL);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/devices/", STRING_c_str(destination));
+    STRING_delete(destination);
+}
+
+/*Tests_SRS_URL_ENCODE_99_005: [ If no character of the text needs escaping the text is copied as it is, without being encoded. ]*/
+/*Tests_SRS_URL_ENCODE_99_008: [ URL_EncodeConcat shall append the encoding of text to destination and return 0. ]*/
+TEST_FUNCTION(URL_EncodeConcat_appends_text_that_needs_no_escaping)
+{
+    // arrange
+    STRING_HANDLE destination = STRING_construct("/devices/");
+
+    // act
+    int result = URL_EncodeConcat(destination, UNRESERVED_CHAR);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/devices/ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-._", STRING_c_str(destination));
+    STRING_delete(destination);
+}
+
+/*Tests_SRS_URL_ENCODE_99_008: [ URL_EncodeConcat shall append the encoding of text to destination and return 0. ]*/
+TEST_FUNCTION(URL_EncodeConcat_appends_encoded_text)
+{
+    // arrange
+    STRING_HANDLE destination = STRING_construct("/devices/");
+
+    // act
+    int result = URL_EncodeConcat(destination, "/getalarm('Le Pichet')");
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, "/devices/%2fgetalarm(%27Le%20Pichet%27)", STRING_c_str(destination));
+    STRING_delete(destination);
+}
+
+/*Tests_SRS_URL_ENCODE_99_008: [ URL_EncodeConcat shall append the encoding of text to destination and return 0. ]*/
+TEST_FUNCTION(URL_EncodeConcat_appends_long_encoded_text)
+{
+    // arrange
+    char text[101];
+    char expected[301];
+    STRING_HANDLE destination = STRING_new();
+    int result;
+    size_t i;
+
+    for (i = 0; i < 100; i++)
+    {
+        text[i] = '/';
+        expected[i * 3] = '%';
+        expected[i * 3 + 1] = '2';
+        expected[i * 3 + 2] = 'f';
+    }
+    text[100] = '\0';
+    expected[300] = '\0';
+
+    // act
+    result = URL_EncodeConcat(destination, text);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, expected, STRING_c_str(destination));
+    STRING_delete(destination);
+}
+
+/*Tests_SRS_URL_ENCODE_99_009: [ If any error occurs URL_EncodeConcat shall fail and return a non-zero value, leaving destination as it was. ]*/
+TEST_FUNCTION(URL_EncodeConcat_when_allocating_the_encoding_fails_fails)
+{
+    // arrange
+    char text[101];
+    STRING_HANDLE destination = STRING_construct("/devices/");
+    int result;
+
+    (void)memset(text, ' ', 100);
+    text[100] = '\0';
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = URL_EncodeConcat(destination, text);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, "/devices/", STRING_c_str(destination));
+    STRING_delete(destination);
+}
+
 END_TEST_SUITE(URLEncode_UnitTests)
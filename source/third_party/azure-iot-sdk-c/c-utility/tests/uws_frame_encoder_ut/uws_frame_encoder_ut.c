@@ -1420,4 +1420,152 @@ TEST_FUNCTION(uws_frame_encoder_encode_masks_a_8_byte_frame_with_different_mask_
     real_BUFFER_delete(result);
 }
 
+/* uws_frame_encoder_get_encoded_size */
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_001: [ `uws_frame_encoder_get_encoded_size` shall return the number of bytes needed to encode a frame with a `length` bytes payload, including the masking key when `is_masked` is true. ]*/
+TEST_FUNCTION(uws_frame_encoder_get_encoded_size_accounts_for_length_encoding_and_mask)
+{
+    // arrange
+
+    // act
+    size_t size_0 = uws_frame_encoder_get_encoded_size(0, false);
+    size_t size_125_masked = uws_frame_encoder_get_encoded_size(125, true);
+    size_t size_126 = uws_frame_encoder_get_encoded_size(126, false);
+    size_t size_65536_masked = uws_frame_encoder_get_encoded_size(65536, true);
+
+    // assert
+    ASSERT_ARE_EQUAL(size_t, 2, size_0);
+    ASSERT_ARE_EQUAL(size_t, 131, size_125_masked);
+    ASSERT_ARE_EQUAL(size_t, 130, size_126);
+    ASSERT_ARE_EQUAL(size_t, 65550, size_65536_masked);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* uws_frame_encoder_encode_into */
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_002: [ `uws_frame_encoder_encode_into` shall encode the frame exactly as `uws_frame_encoder_encode` does, but into the first `uws_frame_encoder_get_encoded_size` bytes of `destination`, and return 0. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_into_encodes_an_unmasked_frame)
+{
+    // arrange
+    unsigned char destination[8];
+    unsigned char payload[] = { 0x42, 0x43 };
+    unsigned char expected_bytes[] = { 0x81, 0x02, 0x42, 0x43 };
+    int result;
+
+    // act
+    result = uws_frame_encoder_encode_into(destination, sizeof(destination), WS_TEXT_FRAME, payload, sizeof(payload), false, true, 0);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    stringify_bytes(expected_bytes, sizeof(expected_bytes), expected_encoded_str, sizeof(expected_encoded_str));
+    stringify_bytes(destination, sizeof(expected_bytes), actual_encoded_str, sizeof(actual_encoded_str));
+    ASSERT_ARE_EQUAL(char_ptr, expected_encoded_str, actual_encoded_str);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_002: [ `uws_frame_encoder_encode_into` shall encode the frame exactly as `uws_frame_encoder_encode` does, but into the first `uws_frame_encoder_get_encoded_size` bytes of `destination`, and return 0. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_99_007: [ The payload shall be masked a machine word at a time, with the remaining bytes masked one at a time. ]*/
+/* Tests_SRS_UWS_FRAME_ENCODER_01_053: [ In order to obtain a 32 bit value for masking, `gb_rand` shall be used 4 times (for each byte). ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_into_masks_a_19_byte_payload_from_an_unaligned_offset)
+{
+    // arrange
+    unsigned char destination[32];
+    unsigned char payload[20];
+    unsigned char mask[] = { 0x00, 0xFF, 0xAA, 0x42 };
+    size_t i;
+    int result;
+
+    for (i = 0; i < sizeof(payload); i++)
+    {
+        payload[i] = (unsigned char)(i * 17);
+    }
+
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x00);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0xFF);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0xAA);
+    STRICT_EXPECTED_CALL(gb_rand())
+        .SetReturn(0x42);
+
+    // act
+    result = uws_frame_encoder_encode_into(destination, sizeof(destination), WS_BINARY_FRAME, payload + 1, 19, true, true, 0);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(int, 0x82, (int)destination[0]);
+    ASSERT_ARE_EQUAL(int, 0x93, (int)destination[1]);
+    for (i = 0; i < 4; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)mask[i], (int)destination[2 + i]);
+    }
+    for (i = 0; i < 19; i++)
+    {
+        ASSERT_ARE_EQUAL(int, (int)(payload[1 + i] ^ mask[i % 4]), (int)destination[6 + i]);
+    }
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_003: [ If `destination` is NULL, `uws_frame_encoder_encode_into` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_into_with_NULL_destination_fails)
+{
+    // arrange
+    unsigned char payload[] = { 0x42 };
+    int result;
+
+    // act
+    result = uws_frame_encoder_encode_into(NULL, 16, WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_004: [ If `destination_size` is smaller than the size returned by `uws_frame_encoder_get_encoded_size`, `uws_frame_encoder_encode_into` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_into_with_destination_too_small_fails)
+{
+    // arrange
+    unsigned char destination[6];
+    unsigned char payload[] = { 0x42 };
+    int result;
+
+    // act
+    result = uws_frame_encoder_encode_into(destination, sizeof(destination), WS_BINARY_FRAME, payload, sizeof(payload), true, true, 0);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_005: [ If `reserved` has any bits set except the lowest 3 then `uws_frame_encoder_encode_into` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_into_with_bad_reserved_fails)
+{
+    // arrange
+    unsigned char destination[16];
+    int result;
+
+    // act
+    result = uws_frame_encoder_encode_into(destination, sizeof(destination), WS_BINARY_FRAME, NULL, 0, true, true, 8);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_UWS_FRAME_ENCODER_99_006: [ If `length` is greater than 0 and payload is NULL, then `uws_frame_encoder_encode_into` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(uws_frame_encoder_encode_into_with_NULL_payload_and_non_zero_length_fails)
+{
+    // arrange
+    unsigned char destination[16];
+    int result;
+
+    // act
+    result = uws_frame_encoder_encode_into(destination, sizeof(destination), WS_BINARY_FRAME, NULL, 1, true, true, 0);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 END_TEST_SUITE(uws_frame_encoder_ut)
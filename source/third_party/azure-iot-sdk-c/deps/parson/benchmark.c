@@ -0,0 +1,125 @@
+/*
+ Times building, parsing and serializing objects with many members, and parsing a twin document
+ with and without an arena. Build and run with "make bench".
+*/
+
+#include "parson.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static size_t allocations;
+
+static void *counting_malloc(size_t size) {
+    allocations++;
+    return malloc(size);
+}
+
+static double elapsed_ms(clock_t start) {
+    return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+static void bench_members(size_t count, int rounds) {
+    char name[32];
+    JSON_Value *value = NULL;
+    JSON_Value *parsed = NULL;
+    char *serialized = NULL;
+    double build_ms = 0, parse_ms = 0, serialize_ms = 0;
+    clock_t start;
+    size_t i;
+    int round;
+
+    for (round = 0; round < rounds; round++) {
+        start = clock();
+        value = json_value_init_object();
+        for (i = 0; i < count; i++) {
+            sprintf(name, "property%u", (unsigned)i);
+            json_object_set_number(json_value_get_object(value), name, (double)i);
+        }
+        build_ms += elapsed_ms(start);
+
+        start = clock();
+        serialized = json_serialize_to_string(value);
+        serialize_ms += elapsed_ms(start);
+
+        start = clock();
+        parsed = json_parse_string(serialized);
+        parse_ms += elapsed_ms(start);
+
+        json_free_serialized_string(serialized);
+        json_value_free(parsed);
+        json_value_free(value);
+    }
+
+    printf("%8u members: build %9.3f ms, parse %9.3f ms, serialize %9.3f ms\n",
+        (unsigned)count, build_ms / rounds, parse_ms / rounds, serialize_ms / rounds);
+}
+
+static char *make_twin(size_t properties) {
+    char name[32];
+    JSON_Value *twin = json_value_init_object();
+    JSON_Object *root = json_value_get_object(twin);
+    char *result;
+    size_t i;
+    for (i = 0; i < properties; i++) {
+        sprintf(name, "desired.property%u", (unsigned)i);
+        json_object_dotset_string(root, name, "some \"quoted\" value\n");
+        sprintf(name, "reported.property%u", (unsigned)i);
+        json_object_dotset_number(root, name, 12.5 * (double)i);
+    }
+    json_object_dotset_number(root, "desired.$version", 42);
+    json_object_dotset_number(root, "reported.$version", 17);
+    result = json_serialize_to_string(twin);
+    json_value_free(twin);
+    return result;
+}
+
+static void bench_arena(size_t properties, int rounds) {
+    char *twin = make_twin(properties);
+    JSON_Value *parsed = NULL;
+    size_t heap_allocations = 0, arena_allocations = 0;
+    double heap_ms = 0, arena_ms = 0;
+    clock_t start;
+    int round;
+
+    start = clock();
+    allocations = 0;
+    for (round = 0; round < rounds; round++) {
+        parsed = json_parse_string(twin);
+        json_object_dotget_string(json_value_get_object(parsed), "desired.property0");
+        json_value_free(parsed);
+    }
+    heap_ms = elapsed_ms(start) / rounds;
+    heap_allocations = allocations / rounds;
+
+    start = clock();
+    allocations = 0;
+    for (round = 0; round < rounds; round++) {
+        parsed = json_parse_string_with_arena(twin);
+        json_object_dotget_string(json_value_get_object(parsed), "desired.property0");
+        json_value_free(parsed);
+    }
+    arena_ms = elapsed_ms(start) / rounds;
+    arena_allocations = allocations / rounds;
+
+    printf("%8u bytes: heap %8.4f ms %6u allocations, arena %8.4f ms %6u allocations\n",
+        (unsigned)strlen(twin), heap_ms, (unsigned)heap_allocations, arena_ms, (unsigned)arena_allocations);
+    json_free_serialized_string(twin);
+}
+
+int main(void) {
+    bench_members(8, 10000);
+    bench_members(64, 2000);
+    bench_members(1000, 100);
+    bench_members(10000, 10);
+    bench_members(50000, 2);
+
+    json_set_allocation_functions(counting_malloc, free);
+    bench_arena(4, 20000);
+    bench_arena(32, 5000);
+    bench_arena(256, 500);
+    bench_arena(4096, 20);
+    return 0;
+}
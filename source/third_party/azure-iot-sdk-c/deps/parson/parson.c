@@ -42,6 +42,18 @@
 #define STARTING_CAPACITY 16
 #define MAX_NESTING       2048
 #define FLOAT_FORMAT      "%1.17g"
+#define NUM_BUF_SIZE      64 /* large enough for any double printed with FLOAT_FORMAT */
+#define OUTPUT_STARTING_CAPACITY 256
+
+/* Objects with at least this many names get a hashed index of their names, smaller ones are
+ * searched linearly. The index is an open addressing table that is never more than half full. */
+#define OBJECT_INDEX_THRESHOLD 16
+
+/* The first chunk of an arena holds the copy of the parsed text and, usually, all of its values.
+ * Arena objects and arrays are not trimmed after parsing, so they start small. */
+#define ARENA_SIZE_FACTOR        4
+#define ARENA_MIN_CHUNK_SIZE     1024
+#define ARENA_STARTING_CAPACITY  4
 
 #define SIZEOF_TOKEN(a)       (sizeof(a) - 1)
 #define SKIP_CHAR(str)        ((*str)++)
@@ -66,8 +78,11 @@ typedef union json_value_value {
     int          null;
 } JSON_Value_Value;
 
+typedef struct json_arena_t JSON_Arena;
+
 struct json_value_t {
     JSON_Value      *parent;
+    JSON_Arena      *arena; /* NULL unless the value was parsed by json_parse_string_with_arena */
     JSON_Value_Type  type;
     JSON_Value_Value value;
 };
@@ -76,6 +91,8 @@ struct json_object_t {
     JSON_Value  *wrapping_value;
     char       **names;
     JSON_Value **values;
+    size_t      *index;          /* positions + 1 of the names, 0 marks an empty cell */
+    size_t       index_capacity; /* power of 2 */
     size_t       count;
     size_t       capacity;
 };
@@ -87,6 +104,32 @@ struct json_array_t {
     size_t       capacity;
 };
 
+/* An arena is a list of chunks that are allocated with parson_malloc and handed out front to back.
+ * Nothing is freed before the whole arena, which lives at the start of its first chunk. */
+typedef union json_arena_align_t {
+    double  number;
+    void   *pointer;
+    size_t  size;
+} JSON_Arena_Align;
+
+#define ARENA_ALIGN(n) (((n) + sizeof(JSON_Arena_Align) - 1) / sizeof(JSON_Arena_Align) * sizeof(JSON_Arena_Align))
+
+typedef struct json_arena_chunk_t {
+    struct json_arena_chunk_t *previous;
+    size_t                     size; /* bytes after the header */
+    size_t                     used;
+} JSON_Arena_Chunk;
+
+#define ARENA_CHUNK_HEADER_SIZE ARENA_ALIGN(sizeof(JSON_Arena_Chunk))
+
+struct json_arena_t {
+    JSON_Arena_Chunk *chunk; /* newest chunk, the only one allocations are made from */
+    JSON_Value       *root;
+};
+
+/* Values inside an arena are read-only. */
+#define IS_IN_ARENA(container) ((container)->wrapping_value->arena != NULL)
+
 /* Various */
 static char * read_file(const char *filename);
 static void   remove_comments(char *string, const char *start_token, const char *end_token);
@@ -98,12 +141,26 @@ static int    num_bytes_in_utf8_sequence(unsigned char c);
 static int    verify_utf8_sequence(const unsigned char *string, int *len);
 static int    is_valid_utf8(const char *string, size_t string_len);
 static int    is_decimal(const char *string, size_t length);
+static unsigned long hash_string(const char *string, size_t n);
+
+/* Arena */
+static JSON_Arena_Chunk * json_arena_chunk_new(JSON_Arena_Chunk *previous, size_t size);
+static JSON_Arena * json_arena_create(size_t size);
+static void *       json_arena_alloc(JSON_Arena *arena, size_t size);
+static void         json_arena_free(JSON_Arena *arena);
+static void *       json_alloc(JSON_Arena *arena, size_t size);
+static void         json_release(JSON_Arena *arena, void *ptr);
 
 /* JSON Object */
 static JSON_Object * json_object_init(JSON_Value *wrapping_value);
 static JSON_Status   json_object_add(JSON_Object *object, const char *name, JSON_Value *value);
 static JSON_Status   json_object_resize(JSON_Object *object, size_t new_capacity);
 static JSON_Value  * json_object_nget_value(const JSON_Object *object, const char *name, size_t n);
+static size_t        json_object_find(const JSON_Object *object, const char *name, size_t n);
+static void          json_object_index_insert(JSON_Object *object, size_t position);
+static size_t        json_object_index_capacity(size_t count);
+static JSON_Status   json_object_index_build(JSON_Object *object, size_t index_capacity);
+static void          json_object_index_free(JSON_Object *object);
 static void          json_object_free(JSON_Object *object);
 
 /* JSON Array */
@@ -113,26 +170,39 @@ static JSON_Status  json_array_resize(JSON_Array *array, size_t new_capacity);
 static void         json_array_free(JSON_Array *array);
 
 /* JSON Value */
-static JSON_Value * json_value_init_string_no_copy(char *string);
+static JSON_Value * json_value_alloc(JSON_Arena *arena, JSON_Value_Type type);
+static JSON_Value * json_value_init_container(JSON_Arena *arena, JSON_Value_Type type);
+static JSON_Value * json_value_init_string_no_copy(char *string, JSON_Arena *arena);
 
 /* Parser */
 static JSON_Status  skip_quotes(const char **string);
 static int          parse_utf16(const char **unprocessed, char **processed);
-static char *       process_string(const char *input, size_t len);
-static char *       get_quoted_string(const char **string);
-static JSON_Value * parse_object_value(const char **string, size_t nesting);
-static JSON_Value * parse_array_value(const char **string, size_t nesting);
-static JSON_Value * parse_string_value(const char **string);
-static JSON_Value * parse_boolean_value(const char **string);
-static JSON_Value * parse_number_value(const char **string);
-static JSON_Value * parse_null_value(const char **string);
-static JSON_Value * parse_value(const char **string, size_t nesting);
+static char *       process_string(const char *input, size_t len, JSON_Arena *arena);
+static char *       get_quoted_string(const char **string, JSON_Arena *arena);
+static JSON_Value * parse_object_value(const char **string, size_t nesting, JSON_Arena *arena);
+static JSON_Value * parse_array_value(const char **string, size_t nesting, JSON_Arena *arena);
+static JSON_Value * parse_string_value(const char **string, JSON_Arena *arena);
+static JSON_Value * parse_boolean_value(const char **string, JSON_Arena *arena);
+static JSON_Value * parse_number_value(const char **string, JSON_Arena *arena);
+static JSON_Value * parse_null_value(const char **string, JSON_Arena *arena);
+static JSON_Value * parse_value(const char **string, size_t nesting, JSON_Arena *arena);
 
 /* Serialization */
-static int    json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int level, int is_pretty, char *num_buf);
-static int    json_serialize_string(const char *string, char *buf);
-static int    append_indent(char *buf, int level);
-static int    append_string(char *buf, const char *string);
+typedef struct json_output_t {
+    char   *buf;      /* NULL while only the size of the output is computed */
+    size_t  length;   /* characters written so far, without the terminating '\0' */
+    size_t  capacity; /* size of buf */
+    int     growable; /* buf is allocated with parson_malloc and grows as needed */
+} JSON_Output;
+
+static JSON_Status output_grow(JSON_Output *out, size_t n);
+static JSON_Status output_append(JSON_Output *out, const char *string, size_t n);
+static JSON_Status json_serialize_to_output_r(const JSON_Value *value, JSON_Output *out, int level, int is_pretty);
+static JSON_Status json_serialize_number(double num, JSON_Output *out);
+static JSON_Status json_serialize_string(const char *string, JSON_Output *out);
+static JSON_Status append_indent(JSON_Output *out, int level);
+static JSON_Status json_serialize_to_buffer_internal(const JSON_Value *value, char *buf, size_t buf_size_in_bytes, int is_pretty);
+static char *      json_serialize_to_string_internal(const JSON_Value *value, int is_pretty);
 
 /* Various */
 static char * parson_strndup(const char *string, size_t n) {
@@ -260,6 +330,16 @@ static int is_decimal(const char *string, size_t length) {
     return 1;
 }
 
+static unsigned long hash_string(const char *string, size_t n) {
+    unsigned long hash = 2166136261UL; /* FNV-1a */
+    size_t i = 0;
+    for (i = 0; i < n; i++) {
+        hash ^= (unsigned char)string[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
 static char * read_file(const char * filename) {
     FILE *fp = fopen(filename, "r");
     size_t file_size;
@@ -328,15 +408,84 @@ static void remove_comments(char *string, const char *start_token, const char *e
     }
 }
 
+/* Arena */
+static JSON_Arena_Chunk * json_arena_chunk_new(JSON_Arena_Chunk *previous, size_t size) {
+    JSON_Arena_Chunk *chunk = NULL;
+    if (size > (size_t)-1 - ARENA_CHUNK_HEADER_SIZE) {
+        return NULL;
+    }
+    chunk = (JSON_Arena_Chunk*)parson_malloc(ARENA_CHUNK_HEADER_SIZE + size);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->previous = previous;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+static JSON_Arena * json_arena_create(size_t size) {
+    JSON_Arena *arena = NULL;
+    JSON_Arena_Chunk *chunk = json_arena_chunk_new(NULL, MAX(size, ARENA_MIN_CHUNK_SIZE));
+    if (chunk == NULL) {
+        return NULL;
+    }
+    arena = (JSON_Arena*)((char*)chunk + ARENA_CHUNK_HEADER_SIZE);
+    chunk->used = ARENA_ALIGN(sizeof(JSON_Arena));
+    arena->chunk = chunk;
+    arena->root = NULL;
+    return arena;
+}
+
+static void * json_arena_alloc(JSON_Arena *arena, size_t size) {
+    JSON_Arena_Chunk *chunk = arena->chunk;
+    void *ptr = NULL;
+    if (size > ((size_t)-1) / 2) {
+        return NULL;
+    }
+    size = ARENA_ALIGN(size);
+    if (chunk->size - chunk->used < size) {
+        chunk = json_arena_chunk_new(chunk, MAX(size, chunk->size * 2));
+        if (chunk == NULL) {
+            return NULL;
+        }
+        arena->chunk = chunk;
+    }
+    ptr = (char*)chunk + ARENA_CHUNK_HEADER_SIZE + chunk->used;
+    chunk->used += size;
+    return ptr;
+}
+
+static void json_arena_free(JSON_Arena *arena) {
+    JSON_Arena_Chunk *chunk = arena->chunk, *previous = NULL;
+    while (chunk != NULL) {
+        previous = chunk->previous;
+        parson_free(chunk);
+        chunk = previous;
+    }
+}
+
+static void * json_alloc(JSON_Arena *arena, size_t size) {
+    return arena != NULL ? json_arena_alloc(arena, size) : parson_malloc(size);
+}
+
+static void json_release(JSON_Arena *arena, void *ptr) {
+    if (arena == NULL) { /* arena memory goes away with the arena */
+        parson_free(ptr);
+    }
+}
+
 /* JSON Object */
 static JSON_Object * json_object_init(JSON_Value *wrapping_value) {
-    JSON_Object *new_obj = (JSON_Object*)parson_malloc(sizeof(JSON_Object));
+    JSON_Object *new_obj = (JSON_Object*)json_alloc(wrapping_value->arena, sizeof(JSON_Object));
     if (new_obj == NULL) {
         return NULL;
     }
     new_obj->wrapping_value = wrapping_value;
     new_obj->names = (char**)NULL;
     new_obj->values = (JSON_Value**)NULL;
+    new_obj->index = (size_t*)NULL;
+    new_obj->index_capacity = 0;
     new_obj->capacity = 0;
     new_obj->count = 0;
     return new_obj;
@@ -351,23 +500,36 @@ static JSON_Status json_object_add(JSON_Object *object, const char *name, JSON_V
         return JSONFailure;
     }
     if (object->count >= object->capacity) {
-        size_t new_capacity = MAX(object->capacity * 2, STARTING_CAPACITY);
+        size_t new_capacity = MAX(object->capacity * 2, IS_IN_ARENA(object) ? ARENA_STARTING_CAPACITY : STARTING_CAPACITY);
         if (json_object_resize(object, new_capacity) == JSONFailure) {
             return JSONFailure;
         }
     }
     index = object->count;
-    object->names[index] = parson_strdup(name);
+    if (IS_IN_ARENA(object)) { /* only the parser adds to these, and its names already live in the arena */
+        object->names[index] = (char*)name;
+    } else {
+        object->names[index] = parson_strdup(name);
+    }
     if (object->names[index] == NULL) {
         return JSONFailure;
     }
     value->parent = json_object_get_wrapping_value(object);
     object->values[index] = value;
     object->count++;
+    if (object->index != NULL && object->count * 2 <= object->index_capacity) {
+        json_object_index_insert(object, index);
+    } else if (object->count >= OBJECT_INDEX_THRESHOLD) {
+        /* without an index lookups are linear, but still correct */
+        if (json_object_index_build(object, json_object_index_capacity(object->count)) == JSONFailure) {
+            json_object_index_free(object);
+        }
+    }
     return JSONSuccess;
 }
 
 static JSON_Status json_object_resize(JSON_Object *object, size_t new_capacity) {
+    JSON_Arena *arena = object->wrapping_value->arena;
     char **temp_names = NULL;
     JSON_Value **temp_values = NULL;
 
@@ -376,21 +538,21 @@ static JSON_Status json_object_resize(JSON_Object *object, size_t new_capacity)
         new_capacity == 0) {
             return JSONFailure; /* Shouldn't happen */
     }
-    temp_names = (char**)parson_malloc(new_capacity * sizeof(char*));
+    temp_names = (char**)json_alloc(arena, new_capacity * sizeof(char*));
     if (temp_names == NULL) {
         return JSONFailure;
     }
-    temp_values = (JSON_Value**)parson_malloc(new_capacity * sizeof(JSON_Value*));
+    temp_values = (JSON_Value**)json_alloc(arena, new_capacity * sizeof(JSON_Value*));
     if (temp_values == NULL) {
-        parson_free(temp_names);
+        json_release(arena, temp_names);
         return JSONFailure;
     }
     if (object->names != NULL && object->values != NULL && object->count > 0) {
         memcpy(temp_names, object->names, object->count * sizeof(char*));
         memcpy(temp_values, object->values, object->count * sizeof(JSON_Value*));
     }
-    parson_free(object->names);
-    parson_free(object->values);
+    json_release(arena, object->names);
+    json_release(arena, object->values);
     object->names = temp_names;
     object->values = temp_values;
     object->capacity = new_capacity;
@@ -398,17 +560,76 @@ static JSON_Status json_object_resize(JSON_Object *object, size_t new_capacity)
 }
 
 static JSON_Value * json_object_nget_value(const JSON_Object *object, const char *name, size_t n) {
-    size_t i, name_length;
-    for (i = 0; i < json_object_get_count(object); i++) {
-        name_length = strlen(object->names[i]);
-        if (name_length != n) {
-            continue;
+    size_t i = json_object_find(object, name, n);
+    if (i >= json_object_get_count(object)) {
+        return NULL;
+    }
+    return object->values[i];
+}
+
+/* Returns the position of the first n characters of name, or the count of the object if it's not there. */
+static size_t json_object_find(const JSON_Object *object, const char *name, size_t n) {
+    size_t i = 0, cell = 0, mask = 0;
+    if (object == NULL) {
+        return 0;
+    }
+    if (object->index != NULL) {
+        mask = object->index_capacity - 1;
+        for (cell = (size_t)hash_string(name, n) & mask; object->index[cell] != 0; cell = (cell + 1) & mask) {
+            i = object->index[cell] - 1;
+            if (strncmp(object->names[i], name, n) == 0 && object->names[i][n] == '\0') {
+                return i;
+            }
         }
-        if (strncmp(object->names[i], name, n) == 0) {
-            return object->values[i];
+        return object->count;
+    }
+    for (i = 0; i < object->count; i++) {
+        if (strncmp(object->names[i], name, n) == 0 && object->names[i][n] == '\0') {
+            return i;
         }
     }
-    return NULL;
+    return object->count;
+}
+
+static void json_object_index_insert(JSON_Object *object, size_t position) {
+    const char *name = object->names[position];
+    size_t mask = object->index_capacity - 1;
+    size_t cell = (size_t)hash_string(name, strlen(name)) & mask;
+    while (object->index[cell] != 0) {
+        cell = (cell + 1) & mask;
+    }
+    object->index[cell] = position + 1;
+}
+
+/* sized from the count rather than the previous capacity, which is 0 after a failed build */
+static size_t json_object_index_capacity(size_t count) {
+    size_t index_capacity = OBJECT_INDEX_THRESHOLD * 2;
+    while (index_capacity < count * 2) {
+        index_capacity *= 2;
+    }
+    return index_capacity;
+}
+
+static JSON_Status json_object_index_build(JSON_Object *object, size_t index_capacity) {
+    size_t i = 0;
+    size_t *new_index = (size_t*)json_alloc(object->wrapping_value->arena, index_capacity * sizeof(size_t));
+    if (new_index == NULL) {
+        return JSONFailure;
+    }
+    memset(new_index, 0, index_capacity * sizeof(size_t));
+    json_release(object->wrapping_value->arena, object->index);
+    object->index = new_index;
+    object->index_capacity = index_capacity;
+    for (i = 0; i < object->count; i++) {
+        json_object_index_insert(object, i);
+    }
+    return JSONSuccess;
+}
+
+static void json_object_index_free(JSON_Object *object) {
+    json_release(object->wrapping_value->arena, object->index);
+    object->index = NULL;
+    object->index_capacity = 0;
 }
 
 static void json_object_free(JSON_Object *object) {
@@ -419,12 +640,13 @@ static void json_object_free(JSON_Object *object) {
     }
     parson_free(object->names);
     parson_free(object->values);
+    parson_free(object->index);
     parson_free(object);
 }
 
 /* JSON Array */
 static JSON_Array * json_array_init(JSON_Value *wrapping_value) {
-    JSON_Array *new_array = (JSON_Array*)parson_malloc(sizeof(JSON_Array));
+    JSON_Array *new_array = (JSON_Array*)json_alloc(wrapping_value->arena, sizeof(JSON_Array));
     if (new_array == NULL) {
         return NULL;
     }
@@ -437,7 +659,7 @@ static JSON_Array * json_array_init(JSON_Value *wrapping_value) {
 
 static JSON_Status json_array_add(JSON_Array *array, JSON_Value *value) {
     if (array->count >= array->capacity) {
-        size_t new_capacity = MAX(array->capacity * 2, STARTING_CAPACITY);
+        size_t new_capacity = MAX(array->capacity * 2, IS_IN_ARENA(array) ? ARENA_STARTING_CAPACITY : STARTING_CAPACITY);
         if (json_array_resize(array, new_capacity) == JSONFailure) {
             return JSONFailure;
         }
@@ -449,18 +671,19 @@ static JSON_Status json_array_add(JSON_Array *array, JSON_Value *value) {
 }
 
 static JSON_Status json_array_resize(JSON_Array *array, size_t new_capacity) {
+    JSON_Arena *arena = array->wrapping_value->arena;
     JSON_Value **new_items = NULL;
     if (new_capacity == 0) {
         return JSONFailure;
     }
-    new_items = (JSON_Value**)parson_malloc(new_capacity * sizeof(JSON_Value*));
+    new_items = (JSON_Value**)json_alloc(arena, new_capacity * sizeof(JSON_Value*));
     if (new_items == NULL) {
         return JSONFailure;
     }
     if (array->items != NULL && array->count > 0) {
         memcpy(new_items, array->items, array->count * sizeof(JSON_Value*));
     }
-    parson_free(array->items);
+    json_release(arena, array->items);
     array->items = new_items;
     array->capacity = new_capacity;
     return JSONSuccess;
@@ -476,13 +699,43 @@ static void json_array_free(JSON_Array *array) {
 }
 
 /* JSON Value */
-static JSON_Value * json_value_init_string_no_copy(char *string) {
-    JSON_Value *new_value = (JSON_Value*)parson_malloc(sizeof(JSON_Value));
+static JSON_Value * json_value_alloc(JSON_Arena *arena, JSON_Value_Type type) {
+    JSON_Value *new_value = (JSON_Value*)json_alloc(arena, sizeof(JSON_Value));
     if (!new_value) {
         return NULL;
     }
     new_value->parent = NULL;
-    new_value->type = JSONString;
+    new_value->arena = arena;
+    new_value->type = type;
+    return new_value;
+}
+
+static JSON_Value * json_value_init_container(JSON_Arena *arena, JSON_Value_Type type) {
+    JSON_Value *new_value = json_value_alloc(arena, type);
+    if (!new_value) {
+        return NULL;
+    }
+    if (type == JSONObject) {
+        new_value->value.object = json_object_init(new_value);
+        if (new_value->value.object == NULL) {
+            json_release(arena, new_value);
+            return NULL;
+        }
+    } else {
+        new_value->value.array = json_array_init(new_value);
+        if (new_value->value.array == NULL) {
+            json_release(arena, new_value);
+            return NULL;
+        }
+    }
+    return new_value;
+}
+
+static JSON_Value * json_value_init_string_no_copy(char *string, JSON_Arena *arena) {
+    JSON_Value *new_value = json_value_alloc(arena, JSONString);
+    if (!new_value) {
+        return NULL;
+    }
     new_value->value.string = string;
     return new_value;
 }
@@ -556,13 +809,15 @@ static int parse_utf16(const char **unprocessed, char **processed) {
 
 
 /* Copies and processes passed string up to supplied length.
-Example: "\u006Corem ipsum" -> lorem ipsum */
-static char* process_string(const char *input, size_t len) {
+Example: "\u006Corem ipsum" -> lorem ipsum
+With an arena the input is the arena's copy of the text and is processed in place, since no escape
+sequence is shorter than the characters it stands for. */
+static char* process_string(const char *input, size_t len, JSON_Arena *arena) {
     const char *input_ptr = input;
     size_t initial_size = (len + 1) * sizeof(char);
     size_t final_size = 0;
     char *output = NULL, *output_ptr = NULL, *resized_output = NULL;
-    output = (char*)parson_malloc(initial_size);
+    output = arena != NULL ? (char*)input : (char*)parson_malloc(initial_size);
     if (output == NULL) {
         goto error;
     }
@@ -596,6 +851,9 @@ static char* process_string(const char *input, size_t len) {
         input_ptr++;
     }
     *output_ptr = '\0';
+    if (arena != NULL) {
+        return output;
+    }
     /* resize to new length */
     final_size = (size_t)(output_ptr-output) + 1;
     /* todo: don't resize if final_size == initial_size */
@@ -607,13 +865,13 @@ static char* process_string(const char *input, size_t len) {
     parson_free(output);
     return resized_output;
 error:
-    parson_free(output);
+    json_release(arena, output);
     return NULL;
 }
 
 /* Return processed contents of a string between quotes and
    skips passed argument to a matching quote. */
-static char * get_quoted_string(const char **string) {
+static char * get_quoted_string(const char **string, JSON_Arena *arena) {
     const char *string_start = *string;
     size_t string_len = 0;
     JSON_Status status = skip_quotes(string);
@@ -621,36 +879,36 @@ static char * get_quoted_string(const char **string) {
         return NULL;
     }
     string_len = *string - string_start - 2; /* length without quotes */
-    return process_string(string_start + 1, string_len);
+    return process_string(string_start + 1, string_len, arena);
 }
 
-static JSON_Value * parse_value(const char **string, size_t nesting) {
+static JSON_Value * parse_value(const char **string, size_t nesting, JSON_Arena *arena) {
     if (nesting > MAX_NESTING) {
         return NULL;
     }
     SKIP_WHITESPACES(string);
     switch (**string) {
         case '{':
-            return parse_object_value(string, nesting + 1);
+            return parse_object_value(string, nesting + 1, arena);
         case '[':
-            return parse_array_value(string, nesting + 1);
+            return parse_array_value(string, nesting + 1, arena);
         case '\"':
-            return parse_string_value(string);
+            return parse_string_value(string, arena);
         case 'f': case 't':
-            return parse_boolean_value(string);
+            return parse_boolean_value(string, arena);
         case '-':
         case '0': case '1': case '2': case '3': case '4':
         case '5': case '6': case '7': case '8': case '9':
-            return parse_number_value(string);
+            return parse_number_value(string, arena);
         case 'n':
-            return parse_null_value(string);
+            return parse_null_value(string, arena);
         default:
             return NULL;
     }
 }
 
-static JSON_Value * parse_object_value(const char **string, size_t nesting) {
-    JSON_Value *output_value = json_value_init_object(), *new_value = NULL;
+static JSON_Value * parse_object_value(const char **string, size_t nesting, JSON_Arena *arena) {
+    JSON_Value *output_value = json_value_init_container(arena, JSONObject), *new_value = NULL;
     JSON_Object *output_object = json_value_get_object(output_value);
     char *new_key = NULL;
     if (output_value == NULL || **string != '{') {
@@ -663,31 +921,31 @@ static JSON_Value * parse_object_value(const char **string, size_t nesting) {
         return output_value;
     }
     while (**string != '\0') {
-        new_key = get_quoted_string(string);
+        new_key = get_quoted_string(string, arena);
         if (new_key == NULL) {
             json_value_free(output_value);
             return NULL;
         }
         SKIP_WHITESPACES(string);
         if (**string != ':') {
-            parson_free(new_key);
+            json_release(arena, new_key);
             json_value_free(output_value);
             return NULL;
         }
         SKIP_CHAR(string);
-        new_value = parse_value(string, nesting);
+        new_value = parse_value(string, nesting, arena);
         if (new_value == NULL) {
-            parson_free(new_key);
+            json_release(arena, new_key);
             json_value_free(output_value);
             return NULL;
         }
         if (json_object_add(output_object, new_key, new_value) == JSONFailure) {
-            parson_free(new_key);
+            json_release(arena, new_key);
             json_value_free(new_value);
             json_value_free(output_value);
             return NULL;
         }
-        parson_free(new_key);
+        json_release(arena, new_key);
         SKIP_WHITESPACES(string);
         if (**string != ',') {
             break;
@@ -696,8 +954,8 @@ static JSON_Value * parse_object_value(const char **string, size_t nesting) {
         SKIP_WHITESPACES(string);
     }
     SKIP_WHITESPACES(string);
-    if (**string != '}' || /* Trim object after parsing is over */
-        json_object_resize(output_object, json_object_get_count(output_object)) == JSONFailure) {
+    if (**string != '}' || /* Trim object after parsing is over, trimming in an arena would only waste it */
+        (arena == NULL && json_object_resize(output_object, json_object_get_count(output_object)) == JSONFailure)) {
             json_value_free(output_value);
             return NULL;
     }
@@ -705,8 +963,8 @@ static JSON_Value * parse_object_value(const char **string, size_t nesting) {
     return output_value;
 }
 
-static JSON_Value * parse_array_value(const char **string, size_t nesting) {
-    JSON_Value *output_value = json_value_init_array(), *new_array_value = NULL;
+static JSON_Value * parse_array_value(const char **string, size_t nesting, JSON_Arena *arena) {
+    JSON_Value *output_value = json_value_init_container(arena, JSONArray), *new_array_value = NULL;
     JSON_Array *output_array = json_value_get_array(output_value);
     if (!output_value || **string != '[') {
         return NULL;
@@ -718,7 +976,7 @@ static JSON_Value * parse_array_value(const char **string, size_t nesting) {
         return output_value;
     }
     while (**string != '\0') {
-        new_array_value = parse_value(string, nesting);
+        new_array_value = parse_value(string, nesting, arena);
         if (new_array_value == NULL) {
             json_value_free(output_value);
             return NULL;
@@ -737,7 +995,7 @@ static JSON_Value * parse_array_value(const char **string, size_t nesting) {
     }
     SKIP_WHITESPACES(string);
     if (**string != ']' || /* Trim array after parsing is over */
-        json_array_resize(output_array, json_array_get_count(output_array)) == JSONFailure) {
+        (arena == NULL && json_array_resize(output_array, json_array_get_count(output_array)) == JSONFailure)) {
             json_value_free(output_value);
             return NULL;
     }
@@ -745,74 +1003,116 @@ static JSON_Value * parse_array_value(const char **string, size_t nesting) {
     return output_value;
 }
 
-static JSON_Value * parse_string_value(const char **string) {
+static JSON_Value * parse_string_value(const char **string, JSON_Arena *arena) {
     JSON_Value *value = NULL;
-    char *new_string = get_quoted_string(string);
+    char *new_string = get_quoted_string(string, arena);
     if (new_string == NULL) {
         return NULL;
     }
-    value = json_value_init_string_no_copy(new_string);
+    value = json_value_init_string_no_copy(new_string, arena);
     if (value == NULL) {
-        parson_free(new_string);
+        json_release(arena, new_string);
         return NULL;
     }
     return value;
 }
 
-static JSON_Value * parse_boolean_value(const char **string) {
+static JSON_Value * parse_boolean_value(const char **string, JSON_Arena *arena) {
+    JSON_Value *value = NULL;
     size_t true_token_size = SIZEOF_TOKEN("true");
     size_t false_token_size = SIZEOF_TOKEN("false");
+    int boolean = 0;
     if (strncmp("true", *string, true_token_size) == 0) {
         *string += true_token_size;
-        return json_value_init_boolean(1);
+        boolean = 1;
     } else if (strncmp("false", *string, false_token_size) == 0) {
         *string += false_token_size;
-        return json_value_init_boolean(0);
+    } else {
+        return NULL;
     }
-    return NULL;
+    value = json_value_alloc(arena, JSONBoolean);
+    if (value != NULL) {
+        value->value.boolean = boolean;
+    }
+    return value;
 }
 
-static JSON_Value * parse_number_value(const char **string) {
+static JSON_Value * parse_number_value(const char **string, JSON_Arena *arena) {
+    JSON_Value *value = NULL;
     char *end;
     double number = 0;
     errno = 0;
     number = strtod(*string, &end);
-    if (errno || !is_decimal(*string, end - *string)) {
+    if (errno || !is_decimal(*string, end - *string) || (number * 0.0) != 0.0) {
         return NULL;
     }
     *string = end;
-    return json_value_init_number(number);
+    value = json_value_alloc(arena, JSONNumber);
+    if (value != NULL) {
+        value->value.number = number;
+    }
+    return value;
 }
 
-static JSON_Value * parse_null_value(const char **string) {
+static JSON_Value * parse_null_value(const char **string, JSON_Arena *arena) {
     size_t token_size = SIZEOF_TOKEN("null");
     if (strncmp("null", *string, token_size) == 0) {
         *string += token_size;
-        return json_value_init_null();
+        return json_value_alloc(arena, JSONNull);
     }
     return NULL;
 }
 
 /* Serialization */
-#define APPEND_STRING(str) do { written = append_string(buf, (str));\
-                                if (written < 0) { return -1; }\
-                                if (buf != NULL) { buf += written; }\
-                                written_total += written; } while(0)
+#define APPEND_STRING(str) do { if (output_append(out, (str), SIZEOF_TOKEN(str)) == JSONFailure) {\
+                                    return JSONFailure; } } while(0)
 
-#define APPEND_INDENT(level) do { written = append_indent(buf, (level));\
-                                  if (written < 0) { return -1; }\
-                                  if (buf != NULL) { buf += written; }\
-                                  written_total += written; } while(0)
+#define APPEND_INDENT(level) do { if (append_indent(out, (level)) == JSONFailure) {\
+                                      return JSONFailure; } } while(0)
 
-static int json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int level, int is_pretty, char *num_buf)
+static JSON_Status output_grow(JSON_Output *out, size_t n) {
+    char *new_buf = NULL;
+    size_t new_capacity = MAX(out->capacity, OUTPUT_STARTING_CAPACITY);
+    while (new_capacity - out->length <= n) {
+        if (new_capacity > ((size_t)-1) / 2) {
+            return JSONFailure;
+        }
+        new_capacity *= 2;
+    }
+    new_buf = (char*)parson_malloc(new_capacity);
+    if (new_buf == NULL) {
+        return JSONFailure;
+    }
+    if (out->buf != NULL) {
+        memcpy(new_buf, out->buf, out->length);
+        parson_free(out->buf);
+    }
+    out->buf = new_buf;
+    out->capacity = new_capacity;
+    return JSONSuccess;
+}
+
+/* Appends n characters, always keeping room for the terminating '\0'. */
+static JSON_Status output_append(JSON_Output *out, const char *string, size_t n) {
+    if (out->buf != NULL || out->growable) {
+        if (out->length >= out->capacity || n >= out->capacity - out->length) {
+            if (!out->growable || output_grow(out, n) == JSONFailure) {
+                return JSONFailure;
+            }
+        }
+        memcpy(out->buf + out->length, string, n);
+    }
+    out->length += n;
+    return JSONSuccess;
+}
+
+static JSON_Status json_serialize_to_output_r(const JSON_Value *value, JSON_Output *out, int level, int is_pretty)
 {
     const char *key = NULL, *string = NULL;
     JSON_Value *temp_value = NULL;
     JSON_Array *array = NULL;
     JSON_Object *object = NULL;
     size_t i = 0, count = 0;
-    double num = 0.0;
-    int written = -1, written_total = 0;
 
     switch (json_value_get_type(value)) {
         case JSONArray:
@@ -827,14 +1127,9 @@ static int json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int le
                     APPEND_INDENT(level+1);
                 }
                 temp_value = json_array_get_value(array, i);
-                written = json_serialize_to_buffer_r(temp_value, buf, level+1, is_pretty, num_buf);
-                if (written < 0) {
-                    return -1;
-                }
-                if (buf != NULL) {
-                    buf += written;
+                if (json_serialize_to_output_r(temp_value, out, level+1, is_pretty) == JSONFailure) {
+                    return JSONFailure;
                 }
-                written_total += written;
                 if (i < (count - 1)) {
                     APPEND_STRING(",");
                 }
@@ -846,7 +1141,7 @@ static int json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int le
                 APPEND_INDENT(level);
             }
             APPEND_STRING("]");
-            return written_total;
+            return JSONSuccess;
         case JSONObject:
             object = json_value_get_object(value);
             count  = json_object_get_count(object);
@@ -857,32 +1152,22 @@ static int json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int le
             for (i = 0; i < count; i++) {
                 key = json_object_get_name(object, i);
                 if (key == NULL) {
-                    return -1;
+                    return JSONFailure;
                 }
                 if (is_pretty) {
                     APPEND_INDENT(level+1);
                 }
-                written = json_serialize_string(key, buf);
-                if (written < 0) {
-                    return -1;
-                }
-                if (buf != NULL) {
-                    buf += written;
+                if (json_serialize_string(key, out) == JSONFailure) {
+                    return JSONFailure;
                 }
-                written_total += written;
                 APPEND_STRING(":");
                 if (is_pretty) {
                     APPEND_STRING(" ");
                 }
-                temp_value = json_object_get_value(object, key);
-                written = json_serialize_to_buffer_r(temp_value, buf, level+1, is_pretty, num_buf);
-                if (written < 0) {
-                    return -1;
-                }
-                if (buf != NULL) {
-                    buf += written;
+                temp_value = json_object_get_value_at(object, i);
+                if (json_serialize_to_output_r(temp_value, out, level+1, is_pretty) == JSONFailure) {
+                    return JSONFailure;
                 }
-                written_total += written;
                 if (i < (count - 1)) {
                     APPEND_STRING(",");
                 }
@@ -894,127 +1179,85 @@ static int json_serialize_to_buffer_r(const JSON_Value *value, char *buf, int le
                 APPEND_INDENT(level);
             }
             APPEND_STRING("}");
-            return written_total;
+            return JSONSuccess;
         case JSONString:
             string = json_value_get_string(value);
             if (string == NULL) {
-                return -1;
-            }
-            written = json_serialize_string(string, buf);
-            if (written < 0) {
-                return -1;
-            }
-            if (buf != NULL) {
-                buf += written;
+                return JSONFailure;
             }
-            written_total += written;
-            return written_total;
+            return json_serialize_string(string, out);
         case JSONBoolean:
             if (json_value_get_boolean(value)) {
                 APPEND_STRING("true");
             } else {
                 APPEND_STRING("false");
             }
-            return written_total;
+            return JSONSuccess;
         case JSONNumber:
-            num = json_value_get_number(value);
-            if (buf != NULL) {
-                num_buf = buf;
-            }
-            written = sprintf(num_buf, FLOAT_FORMAT, num);
-            if (written < 0) {
-                return -1;
-            }
-            if (buf != NULL) {
-                buf += written;
-            }
-            written_total += written;
-            return written_total;
+            return json_serialize_number(json_value_get_number(value), out);
         case JSONNull:
             APPEND_STRING("null");
-            return written_total;
+            return JSONSuccess;
         case JSONError:
-            return -1;
+            return JSONFailure;
         default:
-            return -1;
+            return JSONFailure;
     }
 }
 
-static int json_serialize_string(const char *string, char *buf) {
-    size_t i = 0, len = strlen(string);
-    char c = '\0';
-    int written = -1, written_total = 0;
+/* Kept out of json_serialize_to_output_r so that num_buf is not allocated at every nesting level. */
+static JSON_Status json_serialize_number(double num, JSON_Output *out) {
+    char num_buf[NUM_BUF_SIZE];
+    int written = sprintf(num_buf, FLOAT_FORMAT, num);
+    if (written < 0) {
+        return JSONFailure;
+    }
+    return output_append(out, num_buf, (size_t)written);
+}
+
+/* Characters that need no escaping are copied in runs. */
+static JSON_Status json_serialize_string(const char *string, JSON_Output *out) {
+    const char *run = string, *escape = NULL;
+    char unicode_escape[] = "\\u00XX";
     APPEND_STRING("\"");
-    for (i = 0; i < len; i++) {
-        c = string[i];
-        switch (c) {
-            case '\"': APPEND_STRING("\\\""); break;
-            case '\\': APPEND_STRING("\\\\"); break;
-            case '/':  APPEND_STRING("\\/"); break; /* to make json embeddable in xml\/html */
-            case '\b': APPEND_STRING("\\b"); break;
-            case '\f': APPEND_STRING("\\f"); break;
-            case '\n': APPEND_STRING("\\n"); break;
-            case '\r': APPEND_STRING("\\r"); break;
-            case '\t': APPEND_STRING("\\t"); break;
-            case '\x00': APPEND_STRING("\\u0000"); break;
-            case '\x01': APPEND_STRING("\\u0001"); break;
-            case '\x02': APPEND_STRING("\\u0002"); break;
-            case '\x03': APPEND_STRING("\\u0003"); break;
-            case '\x04': APPEND_STRING("\\u0004"); break;
-            case '\x05': APPEND_STRING("\\u0005"); break;
-            case '\x06': APPEND_STRING("\\u0006"); break;
-            case '\x07': APPEND_STRING("\\u0007"); break;
-            /* '\x08' duplicate: '\b' */
-            /* '\x09' duplicate: '\t' */
-            /* '\x0a' duplicate: '\n' */
-            case '\x0b': APPEND_STRING("\\u000b"); break;
-            /* '\x0c' duplicate: '\f' */
-            /* '\x0d' duplicate: '\r' */
-            case '\x0e': APPEND_STRING("\\u000e"); break;
-            case '\x0f': APPEND_STRING("\\u000f"); break;
-            case '\x10': APPEND_STRING("\\u0010"); break;
-            case '\x11': APPEND_STRING("\\u0011"); break;
-            case '\x12': APPEND_STRING("\\u0012"); break;
-            case '\x13': APPEND_STRING("\\u0013"); break;
-            case '\x14': APPEND_STRING("\\u0014"); break;
-            case '\x15': APPEND_STRING("\\u0015"); break;
-            case '\x16': APPEND_STRING("\\u0016"); break;
-            case '\x17': APPEND_STRING("\\u0017"); break;
-            case '\x18': APPEND_STRING("\\u0018"); break;
-            case '\x19': APPEND_STRING("\\u0019"); break;
-            case '\x1a': APPEND_STRING("\\u001a"); break;
-            case '\x1b': APPEND_STRING("\\u001b"); break;
-            case '\x1c': APPEND_STRING("\\u001c"); break;
-            case '\x1d': APPEND_STRING("\\u001d"); break;
-            case '\x1e': APPEND_STRING("\\u001e"); break;
-            case '\x1f': APPEND_STRING("\\u001f"); break;
+    for (; *string != '\0'; string++) {
+        switch (*string) {
+            case '\"': escape = "\\\""; break;
+            case '\\': escape = "\\\\"; break;
+            case '/':  escape = "\\/"; break; /* to make json embeddable in xml\/html */
+            case '\b': escape = "\\b"; break;
+            case '\f': escape = "\\f"; break;
+            case '\n': escape = "\\n"; break;
+            case '\r': escape = "\\r"; break;
+            case '\t': escape = "\\t"; break;
             default:
-                if (buf != NULL) {
-                    buf[0] = c;
-                    buf += 1;
+                if ((unsigned char)*string >= 0x20) {
+                    continue;
                 }
-                written_total += 1;
+                unicode_escape[4] = "0123456789abcdef"[(unsigned char)*string >> 4];
+                unicode_escape[5] = "0123456789abcdef"[(unsigned char)*string & 0xF];
+                escape = unicode_escape;
                 break;
         }
+        if (output_append(out, run, (size_t)(string - run)) == JSONFailure ||
+            output_append(out, escape, strlen(escape)) == JSONFailure) {
+            return JSONFailure;
+        }
+        run = string + 1;
+    }
+    if (output_append(out, run, (size_t)(string - run)) == JSONFailure) {
+        return JSONFailure;
     }
     APPEND_STRING("\"");
-    return written_total;
+    return JSONSuccess;
 }
 
-static int append_indent(char *buf, int level) {
+static JSON_Status append_indent(JSON_Output *out, int level) {
     int i;
-    int written = -1, written_total = 0;
     for (i = 0; i < level; i++) {
         APPEND_STRING("    ");
     }
-    return written_total;
-}
-
-static int append_string(char *buf, const char *string) {
-    if (buf == NULL) {
-        return (int)strlen(string);
-    }
-    return sprintf(buf, "%s", string);
+    return JSONSuccess;
 }
 
 #undef APPEND_STRING
@@ -1050,7 +1293,44 @@ JSON_Value * json_parse_string(const char *string) {
     if (string[0] == '\xEF' && string[1] == '\xBB' && string[2] == '\xBF') {
         string = string + 3; /* Support for UTF-8 BOM */
     }
-    return parse_value((const char**)&string, 0);
+    return parse_value((const char**)&string, 0, NULL);
+}
+
+JSON_Value * json_parse_string_with_arena(const char *string) {
+    JSON_Arena *arena = NULL;
+    JSON_Value *result = NULL;
+    char *string_copy = NULL;
+    const char *string_copy_ptr = NULL;
+    size_t string_len = 0;
+    if (string == NULL) {
+        return NULL;
+    }
+    if (string[0] == '\xEF' && string[1] == '\xBB' && string[2] == '\xBF') {
+        string = string + 3; /* Support for UTF-8 BOM */
+    }
+    string_len = strlen(string);
+    if (string_len >= ((size_t)-1) / ARENA_SIZE_FACTOR) {
+        return NULL;
+    }
+    arena = json_arena_create((string_len + 1) * ARENA_SIZE_FACTOR);
+    if (arena == NULL) {
+        return NULL;
+    }
+    /* strings are unescaped in place in this copy */
+    string_copy = (char*)json_arena_alloc(arena, string_len + 1);
+    if (string_copy == NULL) {
+        json_arena_free(arena);
+        return NULL;
+    }
+    memcpy(string_copy, string, string_len + 1);
+    string_copy_ptr = string_copy;
+    result = parse_value(&string_copy_ptr, 0, arena);
+    if (result == NULL) {
+        json_arena_free(arena);
+        return NULL;
+    }
+    arena->root = result;
+    return result;
 }
 
 JSON_Value * json_parse_string_with_comments(const char *string) {
@@ -1063,7 +1343,7 @@ JSON_Value * json_parse_string_with_comments(const char *string) {
     remove_comments(string_mutable_copy, "/*", "*/");
     remove_comments(string_mutable_copy, "//", "\n");
     string_mutable_copy_ptr = string_mutable_copy;
-    result = parse_value((const char**)&string_mutable_copy_ptr, 0);
+    result = parse_value((const char**)&string_mutable_copy_ptr, 0, NULL);
     parson_free(string_mutable_copy);
     return result;
 }
@@ -1232,6 +1512,12 @@ JSON_Value * json_value_get_parent (const JSON_Value *value) {
 }
 
 void json_value_free(JSON_Value *value) {
+    if (value != NULL && value->arena != NULL) {
+        if (value->arena->root == value) {
+            json_arena_free(value->arena);
+        }
+        return;
+    }
     switch (json_value_get_type(value)) {
         case JSONObject:
             json_object_free(value->value.object);
@@ -1249,33 +1535,11 @@ void json_value_free(JSON_Value *value) {
 }
 
 JSON_Value * json_value_init_object(void) {
-    JSON_Value *new_value = (JSON_Value*)parson_malloc(sizeof(JSON_Value));
-    if (!new_value) {
-        return NULL;
-    }
-    new_value->parent = NULL;
-    new_value->type = JSONObject;
-    new_value->value.object = json_object_init(new_value);
-    if (!new_value->value.object) {
-        parson_free(new_value);
-        return NULL;
-    }
-    return new_value;
+    return json_value_init_container(NULL, JSONObject);
 }
 
 JSON_Value * json_value_init_array(void) {
-    JSON_Value *new_value = (JSON_Value*)parson_malloc(sizeof(JSON_Value));
-    if (!new_value) {
-        return NULL;
-    }
-    new_value->parent = NULL;
-    new_value->type = JSONArray;
-    new_value->value.array = json_array_init(new_value);
-    if (!new_value->value.array) {
-        parson_free(new_value);
-        return NULL;
-    }
-    return new_value;
+    return json_value_init_container(NULL, JSONArray);
 }
 
 JSON_Value * json_value_init_string(const char *string) {
@@ -1293,7 +1557,7 @@ JSON_Value * json_value_init_string(const char *string) {
     if (copy == NULL) {
         return NULL;
     }
-    value = json_value_init_string_no_copy(copy);
+    value = json_value_init_string_no_copy(copy, NULL);
     if (value == NULL) {
         parson_free(copy);
     }
@@ -1305,35 +1569,25 @@ JSON_Value * json_value_init_number(double number) {
     if ((number * 0.0) != 0.0) { /* nan and inf test */
         return NULL;
     }
-    new_value = (JSON_Value*)parson_malloc(sizeof(JSON_Value));
+    new_value = json_value_alloc(NULL, JSONNumber);
     if (new_value == NULL) {
         return NULL;
     }
-    new_value->parent = NULL;
-    new_value->type = JSONNumber;
     new_value->value.number = number;
     return new_value;
 }
 
 JSON_Value * json_value_init_boolean(int boolean) {
-    JSON_Value *new_value = (JSON_Value*)parson_malloc(sizeof(JSON_Value));
+    JSON_Value *new_value = json_value_alloc(NULL, JSONBoolean);
     if (!new_value) {
         return NULL;
     }
-    new_value->parent = NULL;
-    new_value->type = JSONBoolean;
     new_value->value.boolean = boolean ? 1 : 0;
     return new_value;
 }
 
 JSON_Value * json_value_init_null(void) {
-    JSON_Value *new_value = (JSON_Value*)parson_malloc(sizeof(JSON_Value));
-    if (!new_value) {
-        return NULL;
-    }
-    new_value->parent = NULL;
-    new_value->type = JSONNull;
-    return new_value;
+    return json_value_alloc(NULL, JSONNull);
 }
 
 JSON_Value * json_value_deep_copy(const JSON_Value *value) {
@@ -1375,7 +1629,7 @@ JSON_Value * json_value_deep_copy(const JSON_Value *value) {
             temp_object_copy = json_value_get_object(return_value);
             for (i = 0; i < json_object_get_count(temp_object); i++) {
                 temp_key = json_object_get_name(temp_object, i);
-                temp_value = json_object_get_value(temp_object, temp_key);
+                temp_value = json_object_get_value_at(temp_object, i);
                 temp_value_copy = json_value_deep_copy(temp_value);
                 if (temp_value_copy == NULL) {
                     json_value_free(return_value);
@@ -1401,7 +1655,7 @@ JSON_Value * json_value_deep_copy(const JSON_Value *value) {
             if (temp_string_copy == NULL) {
                 return NULL;
             }
-            return_value = json_value_init_string_no_copy(temp_string_copy);
+            return_value = json_value_init_string_no_copy(temp_string_copy, NULL);
             if (return_value == NULL) {
                 parson_free(temp_string_copy);
             }
@@ -1415,25 +1669,53 @@ JSON_Value * json_value_deep_copy(const JSON_Value *value) {
     }
 }
 
-size_t json_serialization_size(const JSON_Value *value) {
-    char num_buf[1100]; /* recursively allocating buffer on stack is a bad idea, so let's do it only once */
-    int res = json_serialize_to_buffer_r(value, NULL, 0, 0, num_buf);
-    return res < 0 ? 0 : (size_t)(res + 1);
-}
-
-JSON_Status json_serialize_to_buffer(const JSON_Value *value, char *buf, size_t buf_size_in_bytes) {
-    int written = -1;
-    size_t needed_size_in_bytes = json_serialization_size(value);
-    if (needed_size_in_bytes == 0 || buf_size_in_bytes < needed_size_in_bytes) {
+static JSON_Status json_serialize_to_buffer_internal(const JSON_Value *value, char *buf, size_t buf_size_in_bytes, int is_pretty) {
+    JSON_Output out;
+    if (buf == NULL) {
         return JSONFailure;
     }
-    written = json_serialize_to_buffer_r(value, buf, 0, 0, NULL);
-    if (written < 0) {
+    out.buf = buf;
+    out.length = 0;
+    out.capacity = buf_size_in_bytes;
+    out.growable = 0;
+    if (json_serialize_to_output_r(value, &out, 0, is_pretty) == JSONFailure) {
         return JSONFailure;
     }
+    out.buf[out.length] = '\0';
     return JSONSuccess;
 }
 
+/* Serializes in a single pass into a buffer that grows as needed. */
+static char * json_serialize_to_string_internal(const JSON_Value *value, int is_pretty) {
+    JSON_Output out;
+    out.buf = NULL;
+    out.length = 0;
+    out.capacity = 0;
+    out.growable = 1;
+    if (json_serialize_to_output_r(value, &out, 0, is_pretty) == JSONFailure) {
+        parson_free(out.buf);
+        return NULL;
+    }
+    out.buf[out.length] = '\0';
+    return out.buf;
+}
+
+size_t json_serialization_size(const JSON_Value *value) {
+    JSON_Output out;
+    out.buf = NULL;
+    out.length = 0;
+    out.capacity = 0;
+    out.growable = 0;
+    if (json_serialize_to_output_r(value, &out, 0, 0) == JSONFailure) {
+        return 0;
+    }
+    return out.length + 1;
+}
+
+JSON_Status json_serialize_to_buffer(const JSON_Value *value, char *buf, size_t buf_size_in_bytes) {
+    return json_serialize_to_buffer_internal(value, buf, buf_size_in_bytes, 0);
+}
+
 JSON_Status json_serialize_to_file(const JSON_Value *value, const char *filename) {
     JSON_Status return_code = JSONSuccess;
     FILE *fp = NULL;
@@ -1457,41 +1739,23 @@ JSON_Status json_serialize_to_file(const JSON_Value *value, const char *filename
 }
 
 char * json_serialize_to_string(const JSON_Value *value) {
-    JSON_Status serialization_result = JSONFailure;
-    size_t buf_size_bytes = json_serialization_size(value);
-    char *buf = NULL;
-    if (buf_size_bytes == 0) {
-        return NULL;
-    }
-    buf = (char*)parson_malloc(buf_size_bytes);
-    if (buf == NULL) {
-        return NULL;
-    }
-    serialization_result = json_serialize_to_buffer(value, buf, buf_size_bytes);
-    if (serialization_result == JSONFailure) {
-        json_free_serialized_string(buf);
-        return NULL;
-    }
-    return buf;
+    return json_serialize_to_string_internal(value, 0);
 }
 
 size_t json_serialization_size_pretty(const JSON_Value *value) {
-    char num_buf[1100]; /* recursively allocating buffer on stack is a bad idea, so let's do it only once */
-    int res = json_serialize_to_buffer_r(value, NULL, 0, 1, num_buf);
-    return res < 0 ? 0 : (size_t)(res + 1);
+    JSON_Output out;
+    out.buf = NULL;
+    out.length = 0;
+    out.capacity = 0;
+    out.growable = 0;
+    if (json_serialize_to_output_r(value, &out, 0, 1) == JSONFailure) {
+        return 0;
+    }
+    return out.length + 1;
 }
 
 JSON_Status json_serialize_to_buffer_pretty(const JSON_Value *value, char *buf, size_t buf_size_in_bytes) {
-    int written = -1;
-    size_t needed_size_in_bytes = json_serialization_size_pretty(value);
-    if (needed_size_in_bytes == 0 || buf_size_in_bytes < needed_size_in_bytes) {
-        return JSONFailure;
-    }
-    written = json_serialize_to_buffer_r(value, buf, 0, 1, NULL);
-    if (written < 0) {
-        return JSONFailure;
-    }
-    return JSONSuccess;
+    return json_serialize_to_buffer_internal(value, buf, buf_size_in_bytes, 1);
 }
 
 JSON_Status json_serialize_to_file_pretty(const JSON_Value *value, const char *filename) {
@@ -1517,22 +1781,7 @@ JSON_Status json_serialize_to_file_pretty(const JSON_Value *value, const char *f
 }
 
 char * json_serialize_to_string_pretty(const JSON_Value *value) {
-    JSON_Status serialization_result = JSONFailure;
-    size_t buf_size_bytes = json_serialization_size_pretty(value);
-    char *buf = NULL;
-    if (buf_size_bytes == 0) {
-        return NULL;
-    }
-    buf = (char*)parson_malloc(buf_size_bytes);
-    if (buf == NULL) {
-        return NULL;
-    }
-    serialization_result = json_serialize_to_buffer_pretty(value, buf, buf_size_bytes);
-    if (serialization_result == JSONFailure) {
-        json_free_serialized_string(buf);
-        return NULL;
-    }
-    return buf;
+    return json_serialize_to_string_internal(value, 1);
 }
 
 void json_free_serialized_string(char *string) {
@@ -1541,7 +1790,7 @@ void json_free_serialized_string(char *string) {
 
 JSON_Status json_array_remove(JSON_Array *array, size_t ix) {
     size_t to_move_bytes = 0;
-    if (array == NULL || ix >= json_array_get_count(array)) {
+    if (array == NULL || IS_IN_ARENA(array) || ix >= json_array_get_count(array)) {
         return JSONFailure;
     }
     json_value_free(json_array_get_value(array, ix));
@@ -1552,7 +1801,7 @@ JSON_Status json_array_remove(JSON_Array *array, size_t ix) {
 }
 
 JSON_Status json_array_replace_value(JSON_Array *array, size_t ix, JSON_Value *value) {
-    if (array == NULL || value == NULL || value->parent != NULL || ix >= json_array_get_count(array)) {
+    if (array == NULL || IS_IN_ARENA(array) || value == NULL || value->parent != NULL || ix >= json_array_get_count(array)) {
         return JSONFailure;
     }
     json_value_free(json_array_get_value(array, ix));
@@ -1611,7 +1860,7 @@ JSON_Status json_array_replace_null(JSON_Array *array, size_t i) {
 
 JSON_Status json_array_clear(JSON_Array *array) {
     size_t i = 0;
-    if (array == NULL) {
+    if (array == NULL || IS_IN_ARENA(array)) {
         return JSONFailure;
     }
     for (i = 0; i < json_array_get_count(array); i++) {
@@ -1622,7 +1871,7 @@ JSON_Status json_array_clear(JSON_Array *array) {
 }
 
 JSON_Status json_array_append_value(JSON_Array *array, JSON_Value *value) {
-    if (array == NULL || value == NULL || value->parent != NULL) {
+    if (array == NULL || IS_IN_ARENA(array) || value == NULL || value->parent != NULL) {
         return JSONFailure;
     }
     return json_array_add(array, value);
@@ -1679,38 +1928,55 @@ JSON_Status json_array_append_null(JSON_Array *array) {
 JSON_Status json_object_set_value(JSON_Object *object, const char *name, JSON_Value *value) {
     size_t i = 0;
     JSON_Value *old_value;
-    if (object == NULL || name == NULL || value == NULL || value->parent != NULL) {
+    if (object == NULL || IS_IN_ARENA(object) || name == NULL || value == NULL || value->parent != NULL) {
         return JSONFailure;
     }
-    old_value = json_object_get_value(object, name);
-    if (old_value != NULL) { /* free and overwrite old value */
+    i = json_object_find(object, name, strlen(name));
+    if (i < json_object_get_count(object)) { /* free and overwrite old value */
+        old_value = object->values[i];
         json_value_free(old_value);
-        for (i = 0; i < json_object_get_count(object); i++) {
-            if (strcmp(object->names[i], name) == 0) {
-                value->parent = json_object_get_wrapping_value(object);
-                object->values[i] = value;
-                return JSONSuccess;
-            }
-        }
+        value->parent = json_object_get_wrapping_value(object);
+        object->values[i] = value;
+        return JSONSuccess;
     }
     /* add new key value pair */
     return json_object_add(object, name, value);
 }
 
 JSON_Status json_object_set_string(JSON_Object *object, const char *name, const char *string) {
-    return json_object_set_value(object, name, json_value_init_string(string));
+    JSON_Value *value = json_value_init_string(string);
+    if (json_object_set_value(object, name, value) == JSONFailure) {
+        json_value_free(value);
+        return JSONFailure;
+    }
+    return JSONSuccess;
 }
 
 JSON_Status json_object_set_number(JSON_Object *object, const char *name, double number) {
-    return json_object_set_value(object, name, json_value_init_number(number));
+    JSON_Value *value = json_value_init_number(number);
+    if (json_object_set_value(object, name, value) == JSONFailure) {
+        json_value_free(value);
+        return JSONFailure;
+    }
+    return JSONSuccess;
 }
 
 JSON_Status json_object_set_boolean(JSON_Object *object, const char *name, int boolean) {
-    return json_object_set_value(object, name, json_value_init_boolean(boolean));
+    JSON_Value *value = json_value_init_boolean(boolean);
+    if (json_object_set_value(object, name, value) == JSONFailure) {
+        json_value_free(value);
+        return JSONFailure;
+    }
+    return JSONSuccess;
 }
 
 JSON_Status json_object_set_null(JSON_Object *object, const char *name) {
-    return json_object_set_value(object, name, json_value_init_null());
+    JSON_Value *value = json_value_init_null();
+    if (json_object_set_value(object, name, value) == JSONFailure) {
+        json_value_free(value);
+        return JSONFailure;
+    }
+    return JSONSuccess;
 }
 
 JSON_Status json_object_dotset_value(JSON_Object *object, const char *name, JSON_Value *value) {
@@ -1718,7 +1984,7 @@ JSON_Status json_object_dotset_value(JSON_Object *object, const char *name, JSON
     char *current_name = NULL;
     JSON_Object *temp_obj = NULL;
     JSON_Value *new_value = NULL;
-    if (object == NULL || name == NULL || value == NULL) {
+    if (object == NULL || IS_IN_ARENA(object) || name == NULL || value == NULL) {
         return JSONFailure;
     }
     dot_pos = strchr(name, '.');
@@ -1795,23 +2061,28 @@ JSON_Status json_object_dotset_null(JSON_Object *object, const char *name) {
 
 JSON_Status json_object_remove(JSON_Object *object, const char *name) {
     size_t i = 0, last_item_index = 0;
-    if (object == NULL || json_object_get_value(object, name) == NULL) {
+    if (object == NULL || IS_IN_ARENA(object) || name == NULL) {
+        return JSONFailure;
+    }
+    i = json_object_find(object, name, strlen(name));
+    if (i >= json_object_get_count(object)) {
         return JSONFailure;
     }
     last_item_index = json_object_get_count(object) - 1;
-    for (i = 0; i < json_object_get_count(object); i++) {
-        if (strcmp(object->names[i], name) == 0) {
-            parson_free(object->names[i]);
-            json_value_free(object->values[i]);
-            if (i != last_item_index) { /* Replace key value pair with one from the end */
-                object->names[i] = object->names[last_item_index];
-                object->values[i] = object->values[last_item_index];
-            }
-            object->count -= 1;
-            return JSONSuccess;
+    parson_free(object->names[i]);
+    json_value_free(object->values[i]);
+    if (i != last_item_index) { /* Replace key value pair with one from the end */
+        object->names[i] = object->names[last_item_index];
+        object->values[i] = object->values[last_item_index];
+    }
+    object->count -= 1;
+    if (object->index != NULL) { /* positions have changed, the index is rebuilt or dropped */
+        if (object->count < OBJECT_INDEX_THRESHOLD ||
+            json_object_index_build(object, json_object_index_capacity(object->count)) == JSONFailure) {
+            json_object_index_free(object);
         }
     }
-    return JSONFailure; /* No execution path should end here */
+    return JSONSuccess;
 }
 
 JSON_Status json_object_dotremove(JSON_Object *object, const char *name) {
@@ -1833,7 +2104,7 @@ JSON_Status json_object_dotremove(JSON_Object *object, const char *name) {
 
 JSON_Status json_object_clear(JSON_Object *object) {
     size_t i = 0;
-    if (object == NULL) {
+    if (object == NULL || IS_IN_ARENA(object)) {
         return JSONFailure;
     }
     for (i = 0; i < json_object_get_count(object); i++) {
@@ -1841,6 +2112,7 @@ JSON_Status json_object_clear(JSON_Object *object) {
         json_value_free(object->values[i]);
     }
     object->count = 0;
+    json_object_index_free(object);
     return JSONSuccess;
 }
 
@@ -1887,7 +2159,7 @@ JSON_Status json_validate(const JSON_Value *schema, const JSON_Value *value) {
             }
             for (i = 0; i < count; i++) {
                 key = json_object_get_name(schema_object, i);
-                temp_schema_value = json_object_get_value(schema_object, key);
+                temp_schema_value = json_object_get_value_at(schema_object, i);
                 temp_value = json_object_get_value(value_object, key);
                 if (temp_value == NULL) {
                     return JSONFailure;
@@ -1942,7 +2214,7 @@ int json_value_equals(const JSON_Value *a, const JSON_Value *b) {
             }
             for (i = 0; i < a_count; i++) {
                 key = json_object_get_name(a_object, i);
-                if (!json_value_equals(json_object_get_value(a_object, key),
+                if (!json_value_equals(json_object_get_value_at(a_object, i),
                                        json_object_get_value(b_object, key))) {
                     return 0;
                 }
@@ -74,6 +74,13 @@ JSON_Value * json_parse_string(const char *string);
     returns NULL in case of error */
 JSON_Value * json_parse_string_with_comments(const char *string);
 
+/*  Parses first JSON value in a string into a single arena, returns NULL in case of error.
+    Every value, name and string of the document comes from a few large blocks that are all
+    released by json_value_free on the returned value. The returned value and everything in it
+    is read-only: functions that would modify it return JSONFailure, and json_value_free does
+    nothing on values inside it. json_value_deep_copy returns a modifiable copy. */
+JSON_Value * json_parse_string_with_arena(const char *string);
+
 /* Serialization */
 size_t      json_serialization_size(const JSON_Value *value); /* returns 0 on fail */
 JSON_Status json_serialize_to_buffer(const JSON_Value *value, char *buf, size_t buf_size_in_bytes);
@@ -49,12 +49,15 @@ void test_suite_7(void); /* Test schema validation */
 void test_suite_8(void); /* Test serialization */
 void test_suite_9(void); /* Test serialization (pretty) */
 void test_suite_10(void); /* Testing for memory leaks */
+void test_suite_11(void); /* Test large (indexed) objects and single pass serialization */
+void test_suite_12(void); /* Test parsing into an arena */
 
 void print_commits_info(const char *username, const char *repo);
 void persistence_example(void);
 void serialization_example(void);
 
 static int malloc_count;
+static size_t failing_malloc_size; /* the next allocation of this size fails, 0 for none */
 static void *counted_malloc(size_t size);
 static void counted_free(void *ptr);
 
@@ -80,6 +83,8 @@ int main() {
     test_suite_8();
     test_suite_9();
     test_suite_10();
+    test_suite_11();
+    test_suite_12();
     printf("Tests failed: %d\n", tests_failed);
     printf("Tests passed: %d\n", tests_passed);
     return 0;
@@ -536,6 +541,249 @@ void test_suite_10(void) {
     TEST(malloc_count == 0);
 }
 
+void test_suite_11(void) {
+    JSON_Value *val, *copy, *parsed;
+    JSON_Object *obj;
+    char name[32];
+    char *serialized;
+    char small_buf[8];
+    size_t i, size;
+    int all_found = 1;
+
+    malloc_count = 0;
+
+    val = json_value_init_object();
+    obj = json_value_get_object(val);
+    for (i = 0; i < 100; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        if (json_object_set_number(obj, name, (double)i) != JSONSuccess) { all_found = 0; }
+    }
+    TEST(all_found);
+    TEST(json_object_get_count(obj) == 100);
+    for (i = 0; i < 100; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        if (json_object_get_number(obj, name) != (double)i) { all_found = 0; }
+    }
+    TEST(all_found);
+    TEST(json_object_get_value(obj, "key100") == NULL);
+    TEST(json_object_get_value(obj, "key") == NULL);
+
+    /* replacing keeps the count and the position */
+    TEST(json_object_set_string(obj, "key50", "fifty") == JSONSuccess);
+    TEST(json_object_get_count(obj) == 100);
+    TEST(STREQ(json_object_get_string(obj, "key50"), "fifty"));
+    TEST(STREQ(json_object_get_name(obj, 50), "key50"));
+
+    /* dotted names go through the index of every nested object */
+    TEST(json_object_dotset_number(obj, "nested.inner", 1.0) == JSONSuccess);
+    TEST(json_object_dotget_number(obj, "nested.inner") == 1.0);
+    TEST(json_object_dotremove(obj, "nested") == JSONSuccess);
+    TEST(json_object_get_count(obj) == 100);
+
+    /* removing moves the last member into the hole */
+    TEST(json_object_remove(obj, "key0") == JSONSuccess);
+    TEST(json_object_get_value(obj, "key0") == NULL);
+    TEST(json_object_get_count(obj) == 99);
+    for (i = 1; i < 100; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        if (json_object_get_value(obj, name) == NULL) { all_found = 0; }
+    }
+    TEST(all_found);
+    TEST(json_object_remove(obj, "key0") == JSONFailure);
+
+    /* deep copy, equality and a round trip through the serializer */
+    copy = json_value_deep_copy(val);
+    TEST(json_value_equals(val, copy));
+    serialized = json_serialize_to_string(val);
+    TEST(serialized != NULL);
+    TEST(strlen(serialized) + 1 == json_serialization_size(val));
+    parsed = json_parse_string(serialized);
+    TEST(json_value_equals(val, parsed));
+    TEST(json_object_get_count(json_value_get_object(parsed)) == 99);
+    json_free_serialized_string(serialized);
+    json_value_free(parsed);
+    TEST(json_object_set_boolean(json_value_get_object(copy), "key1", 1) == JSONSuccess);
+    TEST(!json_value_equals(val, copy));
+    json_value_free(copy);
+
+    /* dropping below the index threshold and growing again */
+    for (i = 1; i < 95; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        if (json_object_remove(obj, name) != JSONSuccess) { all_found = 0; }
+    }
+    TEST(all_found);
+    TEST(json_object_get_count(obj) == 5);
+    TEST(json_object_get_number(obj, "key95") == 95.0);
+    for (i = 0; i < 40; i++) {
+        sprintf(name, "again%u", (unsigned)i);
+        json_object_set_number(obj, name, (double)i);
+    }
+    TEST(json_object_get_count(obj) == 45);
+    TEST(json_object_get_number(obj, "again39") == 39.0);
+    TEST(json_object_get_number(obj, "key96") == 96.0);
+    TEST(json_object_clear(obj) == JSONSuccess);
+    TEST(json_object_get_count(obj) == 0);
+    TEST(json_object_get_value(obj, "again39") == NULL);
+    TEST(json_object_set_number(obj, "again39", 1.0) == JSONSuccess);
+    TEST(json_object_get_number(obj, "again39") == 1.0);
+    json_value_free(val);
+
+    /* an index that cannot be allocated is built again, large enough, on a later add */
+    val = json_value_init_object();
+    obj = json_value_get_object(val);
+    for (i = 0; i < 32; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        json_object_set_number(obj, name, (double)i);
+    }
+    failing_malloc_size = 128 * sizeof(size_t); /* the index grown for the 33rd name */
+    for (i = 32; i < 100; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        if (json_object_set_number(obj, name, (double)i) != JSONSuccess) { all_found = 0; }
+    }
+    TEST(failing_malloc_size == 0);
+    TEST(all_found);
+    for (i = 0; i < 100; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        if (json_object_get_number(obj, name) != (double)i) { all_found = 0; }
+    }
+    TEST(all_found);
+    failing_malloc_size = 256 * sizeof(size_t); /* the index rebuilt after a remove */
+    TEST(json_object_remove(obj, "key0") == JSONSuccess);
+    TEST(failing_malloc_size == 0);
+    TEST(json_object_set_number(obj, "key0", 0.0) == JSONSuccess);
+    TEST(json_object_set_number(obj, "key100", 100.0) == JSONSuccess);
+    for (i = 0; i <= 100; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        if (json_object_get_number(obj, name) != (double)i) { all_found = 0; }
+    }
+    TEST(all_found);
+    json_value_free(val);
+
+    /* parsing rejects duplicated names in large objects too */
+    TEST(json_parse_string("{\"a\":1,\"b\":2,\"c\":3,\"d\":4,\"e\":5,\"f\":6,\"g\":7,\"h\":8,"
+                           "\"i\":9,\"j\":10,\"k\":11,\"l\":12,\"m\":13,\"n\":14,\"o\":15,\"p\":16,"
+                           "\"q\":17,\"a\":18}") == NULL);
+
+    /* escapes and control characters */
+    val = json_value_init_string("a\"b\\c/d\b\f\n\r\t\001e");
+    serialized = json_serialize_to_string(val);
+    TEST(STREQ(serialized, "\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\\u0001e\""));
+    TEST(strlen(serialized) + 1 == json_serialization_size(val));
+    json_free_serialized_string(serialized);
+
+    /* a buffer that is too small fails */
+    size = json_serialization_size(val);
+    TEST(size > sizeof(small_buf));
+    TEST(json_serialize_to_buffer(val, small_buf, sizeof(small_buf)) == JSONFailure);
+    TEST(json_serialize_to_buffer(val, NULL, size) == JSONFailure);
+    json_value_free(val);
+
+    TEST(malloc_count == 0);
+}
+
+void test_suite_12(void) {
+    const char *unicode_string = "{\"a\\u0062\":\"\\u00A2\\uD801\\uDC37\\n\\\"x\\\"\",\"arr\":[1, true, null, \"\"],\"o\":{}}";
+    char *file_contents = NULL;
+    char *serialized = NULL, *arena_serialized = NULL;
+    char name[32];
+    JSON_Value *val = NULL, *arena_val = NULL, *copy = NULL, *holder = NULL;
+    JSON_Object *obj = NULL;
+    JSON_Array *arr = NULL;
+    size_t i;
+    int all_found = 1;
+
+    malloc_count = 0;
+
+    /* same document as the regular parser */
+    file_contents = read_file("tests/test_2.txt");
+    val = json_parse_string(file_contents);
+    arena_val = json_parse_string_with_arena(file_contents);
+    TEST(arena_val != NULL);
+    TEST(json_value_equals(val, arena_val));
+    serialized = json_serialize_to_string(val);
+    arena_serialized = json_serialize_to_string(arena_val);
+    TEST(STREQ(serialized, arena_serialized));
+    json_free_serialized_string(serialized);
+    json_free_serialized_string(arena_serialized);
+    json_value_free(val);
+    json_value_free(arena_val);
+    free(file_contents);
+
+    /* strings are unescaped in place */
+    arena_val = json_parse_string_with_arena(unicode_string);
+    TEST(malloc_count == 1); /* the whole document fits in one block */
+    obj = json_value_get_object(arena_val);
+    TEST(STREQ(json_object_get_string(obj, "ab"), "\xC2\xA2\xF0\x90\x90\xB7\n\"x\""));
+    arr = json_object_get_array(obj, "arr");
+    TEST(json_array_get_count(arr) == 4);
+    TEST(json_array_get_number(arr, 0) == 1.0);
+    TEST(json_array_get_boolean(arr, 1) == 1);
+    TEST(json_value_get_type(json_array_get_value(arr, 2)) == JSONNull);
+    TEST(STREQ(json_array_get_string(arr, 3), ""));
+    TEST(json_object_get_count(json_object_get_object(obj, "o")) == 0);
+
+    /* values in an arena are read-only */
+    TEST(json_object_set_string(obj, "ab", "y") == JSONFailure);
+    TEST(json_object_set_number(obj, "new", 1.0) == JSONFailure);
+    TEST(json_object_dotset_number(obj, "o.new", 1.0) == JSONFailure);
+    TEST(json_object_dotset_number(obj, "new.new", 1.0) == JSONFailure);
+    TEST(json_object_remove(obj, "ab") == JSONFailure);
+    TEST(json_object_clear(json_object_get_object(obj, "o")) == JSONFailure);
+    TEST(json_array_append_number(arr, 1.0) == JSONFailure);
+    TEST(json_array_replace_null(arr, 0) == JSONFailure);
+    TEST(json_array_remove(arr, 0) == JSONFailure);
+    TEST(json_array_clear(arr) == JSONFailure);
+    json_value_free(json_object_get_value(obj, "arr")); /* does nothing */
+    TEST(json_array_get_count(json_object_get_array(obj, "arr")) == 4);
+    TEST(malloc_count == 1);
+
+    /* a deep copy can be modified */
+    copy = json_value_deep_copy(arena_val);
+    TEST(json_value_equals(copy, arena_val));
+    TEST(json_object_set_string(json_value_get_object(copy), "ab", "y") == JSONSuccess);
+    TEST(STREQ(json_object_get_string(obj, "ab"), "\xC2\xA2\xF0\x90\x90\xB7\n\"x\""));
+    json_value_free(copy);
+
+    /* the root can be moved into a regular tree, which then releases the arena */
+    holder = json_value_init_object();
+    TEST(json_object_set_value(json_value_get_object(holder), "doc", arena_val) == JSONSuccess);
+    TEST(json_object_dotget_number(json_value_get_object(holder), "doc.arr") == 0.0);
+    TEST(STREQ(json_object_dotget_string(json_value_get_object(holder), "doc.ab"), "\xC2\xA2\xF0\x90\x90\xB7\n\"x\""));
+    json_value_free(holder);
+
+    /* large objects are indexed in the arena too */
+    val = json_value_init_object();
+    for (i = 0; i < 200; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        json_object_set_number(json_value_get_object(val), name, (double)i);
+    }
+    serialized = json_serialize_to_string(val);
+    arena_val = json_parse_string_with_arena(serialized);
+    TEST(arena_val != NULL);
+    TEST(json_object_get_count(json_value_get_object(arena_val)) == 200);
+    for (i = 0; i < 200; i++) {
+        sprintf(name, "key%u", (unsigned)i);
+        if (json_object_get_number(json_value_get_object(arena_val), name) != (double)i) { all_found = 0; }
+    }
+    TEST(all_found);
+    TEST(json_value_equals(val, arena_val));
+    json_free_serialized_string(serialized);
+    json_value_free(arena_val);
+    json_value_free(val);
+
+    /* invalid documents do not leak */
+    TEST(json_parse_string_with_arena(NULL) == NULL);
+    TEST(json_parse_string_with_arena("") == NULL);
+    TEST(json_parse_string_with_arena("{\"a\":1,\"a\":2}") == NULL);
+    TEST(json_parse_string_with_arena("{\"a\":[1,2,}") == NULL);
+    TEST(json_parse_string_with_arena("[\"\\uDC00\"]") == NULL);
+    TEST(json_parse_string_with_arena("[\"\\q\"]") == NULL);
+    TEST(json_parse_string_with_arena("\"\x01\"") == NULL);
+    TEST(json_parse_string_with_arena("1e999") == NULL);
+
+    TEST(malloc_count == 0);
+}
+
 void print_commits_info(const char *username, const char *repo) {
     JSON_Value *root_value;
     JSON_Array *commits;
@@ -643,7 +891,12 @@ static char * read_file(const char * filename) {
 }
 
 static void *counted_malloc(size_t size) {
-    void *res = malloc(size);
+    void *res = NULL;
+    if (size == failing_malloc_size) {
+        failing_malloc_size = 0;
+        return NULL;
+    }
+    res = malloc(size);
     if (res != NULL) {
         malloc_count++;
     }
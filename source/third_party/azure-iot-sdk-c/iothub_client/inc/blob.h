@@ -19,6 +19,7 @@
 #include "azure_c_shared_utility/httpapiex.h"
 #include "iothub_client_ll.h"
 #include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/tickcounter.h"
 
 #ifdef __cplusplus
 #include <cstddef>
@@ -46,20 +47,92 @@ extern "C"
 
 DEFINE_ENUM(BLOB_RESULT, BLOB_RESULT_VALUES)
 
+/* Filled in by Blob_UploadMultipleBlocksFromSasUriParallel. Throughput is bytes_uploaded / elapsed_ms;
+   elapsed_ms has the resolution of the platform tickcounter. */
+typedef struct BLOB_UPLOAD_STATISTICS_TAG
+{
+    size_t blocks_uploaded;
+    size_t bytes_uploaded;
+    size_t connections;
+    size_t peak_blocks_in_flight;
+    size_t peak_buffered_bytes;
+    tickcounter_ms_t elapsed_ms;
+} BLOB_UPLOAD_STATISTICS;
+
+/* Called by Blob_UploadMultipleBlocksFromSasUriResumable each time a block has been stored, so that the
+   caller can persist blocksStored and bytesStored and hand them back after an interruption. */
+typedef void(*BLOB_BLOCK_STORED_CALLBACK)(unsigned int blocksStored, size_t bytesStored, void* context);
+
+/* In/out state of Blob_UploadMultipleBlocksFromSasUriResumable. Block IDs are the block indexes, so the
+   number of blocks stored is enough to rebuild the block list. */
+typedef struct BLOB_UPLOAD_RESUME_TAG
+{
+    unsigned int blocksStored;          /*in: blocks put by an earlier attempt; out: blocks put so far*/
+    size_t bytesStored;                 /*in/out: source bytes covered by blocksStored*/
+    size_t blockRetries;                /*times a request is repeated after a transport error, 408, 429 or 5xx*/
+    unsigned int retryDelayMs;          /*wait before the first retry; doubled for every retry after it*/
+    BLOB_BLOCK_STORED_CALLBACK onBlockStored;
+    void* onBlockStoredContext;
+    int isResumable;                    /*out: set when the upload stopped on a failure that a later attempt can resume past*/
+} BLOB_UPLOAD_RESUME;
+
 /**
 * @brief  Synchronously uploads a byte array to blob storage
 *
 * @param  SASURI            The URI to use to upload data
 * @param  getDataCallbackEx A callback to be invoked to acquire the file chunks to be uploaded, as well as to indicate the status of the upload of the previous block.
+* @param  fillSliceCallback A callback that writes the file chunks into a slice owned by the SDK instead; exactly one of the two callbacks is given.
 * @param  context           Any data provided by the user to serve as context on getDataCallback.
 * @param  httpStatus        A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
 * @param  httpResponse      A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
 * @param  certificates      A null terminated string containing CA certificates to be used
 * @param    proxyOptions    A structure that contains optional web proxy information
+* @param  sliceSize         Size of the slice offered to fillSliceCallback, at most 4MB. A blob holds at most 50000 blocks,
+*                           so fillSliceCallback can upload at most 50000 * sliceSize bytes.
+*
+* @return	A @c BLOB_RESULT. BLOB_OK means the blob has been uploaded successfully. Any other value indicates an error
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadMultipleBlocksFromSasUri, const char*, SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK, fillSliceCallback, void*, context, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions, size_t, sliceSize)
+
+/**
+* @brief  Synchronously uploads a byte array to blob storage, with up to maxBlocksInFlight Put Block requests
+*         running at the same time, each over its own connection.
+*
+* @param  SASURI            The URI to use to upload data
+* @param  getDataCallbackEx A callback to be invoked to acquire the file chunks to be uploaded. It is only called when a connection is free to take the block.
+* @param  fillSliceCallback Or a callback that writes them into the slice, as for Blob_UploadMultipleBlocksFromSasUri.
+* @param  context           Any data provided by the user to serve as context on getDataCallback.
+* @param  httpStatus        A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
+* @param  httpResponse      A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
+* @param  certificates      A null terminated string containing CA certificates to be used
+* @param  proxyOptions      A structure that contains optional web proxy information
+* @param  sliceSize         Size of the slice offered to fillSliceCallback, as for Blob_UploadMultipleBlocksFromSasUri.
+* @param  maxBlocksInFlight Most blocks uploaded (and buffered) at once. Memory use is bounded by maxBlocksInFlight * 4MB.
+* @param  statistics        Optional; receives the counters of the upload.
+*
+* @return	A @c BLOB_RESULT. BLOB_OK means the blob has been uploaded successfully. Any other value indicates an error
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadMultipleBlocksFromSasUriParallel, const char*, SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK, fillSliceCallback, void*, context, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions, size_t, sliceSize, size_t, maxBlocksInFlight, BLOB_UPLOAD_STATISTICS*, statistics)
+
+/**
+* @brief  Synchronously uploads a byte array to blob storage, one block at a time, retrying requests that
+*         fail for transient reasons and skipping the blocks that an earlier attempt already stored.
+*
+* @param  SASURI            The URI to use to upload data. To resume, this is the SAS URI of the earlier attempt.
+* @param  getDataCallbackEx A callback to be invoked to acquire the file chunks to be uploaded. When resuming it must
+*                           return the same blocks as before; the first resume->blocksStored are read but not sent.
+* @param  fillSliceCallback Or a callback that writes them into the slice, as for Blob_UploadMultipleBlocksFromSasUri.
+* @param  context           Any data provided by the user to serve as context on getDataCallback.
+* @param  httpStatus        A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
+* @param  httpResponse      A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
+* @param  certificates      A null terminated string containing CA certificates to be used
+* @param  proxyOptions      A structure that contains optional web proxy information
+* @param  sliceSize         Size of the slice offered to fillSliceCallback, as for Blob_UploadMultipleBlocksFromSasUri.
+* @param  resume            Where to start, how to retry, and where the upload stopped.
 *
 * @return	A @c BLOB_RESULT. BLOB_OK means the blob has been uploaded successfully. Any other value indicates an error
 */
-MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadMultipleBlocksFromSasUri, const char*, SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions)
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadMultipleBlocksFromSasUriResumable, const char*, SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK, fillSliceCallback, void*, context, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates, HTTP_PROXY_OPTIONS*, proxyOptions, size_t, sliceSize, BLOB_UPLOAD_RESUME*, resume)
 
 /**
 * @brief  Synchronously uploads a byte array as a new block to blob storage
@@ -380,6 +380,16 @@ extern "C"
     * @returns                        An IOTHUB_CLIENT_RESULT value indicating the success or failure of the API call.*/
     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_UploadMultipleBlocksToBlobAsyncEx, IOTHUB_CLIENT_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context);
 
+    /**
+    * @brief                          Uploads a file to a Blob storage in chunks, which the callback provided by the user writes into a buffer owned by the client.
+    * @remarks                        This function allows users to upload large files in chunks without keeping a buffer of their own for each chunk.
+    * @param iotHubClientHandle       The handle created by a call to the IoTHubClient_Create function.
+    * @param destinationFileName      The name of the file to be created in Azure Blob Storage.
+    * @param fillSliceCallback        A callback to be invoked to write the file chunks to be uploaded, as well as to indicate the status of the upload of the previous block.
+    * @param context                  Any data provided by the user to serve as context on fillSliceCallback.
+    * @returns                        An IOTHUB_CLIENT_RESULT value indicating the success or failure of the API call.*/
+    MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_UploadSlicesToBlobAsync, IOTHUB_CLIENT_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK, fillSliceCallback, void*, context);
+
 #endif /* DONT_USE_UPLOADTOBLOB */
 
 #ifdef __cplusplus
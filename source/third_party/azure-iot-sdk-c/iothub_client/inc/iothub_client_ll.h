@@ -183,6 +183,11 @@ extern "C"
 
 #define BLOCK_SIZE (4*1024*1024)
 
+/* Default size of the slice that IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK writes into (see OPTION_BLOB_UPLOAD_SLICE_SIZE); at most one is allocated per upload */
+#ifndef FILE_UPLOAD_SLICE_SIZE
+#define FILE_UPLOAD_SLICE_SIZE (16*1024)
+#endif
+
 #define IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT_VALUES \
     IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK, \
     IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT
@@ -201,9 +206,27 @@ extern "C"
     *                   In such case this callback will be invoked only once more to indicate the status of the final block upload.
     *                   If result is not FILE_UPLOAD_OK, the download is cancelled and this callback stops being invoked.
     *                   When this callback is called for the last time, no data or size is expected, so data and size are set to NULL
+    *                   The memory *data points at has to stay valid until the callback is invoked again; the block is sent from there
+    *                   without being copied, unless OPTION_BLOB_UPLOAD_PARALLELISM is above 1. To read the blocks into a buffer owned by the
+    *                   client instead, use IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK.
     */
     typedef void(*IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context);
     typedef IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT (*IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context);
+
+    /**
+    *  @brief           Callback invoked by IoTHubClient_LL_UploadSlicesToBlob to have the next block of data written into a buffer owned by the client.
+    *  @param result    The result of the upload of the previous block.
+    *  @param slice     The buffer to write the next block into. It is NULL on the last call, which only reports the result of the last block.
+    *  @param size      On entry the capacity of slice (FILE_UPLOAD_SLICE_SIZE unless OPTION_BLOB_UPLOAD_SLICE_SIZE is set); the callback sets it
+    *                   to the number of bytes written, 0 when the file has been uploaded completely.
+    *  @param context   User context provided on the call to IoTHubClient_LL_UploadSlicesToBlob.
+    *  @remarks         Returning IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT aborts the upload.
+    *                   The slice is sent without being copied, unless OPTION_BLOB_UPLOAD_PARALLELISM is above 1.
+    *                   Each slice becomes one blob block and a blob holds at most 50000 of them, so an upload is limited to 50000 times the
+    *                   capacity of the slice (about 800MB with the default 16KB). For larger files raise OPTION_BLOB_UPLOAD_SLICE_SIZE or
+    *                   return blocks of up to BLOCK_SIZE bytes from the application's own memory with IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX.
+    */
+    typedef IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT (*IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char* slice, size_t* size, void* context);
 #endif /* DONT_USE_UPLOADTOBLOB */
 
     /** @brief	This struct captures IoTHub client configuration. */
@@ -259,6 +282,37 @@ extern "C"
         const char* deviceSasToken;
     } IOTHUB_CLIENT_DEVICE_CONFIG;
 
+    /** @brief	Number of priority lanes, one per IOTHUB_MESSAGE_PRIORITY value. */
+#define IOTHUB_CLIENT_PRIORITY_LANE_COUNT 3
+
+    /** @brief	Settings of one priority lane. */
+    typedef struct IOTHUB_CLIENT_PRIORITY_LANE_CONFIG_TAG
+    {
+        /** @brief	Messages the lane may hand to the transport in a row before the lower lanes
+        *           get their turn; cannot be 0. */
+        size_t weight;
+
+        /** @brief	Timeout of the messages queued in the lane in milliseconds, counted from
+        *           IoTHubClient_LL_SendEventAsync; 0 uses the messageTimeout option. */
+        size_t message_timeout_ms;
+
+        /** @brief	Most payload bytes the lane holds; IoTHubClient_LL_SendEventAsync fails
+        *           with IOTHUB_CLIENT_ERROR instead of going over. 0 means no cap. */
+        size_t max_bytes;
+    } IOTHUB_CLIENT_PRIORITY_LANE_CONFIG;
+
+    /** @brief	Value of the priority_lanes option. Events are queued per IOTHUB_MESSAGE_PRIORITY
+    *           and IoTHubClient_LL_DoWork hands them to the transport highest lane first. */
+    typedef struct IOTHUB_CLIENT_PRIORITY_LANES_CONFIG_TAG
+    {
+        /** @brief	Most events waiting for the transport at once; the rest stay in their lanes
+        *           so that a later, higher priority event does not queue behind them. Cannot be 0. */
+        size_t send_window;
+
+        /** @brief	Indexed by IOTHUB_MESSAGE_PRIORITY. */
+        IOTHUB_CLIENT_PRIORITY_LANE_CONFIG lanes[IOTHUB_CLIENT_PRIORITY_LANE_COUNT];
+    } IOTHUB_CLIENT_PRIORITY_LANES_CONFIG;
+
     /** @brief	This struct captures IoTHub transport configuration. */
     struct IOTHUBTRANSPORT_CONFIG_TAG
     {
@@ -611,6 +665,19 @@ extern "C"
      */
      MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadMultipleBlocksToBlobEx, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, getDataCallbackEx, void*, context);
 
+     /**
+     * @brief    This API uploads to Azure Storage the content that @p fillSliceCallback writes, block by block, into a buffer owned by the client,
+     *           under the blob name devicename/@pdestinationFileName
+     *
+     * @param    iotHubClientHandle      The handle created by a call to the create function.
+     * @param    destinationFileName     name of the file.
+     * @param    fillSliceCallback       A callback to be invoked to write the file chunks to be uploaded, as well as to indicate the status of the upload of the previous block.
+     * @param    context                 Any data provided by the user to serve as context on fillSliceCallback.
+     *
+     * @return   IOTHUB_CLIENT_OK upon success or an error code upon failure.
+     */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadSlicesToBlob, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK, fillSliceCallback, void*, context);
+
 #endif /*DONT_USE_UPLOADTOBLOB*/
 
 #ifdef __cplusplus
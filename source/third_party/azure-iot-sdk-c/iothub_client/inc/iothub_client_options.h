@@ -5,8 +5,11 @@
 #define IOTHUB_CLIENT_OPTIONS_H
 
 #ifdef __cplusplus
+#include <cstddef>
 extern "C"
 {
+#else
+#include <stddef.h>
 #endif
 
     typedef struct IOTHUB_PROXY_OPTIONS_TAG
@@ -16,6 +19,19 @@ extern "C"
         const char* password;
     } IOTHUB_PROXY_OPTIONS;
 
+#define IOTHUB_BLOB_UPLOAD_CHECKPOINT_MAX_SIZE 1024
+
+    /* Persists the checkpoint of an upload to blob (e.g. in a file) so that it can be resumed after a
+       reboot. A checkpoint is a '\0' terminated string of at most IOTHUB_BLOB_UPLOAD_CHECKPOINT_MAX_SIZE
+       characters, terminator included. */
+    typedef struct IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE_TAG
+    {
+        int(*save)(const char* destinationFileName, const char* checkpoint, void* context);                 /* replaces the checkpoint, returns 0 on success */
+        int(*load)(const char* destinationFileName, char* checkpoint, size_t checkpointSize, void* context); /* returns 0 if a checkpoint was copied out */
+        void(*remove)(const char* destinationFileName, void* context);
+        void* context;
+    } IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE;
+
     static const char* OPTION_LOG_TRACE = "logtrace";
     static const char* OPTION_X509_CERT = "x509certificate";
     static const char* OPTION_X509_PRIVATE_KEY = "x509privatekey";
@@ -29,11 +45,35 @@ extern "C"
     static const char* OPTION_SAS_TOKEN_LIFETIME = "sas_token_lifetime";
     static const char* OPTION_SAS_TOKEN_REFRESH_TIME = "sas_token_refresh_time";
     static const char* OPTION_CBS_REQUEST_TIMEOUT = "cbs_request_timeout";
+    static const char* OPTION_SAS_TOKEN_REFRESH_JITTER = "sas_token_refresh_jitter";
+    static const char* OPTION_CBS_MAX_OUTSTANDING_OPERATIONS = "cbs_max_outstanding_operations";
 
     static const char* OPTION_MIN_POLLING_TIME = "MinimumPollingTime";
     static const char* OPTION_BATCHING = "Batching";
+    /* bool: packs queued MQTT telemetry into one PUBLISH tagged mqtt-batch=<count> that the consumer must unpack, see doc/Iothub_sdk_options.md (default false) */
+    static const char* OPTION_MQTT_BATCHING = "mqtt_batching";
+    /* size_t: largest payload the MQTT transport packs batched telemetry into (default 4096) */
+    static const char* OPTION_MQTT_BATCHING_MAX_BYTES = "mqtt_batching_max_bytes";
+    /* size_t: most telemetry messages the MQTT transport packs into one PUBLISH (default 32) */
+    static const char* OPTION_MQTT_BATCHING_MAX_MESSAGES = "mqtt_batching_max_messages";
+    /* tickcounter_ms_t: how long the MQTT transport holds a batch that is not full yet (default 0, only what is already queued) */
+    static const char* OPTION_MQTT_BATCHING_LINGER_MS = "mqtt_batching_linger_ms";
 
     static const char* OPTION_MESSAGE_TIMEOUT = "messageTimeout";
+    /* size_t: most blocks of an upload to blob sent at once, each over its own connection (default 1) */
+    static const char* OPTION_BLOB_UPLOAD_PARALLELISM = "blob_upload_parallelism";
+    /* size_t: times a block of an upload to blob is sent again after a transient failure (default 0) */
+    static const char* OPTION_BLOB_UPLOAD_BLOCK_RETRIES = "blob_upload_block_retries";
+    /* const IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE*: makes uploads to blob resume where an interrupted one stopped (default none) */
+    static const char* OPTION_BLOB_UPLOAD_CHECKPOINT_STORE = "blob_upload_checkpoint_store";
+    /* size_t: slice offered to IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK, at most BLOCK_SIZE (default FILE_UPLOAD_SLICE_SIZE); a blob holds at most 50000 of them */
+    static const char* OPTION_BLOB_UPLOAD_SLICE_SIZE = "blob_upload_slice_size";
+    /* const IOTHUB_MESSAGE_JOURNAL_CONFIG*: keeps telemetry in a message journal on flash or disk until it is delivered, across reboots (default none) */
+    static const char* OPTION_MESSAGE_JOURNAL = "message_journal";
+    /* size_t: times the oldest undelivered journaled message is replayed before it is dropped and reported as IOTHUB_CLIENT_CONFIRMATION_ERROR (default 0, no limit) */
+    static const char* OPTION_MESSAGE_JOURNAL_MAX_REPLAYS = "message_journal_max_replays";
+    /* const IOTHUB_CLIENT_PRIORITY_LANES_CONFIG*: queues events per IOTHUB_MESSAGE_PRIORITY and sends the higher lanes first (default one FIFO) */
+    static const char* OPTION_PRIORITY_LANES = "priority_lanes";
     static const char* OPTION_PRODUCT_INFO = "product_info";
     /*
     * @brief Informs the service of what is the maximum period the client will wait for a keep-alive message from the service.
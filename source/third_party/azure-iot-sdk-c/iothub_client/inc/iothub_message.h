@@ -42,6 +42,17 @@ IOTHUBMESSAGE_UNKNOWN \
 */
 DEFINE_ENUM(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUES);
 
+#define IOTHUB_MESSAGE_PRIORITY_VALUES \
+IOTHUB_MESSAGE_PRIORITY_LOW, \
+IOTHUB_MESSAGE_PRIORITY_NORMAL, \
+IOTHUB_MESSAGE_PRIORITY_HIGH \
+
+/** @brief Enumeration specifying the lane a message is queued in when the
+* client has priority lanes enabled. Messages are created as
+* IOTHUB_MESSAGE_PRIORITY_NORMAL.
+*/
+DEFINE_ENUM(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_VALUES);
+
 typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG* IOTHUB_MESSAGE_HANDLE;
 
 /** @brief diagnostic related data*/
@@ -238,6 +249,80 @@ MOCKABLE_FUNCTION(, const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA*, IoTHubMessag
 */
 MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_RESULT, IoTHubMessage_SetDiagnosticPropertyData, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle, const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA*, diagnosticData);
 
+/**
+* @brief   Sets the priority of the message. The priority only matters when the
+*          client has the priority_lanes option set; the message is otherwise
+*          sent in the order it was queued.
+*
+* @param   iotHubMessageHandle Handle to the message.
+* @param   priority The lane the message is queued in.
+*
+* @return  Returns IOTHUB_MESSAGE_OK if the priority was set successfully
+*          or an error code otherwise.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_RESULT, IoTHubMessage_SetPriority, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle, IOTHUB_MESSAGE_PRIORITY, priority);
+
+/**
+* @brief   Gets the priority of the message.
+*
+* @param   iotHubMessageHandle Handle to the message.
+*
+* @return  The priority of the message, IOTHUB_MESSAGE_PRIORITY_NORMAL if none was set.
+*/
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_PRIORITY, IoTHubMessage_GetPriority, IOTHUB_MESSAGE_HANDLE, iotHubMessageHandle);
+
+/** @brief  Sizes the message pool. Once the pool is set up every message is packed in a
+            single block: the handle, the content and inline_size bytes that hold its
+            system properties. The block is a pool slot when the content and the inline
+            storage fit in slot_size and a slot is free, otherwise it comes from the heap.
+            A slot_count of 0 packs the messages without keeping any slots. With a
+            property_count the block also holds a table of that many application
+            properties and property_size bytes for their keys and values; the MAP
+            returned by IoTHubMessage_Properties lives there and only allocates past it. */
+typedef struct IOTHUB_MESSAGE_POOL_CONFIG_TAG
+{
+    size_t slot_count;
+    size_t slot_size;      /* content and system property bytes one slot holds */
+    size_t inline_size;    /* system property bytes kept after the content of every message */
+    size_t property_count; /* application properties kept in the block, 0 for a MAP of its own */
+    size_t property_size;  /* bytes for the keys and values of those properties */
+} IOTHUB_MESSAGE_POOL_CONFIG;
+
+typedef struct IOTHUB_MESSAGE_POOL_STATISTICS_TAG
+{
+    size_t slots_in_use;
+    size_t max_slots_in_use;
+    size_t pool_allocations; /* messages placed in a slot */
+    size_t heap_allocations; /* messages too big for a slot or created while none was free */
+} IOTHUB_MESSAGE_POOL_STATISTICS;
+
+/**
+* @brief   Sets up the message pool. It is meant to be called once at start up, before
+*          any message is created, and not concurrently with the other functions.
+*
+* @param   config  How many slots to keep and how big they are.
+*
+* @return  0 if the pool was set up, a non-zero value otherwise.
+*/
+MOCKABLE_FUNCTION(, int, IoTHubMessage_InitPool, const IOTHUB_MESSAGE_POOL_CONFIG*, config);
+
+/**
+* @brief   Goes back to building messages from separate allocations. The slots are freed
+*          once the last message placed in them is destroyed. Like IoTHubMessage_InitPool,
+*          it must not run concurrently with the functions that create messages or with
+*          IoTHubMessage_GetPoolStatistics, which may still be using the pool it frees.
+*/
+MOCKABLE_FUNCTION(, void, IoTHubMessage_DeinitPool);
+
+/**
+* @brief   Reports how the message pool has been used since IoTHubMessage_InitPool.
+*
+* @param   statistics  Receives the counters.
+*
+* @return  0 on success, a non-zero value if there is no pool.
+*/
+MOCKABLE_FUNCTION(, int, IoTHubMessage_GetPoolStatistics, IOTHUB_MESSAGE_POOL_STATISTICS*, statistics);
+
 /**
 * @brief   Frees all resources associated with the given message handle.
 *
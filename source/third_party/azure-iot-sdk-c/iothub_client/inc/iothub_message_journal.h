@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/** @file   iothub_message_journal.h
+*	@brief  The @c message journal is an append-only, log-structured store of telemetry
+            messages that outlives reboots, so that messages sent while offline can be
+            replayed once the transport is connected again.
+*/
+
+#ifndef IOTHUB_MESSAGE_JOURNAL_H
+#define IOTHUB_MESSAGE_JOURNAL_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+#include "azure_c_shared_utility/umock_c_prod.h"
+#include "azure_c_shared_utility/journal_storage.h"
+
+#include "iothub_message.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#endif
+
+typedef struct IOTHUB_MESSAGE_JOURNAL_TAG* IOTHUB_MESSAGE_JOURNAL_HANDLE;
+
+/** @brief  Where and how much the journal stores. The journal never takes more than
+            segment_size * max_segments bytes of storage; when it is full the oldest
+            segment is dropped, messages not yet delivered included. The segment being
+            written is also kept in RAM, so segment_size is the RAM cost of the journal. */
+typedef struct IOTHUB_MESSAGE_JOURNAL_CONFIG_TAG
+{
+    const JOURNAL_STORAGE_INTERFACE_DESCRIPTION* storage_interface;
+    const void* storage_parameters;
+    size_t segment_size;
+    size_t max_segments;
+    size_t replay_batch; /* most replayed messages handed to the transport at once */
+} IOTHUB_MESSAGE_JOURNAL_CONFIG;
+
+typedef struct IOTHUB_MESSAGE_JOURNAL_STATISTICS_TAG
+{
+    size_t messages_appended;
+    size_t messages_replayed;
+    size_t messages_evicted;   /* dropped before being acknowledged because the journal was full */
+    size_t records_discarded;  /* found torn or corrupt when the journal was opened */
+    size_t bytes_written;
+    size_t segments_in_use;
+} IOTHUB_MESSAGE_JOURNAL_STATISTICS;
+
+/**
+    * @brief    Opens the journal kept in the storage described by config, recovering the
+    *           messages a previous run left unacknowledged.
+    */
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_JOURNAL_HANDLE, IoTHubMessageJournal_Create, const IOTHUB_MESSAGE_JOURNAL_CONFIG*, config);
+
+/**
+    * @brief    Writes out what is still buffered and closes the journal. Messages not yet
+    *           acknowledged stay in the storage for the next run.
+    */
+MOCKABLE_FUNCTION(, void, IoTHubMessageJournal_Destroy, IOTHUB_MESSAGE_JOURNAL_HANDLE, journal);
+
+/**
+    * @brief    Appends a copy of message to the journal and returns its sequence number.
+    *           The record reaches the storage on the next IoTHubMessageJournal_Flush.
+    */
+MOCKABLE_FUNCTION(, int, IoTHubMessageJournal_Append, IOTHUB_MESSAGE_JOURNAL_HANDLE, journal, IOTHUB_MESSAGE_HANDLE, message, uint32_t*, sequence_number);
+
+/**
+    * @brief    Reads the next message after the replay position that is not acknowledged.
+    *           Returns 0 with *message set to NULL when replay has caught up with the appends.
+    */
+MOCKABLE_FUNCTION(, int, IoTHubMessageJournal_ReadNext, IOTHUB_MESSAGE_JOURNAL_HANDLE, journal, IOTHUB_MESSAGE_HANDLE*, message, uint32_t*, sequence_number);
+
+/**
+    * @brief    Moves the replay position back so that the message sequence_number is read next.
+    */
+MOCKABLE_FUNCTION(, void, IoTHubMessageJournal_Rewind, IOTHUB_MESSAGE_JOURNAL_HANDLE, journal, uint32_t, sequence_number);
+
+/**
+    * @brief    Marks every message up to and including sequence_number as delivered.
+    */
+MOCKABLE_FUNCTION(, void, IoTHubMessageJournal_Acknowledge, IOTHUB_MESSAGE_JOURNAL_HANDLE, journal, uint32_t, sequence_number);
+
+/**
+    * @brief    Writes the appended records and the acknowledgement to the storage and drops
+    *           the oldest segments once everything in them is delivered.
+    */
+MOCKABLE_FUNCTION(, int, IoTHubMessageJournal_Flush, IOTHUB_MESSAGE_JOURNAL_HANDLE, journal);
+
+/**
+    * @brief    Sequence number of the oldest message still kept; anything older was either
+    *           acknowledged or evicted.
+    */
+MOCKABLE_FUNCTION(, uint32_t, IoTHubMessageJournal_GetFirstSequenceNumber, IOTHUB_MESSAGE_JOURNAL_HANDLE, journal);
+
+/**
+    * @brief    Number of messages kept that are not acknowledged yet, replayed or not.
+    */
+MOCKABLE_FUNCTION(, size_t, IoTHubMessageJournal_GetPendingCount, IOTHUB_MESSAGE_JOURNAL_HANDLE, journal);
+
+MOCKABLE_FUNCTION(, int, IoTHubMessageJournal_GetStatistics, IOTHUB_MESSAGE_JOURNAL_HANDLE, journal, IOTHUB_MESSAGE_JOURNAL_STATISTICS*, statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTHUB_MESSAGE_JOURNAL_H */
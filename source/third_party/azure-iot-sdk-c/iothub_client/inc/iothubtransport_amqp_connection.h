@@ -36,6 +36,7 @@ typedef struct AMQP_CONNECTION_CONFIG_TAG
 	const void* on_state_changed_context;
     size_t svc2cl_keep_alive_timeout_secs;
     double cl2svc_keep_alive_send_ratio; 
+    size_t cbs_max_outstanding_operations;
 } AMQP_CONNECTION_CONFIG;
 
 typedef struct AMQP_CONNECTION_INSTANCE* AMQP_CONNECTION_HANDLE;
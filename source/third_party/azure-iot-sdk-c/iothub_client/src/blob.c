@@ -10,6 +10,428 @@
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/tickcounter.h"
+
+/*one connection uploading blocks for Blob_UploadMultipleBlocksFromSasUriParallel*/
+typedef struct BLOB_UPLOAD_WORKER_TAG
+{
+    struct BLOB_PARALLEL_UPLOAD_TAG* upload;
+    HTTPAPIEX_HANDLE httpApiExHandle;
+    THREAD_HANDLE thread;
+    COND_HANDLE wake;               /*posted when a block is handed over or the upload stops*/
+    BUFFER_HANDLE block;            /*copy of the block being uploaded, NULL while idle*/
+    unsigned int blockID;
+    unsigned int httpStatus;
+    BUFFER_HANDLE httpResponse;
+} BLOB_UPLOAD_WORKER;
+
+typedef struct BLOB_PARALLEL_UPLOAD_TAG
+{
+    LOCK_HANDLE lock;               /*guards everything below and the block/blockID of every worker*/
+    COND_HANDLE blockDone;          /*posted by a worker each time it finishes a block*/
+    const char* relativePath;
+    BLOB_UPLOAD_WORKER* workers;
+    size_t workerCount;
+    size_t blocksInFlight;
+    size_t bufferedBytes;
+    int isStopping;
+    int isFailed;                   /*set by the first block that fails; no more blocks are handed out*/
+    BLOB_RESULT failedResult;
+    unsigned int* httpStatus;       /*caller's, written by the first failed block*/
+    BUFFER_HANDLE httpResponse;     /*caller's, written by the first failed block*/
+    BLOB_UPLOAD_STATISTICS statistics;
+} BLOB_PARALLEL_UPLOAD;
+
+static STRING_HANDLE create_block_id_string(unsigned int blockID)
+{
+    STRING_HANDLE result;
+    char temp[7]; /*this will contain 000000... 049999*/
+    if (sprintf(temp, "%6u", (unsigned int)blockID) != 6) /*produces 000000... 049999*/
+    {
+        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+        LogError("failed to sprintf");
+        result = NULL;
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_02_020: [ Blob_UploadMultipleBlocksFromSasUri shall construct a BASE64 encoded string from the block ID (000000... 049999) ]*/
+        result = Base64_Encode_Bytes((const unsigned char*)temp, 6);
+        if (result == NULL)
+        {
+            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+            LogError("unable to Base64_Encode_Bytes");
+        }
+    }
+    return result;
+}
+
+static int append_block_id(STRING_HANDLE blockIDList, STRING_HANDLE blockIdString)
+{
+    int result;
+    /*add the blockId base64 encoded to the XML*/
+    if (!(
+        (STRING_concat(blockIDList, "<Latest>") == 0) &&
+        (STRING_concat_with_STRING(blockIDList, blockIdString) == 0) &&
+        (STRING_concat(blockIDList, "</Latest>") == 0)
+        ))
+    {
+        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+        LogError("unable to STRING_concat");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+/*adds blockID to the block list; returns its base64 form, for Put Block, or NULL*/
+static STRING_HANDLE add_block_id(STRING_HANDLE blockIDList, unsigned int blockID)
+{
+    STRING_HANDLE result = create_block_id_string(blockID);
+    if ((result != NULL) && (append_block_id(blockIDList, result) != 0))
+    {
+        STRING_delete(result);
+        result = NULL;
+    }
+    return result;
+}
+
+/*Put Block of one block, without touching the block list; the block is sent from where it is, without a copy*/
+static BLOB_RESULT put_block(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, unsigned char const * source, size_t size, STRING_HANDLE blockIdString, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_02_022: [ Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId" ]*/
+    STRING_HANDLE newRelativePath = STRING_construct(relativePath);
+    if (newRelativePath == NULL)
+    {
+        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+        LogError("unable to STRING_construct");
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        if (!(
+            (STRING_concat(newRelativePath, "&comp=block&blockid=") == 0) &&
+            (STRING_concat_with_STRING(newRelativePath, blockIdString) == 0)
+            ))
+        {
+            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+            LogError("unable to STRING concatenate");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_BLOB_02_024: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequestWithContent with a PUT operation, passing httpStatus and httpResponse. ]*/
+            /*Codes_SRS_BLOB_99_032: [ Each block shall be sent by `HTTPAPIEX_ExecuteRequestWithContent` straight from the memory `getDataCallbackEx` returned it in, without being copied. ]*/
+            if (HTTPAPIEX_ExecuteRequestWithContent(
+                httpApiExHandle,
+                HTTPAPI_REQUEST_PUT,
+                STRING_c_str(newRelativePath),
+                NULL,
+                source,
+                size,
+                httpStatus,
+                NULL,
+                httpResponse) != HTTPAPIEX_OK
+                )
+            {
+                /*Codes_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequestWithContent fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+                LogError("unable to HTTPAPIEX_ExecuteRequestWithContent");
+                result = BLOB_HTTP_ERROR;
+            }
+            else if (*httpStatus >= 300)
+            {
+                /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
+                LogError("HTTP status from storage does not indicate success (%d)", (int)*httpStatus);
+                result = BLOB_OK;
+            }
+            else
+            {
+                /*Codes_SRS_BLOB_02_027: [ Otherwise Blob_UploadMultipleBlocksFromSasUri shall continue execution. ]*/
+                result = BLOB_OK;
+            }
+        }
+        STRING_delete(newRelativePath);
+    }
+    return result;
+}
+
+/*executes Put Block List with an XML that is already complete*/
+static BLOB_RESULT execute_put_block_list(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, STRING_HANDLE blockIDList, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_02_029: [Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string : base relativePath + "&comp=blocklist"]*/
+    STRING_HANDLE newRelativePath = STRING_construct(relativePath);
+    if (newRelativePath == NULL)
+    {
+        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+        LogError("failed to STRING_construct");
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        if (STRING_concat(newRelativePath, "&comp=blocklist") != 0)
+        {
+            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+            LogError("failed to STRING_concat");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_BLOB_02_030: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing the new relativePath, httpStatus and httpResponse and the XML string as content. ]*/
+            const char* s = STRING_c_str(blockIDList);
+            BUFFER_HANDLE blockIDListAsBuffer = BUFFER_create((const unsigned char*)s, strlen(s));
+            if (blockIDListAsBuffer == NULL)
+            {
+                /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+                LogError("failed to BUFFER_create");
+                result = BLOB_ERROR;
+            }
+            else
+            {
+                if (HTTPAPIEX_ExecuteRequest(
+                    httpApiExHandle,
+                    HTTPAPI_REQUEST_PUT,
+                    STRING_c_str(newRelativePath),
+                    NULL,
+                    blockIDListAsBuffer,
+                    httpStatus,
+                    NULL,
+                    httpResponse
+                ) != HTTPAPIEX_OK)
+                {
+                    /*Codes_SRS_BLOB_02_031: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+                    LogError("unable to HTTPAPIEX_ExecuteRequest");
+                    result = BLOB_HTTP_ERROR;
+                }
+                else
+                {
+                    /*Codes_SRS_BLOB_02_032: [ Otherwise, Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
+                    result = BLOB_OK;
+                }
+                BUFFER_delete(blockIDListAsBuffer);
+            }
+        }
+        STRING_delete(newRelativePath);
+    }
+    return result;
+}
+
+/*completes the XML and executes Put Block List*/
+static BLOB_RESULT put_block_list(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, STRING_HANDLE blockIDList, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    if (STRING_concat(blockIDList, "</BlockList>") != 0)
+    {
+        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+        LogError("failed to STRING_concat");
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        result = execute_put_block_list(httpApiExHandle, relativePath, blockIDList, httpStatus, httpResponse);
+    }
+    return result;
+}
+
+/*splits SASURI into a copy of the hostname and the relative path that follows it*/
+static BLOB_RESULT copy_hostname(const char* SASURI, char** hostname, const char** relativePath)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_02_017: [ Blob_UploadMultipleBlocksFromSasUri shall copy from SASURI the hostname to a new const char* ]*/
+    /*to find the hostname, the following logic is applied:*/
+    /*the hostname starts at the first character after "://"*/
+    /*the hostname ends at the first character before the next "/" after "://"*/
+    const char* hostnameBegin = strstr(SASURI, "://");
+    if (hostnameBegin == NULL)
+    {
+        /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+        LogError("hostname cannot be determined");
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        hostnameBegin += 3; /*have to skip 3 characters which are "://"*/
+        const char* hostnameEnd = strchr(hostnameBegin, '/');
+        if (hostnameEnd == NULL)
+        {
+            /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+            LogError("hostname cannot be determined");
+            result = BLOB_INVALID_ARG;
+        }
+        else
+        {
+            size_t hostnameSize = hostnameEnd - hostnameBegin;
+            *hostname = (char*)malloc(hostnameSize + 1); /*+1 because of '\0' at the end*/
+            if (*hostname == NULL)
+            {
+                /*Codes_SRS_BLOB_02_016: [ If the hostname copy cannot be made then then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+                LogError("oom - out of memory");
+                result = BLOB_ERROR;
+            }
+            else
+            {
+                (void)memcpy(*hostname, hostnameBegin, hostnameSize);
+                (*hostname)[hostnameSize] = '\0';
+
+                /*Codes_SRS_BLOB_02_019: [ Blob_UploadMultipleBlocksFromSasUri shall compute the base relative path of the request from the SASURI parameter. ]*/
+                *relativePath = hostnameEnd; /*this is where the relative path begins in the SasUri*/
+                result = BLOB_OK;
+            }
+        }
+    }
+    return result;
+}
+
+static HTTPAPIEX_HANDLE create_http_handle(const char* hostname, const char* certificates, HTTP_PROXY_OPTIONS* proxyOptions)
+{
+    /*Codes_SRS_BLOB_02_018: [ Blob_UploadMultipleBlocksFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
+    HTTPAPIEX_HANDLE result = HTTPAPIEX_Create(hostname);
+    if (result == NULL)
+    {
+        /*Codes_SRS_BLOB_02_007: [ If HTTPAPIEX_Create fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+        LogError("unable to create a HTTPAPIEX_HANDLE");
+    }
+    else if ((certificates != NULL) && (HTTPAPIEX_SetOption(result, "TrustedCerts", certificates) == HTTPAPIEX_ERROR))
+    {
+        LogError("failure in setting trusted certificates");
+        HTTPAPIEX_Destroy(result);
+        result = NULL;
+    }
+    else if ((proxyOptions != NULL && proxyOptions->host_address != NULL) && HTTPAPIEX_SetOption(result, OPTION_HTTP_PROXY, proxyOptions) == HTTPAPIEX_ERROR)
+    {
+        LogError("failure in setting proxy options");
+        HTTPAPIEX_Destroy(result);
+        result = NULL;
+    }
+    return result;
+}
+
+/*where the blocks of one upload come from: the application's memory through getDataCallbackEx, or the slice
+  filled by fillSliceCallback. Every upload gets its blocks, numbered in order, through next_block*/
+typedef struct BLOB_BLOCK_SOURCE_TAG
+{
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx;
+    IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK fillSliceCallback;
+    void* context;
+    unsigned char* slice;       /*NULL unless fillSliceCallback is used*/
+    size_t sliceSize;
+    unsigned int blockCount;    /*blocks handed out so far, which is also the ID of the next one*/
+} BLOB_BLOCK_SOURCE;
+
+static int is_block_source_valid(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK fillSliceCallback, size_t sliceSize)
+{
+    return ((getDataCallbackEx == NULL) != (fillSliceCallback == NULL)) && (sliceSize != 0) && (sliceSize <= BLOCK_SIZE);
+}
+
+static int open_block_source(BLOB_BLOCK_SOURCE* blocks, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK fillSliceCallback, void* context, size_t sliceSize)
+{
+    int result;
+    blocks->getDataCallbackEx = getDataCallbackEx;
+    blocks->fillSliceCallback = fillSliceCallback;
+    blocks->context = context;
+    blocks->slice = NULL;
+    blocks->sliceSize = sliceSize;
+    blocks->blockCount = 0;
+
+    /*Codes_SRS_BLOB_99_030: [ When `fillSliceCallback` is used, `Blob_UploadMultipleBlocksFromSasUri` shall allocate one slice of `sliceSize` bytes for the whole upload. ]*/
+    if ((fillSliceCallback != NULL) && ((blocks->slice = (unsigned char*)malloc(sliceSize)) == NULL))
+    {
+        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+        LogError("unable to malloc the slice");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static void close_block_source(BLOB_BLOCK_SOURCE* blocks)
+{
+    if (blocks->slice != NULL)
+    {
+        free(blocks->slice);
+    }
+}
+
+/*asks for the next block and checks it against the limits of the service; *size is 0 once the data has ended*/
+static BLOB_RESULT next_block(BLOB_BLOCK_SOURCE* blocks, unsigned char const ** source, size_t* size, unsigned int* blockID)
+{
+    BLOB_RESULT result;
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataResult;
+    size_t maxSize;
+
+    if (blocks->fillSliceCallback != NULL)
+    {
+        /*Codes_SRS_BLOB_99_031: [ `fillSliceCallback` shall be called with the slice and `*size` set to `sliceSize`; the block is the first `*size` bytes of the slice when it returns, and a `*size` bigger than `sliceSize` shall make the upload fail with `BLOB_INVALID_ARG`. ]*/
+        *size = blocks->sliceSize;
+        getDataResult = blocks->fillSliceCallback(FILE_UPLOAD_OK, blocks->slice, size, blocks->context);
+        *source = blocks->slice;
+        maxSize = blocks->sliceSize;
+    }
+    else
+    {
+        *source = NULL;
+        *size = 0;
+        getDataResult = blocks->getDataCallbackEx(FILE_UPLOAD_OK, source, size, blocks->context);
+        maxSize = BLOCK_SIZE;
+    }
+
+    if (getDataResult == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
+    {
+        /*Codes_SRS_BLOB_99_004: [ If `getDataCallbackEx` returns `IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT_ABORT`, then `Blob_UploadMultipleBlocksFromSasUri` shall exit the loop and return `BLOB_ABORTED`. ]*/
+        LogInfo("Upload to blob has been aborted by the user");
+        result = BLOB_ABORTED;
+    }
+    else if ((*source == NULL) || (*size == 0))
+    {
+        /*Codes_SRS_BLOB_99_002: [ If the size of the block returned by `getDataCallbackEx` is 0 or if the data is NULL, then `Blob_UploadMultipleBlocksFromSasUri` shall exit the loop. ]*/
+        *size = 0;
+        result = BLOB_OK;
+    }
+    else if (*size > maxSize)
+    {
+        /*Codes_SRS_BLOB_99_001: [ If the size of the block returned by `getDataCallbackEx` is bigger than 4MB, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
+        LogError("tried to upload block of size %lu, max allowed size is %lu", (unsigned long)*size, (unsigned long)maxSize);
+        result = BLOB_INVALID_ARG;
+    }
+    else if (blocks->blockCount >= MAX_BLOCK_COUNT)
+    {
+        /*Codes_SRS_BLOB_99_003: [ If `getDataCallbackEx` returns more than 50000 blocks, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
+        LogError("unable to upload more than %lu blocks in one blob", (unsigned long)MAX_BLOCK_COUNT);
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        *blockID = blocks->blockCount++;
+        result = BLOB_OK;
+    }
+    return result;
+}
+
+/*adds the block to the block list and sends it*/
+static BLOB_RESULT upload_block(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, unsigned char const * source, size_t size, unsigned int blockID, STRING_HANDLE blockIDList, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    STRING_HANDLE blockIdString = add_block_id(blockIDList, blockID);
+    if (blockIdString == NULL)
+    {
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        result = put_block(httpApiExHandle, relativePath, source, size, blockIdString, httpStatus, httpResponse);
+        STRING_delete(blockIdString);
+    }
+    return result;
+}
 
 BLOB_RESULT Blob_UploadBlock(
         HTTPAPIEX_HANDLE httpApiExHandle,
@@ -34,347 +456,717 @@ BLOB_RESULT Blob_UploadBlock(
     }
     else
     {
-        char temp[7]; /*this will contain 000000... 049999*/
-        if (sprintf(temp, "%6u", (unsigned int)blockID) != 6) /*produces 000000... 049999*/
+        result = upload_block(httpApiExHandle, relativePath, BUFFER_u_char(requestContent), BUFFER_length(requestContent), blockID, blockIDList, httpStatus, httpResponse);
+    }
+    return result;
+}
+
+BLOB_RESULT Blob_UploadMultipleBlocksFromSasUri(const char* SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK fillSliceCallback, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS *proxyOptions, size_t sliceSize)
+{
+    BLOB_RESULT result;
+    char* hostname;
+    const char* relativePath;
+
+    /*Codes_SRS_BLOB_02_001: [ If SASURI is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    if (SASURI == NULL)
+    {
+        LogError("parameter SASURI is NULL");
+        result = BLOB_INVALID_ARG;
+    }
+    /*Codes_SRS_BLOB_02_002: [ If getDataCallback is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    /*Codes_SRS_BLOB_99_034: [ If both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
+    /*Codes_SRS_BLOB_99_033: [ If `sliceSize` is 0 or bigger than 4MB, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
+    else if (!is_block_source_valid(getDataCallbackEx, fillSliceCallback, sliceSize))
+    {
+        LogError("invalid argument getDataCallbackEx=%p fillSliceCallback=%p sliceSize=%lu", getDataCallbackEx, fillSliceCallback, (unsigned long)sliceSize);
+        result = BLOB_INVALID_ARG;
+    }
+    else if ((result = copy_hostname(SASURI, &hostname, &relativePath)) != BLOB_OK)
+    {
+        /*already logged*/
+    }
+    else
+    {
+        HTTPAPIEX_HANDLE httpApiExHandle = create_http_handle(hostname, certificates, proxyOptions);
+        if (httpApiExHandle == NULL)
         {
-            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-            LogError("failed to sprintf");
             result = BLOB_ERROR;
         }
         else
         {
-            STRING_HANDLE blockIdString = Base64_Encode_Bytes((const unsigned char*)temp, 6);
-            if (blockIdString == NULL)
+            /*Codes_SRS_BLOB_02_028: [ Blob_UploadMultipleBlocksFromSasUri shall construct an XML string with the following content: ]*/
+            STRING_HANDLE blockIDList = STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"); /*the XML "build as we go"*/
+            if (blockIDList == NULL)
             {
                 /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                LogError("unable to Base64_Encode_Bytes");
-                result = BLOB_ERROR;
+                LogError("failed to STRING_construct");
+                result = BLOB_HTTP_ERROR;
             }
             else
             {
-                /*add the blockId base64 encoded to the XML*/
-                if (!(
-                    (STRING_concat(blockIDList, "<Latest>") == 0) &&
-                    (STRING_concat_with_STRING(blockIDList, blockIdString) == 0) &&
-                    (STRING_concat(blockIDList, "</Latest>") == 0)
-                    ))
+                BLOB_BLOCK_SOURCE blocks;
+                if (open_block_source(&blocks, getDataCallbackEx, fillSliceCallback, context, sliceSize) != 0)
                 {
-                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                    LogError("unable to STRING_concat");
                     result = BLOB_ERROR;
                 }
                 else
                 {
-                    /*Codes_SRS_BLOB_02_022: [ Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId" ]*/
-                    STRING_HANDLE newRelativePath = STRING_construct(relativePath);
-                    if (newRelativePath == NULL)
-                    {
-                        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                        LogError("unable to STRING_construct");
-                        result = BLOB_ERROR;
-                    }
-                    else
+                    /*Codes_SRS_BLOB_02_021: [ For every block returned by `getDataCallbackEx` the following operations shall happen: ]*/
+                    unsigned int blockID = 0; /* ID of the block being uploaded */
+                    unsigned int isError = 0; /* set to 1 if a block upload fails or if getDataCallbackEx returns incorrect blocks to upload */
+                    unsigned int uploadOneMoreBlock = 1; /* set to 1 while getDataCallbackEx returns correct blocks to upload */
+                    unsigned char const * source; /* the slice or the application's own memory */
+                    size_t size; /* 0 once the data has ended */
+
+                    do
                     {
-                        if (!(
-                            (STRING_concat(newRelativePath, "&comp=block&blockid=") == 0) &&
-                            (STRING_concat_with_STRING(newRelativePath, blockIdString) == 0)
-                            ))
+                        if ((result = next_block(&blocks, &source, &size, &blockID)) != BLOB_OK)
                         {
-                            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                            LogError("unable to STRING concatenate");
-                            result = BLOB_ERROR;
+                            isError = 1;
+                        }
+                        else if (size == 0)
+                        {
+                            uploadOneMoreBlock = 0;
                         }
                         else
                         {
-                            /*Codes_SRS_BLOB_02_024: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing httpStatus and httpResponse. ]*/
-                            if (HTTPAPIEX_ExecuteRequest(
-                                httpApiExHandle,
-                                HTTPAPI_REQUEST_PUT,
-                                STRING_c_str(newRelativePath),
-                                NULL,
-                                requestContent,
-                                httpStatus,
-                                NULL,
-                                httpResponse) != HTTPAPIEX_OK
-                                )
-                            {
-                                /*Codes_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
-                                LogError("unable to HTTPAPIEX_ExecuteRequest");
-                                result = BLOB_HTTP_ERROR;
-                            }
-                            else if (*httpStatus >= 300)
-                            {
-                                /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
-                                LogError("HTTP status from storage does not indicate success (%d)", (int)*httpStatus);
-                                result = BLOB_OK;
-                            }
-                            else
+                            result = upload_block(httpApiExHandle, relativePath, source, size, blockID, blockIDList, httpStatus, httpResponse);
+
+                            /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
+                            if (result != BLOB_OK || *httpStatus >= 300)
                             {
-                                /*Codes_SRS_BLOB_02_027: [ Otherwise Blob_UploadMultipleBlocksFromSasUri shall continue execution. ]*/
-                                result = BLOB_OK;
+                                LogError("unable to upload block %u. Returned value=%d, httpStatus=%u", blockID, result, (result == BLOB_OK) ? *httpStatus : 0);
+                                isError = 1;
                             }
                         }
-                        STRING_delete(newRelativePath);
+                    }
+                    while(uploadOneMoreBlock && !isError);
+                    close_block_source(&blocks);
+
+                    if (isError || result != BLOB_OK)
+                    {
+                        /*do nothing, it will be reported "as is"*/
+                    }
+                    else
+                    {
+                        result = put_block_list(httpApiExHandle, relativePath, blockIDList, httpStatus, httpResponse);
                     }
                 }
+                STRING_delete(blockIDList);
+            }
+            HTTPAPIEX_Destroy(httpApiExHandle);
+        }
+        free(hostname);
+    }
+    return result;
+}
+
+static void destroy_upload_worker(BLOB_UPLOAD_WORKER* worker, HTTPAPIEX_HANDLE sharedHttpApiExHandle)
+{
+    if (worker->httpApiExHandle != sharedHttpApiExHandle)
+    {
+        HTTPAPIEX_Destroy(worker->httpApiExHandle);
+    }
+    if (worker->wake != NULL)
+    {
+        Condition_Deinit(worker->wake);
+    }
+    if (worker->httpResponse != NULL)
+    {
+        BUFFER_delete(worker->httpResponse);
+    }
+}
+
+static int blob_upload_worker_thread(void* arg)
+{
+    BLOB_UPLOAD_WORKER* worker = (BLOB_UPLOAD_WORKER*)arg;
+    BLOB_PARALLEL_UPLOAD* upload = worker->upload;
+    int isDone = 0;
+
+    (void)Lock(upload->lock);
+    while (!isDone)
+    {
+        if (worker->block != NULL)
+        {
+            BUFFER_HANDLE block = worker->block;
+            size_t size = BUFFER_length(block);
+            BLOB_RESULT blockResult;
+            STRING_HANDLE blockIdString;
+
+            (void)Unlock(upload->lock);
+
+            /*Codes_SRS_BLOB_99_016: [ Each worker shall upload the blocks handed to it over its own HTTPAPIEX_HANDLE. ]*/
+            if ((blockIdString = create_block_id_string(worker->blockID)) == NULL)
+            {
+                blockResult = BLOB_ERROR;
+            }
+            else
+            {
+                blockResult = put_block(worker->httpApiExHandle, upload->relativePath, BUFFER_u_char(block), size, blockIdString, &worker->httpStatus, worker->httpResponse);
                 STRING_delete(blockIdString);
             }
+            BUFFER_delete(block);
+
+            (void)Lock(upload->lock);
+            worker->block = NULL;
+            upload->blocksInFlight--;
+            upload->bufferedBytes -= size;
+            if ((blockResult == BLOB_OK) && (worker->httpStatus < 300))
+            {
+                upload->statistics.blocks_uploaded++;
+                upload->statistics.bytes_uploaded += size;
+            }
+            else if (!upload->isFailed)
+            {
+                /*Codes_SRS_BLOB_99_017: [ The first block that fails shall stop the upload; its result, `httpStatus` and `httpResponse` shall be reported as `Blob_UploadMultipleBlocksFromSasUri` reports a failed block. ]*/
+                LogError("unable to upload block %u. Returned value=%d, httpStatus=%u", worker->blockID, blockResult, worker->httpStatus);
+                upload->isFailed = 1;
+                upload->failedResult = blockResult;
+                *upload->httpStatus = worker->httpStatus;
+                if ((blockResult == BLOB_OK) && (BUFFER_build(upload->httpResponse, BUFFER_u_char(worker->httpResponse), BUFFER_length(worker->httpResponse)) != 0))
+                {
+                    LogError("unable to copy the HTTP response of the failed block");
+                }
+            }
+            (void)Condition_Post(upload->blockDone);
+        }
+        else if (upload->isStopping)
+        {
+            isDone = 1;
+        }
+        else
+        {
+            (void)Condition_Wait(worker->wake, upload->lock, 0);
+        }
+    }
+    (void)Unlock(upload->lock);
+
+    return 0;
+}
+
+/*opens one more connection; the first worker reuses the handle that also executes Put Block List*/
+static BLOB_UPLOAD_WORKER* start_upload_worker(BLOB_PARALLEL_UPLOAD* upload, HTTPAPIEX_HANDLE sharedHttpApiExHandle, const char* hostname, const char* certificates, HTTP_PROXY_OPTIONS* proxyOptions)
+{
+    BLOB_UPLOAD_WORKER* result = &upload->workers[upload->workerCount];
+
+    result->upload = upload;
+    result->block = NULL;
+    result->blockID = 0;
+    result->httpStatus = 0;
+    result->wake = NULL;
+    result->httpResponse = NULL;
+    result->httpApiExHandle = (upload->workerCount == 0) ? sharedHttpApiExHandle : create_http_handle(hostname, certificates, proxyOptions);
+
+    if (result->httpApiExHandle == NULL)
+    {
+        result = NULL;
+    }
+    else if (((result->wake = Condition_Init()) == NULL) ||
+        ((result->httpResponse = BUFFER_new()) == NULL))
+    {
+        LogError("unable to allocate the upload worker");
+        destroy_upload_worker(result, sharedHttpApiExHandle);
+        result = NULL;
+    }
+    else if (ThreadAPI_Create(&result->thread, blob_upload_worker_thread, result) != THREADAPI_OK)
+    {
+        LogError("unable to ThreadAPI_Create");
+        destroy_upload_worker(result, sharedHttpApiExHandle);
+        result = NULL;
+    }
+    else
+    {
+        upload->workerCount++;
+        upload->statistics.connections = upload->workerCount;
+    }
+    return result;
+}
+
+/*waits until a block can be handed over without exceeding maxBlocksInFlight; returns NULL when a new worker has to be started*/
+static BLOB_UPLOAD_WORKER* wait_for_idle_worker(BLOB_PARALLEL_UPLOAD* upload, size_t maxBlocksInFlight)
+{
+    BLOB_UPLOAD_WORKER* result = NULL;
+    int canStartWorker = 0;
+
+    while (!upload->isFailed && (result == NULL) && !canStartWorker)
+    {
+        size_t i;
+        for (i = 0; (i < upload->workerCount) && (result == NULL); i++)
+        {
+            if (upload->workers[i].block == NULL)
+            {
+                result = &upload->workers[i];
+            }
+        }
+
+        if (result == NULL)
+        {
+            if (upload->workerCount < maxBlocksInFlight)
+            {
+                canStartWorker = 1;
+            }
+            else
+            {
+                (void)Condition_Wait(upload->blockDone, upload->lock, 0);
+            }
         }
     }
     return result;
 }
 
-BLOB_RESULT Blob_UploadMultipleBlocksFromSasUri(const char* SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS *proxyOptions)
+BLOB_RESULT Blob_UploadMultipleBlocksFromSasUriParallel(const char* SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK fillSliceCallback, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS *proxyOptions, size_t sliceSize, size_t maxBlocksInFlight, BLOB_UPLOAD_STATISTICS* statistics)
 {
     BLOB_RESULT result;
-    /*Codes_SRS_BLOB_02_001: [ If SASURI is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-    if (SASURI == NULL)
+    char* hostname;
+    BLOB_PARALLEL_UPLOAD upload;
+
+    /*Codes_SRS_BLOB_99_010: [ If `SASURI` or `httpStatus` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or `maxBlocksInFlight` is 0, then `Blob_UploadMultipleBlocksFromSasUriParallel` shall fail and return `BLOB_INVALID_ARG`. ]*/
+    if ((SASURI == NULL) || (httpStatus == NULL) || !is_block_source_valid(getDataCallbackEx, fillSliceCallback, sliceSize) || (maxBlocksInFlight == 0))
     {
-        LogError("parameter SASURI is NULL");
+        LogError("invalid argument SASURI=%p getDataCallbackEx=%p fillSliceCallback=%p httpStatus=%p sliceSize=%lu maxBlocksInFlight=%lu", SASURI, getDataCallbackEx, fillSliceCallback, httpStatus, (unsigned long)sliceSize, (unsigned long)maxBlocksInFlight);
         result = BLOB_INVALID_ARG;
     }
+    else if ((result = copy_hostname(SASURI, &hostname, &upload.relativePath)) != BLOB_OK)
+    {
+        /*already logged*/
+    }
     else
     {
-        /*Codes_SRS_BLOB_02_002: [ If getDataCallbackEx is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-        if (getDataCallbackEx == NULL)
+        HTTPAPIEX_HANDLE httpApiExHandle;
+
+        (void)memset(&upload.statistics, 0, sizeof(upload.statistics));
+        upload.workerCount = 0;
+        upload.blocksInFlight = 0;
+        upload.bufferedBytes = 0;
+        upload.isStopping = 0;
+        upload.isFailed = 0;
+        upload.failedResult = BLOB_OK;
+        upload.httpStatus = httpStatus;
+        upload.httpResponse = httpResponse;
+
+        if ((httpApiExHandle = create_http_handle(hostname, certificates, proxyOptions)) == NULL)
         {
-            LogError("IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx is NULL");
-            result = BLOB_INVALID_ARG;
+            result = BLOB_ERROR;
         }
-        /*the below define avoid a "condition always false" on some compilers*/
         else
         {
-            /*Codes_SRS_BLOB_02_017: [ Blob_UploadMultipleBlocksFromSasUri shall copy from SASURI the hostname to a new const char* ]*/
-            /*to find the hostname, the following logic is applied:*/
-            /*the hostname starts at the first character after "://"*/
-            /*the hostname ends at the first character before the next "/" after "://"*/
-            const char* hostnameBegin = strstr(SASURI, "://");
-            if (hostnameBegin == NULL)
+            /*Codes_SRS_BLOB_99_011: [ `Blob_UploadMultipleBlocksFromSasUriParallel` shall upload blocks over at most `maxBlocksInFlight` connections, opening one only when no open connection is idle. ]*/
+            if ((upload.workers = (BLOB_UPLOAD_WORKER*)malloc(maxBlocksInFlight * sizeof(BLOB_UPLOAD_WORKER))) == NULL)
+            {
+                LogError("unable to allocate the upload workers");
+                result = BLOB_ERROR;
+            }
+            else if ((upload.lock = Lock_Init()) == NULL)
+            {
+                LogError("unable to Lock_Init");
+                free(upload.workers);
+                result = BLOB_ERROR;
+            }
+            else if ((upload.blockDone = Condition_Init()) == NULL)
             {
-                /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-                LogError("hostname cannot be determined");
-                result = BLOB_INVALID_ARG;
+                LogError("unable to Condition_Init");
+                (void)Lock_Deinit(upload.lock);
+                free(upload.workers);
+                result = BLOB_ERROR;
             }
             else
             {
-                hostnameBegin += 3; /*have to skip 3 characters which are "://"*/
-                const char* hostnameEnd = strchr(hostnameBegin, '/');
-                if (hostnameEnd == NULL)
+                TICK_COUNTER_HANDLE tickCounter = tickcounter_create();
+                tickcounter_ms_t startTime = 0;
+                BLOB_BLOCK_SOURCE blocks;
+                unsigned int blockID = 0;
+                unsigned int isError = 0;
+                unsigned int uploadOneMoreBlock = 1;
+                int isBlockSourceOpen = 0;
+                int isHttpApiInitialized = 0;
+                unsigned char const * source;
+                size_t size;
+                size_t i;
+
+                if ((tickCounter != NULL) && (tickcounter_get_current_ms(tickCounter, &startTime) != 0))
+                {
+                    LogError("unable to tickcounter_get_current_ms; the upload will not be timed");
+                }
+
+                if (open_block_source(&blocks, getDataCallbackEx, fillSliceCallback, context, sliceSize) != 0)
                 {
-                    /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-                    LogError("hostname cannot be determined");
-                    result = BLOB_INVALID_ARG;
+                    result = BLOB_ERROR;
+                    isError = 1;
                 }
                 else
                 {
-                    size_t hostnameSize = hostnameEnd - hostnameBegin;
-                    char* hostname = (char*)malloc(hostnameSize + 1); /*+1 because of '\0' at the end*/
-                    if (hostname == NULL)
+                    isBlockSourceOpen = 1;
+
+                    /*workers call HTTPAPI_Init/HTTPAPI_Deinit from their own threads; this keeps the first init and the last deinit here*/
+                    if (HTTPAPI_Init() != HTTPAPI_OK)
                     {
-                        /*Codes_SRS_BLOB_02_016: [ If the hostname copy cannot be made then then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                        LogError("oom - out of memory");
+                        LogError("unable to HTTPAPI_Init");
                         result = BLOB_ERROR;
+                        isError = 1;
                     }
                     else
                     {
-                        HTTPAPIEX_HANDLE httpApiExHandle;
-                        (void)memcpy(hostname, hostnameBegin, hostnameSize);
-                        hostname[hostnameSize] = '\0';
+                        isHttpApiInitialized = 1;
+                    }
+                }
+
+                while (uploadOneMoreBlock && !isError)
+                {
+                    /*Codes_SRS_BLOB_99_012: [ `Blob_UploadMultipleBlocksFromSasUriParallel` shall only ask `getDataCallbackEx` for the next block once it can be handed to a connection, so that at most `maxBlocksInFlight` blocks are buffered. ]*/
+                    BLOB_UPLOAD_WORKER* worker;
+                    int isFailed;
 
-                        /*Codes_SRS_BLOB_02_018: [ Blob_UploadMultipleBlocksFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
-                        httpApiExHandle = HTTPAPIEX_Create(hostname);
-                        if (httpApiExHandle == NULL)
+                    (void)Lock(upload.lock);
+                    worker = wait_for_idle_worker(&upload, maxBlocksInFlight);
+                    isFailed = upload.isFailed;
+                    (void)Unlock(upload.lock);
+
+                    if (isFailed)
+                    {
+                        /*reported from upload.failedResult once the workers are stopped*/
+                        isError = 1;
+                    }
+                    else if ((result = next_block(&blocks, &source, &size, &blockID)) != BLOB_OK)
+                    {
+                        isError = 1;
+                    }
+                    else if (size == 0)
+                    {
+                        uploadOneMoreBlock = 0;
+                    }
+                    else if ((worker == NULL) && ((worker = start_upload_worker(&upload, httpApiExHandle, hostname, certificates, proxyOptions)) == NULL))
+                    {
+                        result = BLOB_ERROR;
+                        isError = 1;
+                    }
+                    else
+                    {
+                        /*Codes_SRS_BLOB_99_013: [ Each block shall be copied before the next call to `getDataCallbackEx` and handed to an idle connection. ]*/
+                        BUFFER_HANDLE block = BUFFER_create(source, size);
+                        if (block == NULL)
                         {
-                            /*Codes_SRS_BLOB_02_007: [ If HTTPAPIEX_Create fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
-                            LogError("unable to create a HTTPAPIEX_HANDLE");
+                            LogError("unable to BUFFER_create");
                             result = BLOB_ERROR;
+                            isError = 1;
                         }
                         else
                         {
-                            if ((certificates != NULL)&& (HTTPAPIEX_SetOption(httpApiExHandle, "TrustedCerts", certificates) == HTTPAPIEX_ERROR))
+                            (void)Lock(upload.lock);
+                            worker->block = block;
+                            worker->blockID = blockID;
+                            upload.blocksInFlight++;
+                            upload.bufferedBytes += size;
+                            if (upload.blocksInFlight > upload.statistics.peak_blocks_in_flight)
                             {
-                                LogError("failure in setting trusted certificates");
-                                result = BLOB_ERROR;
+                                upload.statistics.peak_blocks_in_flight = upload.blocksInFlight;
                             }
-                            else if ((proxyOptions != NULL && proxyOptions->host_address != NULL) && HTTPAPIEX_SetOption(httpApiExHandle, OPTION_HTTP_PROXY, proxyOptions) == HTTPAPIEX_ERROR)
+                            if (upload.bufferedBytes > upload.statistics.peak_buffered_bytes)
+                            {
+                                upload.statistics.peak_buffered_bytes = upload.bufferedBytes;
+                            }
+                            (void)Condition_Post(worker->wake);
+                            (void)Unlock(upload.lock);
+                        }
+                    }
+                }
+
+                /*Codes_SRS_BLOB_99_014: [ Before returning, `Blob_UploadMultipleBlocksFromSasUriParallel` shall wait for the blocks in flight and stop every connection. ]*/
+                (void)Lock(upload.lock);
+                while (upload.blocksInFlight > 0)
+                {
+                    (void)Condition_Wait(upload.blockDone, upload.lock, 0);
+                }
+                upload.isStopping = 1;
+                for (i = 0; i < upload.workerCount; i++)
+                {
+                    (void)Condition_Post(upload.workers[i].wake);
+                }
+                (void)Unlock(upload.lock);
+
+                for (i = 0; i < upload.workerCount; i++)
+                {
+                    int threadResult;
+                    (void)ThreadAPI_Join(upload.workers[i].thread, &threadResult);
+                    destroy_upload_worker(&upload.workers[i], httpApiExHandle);
+                }
+
+                if (isHttpApiInitialized)
+                {
+                    HTTPAPI_Deinit();
+                }
+                if (isBlockSourceOpen)
+                {
+                    close_block_source(&blocks);
+                }
+
+                /*a failed block wins over the end of the data, the same as when blocks are uploaded one at a time*/
+                if (upload.isFailed && (result == BLOB_OK))
+                {
+                    result = upload.failedResult;
+                    isError = 1;
+                }
+
+                if (isError || result != BLOB_OK)
+                {
+                    /*do nothing, it will be reported "as is"*/
+                }
+                else
+                {
+                    /*Codes_SRS_BLOB_99_015: [ Blocks may complete in any order; `Blob_UploadMultipleBlocksFromSasUriParallel` shall list them by block ID in the Put Block List XML. ]*/
+                    STRING_HANDLE blockIDList = STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>");
+                    if (blockIDList == NULL)
+                    {
+                        LogError("failed to STRING_construct");
+                        result = BLOB_ERROR;
+                    }
+                    else
+                    {
+                        unsigned int listedBlockID;
+                        for (listedBlockID = 0; (listedBlockID < blocks.blockCount) && (result == BLOB_OK); listedBlockID++)
+                        {
+                            STRING_HANDLE blockIdString = add_block_id(blockIDList, listedBlockID);
+                            if (blockIdString == NULL)
                             {
-                                LogError("failure in setting proxy options");
                                 result = BLOB_ERROR;
                             }
                             else
                             {
-                                /*Codes_SRS_BLOB_02_019: [ Blob_UploadMultipleBlocksFromSasUri shall compute the base relative path of the request from the SASURI parameter. ]*/
-                                const char* relativePath = hostnameEnd; /*this is where the relative path begins in the SasUri*/
+                                STRING_delete(blockIdString);
+                            }
+                        }
+
+                        if (result == BLOB_OK)
+                        {
+                            result = put_block_list(httpApiExHandle, upload.relativePath, blockIDList, httpStatus, httpResponse);
+                        }
+                        STRING_delete(blockIDList);
+                    }
+                }
+
+                if (tickCounter != NULL)
+                {
+                    tickcounter_ms_t endTime;
+                    if (tickcounter_get_current_ms(tickCounter, &endTime) == 0)
+                    {
+                        upload.statistics.elapsed_ms = endTime - startTime;
+                    }
+                    tickcounter_destroy(tickCounter);
+                }
+
+                /*Codes_SRS_BLOB_99_018: [ If `statistics` is not NULL, `Blob_UploadMultipleBlocksFromSasUriParallel` shall fill it in whether or not the upload succeeded. ]*/
+                if (statistics != NULL)
+                {
+                    *statistics = upload.statistics;
+                }
+
+                Condition_Deinit(upload.blockDone);
+                (void)Lock_Deinit(upload.lock);
+                free(upload.workers);
+            }
+            HTTPAPIEX_Destroy(httpApiExHandle);
+        }
+        free(hostname);
+    }
+    return result;
+}
+
+#define MAX_RETRY_DELAY_MS 60000
+
+/*failures that may go away by themselves: no HTTP dialogue, request timeout, throttling and server errors*/
+static int is_transient_failure(BLOB_RESULT result, unsigned int httpStatus)
+{
+    return (result == BLOB_HTTP_ERROR) ||
+        ((result == BLOB_OK) && ((httpStatus == 408) || (httpStatus == 429) || (httpStatus >= 500)));
+}
+
+/*waits and returns 1 when the request that just finished should be sent again*/
+static int retry_after_transient_failure(BLOB_RESULT result, unsigned int httpStatus, const BLOB_UPLOAD_RESUME* resume, size_t* attempt, unsigned int* delayMs)
+{
+    int retry;
+    if (!is_transient_failure(result, httpStatus) || (*attempt >= resume->blockRetries))
+    {
+        retry = 0;
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_99_024: [ A request that fails with a transport error, 408, 429 or 5xx shall be sent again up to `resume->blockRetries` times, waiting `resume->retryDelayMs` before the first retry and twice as long before each one after it. ]*/
+        LogInfo("request failed (result=%d, httpStatus=%u), retrying in %u ms", (int)result, (result == BLOB_OK) ? httpStatus : 0, *delayMs);
+        ThreadAPI_Sleep(*delayMs);
+        (*attempt)++;
+        *delayMs = (*delayMs > MAX_RETRY_DELAY_MS / 2) ? MAX_RETRY_DELAY_MS : (*delayMs * 2);
+        retry = 1;
+    }
+    return retry;
+}
+
+/*sends one block, with retries, and records it in resume once it is stored*/
+static BLOB_RESULT put_block_resumable(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, unsigned char const * source, size_t size, STRING_HANDLE blockIdString, unsigned int blockID, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, BLOB_UPLOAD_RESUME* resume)
+{
+    BLOB_RESULT result;
+    size_t attempt = 0;
+    unsigned int delayMs = resume->retryDelayMs;
+
+    /*source stays valid until the next getDataCallbackEx call, so every retry sends it again as is*/
+    do
+    {
+        result = put_block(httpApiExHandle, relativePath, source, size, blockIdString, httpStatus, httpResponse);
+    } while (retry_after_transient_failure(result, *httpStatus, resume, &attempt, &delayMs));
+
+    if ((result == BLOB_OK) && (*httpStatus < 300))
+    {
+        /*Codes_SRS_BLOB_99_025: [ After each block is stored, `resume->blocksStored` and `resume->bytesStored` shall be updated and `resume->onBlockStored`, if not NULL, shall be called with them. ]*/
+        resume->blocksStored = blockID + 1;
+        resume->bytesStored += size;
+        if (resume->onBlockStored != NULL)
+        {
+            resume->onBlockStored(resume->blocksStored, resume->bytesStored, resume->onBlockStoredContext);
+        }
+    }
+    return result;
+}
+
+BLOB_RESULT Blob_UploadMultipleBlocksFromSasUriResumable(const char* SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK fillSliceCallback, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates, HTTP_PROXY_OPTIONS *proxyOptions, size_t sliceSize, BLOB_UPLOAD_RESUME* resume)
+{
+    BLOB_RESULT result;
+    char* hostname;
+    const char* relativePath;
 
-                                /*Codes_SRS_BLOB_02_028: [ Blob_UploadMultipleBlocksFromSasUri shall construct an XML string with the following content: ]*/
-                                STRING_HANDLE blockIDList = STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"); /*the XML "build as we go"*/
-                                if (blockIDList == NULL)
+    /*Codes_SRS_BLOB_99_020: [ If `SASURI`, `httpStatus` or `resume` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or exactly one of `resume->blocksStored` and `resume->bytesStored` is 0, then `Blob_UploadMultipleBlocksFromSasUriResumable` shall fail and return `BLOB_INVALID_ARG`. ]*/
+    if ((SASURI == NULL) || (httpStatus == NULL) || (resume == NULL) ||
+        !is_block_source_valid(getDataCallbackEx, fillSliceCallback, sliceSize) ||
+        ((resume->blocksStored == 0) != (resume->bytesStored == 0)))
+    {
+        LogError("invalid argument SASURI=%p getDataCallbackEx=%p fillSliceCallback=%p httpStatus=%p sliceSize=%lu resume=%p", SASURI, getDataCallbackEx, fillSliceCallback, httpStatus, (unsigned long)sliceSize, resume);
+        result = BLOB_INVALID_ARG;
+    }
+    else if ((result = copy_hostname(SASURI, &hostname, &relativePath)) != BLOB_OK)
+    {
+        /*already logged*/
+    }
+    else
+    {
+        HTTPAPIEX_HANDLE httpApiExHandle;
+
+        resume->isResumable = 0;
+        if ((httpApiExHandle = create_http_handle(hostname, certificates, proxyOptions)) == NULL)
+        {
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            STRING_HANDLE blockIDList = STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>");
+            if (blockIDList == NULL)
+            {
+                LogError("failed to STRING_construct");
+                result = BLOB_ERROR;
+            }
+            else
+            {
+                unsigned int blocksToSkip = resume->blocksStored;
+                size_t bytesToSkip = resume->bytesStored;
+                unsigned int blockID = 0;
+                unsigned int isError = 0;
+                unsigned int uploadOneMoreBlock = 1;
+                unsigned char const * source;
+                size_t size;
+                BLOB_BLOCK_SOURCE blocks;
+
+                if (open_block_source(&blocks, getDataCallbackEx, fillSliceCallback, context, sliceSize) != 0)
+                {
+                    result = BLOB_ERROR;
+                    isError = 1;
+                }
+                else
+                {
+                    /*Codes_SRS_BLOB_99_021: [ `Blob_UploadMultipleBlocksFromSasUriResumable` shall get the blocks from `getDataCallbackEx` and number them as `Blob_UploadMultipleBlocksFromSasUri` does. ]*/
+                    while (uploadOneMoreBlock && !isError)
+                    {
+                        STRING_HANDLE blockIdString;
+                        if ((result = next_block(&blocks, &source, &size, &blockID)) != BLOB_OK)
+                        {
+                            isError = 1;
+                        }
+                        else if (size == 0)
+                        {
+                            uploadOneMoreBlock = 0;
+                            if (blocks.blockCount < blocksToSkip)
+                            {
+                                /*Codes_SRS_BLOB_99_023: [ If the blocks returned by `getDataCallbackEx` do not match the `resume->blocksStored` blocks and `resume->bytesStored` bytes already stored, `Blob_UploadMultipleBlocksFromSasUriResumable` shall fail and return `BLOB_ERROR`. ]*/
+                                LogError("the source ended after %u blocks, before the %u blocks already stored", blocks.blockCount, blocksToSkip);
+                                result = BLOB_ERROR;
+                                isError = 1;
+                            }
+                        }
+                        else if ((blockIdString = add_block_id(blockIDList, blockID)) == NULL)
+                        {
+                            result = BLOB_ERROR;
+                            isError = 1;
+                        }
+                        else
+                        {
+                            if (blockID < blocksToSkip)
+                            {
+                                /*Codes_SRS_BLOB_99_022: [ The first `resume->blocksStored` blocks shall be added to the block list without being sent again. ]*/
+                                if (size > bytesToSkip)
                                 {
-                                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                    LogError("failed to STRING_construct");
-                                    result = BLOB_HTTP_ERROR;
+                                    /*Codes_SRS_BLOB_99_023: [ If the blocks returned by `getDataCallbackEx` do not match the `resume->blocksStored` blocks and `resume->bytesStored` bytes already stored, `Blob_UploadMultipleBlocksFromSasUriResumable` shall fail and return `BLOB_ERROR`. ]*/
+                                    LogError("block %u goes past the %lu bytes already stored", blockID, (unsigned long)resume->bytesStored);
+                                    result = BLOB_ERROR;
+                                    isError = 1;
                                 }
                                 else
                                 {
-                                    /*Codes_SRS_BLOB_02_021: [ For every block returned by `getDataCallbackEx` the following operations shall happen: ]*/
-                                    unsigned int blockID = 0; /* incremented for each new block */
-                                    unsigned int isError = 0; /* set to 1 if a block upload fails or if getDataCallbackEx returns incorrect blocks to upload */
-                                    unsigned int uploadOneMoreBlock = 1; /* set to 1 while getDataCallbackEx returns correct blocks to upload */
-                                    unsigned char const * source; /* data set by getDataCallbackEx */
-                                    size_t size; /* source size set by getDataCallbackEx */
-                                    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT getDataReturnValue;
-
-                                    do
+                                    bytesToSkip -= size;
+                                    if ((blockID + 1 == blocksToSkip) && (bytesToSkip != 0))
                                     {
-                                        getDataReturnValue = getDataCallbackEx(FILE_UPLOAD_OK, &source, &size, context);
-                                        if (getDataReturnValue == IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_ABORT)
-                                        {
-                                            /*Codes_SRS_BLOB_99_004: [ If `getDataCallbackEx` returns `IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT_ABORT`, then `Blob_UploadMultipleBlocksFromSasUri` shall exit the loop and return `BLOB_ABORTED`. ]*/
-                                            LogInfo("Upload to blob has been aborted by the user");
-                                            uploadOneMoreBlock = 0;
-                                            result = BLOB_ABORTED;
-                                        }
-                                        else if (source == NULL || size == 0)
-                                        {
-                                            /*Codes_SRS_BLOB_99_002: [ If the size of the block returned by `getDataCallbackEx` is 0 or if the data is NULL, then `Blob_UploadMultipleBlocksFromSasUri` shall exit the loop. ]*/
-                                            uploadOneMoreBlock = 0;
-                                            result = BLOB_OK;
-                                        }
-                                        else
-                                        {
-                                            if (size > BLOCK_SIZE)
-                                            {
-                                                /*Codes_SRS_BLOB_99_001: [ If the size of the block returned by `getDataCallbackEx` is bigger than 4MB, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
-                                                LogError("tried to upload block of size %zu, max allowed size is %d", size, BLOCK_SIZE);
-                                                result = BLOB_INVALID_ARG;
-                                                isError = 1;
-                                            }
-                                            else if (blockID >= MAX_BLOCK_COUNT)
-                                            {
-                                                /*Codes_SRS_BLOB_99_003: [ If `getDataCallbackEx` returns more than 50000 blocks, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
-                                                LogError("unable to upload more than %zu blocks in one blob", MAX_BLOCK_COUNT);
-                                                result = BLOB_INVALID_ARG;
-                                                isError = 1;
-                                            }
-                                            else
-                                            {
-                                                /*Codes_SRS_BLOB_02_023: [ Blob_UploadMultipleBlocksFromSasUri shall create a BUFFER_HANDLE from source and size parameters. ]*/
-                                                BUFFER_HANDLE requestContent = BUFFER_create(source, size);
-                                                if (requestContent == NULL)
-                                                {
-                                                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                    LogError("unable to BUFFER_create");
-                                                    result = BLOB_ERROR;
-                                                    isError = 1;
-                                                }
-                                                else
-                                                {
-                                                    result = Blob_UploadBlock(
-                                                            httpApiExHandle,
-                                                            relativePath,
-                                                            requestContent,
-                                                            blockID,
-                                                            blockIDList,
-                                                            httpStatus,
-                                                            httpResponse);
-
-                                                    BUFFER_delete(requestContent);
-                                                }
-
-                                                /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
-                                                if (result != BLOB_OK || *httpStatus >= 300)
-                                                {
-                                                    LogError("unable to Blob_UploadBlock. Returned value=%d, httpStatus=%u", result, httpStatus);
-                                                    isError = 1;
-                                                }
-                                            }
-                                            blockID++;
-                                        }
+                                        LogError("the %u blocks already stored do not cover %lu bytes", blocksToSkip, (unsigned long)resume->bytesStored);
+                                        result = BLOB_ERROR;
+                                        isError = 1;
                                     }
-                                    while(uploadOneMoreBlock && !isError);
-
-                                    if (isError || result != BLOB_OK)
-                                    {
-                                        /*do nothing, it will be reported "as is"*/
-                                    }
-                                    else
-                                    {
-                                        /*complete the XML*/
-                                        if (STRING_concat(blockIDList, "</BlockList>") != 0)
-                                        {
-                                            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                            LogError("failed to STRING_concat");
-                                            result = BLOB_ERROR;
-                                        }
-                                        else
-                                        {
-                                            /*Codes_SRS_BLOB_02_029: [Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string : base relativePath + "&comp=blocklist"]*/
-                                            STRING_HANDLE newRelativePath = STRING_construct(relativePath);
-                                            if (newRelativePath == NULL)
-                                            {
-                                                /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                LogError("failed to STRING_construct");
-                                                result = BLOB_ERROR;
-                                            }
-                                            else
-                                            {
-                                                if (STRING_concat(newRelativePath, "&comp=blocklist") != 0)
-                                                {
-                                                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                    LogError("failed to STRING_concat");
-                                                    result = BLOB_ERROR;
-                                                }
-                                                else
-                                                {
-                                                    /*Codes_SRS_BLOB_02_030: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing the new relativePath, httpStatus and httpResponse and the XML string as content. ]*/
-                                                    const char* s = STRING_c_str(blockIDList);
-                                                    BUFFER_HANDLE blockIDListAsBuffer = BUFFER_create((const unsigned char*)s, strlen(s));
-                                                    if (blockIDListAsBuffer == NULL)
-                                                    {
-                                                        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                        LogError("failed to BUFFER_create");
-                                                        result = BLOB_ERROR;
-                                                    }
-                                                    else
-                                                    {
-                                                        if (HTTPAPIEX_ExecuteRequest(
-                                                            httpApiExHandle,
-                                                            HTTPAPI_REQUEST_PUT,
-                                                            STRING_c_str(newRelativePath),
-                                                            NULL,
-                                                            blockIDListAsBuffer,
-                                                            httpStatus,
-                                                            NULL,
-                                                            httpResponse
-                                                        ) != HTTPAPIEX_OK)
-                                                        {
-                                                            /*Codes_SRS_BLOB_02_031: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
-                                                            LogError("unable to HTTPAPIEX_ExecuteRequest");
-                                                            result = BLOB_HTTP_ERROR;
-                                                        }
-                                                        else
-                                                        {
-                                                            /*Codes_SRS_BLOB_02_032: [ Otherwise, Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
-                                                            result = BLOB_OK;
-                                                        }
-                                                        BUFFER_delete(blockIDListAsBuffer);
-                                                    }
-                                                }
-                                                STRING_delete(newRelativePath);
-                                            }
-                                        }
-                                    }
-                                    STRING_delete(blockIDList);
                                 }
-
                             }
-                            HTTPAPIEX_Destroy(httpApiExHandle);
+                            else
+                            {
+                                result = put_block_resumable(httpApiExHandle, relativePath, source, size, blockIdString, blockID, httpStatus, httpResponse, resume);
+                                if ((result != BLOB_OK) || (*httpStatus >= 300))
+                                {
+                                    LogError("unable to upload block %u. Returned value=%d, httpStatus=%u", blockID, (int)result, (result == BLOB_OK) ? *httpStatus : 0);
+                                    /*Codes_SRS_BLOB_99_026: [ If a block still fails after its retries, `Blob_UploadMultipleBlocksFromSasUriResumable` shall stop and set `resume->isResumable` when the last failure was transient. ]*/
+                                    resume->isResumable = is_transient_failure(result, *httpStatus);
+                                    isError = 1;
+                                }
+                            }
+                            STRING_delete(blockIdString);
                         }
-                        free(hostname);
                     }
+                    close_block_source(&blocks);
+                }
+
+                if (isError || (result != BLOB_OK))
+                {
+                    /*do nothing, it will be reported "as is"*/
+                }
+                else if (STRING_concat(blockIDList, "</BlockList>") != 0)
+                {
+                    LogError("failed to STRING_concat");
+                    result = BLOB_ERROR;
+                }
+                else
+                {
+                    /*Codes_SRS_BLOB_99_027: [ Put Block List shall be retried like a block, and shall set `resume->isResumable` if it still fails for a transient reason. ]*/
+                    size_t attempt = 0;
+                    unsigned int delayMs = resume->retryDelayMs;
+                    do
+                    {
+                        result = execute_put_block_list(httpApiExHandle, relativePath, blockIDList, httpStatus, httpResponse);
+                    } while (retry_after_transient_failure(result, *httpStatus, resume, &attempt, &delayMs));
+                    resume->isResumable = is_transient_failure(result, *httpStatus);
                 }
+                STRING_delete(blockIDList);
             }
+            HTTPAPIEX_Destroy(httpApiExHandle);
         }
+        free(hostname);
     }
     return result;
 }
@@ -25,6 +25,7 @@ typedef struct IOTHUB_AUTHORIZATION_DATA_TAG
 {
     char* device_sas_token;
     char* device_key;
+    SAS_SIGNER_HANDLE device_key_signer;
     char* device_id;
     size_t token_expiry_time_sec;
     IOTHUB_CREDENTIAL_TYPE cred_type;
@@ -186,6 +187,10 @@ void IoTHubClient_Auth_Destroy(IOTHUB_AUTHORIZATION_HANDLE handle)
 #ifdef USE_PROV_MODULE
         iothub_device_auth_destroy(handle->device_auth_handle);
 #endif
+        if (handle->device_key_signer != NULL)
+        {
+            SASToken_DestroySigner(handle->device_key_signer);
+        }
         free(handle->device_key);
         free(handle->device_id);
         free(handle->device_sas_token);
@@ -368,7 +373,6 @@ char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const c
             else
             {
                 const char* key_name = "";
-                STRING_HANDLE sas_token;
                 size_t sec_since_epoch;
 
                 /* Codes_SRS_IoTHub_Authorization_07_010: [ IoTHubClient_Auth_Get_SasToken` shall construct the expiration time using the expiry_time_relative_seconds added to epoch time. ] */
@@ -378,26 +382,32 @@ char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const c
                     LogError("failure getting seconds from epoch");
                     result = NULL;
                 }
+                /* Codes_SRS_IoTHub_Authorization_99_001: [ The first time a sas token is requested for the device key, IoTHubClient_Auth_Get_SasToken shall create a signer for the device key by calling SASToken_CreateSigner and keep it for later requests. ] */
+                else if ((handle->device_key_signer == NULL) &&
+                    ((handle->device_key_signer = SASToken_CreateSigner(handle->device_key)) == NULL))
+                {
+                    /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
+                    LogError("Failed creating the sas token signer");
+                    result = NULL;
+                }
                 else
                 {
-                    /* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_ConnString shall call SASToken_CreateString to construct the sas token. ] */
                     size_t expiry_time = sec_since_epoch+expiry_time_relative_seconds;
-                    if ( (sas_token = SASToken_CreateString(handle->device_key, scope, key_name, expiry_time)) == NULL)
+                    size_t token_size = SASToken_GetMaxTokenSize(scope, key_name);
+
+                    /* Codes_SRS_IoTHub_Authorization_07_012: [ On success IoTHubClient_Auth_Get_ConnString shall allocate and return the sas token in a char*. ] */
+                    if ((result = (char*)malloc(token_size)) == NULL)
                     {
                         /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
-                        LogError("Failed creating sas_token");
-                        result = NULL;
+                        LogError("Failed allocating the sas token");
                     }
-                    else
+                    /* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_ConnString shall call SASToken_SignInto with the device key signer to construct the sas token. ] */
+                    else if (SASToken_SignInto(handle->device_key_signer, scope, key_name, expiry_time, result, token_size) != 0)
                     {
-                        /* Codes_SRS_IoTHub_Authorization_07_012: [ On success IoTHubClient_Auth_Get_ConnString shall allocate and return the sas token in a char*. ] */
-                        if (mallocAndStrcpy_s(&result, STRING_c_str(sas_token) ) != 0)
-                        {
-                            /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
-                            LogError("Failed copying result");
-                            result = NULL;
-                        }
-                        STRING_delete(sas_token);
+                        /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
+                        LogError("Failed creating sas_token");
+                        free(result);
+                        result = NULL;
                     }
                 }
             }
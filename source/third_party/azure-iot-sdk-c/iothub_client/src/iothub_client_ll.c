@@ -19,6 +19,7 @@
 #include "iothub_client_options.h"
 #include "iothub_client_version.h"
 #include "iothub_client_diagnostic.h"
+#include "iothub_message_journal.h"
 #include <stdint.h>
 
 #ifdef USE_PROV_MODULE
@@ -59,6 +60,14 @@ typedef struct IOTHUB_MESSAGE_CALLBACK_DATA_TAG
     void* userContextCallback;
 }IOTHUB_MESSAGE_CALLBACK_DATA;
 
+typedef struct PRIORITY_LANE_TAG
+{
+    DLIST_ENTRY messages; /*IOTHUB_MESSAGE_LIST of the events not yet moved to waitingToSend, in the order they were sent*/
+    size_t bytes;
+    size_t credit; /*events the lane may still move before the lower lanes get their turn*/
+    IOTHUB_CLIENT_PRIORITY_LANE_CONFIG config;
+}PRIORITY_LANE;
+
 typedef struct IOTHUB_CLIENT_LL_HANDLE_DATA_TAG
 {
     DLIST_ENTRY waitingToSend;
@@ -88,8 +97,31 @@ typedef struct IOTHUB_CLIENT_LL_HANDLE_DATA_TAG
     IOTHUB_AUTHORIZATION_HANDLE authorization_module;
     STRING_HANDLE product_info;
     IOTHUB_DIAGNOSTIC_SETTING_DATA diagnostic_setting;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE messageJournal; /*NULL unless OPTION_MESSAGE_JOURNAL was set, then events go through the journal instead of straight to waitingToSend*/
+    size_t journalReplayBatch;
+    DLIST_ENTRY journalInFlight; /*JOURNAL_SEND_DATA of the replayed messages in waitingToSend, in sequence order*/
+    size_t journalInFlightCount;
+    DLIST_ENTRY journalCallbacks; /*JOURNAL_SEND_DATA of the journaled messages that have a confirmation callback, in sequence order*/
+    size_t journalMaxReplays; /*set by OPTION_MESSAGE_JOURNAL_MAX_REPLAYS, 0 replays without limit*/
+    uint32_t journalReplayedSequenceNumber; /*oldest journaled message that failed to be delivered, replayed journalReplayCount times*/
+    size_t journalReplayCount;
+    bool isDisconnected;
+    bool usePriorityLanes; /*set by OPTION_PRIORITY_LANES, then events wait in priorityLanes until IoTHubClient_LL_DoWork moves them to waitingToSend*/
+    size_t prioritySendWindow;
+    PRIORITY_LANE priorityLanes[IOTHUB_CLIENT_PRIORITY_LANE_COUNT]; /*indexed by IOTHUB_MESSAGE_PRIORITY*/
 }IOTHUB_CLIENT_LL_HANDLE_DATA;
 
+typedef struct JOURNAL_SEND_DATA_TAG
+{
+    IOTHUB_CLIENT_LL_HANDLE_DATA* handleData;
+    uint32_t sequenceNumber;
+    bool completed;
+    IOTHUB_CLIENT_CONFIRMATION_RESULT result;
+    IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK callback;
+    void* context;
+    DLIST_ENTRY entry;
+}JOURNAL_SEND_DATA;
+
 static const char HOSTNAME_TOKEN[] = "HostName";
 static const char DEVICEID_TOKEN[] = "DeviceId";
 static const char X509_TOKEN[] = "x509";
@@ -943,6 +975,33 @@ IOTHUB_CLIENT_LL_HANDLE IoTHubClient_LL_CreateWithTransport(const IOTHUB_CLIENT_
     return result;
 }
 
+/*calls, oldest first, the confirmation callbacks of the journaled messages up to throughSequenceNumber*/
+static void complete_journal_callbacks(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, uint32_t throughSequenceNumber, IOTHUB_CLIENT_CONFIRMATION_RESULT result)
+{
+    PDLIST_ENTRY oldest;
+    while ((oldest = handleData->journalCallbacks.Flink) != &(handleData->journalCallbacks))
+    {
+        JOURNAL_SEND_DATA* sendData = containingRecord(oldest, JOURNAL_SEND_DATA, entry);
+        if (sendData->sequenceNumber > throughSequenceNumber)
+        {
+            break;
+        }
+        DList_RemoveEntryList(oldest);
+        sendData->callback(result, sendData->context);
+        free(sendData);
+    }
+}
+
+static void free_journal_in_flight(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData)
+{
+    PDLIST_ENTRY oldest;
+    while ((oldest = DList_RemoveHeadList(&(handleData->journalInFlight))) != &(handleData->journalInFlight))
+    {
+        free(containingRecord(oldest, JOURNAL_SEND_DATA, entry));
+    }
+    handleData->journalInFlightCount = 0;
+}
+
 void IoTHubClient_LL_Destroy(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
 {
     /*Codes_SRS_IOTHUBCLIENT_LL_02_009: [IoTHubClient_LL_Destroy shall do nothing if parameter iotHubClientHandle is NULL.]*/
@@ -970,6 +1029,34 @@ void IoTHubClient_LL_Destroy(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
             free(temp);
         }
 
+        if (handleData->usePriorityLanes)
+        {
+            size_t i;
+            for (i = 0; i < IOTHUB_CLIENT_PRIORITY_LANE_COUNT; i++)
+            {
+                PDLIST_ENTRY laneHead = &(handleData->priorityLanes[i].messages);
+                while ((unsend = DList_RemoveHeadList(laneHead)) != laneHead)
+                {
+                    IOTHUB_MESSAGE_LIST* temp = containingRecord(unsend, IOTHUB_MESSAGE_LIST, entry);
+                    /*Codes_SRS_IOTHUBCLIENT_LL_99_033: [ `IoTHubClient_LL_Destroy` shall complete the event message callbacks still in the priority lanes with `IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY`. ]*/
+                    if (temp->callback != NULL)
+                    {
+                        temp->callback(IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, temp->context);
+                    }
+                    IoTHubMessage_Destroy(temp->messageHandle);
+                    free(temp);
+                }
+            }
+        }
+
+        if (handleData->messageJournal != NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_99_026: [ `IoTHubClient_LL_Destroy` shall destroy the message journal, leaving the messages not yet delivered in it for the next run, and complete the callbacks of the journaled messages with `IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY`. ]*/
+            IoTHubMessageJournal_Destroy(handleData->messageJournal);
+            complete_journal_callbacks(handleData, UINT32_MAX, IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY);
+            free_journal_in_flight(handleData);
+        }
+
         /* Codes_SRS_IOTHUBCLIENT_LL_07_007: [ IoTHubClient_LL_Destroy shall iterate the device twin queues and destroy any remaining items. ] */
         while ((unsend = DList_RemoveHeadList(&(handleData->iot_msg_queue))) != &(handleData->iot_msg_queue))
         {
@@ -995,11 +1082,11 @@ void IoTHubClient_LL_Destroy(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
 
 /*Codes_SRS_IOTHUBCLIENT_LL_02_044: [ Messages already delivered to IoTHubClient_LL shall not have their timeouts modified by a new call to IoTHubClient_LL_SetOption. ]*/
 /*returns 0 on success, any other value is error*/
-static int attach_ms_timesOutAfter(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_LIST *newEntry)
+static int attach_ms_timesOutAfter(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_LIST *newEntry, tickcounter_ms_t messageTimeout)
 {
     int result;
     /*Codes_SRS_IOTHUBCLIENT_LL_02_043: [ Calling IoTHubClient_LL_SetOption with value set to "0" shall disable the timeout mechanism for all new messages. ]*/
-    if (handleData->currentMessageTimeout == 0)
+    if (messageTimeout == 0)
     {
         newEntry->ms_timesOutAfter = 0; /*do not timeout*/
         result = 0;
@@ -1014,13 +1101,349 @@ static int attach_ms_timesOutAfter(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOT
         }
         else
         {
-            newEntry->ms_timesOutAfter += handleData->currentMessageTimeout;
+            newEntry->ms_timesOutAfter += messageTimeout;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+/*clones the event into a new IOTHUB_MESSAGE_LIST that times out messageTimeout ms from now, NULL if that fails*/
+static IOTHUB_MESSAGE_LIST* create_message_list_entry(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback, tickcounter_ms_t messageTimeout)
+{
+    IOTHUB_MESSAGE_LIST* result = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST));
+    if (result == NULL)
+    {
+        LogError("unable to malloc");
+    }
+    else if (attach_ms_timesOutAfter(handleData, result, messageTimeout) != 0)
+    {
+        LogError("unable to set the message timeout");
+        free(result);
+        result = NULL;
+    }
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_013: [IoTHubClient_LL_SendEventAsync shall add the DLIST waitingToSend a new record cloning the information from eventMessageHandle, eventConfirmationCallback, userContextCallback.]*/
+    else if ((result->messageHandle = IoTHubMessage_Clone(eventMessageHandle)) == NULL)
+    {
+        LogError("unable to clone the message");
+        free(result);
+        result = NULL;
+    }
+    else if (IoTHubClient_Diagnostic_AddIfNecessary(&handleData->diagnostic_setting, result->messageHandle) != 0)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_02_014: [If cloning and/or adding the information/diagnostic fails for any reason, IoTHubClient_LL_SendEventAsync shall fail and return IOTHUB_CLIENT_ERROR.] */
+        LogError("unable to add the diagnostic information");
+        IoTHubMessage_Destroy(result->messageHandle);
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        result->callback = eventConfirmationCallback;
+        result->context = userContextCallback;
+    }
+    return result;
+}
+
+/*payload bytes of the message, what the lanes count against max_bytes*/
+static size_t get_message_size(IOTHUB_MESSAGE_HANDLE messageHandle)
+{
+    size_t result;
+    const unsigned char* buffer;
+    const char* text;
+    IOTHUBMESSAGE_CONTENT_TYPE contentType = IoTHubMessage_GetContentType(messageHandle);
+    if (contentType == IOTHUBMESSAGE_BYTEARRAY)
+    {
+        if (IoTHubMessage_GetByteArray(messageHandle, &buffer, &result) != IOTHUB_MESSAGE_OK)
+        {
             result = 0;
         }
     }
+    else if ((contentType == IOTHUBMESSAGE_STRING) && ((text = IoTHubMessage_GetString(messageHandle)) != NULL))
+    {
+        result = strlen(text);
+    }
+    else
+    {
+        result = 0;
+    }
     return result;
 }
 
+static IOTHUB_CLIENT_RESULT send_event_to_priority_lane(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
+{
+    IOTHUB_CLIENT_RESULT result;
+    IOTHUB_MESSAGE_PRIORITY priority = IoTHubMessage_GetPriority(eventMessageHandle);
+    PRIORITY_LANE* lane = &(handleData->priorityLanes[((size_t)priority < IOTHUB_CLIENT_PRIORITY_LANE_COUNT) ? (size_t)priority : (size_t)IOTHUB_MESSAGE_PRIORITY_NORMAL]);
+    size_t messageSize = get_message_size(eventMessageHandle);
+
+    if ((lane->config.max_bytes != 0) && (lane->bytes + messageSize > lane->config.max_bytes))
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_035: [ If the lane would then hold more than `max_bytes` payload bytes, `IoTHubClient_LL_SendEventAsync` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+        LogError("priority lane %d is full (%lu of %lu bytes queued)", (int)priority, (unsigned long)lane->bytes, (unsigned long)lane->config.max_bytes);
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_034: [ If priority lanes are set, `IoTHubClient_LL_SendEventAsync` shall queue the new record in the lane of `IoTHubMessage_GetPriority` instead of waitingToSend, timing out after the `message_timeout_ms` of the lane unless that is 0. ]*/
+        IOTHUB_MESSAGE_LIST* newEntry = create_message_list_entry(handleData, eventMessageHandle, eventConfirmationCallback, userContextCallback,
+            (lane->config.message_timeout_ms != 0) ? (tickcounter_ms_t)lane->config.message_timeout_ms : handleData->currentMessageTimeout);
+        if (newEntry == NULL)
+        {
+            result = IOTHUB_CLIENT_ERROR;
+            LOG_ERROR_RESULT;
+        }
+        else
+        {
+            DList_InsertTailList(&(lane->messages), &(newEntry->entry));
+            lane->bytes += messageSize;
+            result = IOTHUB_CLIENT_OK;
+        }
+    }
+    return result;
+}
+
+/*highest lane that has events and credit left; once every lane with events has used its credit, all of them get their weight again*/
+static PRIORITY_LANE* next_priority_lane(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData)
+{
+    PRIORITY_LANE* result = NULL;
+    bool anyQueued = false;
+    size_t i;
+    for (i = IOTHUB_CLIENT_PRIORITY_LANE_COUNT; (result == NULL) && (i > 0); i--)
+    {
+        PRIORITY_LANE* lane = &(handleData->priorityLanes[i - 1]);
+        if (lane->messages.Flink != &(lane->messages))
+        {
+            anyQueued = true;
+            if (lane->credit > 0)
+            {
+                result = lane;
+            }
+        }
+    }
+
+    if ((result == NULL) && anyQueued)
+    {
+        for (i = 0; i < IOTHUB_CLIENT_PRIORITY_LANE_COUNT; i++)
+        {
+            handleData->priorityLanes[i].credit = handleData->priorityLanes[i].config.weight;
+        }
+        for (i = IOTHUB_CLIENT_PRIORITY_LANE_COUNT; (result == NULL) && (i > 0); i--)
+        {
+            PRIORITY_LANE* lane = &(handleData->priorityLanes[i - 1]);
+            if (lane->messages.Flink != &(lane->messages))
+            {
+                result = lane;
+            }
+        }
+    }
+    return result;
+}
+
+static void schedule_priority_lanes(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData)
+{
+    size_t waiting = 0;
+    PDLIST_ENTRY current;
+    PRIORITY_LANE* lane;
+
+    for (current = handleData->waitingToSend.Flink; (current != &(handleData->waitingToSend)) && (waiting < handleData->prioritySendWindow); current = current->Flink)
+    {
+        waiting++;
+    }
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_036: [ If priority lanes are set, `IoTHubClient_LL_DoWork` shall move events from the lanes to waitingToSend, in the order they were sent within a lane, until `send_window` events are in waitingToSend. ]*/
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_037: [ Each event shall be taken from the highest lane that has events and credit left, using one credit of that lane; when no lane that has events has credit left, every lane shall get its `weight` as credit again. ]*/
+    while ((waiting < handleData->prioritySendWindow) && ((lane = next_priority_lane(handleData)) != NULL))
+    {
+        PDLIST_ENTRY entry = DList_RemoveHeadList(&(lane->messages));
+        size_t messageSize = get_message_size(containingRecord(entry, IOTHUB_MESSAGE_LIST, entry)->messageHandle);
+        lane->bytes = (messageSize < lane->bytes) ? lane->bytes - messageSize : 0;
+        lane->credit--;
+        DList_InsertTailList(&(handleData->waitingToSend), entry);
+        waiting++;
+    }
+}
+
+static IOTHUB_CLIENT_RESULT send_event_to_journal(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
+{
+    IOTHUB_CLIENT_RESULT result;
+    JOURNAL_SEND_DATA* sendData = NULL;
+    uint32_t sequenceNumber;
+
+    if ((eventConfirmationCallback != NULL) &&
+        ((sendData = (JOURNAL_SEND_DATA*)malloc(sizeof(JOURNAL_SEND_DATA))) == NULL))
+    {
+        result = IOTHUB_CLIENT_ERROR;
+        LOG_ERROR_RESULT;
+    }
+    else if (IoTHubMessageJournal_Append(handleData->messageJournal, eventMessageHandle, &sequenceNumber) != 0)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_023: [ If appending to the journal fails, `IoTHubClient_LL_SendEventAsync` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+        result = IOTHUB_CLIENT_ERROR;
+        free(sendData);
+        LOG_ERROR_RESULT;
+    }
+    else
+    {
+        if (sendData != NULL)
+        {
+            sendData->handleData = handleData;
+            sendData->sequenceNumber = sequenceNumber;
+            sendData->completed = false;
+            sendData->result = IOTHUB_CLIENT_CONFIRMATION_OK;
+            sendData->callback = eventConfirmationCallback;
+            sendData->context = userContextCallback;
+            DList_InsertTailList(&(handleData->journalCallbacks), &(sendData->entry));
+        }
+        result = IOTHUB_CLIENT_OK;
+    }
+
+    return result;
+}
+
+/*confirmation callback of the messages replayed from the journal*/
+static void on_journal_send_complete(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* context)
+{
+    JOURNAL_SEND_DATA* sent = (JOURNAL_SEND_DATA*)context;
+    IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = sent->handleData;
+    PDLIST_ENTRY oldest;
+
+    sent->completed = true;
+    sent->result = result;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_028: [ Once a replayed message and all the replayed messages before it are delivered, the journal shall be acknowledged up to it and the confirmation callbacks up to it shall be called with `IOTHUB_CLIENT_CONFIRMATION_OK`. ]*/
+    while ((oldest = handleData->journalInFlight.Flink) != &(handleData->journalInFlight))
+    {
+        JOURNAL_SEND_DATA* oldestSent = containingRecord(oldest, JOURNAL_SEND_DATA, entry);
+        if (!oldestSent->completed || (oldestSent->result != IOTHUB_CLIENT_CONFIRMATION_OK))
+        {
+            break;
+        }
+        IoTHubMessageJournal_Acknowledge(handleData->messageJournal, oldestSent->sequenceNumber);
+        complete_journal_callbacks(handleData, oldestSent->sequenceNumber, IOTHUB_CLIENT_CONFIRMATION_OK);
+        DList_RemoveEntryList(oldest);
+        free(oldestSent);
+        handleData->journalInFlightCount--;
+    }
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_029: [ A replayed message that is not delivered (error, timeout or destroy) shall not be reported; once no replayed message is pending anymore, replay shall start over from the oldest one not delivered. ]*/
+    if (oldest != &(handleData->journalInFlight))
+    {
+        PDLIST_ENTRY current = oldest;
+        while ((current != &(handleData->journalInFlight)) && containingRecord(current, JOURNAL_SEND_DATA, entry)->completed)
+        {
+            current = current->Flink;
+        }
+
+        if (current == &(handleData->journalInFlight))
+        {
+            JOURNAL_SEND_DATA* failed = containingRecord(oldest, JOURNAL_SEND_DATA, entry);
+            uint32_t sequenceNumber = failed->sequenceNumber;
+
+            if (sequenceNumber != handleData->journalReplayedSequenceNumber)
+            {
+                handleData->journalReplayedSequenceNumber = sequenceNumber;
+                handleData->journalReplayCount = 0;
+            }
+            if (failed->result != IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY)
+            {
+                handleData->journalReplayCount++;
+            }
+
+            if ((handleData->journalMaxReplays != 0) && (handleData->journalReplayCount >= handleData->journalMaxReplays))
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_99_045: [ Once the oldest message not delivered has been replayed `OPTION_MESSAGE_JOURNAL_MAX_REPLAYS` times, the journal shall be acknowledged up to it, replay shall start over from the message after it and its confirmation callback shall be called with `IOTHUB_CLIENT_CONFIRMATION_ERROR`. ]*/
+                LogError("dropping journaled message %lu after %lu replays", (unsigned long)sequenceNumber, (unsigned long)handleData->journalReplayCount);
+                IoTHubMessageJournal_Acknowledge(handleData->messageJournal, sequenceNumber);
+                IoTHubMessageJournal_Rewind(handleData->messageJournal, sequenceNumber + 1);
+                free_journal_in_flight(handleData);
+                handleData->journalReplayCount = 0;
+                complete_journal_callbacks(handleData, sequenceNumber, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+            }
+            else
+            {
+                IoTHubMessageJournal_Rewind(handleData->messageJournal, sequenceNumber);
+                free_journal_in_flight(handleData);
+            }
+        }
+    }
+}
+
+static void replay_journal(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData)
+{
+    PDLIST_ENTRY oldest = handleData->journalInFlight.Flink;
+    /*a replayed message was not delivered, the others have to complete before replay starts over*/
+    bool stalled = (oldest != &(handleData->journalInFlight)) && containingRecord(oldest, JOURNAL_SEND_DATA, entry)->completed;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_027: [ Unless the transport reported `IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED`, `IoTHubClient_LL_DoWork` shall read messages from the journal into waitingToSend until `replay_batch` replayed messages are pending. ]*/
+    if (!handleData->isDisconnected && !stalled)
+    {
+        while (handleData->journalInFlightCount < handleData->journalReplayBatch)
+        {
+            IOTHUB_MESSAGE_HANDLE message;
+            uint32_t sequenceNumber;
+            JOURNAL_SEND_DATA* sendData;
+            IOTHUB_MESSAGE_LIST* newEntry;
+
+            if ((IoTHubMessageJournal_ReadNext(handleData->messageJournal, &message, &sequenceNumber) != 0) ||
+                (message == NULL))
+            {
+                break;
+            }
+            else if ((sendData = (JOURNAL_SEND_DATA*)malloc(sizeof(JOURNAL_SEND_DATA))) == NULL)
+            {
+                LogError("failure allocating JOURNAL_SEND_DATA");
+                IoTHubMessage_Destroy(message);
+                IoTHubMessageJournal_Rewind(handleData->messageJournal, sequenceNumber);
+                break;
+            }
+            else if ((newEntry = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST))) == NULL)
+            {
+                LogError("failure allocating IOTHUB_MESSAGE_LIST");
+                free(sendData);
+                IoTHubMessage_Destroy(message);
+                IoTHubMessageJournal_Rewind(handleData->messageJournal, sequenceNumber);
+                break;
+            }
+            else if ((attach_ms_timesOutAfter(handleData, newEntry, handleData->currentMessageTimeout) != 0) ||
+                (IoTHubClient_Diagnostic_AddIfNecessary(&handleData->diagnostic_setting, message) != 0))
+            {
+                LogError("unable to replay message %lu from the journal", (unsigned long)sequenceNumber);
+                free(newEntry);
+                free(sendData);
+                IoTHubMessage_Destroy(message);
+                IoTHubMessageJournal_Rewind(handleData->messageJournal, sequenceNumber);
+                break;
+            }
+            else
+            {
+                sendData->handleData = handleData;
+                sendData->sequenceNumber = sequenceNumber;
+                sendData->completed = false;
+                sendData->result = IOTHUB_CLIENT_CONFIRMATION_OK;
+                sendData->callback = NULL;
+                sendData->context = NULL;
+                DList_InsertTailList(&(handleData->journalInFlight), &(sendData->entry));
+                handleData->journalInFlightCount++;
+
+                newEntry->messageHandle = message;
+                newEntry->callback = on_journal_send_complete;
+                newEntry->context = sendData;
+                DList_InsertTailList(&(handleData->waitingToSend), &(newEntry->entry));
+            }
+        }
+    }
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_030: [ `IoTHubClient_LL_DoWork` shall flush the journal once per call. ]*/
+    if (IoTHubMessageJournal_Flush(handleData->messageJournal) != 0)
+    {
+        LogError("unable to flush the message journal");
+    }
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_031: [ The confirmation callbacks of the messages the journal evicted to make room shall be called with `IOTHUB_CLIENT_CONFIRMATION_ERROR`. ]*/
+    complete_journal_callbacks(handleData, IoTHubMessageJournal_GetFirstSequenceNumber(handleData->messageJournal) - 1, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -1035,9 +1458,19 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotH
         result = IOTHUB_CLIENT_INVALID_ARG;
         LOG_ERROR_RESULT;
     }
+    else if (((IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle)->messageJournal != NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_022: [ If a message journal is set, `IoTHubClient_LL_SendEventAsync` shall append the message to the journal instead of waitingToSend, keep `eventConfirmationCallback` and `userContextCallback` until the message is delivered and return `IOTHUB_CLIENT_OK`. ]*/
+        result = send_event_to_journal((IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle, eventMessageHandle, eventConfirmationCallback, userContextCallback);
+    }
+    else if (((IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle)->usePriorityLanes)
+    {
+        result = send_event_to_priority_lane((IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle, eventMessageHandle, eventConfirmationCallback, userContextCallback);
+    }
     else
     {
-        IOTHUB_MESSAGE_LIST *newEntry = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST));
+        IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle;
+        IOTHUB_MESSAGE_LIST* newEntry = create_message_list_entry(handleData, eventMessageHandle, eventConfirmationCallback, userContextCallback, handleData->currentMessageTimeout);
         if (newEntry == NULL)
         {
             result = IOTHUB_CLIENT_ERROR;
@@ -1045,41 +1478,10 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotH
         }
         else
         {
-            IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle;
-
-            if (attach_ms_timesOutAfter(handleData, newEntry) != 0)
-            {
-                result = IOTHUB_CLIENT_ERROR;
-                LOG_ERROR_RESULT;
-                free(newEntry);
-            }
-            else
-            {
-                /*Codes_SRS_IOTHUBCLIENT_LL_02_013: [IoTHubClient_LL_SendEventAsync shall add the DLIST waitingToSend a new record cloning the information from eventMessageHandle, eventConfirmationCallback, userContextCallback.]*/
-                if ((newEntry->messageHandle = IoTHubMessage_Clone(eventMessageHandle)) == NULL)
-                {
-                    result = IOTHUB_CLIENT_ERROR;
-                    free(newEntry);
-                    LOG_ERROR_RESULT;
-                }
-                else if (IoTHubClient_Diagnostic_AddIfNecessary(&handleData->diagnostic_setting, newEntry->messageHandle) != 0)
-                {
-                    /*Codes_SRS_IOTHUBCLIENT_LL_02_014: [If cloning and/or adding the information/diagnostic fails for any reason, IoTHubClient_LL_SendEventAsync shall fail and return IOTHUB_CLIENT_ERROR.] */
-                    result = IOTHUB_CLIENT_ERROR;
-                    IoTHubMessage_Destroy(newEntry->messageHandle);
-                    free(newEntry);
-                    LOG_ERROR_RESULT;
-                }
-                else
-                {
-                    /*Codes_SRS_IOTHUBCLIENT_LL_02_013: [IoTHubClient_LL_SendEventAsync shall add the DLIST waitingToSend a new record cloning the information from eventMessageHandle, eventConfirmationCallback, userContextCallback.]*/
-                    newEntry->callback = eventConfirmationCallback;
-                    newEntry->context = userContextCallback;
-                    DList_InsertTailList(&(iotHubClientHandle->waitingToSend), &(newEntry->entry));
-                    /*Codes_SRS_IOTHUBCLIENT_LL_02_015: [Otherwise IoTHubClient_LL_SendEventAsync shall succeed and return IOTHUB_CLIENT_OK.] */
-                    result = IOTHUB_CLIENT_OK;
-                }
-            }
+            /*Codes_SRS_IOTHUBCLIENT_LL_02_013: [IoTHubClient_LL_SendEventAsync shall add the DLIST waitingToSend a new record cloning the information from eventMessageHandle, eventConfirmationCallback, userContextCallback.]*/
+            DList_InsertTailList(&(handleData->waitingToSend), &(newEntry->entry));
+            /*Codes_SRS_IOTHUBCLIENT_LL_02_015: [Otherwise IoTHubClient_LL_SendEventAsync shall succeed and return IOTHUB_CLIENT_OK.] */
+            result = IOTHUB_CLIENT_OK;
         }
     }
     return result;
@@ -1245,6 +1647,38 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendMessageDisposition(IOTHUB_CLIENT_LL_HAN
     return result;
 }
 
+/*lane is the PRIORITY_LANE that list belongs to, NULL for waitingToSend*/
+static void DoListTimeouts(PDLIST_ENTRY list, PRIORITY_LANE* lane, tickcounter_ms_t nowTick)
+{
+    DLIST_ENTRY* currentItemInWaitingToSend = list->Flink;
+    while (currentItemInWaitingToSend != list) /*while we are not at the end of the list*/
+    {
+        IOTHUB_MESSAGE_LIST* fullEntry = containingRecord(currentItemInWaitingToSend, IOTHUB_MESSAGE_LIST, entry);
+        /*Codes_SRS_IOTHUBCLIENT_LL_02_041: [ If more than value miliseconds have passed since the call to IoTHubClient_LL_SendEventAsync then the message callback shall be called with a status code of IOTHUB_CLIENT_CONFIRMATION_TIMEOUT. ]*/
+        if ((fullEntry->ms_timesOutAfter != 0) && (fullEntry->ms_timesOutAfter < nowTick))
+        {
+            PDLIST_ENTRY theNext = currentItemInWaitingToSend->Flink; /*need to save the next item, because the below operations are destructive*/
+            DList_RemoveEntryList(currentItemInWaitingToSend);
+            if (lane != NULL)
+            {
+                size_t messageSize = get_message_size(fullEntry->messageHandle);
+                lane->bytes = (messageSize < lane->bytes) ? lane->bytes - messageSize : 0;
+            }
+            if (fullEntry->callback != NULL)
+            {
+                fullEntry->callback(IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT, fullEntry->context);
+            }
+            IoTHubMessage_Destroy(fullEntry->messageHandle); /*because it has been cloned*/
+            free(fullEntry);
+            currentItemInWaitingToSend = theNext;
+        }
+        else
+        {
+            currentItemInWaitingToSend = currentItemInWaitingToSend->Flink;
+        }
+    }
+}
+
 static void DoTimeouts(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData)
 {
     tickcounter_ms_t nowTick;
@@ -1254,26 +1688,14 @@ static void DoTimeouts(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData)
     }
     else
     {
-        DLIST_ENTRY* currentItemInWaitingToSend = handleData->waitingToSend.Flink;
-        while (currentItemInWaitingToSend != &(handleData->waitingToSend)) /*while we are not at the end of the list*/
+        DoListTimeouts(&(handleData->waitingToSend), NULL, nowTick);
+        if (handleData->usePriorityLanes)
         {
-            IOTHUB_MESSAGE_LIST* fullEntry = containingRecord(currentItemInWaitingToSend, IOTHUB_MESSAGE_LIST, entry);
-            /*Codes_SRS_IOTHUBCLIENT_LL_02_041: [ If more than value miliseconds have passed since the call to IoTHubClient_LL_SendEventAsync then the message callback shall be called with a status code of IOTHUB_CLIENT_CONFIRMATION_TIMEOUT. ]*/
-            if ((fullEntry->ms_timesOutAfter != 0) && (fullEntry->ms_timesOutAfter < nowTick))
-            {
-                PDLIST_ENTRY theNext = currentItemInWaitingToSend->Flink; /*need to save the next item, because the below operations are destructive*/
-                DList_RemoveEntryList(currentItemInWaitingToSend);
-                if (fullEntry->callback != NULL)
-                {
-                    fullEntry->callback(IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT, fullEntry->context);
-                }
-                IoTHubMessage_Destroy(fullEntry->messageHandle); /*because it has been cloned*/
-                free(fullEntry);
-                currentItemInWaitingToSend = theNext;
-            }
-            else
+            size_t i;
+            for (i = 0; i < IOTHUB_CLIENT_PRIORITY_LANE_COUNT; i++)
             {
-                currentItemInWaitingToSend = currentItemInWaitingToSend->Flink;
+                /*Codes_SRS_IOTHUBCLIENT_LL_99_038: [ Events still in a priority lane shall time out the same way as the ones in waitingToSend. ]*/
+                DoListTimeouts(&(handleData->priorityLanes[i].messages), &(handleData->priorityLanes[i]), nowTick);
             }
         }
     }
@@ -1321,6 +1743,16 @@ void IoTHubClient_LL_DoWork(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
             client_item = next_item;
         }
 
+        if (handleData->messageJournal != NULL)
+        {
+            replay_journal(handleData);
+        }
+
+        if (handleData->usePriorityLanes)
+        {
+            schedule_priority_lanes(handleData);
+        }
+
         /*Codes_SRS_IOTHUBCLIENT_LL_02_021: [Otherwise, IoTHubClient_LL_DoWork shall invoke the underlaying layer's _DoWork function.]*/
         handleData->IoTHubTransport_DoWork(handleData->transportHandle, iotHubClientHandle);
     }
@@ -1343,6 +1775,26 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_GetSendStatus(IOTHUB_CLIENT_LL_HANDLE iotHu
         /* Codes_SRS_IOTHUBCLIENT_09_008: [IoTHubClient_GetSendStatus shall return IOTHUB_CLIENT_OK and status IOTHUB_CLIENT_SEND_STATUS_IDLE if there is currently no items to be sent] */
         /* Codes_SRS_IOTHUBCLIENT_09_009: [IoTHubClient_GetSendStatus shall return IOTHUB_CLIENT_OK and status IOTHUB_CLIENT_SEND_STATUS_BUSY if there are currently items to be sent] */
         result = handleData->IoTHubTransport_GetSendStatus(handleData->deviceHandle, iotHubClientStatus);
+        if ((result == IOTHUB_CLIENT_OK) && (*iotHubClientStatus == IOTHUB_CLIENT_SEND_STATUS_IDLE) && handleData->usePriorityLanes)
+        {
+            size_t i;
+            for (i = 0; i < IOTHUB_CLIENT_PRIORITY_LANE_COUNT; i++)
+            {
+                if (handleData->priorityLanes[i].messages.Flink != &(handleData->priorityLanes[i].messages))
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_LL_99_039: [ If the underlaying layer reports `IOTHUB_CLIENT_SEND_STATUS_IDLE` but a priority lane still has events, `IoTHubClient_LL_GetSendStatus` shall report `IOTHUB_CLIENT_SEND_STATUS_BUSY`. ]*/
+                    *iotHubClientStatus = IOTHUB_CLIENT_SEND_STATUS_BUSY;
+                    break;
+                }
+            }
+        }
+
+        if ((result == IOTHUB_CLIENT_OK) && (*iotHubClientStatus == IOTHUB_CLIENT_SEND_STATUS_IDLE) &&
+            (handleData->messageJournal != NULL) && (IoTHubMessageJournal_GetPendingCount(handleData->messageJournal) > 0))
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_99_046: [ If the underlaying layer reports `IOTHUB_CLIENT_SEND_STATUS_IDLE` but the message journal still has messages not delivered, `IoTHubClient_LL_GetSendStatus` shall report `IOTHUB_CLIENT_SEND_STATUS_BUSY`. ]*/
+            *iotHubClientStatus = IOTHUB_CLIENT_SEND_STATUS_BUSY;
+        }
     }
 
     return result;
@@ -1562,6 +2014,9 @@ void IoTHubClient_LL_ConnectionStatusCallBack(IOTHUB_CLIENT_LL_HANDLE handle, IO
     {
         IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_HANDLE_DATA*)handle;
 
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_032: [ `IoTHubClient_LL_ConnectionStatusCallBack` shall stop the replay of the message journal while `status` is `IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED`. ]*/
+        handleData->isDisconnected = (status == IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED);
+
         /*Codes_SRS_IOTHUBCLIENT_LL_25_114: [IoTHubClient_LL_ConnectionStatusCallBack shall call non-callback set by the user from IoTHubClient_LL_SetConnectionStatusCallback passing the status, reason and the passed userContextCallback.]*/
         if (handleData->conStatusCallback != NULL)
         {
@@ -1749,6 +2204,74 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SetOption(IOTHUB_CLIENT_LL_HANDLE iotHubCli
                 result = IOTHUB_CLIENT_OK;
             }
         }
+        else if (strcmp(optionName, OPTION_MESSAGE_JOURNAL) == 0)
+        {
+            const IOTHUB_MESSAGE_JOURNAL_CONFIG* journalConfig = (const IOTHUB_MESSAGE_JOURNAL_CONFIG*)value;
+            if (journalConfig->replay_batch == 0)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_99_025: [ If `replay_batch` is 0, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`; if a journal is already set or it cannot be opened, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+                LogError("replay_batch of the message journal cannot be 0");
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else if (handleData->messageJournal != NULL)
+            {
+                LogError("the message journal is already set");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            /*Codes_SRS_IOTHUBCLIENT_LL_99_024: [ `OPTION_MESSAGE_JOURNAL` - `value` is a pointer to an `IOTHUB_MESSAGE_JOURNAL_CONFIG`; `IoTHubClient_LL_SetOption` shall open the journal with `IoTHubMessageJournal_Create`, after which the messages it kept from a previous run are replayed too. ]*/
+            else if ((handleData->messageJournal = IoTHubMessageJournal_Create(journalConfig)) == NULL)
+            {
+                LogError("unable to open the message journal");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                handleData->journalReplayBatch = journalConfig->replay_batch;
+                DList_InitializeListHead(&(handleData->journalInFlight));
+                DList_InitializeListHead(&(handleData->journalCallbacks));
+                handleData->journalInFlightCount = 0;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        else if (strcmp(optionName, OPTION_MESSAGE_JOURNAL_MAX_REPLAYS) == 0)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_99_044: [ `OPTION_MESSAGE_JOURNAL_MAX_REPLAYS` - `value` is a pointer to a `size_t` with the times the oldest message not delivered is replayed before it is dropped; 0, the default, replays it until it is delivered. ]*/
+            handleData->journalMaxReplays = *(const size_t*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
+        else if (strcmp(optionName, OPTION_PRIORITY_LANES) == 0)
+        {
+            const IOTHUB_CLIENT_PRIORITY_LANES_CONFIG* lanesConfig = (const IOTHUB_CLIENT_PRIORITY_LANES_CONFIG*)value;
+            size_t i;
+            for (i = 0; (i < IOTHUB_CLIENT_PRIORITY_LANE_COUNT) && (lanesConfig->lanes[i].weight != 0); i++)
+            {
+            }
+
+            if ((lanesConfig->send_window == 0) || (i < IOTHUB_CLIENT_PRIORITY_LANE_COUNT))
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_99_041: [ If `send_window` or the `weight` of any lane is 0, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+                LogError("send_window and the weight of every priority lane must be above 0");
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_99_040: [ `OPTION_PRIORITY_LANES` - `value` is a pointer to an `IOTHUB_CLIENT_PRIORITY_LANES_CONFIG` that is copied; setting it again keeps the events already queued in the lanes. ]*/
+                for (i = 0; i < IOTHUB_CLIENT_PRIORITY_LANE_COUNT; i++)
+                {
+                    PRIORITY_LANE* lane = &(handleData->priorityLanes[i]);
+                    if (!handleData->usePriorityLanes)
+                    {
+                        DList_InitializeListHead(&(lane->messages));
+                        lane->bytes = 0;
+                    }
+                    lane->config = lanesConfig->lanes[i];
+                    lane->credit = lane->config.weight;
+                }
+                handleData->prioritySendWindow = lanesConfig->send_window;
+                handleData->usePriorityLanes = true;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
         else
         {
 
@@ -2122,7 +2645,7 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob(IOTHUB_CLIENT_LL
         uploadMultipleBlocksWrapperContext.getDataCallback = getDataCallback;
         uploadMultipleBlocksWrapperContext.context = context;
     
-        result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(iotHubClientHandle->uploadToBlobHandle, destinationFileName, uploadMultipleBlocksCallbackWrapper, &uploadMultipleBlocksWrapperContext);
+        result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(iotHubClientHandle->uploadToBlobHandle, destinationFileName, uploadMultipleBlocksCallbackWrapper, NULL, &uploadMultipleBlocksWrapperContext);
     }
     return result;
 }
@@ -2144,7 +2667,28 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlobEx(IOTHUB_CLIENT_
     }
     else
     {
-        result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(iotHubClientHandle->uploadToBlobHandle, destinationFileName, getDataCallbackEx, context);
+        result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(iotHubClientHandle->uploadToBlobHandle, destinationFileName, getDataCallbackEx, NULL, context);
+    }
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadSlicesToBlob(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK fillSliceCallback, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_048: [ If `iotHubClientHandle`, `destinationFileName` or `fillSliceCallback` is `NULL` then `IoTHubClient_LL_UploadSlicesToBlob` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+    if (
+        (iotHubClientHandle == NULL) ||
+        (destinationFileName == NULL) ||
+        (fillSliceCallback == NULL)
+        )
+    {
+        LogError("invalid parameters IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle=%p, destinationFileName=%p, fillSliceCallback=%p", iotHubClientHandle, destinationFileName, fillSliceCallback);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_049: [ `IoTHubClient_LL_UploadSlicesToBlob` shall call `IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl` with `fillSliceCallback` and `context` and return what it returns. ]*/
+        result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(iotHubClientHandle->uploadToBlobHandle, destinationFileName, NULL, fillSliceCallback, context);
     }
     return result;
 }
@@ -46,6 +46,8 @@ int snprintf(char * s, size_t n, const char * format, ...)
 #define FILE_UPLOAD_FAILED_BODY "{ \"isSuccess\":false, \"statusCode\":-1,\"statusDescription\" : \"client not able to connect with the server\" }"
 #define FILE_UPLOAD_ABORTED_BODY "{ \"isSuccess\":false, \"statusCode\":-1,\"statusDescription\" : \"file upload aborted\" }"
 
+#define BLOB_UPLOAD_RETRY_DELAY_MS 1000
+
 #define AUTHORIZATION_SCHEME_VALUES \
     DEVICE_KEY, \
     X509,       \
@@ -71,6 +73,10 @@ typedef struct IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA_TAG
     char* certificates; /*if there are any certificates used*/
     HTTP_PROXY_OPTIONS http_proxy_options;
     size_t curl_verbose;
+    size_t blob_upload_parallelism; /*most blocks uploaded at once; 1 uploads them one after the other*/
+    size_t blob_upload_slice_size; /*size of the slice offered to `fillSliceCallback`*/
+    size_t blob_upload_block_retries; /*times a block is sent again after a transient failure*/
+    IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE checkpoint_store; /*all NULL when uploads are not resumable*/
 }IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA;
 
 typedef struct BLOB_UPLOAD_CONTEXT_TAG
@@ -80,6 +86,15 @@ typedef struct BLOB_UPLOAD_CONTEXT_TAG
     size_t remainingSizeToUpload; /* size not yet uploaded */
 }BLOB_UPLOAD_CONTEXT;
 
+/*what is saved after every stored block: "<blocksStored> <bytesStored> <correlationId> <sasUri>"*/
+typedef struct BLOB_UPLOAD_CHECKPOINT_TAG
+{
+    const IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE* store;
+    const char* destinationFileName;
+    STRING_HANDLE correlationId;
+    STRING_HANDLE sasUri;
+}BLOB_UPLOAD_CHECKPOINT;
+
 IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE IoTHubClient_LL_UploadToBlob_Create(const IOTHUB_CLIENT_CONFIG* config)
 {
     IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = malloc(sizeof(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA));
@@ -123,6 +138,10 @@ IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE IoTHubClient_LL_UploadToBlob_Create(const I
                 handleData->certificates = NULL;
                 memset(&(handleData->http_proxy_options), 0, sizeof(HTTP_PROXY_OPTIONS));
                 handleData->curl_verbose = 0;
+                handleData->blob_upload_parallelism = 1;
+                handleData->blob_upload_slice_size = FILE_UPLOAD_SLICE_SIZE;
+                handleData->blob_upload_block_retries = 0;
+                memset(&(handleData->checkpoint_store), 0, sizeof(IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE));
 
                 if ((config->deviceSasToken != NULL) && (config->deviceKey == NULL))
                 {
@@ -446,11 +465,11 @@ static int IoTHubClient_LL_UploadToBlob_step1and2(IOTHUB_CLIENT_LL_UPLOADTOBLOB_
                                     else
                                     {
                                         /*Codes_SRS_IOTHUBCLIENT_LL_02_081: [ Otherwise, IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall use parson to extract and save the following information from the response buffer: correlationID and SasUri. ]*/
-                                        JSON_Value* allJson = json_parse_string(STRING_c_str(responseAsString));
+                                        JSON_Value* allJson = json_parse_string_with_arena(STRING_c_str(responseAsString));
                                         if (allJson == NULL)
                                         {
                                             /*Codes_SRS_IOTHUBCLIENT_LL_02_082: [ If extracting and saving the correlationId or SasUri fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-                                            LogError("unable to json_parse_string");
+                                            LogError("unable to json_parse_string_with_arena");
                                             result = __FAILURE__;
                                         }
                                         else
@@ -529,37 +548,24 @@ static int IoTHubClient_LL_UploadToBlob_step1and2(IOTHUB_CLIENT_LL_UPLOADTOBLOB_
                                                                         else
                                                                         {
                                                                             /*Codes_SRS_IOTHUBCLIENT_LL_32_008: [ The returned file name shall be URL encoded before passing back to the cloud. ]*/
-                                                                            STRING_HANDLE fileName = URL_EncodeString(json_blobName);
-																			
-																			if (fileName == NULL)
-																			{
-                                                                                /*Codes_SRS_IOTHUBCLIENT_LL_32_009: [ If URL_EncodeString fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-																				LogError("unable to URL_EncodeString of filename");
-																				result = __FAILURE__;
-																			}
-
-                                                                            else 
-																			{
-																				if (!(
-																					(STRING_concat(sasUri, json_hostName) == 0) &&
-																					(STRING_concat(sasUri, "/") == 0) &&
-																					(STRING_concat(sasUri, json_containerName) == 0) &&
-																					(STRING_concat(sasUri, "/") == 0) &&
-																					(STRING_concat(sasUri, STRING_c_str(fileName)) == 0) &&
-																					(STRING_concat(sasUri, json_sasToken) == 0)
-																					))
-																				{
-																					/*Codes_SRS_IOTHUBCLIENT_LL_02_082: [ If extracting and saving the correlationId or SasUri fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-																					LogError("unable to STRING_concat");
-																					result = __FAILURE__;
-																				}
-																				else
-																				{
-																					result = 0; /*success in step 1*/
-																				}
-																				
-																				STRING_delete(fileName);
-																			}	
+                                                                            if (!(
+                                                                                (STRING_concat(sasUri, json_hostName) == 0) &&
+                                                                                (STRING_concat(sasUri, "/") == 0) &&
+                                                                                (STRING_concat(sasUri, json_containerName) == 0) &&
+                                                                                (STRING_concat(sasUri, "/") == 0) &&
+                                                                                (URL_EncodeConcat(sasUri, json_blobName) == 0) &&
+                                                                                (STRING_concat(sasUri, json_sasToken) == 0)
+                                                                                ))
+                                                                            {
+                                                                                /*Codes_SRS_IOTHUBCLIENT_LL_02_082: [ If extracting and saving the correlationId or SasUri fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                                                                                /*Codes_SRS_IOTHUBCLIENT_LL_32_009: [ If URL encoding the file name fails then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                                                                                LogError("unable to build the SAS URI of the blob");
+                                                                                result = __FAILURE__;
+                                                                            }
+                                                                            else
+                                                                            {
+                                                                                result = 0; /*success in step 1*/
+                                                                            }
                                                                         }
                                                                     }
                                                                 }
@@ -804,20 +810,85 @@ static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_GetData_Callback(IOT
     return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
 }
 
-IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, void* context)
+static void save_checkpoint(unsigned int blocksStored, size_t bytesStored, void* context)
+{
+    BLOB_UPLOAD_CHECKPOINT* checkpoint = (BLOB_UPLOAD_CHECKPOINT*)context;
+    char text[IOTHUB_BLOB_UPLOAD_CHECKPOINT_MAX_SIZE];
+    int length = snprintf(text, sizeof(text), "%u %lu %s %s", blocksStored, (unsigned long)bytesStored, STRING_c_str(checkpoint->correlationId), STRING_c_str(checkpoint->sasUri));
+    if ((length < 0) || ((size_t)length >= sizeof(text)))
+    {
+        LogError("checkpoint does not fit in %d characters, the upload cannot be resumed", IOTHUB_BLOB_UPLOAD_CHECKPOINT_MAX_SIZE);
+    }
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_016: [ After every stored block, `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall save a checkpoint with the blocks and bytes stored, the correlation ID and the SAS URI. ]*/
+    else if (checkpoint->store->save(checkpoint->destinationFileName, text, checkpoint->store->context) != 0)
+    {
+        LogError("unable to save the checkpoint of %s", checkpoint->destinationFileName);
+    }
+}
+
+/*returns 0 when destinationFileName has a checkpoint, which is then in resume, correlationId and sasUri*/
+static int load_checkpoint(const IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE* store, const char* destinationFileName, STRING_HANDLE correlationId, STRING_HANDLE sasUri, BLOB_UPLOAD_RESUME* resume)
+{
+    int result;
+    char text[IOTHUB_BLOB_UPLOAD_CHECKPOINT_MAX_SIZE];
+    if (store->load(destinationFileName, text, sizeof(text), store->context) != 0)
+    {
+        /*nothing to resume*/
+        result = __FAILURE__;
+    }
+    else
+    {
+        char* cursor;
+        unsigned long blocksStored;
+        unsigned long bytesStored;
+        const char* correlationIdBegin;
+        const char* correlationIdEnd;
+
+        text[sizeof(text) - 1] = '\0';
+        blocksStored = strtoul(text, &cursor, 10);
+        bytesStored = strtoul(cursor, &cursor, 10);
+        correlationIdBegin = cursor + ((*cursor == ' ') ? 1 : 0);
+        correlationIdEnd = strchr(correlationIdBegin, ' ');
+        if ((*cursor != ' ') || (correlationIdEnd == NULL) || (correlationIdEnd == correlationIdBegin) || (correlationIdEnd[1] == '\0') ||
+            ((blocksStored == 0) != (bytesStored == 0)))
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_99_018: [ A checkpoint that cannot be parsed shall be removed and the upload shall start over. ]*/
+            LogError("checkpoint of %s is malformed, starting over", destinationFileName);
+            store->remove(destinationFileName, store->context);
+            result = __FAILURE__;
+        }
+        else if ((STRING_copy_n(correlationId, correlationIdBegin, correlationIdEnd - correlationIdBegin) != 0) ||
+            (STRING_copy(sasUri, correlationIdEnd + 1) != 0))
+        {
+            LogError("unable to copy the checkpoint of %s", destinationFileName);
+            result = __FAILURE__;
+        }
+        else
+        {
+            LogInfo("resuming the upload of %s after %lu blocks", destinationFileName, blocksStored);
+            resume->blocksStored = (unsigned int)blocksStored;
+            resume->bytesStored = (size_t)bytesStored;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX getDataCallbackEx, IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK fillSliceCallback, void* context)
 {
     IOTHUB_CLIENT_RESULT result;
 
     /*Codes_SRS_IOTHUBCLIENT_LL_02_061: [ If handle is NULL then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
     /*Codes_SRS_IOTHUBCLIENT_LL_02_062: [ If destinationFileName is NULL then IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
 
+    /*Codes_SRS_IOTHUBCLIENT_LL_99_047: [ If both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
     if (
         (handle == NULL) ||
         (destinationFileName == NULL) ||
-        (getDataCallbackEx == NULL)
+        ((getDataCallbackEx == NULL) == (fillSliceCallback == NULL))
         )
     {
-        LogError("invalid argument detected handle=%p destinationFileName=%p getDataCallbackEx=%p", handle, destinationFileName, getDataCallbackEx);
+        LogError("invalid argument detected handle=%p destinationFileName=%p getDataCallbackEx=%p fillSliceCallback=%p", handle, destinationFileName, getDataCallbackEx, fillSliceCallback);
         result = IOTHUB_CLIENT_INVALID_ARG;
     }
     else
@@ -909,8 +980,25 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IOTHUB_CLIE
                                 }
                                 else
                                 {
+                                    int isResumableUpload = (handleData->checkpoint_store.save != NULL);
+                                    BLOB_UPLOAD_CHECKPOINT checkpoint;
+                                    BLOB_UPLOAD_RESUME resume;
+                                    checkpoint.store = &(handleData->checkpoint_store);
+                                    checkpoint.destinationFileName = destinationFileName;
+                                    checkpoint.correlationId = correlationId;
+                                    checkpoint.sasUri = sasUri;
+                                    resume.blocksStored = 0;
+                                    resume.bytesStored = 0;
+                                    resume.blockRetries = handleData->blob_upload_block_retries;
+                                    resume.retryDelayMs = BLOB_UPLOAD_RETRY_DELAY_MS;
+                                    resume.onBlockStored = isResumableUpload ? save_checkpoint : NULL;
+                                    resume.onBlockStoredContext = &checkpoint;
+                                    resume.isResumable = 0;
+
                                     /*do step 1*/
-                                    if (IoTHubClient_LL_UploadToBlob_step1and2(handleData, iotHubHttpApiExHandle, requestHttpHeaders, destinationFileName, correlationId, sasUri) != 0)
+                                    /*Codes_SRS_IOTHUBCLIENT_LL_99_017: [ If a checkpoint was saved for `destinationFileName`, `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall skip step 1 and resume with its correlation ID, SAS URI and stored blocks. ]*/
+                                    if ((!isResumableUpload || (load_checkpoint(&(handleData->checkpoint_store), destinationFileName, correlationId, sasUri, &resume) != 0)) &&
+                                        (IoTHubClient_LL_UploadToBlob_step1and2(handleData, iotHubHttpApiExHandle, requestHttpHeaders, destinationFileName, correlationId, sasUri) != 0))
                                     {
                                         LogError("error in IoTHubClient_LL_UploadToBlob_step1");
                                         result = IOTHUB_CLIENT_ERROR;
@@ -929,8 +1017,35 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IOTHUB_CLIE
                                         else
                                         {
                                             /*Codes_SRS_IOTHUBCLIENT_LL_02_083: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall call Blob_UploadFromSasUri and capture the HTTP return code and HTTP body. ]*/
-                                            BLOB_RESULT uploadMultipleBlocksResult = Blob_UploadMultipleBlocksFromSasUri(STRING_c_str(sasUri), getDataCallbackEx, context, &httpResponse, responseToIoTHub, handleData->certificates, &(handleData->http_proxy_options));
-                                            if (uploadMultipleBlocksResult == BLOB_ABORTED)
+                                            BLOB_RESULT uploadMultipleBlocksResult;
+                                            if (isResumableUpload || (handleData->blob_upload_block_retries > 0))
+                                            {
+                                                /*Codes_SRS_IOTHUBCLIENT_LL_99_015: [ If a checkpoint store is set or `blob_upload_block_retries` is not 0, `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall call `Blob_UploadMultipleBlocksFromSasUriResumable` instead. ]*/
+                                                uploadMultipleBlocksResult = Blob_UploadMultipleBlocksFromSasUriResumable(STRING_c_str(sasUri), getDataCallbackEx, fillSliceCallback, context, &httpResponse, responseToIoTHub, handleData->certificates, &(handleData->http_proxy_options), handleData->blob_upload_slice_size, &resume);
+                                            }
+                                            else if (handleData->blob_upload_parallelism > 1)
+                                            {
+                                                /*Codes_SRS_IOTHUBCLIENT_LL_99_012: [ If `blob_upload_parallelism` is greater than 1, `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall call `Blob_UploadMultipleBlocksFromSasUriParallel` with it instead. ]*/
+                                                uploadMultipleBlocksResult = Blob_UploadMultipleBlocksFromSasUriParallel(STRING_c_str(sasUri), getDataCallbackEx, fillSliceCallback, context, &httpResponse, responseToIoTHub, handleData->certificates, &(handleData->http_proxy_options), handleData->blob_upload_slice_size, handleData->blob_upload_parallelism, NULL);
+                                            }
+                                            else
+                                            {
+                                                uploadMultipleBlocksResult = Blob_UploadMultipleBlocksFromSasUri(STRING_c_str(sasUri), getDataCallbackEx, fillSliceCallback, context, &httpResponse, responseToIoTHub, handleData->certificates, &(handleData->http_proxy_options), handleData->blob_upload_slice_size);
+                                            }
+
+                                            if (isResumableUpload && !resume.isResumable)
+                                            {
+                                                /*Codes_SRS_IOTHUBCLIENT_LL_99_019: [ Unless the upload stopped on a transient failure, the checkpoint shall be removed. ]*/
+                                                handleData->checkpoint_store.remove(destinationFileName, handleData->checkpoint_store.context);
+                                            }
+
+                                            if (isResumableUpload && resume.isResumable)
+                                            {
+                                                /*Codes_SRS_IOTHUBCLIENT_LL_99_020: [ If the upload stopped on a transient failure and a checkpoint store is set, step 3 shall be skipped and `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall return `IOTHUB_CLIENT_ERROR`; the next upload of `destinationFileName` resumes it. ]*/
+                                                LogError("upload of %s interrupted after %u blocks, the next upload of it will resume", destinationFileName, resume.blocksStored);
+                                                result = IOTHUB_CLIENT_ERROR;
+                                            }
+                                            else if (uploadMultipleBlocksResult == BLOB_ABORTED)
                                             {
                                                 /*Codes_SRS_IOTHUBCLIENT_LL_99_008: [ If step 2 is aborted by the client, then the HTTP message body shall look like:  ]*/
                                                 LogInfo("Blob_UploadFromSasUri aborted file upload");
@@ -1027,7 +1142,14 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IOTHUB_CLIE
 
     /*Codes_SRS_IOTHUBCLIENT_LL_99_003: [ If `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` return `IOTHUB_CLIENT_OK`, it shall call `getDataCallbackEx` with `result` set to `FILE_UPLOAD_OK`, and `data` and `size` set to NULL. ]*/
     /*Codes_SRS_IOTHUBCLIENT_LL_99_004: [ If `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` does not return `IOTHUB_CLIENT_OK`, it shall call `getDataCallbackEx` with `result` set to `FILE_UPLOAD_ERROR`, and `data` and `size` set to NULL. ]*/
-    (void)getDataCallbackEx(result == IOTHUB_CLIENT_OK ? FILE_UPLOAD_OK : FILE_UPLOAD_ERROR, NULL, NULL, context);
+    if (getDataCallbackEx != NULL)
+    {
+        (void)getDataCallbackEx(result == IOTHUB_CLIENT_OK ? FILE_UPLOAD_OK : FILE_UPLOAD_ERROR, NULL, NULL, context);
+    }
+    else if (fillSliceCallback != NULL)
+    {
+        (void)fillSliceCallback(result == IOTHUB_CLIENT_OK ? FILE_UPLOAD_OK : FILE_UPLOAD_ERROR, NULL, NULL, context);
+    }
 
     return result;
 }
@@ -1051,7 +1173,7 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTO
         context.remainingSizeToUpload = size;
 
         /*Codes_SRS_IOTHUBCLIENT_LL_99_002: [ `IoTHubClient_LL_UploadToBlob` shall call `IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl` with `FileUpload_GetData_Callback` as `getDataCallbackEx` and pass the struct created at step SRS_IOTHUBCLIENT_LL_99_001 as `context` ]*/
-        result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(handle, destinationFileName, FileUpload_GetData_Callback, &context);
+        result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(handle, destinationFileName, FileUpload_GetData_Callback, NULL, &context);
     }
     return result;
 }
@@ -1284,6 +1406,60 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_SetOption(IOTHUB_CLIENT_LL_UPL
             handleData->curl_verbose = *(size_t*)value;
             result = IOTHUB_CLIENT_OK;
         }
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_010: [ OPTION_BLOB_UPLOAD_PARALLELISM - then `value` is a pointer to a `size_t` with the most blocks uploaded at once. ]*/
+        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_PARALLELISM) == 0)
+        {
+            if (*(const size_t*)value == 0)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_99_011: [ If the value is 0, `IoTHubClient_LL_UploadToBlob_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+                LogError("blob upload parallelism cannot be 0");
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                handleData->blob_upload_parallelism = *(const size_t*)value;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_042: [ OPTION_BLOB_UPLOAD_SLICE_SIZE - then `value` is a pointer to a `size_t` with the size of the slice offered to `fillSliceCallback`. ]*/
+        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_SLICE_SIZE) == 0)
+        {
+            if ((*(const size_t*)value == 0) || (*(const size_t*)value > BLOCK_SIZE))
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_99_043: [ If the value is 0 or bigger than `BLOCK_SIZE`, `IoTHubClient_LL_UploadToBlob_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+                LogError("blob upload slice size %lu is not between 1 and %d", (unsigned long)*(const size_t*)value, BLOCK_SIZE);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                handleData->blob_upload_slice_size = *(const size_t*)value;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_013: [ OPTION_BLOB_UPLOAD_BLOCK_RETRIES - then `value` is a pointer to a `size_t` with the times a block is sent again after a transient failure. ]*/
+        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_BLOCK_RETRIES) == 0)
+        {
+            handleData->blob_upload_block_retries = *(const size_t*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_99_014: [ OPTION_BLOB_UPLOAD_CHECKPOINT_STORE - then `value` is a pointer to an `IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE` that is copied; a store with all callbacks NULL turns checkpoints off. ]*/
+        else if (strcmp(optionName, OPTION_BLOB_UPLOAD_CHECKPOINT_STORE) == 0)
+        {
+            const IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE* store = (const IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE*)value;
+            if ((store == NULL) ||
+                (((store->save == NULL) || (store->load == NULL) || (store->remove == NULL)) &&
+                 ((store->save != NULL) || (store->load != NULL) || (store->remove != NULL))))
+            {
+                /*Codes_SRS_IOTHUBCLIENT_LL_99_021: [ If `value` is NULL or only some of its callbacks are NULL, `IoTHubClient_LL_UploadToBlob_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+                LogError("a checkpoint store needs all of save, load and remove");
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                handleData->checkpoint_store = *store;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
         else
         {
             /*Codes_SRS_IOTHUBCLIENT_LL_02_102: [ If an unknown option is presented then IoTHubClient_LL_UploadToBlob_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
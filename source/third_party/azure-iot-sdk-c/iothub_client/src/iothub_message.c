@@ -2,15 +2,19 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/lock.h"
 
 #include "iothub_message.h"
 
 DEFINE_ENUM_STRINGS(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_RESULT_VALUES);
 DEFINE_ENUM_STRINGS(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUES);
+DEFINE_ENUM_STRINGS(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_VALUES);
 
 #define LOG_IOTHUB_MESSAGE_ERROR() \
     LogError("(result = %s)", ENUM_TO_STRING(IOTHUB_MESSAGE_RESULT, result));
@@ -29,8 +33,35 @@ typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG
     char* userDefinedContentType;
     char* contentEncoding;
     IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE diagnosticData;
+    IOTHUB_MESSAGE_PRIORITY priority;
+    /*packed messages only: the content and the system properties share the block of the handle*/
+    unsigned char* content;
+    size_t contentSize;
+    unsigned char* inlineStorage;
+    size_t inlineSize;
+    size_t inlineUsed;
+    struct IOTHUB_MESSAGE_POOL_TAG* pool; /*the pool the block is a slot of, NULL when it came from the heap*/
 }IOTHUB_MESSAGE_HANDLE_DATA;
 
+typedef struct IOTHUB_MESSAGE_POOL_TAG
+{
+    LOCK_HANDLE lock;
+    unsigned char* freeSlots; /*each free slot starts with a pointer to the next one*/
+    size_t slotContentSize;
+    size_t inlineSize;
+    size_t propertyCount;
+    size_t propertyStorageSize; /*bytes of every block given to Map_CreateInPlace, 0 when the properties have a MAP of their own*/
+    bool closing;
+    IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+}IOTHUB_MESSAGE_POOL;
+
+#define ALIGN_TO_POINTER(size) (((size) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+#define PACKED_HEADER_SIZE ALIGN_TO_POINTER(sizeof(IOTHUB_MESSAGE_HANDLE_DATA))
+#define POOL_HEADER_SIZE ALIGN_TO_POINTER(sizeof(IOTHUB_MESSAGE_POOL))
+
+/*NULL unless IoTHubMessage_InitPool was called, messages are then built from separate allocations*/
+static IOTHUB_MESSAGE_POOL* g_messagePool = NULL;
+
 static bool ContainsOnlyUsAscii(const char* asciiValue)
 {
     bool result = true;
@@ -73,9 +104,125 @@ static void DestroyDiagnosticPropertyData(IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DAT
     free(diagnosticHandle);
 }
 
+static bool IsInline(const IOTHUB_MESSAGE_HANDLE_DATA* handleData, const void* value)
+{
+    const unsigned char* bytes = (const unsigned char*)value;
+    return (handleData->inlineStorage != NULL) &&
+        (bytes >= handleData->inlineStorage) &&
+        (bytes < handleData->inlineStorage + handleData->inlineSize);
+}
+
+static void* PlaceInline(IOTHUB_MESSAGE_HANDLE_DATA* handleData, size_t size, bool aligned)
+{
+    void* result;
+    size_t offset = aligned ? ALIGN_TO_POINTER(handleData->inlineUsed) : handleData->inlineUsed;
+    if ((handleData->inlineStorage == NULL) || (offset > handleData->inlineSize) || (size > handleData->inlineSize - offset))
+    {
+        result = NULL;
+    }
+    else
+    {
+        result = handleData->inlineStorage + offset;
+        handleData->inlineUsed = offset + size;
+    }
+    return result;
+}
+
+/*the room is only given back when the value is the last one placed, which is what repeated Set calls do*/
+static void ReleaseInline(IOTHUB_MESSAGE_HANDLE_DATA* handleData, const void* value, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)value;
+    if (bytes + size == handleData->inlineStorage + handleData->inlineUsed)
+    {
+        handleData->inlineUsed = (size_t)(bytes - handleData->inlineStorage);
+    }
+}
+
+/*Codes_SRS_IOTHUBMESSAGE_99_012: [ The system properties of a packed message shall be copied in its inline storage while it has room, and with mallocAndStrcpy_s otherwise. ]*/
+static int CopySystemProperty(IOTHUB_MESSAGE_HANDLE_DATA* handleData, char** destination, const char* value)
+{
+    int result;
+    size_t size = strlen(value) + 1;
+    char* inlineCopy = (char*)PlaceInline(handleData, size, false);
+    if (inlineCopy != NULL)
+    {
+        (void)memcpy(inlineCopy, value, size);
+        *destination = inlineCopy;
+        result = 0;
+    }
+    else
+    {
+        result = mallocAndStrcpy_s(destination, value);
+    }
+    return result;
+}
+
+static void FreeSystemProperty(IOTHUB_MESSAGE_HANDLE_DATA* handleData, char* value)
+{
+    if (IsInline(handleData, value))
+    {
+        ReleaseInline(handleData, value, strlen(value) + 1);
+    }
+    else
+    {
+        free(value);
+    }
+}
+
+static void FreeDiagnosticPropertyData(IOTHUB_MESSAGE_HANDLE_DATA* handleData, IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE diagnosticHandle)
+{
+    if (IsInline(handleData, diagnosticHandle))
+    {
+        ReleaseInline(handleData, diagnosticHandle, sizeof(IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA) +
+            ((diagnosticHandle->diagnosticId == NULL) ? 0 : strlen(diagnosticHandle->diagnosticId) + 1) +
+            ((diagnosticHandle->diagnosticCreationTimeUtc == NULL) ? 0 : strlen(diagnosticHandle->diagnosticCreationTimeUtc) + 1));
+    }
+    else
+    {
+        DestroyDiagnosticPropertyData(diagnosticHandle);
+    }
+}
+
+static void DestroyPool(IOTHUB_MESSAGE_POOL* pool)
+{
+    (void)Lock_Deinit(pool->lock);
+    free(pool);
+}
+
+static void ReleasePackedMessage(IOTHUB_MESSAGE_HANDLE_DATA* handleData)
+{
+    IOTHUB_MESSAGE_POOL* pool = handleData->pool;
+    if (pool == NULL)
+    {
+        free(handleData);
+    }
+    else if (Lock(pool->lock) != LOCK_OK)
+    {
+        LogError("unable to lock the message pool, the slot is lost");
+    }
+    else
+    {
+        bool destroyPool;
+        *(unsigned char**)handleData = pool->freeSlots;
+        pool->freeSlots = (unsigned char*)handleData;
+        pool->statistics.slots_in_use--;
+        destroyPool = pool->closing && (pool->statistics.slots_in_use == 0);
+        (void)Unlock(pool->lock);
+
+        if (destroyPool)
+        {
+            DestroyPool(pool);
+        }
+    }
+}
+
 static void DestroyMessageData(IOTHUB_MESSAGE_HANDLE_DATA* handleData)
 {
-    if (handleData->contentType == IOTHUBMESSAGE_BYTEARRAY)
+    if (handleData->inlineStorage != NULL)
+    {
+        /*the content is part of the block*/
+    }
+    else if (handleData->contentType == IOTHUBMESSAGE_BYTEARRAY)
     {
         BUFFER_delete(handleData->value.byteArray);
     }
@@ -85,14 +232,22 @@ static void DestroyMessageData(IOTHUB_MESSAGE_HANDLE_DATA* handleData)
     }
 
     Map_Destroy(handleData->properties);
-    free(handleData->messageId);
+    FreeSystemProperty(handleData, handleData->messageId);
     handleData->messageId = NULL;
-    free(handleData->correlationId);
+    FreeSystemProperty(handleData, handleData->correlationId);
     handleData->correlationId = NULL;
-    free(handleData->userDefinedContentType);
-    free(handleData->contentEncoding);
-    DestroyDiagnosticPropertyData(handleData->diagnosticData);
-    free(handleData);
+    FreeSystemProperty(handleData, handleData->userDefinedContentType);
+    FreeSystemProperty(handleData, handleData->contentEncoding);
+    FreeDiagnosticPropertyData(handleData, handleData->diagnosticData);
+    if (handleData->inlineStorage != NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_99_013: [ IoTHubMessage_Destroy shall give the slot of a packed message back to the pool, or free its block when it came from the heap. ]*/
+        ReleasePackedMessage(handleData);
+    }
+    else
+    {
+        free(handleData);
+    }
 }
 
 static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE CloneDiagnosticPropertyData(const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA* source)
@@ -131,14 +286,265 @@ static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE CloneDiagnosticPropertyDat
     return result;
 }
 
+static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE CopyDiagnosticPropertyData(IOTHUB_MESSAGE_HANDLE_DATA* handleData, const IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA* source)
+{
+    IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE result = NULL;
+    if ((handleData->inlineStorage != NULL) && (source != NULL))
+    {
+        size_t idSize = (source->diagnosticId == NULL) ? 0 : strlen(source->diagnosticId) + 1;
+        size_t timeSize = (source->diagnosticCreationTimeUtc == NULL) ? 0 : strlen(source->diagnosticCreationTimeUtc) + 1;
+        if ((result = (IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA_HANDLE)PlaceInline(handleData, sizeof(IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA) + idSize + timeSize, true)) != NULL)
+        {
+            char* strings = (char*)(result + 1);
+            result->diagnosticId = (idSize == 0) ? NULL : (char*)memcpy(strings, source->diagnosticId, idSize);
+            result->diagnosticCreationTimeUtc = (timeSize == 0) ? NULL : (char*)memcpy(strings + idSize, source->diagnosticCreationTimeUtc, timeSize);
+        }
+    }
+
+    if (result == NULL)
+    {
+        result = CloneDiagnosticPropertyData(source);
+    }
+    return result;
+}
+
+/*Codes_SRS_IOTHUBMESSAGE_99_010: [ Once the pool is set up, IoTHubMessage_CreateFromByteArray, IoTHubMessage_CreateFromString and IoTHubMessage_Clone shall place the handle, the content and inline_size bytes for the system properties in a single block. ]*/
+static IOTHUB_MESSAGE_HANDLE_DATA* AllocatePackedMessage(IOTHUB_MESSAGE_POOL* pool, IOTHUBMESSAGE_CONTENT_TYPE contentType, const unsigned char* content, size_t contentSize)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result = NULL;
+
+    if (contentSize > SIZE_MAX - PACKED_HEADER_SIZE - pool->propertyStorageSize - pool->inlineSize - 2 * sizeof(void*))
+    {
+        LogError("content of %lu bytes is too big", (unsigned long)contentSize);
+    }
+    else
+    {
+        /*strings keep their terminating '\0' in the block*/
+        size_t contentRoom = ALIGN_TO_POINTER((contentType == IOTHUBMESSAGE_STRING) ? contentSize + 1 : contentSize);
+        size_t blockSize = 0;
+        unsigned char* block = NULL;
+
+        if (Lock(pool->lock) != LOCK_OK)
+        {
+            LogError("unable to lock the message pool");
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBMESSAGE_99_011: [ The block shall be a free slot of the pool when the content and the inline storage fit in slot_size, otherwise it shall be allocated from the heap. ]*/
+            if ((pool->freeSlots != NULL) &&
+                (pool->slotContentSize >= pool->inlineSize) &&
+                (contentRoom <= pool->slotContentSize - pool->inlineSize))
+            {
+                block = pool->freeSlots;
+                pool->freeSlots = *(unsigned char**)block;
+                blockSize = PACKED_HEADER_SIZE + pool->slotContentSize + pool->propertyStorageSize;
+                pool->statistics.pool_allocations++;
+                pool->statistics.slots_in_use++;
+                if (pool->statistics.slots_in_use > pool->statistics.max_slots_in_use)
+                {
+                    pool->statistics.max_slots_in_use = pool->statistics.slots_in_use;
+                }
+            }
+            (void)Unlock(pool->lock);
+        }
+
+        if (block != NULL)
+        {
+            result = (IOTHUB_MESSAGE_HANDLE_DATA*)block;
+            memset(result, 0, sizeof(*result));
+            result->pool = pool;
+        }
+        else
+        {
+            blockSize = PACKED_HEADER_SIZE + contentRoom + pool->propertyStorageSize + pool->inlineSize;
+            if ((block = (unsigned char*)malloc(blockSize)) == NULL)
+            {
+                LogError("unable to malloc");
+            }
+            else
+            {
+                result = (IOTHUB_MESSAGE_HANDLE_DATA*)block;
+                memset(result, 0, sizeof(*result));
+                if (Lock(pool->lock) == LOCK_OK)
+                {
+                    pool->statistics.heap_allocations++;
+                    (void)Unlock(pool->lock);
+                }
+            }
+        }
+
+        if (result != NULL)
+        {
+            result->contentType = contentType;
+            /*Codes_SRS_IOTHUBMESSAGE_99_001: [ A new message shall have the priority IOTHUB_MESSAGE_PRIORITY_NORMAL. ]*/
+            result->priority = IOTHUB_MESSAGE_PRIORITY_NORMAL;
+            result->content = block + PACKED_HEADER_SIZE;
+            result->contentSize = contentSize;
+            if (contentSize != 0)
+            {
+                (void)memcpy(result->content, content, contentSize);
+            }
+            if (contentType == IOTHUBMESSAGE_STRING)
+            {
+                result->content[contentSize] = '\0';
+            }
+            /*the property table sits between the content and the inline storage so that it stays aligned*/
+            result->inlineStorage = result->content + contentRoom + pool->propertyStorageSize;
+            result->inlineSize = blockSize - PACKED_HEADER_SIZE - contentRoom - pool->propertyStorageSize;
+
+            /*Codes_SRS_IOTHUBMESSAGE_99_018: [ When property_count is not 0, the properties of a packed message shall be created with Map_CreateInPlace in its block, and IoTHubMessage_Clone shall copy the properties of the source into them with Map_GetInternals and Map_Add. ]*/
+            if ((pool->propertyCount != 0) &&
+                ((result->properties = Map_CreateInPlace(ValidateAsciiCharactersFilter, result->content + contentRoom, pool->propertyStorageSize, pool->propertyCount)) == NULL))
+            {
+                LogError("Map_CreateInPlace for properties failed");
+                DestroyMessageData(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+static IOTHUB_MESSAGE_HANDLE_DATA* CreatePackedMessage(IOTHUB_MESSAGE_POOL* pool, IOTHUBMESSAGE_CONTENT_TYPE contentType, const unsigned char* content, size_t contentSize)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result = AllocatePackedMessage(pool, contentType, content, contentSize);
+    if (result == NULL)
+    {
+        LogError("unable to allocate a packed message");
+    }
+    else if ((result->properties == NULL) && ((result->properties = Map_Create(ValidateAsciiCharactersFilter)) == NULL))
+    {
+        LogError("Map_Create for properties failed");
+        DestroyMessageData(result);
+        result = NULL;
+    }
+    return result;
+}
+
+static int CopyProperties(MAP_HANDLE destination, MAP_HANDLE source)
+{
+    int result;
+    const char*const* keys;
+    const char*const* values;
+    size_t count;
+    if (Map_GetInternals(source, &keys, &values, &count) != MAP_OK)
+    {
+        LogError("unable to Map_GetInternals");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t i;
+        result = 0;
+        for (i = 0; i < count; i++)
+        {
+            if (Map_Add(destination, keys[i], values[i]) != MAP_OK)
+            {
+                LogError("unable to Map_Add");
+                result = __FAILURE__;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
+static IOTHUB_MESSAGE_HANDLE_DATA* ClonePackedMessage(IOTHUB_MESSAGE_POOL* pool, const IOTHUB_MESSAGE_HANDLE_DATA* source)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result;
+    const unsigned char* content;
+    size_t contentSize;
+
+    if (source->inlineStorage != NULL)
+    {
+        content = source->content;
+        contentSize = source->contentSize;
+    }
+    else if (source->contentType == IOTHUBMESSAGE_BYTEARRAY)
+    {
+        content = BUFFER_u_char(source->value.byteArray);
+        contentSize = BUFFER_length(source->value.byteArray);
+    }
+    else
+    {
+        content = (const unsigned char*)STRING_c_str(source->value.string);
+        contentSize = STRING_length(source->value.string);
+    }
+
+    if ((result = AllocatePackedMessage(pool, source->contentType, content, contentSize)) == NULL)
+    {
+        LogError("unable to allocate a packed message");
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_99_002: [ IoTHubMessage_Clone shall copy the priority of the source message. ]*/
+        result->priority = source->priority;
+
+        /*Codes_SRS_IOTHUBMESSAGE_99_012: [ The system properties of a packed message shall be copied in its inline storage while it has room, and with mallocAndStrcpy_s otherwise. ]*/
+        if (source->messageId != NULL && CopySystemProperty(result, &result->messageId, source->messageId) != 0)
+        {
+            LogError("unable to Copy messageId");
+            DestroyMessageData(result);
+            result = NULL;
+        }
+        else if (source->correlationId != NULL && CopySystemProperty(result, &result->correlationId, source->correlationId) != 0)
+        {
+            LogError("unable to Copy correlationId");
+            DestroyMessageData(result);
+            result = NULL;
+        }
+        else if (source->userDefinedContentType != NULL && CopySystemProperty(result, &result->userDefinedContentType, source->userDefinedContentType) != 0)
+        {
+            LogError("unable to copy contentType");
+            DestroyMessageData(result);
+            result = NULL;
+        }
+        else if (source->contentEncoding != NULL && CopySystemProperty(result, &result->contentEncoding, source->contentEncoding) != 0)
+        {
+            LogError("unable to copy contentEncoding");
+            DestroyMessageData(result);
+            result = NULL;
+        }
+        else if (source->diagnosticData != NULL && (result->diagnosticData = CopyDiagnosticPropertyData(result, source->diagnosticData)) == NULL)
+        {
+            LogError("unable to CopyDiagnosticPropertyData");
+            DestroyMessageData(result);
+            result = NULL;
+        }
+        else if (result->properties == NULL)
+        {
+            if ((result->properties = Map_Clone(source->properties)) == NULL)
+            {
+                LogError("unable to Map_Clone");
+                DestroyMessageData(result);
+                result = NULL;
+            }
+        }
+        else if (CopyProperties(result->properties, source->properties) != 0)
+        {
+            LogError("unable to copy the properties");
+            DestroyMessageData(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
 IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArray(const unsigned char* byteArray, size_t size)
 {
     IOTHUB_MESSAGE_HANDLE_DATA* result;
+    IOTHUB_MESSAGE_POOL* pool = g_messagePool;
     if ((byteArray == NULL) && (size != 0))
     {
         LogError("Invalid argument - byteArray is NULL");
         result = NULL;
     }
+    else if (pool != NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_99_010: [ Once the pool is set up, IoTHubMessage_CreateFromByteArray, IoTHubMessage_CreateFromString and IoTHubMessage_Clone shall place the handle, the content and inline_size bytes for the system properties in a single block. ]*/
+        result = CreatePackedMessage(pool, IOTHUBMESSAGE_BYTEARRAY, byteArray, size);
+    }
     else
     {
         result = (IOTHUB_MESSAGE_HANDLE_DATA*)malloc(sizeof(IOTHUB_MESSAGE_HANDLE_DATA));
@@ -156,6 +562,8 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArray(const unsigned char* byt
             memset(result, 0, sizeof(*result));
             /*Codes_SRS_IOTHUBMESSAGE_02_026: [The type of the new message shall be IOTHUBMESSAGE_BYTEARRAY.] */
             result->contentType = IOTHUBMESSAGE_BYTEARRAY;
+            /*Codes_SRS_IOTHUBMESSAGE_99_001: [ A new message shall have the priority IOTHUB_MESSAGE_PRIORITY_NORMAL. ]*/
+            result->priority = IOTHUB_MESSAGE_PRIORITY_NORMAL;
 
             if (size != 0)
             {
@@ -205,11 +613,17 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArray(const unsigned char* byt
 IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromString(const char* source)
 {
     IOTHUB_MESSAGE_HANDLE_DATA* result;
+    IOTHUB_MESSAGE_POOL* pool = g_messagePool;
     if (source == NULL)
     {
         LogError("Invalid argument - source is NULL");
         result = NULL;
     }
+    else if (pool != NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_99_010: [ Once the pool is set up, IoTHubMessage_CreateFromByteArray, IoTHubMessage_CreateFromString and IoTHubMessage_Clone shall place the handle, the content and inline_size bytes for the system properties in a single block. ]*/
+        result = CreatePackedMessage(pool, IOTHUBMESSAGE_STRING, (const unsigned char*)source, strlen(source));
+    }
     else
     {
         result = (IOTHUB_MESSAGE_HANDLE_DATA*)malloc(sizeof(IOTHUB_MESSAGE_HANDLE_DATA));
@@ -224,6 +638,8 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromString(const char* source)
             memset(result, 0, sizeof(*result));
             /*Codes_SRS_IOTHUBMESSAGE_02_032: [The type of the new message shall be IOTHUBMESSAGE_STRING.] */
             result->contentType = IOTHUBMESSAGE_STRING;
+            /*Codes_SRS_IOTHUBMESSAGE_99_001: [ A new message shall have the priority IOTHUB_MESSAGE_PRIORITY_NORMAL. ]*/
+            result->priority = IOTHUB_MESSAGE_PRIORITY_NORMAL;
             
             /*Codes_SRS_IOTHUBMESSAGE_02_027: [IoTHubMessage_CreateFromString shall call STRING_construct passing source as parameter.] */
             if ((result->value.string = STRING_construct(source)) == NULL)
@@ -252,12 +668,18 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_Clone(IOTHUB_MESSAGE_HANDLE iotHubMessageHan
 {
     IOTHUB_MESSAGE_HANDLE_DATA* result;
     const IOTHUB_MESSAGE_HANDLE_DATA* source = (const IOTHUB_MESSAGE_HANDLE_DATA*)iotHubMessageHandle;
+    IOTHUB_MESSAGE_POOL* pool = g_messagePool;
     /* Codes_SRS_IOTHUBMESSAGE_03_005: [IoTHubMessage_Clone shall return NULL if iotHubMessageHandle is NULL.] */
     if (source == NULL)
     {
         result = NULL;
         LogError("iotHubMessageHandle parameter cannot be NULL for IoTHubMessage_Clone");
     }
+    else if (pool != NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_99_010: [ Once the pool is set up, IoTHubMessage_CreateFromByteArray, IoTHubMessage_CreateFromString and IoTHubMessage_Clone shall place the handle, the content and inline_size bytes for the system properties in a single block. ]*/
+        result = ClonePackedMessage(pool, source);
+    }
     else
     {
         result = (IOTHUB_MESSAGE_HANDLE_DATA*)malloc(sizeof(IOTHUB_MESSAGE_HANDLE_DATA));
@@ -272,6 +694,8 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_Clone(IOTHUB_MESSAGE_HANDLE iotHubMessageHan
         {
             memset(result, 0, sizeof(*result));
             result->contentType = source->contentType;
+            /*Codes_SRS_IOTHUBMESSAGE_99_002: [ IoTHubMessage_Clone shall copy the priority of the source message. ]*/
+            result->priority = source->priority;
 
             if (source->messageId != NULL && mallocAndStrcpy_s(&result->messageId, source->messageId) != 0)
             {
@@ -306,7 +730,10 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_Clone(IOTHUB_MESSAGE_HANDLE iotHubMessageHan
             else if (source->contentType == IOTHUBMESSAGE_BYTEARRAY)
             {
                 /*Codes_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall clone to content by a call to BUFFER_clone] */
-                if ((result->value.byteArray = BUFFER_clone(source->value.byteArray)) == NULL)
+                /*Codes_SRS_IOTHUBMESSAGE_99_017: [ When there is no pool, IoTHubMessage_Clone shall copy the content of a packed message with BUFFER_create or STRING_construct. ]*/
+                if ((result->value.byteArray = (source->inlineStorage != NULL) ?
+                    BUFFER_create(source->content, source->contentSize) :
+                    BUFFER_clone(source->value.byteArray)) == NULL)
                 {
                     /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
                     LogError("unable to BUFFER_clone");
@@ -326,7 +753,10 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_Clone(IOTHUB_MESSAGE_HANDLE iotHubMessageHan
             else /*can only be STRING*/
             {
                 /*Codes_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall clone the content by a call to BUFFER_clone or STRING_clone] */
-                if ((result->value.string = STRING_clone(source->value.string)) == NULL)
+                /*Codes_SRS_IOTHUBMESSAGE_99_017: [ When there is no pool, IoTHubMessage_Clone shall copy the content of a packed message with BUFFER_create or STRING_construct. ]*/
+                if ((result->value.string = (source->inlineStorage != NULL) ?
+                    STRING_construct((const char*)source->content) :
+                    STRING_clone(source->value.string)) == NULL)
                 {
                     /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
                     LogError("failed to STRING_clone");
@@ -369,6 +799,12 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_GetByteArray(IOTHUB_MESSAGE_HANDLE iotHubMes
             result = IOTHUB_MESSAGE_INVALID_ARG;
             LogError("invalid type of message %s", ENUM_TO_STRING(IOTHUBMESSAGE_CONTENT_TYPE, handleData->contentType));
         }
+        else if (handleData->inlineStorage != NULL)
+        {
+            *buffer = handleData->content;
+            *size = handleData->contentSize;
+            result = IOTHUB_MESSAGE_OK;
+        }
         else
         {
             /*Codes_SRS_IOTHUBMESSAGE_01_011: [The pointer shall be obtained by using BUFFER_u_char and it shall be copied in the buffer argument.]*/
@@ -397,6 +833,10 @@ const char* IoTHubMessage_GetString(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
             /*Codes_SRS_IOTHUBMESSAGE_02_017: [IoTHubMessage_GetString shall return NULL if the iotHubMessageHandle does not refer to a IOTHUBMESSAGE of type STRING.] */
             result = NULL;
         }
+        else if (handleData->inlineStorage != NULL)
+        {
+            result = (const char*)handleData->content;
+        }
         else
         {
             /*Codes_SRS_IOTHUBMESSAGE_02_018: [IoTHubMessage_GetStringData shall return the currently stored null terminated string.] */
@@ -474,11 +914,11 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetCorrelationId(IOTHUB_MESSAGE_HANDLE iotHu
         /* Codes_SRS_IOTHUBMESSAGE_07_019: [If the IOTHUB_MESSAGE_HANDLE correlationId is not NULL, then the IOTHUB_MESSAGE_HANDLE correlationId will be deallocated.] */
         if (handleData->correlationId != NULL)
         {
-            free(handleData->correlationId);
+            FreeSystemProperty(handleData, handleData->correlationId);
             handleData->correlationId = NULL;
         }
 
-        if (mallocAndStrcpy_s(&handleData->correlationId, correlationId) != 0)
+        if (CopySystemProperty(handleData, &handleData->correlationId, correlationId) != 0)
         {
             /* Codes_SRS_IOTHUBMESSAGE_07_020: [If the allocation or the copying of the correlationId fails, then IoTHubMessage_SetCorrelationId shall return IOTHUB_MESSAGE_ERROR.] */
             result = IOTHUB_MESSAGE_ERROR;
@@ -507,12 +947,12 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetMessageId(IOTHUB_MESSAGE_HANDLE iotHubMes
         /* Codes_SRS_IOTHUBMESSAGE_07_013: [If the IOTHUB_MESSAGE_HANDLE messageId is not NULL, then the IOTHUB_MESSAGE_HANDLE messageId will be freed] */
         if (handleData->messageId != NULL)
         {
-            free(handleData->messageId);
+            FreeSystemProperty(handleData, handleData->messageId);
             handleData->messageId = NULL;
         }
 
         /* Codes_SRS_IOTHUBMESSAGE_07_014: [If the allocation or the copying of the messageId fails, then IoTHubMessage_SetMessageId shall return IOTHUB_MESSAGE_ERROR.] */
-        if (mallocAndStrcpy_s(&handleData->messageId, messageId) != 0)
+        if (CopySystemProperty(handleData, &handleData->messageId, messageId) != 0)
         {
             result = IOTHUB_MESSAGE_ERROR;
         }
@@ -559,11 +999,11 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetContentTypeSystemProperty(IOTHUB_MESSAGE_
         // Codes_SRS_IOTHUBMESSAGE_09_002: [If the IOTHUB_MESSAGE_HANDLE `contentType` is not NULL it shall be deallocated.] 
         if (handleData->userDefinedContentType != NULL)
         {
-            free(handleData->userDefinedContentType);
+            FreeSystemProperty(handleData, handleData->userDefinedContentType);
             handleData->userDefinedContentType = NULL;
         }
 
-        if (mallocAndStrcpy_s(&handleData->userDefinedContentType, contentType) != 0)
+        if (CopySystemProperty(handleData, &handleData->userDefinedContentType, contentType) != 0)
         {
             LogError("Failed saving a copy of contentType");
             // Codes_SRS_IOTHUBMESSAGE_09_003: [If the allocation or the copying of `contentType` fails, then IoTHubMessage_SetContentTypeSystemProperty shall return IOTHUB_MESSAGE_ERROR.] 
@@ -617,11 +1057,11 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetContentEncodingSystemProperty(IOTHUB_MESS
         // Codes_SRS_IOTHUBMESSAGE_09_007: [If the IOTHUB_MESSAGE_HANDLE `contentEncoding` is not NULL it shall be deallocated.] 
         if (handleData->contentEncoding != NULL)
         {
-            free(handleData->contentEncoding);
+            FreeSystemProperty(handleData, handleData->contentEncoding);
             handleData->contentEncoding = NULL;
         }
 
-        if (mallocAndStrcpy_s(&handleData->contentEncoding, contentEncoding) != 0)
+        if (CopySystemProperty(handleData, &handleData->contentEncoding, contentEncoding) != 0)
         {
             LogError("Failed saving a copy of contentEncoding");
             // Codes_SRS_IOTHUBMESSAGE_09_008: [If the allocation or the copying of `contentEncoding` fails, then IoTHubMessage_SetContentEncodingSystemProperty shall return IOTHUB_MESSAGE_ERROR.]
@@ -695,12 +1135,12 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetDiagnosticPropertyData(IOTHUB_MESSAGE_HAN
         // Codes_SRS_IOTHUBMESSAGE_10_004: [If the IOTHUB_MESSAGE_HANDLE `diagnosticData` is not NULL it shall be deallocated.] 
         if (iotHubMessageHandle->diagnosticData != NULL)
         {
-            DestroyDiagnosticPropertyData(iotHubMessageHandle->diagnosticData);
+            FreeDiagnosticPropertyData(iotHubMessageHandle, iotHubMessageHandle->diagnosticData);
             iotHubMessageHandle->diagnosticData = NULL;
         }
 
         // Codes_SRS_IOTHUBMESSAGE_10_005: [If the allocation or the copying of `diagnosticData` fails, then IoTHubMessage_SetDiagnosticPropertyData shall return IOTHUB_MESSAGE_ERROR.]
-        if ((iotHubMessageHandle->diagnosticData = CloneDiagnosticPropertyData(diagnosticData)) == NULL)
+        if ((iotHubMessageHandle->diagnosticData = CopyDiagnosticPropertyData(iotHubMessageHandle, diagnosticData)) == NULL)
         {
             LogError("Failed saving a copy of diagnosticData");
             result = IOTHUB_MESSAGE_ERROR;
@@ -714,6 +1154,162 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_SetDiagnosticPropertyData(IOTHUB_MESSAGE_HAN
     return result;
 }
 
+IOTHUB_MESSAGE_RESULT IoTHubMessage_SetPriority(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, IOTHUB_MESSAGE_PRIORITY priority)
+{
+    IOTHUB_MESSAGE_RESULT result;
+    /*Codes_SRS_IOTHUBMESSAGE_99_003: [ If iotHubMessageHandle is NULL or priority is not one of the IOTHUB_MESSAGE_PRIORITY values, IoTHubMessage_SetPriority shall return IOTHUB_MESSAGE_INVALID_ARG. ]*/
+    if (iotHubMessageHandle == NULL ||
+        (priority != IOTHUB_MESSAGE_PRIORITY_LOW && priority != IOTHUB_MESSAGE_PRIORITY_NORMAL && priority != IOTHUB_MESSAGE_PRIORITY_HIGH))
+    {
+        LogError("Invalid argument (iotHubMessageHandle=%p, priority=%d)", iotHubMessageHandle, (int)priority);
+        result = IOTHUB_MESSAGE_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_99_004: [ Otherwise IoTHubMessage_SetPriority shall store priority in the message and return IOTHUB_MESSAGE_OK. ]*/
+        iotHubMessageHandle->priority = priority;
+        result = IOTHUB_MESSAGE_OK;
+    }
+    return result;
+}
+
+IOTHUB_MESSAGE_PRIORITY IoTHubMessage_GetPriority(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    IOTHUB_MESSAGE_PRIORITY result;
+    /*Codes_SRS_IOTHUBMESSAGE_99_005: [ If iotHubMessageHandle is NULL, IoTHubMessage_GetPriority shall return IOTHUB_MESSAGE_PRIORITY_NORMAL. ]*/
+    if (iotHubMessageHandle == NULL)
+    {
+        LogError("Invalid argument (iotHubMessageHandle is NULL)");
+        result = IOTHUB_MESSAGE_PRIORITY_NORMAL;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_99_006: [ Otherwise IoTHubMessage_GetPriority shall return the priority of the message. ]*/
+        result = iotHubMessageHandle->priority;
+    }
+    return result;
+}
+
+int IoTHubMessage_InitPool(const IOTHUB_MESSAGE_POOL_CONFIG* config)
+{
+    int result;
+    /*Codes_SRS_IOTHUBMESSAGE_99_007: [ If config is NULL, or slot_count is not 0 and slot_size is 0 or smaller than inline_size, IoTHubMessage_InitPool shall fail and return a non-zero value. ]*/
+    if ((config == NULL) ||
+        ((config->slot_count != 0) && ((config->slot_size == 0) || (config->slot_size < config->inline_size))) ||
+        (config->slot_size > SIZE_MAX / 8) ||
+        (config->inline_size > SIZE_MAX / 8) ||
+        (config->property_count > SIZE_MAX / (32 * sizeof(void*))) ||
+        (config->property_size > SIZE_MAX / 8))
+    {
+        LogError("Invalid argument (config=%p)", config);
+        result = __FAILURE__;
+    }
+    /*Codes_SRS_IOTHUBMESSAGE_99_008: [ If the pool is already set up, IoTHubMessage_InitPool shall fail and return a non-zero value. ]*/
+    else if (g_messagePool != NULL)
+    {
+        LogError("the message pool is already set up");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t propertyStorageSize = (config->property_count == 0) ? 0 : Map_GetInPlaceSize(config->property_count) + ALIGN_TO_POINTER(config->property_size);
+        size_t slotSize = PACKED_HEADER_SIZE + ALIGN_TO_POINTER(config->slot_size) + propertyStorageSize;
+        IOTHUB_MESSAGE_POOL* pool;
+
+        if (config->slot_count > (SIZE_MAX - POOL_HEADER_SIZE) / slotSize)
+        {
+            LogError("a pool of %lu slots of %lu bytes is too big", (unsigned long)config->slot_count, (unsigned long)config->slot_size);
+            result = __FAILURE__;
+        }
+        /*Codes_SRS_IOTHUBMESSAGE_99_009: [ IoTHubMessage_InitPool shall allocate the pool and all its slots in a single block and create a lock for it; if either fails it shall return a non-zero value. ]*/
+        else if ((pool = (IOTHUB_MESSAGE_POOL*)malloc(POOL_HEADER_SIZE + config->slot_count * slotSize)) == NULL)
+        {
+            LogError("unable to malloc the message pool");
+            result = __FAILURE__;
+        }
+        else if ((pool->lock = Lock_Init()) == NULL)
+        {
+            LogError("unable to create the message pool lock");
+            free(pool);
+            result = __FAILURE__;
+        }
+        else
+        {
+            unsigned char* slots = (unsigned char*)pool + POOL_HEADER_SIZE;
+            size_t i;
+
+            pool->freeSlots = NULL;
+            for (i = config->slot_count; i > 0; i--)
+            {
+                unsigned char* slot = slots + (i - 1) * slotSize;
+                *(unsigned char**)slot = pool->freeSlots;
+                pool->freeSlots = slot;
+            }
+            pool->slotContentSize = ALIGN_TO_POINTER(config->slot_size);
+            pool->inlineSize = config->inline_size;
+            pool->propertyCount = config->property_count;
+            pool->propertyStorageSize = propertyStorageSize;
+            pool->closing = false;
+            memset(&pool->statistics, 0, sizeof(pool->statistics));
+
+            g_messagePool = pool;
+            result = 0;
+        }
+    }
+    return result;
+}
+
+void IoTHubMessage_DeinitPool(void)
+{
+    IOTHUB_MESSAGE_POOL* pool = g_messagePool;
+    if (pool != NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_99_014: [ IoTHubMessage_DeinitPool shall make new messages use separate allocations again and free the pool once no message is left in its slots. ]*/
+        g_messagePool = NULL;
+        if (Lock(pool->lock) != LOCK_OK)
+        {
+            LogError("unable to lock the message pool, it is not freed");
+        }
+        else
+        {
+            bool destroyPool;
+            pool->closing = true;
+            destroyPool = (pool->statistics.slots_in_use == 0);
+            (void)Unlock(pool->lock);
+
+            if (destroyPool)
+            {
+                DestroyPool(pool);
+            }
+        }
+    }
+}
+
+int IoTHubMessage_GetPoolStatistics(IOTHUB_MESSAGE_POOL_STATISTICS* statistics)
+{
+    int result;
+    IOTHUB_MESSAGE_POOL* pool = g_messagePool;
+    /*Codes_SRS_IOTHUBMESSAGE_99_015: [ If statistics is NULL or the pool is not set up, IoTHubMessage_GetPoolStatistics shall return a non-zero value. ]*/
+    if ((statistics == NULL) || (pool == NULL))
+    {
+        LogError("Invalid argument (statistics=%p) or no message pool", statistics);
+        result = __FAILURE__;
+    }
+    else if (Lock(pool->lock) != LOCK_OK)
+    {
+        LogError("unable to lock the message pool");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_99_016: [ Otherwise IoTHubMessage_GetPoolStatistics shall copy the counters of the pool in statistics and return 0. ]*/
+        *statistics = pool->statistics;
+        (void)Unlock(pool->lock);
+        result = 0;
+    }
+    return result;
+}
+
 void IoTHubMessage_Destroy(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
 {
     /*Codes_SRS_IOTHUBMESSAGE_01_004: [If iotHubMessageHandle is NULL, IoTHubMessage_Destroy shall do nothing.] */
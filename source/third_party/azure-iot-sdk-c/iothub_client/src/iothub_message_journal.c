@@ -0,0 +1,1020 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/map.h"
+
+#include "iothub_message_journal.h"
+
+/* A segment is a header followed by records, each a header and a payload:
+     segment header: magic(4) segment_sequence(4) crc32(4)
+     record header:  type(1) marker(1) reserved(2) sequence(4) payload_length(4) crc32(4)
+   All integers are little endian; a record's crc covers the first 12 bytes of its header and its payload.
+   MESSAGE records carry a serialized message, ACK records carry in sequence the highest message delivered
+   so far. Every segment starts with an ACK record so that dropping older segments never forgets it. */
+#define SEGMENT_MAGIC 0x534A4D49 /* "IMJS" */
+#define SEGMENT_HEADER_SIZE 12
+#define RECORD_HEADER_SIZE 16
+#define RECORD_MARKER 0x4A
+#define RECORD_TYPE_MESSAGE 1
+#define RECORD_TYPE_ACK 2
+#define MIN_SEGMENT_SIZE 256
+
+/* message payload: kind(1) then fields of tag(1) length(4) bytes; strings keep their '\0' */
+#define MESSAGE_KIND_BYTEARRAY 1
+#define MESSAGE_KIND_STRING 2
+#define FIELD_BODY 1
+#define FIELD_MESSAGE_ID 2
+#define FIELD_CORRELATION_ID 3
+#define FIELD_CONTENT_TYPE 4
+#define FIELD_CONTENT_ENCODING 5
+#define FIELD_PROPERTY 6 /* key'\0'value'\0' */
+#define FIELD_HEADER_SIZE 5
+#define SYSTEM_PROPERTY_COUNT 4
+
+typedef struct JOURNAL_SEGMENT_TAG
+{
+    size_t slot;
+    uint32_t segment_sequence;
+    uint32_t first_message; /* 0 when the segment holds no message */
+    uint32_t last_message;
+    size_t size;            /* bytes of whole records, segment header included */
+} JOURNAL_SEGMENT;
+
+typedef struct IOTHUB_MESSAGE_JOURNAL_TAG
+{
+    const JOURNAL_STORAGE_INTERFACE_DESCRIPTION* storage_interface;
+    CONCRETE_JOURNAL_STORAGE_HANDLE storage;
+    size_t segment_size;
+    size_t max_segments;
+    JOURNAL_SEGMENT* segments;      /* oldest first; when writing is true the last one is being written */
+    size_t segment_count;
+    bool writing;
+    unsigned char* tail;            /* image of the segment being written, so that it is written out in bulk and read back without the storage */
+    size_t tail_flushed;
+    unsigned char* scratch;         /* payloads read back from sealed segments */
+    size_t scratch_size;
+    uint32_t next_sequence_number;
+    uint32_t next_segment_sequence;
+    uint32_t acknowledged;
+    uint32_t acknowledged_recorded; /* what the last ACK record in the tail says */
+    size_t read_segment;
+    size_t read_offset;
+    uint32_t read_from;
+    IOTHUB_MESSAGE_JOURNAL_STATISTICS statistics;
+} IOTHUB_MESSAGE_JOURNAL;
+
+typedef struct MESSAGE_FIELDS_TAG
+{
+    unsigned char kind;
+    const unsigned char* body;
+    size_t body_size;
+    const char* system_properties[SYSTEM_PROPERTY_COUNT];
+    const char* const* keys;
+    const char* const* values;
+    size_t property_count;
+} MESSAGE_FIELDS;
+
+static const unsigned char SYSTEM_PROPERTY_TAGS[SYSTEM_PROPERTY_COUNT] = { FIELD_MESSAGE_ID, FIELD_CORRELATION_ID, FIELD_CONTENT_TYPE, FIELD_CONTENT_ENCODING };
+
+/* CRC-32 (IEEE 802.3) a nibble at a time, so that the table stays at 64 bytes of flash */
+static const uint32_t CRC32_TABLE[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t crc32_update(uint32_t crc, const unsigned char* bytes, size_t size)
+{
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        crc ^= bytes[i];
+        crc = (crc >> 4) ^ CRC32_TABLE[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC32_TABLE[crc & 0x0F];
+    }
+    return crc;
+}
+
+static void put_uint32(unsigned char* destination, uint32_t value)
+{
+    destination[0] = (unsigned char)(value & 0xFF);
+    destination[1] = (unsigned char)((value >> 8) & 0xFF);
+    destination[2] = (unsigned char)((value >> 16) & 0xFF);
+    destination[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+static uint32_t get_uint32(const unsigned char* source)
+{
+    return (uint32_t)source[0] | ((uint32_t)source[1] << 8) | ((uint32_t)source[2] << 16) | ((uint32_t)source[3] << 24);
+}
+
+static uint32_t record_crc(const unsigned char* header, const unsigned char* payload, size_t payload_length)
+{
+    uint32_t crc = crc32_update(0xFFFFFFFF, header, RECORD_HEADER_SIZE - 4);
+    return ~crc32_update(crc, payload, payload_length);
+}
+
+static void write_record_header(unsigned char* header, unsigned char type, uint32_t sequence_number, const unsigned char* payload, size_t payload_length)
+{
+    header[0] = type;
+    header[1] = RECORD_MARKER;
+    header[2] = 0;
+    header[3] = 0;
+    put_uint32(header + 4, sequence_number);
+    put_uint32(header + 8, (uint32_t)payload_length);
+    put_uint32(header + 12, record_crc(header, payload, payload_length));
+}
+
+static int get_message_fields(IOTHUB_MESSAGE_HANDLE message, MESSAGE_FIELDS* fields)
+{
+    int result;
+    IOTHUBMESSAGE_CONTENT_TYPE content_type = IoTHubMessage_GetContentType(message);
+    MAP_HANDLE properties;
+
+    if (content_type == IOTHUBMESSAGE_BYTEARRAY)
+    {
+        fields->kind = MESSAGE_KIND_BYTEARRAY;
+        result = (IoTHubMessage_GetByteArray(message, &fields->body, &fields->body_size) == IOTHUB_MESSAGE_OK) ? 0 : __FAILURE__;
+    }
+    else if (content_type == IOTHUBMESSAGE_STRING)
+    {
+        const char* text = IoTHubMessage_GetString(message);
+        fields->kind = MESSAGE_KIND_STRING;
+        if (text == NULL)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            fields->body = (const unsigned char*)text;
+            fields->body_size = strlen(text) + 1;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = __FAILURE__;
+    }
+
+    if (result != 0)
+    {
+        LogError("unable to get the body of the message");
+    }
+    else
+    {
+        fields->system_properties[0] = IoTHubMessage_GetMessageId(message);
+        fields->system_properties[1] = IoTHubMessage_GetCorrelationId(message);
+        fields->system_properties[2] = IoTHubMessage_GetContentTypeSystemProperty(message);
+        fields->system_properties[3] = IoTHubMessage_GetContentEncodingSystemProperty(message);
+
+        if ((properties = IoTHubMessage_Properties(message)) == NULL)
+        {
+            LogError("unable to get the properties of the message");
+            result = __FAILURE__;
+        }
+        else if (Map_GetInternals(properties, &fields->keys, &fields->values, &fields->property_count) != MAP_OK)
+        {
+            LogError("unable to enumerate the properties of the message");
+            result = __FAILURE__;
+        }
+    }
+
+    return result;
+}
+
+static size_t get_payload_size(const MESSAGE_FIELDS* fields)
+{
+    size_t result = 1 + FIELD_HEADER_SIZE + fields->body_size;
+    size_t i;
+
+    for (i = 0; i < SYSTEM_PROPERTY_COUNT; i++)
+    {
+        if (fields->system_properties[i] != NULL)
+        {
+            result += FIELD_HEADER_SIZE + strlen(fields->system_properties[i]) + 1;
+        }
+    }
+    for (i = 0; i < fields->property_count; i++)
+    {
+        result += FIELD_HEADER_SIZE + strlen(fields->keys[i]) + 1 + strlen(fields->values[i]) + 1;
+    }
+
+    return result;
+}
+
+static unsigned char* put_field(unsigned char* destination, unsigned char tag, const void* bytes, size_t size)
+{
+    destination[0] = tag;
+    put_uint32(destination + 1, (uint32_t)size);
+    (void)memcpy(destination + FIELD_HEADER_SIZE, bytes, size);
+    return destination + FIELD_HEADER_SIZE + size;
+}
+
+static void write_payload(unsigned char* destination, const MESSAGE_FIELDS* fields)
+{
+    size_t i;
+
+    *destination++ = fields->kind;
+    destination = put_field(destination, FIELD_BODY, fields->body, fields->body_size);
+    for (i = 0; i < SYSTEM_PROPERTY_COUNT; i++)
+    {
+        if (fields->system_properties[i] != NULL)
+        {
+            destination = put_field(destination, SYSTEM_PROPERTY_TAGS[i], fields->system_properties[i], strlen(fields->system_properties[i]) + 1);
+        }
+    }
+    for (i = 0; i < fields->property_count; i++)
+    {
+        size_t key_size = strlen(fields->keys[i]) + 1;
+        size_t value_size = strlen(fields->values[i]) + 1;
+        destination[0] = FIELD_PROPERTY;
+        put_uint32(destination + 1, (uint32_t)(key_size + value_size));
+        (void)memcpy(destination + FIELD_HEADER_SIZE, fields->keys[i], key_size);
+        (void)memcpy(destination + FIELD_HEADER_SIZE + key_size, fields->values[i], value_size);
+        destination += FIELD_HEADER_SIZE + key_size + value_size;
+    }
+}
+
+static IOTHUB_MESSAGE_HANDLE read_payload(const unsigned char* payload, size_t payload_length)
+{
+    IOTHUB_MESSAGE_HANDLE result;
+    const unsigned char* end = payload + payload_length;
+    size_t body_size;
+
+    if ((payload_length < 1 + FIELD_HEADER_SIZE) ||
+        (payload[1] != FIELD_BODY) ||
+        ((body_size = get_uint32(payload + 2)) > payload_length - 1 - FIELD_HEADER_SIZE))
+    {
+        LogError("malformed message record");
+        result = NULL;
+    }
+    else
+    {
+        const unsigned char* body = payload + 1 + FIELD_HEADER_SIZE;
+        const unsigned char* field = body + body_size;
+
+        if (payload[0] == MESSAGE_KIND_BYTEARRAY)
+        {
+            result = IoTHubMessage_CreateFromByteArray(body, body_size);
+        }
+        else if ((payload[0] == MESSAGE_KIND_STRING) && (body_size > 0) && (body[body_size - 1] == '\0'))
+        {
+            result = IoTHubMessage_CreateFromString((const char*)body);
+        }
+        else
+        {
+            LogError("malformed message body");
+            result = NULL;
+        }
+
+        while ((result != NULL) && (field < end))
+        {
+            size_t size;
+            const char* value;
+            IOTHUB_MESSAGE_RESULT set_result;
+
+            if (((size_t)(end - field) < FIELD_HEADER_SIZE) ||
+                ((size = get_uint32(field + 1)) == 0) ||
+                (size > (size_t)(end - field) - FIELD_HEADER_SIZE) ||
+                (field[FIELD_HEADER_SIZE + size - 1] != '\0'))
+            {
+                LogError("malformed message field");
+                set_result = IOTHUB_MESSAGE_ERROR;
+            }
+            else
+            {
+                value = (const char*)(field + FIELD_HEADER_SIZE);
+                switch (field[0])
+                {
+                    case FIELD_MESSAGE_ID:
+                        set_result = IoTHubMessage_SetMessageId(result, value);
+                        break;
+                    case FIELD_CORRELATION_ID:
+                        set_result = IoTHubMessage_SetCorrelationId(result, value);
+                        break;
+                    case FIELD_CONTENT_TYPE:
+                        set_result = IoTHubMessage_SetContentTypeSystemProperty(result, value);
+                        break;
+                    case FIELD_CONTENT_ENCODING:
+                        set_result = IoTHubMessage_SetContentEncodingSystemProperty(result, value);
+                        break;
+                    case FIELD_PROPERTY:
+                    {
+                        size_t key_size = strlen(value) + 1;
+                        if ((key_size >= size) ||
+                            (Map_AddOrUpdate(IoTHubMessage_Properties(result), value, value + key_size) != MAP_OK))
+                        {
+                            set_result = IOTHUB_MESSAGE_ERROR;
+                        }
+                        else
+                        {
+                            set_result = IOTHUB_MESSAGE_OK;
+                        }
+                        break;
+                    }
+                    default:
+                        /*a field this version does not know about*/
+                        set_result = IOTHUB_MESSAGE_OK;
+                        break;
+                }
+                field += FIELD_HEADER_SIZE + size;
+            }
+
+            if (set_result != IOTHUB_MESSAGE_OK)
+            {
+                LogError("unable to restore a field of the message");
+                IoTHubMessage_Destroy(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+static int ensure_scratch(IOTHUB_MESSAGE_JOURNAL* journal, size_t size)
+{
+    int result;
+
+    if (size <= journal->scratch_size)
+    {
+        result = 0;
+    }
+    else
+    {
+        unsigned char* scratch = (unsigned char*)realloc(journal->scratch, size);
+        if (scratch == NULL)
+        {
+            LogError("failure allocating %lu bytes to read a record", (unsigned long)size);
+            result = __FAILURE__;
+        }
+        else
+        {
+            journal->scratch = scratch;
+            journal->scratch_size = size;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/*reads from the tail image for the segment being written, from the storage otherwise; 0 only if all size bytes were read*/
+static int read_segment_bytes(IOTHUB_MESSAGE_JOURNAL* journal, size_t index, size_t offset, unsigned char* buffer, size_t size)
+{
+    int result;
+
+    if (size == 0)
+    {
+        /*ACK records have no payload and the scratch buffer may not exist yet*/
+        result = 0;
+    }
+    else if (journal->writing && (index == journal->segment_count - 1))
+    {
+        (void)memcpy(buffer, journal->tail + offset, size);
+        result = 0;
+    }
+    else
+    {
+        size_t bytes_read;
+        if ((journal->storage_interface->concrete_storage_read(journal->storage, journal->segments[index].slot, offset, buffer, size, &bytes_read) != 0) ||
+            (bytes_read != size))
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int flush_tail(IOTHUB_MESSAGE_JOURNAL* journal)
+{
+    int result;
+    size_t size = journal->segments[journal->segment_count - 1].size;
+
+    if (journal->tail_flushed == size)
+    {
+        result = 0;
+    }
+    else if (journal->storage_interface->concrete_storage_append(journal->storage, journal->tail + journal->tail_flushed, size - journal->tail_flushed) != 0)
+    {
+        LogError("unable to write %lu bytes to the journal", (unsigned long)(size - journal->tail_flushed));
+        result = __FAILURE__;
+    }
+    else
+    {
+        journal->statistics.bytes_written += size - journal->tail_flushed;
+        journal->tail_flushed = size;
+        result = 0;
+    }
+
+    return result;
+}
+
+static void append_ack_record(IOTHUB_MESSAGE_JOURNAL* journal)
+{
+    JOURNAL_SEGMENT* segment = &journal->segments[journal->segment_count - 1];
+    write_record_header(journal->tail + segment->size, RECORD_TYPE_ACK, journal->acknowledged, NULL, 0);
+    segment->size += RECORD_HEADER_SIZE;
+    journal->acknowledged_recorded = journal->acknowledged;
+}
+
+static void remove_oldest_segment(IOTHUB_MESSAGE_JOURNAL* journal)
+{
+    JOURNAL_SEGMENT* oldest = &journal->segments[0];
+
+    if ((oldest->first_message != 0) && (oldest->last_message > journal->acknowledged))
+    {
+        uint32_t first_lost = (oldest->first_message > journal->acknowledged) ? oldest->first_message : journal->acknowledged + 1;
+        journal->statistics.messages_evicted += (size_t)(oldest->last_message - first_lost) + 1;
+        LogError("message journal is full, dropping %lu undelivered messages", (unsigned long)(oldest->last_message - first_lost) + 1);
+    }
+
+    if (journal->storage_interface->concrete_storage_remove_segment(journal->storage, oldest->slot) != 0)
+    {
+        /*the slot is truncated anyway when it is reused*/
+        LogError("unable to remove segment %lu of the journal", (unsigned long)oldest->slot);
+    }
+
+    (void)memmove(&journal->segments[0], &journal->segments[1], (journal->segment_count - 1) * sizeof(JOURNAL_SEGMENT));
+    journal->segment_count--;
+
+    if (journal->read_segment > 0)
+    {
+        journal->read_segment--;
+    }
+    else
+    {
+        journal->read_offset = 0;
+    }
+}
+
+static void remove_delivered_segments(IOTHUB_MESSAGE_JOURNAL* journal)
+{
+    /*the segment being written is never removed, it holds the latest ACK record*/
+    while ((journal->segment_count > (journal->writing ? 1U : 0U)) &&
+        ((journal->segments[0].first_message == 0) || (journal->segments[0].last_message <= journal->acknowledged)))
+    {
+        remove_oldest_segment(journal);
+    }
+}
+
+static int start_segment(IOTHUB_MESSAGE_JOURNAL* journal)
+{
+    int result;
+    size_t slot;
+    size_t i;
+
+    if (journal->segment_count == journal->max_segments)
+    {
+        remove_oldest_segment(journal);
+    }
+
+    /*pick the slot after the newest one that is not in use*/
+    slot = (journal->segment_count == 0) ? 0 : (journal->segments[journal->segment_count - 1].slot + 1) % journal->max_segments;
+    for (i = 0; i < journal->segment_count; i++)
+    {
+        if (journal->segments[i].slot == slot)
+        {
+            slot = (slot + 1) % journal->max_segments;
+            i = (size_t)-1;
+        }
+    }
+
+    if (journal->storage_interface->concrete_storage_start_segment(journal->storage, slot, journal->segment_size) != 0)
+    {
+        LogError("unable to start segment %lu of the journal", (unsigned long)slot);
+        result = __FAILURE__;
+    }
+    else
+    {
+        JOURNAL_SEGMENT* segment = &journal->segments[journal->segment_count];
+        segment->slot = slot;
+        segment->segment_sequence = journal->next_segment_sequence++;
+        segment->first_message = 0;
+        segment->last_message = 0;
+        segment->size = SEGMENT_HEADER_SIZE;
+
+        put_uint32(journal->tail, SEGMENT_MAGIC);
+        put_uint32(journal->tail + 4, segment->segment_sequence);
+        put_uint32(journal->tail + 8, ~crc32_update(0xFFFFFFFF, journal->tail, 8));
+
+        journal->segment_count++;
+        journal->writing = true;
+        journal->tail_flushed = 0;
+        append_ack_record(journal);
+        result = 0;
+    }
+
+    return result;
+}
+
+static int seal_segment(IOTHUB_MESSAGE_JOURNAL* journal)
+{
+    int result;
+
+    if (flush_tail(journal) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        journal->writing = false;
+        if (journal->storage_interface->concrete_storage_seal_segment(journal->storage) != 0)
+        {
+            LogError("unable to seal segment %lu of the journal", (unsigned long)journal->segments[journal->segment_count - 1].slot);
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int roll_segment(IOTHUB_MESSAGE_JOURNAL* journal)
+{
+    int result;
+
+    if (journal->writing && (seal_segment(journal) != 0))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = start_segment(journal);
+    }
+
+    return result;
+}
+
+/*validates the records of a recovered segment, the first bad one and everything after it are dropped*/
+static void scan_segment(IOTHUB_MESSAGE_JOURNAL* journal, JOURNAL_SEGMENT* segment, uint32_t* last_message)
+{
+    size_t index = (size_t)(segment - journal->segments);
+    unsigned char header[RECORD_HEADER_SIZE];
+    bool done = false;
+
+    while (!done)
+    {
+        size_t bytes_read;
+        uint32_t sequence_number;
+        size_t payload_length;
+
+        if ((journal->storage_interface->concrete_storage_read(journal->storage, segment->slot, segment->size, header, RECORD_HEADER_SIZE, &bytes_read) != 0) ||
+            (bytes_read != RECORD_HEADER_SIZE) ||
+            (header[1] != RECORD_MARKER))
+        {
+            /*end of what was written*/
+            done = true;
+        }
+        else if (((header[0] != RECORD_TYPE_MESSAGE) && (header[0] != RECORD_TYPE_ACK)) ||
+            ((payload_length = get_uint32(header + 8)) > journal->segment_size - segment->size - RECORD_HEADER_SIZE) ||
+            (ensure_scratch(journal, payload_length) != 0) ||
+            (read_segment_bytes(journal, index, segment->size + RECORD_HEADER_SIZE, journal->scratch, payload_length) != 0) ||
+            (record_crc(header, journal->scratch, payload_length) != get_uint32(header + 12)) ||
+            ((header[0] == RECORD_TYPE_MESSAGE) && ((sequence_number = get_uint32(header + 4)) <= *last_message)))
+        {
+            LogError("discarding a torn or corrupt record at offset %lu of segment %lu", (unsigned long)segment->size, (unsigned long)segment->slot);
+            journal->statistics.records_discarded++;
+            done = true;
+        }
+        else
+        {
+            if (header[0] == RECORD_TYPE_MESSAGE)
+            {
+                if (segment->first_message == 0)
+                {
+                    segment->first_message = sequence_number;
+                }
+                segment->last_message = sequence_number;
+                *last_message = sequence_number;
+            }
+            else if (get_uint32(header + 4) > journal->acknowledged)
+            {
+                journal->acknowledged = get_uint32(header + 4);
+            }
+            segment->size += RECORD_HEADER_SIZE + payload_length;
+        }
+    }
+}
+
+static void recover(IOTHUB_MESSAGE_JOURNAL* journal)
+{
+    uint32_t last_message = 0;
+    size_t slot;
+    size_t i;
+
+    for (slot = 0; slot < journal->max_segments; slot++)
+    {
+        unsigned char header[SEGMENT_HEADER_SIZE];
+        size_t bytes_read;
+
+        if ((journal->storage_interface->concrete_storage_read(journal->storage, slot, 0, header, SEGMENT_HEADER_SIZE, &bytes_read) == 0) &&
+            (bytes_read == SEGMENT_HEADER_SIZE) &&
+            (get_uint32(header) == SEGMENT_MAGIC) &&
+            (get_uint32(header + 8) == ~crc32_update(0xFFFFFFFF, header, 8)))
+        {
+            /*insertion sort on the segment sequence, there are only a handful of segments*/
+            uint32_t segment_sequence = get_uint32(header + 4);
+            i = journal->segment_count;
+            while ((i > 0) && (journal->segments[i - 1].segment_sequence > segment_sequence))
+            {
+                journal->segments[i] = journal->segments[i - 1];
+                i--;
+            }
+            journal->segments[i].slot = slot;
+            journal->segments[i].segment_sequence = segment_sequence;
+            journal->segments[i].first_message = 0;
+            journal->segments[i].last_message = 0;
+            journal->segments[i].size = SEGMENT_HEADER_SIZE;
+            journal->segment_count++;
+
+            if (segment_sequence >= journal->next_segment_sequence)
+            {
+                journal->next_segment_sequence = segment_sequence + 1;
+            }
+        }
+    }
+
+    for (i = 0; i < journal->segment_count; i++)
+    {
+        scan_segment(journal, &journal->segments[i], &last_message);
+    }
+
+    journal->next_sequence_number = ((last_message > journal->acknowledged) ? last_message : journal->acknowledged) + 1;
+    journal->acknowledged_recorded = journal->acknowledged;
+}
+
+IOTHUB_MESSAGE_JOURNAL_HANDLE IoTHubMessageJournal_Create(const IOTHUB_MESSAGE_JOURNAL_CONFIG* config)
+{
+    IOTHUB_MESSAGE_JOURNAL* result;
+
+    /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_001: [ If `config` or its `storage_interface` is NULL, `segment_size` is less than 256 or `max_segments` is less than 2, `IoTHubMessageJournal_Create` shall fail and return NULL. ]*/
+    if ((config == NULL) ||
+        (config->storage_interface == NULL) ||
+        (config->segment_size < MIN_SEGMENT_SIZE) ||
+        (config->max_segments < 2))
+    {
+        LogError("invalid argument config=%p", config);
+        result = NULL;
+    }
+    else if ((result = (IOTHUB_MESSAGE_JOURNAL*)malloc(sizeof(IOTHUB_MESSAGE_JOURNAL))) == NULL)
+    {
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_002: [ If any failure occurs, `IoTHubMessageJournal_Create` shall fail and return NULL. ]*/
+        LogError("failure allocating IOTHUB_MESSAGE_JOURNAL");
+    }
+    else
+    {
+        (void)memset(result, 0, sizeof(IOTHUB_MESSAGE_JOURNAL));
+        result->storage_interface = config->storage_interface;
+        result->segment_size = config->segment_size;
+        result->max_segments = config->max_segments;
+        result->next_segment_sequence = 1;
+
+        if (((result->segments = (JOURNAL_SEGMENT*)malloc(config->max_segments * sizeof(JOURNAL_SEGMENT))) == NULL) ||
+            ((result->tail = (unsigned char*)malloc(config->segment_size)) == NULL))
+        {
+            LogError("failure allocating the journal segments");
+            free(result->segments);
+            free(result);
+            result = NULL;
+        }
+        else if ((result->storage = config->storage_interface->concrete_storage_create(config->storage_parameters)) == NULL)
+        {
+            LogError("unable to create the journal storage");
+            free(result->tail);
+            free(result->segments);
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_003: [ `IoTHubMessageJournal_Create` shall read back the segments found in the storage in the order they were written, keeping every record up to the first one whose CRC does not match. ]*/
+            recover(result);
+
+            /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_004: [ `IoTHubMessageJournal_Create` shall remove the oldest segments whose messages are all acknowledged and start a new segment for the appends; recovered segments are never written again. ]*/
+            remove_delivered_segments(result);
+            if (start_segment(result) != 0)
+            {
+                LogError("unable to start writing the journal");
+                result->storage_interface->concrete_storage_destroy(result->storage);
+                free(result->scratch);
+                free(result->tail);
+                free(result->segments);
+                free(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+void IoTHubMessageJournal_Destroy(IOTHUB_MESSAGE_JOURNAL_HANDLE journal)
+{
+    if (journal != NULL)
+    {
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_005: [ `IoTHubMessageJournal_Destroy` shall flush the journal, seal the segment being written and free all resources. ]*/
+        (void)IoTHubMessageJournal_Flush(journal);
+        if (journal->writing)
+        {
+            (void)seal_segment(journal);
+        }
+        journal->storage_interface->concrete_storage_destroy(journal->storage);
+        free(journal->scratch);
+        free(journal->tail);
+        free(journal->segments);
+        free(journal);
+    }
+}
+
+int IoTHubMessageJournal_Append(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, IOTHUB_MESSAGE_HANDLE message, uint32_t* sequence_number)
+{
+    int result;
+    MESSAGE_FIELDS fields;
+
+    if ((journal == NULL) || (message == NULL) || (sequence_number == NULL))
+    {
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_006: [ If `journal`, `message` or `sequence_number` is NULL, `IoTHubMessageJournal_Append` shall fail and return a non-zero value. ]*/
+        LogError("invalid argument journal=%p, message=%p, sequence_number=%p", journal, message, sequence_number);
+        result = __FAILURE__;
+    }
+    else if (get_message_fields(message, &fields) != 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t payload_length = get_payload_size(&fields);
+
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_007: [ If the record of the message does not fit in a segment next to the segment's first ACK record, `IoTHubMessageJournal_Append` shall fail and return a non-zero value. ]*/
+        if (payload_length > journal->segment_size - SEGMENT_HEADER_SIZE - 2 * RECORD_HEADER_SIZE)
+        {
+            LogError("a message of %lu bytes does not fit in a journal segment", (unsigned long)payload_length);
+            result = __FAILURE__;
+        }
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_008: [ When the record does not fit in the segment being written, `IoTHubMessageJournal_Append` shall seal that segment and start the next one, first dropping the oldest segment if `max_segments` are in use. ]*/
+        else if ((!journal->writing ||
+            (journal->segments[journal->segment_count - 1].size + RECORD_HEADER_SIZE + payload_length > journal->segment_size)) &&
+            (roll_segment(journal) != 0))
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_009: [ `IoTHubMessageJournal_Append` shall serialize the body, message id, correlation id, content type, content encoding and properties of the message in a MESSAGE record, return its sequence number in `sequence_number` and return 0. ]*/
+            JOURNAL_SEGMENT* segment = &journal->segments[journal->segment_count - 1];
+            unsigned char* record = journal->tail + segment->size;
+
+            write_payload(record + RECORD_HEADER_SIZE, &fields);
+            write_record_header(record, RECORD_TYPE_MESSAGE, journal->next_sequence_number, record + RECORD_HEADER_SIZE, payload_length);
+            segment->size += RECORD_HEADER_SIZE + payload_length;
+            if (segment->first_message == 0)
+            {
+                segment->first_message = journal->next_sequence_number;
+            }
+            segment->last_message = journal->next_sequence_number;
+
+            *sequence_number = journal->next_sequence_number++;
+            journal->statistics.messages_appended++;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+int IoTHubMessageJournal_ReadNext(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, IOTHUB_MESSAGE_HANDLE* message, uint32_t* sequence_number)
+{
+    int result;
+
+    if ((journal == NULL) || (message == NULL) || (sequence_number == NULL))
+    {
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_010: [ If `journal`, `message` or `sequence_number` is NULL, `IoTHubMessageJournal_ReadNext` shall fail and return a non-zero value. ]*/
+        LogError("invalid argument journal=%p, message=%p, sequence_number=%p", journal, message, sequence_number);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+        *message = NULL;
+
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_011: [ `IoTHubMessageJournal_ReadNext` shall skip ACK records, acknowledged messages and messages before the one given to the last `IoTHubMessageJournal_Rewind`. ]*/
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_012: [ When it reaches the end of the segment being written, `IoTHubMessageJournal_ReadNext` shall set `*message` to NULL and return 0. ]*/
+        while ((result == 0) && (*message == NULL) && (journal->read_segment < journal->segment_count))
+        {
+            JOURNAL_SEGMENT* segment = &journal->segments[journal->read_segment];
+            unsigned char header[RECORD_HEADER_SIZE];
+            size_t payload_length;
+            uint32_t record_sequence_number;
+
+            if (journal->read_offset < SEGMENT_HEADER_SIZE)
+            {
+                journal->read_offset = SEGMENT_HEADER_SIZE;
+            }
+
+            if (journal->read_offset + RECORD_HEADER_SIZE > segment->size)
+            {
+                if (journal->read_segment + 1 == journal->segment_count)
+                {
+                    break;
+                }
+                journal->read_segment++;
+                journal->read_offset = 0;
+            }
+            else if ((read_segment_bytes(journal, journal->read_segment, journal->read_offset, header, RECORD_HEADER_SIZE) != 0) ||
+                ((payload_length = get_uint32(header + 8)) > segment->size - journal->read_offset - RECORD_HEADER_SIZE))
+            {
+                /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_013: [ If a record cannot be read back or its CRC does not match, `IoTHubMessageJournal_ReadNext` shall skip the rest of its segment. ]*/
+                LogError("unable to read the journal at offset %lu of segment %lu, skipping the rest of it", (unsigned long)journal->read_offset, (unsigned long)segment->slot);
+                journal->read_offset = segment->size;
+            }
+            else if ((header[0] != RECORD_TYPE_MESSAGE) ||
+                ((record_sequence_number = get_uint32(header + 4)) < journal->read_from) ||
+                (record_sequence_number <= journal->acknowledged))
+            {
+                journal->read_offset += RECORD_HEADER_SIZE + payload_length;
+            }
+            else if ((ensure_scratch(journal, payload_length) != 0) ||
+                (read_segment_bytes(journal, journal->read_segment, journal->read_offset + RECORD_HEADER_SIZE, journal->scratch, payload_length) != 0) ||
+                (record_crc(header, journal->scratch, payload_length) != get_uint32(header + 12)))
+            {
+                LogError("unable to read the journal at offset %lu of segment %lu, skipping the rest of it", (unsigned long)journal->read_offset, (unsigned long)segment->slot);
+                journal->read_offset = segment->size;
+            }
+            else if ((*message = read_payload(journal->scratch, payload_length)) == NULL)
+            {
+                /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_014: [ If the message cannot be rebuilt, `IoTHubMessageJournal_ReadNext` shall fail, return a non-zero value and read the same record on the next call. ]*/
+                LogError("unable to rebuild message %lu from the journal", (unsigned long)record_sequence_number);
+                result = __FAILURE__;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_015: [ Otherwise `IoTHubMessageJournal_ReadNext` shall return in `*message` a new message rebuilt from the record, its sequence number in `sequence_number`, and return 0. ]*/
+                *sequence_number = record_sequence_number;
+                journal->read_offset += RECORD_HEADER_SIZE + payload_length;
+                journal->statistics.messages_replayed++;
+            }
+        }
+    }
+
+    return result;
+}
+
+void IoTHubMessageJournal_Rewind(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, uint32_t sequence_number)
+{
+    if (journal == NULL)
+    {
+        LogError("invalid argument journal=NULL");
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_016: [ `IoTHubMessageJournal_Rewind` shall move the replay position to the start of the segment holding `sequence_number` so that the next message read is the first one not older than `sequence_number`. ]*/
+        size_t i;
+        journal->read_from = sequence_number;
+        journal->read_segment = 0;
+        journal->read_offset = 0;
+        for (i = 0; i < journal->segment_count; i++)
+        {
+            if ((journal->segments[i].first_message != 0) && (journal->segments[i].first_message <= sequence_number))
+            {
+                journal->read_segment = i;
+            }
+        }
+    }
+}
+
+void IoTHubMessageJournal_Acknowledge(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, uint32_t sequence_number)
+{
+    if (journal == NULL)
+    {
+        LogError("invalid argument journal=NULL");
+    }
+    /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_017: [ `IoTHubMessageJournal_Acknowledge` shall mark the messages up to `sequence_number` as delivered; acknowledgements never move back and the ACK record is only written by `IoTHubMessageJournal_Flush`. ]*/
+    else if ((sequence_number > journal->acknowledged) && (sequence_number < journal->next_sequence_number))
+    {
+        journal->acknowledged = sequence_number;
+    }
+}
+
+int IoTHubMessageJournal_Flush(IOTHUB_MESSAGE_JOURNAL_HANDLE journal)
+{
+    int result;
+
+    if (journal == NULL)
+    {
+        LogError("invalid argument journal=NULL");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_018: [ If messages were acknowledged since the last ACK record, `IoTHubMessageJournal_Flush` shall append an ACK record, starting the next segment if it does not fit. ]*/
+        if (journal->acknowledged != journal->acknowledged_recorded)
+        {
+            if (journal->writing &&
+                (journal->segments[journal->segment_count - 1].size + RECORD_HEADER_SIZE <= journal->segment_size))
+            {
+                append_ack_record(journal);
+            }
+            else if (roll_segment(journal) != 0)
+            {
+                result = __FAILURE__;
+            }
+        }
+
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_019: [ `IoTHubMessageJournal_Flush` shall write the records appended since the last flush to the storage in a single append. ]*/
+        if ((result == 0) && journal->writing && (flush_tail(journal) != 0))
+        {
+            result = __FAILURE__;
+        }
+
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_020: [ `IoTHubMessageJournal_Flush` shall remove the oldest sealed segments whose messages are all acknowledged. ]*/
+        remove_delivered_segments(journal);
+    }
+
+    return result;
+}
+
+uint32_t IoTHubMessageJournal_GetFirstSequenceNumber(IOTHUB_MESSAGE_JOURNAL_HANDLE journal)
+{
+    uint32_t result;
+
+    if (journal == NULL)
+    {
+        LogError("invalid argument journal=NULL");
+        result = 0;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_021: [ `IoTHubMessageJournal_GetFirstSequenceNumber` shall return the sequence number of the oldest message kept, or the next sequence number to be given out if there is none. ]*/
+        size_t i;
+        result = journal->next_sequence_number;
+        for (i = 0; i < journal->segment_count; i++)
+        {
+            if (journal->segments[i].first_message != 0)
+            {
+                result = journal->segments[i].first_message;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+size_t IoTHubMessageJournal_GetPendingCount(IOTHUB_MESSAGE_JOURNAL_HANDLE journal)
+{
+    size_t result;
+
+    if (journal == NULL)
+    {
+        LogError("invalid argument journal=NULL");
+        result = 0;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUB_MESSAGE_JOURNAL_99_022: [ `IoTHubMessageJournal_GetPendingCount` shall return how many of the messages kept are not acknowledged. ]*/
+        uint32_t first = IoTHubMessageJournal_GetFirstSequenceNumber(journal);
+        if (first <= journal->acknowledged)
+        {
+            first = journal->acknowledged + 1;
+        }
+        result = journal->next_sequence_number - first;
+    }
+
+    return result;
+}
+
+int IoTHubMessageJournal_GetStatistics(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, IOTHUB_MESSAGE_JOURNAL_STATISTICS* statistics)
+{
+    int result;
+
+    if ((journal == NULL) || (statistics == NULL))
+    {
+        LogError("invalid argument journal=%p, statistics=%p", journal, statistics);
+        result = __FAILURE__;
+    }
+    else
+    {
+        *statistics = journal->statistics;
+        statistics->segments_in_use = journal->segment_count;
+        result = 0;
+    }
+
+    return result;
+}
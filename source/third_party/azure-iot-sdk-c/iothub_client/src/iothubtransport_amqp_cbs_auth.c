@@ -8,6 +8,7 @@
 #include "azure_c_shared_utility/agenttime.h" 
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/sastoken.h"
+#include "azure_c_shared_utility/gb_rand.h"
 
 #define RESULT_OK                                 0
 #define INDEFINITE_TIME                           ((time_t)(-1))
@@ -31,6 +32,7 @@ typedef struct AUTHENTICATION_INSTANCE_TAG
     size_t cbs_request_timeout_secs;
     size_t sas_token_lifetime_secs;
     size_t sas_token_refresh_time_secs;
+    size_t sas_token_refresh_jitter_secs;
 
     AUTHENTICATION_STATE state;
     CBS_HANDLE cbs_handle;
@@ -39,6 +41,7 @@ typedef struct AUTHENTICATION_INSTANCE_TAG
     bool is_sas_token_refresh_in_progress;
 
     time_t current_sas_token_put_time;
+    size_t current_sas_token_refresh_advance_secs;
 
     // Auth module used to generating handle authorization
     // with either SAS Token, x509 Certs, and Device SAS Token
@@ -104,6 +107,23 @@ static int verify_cbs_put_token_timeout(AUTHENTICATION_INSTANCE* instance, bool*
     return result;
 }
 
+static size_t get_sas_token_refresh_time(AUTHENTICATION_INSTANCE* instance)
+{
+    size_t result;
+
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_131: [The SAS token shall be refreshed `instance->current_sas_token_refresh_advance_secs` earlier than `instance->sas_token_refresh_time_secs`]
+    if (instance->current_sas_token_refresh_advance_secs < instance->sas_token_refresh_time_secs)
+    {
+        result = instance->sas_token_refresh_time_secs - instance->current_sas_token_refresh_advance_secs;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
 static int verify_sas_token_refresh_timeout(AUTHENTICATION_INSTANCE* instance, bool* is_timed_out)
 {
     int result;
@@ -122,7 +142,7 @@ static int verify_sas_token_refresh_timeout(AUTHENTICATION_INSTANCE* instance, b
             result = __FAILURE__;
             LogError("Failed verifying if SAS token refresh timed out (get_time failed)");
         }
-        else if ((uint32_t)get_difftime(current_time, instance->current_sas_token_put_time) >= instance->sas_token_refresh_time_secs)
+        else if ((uint32_t)get_difftime(current_time, instance->current_sas_token_put_time) >= get_sas_token_refresh_time(instance))
         {
             *is_timed_out = true;
             result = RESULT_OK;
@@ -221,6 +241,12 @@ static int put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance, STRING_HANDLE
 
         instance->current_sas_token_put_time = current_time; // If it failed, fear not. `current_sas_token_put_time` shall be checked for INDEFINITE_TIME wherever it is used.
 
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_130: [If `instance->sas_token_refresh_jitter_secs` is not zero, `instance->current_sas_token_refresh_advance_secs` shall be set to a random value between 0 and `instance->sas_token_refresh_jitter_secs` using gb_rand()]
+        if (instance->sas_token_refresh_jitter_secs != 0)
+        {
+            instance->current_sas_token_refresh_advance_secs = (size_t)gb_rand() % (instance->sas_token_refresh_jitter_secs + 1);
+        }
+
         result = RESULT_OK;
     }
 
@@ -345,6 +371,7 @@ static void* authentication_clone_option(const char* name, const void* value)
         if (strcmp(AUTHENTICATION_OPTION_CBS_REQUEST_TIMEOUT_SECS, name) == 0 ||
             strcmp(AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_TIME_SECS, name) == 0 ||
             strcmp(AUTHENTICATION_OPTION_SAS_TOKEN_LIFETIME_SECS, name) == 0 ||
+            strcmp(AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, name) == 0 ||
             strcmp(AUTHENTICATION_OPTION_SAVED_OPTIONS, name) == 0)
         {
             result = (void*)value;
@@ -710,6 +737,12 @@ int authentication_set_option(AUTHENTICATION_HANDLE authentication_handle, const
             instance->sas_token_lifetime_secs = *((size_t*)value);
             result = RESULT_OK;
         }
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_129: [If name matches AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, `value` shall be saved on `instance->sas_token_refresh_jitter_secs`]
+        else if (strcmp(AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, name) == 0)
+        {
+            instance->sas_token_refresh_jitter_secs = *((size_t*)value);
+            result = RESULT_OK;
+        }
         else if (strcmp(AUTHENTICATION_OPTION_SAVED_OPTIONS, name) == 0)
         {
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_098: [If name matches AUTHENTICATION_OPTION_SAVED_OPTIONS, `value` shall be applied using OptionHandler_FeedOptions]
@@ -778,6 +811,11 @@ OPTIONHANDLER_HANDLE authentication_retrieve_options(AUTHENTICATION_HANDLE authe
                 LogError("Failed to retrieve options from authentication instance (OptionHandler_Create failed for option '%s')", AUTHENTICATION_OPTION_SAS_TOKEN_LIFETIME_SECS);
                 result = NULL;
             }
+            else if (OptionHandler_AddOption(options, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, (void*)&instance->sas_token_refresh_jitter_secs) != OPTIONHANDLER_OK)
+            {
+                LogError("Failed to retrieve options from authentication instance (OptionHandler_Create failed for option '%s')", AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS);
+                result = NULL;
+            }
             else
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_127: [If no failures occur, authentication_retrieve_options shall return the OPTIONHANDLER_HANDLE instance]
@@ -115,6 +115,8 @@ typedef struct AMQP_TRANSPORT_INSTANCE_TAG
     size_t option_sas_token_refresh_time_secs;                          // Device-specific option.
     size_t option_cbs_request_timeout_secs;                             // Device-specific option.
     size_t option_send_event_timeout_secs;                              // Device-specific option.
+    size_t option_sas_token_refresh_jitter_secs;                        // Device-specific option.
+    size_t option_cbs_max_outstanding_operations;                       // Applied to the CBS instance of each new connection.
 
                                                                         // Auth module used to generating handle authorization
     IOTHUB_AUTHORIZATION_HANDLE authorization_module;                   // with either SAS Token, x509 Certs, and Device SAS Token
@@ -803,6 +805,8 @@ static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance
         amqp_connection_config.svc2cl_keep_alive_timeout_secs = transport_instance->svc2cl_keep_alive_timeout_secs;
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_99_001: [AMQP connection will be configured using the `remote_idle_timeout_ratio` value from SetOption ]
         amqp_connection_config.cl2svc_keep_alive_send_ratio = transport_instance->cl2svc_keep_alive_send_ratio;
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_154: [`instance->option_cbs_max_outstanding_operations` shall be set into `AMQP_CONNECTION_CONFIG->cbs_max_outstanding_operations`]
+        amqp_connection_config.cbs_max_outstanding_operations = transport_instance->option_cbs_max_outstanding_operations;
 
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_027: [If `transport->preferred_authentication_method` is CBS, AMQP_CONNECTION_CONFIG shall be set with `create_sasl_io` = true and `create_cbs_connection` = true]
         if (transport_instance->preferred_authentication_mode == AMQP_TRANSPORT_AUTHENTICATION_MODE_CBS)
@@ -1221,6 +1225,16 @@ static int replicate_device_options_to(AMQP_TRANSPORT_DEVICE_INSTANCE* dev_insta
             LogError("Failed to apply option DEVICE_OPTION_SAS_TOKEN_REFRESH_TIME_SECS to device '%s' (device_set_option failed)", STRING_c_str(dev_instance->device_id));
             result = __FAILURE__;
         }
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_155: [The SAS token refresh jitter shall only be replicated to a new device if it has been set to a non-zero value]
+        else if (dev_instance->transport_instance->option_sas_token_refresh_jitter_secs != 0 &&
+            device_set_option(
+            dev_instance->device_handle,
+            DEVICE_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS,
+            &dev_instance->transport_instance->option_sas_token_refresh_jitter_secs) != RESULT_OK)
+        {
+            LogError("Failed to apply option DEVICE_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS to device '%s' (device_set_option failed)", STRING_c_str(dev_instance->device_id));
+            result = __FAILURE__;
+        }
         else
         {
             result = RESULT_OK;
@@ -1252,6 +1266,10 @@ static const char* get_device_option_name_from(const char* iothubclient_option_n
     {
         device_option_name = DEVICE_OPTION_CBS_REQUEST_TIMEOUT_SECS;
     }
+    else if (strcmp(OPTION_SAS_TOKEN_REFRESH_JITTER, iothubclient_option_name) == 0)
+    {
+        device_option_name = DEVICE_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS;
+    }
     else if (strcmp(OPTION_EVENT_SEND_TIMEOUT_SECS, iothubclient_option_name) == 0)
     {
         device_option_name = DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS;
@@ -1448,6 +1466,8 @@ TRANSPORT_LL_HANDLE IoTHubTransport_AMQP_Common_Create(const IOTHUBTRANSPORT_CON
                 instance->option_sas_token_refresh_time_secs = DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS;
                 instance->option_cbs_request_timeout_secs = DEFAULT_CBS_REQUEST_TIMEOUT_SECS;
                 instance->option_send_event_timeout_secs = DEFAULT_EVENT_SEND_TIMEOUT_SECS;
+                instance->option_sas_token_refresh_jitter_secs = 0;
+                instance->option_cbs_max_outstanding_operations = 0;
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_12_002: [The connection idle timeout parameter default value shall be set to 240000 milliseconds using connection_set_idle_timeout()]
                 instance->svc2cl_keep_alive_timeout_secs = DEFAULT_SERVICE_KEEP_ALIVE_FREQ_SECS;
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_99_001: [The remote idle timeout ratio shall be set to 0.5 using connection_set_remote_idle_timeout_empty_frame_send_ratio()]
@@ -1934,6 +1954,11 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
             is_device_specific_option = true;
             transport_instance->option_send_event_timeout_secs = *(size_t*)value;
         }
+        else if (strcmp(OPTION_SAS_TOKEN_REFRESH_JITTER, option) == 0)
+        {
+            is_device_specific_option = true;
+            transport_instance->option_sas_token_refresh_jitter_secs = *(size_t*)value;
+        }
         else
         {
             is_device_specific_option = false;
@@ -1952,6 +1977,12 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
                 result = IOTHUB_CLIENT_OK;
             }
         }
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_156: [If `option` is `cbs_max_outstanding_operations`, `value` shall be saved and applied to the CBS instance when the next connection is created]
+        else if (strcmp(OPTION_CBS_MAX_OUTSTANDING_OPERATIONS, option) == 0)
+        {
+            transport_instance->option_cbs_max_outstanding_operations = *(size_t*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
         else if ((strcmp(OPTION_SERVICE_SIDE_KEEP_ALIVE_FREQ_SECS, option) == 0) || (strcmp(OPTION_C2D_KEEP_ALIVE_FREQ_SECS, option) == 0))
         {
             transport_instance->svc2cl_keep_alive_timeout_secs = *(size_t*)value;
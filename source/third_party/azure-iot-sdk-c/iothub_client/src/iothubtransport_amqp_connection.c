@@ -37,6 +37,7 @@ typedef struct AMQP_CONNECTION_INSTANCE_TAG
     const void* on_state_changed_context;
     uint32_t svc2cl_keep_alive_timeout_secs;
     double cl2svc_keep_alive_send_ratio;
+    size_t cbs_max_outstanding_operations;
 } AMQP_CONNECTION_INSTANCE;
 
 
@@ -270,6 +271,14 @@ static int create_cbs_handle(AMQP_CONNECTION_INSTANCE* instance)
         result = __FAILURE__;
         LogError("Failed to create the CBS connection.");
     }
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_CONNECTION_09_075: [If `config->cbs_max_outstanding_operations` is not zero, it shall be set on `instance->cbs_handle` using cbs_set_max_outstanding_operations()]
+    else if (instance->cbs_max_outstanding_operations != 0 &&
+        cbs_set_max_outstanding_operations(instance->cbs_handle, instance->cbs_max_outstanding_operations) != RESULT_OK)
+    {
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_CONNECTION_09_076: [If cbs_set_max_outstanding_operations() fails, amqp_connection_create() shall fail and return NULL]
+        result = __FAILURE__;
+        LogError("Failed to limit the outstanding CBS operations.");
+    }
     // Codes_SRS_IOTHUBTRANSPORT_AMQP_CONNECTION_09_031: [`instance->cbs_handle` shall be opened using `cbs_open_async`]
     else if (cbs_open_async(instance->cbs_handle, on_cbs_open_complete, instance->cbs_handle, on_cbs_error, instance->cbs_handle) != RESULT_OK)
     {
@@ -395,6 +404,7 @@ AMQP_CONNECTION_HANDLE amqp_connection_create(AMQP_CONNECTION_CONFIG* config)
 
                 instance->svc2cl_keep_alive_timeout_secs = (uint32_t)config->svc2cl_keep_alive_timeout_secs;
 				instance->cl2svc_keep_alive_send_ratio = (double)config->cl2svc_keep_alive_send_ratio;
+                instance->cbs_max_outstanding_operations = config->cbs_max_outstanding_operations;
 
                 instance->current_state = AMQP_CONNECTION_STATE_CLOSED;
 
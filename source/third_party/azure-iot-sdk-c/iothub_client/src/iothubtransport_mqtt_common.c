@@ -49,6 +49,11 @@
 #define STATUS_CODE_FAILURE_VALUE           500
 #define STATUS_CODE_TIMEOUT_VALUE           408
 
+#define DEFAULT_BATCHING_MAX_BYTES          4096
+#define DEFAULT_BATCHING_MAX_MESSAGES       32
+#define DEFAULT_BATCHING_LINGER_MS          0
+#define BATCH_FRAME_HEADER_SIZE             4
+
 #define DEFAULT_RETRY_POLICY                IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER
 #define DEFAULT_RETRY_TIMEOUT_IN_SECONDS    0
 
@@ -81,6 +86,8 @@ static const char* DIAGNOSTIC_CONTEXT_PROPERTY = "diagctx";
 
 static const char* DIAGNOSTIC_CONTEXT_CREATION_TIME_UTC_PROPERTY = "creationtimeutc";
 
+static const char* BATCH_COUNT_PROPERTY = "mqtt-batch";
+
 #define UNSUBSCRIBE_FROM_TOPIC                  0x0000
 #define SUBSCRIBE_GET_REPORTED_STATE_TOPIC      0x0001
 #define SUBSCRIBE_NOTIFICATION_STATE_TOPIC      0x0002
@@ -197,6 +204,14 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
     // Telemetry specific
     DLIST_ENTRY telemetry_waitingForAck;
 
+    // Telemetry batching, messages with the same topic are packed into one PUBLISH
+    bool batching;
+    size_t batching_max_bytes;
+    size_t batching_max_messages;
+    tickcounter_ms_t batching_linger_ms;
+    bool batch_lingering;
+    tickcounter_ms_t batch_linger_start;
+
     // Controls frequency of reconnection logic.
     RETRY_CONTROL_HANDLE retry_control_handle;
 
@@ -230,6 +245,11 @@ typedef struct MQTT_MESSAGE_DETAILS_LIST_TAG
     IOTHUB_MESSAGE_LIST* iotHubMessageEntry;
     void* context;
     uint16_t packet_id;
+    // The messages batched after iotHubMessageEntry and the framed payload kept for resending, NULL when not batched
+    IOTHUB_MESSAGE_LIST** batchedMessages;
+    size_t batchCount;
+    unsigned char* batchPayload;
+    size_t batchPayloadLength;
     DLIST_ENTRY entry;
 } MQTT_MESSAGE_DETAILS_LIST, *PMQTT_MESSAGE_DETAILS_LIST;
 
@@ -580,6 +600,30 @@ static void sendMsgComplete(IOTHUB_MESSAGE_LIST* iothubMsgList, PMQTTTRANSPORT_H
     IoTHubClient_LL_SendComplete(transport_data->llClientHandle, &messageCompleted, confirmResult);
 }
 
+/* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_005: [ When a batch is acknowledged, fails or is discarded every message packed into it shall be completed with the same result in a single call to IoTHubClient_LL_SendComplete. ] */
+static void completeTelemetryEntry(MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry, PMQTTTRANSPORT_HANDLE_DATA transport_data, IOTHUB_CLIENT_CONFIRMATION_RESULT confirmResult)
+{
+    if (mqttMsgEntry->batchedMessages == NULL)
+    {
+        sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, confirmResult);
+    }
+    else
+    {
+        size_t index;
+        DLIST_ENTRY messagesCompleted;
+        DList_InitializeListHead(&messagesCompleted);
+        DList_InsertTailList(&messagesCompleted, &(mqttMsgEntry->iotHubMessageEntry->entry));
+        for (index = 0; index < mqttMsgEntry->batchCount; index++)
+        {
+            DList_InsertTailList(&messagesCompleted, &(mqttMsgEntry->batchedMessages[index]->entry));
+        }
+        IoTHubClient_LL_SendComplete(transport_data->llClientHandle, &messagesCompleted, confirmResult);
+        free(mqttMsgEntry->batchedMessages);
+        free(mqttMsgEntry->batchPayload);
+    }
+    free(mqttMsgEntry);
+}
+
 static STRING_HANDLE addPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_message_handle, const char* eventTopic)
 {
     STRING_HANDLE result = STRING_construct(eventTopic);
@@ -701,40 +745,16 @@ static STRING_HANDLE addPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_me
                 if (result != NULL)
                 {
                     //construct diagnostic context, it should be urlencode(key1=value1,key2=value2)
-                    STRING_HANDLE diagContextHandle = STRING_construct_sprintf("%s=%s", DIAGNOSTIC_CONTEXT_CREATION_TIME_UTC_PROPERTY, creation_time_utc);
-                    if (diagContextHandle == NULL)
+                    //the key needs no escaping, so only the value is encoded and written straight after "key%3d"
+                    if ((STRING_sprintf(result, "%s%%24.%s=%s%%3d", index == 0 ? "" : PROPERTY_SEPARATOR, DIAGNOSTIC_CONTEXT_PROPERTY, DIAGNOSTIC_CONTEXT_CREATION_TIME_UTC_PROPERTY) != 0) ||
+                        (URL_EncodeConcat(result, creation_time_utc) != 0))
                     {
-                        LogError("Failed constructing diagnostic context");
+                        LogError("Failed setting diagnostic context");
                         STRING_delete(result);
                         result = NULL;
                     }
-                    else
-                    {
-                        //Add other diagnostic context properties here if have more
-                        STRING_HANDLE encodedContextValueHandle = URL_Encode(diagContextHandle);
-                        const char* encodedContextValueString = NULL;
-                        if (encodedContextValueHandle != NULL &&
-                            (encodedContextValueString = STRING_c_str(encodedContextValueHandle)) != NULL)
-                        {
-                            if (STRING_sprintf(result, "%s%%24.%s=%s", index == 0 ? "" : PROPERTY_SEPARATOR, DIAGNOSTIC_CONTEXT_PROPERTY, encodedContextValueString) != 0)
-                            {
-                                LogError("Failed setting diagnostic context");
-                                STRING_delete(result);
-                                result = NULL;
-                            }
-                            STRING_delete(encodedContextValueHandle);
-                            encodedContextValueHandle = NULL;
-                        }
-                        else
-                        {
-                            LogError("Failed encoding diagnostic context value");
-                            STRING_delete(result);
-                            result = NULL;
-                        }
-                        STRING_delete(diagContextHandle);
-                        diagContextHandle = NULL;
-                        index++;
-                    }
+                    //Add other diagnostic context properties here if have more
+                    index++;
                 }
             }
             else if (diag_id != NULL || creation_time_utc != NULL)
@@ -759,6 +779,15 @@ static int publish_mqtt_telemetry_msg(PMQTTTRANSPORT_HANDLE_DATA transport_data,
         LogError("Failed adding properties to mqtt message");
         result = __FAILURE__;
     }
+    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_004: [ The topic of a batch shall be the topic of its messages with the property mqtt-batch=<number of messages> added. ] */
+    else if ((mqttMsgEntry->batchedMessages != NULL) &&
+        (STRING_sprintf(msgTopic, "%s%s=%lu", STRING_length(msgTopic) == STRING_length(transport_data->topic_MqttEvent) ? "" : PROPERTY_SEPARATOR,
+            BATCH_COUNT_PROPERTY, (unsigned long)(mqttMsgEntry->batchCount + 1)) != 0))
+    {
+        LogError("Failed adding the batch count to mqtt message");
+        STRING_delete(msgTopic);
+        result = __FAILURE__;
+    }
     else
     {
         MQTT_MESSAGE_HANDLE mqttMsg = mqttmessage_create(mqttMsgEntry->packet_id, STRING_c_str(msgTopic), DELIVER_AT_LEAST_ONCE, payload, len);
@@ -1309,8 +1338,7 @@ static void mqtt_operation_complete_callback(MQTT_CLIENT_HANDLE handle, MQTT_CLI
                         if (puback->packetId == mqttMsgEntry->packet_id)
                         {
                             (void)DList_RemoveEntryList(currentListEntry); //First remove the item from Waiting for Ack List.
-                            sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_OK);
-                            free(mqttMsgEntry);
+                            completeTelemetryEntry(mqttMsgEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_OK);
                         }
                         currentListEntry = saveListEntry.Flink;
                     }
@@ -1741,32 +1769,23 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
             // This will be a major hurdle when we add device multiplexing to MQTT transport.
 
             void* product_info;
-            STRING_HANDLE clone;
+            int concat_result;
             if ((IoTHubClient_LL_GetOption(transport_data->llClientHandle, OPTION_PRODUCT_INFO, &product_info) == IOTHUB_CLIENT_ERROR) || (product_info == NULL))
             {
-                clone = STRING_construct_sprintf("%s%%2F%s", CLIENT_DEVICE_TYPE_PREFIX, IOTHUB_SDK_VERSION);
+                concat_result = STRING_sprintf(transport_data->configPassedThroughUsername, "%s%%2F%s", CLIENT_DEVICE_TYPE_PREFIX, IOTHUB_SDK_VERSION);
             }
             else
             {
-                clone = URL_Encode(product_info);
+                concat_result = URL_EncodeConcat(transport_data->configPassedThroughUsername, STRING_c_str((STRING_HANDLE)product_info));
             }
 
-            if (clone == NULL)
+            if (concat_result != 0)
             {
-                LogError("Failed obtaining the product info");
+                LogError("Failed concatenating the product info");
             }
             else
             {
-                if (STRING_concat_with_STRING(transport_data->configPassedThroughUsername, clone) != 0)
-                {
-                    LogError("Failed concatenating the product info");
-                }
-                else
-                {
-                    transport_data->isProductInfoSet = true;
-                }
-
-                STRING_delete(clone);
+                transport_data->isProductInfoSet = true;
             }
         }
 
@@ -2004,6 +2023,12 @@ static PMQTTTRANSPORT_HANDLE_DATA InitializeTransportHandleData(const IOTHUB_CLI
                         state->currPacketState = CONNECT_TYPE;
                         state->keepAliveValue = DEFAULT_MQTT_KEEPALIVE;
                         state->connect_timeout_in_sec = DEFAULT_CONNACK_TIMEOUT;
+                        state->batching = false;
+                        state->batching_max_bytes = DEFAULT_BATCHING_MAX_BYTES;
+                        state->batching_max_messages = DEFAULT_BATCHING_MAX_MESSAGES;
+                        state->batching_linger_ms = DEFAULT_BATCHING_LINGER_MS;
+                        state->batch_lingering = false;
+                        state->batch_linger_start = 0;
                         state->connectFailCount = 0;
                         state->connectTick = 0;
                         state->topic_MqttMessage = NULL;
@@ -2117,8 +2142,7 @@ void IoTHubTransport_MQTT_Common_Destroy(TRANSPORT_LL_HANDLE handle)
         {
             PDLIST_ENTRY currentEntry = DList_RemoveHeadList(&transport_data->telemetry_waitingForAck);
             MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = containingRecord(currentEntry, MQTT_MESSAGE_DETAILS_LIST, entry);
-            sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY);
-            free(mqttMsgEntry);
+            completeTelemetryEntry(mqttMsgEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY);
         }
         while (!DList_IsListEmpty(&transport_data->ack_waiting_queue))
         {
@@ -2466,6 +2490,219 @@ IOTHUB_PROCESS_ITEM_RESULT IoTHubTransport_MQTT_Common_ProcessItem(TRANSPORT_LL_
     return result;
 }
 
+static bool isBatchLingerOver(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    bool result;
+    tickcounter_ms_t current_ms;
+    if (transport_data->batching_linger_ms == 0)
+    {
+        result = true;
+    }
+    else if (tickcounter_get_current_ms(transport_data->msgTickCounter, &current_ms) != 0)
+    {
+        LogError("Failed retrieving tickcounter info");
+        result = true;
+    }
+    else if (!transport_data->batch_lingering)
+    {
+        transport_data->batch_lingering = true;
+        transport_data->batch_linger_start = current_ms;
+        result = false;
+    }
+    else
+    {
+        result = (current_ms - transport_data->batch_linger_start) >= transport_data->batching_linger_ms;
+    }
+    return result;
+}
+
+/* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_003: [ The payload of a batch shall be the payload of each message, in the order they were queued, each preceded by its length as 4 bytes in network byte order. ] */
+static int publishTelemetryBatch(PMQTTTRANSPORT_HANDLE_DATA transport_data, PDLIST_ENTRY firstListEntry, size_t count, size_t batchLength)
+{
+    int result;
+    MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = (MQTT_MESSAGE_DETAILS_LIST*)malloc(sizeof(MQTT_MESSAGE_DETAILS_LIST));
+    if (mqttMsgEntry == NULL)
+    {
+        LogError("Allocation Error: Failure allocating MQTT Message Detail List.");
+        result = __FAILURE__;
+    }
+    else if ((mqttMsgEntry->batchedMessages = (IOTHUB_MESSAGE_LIST**)malloc((count - 1) * sizeof(IOTHUB_MESSAGE_LIST*))) == NULL)
+    {
+        LogError("Allocation Error: Failure allocating the batched message list.");
+        free(mqttMsgEntry);
+        result = __FAILURE__;
+    }
+    else if ((mqttMsgEntry->batchPayload = (unsigned char*)malloc(batchLength)) == NULL)
+    {
+        LogError("Allocation Error: Failure allocating the batch payload.");
+        free(mqttMsgEntry->batchedMessages);
+        free(mqttMsgEntry);
+        result = __FAILURE__;
+    }
+    else
+    {
+        PDLIST_ENTRY currentListEntry = firstListEntry;
+        unsigned char* frame = mqttMsgEntry->batchPayload;
+        size_t index;
+
+        mqttMsgEntry->retryCount = 0;
+        mqttMsgEntry->batchCount = count - 1;
+        mqttMsgEntry->batchPayloadLength = batchLength;
+        for (index = 0; index < count; index++)
+        {
+            IOTHUB_MESSAGE_LIST* iothubMsgList = containingRecord(currentListEntry, IOTHUB_MESSAGE_LIST, entry);
+            PDLIST_ENTRY nextListEntry = currentListEntry->Flink;
+            size_t messageLength;
+            const unsigned char* messagePayload = RetrieveMessagePayload(iothubMsgList->messageHandle, &messageLength);
+
+            frame[0] = (unsigned char)((messageLength >> 24) & 0xFF);
+            frame[1] = (unsigned char)((messageLength >> 16) & 0xFF);
+            frame[2] = (unsigned char)((messageLength >> 8) & 0xFF);
+            frame[3] = (unsigned char)(messageLength & 0xFF);
+            (void)memcpy(frame + BATCH_FRAME_HEADER_SIZE, messagePayload, messageLength);
+            frame += BATCH_FRAME_HEADER_SIZE + messageLength;
+
+            (void)DList_RemoveEntryList(currentListEntry);
+            if (index == 0)
+            {
+                mqttMsgEntry->iotHubMessageEntry = iothubMsgList;
+            }
+            else
+            {
+                mqttMsgEntry->batchedMessages[index - 1] = iothubMsgList;
+            }
+            currentListEntry = nextListEntry;
+        }
+
+        mqttMsgEntry->packet_id = get_next_packet_id(transport_data);
+        if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, mqttMsgEntry->batchPayload, batchLength) != 0)
+        {
+            completeTelemetryEntry(mqttMsgEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+        }
+        else
+        {
+            DList_InsertTailList(&(transport_data->telemetry_waitingForAck), &(mqttMsgEntry->entry));
+        }
+        result = 0;
+    }
+    return result;
+}
+
+static int publishTelemetryMessage(PMQTTTRANSPORT_HANDLE_DATA transport_data, IOTHUB_MESSAGE_LIST* iothubMsgList, const unsigned char* messagePayload, size_t messageLength)
+{
+    int result;
+    /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_029: [IoTHubTransport_MQTT_Common_DoWork shall create a MQTT_MESSAGE_HANDLE and pass this to a call to mqtt_client_publish.] */
+    MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = (MQTT_MESSAGE_DETAILS_LIST*)malloc(sizeof(MQTT_MESSAGE_DETAILS_LIST));
+    if (mqttMsgEntry == NULL)
+    {
+        LogError("Allocation Error: Failure allocating MQTT Message Detail List.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        mqttMsgEntry->retryCount = 0;
+        mqttMsgEntry->iotHubMessageEntry = iothubMsgList;
+        mqttMsgEntry->batchedMessages = NULL;
+        mqttMsgEntry->batchCount = 0;
+        mqttMsgEntry->batchPayload = NULL;
+        mqttMsgEntry->batchPayloadLength = 0;
+        mqttMsgEntry->packet_id = get_next_packet_id(transport_data);
+        if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength) != 0)
+        {
+            (void)(DList_RemoveEntryList(&(iothubMsgList->entry)));
+            sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+            free(mqttMsgEntry);
+        }
+        else
+        {
+            (void)(DList_RemoveEntryList(&(iothubMsgList->entry)));
+            DList_InsertTailList(&(transport_data->telemetry_waitingForAck), &(mqttMsgEntry->entry));
+        }
+        result = 0;
+    }
+    return result;
+}
+
+/* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_002: [ When batching is on IoTHubTransport_MQTT_Common_DoWork shall pack consecutive messages of "waitingToSend" that have the same topic into one PUBLISH, up to "mqtt_batching_max_messages" messages and "mqtt_batching_max_bytes" bytes of payload, and shall hold a batch that is not full until "mqtt_batching_linger_ms" has passed. A message too large to share a batch shall be published on its own as when batching is off. ] */
+static void sendBatchedTelemetry(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    PDLIST_ENTRY currentListEntry = transport_data->waitingToSend->Flink;
+    while (currentListEntry != transport_data->waitingToSend)
+    {
+        IOTHUB_MESSAGE_LIST* iothubMsgList = containingRecord(currentListEntry, IOTHUB_MESSAGE_LIST, entry);
+        STRING_HANDLE batchTopic;
+        size_t messageLength;
+        const unsigned char* messagePayload = RetrieveMessagePayload(iothubMsgList->messageHandle, &messageLength);
+        if (messageLength == 0 || messagePayload == NULL)
+        {
+            LogError("Failure result from IoTHubMessage_GetData");
+            currentListEntry = currentListEntry->Flink;
+        }
+        else if ((batchTopic = addPropertiesTouMqttMessage(iothubMsgList->messageHandle, STRING_c_str(transport_data->topic_MqttEvent))) == NULL)
+        {
+            LogError("Failed adding properties to mqtt message");
+            currentListEntry = currentListEntry->Flink;
+        }
+        else
+        {
+            PDLIST_ENTRY batchEnd = currentListEntry->Flink;
+            size_t count = 1;
+            size_t batchLength = BATCH_FRAME_HEADER_SIZE + messageLength;
+            bool isComplete = false;
+
+            while (!isComplete && (batchEnd != transport_data->waitingToSend))
+            {
+                IOTHUB_MESSAGE_LIST* nextMsgList = containingRecord(batchEnd, IOTHUB_MESSAGE_LIST, entry);
+                STRING_HANDLE nextTopic;
+                if ((count >= transport_data->batching_max_messages) ||
+                    ((messagePayload = RetrieveMessagePayload(nextMsgList->messageHandle, &messageLength)) == NULL) ||
+                    (messageLength == 0) ||
+                    (batchLength + BATCH_FRAME_HEADER_SIZE + messageLength > transport_data->batching_max_bytes) ||
+                    ((nextTopic = addPropertiesTouMqttMessage(nextMsgList->messageHandle, STRING_c_str(transport_data->topic_MqttEvent))) == NULL))
+                {
+                    isComplete = true;
+                }
+                else
+                {
+                    if (strcmp(STRING_c_str(nextTopic), STRING_c_str(batchTopic)) != 0)
+                    {
+                        isComplete = true;
+                    }
+                    else
+                    {
+                        count++;
+                        batchLength += BATCH_FRAME_HEADER_SIZE + messageLength;
+                        batchEnd = batchEnd->Flink;
+                    }
+                    STRING_delete(nextTopic);
+                }
+            }
+            STRING_delete(batchTopic);
+
+            if (!isComplete && (count < transport_data->batching_max_messages) && !isBatchLingerOver(transport_data))
+            {
+                // Everything left fits in this batch, wait a little for more
+                currentListEntry = transport_data->waitingToSend;
+            }
+            else
+            {
+                int publishResult;
+                transport_data->batch_lingering = false;
+                if (count == 1)
+                {
+                    messagePayload = RetrieveMessagePayload(iothubMsgList->messageHandle, &messageLength);
+                    publishResult = publishTelemetryMessage(transport_data, iothubMsgList, messagePayload, messageLength);
+                }
+                else
+                {
+                    publishResult = publishTelemetryBatch(transport_data, currentListEntry, count, batchLength);
+                }
+                currentListEntry = (publishResult == 0) ? batchEnd : transport_data->waitingToSend;
+            }
+        }
+    }
+}
+
 /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_054: [ IoTHubTransport_MQTT_Common_DoWork shall subscribe to the Notification and get_state Topics if they are defined. ] */
 void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
 {
@@ -2527,8 +2764,7 @@ void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
                         {
                             PDLIST_ENTRY current_entry;
                             (void)DList_RemoveEntryList(currentListEntry);
-                            sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT);
-                            free(mqttMsgEntry);
+                            completeTelemetryEntry(mqttMsgEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT);
 
                             transport_data->currPacketState = PACKET_TYPE_ERROR;
                             transport_data->device_twin_get_sent = false;
@@ -2547,7 +2783,16 @@ void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
                         else
                         {
                             size_t messageLength;
-                            const unsigned char* messagePayload = RetrieveMessagePayload(mqttMsgEntry->iotHubMessageEntry->messageHandle, &messageLength);
+                            const unsigned char* messagePayload;
+                            if (mqttMsgEntry->batchPayload != NULL)
+                            {
+                                messagePayload = mqttMsgEntry->batchPayload;
+                                messageLength = mqttMsgEntry->batchPayloadLength;
+                            }
+                            else
+                            {
+                                messagePayload = RetrieveMessagePayload(mqttMsgEntry->iotHubMessageEntry->messageHandle, &messageLength);
+                            }
                             if (messageLength == 0 || messagePayload == NULL)
                             {
                                 LogError("Failure from creating Message IoTHubMessage_GetData");
@@ -2557,8 +2802,7 @@ void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
                                 if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength) != 0)
                                 {
                                     (void)DList_RemoveEntryList(currentListEntry);
-                                    sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
-                                    free(mqttMsgEntry);
+                                    completeTelemetryEntry(mqttMsgEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
                                 }
                             }
                         }
@@ -2566,48 +2810,33 @@ void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
                     currentListEntry = nextListEntry.Flink;
                 }
 
-                currentListEntry = transport_data->waitingToSend->Flink;
-                /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
-                while (currentListEntry != transport_data->waitingToSend)
+                if (transport_data->batching)
                 {
-                    IOTHUB_MESSAGE_LIST* iothubMsgList = containingRecord(currentListEntry, IOTHUB_MESSAGE_LIST, entry);
-                    DLIST_ENTRY savedFromCurrentListEntry;
-                    savedFromCurrentListEntry.Flink = currentListEntry->Flink;
-
+                    sendBatchedTelemetry(transport_data);
+                }
+                else
+                {
+                    currentListEntry = transport_data->waitingToSend->Flink;
                     /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
-                    size_t messageLength;
-                    const unsigned char* messagePayload = RetrieveMessagePayload(iothubMsgList->messageHandle, &messageLength);
-                    if (messageLength == 0 || messagePayload == NULL)
-                    {
-                        LogError("Failure result from IoTHubMessage_GetData");
-                    }
-                    else
+                    while (currentListEntry != transport_data->waitingToSend)
                     {
-                        /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_029: [IoTHubTransport_MQTT_Common_DoWork shall create a MQTT_MESSAGE_HANDLE and pass this to a call to mqtt_client_publish.] */
-                        MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = (MQTT_MESSAGE_DETAILS_LIST*)malloc(sizeof(MQTT_MESSAGE_DETAILS_LIST));
-                        if (mqttMsgEntry == NULL)
+                        IOTHUB_MESSAGE_LIST* iothubMsgList = containingRecord(currentListEntry, IOTHUB_MESSAGE_LIST, entry);
+                        DLIST_ENTRY savedFromCurrentListEntry;
+                        savedFromCurrentListEntry.Flink = currentListEntry->Flink;
+
+                        /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
+                        size_t messageLength;
+                        const unsigned char* messagePayload = RetrieveMessagePayload(iothubMsgList->messageHandle, &messageLength);
+                        if (messageLength == 0 || messagePayload == NULL)
                         {
-                            LogError("Allocation Error: Failure allocating MQTT Message Detail List.");
+                            LogError("Failure result from IoTHubMessage_GetData");
                         }
                         else
                         {
-                            mqttMsgEntry->retryCount = 0;
-                            mqttMsgEntry->iotHubMessageEntry = iothubMsgList;
-                            mqttMsgEntry->packet_id = get_next_packet_id(transport_data);
-                            if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength) != 0)
-                            {
-                                (void)(DList_RemoveEntryList(currentListEntry));
-                                sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
-                                free(mqttMsgEntry);
-                            }
-                            else
-                            {
-                                (void)(DList_RemoveEntryList(currentListEntry));
-                                DList_InsertTailList(&(transport_data->telemetry_waitingForAck), &(mqttMsgEntry->entry));
-                            }
+                            (void)publishTelemetryMessage(transport_data, iothubMsgList, messagePayload, messageLength);
                         }
+                        currentListEntry = savedFromCurrentListEntry.Flink;
                     }
-                    currentListEntry = savedFromCurrentListEntry.Flink;
                 }
             }
             /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_030: [IoTHubTransport_MQTT_Common_DoWork shall call mqtt_client_dowork everytime it is called if it is connected.] */
@@ -2708,6 +2937,49 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_SetOption(TRANSPORT_LL_HANDLE h
             }
             result = IOTHUB_CLIENT_OK;
         }
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_001: [ If the option parameter is set to "mqtt_batching" then the value shall be a bool_ptr and the value will determine if telemetry messages are packed into batches. ] */
+        else if (strcmp(OPTION_MQTT_BATCHING, option) == 0)
+        {
+            transport_data->batching = *((bool*)value);
+            transport_data->batch_lingering = false;
+            result = IOTHUB_CLIENT_OK;
+        }
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_006: [ If the option parameter is set to "mqtt_batching_max_bytes" then the value shall be a size_t_ptr with the largest batch payload, IoTHubTransport_MQTT_Common_SetOption shall return IOTHUB_CLIENT_INVALID_ARG if it is 0. ] */
+        else if (strcmp(OPTION_MQTT_BATCHING_MAX_BYTES, option) == 0)
+        {
+            size_t* max_bytes = (size_t*)value;
+            if (*max_bytes == 0)
+            {
+                LogError("invalid batching max bytes of 0");
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                transport_data->batching_max_bytes = *max_bytes;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_007: [ If the option parameter is set to "mqtt_batching_max_messages" then the value shall be a size_t_ptr with the most messages in a batch, IoTHubTransport_MQTT_Common_SetOption shall return IOTHUB_CLIENT_INVALID_ARG if it is 0. ] */
+        else if (strcmp(OPTION_MQTT_BATCHING_MAX_MESSAGES, option) == 0)
+        {
+            size_t* max_messages = (size_t*)value;
+            if (*max_messages == 0)
+            {
+                LogError("invalid batching max messages of 0");
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                transport_data->batching_max_messages = *max_messages;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_008: [ If the option parameter is set to "mqtt_batching_linger_ms" then the value shall be a tickcounter_ms_t_ptr with how long a batch that is not full is held. ] */
+        else if (strcmp(OPTION_MQTT_BATCHING_LINGER_MS, option) == 0)
+        {
+            transport_data->batching_linger_ms = *((tickcounter_ms_t*)value);
+            result = IOTHUB_CLIENT_OK;
+        }
         /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_039: [If the option parameter is set to "x509certificate" then the value shall be a const char of the certificate to be used for x509.] */
         else if ((strcmp(OPTION_X509_CERT, option) == 0) && (cred_type != IOTHUB_CREDENTIAL_TYPE_X509 && cred_type != IOTHUB_CREDENTIAL_TYPE_UNKNOWN))
         {
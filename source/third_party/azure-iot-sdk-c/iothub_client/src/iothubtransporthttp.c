@@ -97,7 +97,6 @@ static bool create_eventHTTPrelativePath(HTTPTRANSPORT_PERDEVICE_DATA* handleDat
 {
     /*Codes_SRS_TRANSPORTMULTITHTTP_17_017: [ IoTHubTransportHttp_Register shall create an immutable string (further called "event HTTP relative path") from the following pieces: "/devices/" + URL_ENCODED(deviceId) + "/messages/events" + APIVERSION. ]*/
     bool result;
-    STRING_HANDLE urlEncodedDeviceId;
     handleData->eventHTTPrelativePath = STRING_construct("/devices/");
     if (handleData->eventHTTPrelativePath == NULL)
     {
@@ -107,8 +106,7 @@ static bool create_eventHTTPrelativePath(HTTPTRANSPORT_PERDEVICE_DATA* handleDat
     else
     {
         if (!(
-            ((urlEncodedDeviceId = URL_EncodeString(deviceId)) != NULL) &&
-            (STRING_concat_with_STRING(handleData->eventHTTPrelativePath, urlEncodedDeviceId) == 0) &&
+            (URL_EncodeConcat(handleData->eventHTTPrelativePath, deviceId) == 0) &&
             (STRING_concat(handleData->eventHTTPrelativePath, EVENT_ENDPOINT API_VERSION) == 0)
             ))
         {
@@ -121,7 +119,6 @@ static bool create_eventHTTPrelativePath(HTTPTRANSPORT_PERDEVICE_DATA* handleDat
         {
             result = true;
         }
-        STRING_delete(urlEncodedDeviceId);
     }
     return result;
 }
@@ -143,11 +140,9 @@ static bool create_messageHTTPrelativePath(HTTPTRANSPORT_PERDEVICE_DATA* handleD
     }
     else
     {
-        STRING_HANDLE urlEncodedDeviceId;
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_019: [ IoTHubTransportHttp_Register shall create an immutable string (further called "message HTTP relative path") from the following pieces: "/devices/" + URL_ENCODED(deviceId) + "/messages/devicebound" + APIVERSION. ]*/
         if (!(
-            ((urlEncodedDeviceId = URL_EncodeString(deviceId)) != NULL) &&
-            (STRING_concat_with_STRING(handleData->messageHTTPrelativePath, urlEncodedDeviceId) == 0) &&
+            (URL_EncodeConcat(handleData->messageHTTPrelativePath, deviceId) == 0) &&
             (STRING_concat(handleData->messageHTTPrelativePath, MESSAGE_ENDPOINT_HTTP API_VERSION) == 0)
             ))
         {
@@ -160,7 +155,6 @@ static bool create_messageHTTPrelativePath(HTTPTRANSPORT_PERDEVICE_DATA* handleD
         {
             result = true;
         }
-        STRING_delete(urlEncodedDeviceId);
     }
 
     return result;
@@ -210,10 +204,8 @@ static bool create_eventHTTPrequestHeaders(HTTPTRANSPORT_PERDEVICE_DATA* handleD
         }
         else
         {
-            STRING_HANDLE urlEncodedDeviceId;
             if (!(
-                ((urlEncodedDeviceId = URL_EncodeString(deviceId)) != NULL) &&
-                (STRING_concat_with_STRING(temp, urlEncodedDeviceId) == 0) &&
+                (URL_EncodeConcat(temp, deviceId) == 0) &&
                 (STRING_concat(temp, EVENT_ENDPOINT) == 0)
                 ))
             {
@@ -241,7 +233,6 @@ static bool create_eventHTTPrequestHeaders(HTTPTRANSPORT_PERDEVICE_DATA* handleD
                     result = true;
                 }
             }
-            STRING_delete(urlEncodedDeviceId);
             STRING_delete(temp);
         }
     }
@@ -302,10 +293,8 @@ static bool create_abandonHTTPrelativePathBegin(HTTPTRANSPORT_PERDEVICE_DATA* ha
     }
     else
     {
-        STRING_HANDLE urlEncodedDeviceId;
         if (!(
-            ((urlEncodedDeviceId = URL_EncodeString(deviceId)) != NULL) &&
-            (STRING_concat_with_STRING(handleData->abandonHTTPrelativePathBegin, urlEncodedDeviceId) == 0) &&
+            (URL_EncodeConcat(handleData->abandonHTTPrelativePathBegin, deviceId) == 0) &&
             (STRING_concat(handleData->abandonHTTPrelativePathBegin, MESSAGE_ENDPOINT_HTTP_ETAG) == 0)
             ))
         {
@@ -318,7 +307,6 @@ static bool create_abandonHTTPrelativePathBegin(HTTPTRANSPORT_PERDEVICE_DATA* ha
         {
             result = true;
         }
-        STRING_delete(urlEncodedDeviceId);
     }
     return result;
 }
@@ -0,0 +1,547 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*
+ * Compares the serial Blob_UploadMultipleBlocksFromSasUri with Blob_UploadMultipleBlocksFromSasUriParallel.
+ * blob.c is linked against the stand-in HTTPAPIEX below instead of a real storage account: every request
+ * holds the shared uplink for size / UPLINK_BYTES_PER_SECOND and then waits one round trip for the
+ * response. The stand-in records what each Put Block carried and checks the final Put Block List
+ * against it, so a run only counts when the blob would have been committed intact and in order.
+ *
+ * The next two runs inject failures into the stand-in: one answers every FAIL_EVERY-th Put Block with
+ * 503, the other loses the link for good after OUTAGE_AFTER_BLOCKS blocks and then resumes the upload
+ * from the blocks it had stored, as after a reboot.
+ *
+ * The last run reads the blob the way a file would be read, writing each block into the slice blob.c
+ * offers to the callback, and counts how many distinct buffers the Put Block bodies came from.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "azure_c_shared_utility/httpapiex.h"
+#include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/buffer_.h"
+#include "blob.h"
+
+#define PERF_BLOCK_SIZE         (256 * 1024)
+#define PERF_BLOCK_COUNT        32
+#define ROUND_TRIP_MS           50
+#define UPLINK_BYTES_PER_SECOND (64 * 1024 * 1024)
+#define FAIL_EVERY              5
+#define OUTAGE_AFTER_BLOCKS     20
+#define SLICE_RUN_BLOCKS        32
+#define MAX_STORED_BLOCKS       1024
+
+typedef struct STORED_BLOCK_TAG
+{
+    int isPresent;
+    size_t size;
+    unsigned int checksum;
+} STORED_BLOCK;
+
+typedef struct STAND_IN_TAG
+{
+    pthread_mutex_t lock;
+    struct timespec uplinkFreeAt;
+    STORED_BLOCK blocks[MAX_STORED_BLOCKS];
+    size_t blockSize;               /*size of every block of the current run*/
+    unsigned int blockCount;        /*number of blocks of the current run*/
+    size_t connections;
+    int blockListOk;
+    size_t requests;
+    size_t bytesSent;
+    unsigned int failEvery;         /*answer every failEvery-th Put Block with 503, 0 for never*/
+    unsigned int outageAfterBlocks; /*drop every request once this many blocks are stored, 0 for never*/
+    unsigned int blocksStored;
+    const unsigned char* lastBody;  /*where the last Put Block body was read from*/
+    size_t distinctBodies;          /*how many times that changed*/
+} STAND_IN;
+
+static STAND_IN standIn = { PTHREAD_MUTEX_INITIALIZER };
+
+typedef struct SOURCE_TAG
+{
+    unsigned char* data;
+    size_t offset;
+} SOURCE;
+
+static unsigned int checksum(const unsigned char* data, size_t size)
+{
+    unsigned int result = 2166136261u;
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        result = (result ^ data[i]) * 16777619u;
+    }
+    return result;
+}
+
+static void add_ns(struct timespec* t, long long ns)
+{
+    t->tv_sec += (time_t)(ns / 1000000000LL);
+    t->tv_nsec += (long)(ns % 1000000000LL);
+    if (t->tv_nsec >= 1000000000L)
+    {
+        t->tv_sec++;
+        t->tv_nsec -= 1000000000L;
+    }
+}
+
+static int is_before(const struct timespec* a, const struct timespec* b)
+{
+    return (a->tv_sec < b->tv_sec) || ((a->tv_sec == b->tv_sec) && (a->tv_nsec < b->tv_nsec));
+}
+
+static double elapsed_ms(const struct timespec* start)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+/*queues the request behind the others on the uplink, then waits for the response to come back*/
+static void simulate_request(size_t size)
+{
+    struct timespec now;
+    struct timespec done;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    (void)pthread_mutex_lock(&standIn.lock);
+    done = is_before(&now, &standIn.uplinkFreeAt) ? standIn.uplinkFreeAt : now;
+    add_ns(&done, (long long)size * 1000000000LL / UPLINK_BYTES_PER_SECOND);
+    standIn.uplinkFreeAt = done;
+    (void)pthread_mutex_unlock(&standIn.lock);
+
+    add_ns(&done, ROUND_TRIP_MS * 1000000LL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &done, NULL) != 0)
+    {
+    }
+}
+
+static int decode_block_id(const char* base64, size_t length)
+{
+    int result;
+    char encoded[16];
+    BUFFER_HANDLE decoded;
+
+    if (length >= sizeof(encoded))
+    {
+        result = -1;
+    }
+    else
+    {
+        (void)memcpy(encoded, base64, length);
+        encoded[length] = '\0';
+        if ((decoded = Base64_Decoder(encoded)) == NULL)
+        {
+            result = -1;
+        }
+        else
+        {
+            char digits[8] = { 0 };
+            (void)memcpy(digits, BUFFER_u_char(decoded), BUFFER_length(decoded) < 7 ? BUFFER_length(decoded) : 7);
+            result = atoi(digits);
+            BUFFER_delete(decoded);
+        }
+    }
+    return result;
+}
+
+static void check_block_list(const unsigned char* content, size_t contentLength, const unsigned char* expected)
+{
+    char* xml = (char*)malloc(contentLength + 1);
+    int ok = (xml != NULL);
+    if (ok)
+    {
+        const char* cursor;
+        int next = 0;
+        (void)memcpy(xml, content, contentLength);
+        xml[contentLength] = '\0';
+
+        cursor = xml;
+        while (ok && ((cursor = strstr(cursor, "<Latest>")) != NULL))
+        {
+            const char* end = strstr(cursor, "</Latest>");
+            int blockID;
+            cursor += strlen("<Latest>");
+            blockID = (end == NULL) ? -1 : decode_block_id(cursor, (size_t)(end - cursor));
+            ok = (blockID == next) && (blockID < (int)standIn.blockCount) &&
+                standIn.blocks[blockID].isPresent &&
+                (standIn.blocks[blockID].size == standIn.blockSize) &&
+                (standIn.blocks[blockID].checksum == checksum(expected + (size_t)blockID * standIn.blockSize, standIn.blockSize));
+            next++;
+            cursor = end;
+        }
+        ok = ok && (next == (int)standIn.blockCount);
+        free(xml);
+    }
+    standIn.blockListOk = ok;
+}
+
+static const unsigned char* expectedBlob;
+
+HTTPAPIEX_HANDLE HTTPAPIEX_Create(const char* hostName)
+{
+    (void)hostName;
+    (void)pthread_mutex_lock(&standIn.lock);
+    standIn.connections++;
+    (void)pthread_mutex_unlock(&standIn.lock);
+    return (HTTPAPIEX_HANDLE)malloc(1);
+}
+
+void HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
+{
+    free(handle);
+}
+
+HTTPAPIEX_RESULT HTTPAPIEX_SetOption(HTTPAPIEX_HANDLE handle, const char* optionName, const void* value)
+{
+    (void)handle;
+    (void)optionName;
+    (void)value;
+    return HTTPAPIEX_OK;
+}
+
+/*Put Block comes through HTTPAPIEX_ExecuteRequestWithContent and Put Block List through HTTPAPIEX_ExecuteRequest; both end here*/
+static HTTPAPIEX_RESULT execute_request(const char* relativePath, const unsigned char* content, size_t contentLength, unsigned int* statusCode)
+{
+    HTTPAPIEX_RESULT result;
+    const char* blockIdParameter = strstr(relativePath, "&blockid=");
+    int isLinkDown;
+    int isInjectedFailure;
+
+    simulate_request(contentLength);
+
+    (void)pthread_mutex_lock(&standIn.lock);
+    standIn.requests++;
+    standIn.bytesSent += contentLength;
+    isLinkDown = (standIn.outageAfterBlocks != 0) && (standIn.blocksStored >= standIn.outageAfterBlocks);
+    isInjectedFailure = (blockIdParameter != NULL) && (standIn.failEvery != 0) && (standIn.requests % standIn.failEvery == 0);
+    (void)pthread_mutex_unlock(&standIn.lock);
+
+    if (isLinkDown)
+    {
+        result = HTTPAPIEX_ERROR;
+    }
+    else if (isInjectedFailure)
+    {
+        *statusCode = 503;
+        result = HTTPAPIEX_OK;
+    }
+    else if (blockIdParameter != NULL)
+    {
+        const char* base64 = blockIdParameter + strlen("&blockid=");
+        int blockID = decode_block_id(base64, strlen(base64));
+        if ((blockID < 0) || (blockID >= (int)standIn.blockCount))
+        {
+            *statusCode = 400;
+        }
+        else
+        {
+            (void)pthread_mutex_lock(&standIn.lock);
+            standIn.blocks[blockID].isPresent = 1;
+            standIn.blocks[blockID].size = contentLength;
+            standIn.blocks[blockID].checksum = checksum(content, contentLength);
+            standIn.blocksStored++;
+            if (content != standIn.lastBody)
+            {
+                standIn.lastBody = content;
+                standIn.distinctBodies++;
+            }
+            (void)pthread_mutex_unlock(&standIn.lock);
+            *statusCode = 201;
+        }
+        result = HTTPAPIEX_OK;
+    }
+    else if (strstr(relativePath, "&comp=blocklist") != NULL)
+    {
+        check_block_list(content, contentLength, expectedBlob);
+        *statusCode = standIn.blockListOk ? 201 : 400;
+        result = HTTPAPIEX_OK;
+    }
+    else
+    {
+        *statusCode = 400;
+        result = HTTPAPIEX_OK;
+    }
+    return result;
+}
+
+HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode,
+    HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    (void)handle;
+    (void)requestType;
+    (void)requestHttpHeadersHandle;
+    (void)responseHttpHeadersHandle;
+    (void)responseContent;
+    return execute_request(relativePath, BUFFER_u_char(requestContent), BUFFER_length(requestContent), statusCode);
+}
+
+HTTPAPIEX_RESULT HTTPAPIEX_ExecuteRequestWithContent(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE requestHttpHeadersHandle, const unsigned char* content, size_t contentLength, unsigned int* statusCode,
+    HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    (void)handle;
+    (void)requestType;
+    (void)requestHttpHeadersHandle;
+    (void)responseHttpHeadersHandle;
+    (void)responseContent;
+    return execute_request(relativePath, content, contentLength, statusCode);
+}
+
+/*blob.c brackets the parallel upload with these; the stand-in has nothing to set up*/
+HTTPAPI_RESULT HTTPAPI_Init(void)
+{
+    return HTTPAPI_OK;
+}
+
+void HTTPAPI_Deinit(void)
+{
+}
+
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT get_data(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context)
+{
+    SOURCE* source = (SOURCE*)context;
+    (void)result;
+    if ((data != NULL) && (size != NULL))
+    {
+        if (source->offset >= (size_t)PERF_BLOCK_SIZE * PERF_BLOCK_COUNT)
+        {
+            *data = NULL;
+            *size = 0;
+        }
+        else
+        {
+            *data = source->data + source->offset;
+            *size = PERF_BLOCK_SIZE;
+            source->offset += PERF_BLOCK_SIZE;
+        }
+    }
+    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+}
+
+/*reads the blob the way a file would be read: into the slice offered by blob.c, one slice per block*/
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT read_into_slice(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char* slice, size_t* size, void* context)
+{
+    SOURCE* source = (SOURCE*)context;
+    (void)result;
+    if ((slice != NULL) && (size != NULL))
+    {
+        if (source->offset >= (size_t)FILE_UPLOAD_SLICE_SIZE * SLICE_RUN_BLOCKS)
+        {
+            *size = 0;
+        }
+        else
+        {
+            (void)memcpy(slice, source->data + source->offset, *size);
+            source->offset += *size;
+        }
+    }
+    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+}
+
+static void reset_stand_in(size_t blockSize, unsigned int blockCount)
+{
+    (void)memset(standIn.blocks, 0, sizeof(standIn.blocks));
+    standIn.blockSize = blockSize;
+    standIn.blockCount = blockCount;
+    standIn.connections = 0;
+    standIn.blockListOk = 0;
+    standIn.requests = 0;
+    standIn.bytesSent = 0;
+    standIn.failEvery = 0;
+    standIn.outageAfterBlocks = 0;
+    standIn.blocksStored = 0;
+    standIn.lastBody = NULL;
+    standIn.distinctBodies = 0;
+}
+
+static int run(const char* name, unsigned char* blob, size_t maxBlocksInFlight)
+{
+    int result;
+    SOURCE source;
+    BLOB_UPLOAD_STATISTICS statistics;
+    unsigned int httpStatus = 0;
+    BUFFER_HANDLE httpResponse = BUFFER_new();
+    struct timespec start;
+    BLOB_RESULT uploadResult;
+    double ms;
+
+    source.data = blob;
+    source.offset = 0;
+    reset_stand_in(PERF_BLOCK_SIZE, PERF_BLOCK_COUNT);
+    (void)memset(&statistics, 0, sizeof(statistics));
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    if (maxBlocksInFlight == 0)
+    {
+        uploadResult = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", get_data, NULL, &source, &httpStatus, httpResponse, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
+    }
+    else
+    {
+        uploadResult = Blob_UploadMultipleBlocksFromSasUriParallel("https://h.h/something?a=b", get_data, NULL, &source, &httpStatus, httpResponse, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, maxBlocksInFlight, &statistics);
+    }
+    ms = elapsed_ms(&start);
+
+    if ((uploadResult != BLOB_OK) || (httpStatus >= 300) || !standIn.blockListOk)
+    {
+        (void)printf("%-12s FAILED (result %d, status %u, block list %s)\r\n", name, (int)uploadResult, httpStatus, standIn.blockListOk ? "ok" : "wrong");
+        result = __LINE__;
+    }
+    else
+    {
+        (void)printf("%-12s %8.0f ms %8.2f MB/s  connections %2zu  peak in flight %2zu  peak buffered %6zu KB\r\n",
+            name, ms, ((double)PERF_BLOCK_SIZE * PERF_BLOCK_COUNT / (1024 * 1024)) / (ms / 1000.0), standIn.connections,
+            statistics.peak_blocks_in_flight, statistics.peak_buffered_bytes / 1024);
+        result = 0;
+    }
+    BUFFER_delete(httpResponse);
+    return result;
+}
+
+static int run_with_retries(unsigned char* blob)
+{
+    int result;
+    SOURCE source;
+    BLOB_UPLOAD_RESUME resume;
+    unsigned int httpStatus = 0;
+    BUFFER_HANDLE httpResponse = BUFFER_new();
+    BLOB_RESULT uploadResult;
+
+    source.data = blob;
+    source.offset = 0;
+    reset_stand_in(PERF_BLOCK_SIZE, PERF_BLOCK_COUNT);
+    standIn.failEvery = FAIL_EVERY;
+    (void)memset(&resume, 0, sizeof(resume));
+    resume.blockRetries = 3;
+    resume.retryDelayMs = 10;
+
+    uploadResult = Blob_UploadMultipleBlocksFromSasUriResumable("https://h.h/something?a=b", get_data, NULL, &source, &httpStatus, httpResponse, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+    if ((uploadResult != BLOB_OK) || (httpStatus >= 300) || !standIn.blockListOk)
+    {
+        (void)printf("%-12s FAILED (result %d, status %u, block list %s)\r\n", "retries", (int)uploadResult, httpStatus, standIn.blockListOk ? "ok" : "wrong");
+        result = __LINE__;
+    }
+    else
+    {
+        (void)printf("%-12s 1 in %d Put Block answered 503: %zu requests, %6zu KB sent for a %d KB blob\r\n",
+            "retries", FAIL_EVERY, standIn.requests, standIn.bytesSent / 1024, PERF_BLOCK_SIZE * PERF_BLOCK_COUNT / 1024);
+        result = 0;
+    }
+    BUFFER_delete(httpResponse);
+    return result;
+}
+
+static int run_resume_after_outage(unsigned char* blob)
+{
+    int result;
+    SOURCE source;
+    BLOB_UPLOAD_RESUME resume;
+    unsigned int httpStatus = 0;
+    BUFFER_HANDLE httpResponse = BUFFER_new();
+    BLOB_RESULT uploadResult;
+    size_t bytesSentBeforeOutage;
+
+    source.data = blob;
+    source.offset = 0;
+    reset_stand_in(PERF_BLOCK_SIZE, PERF_BLOCK_COUNT);
+    standIn.outageAfterBlocks = OUTAGE_AFTER_BLOCKS;
+    (void)memset(&resume, 0, sizeof(resume));
+    resume.blockRetries = 1;
+    resume.retryDelayMs = 10;
+
+    uploadResult = Blob_UploadMultipleBlocksFromSasUriResumable("https://h.h/something?a=b", get_data, NULL, &source, &httpStatus, httpResponse, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+    if ((uploadResult != BLOB_HTTP_ERROR) || !resume.isResumable || (resume.blocksStored != OUTAGE_AFTER_BLOCKS))
+    {
+        (void)printf("%-12s FAILED (first attempt: result %d, resumable %d, blocks stored %u)\r\n", "resume", (int)uploadResult, resume.isResumable, resume.blocksStored);
+        result = __LINE__;
+    }
+    else
+    {
+        /*after the "reboot" the source starts over; what was stored is only kept in resume*/
+        bytesSentBeforeOutage = standIn.bytesSent;
+        standIn.outageAfterBlocks = 0;
+        source.offset = 0;
+        uploadResult = Blob_UploadMultipleBlocksFromSasUriResumable("https://h.h/something?a=b", get_data, NULL, &source, &httpStatus, httpResponse, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+        if ((uploadResult != BLOB_OK) || (httpStatus >= 300) || !standIn.blockListOk)
+        {
+            (void)printf("%-12s FAILED (result %d, status %u, block list %s)\r\n", "resume", (int)uploadResult, httpStatus, standIn.blockListOk ? "ok" : "wrong");
+            result = __LINE__;
+        }
+        else
+        {
+            (void)printf("%-12s link lost after %d blocks: %6zu KB sent before, %6zu KB after resuming (starting over: %d KB)\r\n",
+                "resume", OUTAGE_AFTER_BLOCKS, bytesSentBeforeOutage / 1024, (standIn.bytesSent - bytesSentBeforeOutage) / 1024, PERF_BLOCK_SIZE * PERF_BLOCK_COUNT / 1024);
+            result = 0;
+        }
+    }
+    BUFFER_delete(httpResponse);
+    return result;
+}
+
+static int run_from_slice(unsigned char* blob)
+{
+    int result;
+    SOURCE source;
+    unsigned int httpStatus = 0;
+    BUFFER_HANDLE httpResponse = BUFFER_new();
+    BLOB_RESULT uploadResult;
+
+    source.data = blob;
+    source.offset = 0;
+    reset_stand_in(FILE_UPLOAD_SLICE_SIZE, SLICE_RUN_BLOCKS);
+
+    uploadResult = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", NULL, read_into_slice, &source, &httpStatus, httpResponse, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
+    if ((uploadResult != BLOB_OK) || (httpStatus >= 300) || !standIn.blockListOk || (standIn.distinctBodies != 1))
+    {
+        (void)printf("%-12s FAILED (result %d, status %u, block list %s, %zu body buffers)\r\n", "slice", (int)uploadResult, httpStatus, standIn.blockListOk ? "ok" : "wrong", standIn.distinctBodies);
+        result = __LINE__;
+    }
+    else
+    {
+        (void)printf("%-12s %d blocks read into the slice: %zu body buffer of %d KB for a %d KB blob\r\n",
+            "slice", SLICE_RUN_BLOCKS, standIn.distinctBodies, FILE_UPLOAD_SLICE_SIZE / 1024, FILE_UPLOAD_SLICE_SIZE * SLICE_RUN_BLOCKS / 1024);
+        result = 0;
+    }
+    BUFFER_delete(httpResponse);
+    return result;
+}
+
+int main(void)
+{
+    int result;
+    unsigned char* blob = (unsigned char*)malloc((size_t)PERF_BLOCK_SIZE * PERF_BLOCK_COUNT);
+    if (blob == NULL)
+    {
+        (void)printf("out of memory\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        size_t i;
+        for (i = 0; i < (size_t)PERF_BLOCK_SIZE * PERF_BLOCK_COUNT; i++)
+        {
+            blob[i] = (unsigned char)(i * 31 + (i >> 12));
+        }
+        expectedBlob = blob;
+
+        (void)printf("%d blocks of %d KB, round trip %d ms, uplink %d MB/s\r\n", PERF_BLOCK_COUNT, PERF_BLOCK_SIZE / 1024, ROUND_TRIP_MS, UPLINK_BYTES_PER_SECOND / (1024 * 1024));
+        result = 0;
+        if (run("serial", blob, 0) != 0) result = __LINE__;
+        if (run("parallel 1", blob, 1) != 0) result = __LINE__;
+        if (run("parallel 2", blob, 2) != 0) result = __LINE__;
+        if (run("parallel 4", blob, 4) != 0) result = __LINE__;
+        if (run("parallel 8", blob, 8) != 0) result = __LINE__;
+        if (run_with_retries(blob) != 0) result = __LINE__;
+        if (run_resume_after_outage(blob) != 0) result = __LINE__;
+        if (run_from_slice(blob) != 0) result = __LINE__;
+        free(blob);
+    }
+    return result;
+}
@@ -30,6 +30,10 @@ static void my_gballoc_free(void* s)
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/shared_util_options.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/tickcounter.h"
 #undef ENABLE_MOCKS
 
 #include "blob.h"
@@ -232,6 +236,152 @@ static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_GetFakeData_Callback
     return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
 }
 
+/**
+ * FileUpload_FillSlice_Callback simulates a user who writes each of
+ * blocksCount blocks straight into the slice offered by the library.
+ * slicesOffered and contentSent record the pointers seen on each side.
+ */
+static const unsigned char* slicesOffered[4];
+static size_t sliceSizesOffered[4];
+static unsigned int slicesFilled;
+static const unsigned char* contentSent[4];
+static size_t contentSentCount;
+
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_FillSlice_Callback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char* slice, size_t* size, void* _uploadContext)
+{
+    unsigned int* blocksCount = (unsigned int*)_uploadContext;
+
+    if (slice == NULL || size == NULL)
+    {
+        // This is the last call
+    }
+    else if (result != FILE_UPLOAD_OK || slicesFilled >= *blocksCount)
+    {
+        *size = 0;
+    }
+    else
+    {
+        // Fill the slice in place, only half of it so that the size is seen to be updated
+        slicesOffered[slicesFilled] = slice;
+        sliceSizesOffered[slicesFilled] = *size;
+        memset(slice, '0' + slicesFilled, *size / 2);
+        *size = *size / 2;
+        slicesFilled++;
+    }
+
+    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+}
+
+/**
+ * FileUpload_Overfill_Callback claims to have written more than the slice holds.
+ */
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_Overfill_Callback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char* slice, size_t* size, void* _uploadContext)
+{
+    (void)result;
+    (void)slice;
+    (void)_uploadContext;
+    if (size != NULL)
+    {
+        *size = *size + 1;
+    }
+    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+}
+
+static HTTPAPIEX_RESULT my_HTTPAPIEX_ExecuteRequestWithContent_record(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, const unsigned char* content, size_t contentLength, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    (void)handle;
+    (void)requestType;
+    (void)relativePath;
+    (void)requestHttpHeadersHandle;
+    (void)responseHttpHeadersHandle;
+    (void)responseContent;
+    if ((contentSentCount < sizeof(contentSent) / sizeof(contentSent[0])) && (contentLength == FILE_UPLOAD_SLICE_SIZE / 2) && (content[0] == '0' + contentSentCount))
+    {
+        contentSent[contentSentCount] = content;
+    }
+    contentSentCount++;
+    *statusCode = 201;
+    return HTTPAPIEX_OK;
+}
+
+/**
+ * scriptedResults and scriptedStatuses are what the storage stand-in answers to
+ * each HTTPAPIEX_ExecuteRequest or HTTPAPIEX_ExecuteRequestWithContent, in order;
+ * used by the resumable upload tests.
+ */
+static const HTTPAPIEX_RESULT* scriptedResults;
+static const unsigned int* scriptedStatuses;
+static size_t scriptedCalls;
+static unsigned int sleeps[4];
+static size_t sleepCount;
+static unsigned int blockStoredCalls;
+
+static HTTPAPIEX_RESULT my_HTTPAPIEX_ExecuteRequest(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, BUFFER_HANDLE requestContent, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    (void)handle;
+    (void)requestType;
+    (void)relativePath;
+    (void)requestHttpHeadersHandle;
+    (void)requestContent;
+    (void)responseHttpHeadersHandle;
+    (void)responseContent;
+    *statusCode = scriptedStatuses[scriptedCalls];
+    return scriptedResults[scriptedCalls++];
+}
+
+static HTTPAPIEX_RESULT my_HTTPAPIEX_ExecuteRequestWithContent(HTTPAPIEX_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath, HTTP_HEADERS_HANDLE requestHttpHeadersHandle, const unsigned char* content, size_t contentLength, unsigned int* statusCode, HTTP_HEADERS_HANDLE responseHttpHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    (void)handle;
+    (void)requestType;
+    (void)relativePath;
+    (void)requestHttpHeadersHandle;
+    (void)content;
+    (void)contentLength;
+    (void)responseHttpHeadersHandle;
+    (void)responseContent;
+    *statusCode = scriptedStatuses[scriptedCalls];
+    return scriptedResults[scriptedCalls++];
+}
+
+static void my_ThreadAPI_Sleep(unsigned int milliseconds)
+{
+    if (sleepCount < sizeof(sleeps) / sizeof(sleeps[0]))
+    {
+        sleeps[sleepCount] = milliseconds;
+    }
+    sleepCount++;
+}
+
+static void on_block_stored(unsigned int blocksStored, size_t bytesStored, void* context)
+{
+    (void)blocksStored;
+    (void)bytesStored;
+    (void)context;
+    blockStoredCalls++;
+}
+
+static void setup_resumable_upload(const HTTPAPIEX_RESULT* results, const unsigned int* statuses, BLOB_UPLOAD_RESUME* resume, BLOB_UPLOAD_CONTEXT_FAKE* fakeContext, unsigned int blocksCount)
+{
+    scriptedResults = results;
+    scriptedStatuses = statuses;
+    scriptedCalls = 0;
+    sleepCount = 0;
+    blockStoredCalls = 0;
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_ExecuteRequest, my_HTTPAPIEX_ExecuteRequest);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_ExecuteRequestWithContent, my_HTTPAPIEX_ExecuteRequestWithContent);
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Sleep, my_ThreadAPI_Sleep);
+
+    memset(resume, 0, sizeof(BLOB_UPLOAD_RESUME));
+    resume->retryDelayMs = 10;
+    resume->onBlockStored = on_block_stored;
+
+    fakeContext->fakeData = NULL;
+    fakeContext->blockSize = 10;
+    fakeContext->blocksCount = blocksCount;
+    fakeContext->blockSent = 0;
+    fakeContext->abortOnBlockNumber = -1;
+}
+
 BEGIN_TEST_SUITE(blob_ut)
 
 TEST_SUITE_INITIALIZE(TestSuiteInitialize)
@@ -248,6 +398,7 @@ TEST_SUITE_INITIALIZE(TestSuiteInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Create, my_HTTPAPIEX_Create);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_Create, NULL);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_ExecuteRequest, HTTPAPIEX_ERROR);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPIEX_ExecuteRequestWithContent, HTTPAPIEX_ERROR);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_Destroy, my_HTTPAPIEX_Destroy);
 
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_create, my_BUFFER_create);
@@ -275,6 +426,8 @@ TEST_SUITE_INITIALIZE(TestSuiteInitialize)
 
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(COND_HANDLE, void*);
 
     REGISTER_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE);
     REGISTER_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT);
@@ -300,13 +453,20 @@ TEST_FUNCTION_INITIALIZE(Setup)
     umock_c_reset_all_calls();
 }
 
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_ExecuteRequest, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_ExecuteRequestWithContent, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Sleep, NULL);
+}
+
 /*Tests_SRS_BLOB_02_001: [ If SASURI is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
 TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_NULL_SasUri_fails)
 {
     ///arrange
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(NULL, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(NULL, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -321,7 +481,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_NULL_getDataCallBack_and_
     ///arrange
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, NULL, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -330,6 +490,32 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_NULL_getDataCallBack_and_
 
 }
 
+/*Tests_SRS_BLOB_99_033: [ If `sliceSize` is 0 or bigger than 4MB, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_0_sliceSize_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, 0);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_033: [ If `sliceSize` is 0 or bigger than 4MB, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_sliceSize_over_4MB_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, BLOCK_SIZE + 1);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
 /*Tests_SRS_BLOB_02_032: [ Otherwise, `Blob_UploadMultipleBlocksFromSasUri` shall succeed and return `BLOB_OK`. ]*/
 TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_succeeds_when_HTTP_status_code_is_404)
 {
@@ -349,10 +535,6 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_succeeds_when_HTTP_status_code
     /*uploading blocks (Put Block)*/
     for (size_t blockNumber = 0;blockNumber < (size - 1) / (4 * 1024 * 1024) + 1;blockNumber++)
     {
-        STRICT_EXPECTED_CALL(BUFFER_create(&c + blockNumber * 4 * 1024 * 1024,
-            (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-        )); /*this is the content to be uploaded by this call*/
-
         /*here some sprintf happens and that produces a string in the form: 000000...049999*/
         STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/
             .IgnoreArgument_source();
@@ -376,20 +558,16 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_succeeds_when_HTTP_status_code
             .IgnoreArgument_handle();
 
         int responseCode = 404; /*not found*/
-        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequestWithContent(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, &c + blockNumber * 4 * 1024 * 1024, (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1, &httpResponse, NULL, testValidBufferHandle))
             .IgnoreArgument_handle()
             .IgnoreArgument_relativePath()
-            .IgnoreArgument_requestContent()
             .CopyOutArgumentBuffer_statusCode(&responseCode, sizeof(responseCode));
 
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/
             .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/
-            .IgnoreArgument_handle();
     }
-
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
@@ -398,7 +576,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_succeeds_when_HTTP_status_code
         .IgnoreArgument_ptr();
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
@@ -407,7 +585,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_succeeds_when_HTTP_status_code
     ///cleanup
 }
 
-/*Tests_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequest fails, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+/*Tests_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequestWithContent fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
 TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_HTTPAPIEX_ExecuteRequest_fails)
 {
     ///arrange
@@ -426,10 +604,6 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_HTTPAPIEX_ExecuteRe
     /*uploading blocks (Put Block)*/
     for (size_t blockNumber = 0;blockNumber < (size - 1) / (4 * 1024 * 1024) + 1;blockNumber++)
     {
-        STRICT_EXPECTED_CALL(BUFFER_create(&c + blockNumber * 4 * 1024 * 1024,
-            (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-        )); /*this is the content to be uploaded by this call*/
-
         /*here some sprintf happens and that produces a string in the form: 000000...049999*/
         STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/
             .IgnoreArgument_source();
@@ -453,10 +627,9 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_HTTPAPIEX_ExecuteRe
             .IgnoreArgument_handle();
 
         int responseCode = 200; /*ok*/
-        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequestWithContent(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, &c + blockNumber * 4 * 1024 * 1024, (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1, &httpResponse, NULL, testValidBufferHandle))
             .IgnoreArgument_handle()
             .IgnoreArgument_relativePath()
-            .IgnoreArgument_requestContent()
             .CopyOutArgumentBuffer_statusCode(&responseCode, sizeof(responseCode))
             .SetReturn(HTTPAPIEX_ERROR);
 
@@ -464,10 +637,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_HTTPAPIEX_ExecuteRe
             .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/
-            .IgnoreArgument_handle();
     }
-
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
@@ -476,7 +646,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_HTTPAPIEX_ExecuteRe
         .IgnoreArgument_ptr();
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_HTTP_ERROR, result);
@@ -487,13 +657,11 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_HTTPAPIEX_ExecuteRe
 
 
 /*Tests_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_ERROR` ]  */
-TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_BUFFER_create_fails)
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_slice_malloc_fails)
 {
     ///arrange
-    unsigned char c = '3';
-    context.size = 1;
-    context.source = &c;
-    context.toUpload = context.size;
+    unsigned int blocksCount = 1;
+    slicesFilled = 0;
 
     STRICT_EXPECTED_CALL(gballoc_malloc(strlen(TEST_HOSTNAME_1) + 1));
     {
@@ -501,7 +669,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_BUFFER_create_fails
         {
             STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
 
-            STRICT_EXPECTED_CALL(BUFFER_create(&c, 1))
+            STRICT_EXPECTED_CALL(gballoc_malloc(FILE_UPLOAD_SLICE_SIZE))
                 .SetReturn(NULL);
 
             STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
@@ -515,11 +683,12 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_BUFFER_create_fails
     }
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, NULL, FileUpload_FillSlice_Callback, &blocksCount, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ERROR, result);
+    ASSERT_ARE_EQUAL(int, 0, slicesFilled);
 
     ///cleanup
 }
@@ -543,7 +712,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_HTTPAPIEX_Create_fa
     }
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ERROR, result);
@@ -566,7 +735,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_fails_when_malloc_fails)
         ;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ERROR, result);
@@ -585,7 +754,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_SasUri_is_wrong_fails_1)
     context.toUpload = context.size;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https:/h.h/doms", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL); /*wrong format for protocol, notice it is actually http:\h.h\doms (missing a \ from http)*/
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https:/h.h/doms", FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE); /*wrong format for protocol, notice it is actually http:\h.h\doms (missing a \ from http)*/
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -604,7 +773,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_SasUri_is_wrong_fails_2)
     context.toUpload = context.size;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL); /*there's no relative path here*/
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h", FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE); /*there's no relative path here*/
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -659,13 +828,9 @@ static void Blob_UploadMultipleBlocksFromSasUri_various_sizes_happy_path_Impl(HT
         }
         STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
 
-        /*uploading blocks (Put Block)*/
+            /*uploading blocks (Put Block)*/
         for (size_t blockNumber = 0;blockNumber < (sizes[iSize] - 1) / (4 * 1024 * 1024) + 1;blockNumber++)
         {
-            STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
-                (blockNumber != (sizes[iSize] - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (sizes[iSize] - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-            )); /*this is the content to be uploaded by this call*/
-
             /*here some sprintf happens and that produces a string in the form: 000000...049999*/
             STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/
                 .IgnoreArgument_source();
@@ -688,19 +853,15 @@ static void Blob_UploadMultipleBlocksFromSasUri_various_sizes_happy_path_Impl(HT
             STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */
                 .IgnoreArgument_handle();
 
-            STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+            STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequestWithContent(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, content + blockNumber * 4 * 1024 * 1024, (blockNumber != (sizes[iSize] - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (sizes[iSize] - 1) % (4 * 1024 * 1024) + 1, &httpResponse, NULL, testValidBufferHandle))
                 .IgnoreArgument_handle()
-                .IgnoreArgument_relativePath()
-                .IgnoreArgument_requestContent();
+                .IgnoreArgument_relativePath();
 
             STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/
                 .IgnoreArgument_handle();
             STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
                 .IgnoreArgument_handle();
-            STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/
-                .IgnoreArgument_handle();
         }
-
         /*this part is Put Block list*/
         STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/
             .IgnoreArgument_handle();
@@ -746,7 +907,7 @@ static void Blob_UploadMultipleBlocksFromSasUri_various_sizes_happy_path_Impl(HT
             .IgnoreArgument_ptr();
 
         ///act
-        BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, proxyOptions);
+        BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, proxyOptions, FILE_UPLOAD_SLICE_SIZE);
 
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -782,9 +943,9 @@ TEST_FUNCTION(Blob_UploadFromSasUri_with_proxy_happy_path)
 /*Tests_SRS_BLOB_99_002: [ If the size of the block returned by `getDataCallback` is 0 or if the data is NULL, then `Blob_UploadMultipleBlocksFromSasUri` shall exit the loop. ]*/
 /*Tests_SRS_BLOB_02_020: [ Blob_UploadMultipleBlocksFromSasUri shall construct a BASE64 encoded string from the block ID (000000... 049999) ]*/
 /*Tests_SRS_BLOB_02_022: [ Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId" ]*/
-/*Tests_SRS_BLOB_02_023: [ Blob_UploadMultipleBlocksFromSasUri shall create a BUFFER_HANDLE from source and size parameters. ]*/
-/*Tests_SRS_BLOB_02_024: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing httpStatus and httpResponse. ]*/
-/*Tests_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+/*Tests_SRS_BLOB_99_032: [ Each block shall be sent by `HTTPAPIEX_ExecuteRequestWithContent` straight from the memory `getDataCallbackEx` returned it in, without being copied. ]*/
+/*Tests_SRS_BLOB_02_024: [ Blob_UploadMultipleBlocksFromSasUri shall call HTTPAPIEX_ExecuteRequestWithContent with a PUT operation, passing httpStatus and httpResponse. ]*/
+/*Tests_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequestWithContent fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
 /*Tests_SRS_BLOB_02_027: [ Otherwise Blob_UploadMultipleBlocksFromSasUri shall continue execution. ]*/
 /*Tests_SRS_BLOB_02_028: [ Blob_UploadMultipleBlocksFromSasUri shall construct an XML string with the following content: ]*/
 /*Tests_SRS_BLOB_02_029: [ Blob_UploadMultipleBlocksFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=blocklist" ]*/
@@ -841,13 +1002,9 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_various_sizes_with_certificate
         STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(IGNORED_PTR_ARG, "TrustedCerts", IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
 
-                                                                                                             /*uploading blocks (Put Block)*/
+                                                                                                                 /*uploading blocks (Put Block)*/
         for (size_t blockNumber = 0;blockNumber < (sizes[iSize] - 1) / (4 * 1024 * 1024) + 1;blockNumber++)
         {
-            STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
-                (blockNumber != (sizes[iSize] - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (sizes[iSize] - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-            )); /*this is the content to be uploaded by this call*/
-
             /*here some sprintf happens and that produces a string in the form: 000000...049999*/
             STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/
                 .IgnoreArgument_source();
@@ -870,19 +1027,15 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_various_sizes_with_certificate
             STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */
                 .IgnoreArgument_handle();
 
-            STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+            STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequestWithContent(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, content + blockNumber * 4 * 1024 * 1024, (blockNumber != (sizes[iSize] - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (sizes[iSize] - 1) % (4 * 1024 * 1024) + 1, &httpResponse, NULL, testValidBufferHandle))
                 .IgnoreArgument_handle()
-                .IgnoreArgument_relativePath()
-                .IgnoreArgument_requestContent();
+                .IgnoreArgument_relativePath();
 
             STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/
                 .IgnoreArgument_handle();
             STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
                 .IgnoreArgument_handle();
-            STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/
-                .IgnoreArgument_handle();
         }
-
         /*this part is Put Block list*/
         STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/
             .IgnoreArgument_handle();
@@ -928,7 +1081,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_various_sizes_with_certificate
             .IgnoreArgument_ptr();
 
         ///act
-        BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, "a", NULL);
+        BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, "a", NULL, FILE_UPLOAD_SLICE_SIZE);
 
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -946,79 +1099,63 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_unhappy_paths)
 
     size_t calls_that_cannot_fail[] =
     {
-        13   ,/*STRING_delete*/
-        26   ,/*STRING_delete*/
-        39   ,/*STRING_delete*/
-        52   ,/*STRING_delete*/
-        65   ,/*STRING_delete*/
+        12   ,/*STRING_delete*/
+        23   ,/*STRING_delete*/
+        34   ,/*STRING_delete*/
+        45   ,/*STRING_delete*/
+        56   ,/*STRING_delete*/
+        67   ,/*STRING_delete*/
         78   ,/*STRING_delete*/
-        91   ,/*STRING_delete*/
-        104  ,/*STRING_delete*/
-        117  ,/*STRING_delete*/
-        130  ,/*STRING_delete*/
-        143  ,/*STRING_delete*/
-        156  ,/*STRING_delete*/
-        169  ,/*STRING_delete*/
-        182  ,/*STRING_delete*/
-        195  ,/*STRING_delete*/
-        208  ,/*STRING_delete*/
-        11   ,/*STRING_c_str*/
-        24   ,/*STRING_c_str*/
-        37   ,/*STRING_c_str*/
-        50   ,/*STRING_c_str*/
-        63   ,/*STRING_c_str*/
+        89   ,/*STRING_delete*/
+        100  ,/*STRING_delete*/
+        111  ,/*STRING_delete*/
+        122  ,/*STRING_delete*/
+        133  ,/*STRING_delete*/
+        144  ,/*STRING_delete*/
+        155  ,/*STRING_delete*/
+        166  ,/*STRING_delete*/
+        177  ,/*STRING_delete*/
+        10   ,/*STRING_c_str*/
+        21   ,/*STRING_c_str*/
+        32   ,/*STRING_c_str*/
+        43   ,/*STRING_c_str*/
+        54   ,/*STRING_c_str*/
+        65   ,/*STRING_c_str*/
         76   ,/*STRING_c_str*/
-        89   ,/*STRING_c_str*/
-        102  ,/*STRING_c_str*/
-        115  ,/*STRING_c_str*/
-        128  ,/*STRING_c_str*/
-        141  ,/*STRING_c_str*/
-        154  ,/*STRING_c_str*/
-        167  ,/*STRING_c_str*/
-        180  ,/*STRING_c_str*/
-        193  ,/*STRING_c_str*/
-        206  ,/*STRING_c_str*/
-        14   ,/*STRING_delete*/
-        27   ,/*STRING_delete*/
-        40   ,/*STRING_delete*/
-        53   ,/*STRING_delete*/
-        66   ,/*STRING_delete*/
+        87   ,/*STRING_c_str*/
+        98   ,/*STRING_c_str*/
+        109  ,/*STRING_c_str*/
+        120  ,/*STRING_c_str*/
+        131  ,/*STRING_c_str*/
+        142  ,/*STRING_c_str*/
+        153  ,/*STRING_c_str*/
+        164  ,/*STRING_c_str*/
+        175  ,/*STRING_c_str*/
+        13   ,/*STRING_delete*/
+        24   ,/*STRING_delete*/
+        35   ,/*STRING_delete*/
+        46   ,/*STRING_delete*/
+        57   ,/*STRING_delete*/
+        68   ,/*STRING_delete*/
         79   ,/*STRING_delete*/
-        92   ,/*STRING_delete*/
-        105  ,/*STRING_delete*/
-        118  ,/*STRING_delete*/
-        131  ,/*STRING_delete*/
-        144  ,/*STRING_delete*/
-        157  ,/*STRING_delete*/
-        170  ,/*STRING_delete*/
-        183  ,/*STRING_delete*/
-        196  ,/*STRING_delete*/
-        209  ,/*STRING_delete*/
-        15   ,/*BUFFER_delete*/
-        28   ,/*BUFFER_delete*/
-        41   ,/*BUFFER_delete*/
-        54   ,/*BUFFER_delete*/
-        67   ,/*BUFFER_delete*/
-        80   ,/*BUFFER_delete*/
-        93   ,/*BUFFER_delete*/
-        106  ,/*BUFFER_delete*/
-        119  ,/*BUFFER_delete*/
-        132  ,/*BUFFER_delete*/
-        145  ,/*BUFFER_delete*/
-        158  ,/*BUFFER_delete*/
-        171  ,/*BUFFER_delete*/
-        184  ,/*BUFFER_delete*/
-        197  ,/*BUFFER_delete*/
-        210  ,/*BUFFER_delete*/
-
-
-        214, /*STRING_c_str*/
-        216, /*STRING_c_str*/
-        218, /*BUFFER_delete*/
-        219, /*STRING_delete*/
-        220, /*STRING_delete*/
-        221, /*HTTPAPIEX_Destroy*/
-        222, /*gballoc_free*/
+        90   ,/*STRING_delete*/
+        101  ,/*STRING_delete*/
+        112  ,/*STRING_delete*/
+        123  ,/*STRING_delete*/
+        134  ,/*STRING_delete*/
+        145  ,/*STRING_delete*/
+        156  ,/*STRING_delete*/
+        167  ,/*STRING_delete*/
+        178  ,/*STRING_delete*/
+
+
+        182, /*STRING_c_str*/
+        184, /*STRING_c_str*/
+        186, /*BUFFER_delete*/
+        187, /*STRING_delete*/
+        188, /*STRING_delete*/
+        189, /*HTTPAPIEX_Destroy*/
+        190, /*gballoc_free*/
     };
 
     (void)umock_c_negative_tests_init();
@@ -1047,12 +1184,8 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_unhappy_paths)
     /*uploading blocks (Put Block)*/
     for (size_t blockNumber = 0;blockNumber < (size - 1) / (4 * 1024 * 1024) + 1;blockNumber++)
     {
-        STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
-            (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-        )); /*this is the content to be uploaded by this call*/
-
         /*here some sprintf happens and that produces a string in the form: 000000...049999*/
-        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/ /*3, 16, 29... (16 numbers)*/
+        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/ /*3, 14, 25... (16 numbers)*/
             .IgnoreArgument_source();
 
         STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "<Latest>")) /*this is building the XML*/
@@ -1070,26 +1203,22 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_unhappy_paths)
             .IgnoreArgument_s1()
             .IgnoreArgument_s2();
 
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */ /*11, 24, 27...*/
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */ /*10, 21, 32...*/
             .IgnoreArgument_handle();
 
-        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequestWithContent(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, content + blockNumber * 4 * 1024 * 1024, (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1, &httpResponse, NULL, testValidBufferHandle))
             .IgnoreArgument_handle()
             .IgnoreArgument_relativePath()
-            .IgnoreArgument_requestContent()
             .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred))
             ;
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/ /*13, 26, 39...*/
-            .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/ /*14, 27, 40...*/
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/ /*12, 23, 34...*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/ /*15, 28, 41...210 (16 numbers)*/
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/ /*13, 24, 35...*/
             .IgnoreArgument_handle();
     }
-
     /*this part is Put Block list*/
-    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/ /*211*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/ /*179*/
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relative path for the Put BLock list*/
 
@@ -1154,7 +1283,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_unhappy_paths)
             
             ///act
             context.toUpload = context.size; /* Reinit context */
-            BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+            BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
             ///assert
             ASSERT_ARE_NOT_EQUAL_WITH_MSG(BLOB_RESULT, BLOB_OK, result, temp_str);
@@ -1175,79 +1304,63 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_with_certificate_unhappy_
 
     size_t calls_that_cannot_fail[] =
     {
-        13  + 1 ,/*STRING_delete*/
-        26  + 1 ,/*STRING_delete*/
-        39  + 1 ,/*STRING_delete*/
-        52  + 1 ,/*STRING_delete*/
-        65  + 1 ,/*STRING_delete*/
+        12  + 1 ,/*STRING_delete*/
+        23  + 1 ,/*STRING_delete*/
+        34  + 1 ,/*STRING_delete*/
+        45  + 1 ,/*STRING_delete*/
+        56  + 1 ,/*STRING_delete*/
+        67  + 1 ,/*STRING_delete*/
         78  + 1 ,/*STRING_delete*/
-        91  + 1 ,/*STRING_delete*/
-        104 + 1 ,/*STRING_delete*/
-        117 + 1 ,/*STRING_delete*/
-        130 + 1 ,/*STRING_delete*/
-        143 + 1 ,/*STRING_delete*/
-        156 + 1 ,/*STRING_delete*/
-        169 + 1 ,/*STRING_delete*/
-        182 + 1 ,/*STRING_delete*/
-        195 + 1 ,/*STRING_delete*/
-        208 + 1 ,/*STRING_delete*/
-        11  + 1 ,/*STRING_c_str*/
-        24  + 1 ,/*STRING_c_str*/
-        37  + 1 ,/*STRING_c_str*/
-        50  + 1 ,/*STRING_c_str*/
-        63  + 1 ,/*STRING_c_str*/
+        89  + 1 ,/*STRING_delete*/
+        100 + 1 ,/*STRING_delete*/
+        111 + 1 ,/*STRING_delete*/
+        122 + 1 ,/*STRING_delete*/
+        133 + 1 ,/*STRING_delete*/
+        144 + 1 ,/*STRING_delete*/
+        155 + 1 ,/*STRING_delete*/
+        166 + 1 ,/*STRING_delete*/
+        177 + 1 ,/*STRING_delete*/
+        10  + 1 ,/*STRING_c_str*/
+        21  + 1 ,/*STRING_c_str*/
+        32  + 1 ,/*STRING_c_str*/
+        43  + 1 ,/*STRING_c_str*/
+        54  + 1 ,/*STRING_c_str*/
+        65  + 1 ,/*STRING_c_str*/
         76  + 1 ,/*STRING_c_str*/
-        89  + 1 ,/*STRING_c_str*/
-        102 + 1 ,/*STRING_c_str*/
-        115 + 1 ,/*STRING_c_str*/
-        128 + 1 ,/*STRING_c_str*/
-        141 + 1 ,/*STRING_c_str*/
-        154 + 1 ,/*STRING_c_str*/
-        167 + 1 ,/*STRING_c_str*/
-        180 + 1 ,/*STRING_c_str*/
-        193 + 1 ,/*STRING_c_str*/
-        206 + 1 ,/*STRING_c_str*/
-        14  + 1 ,/*STRING_delete*/
-        27  + 1 ,/*STRING_delete*/
-        40  + 1 ,/*STRING_delete*/
-        53  + 1 ,/*STRING_delete*/
-        66  + 1 ,/*STRING_delete*/
+        87  + 1 ,/*STRING_c_str*/
+        98  + 1 ,/*STRING_c_str*/
+        109 + 1 ,/*STRING_c_str*/
+        120 + 1 ,/*STRING_c_str*/
+        131 + 1 ,/*STRING_c_str*/
+        142 + 1 ,/*STRING_c_str*/
+        153 + 1 ,/*STRING_c_str*/
+        164 + 1 ,/*STRING_c_str*/
+        175 + 1 ,/*STRING_c_str*/
+        13  + 1 ,/*STRING_delete*/
+        24  + 1 ,/*STRING_delete*/
+        35  + 1 ,/*STRING_delete*/
+        46  + 1 ,/*STRING_delete*/
+        57  + 1 ,/*STRING_delete*/
+        68  + 1 ,/*STRING_delete*/
         79  + 1 ,/*STRING_delete*/
-        92  + 1 ,/*STRING_delete*/
-        105 + 1 ,/*STRING_delete*/
-        118 + 1 ,/*STRING_delete*/
-        131 + 1 ,/*STRING_delete*/
-        144 + 1 ,/*STRING_delete*/
-        157 + 1 ,/*STRING_delete*/
-        170 + 1 ,/*STRING_delete*/
-        183 + 1 ,/*STRING_delete*/
-        196 + 1 ,/*STRING_delete*/
-        209 + 1 ,/*STRING_delete*/
-        15  + 1 ,/*BUFFER_delete*/
-        28  + 1 ,/*BUFFER_delete*/
-        41  + 1 ,/*BUFFER_delete*/
-        54  + 1 ,/*BUFFER_delete*/
-        67  + 1 ,/*BUFFER_delete*/
-        80  + 1 ,/*BUFFER_delete*/
-        93  + 1 ,/*BUFFER_delete*/
-        106 + 1 ,/*BUFFER_delete*/
-        119 + 1 ,/*BUFFER_delete*/
-        132 + 1 ,/*BUFFER_delete*/
-        145 + 1 ,/*BUFFER_delete*/
-        158 + 1 ,/*BUFFER_delete*/
-        171 + 1 ,/*BUFFER_delete*/
-        184 + 1 ,/*BUFFER_delete*/
-        197 + 1 ,/*BUFFER_delete*/
-        210 + 1 ,/*BUFFER_delete*/
-
-
-        214+1, /*STRING_c_str*/
-        216+1, /*STRING_c_str*/
-        218+1, /*BUFFER_delete*/
-        219+1, /*STRING_delete*/
-        220+1, /*STRING_delete*/
-        221+1, /*HTTPAPIEX_Destroy*/
-        222+1, /*gballoc_free*/
+        90  + 1 ,/*STRING_delete*/
+        101 + 1 ,/*STRING_delete*/
+        112 + 1 ,/*STRING_delete*/
+        123 + 1 ,/*STRING_delete*/
+        134 + 1 ,/*STRING_delete*/
+        145 + 1 ,/*STRING_delete*/
+        156 + 1 ,/*STRING_delete*/
+        167 + 1 ,/*STRING_delete*/
+        178 + 1 ,/*STRING_delete*/
+
+
+        182+1, /*STRING_c_str*/
+        184+1, /*STRING_c_str*/
+        186+1, /*BUFFER_delete*/
+        187+1, /*STRING_delete*/
+        188+1, /*STRING_delete*/
+        189+1, /*HTTPAPIEX_Destroy*/
+        190+1, /*gballoc_free*/
     };
 
     (void)umock_c_negative_tests_init();
@@ -1277,12 +1390,8 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_with_certificate_unhappy_
                                                                                                          /*uploading blocks (Put Block)*/
     for (size_t blockNumber = 0;blockNumber < (size - 1) / (4 * 1024 * 1024) + 1;blockNumber++)
     {
-        STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
-            (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-        )); /*this is the content to be uploaded by this call*/
-
         /*here some sprintf happens and that produces a string in the form: 000000...049999*/
-        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/ /*3, 16, 29... (16 numbers)*/
+        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/ /*5, 16, 27... (16 numbers)*/
             .IgnoreArgument_source(); /* 5 */
 
         STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "<Latest>")) /*this is building the XML*/
@@ -1300,26 +1409,22 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_with_certificate_unhappy_
             .IgnoreArgument_s1()
             .IgnoreArgument_s2();
 
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */ /*12, 25, 38...*/
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */ /*12, 23, 34...*/
             .IgnoreArgument_handle();
 
-        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequestWithContent(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, content + blockNumber * 4 * 1024 * 1024, (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1, &httpResponse, NULL, testValidBufferHandle))
             .IgnoreArgument_handle()
             .IgnoreArgument_relativePath()
-            .IgnoreArgument_requestContent()
             .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred))
             ; /* 13 */
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/ /*14, 27, 40...*/
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/ /*13, 24, 35...*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/ /*15, 28, 41... */
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/ /*15, 26, 37... */
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/ /*16, 29, 42...211 (16 numbers)*/
-                    .IgnoreArgument_handle();
     }
-
     /*this part is Put Block list*/
-    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/ /*212*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/ /*180*/
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relative path for the Put BLock list*/
 
@@ -1359,7 +1464,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_with_certificate_unhappy_
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/ /* 223 */
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/ /* 191 */
         .IgnoreArgument_ptr();
 
     umock_c_negative_tests_snapshot();
@@ -1384,7 +1489,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_64MB_with_certificate_unhappy_
 
             ///act
             context.toUpload = context.size; /* Reinit context */
-            BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, "a", NULL);
+            BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, "a", NULL, FILE_UPLOAD_SLICE_SIZE);
 
             ///assert
             ASSERT_ARE_NOT_EQUAL_WITH_MSG(BLOB_RESULT, BLOB_OK, result, temp_str);
@@ -1425,10 +1530,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
     /*uploading blocks (Put Block)*/ /*this simply fails first block*/
     size_t blockNumber = 0;
     {
-        STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
-            (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-        )); /*this is the content to be uploaded by this call*/
-
         /*here some sprintf happens and that produces a string in the form: 000000...049999*/
         STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/
             .IgnoreArgument_source();
@@ -1451,10 +1552,9 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
         STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */
             .IgnoreArgument_handle();
 
-        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequestWithContent(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, content + blockNumber * 4 * 1024 * 1024, (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1, &httpResponse, NULL, testValidBufferHandle))
             .IgnoreArgument_handle()
             .IgnoreArgument_relativePath()
-            .IgnoreArgument_requestContent()
             .CopyOutArgumentBuffer_statusCode(&FourHundredFour, sizeof(FourHundredFour))
             ;
 
@@ -1462,10 +1562,7 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
             .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/
-        .IgnoreArgument_handle();
     }
-
     /*this part is Put Block list*/ /*notice: no op because it failed before with 404*/
 
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
@@ -1476,7 +1573,7 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
         .IgnoreArgument_ptr();
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, &context, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
@@ -1499,7 +1596,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_blockSize_too_big_fails)
     fakeContext.abortOnBlockNumber = -1;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -1520,7 +1617,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_blockSize_is_4MB_succeeds
     fakeContext.abortOnBlockNumber = -1;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
@@ -1541,7 +1638,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_blockCount_is_maximum_suc
     fakeContext.abortOnBlockNumber = -1;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
@@ -1562,7 +1659,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_blockCount_is_one_over_ma
     fakeContext.abortOnBlockNumber = -1;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
@@ -1583,7 +1680,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_returns_BLOB_ABORTED_when_call
     fakeContext.abortOnBlockNumber = 0;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ABORTED, result);
@@ -1604,7 +1701,7 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_returns_BLOB_ABORTED_when_call
     fakeContext.abortOnBlockNumber = 5;
 
     ///act
-    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL);
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
 
     ///assert
     ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ABORTED, result);
@@ -1613,4 +1710,399 @@ TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_returns_BLOB_ABORTED_when_call
     gballoc_free(fakeContext.fakeData);
 }
 
+/*Tests_SRS_BLOB_99_030: [ When `fillSliceCallback` is used, `Blob_UploadMultipleBlocksFromSasUri` shall allocate one slice of `sliceSize` bytes for the whole upload. ]*/
+/*Tests_SRS_BLOB_99_031: [ `fillSliceCallback` shall be called with the slice and `*size` set to `sliceSize`; the block is the first `*size` bytes of the slice when it returns, and a `*size` bigger than `sliceSize` shall make the upload fail with `BLOB_INVALID_ARG`. ]*/
+/*Tests_SRS_BLOB_99_032: [ Each block shall be sent by `HTTPAPIEX_ExecuteRequestWithContent` straight from the memory `getDataCallbackEx` returned it in, without being copied. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_sends_blocks_written_in_place_to_the_slice)
+{
+    ///arrange
+    unsigned int blocksCount = 3;
+    slicesFilled = 0;
+    contentSentCount = 0;
+    memset((void*)contentSent, 0, sizeof(contentSent));
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_ExecuteRequestWithContent, my_HTTPAPIEX_ExecuteRequestWithContent_record);
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", NULL, FileUpload_FillSlice_Callback, &blocksCount, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 3, slicesFilled);
+    ASSERT_ARE_EQUAL(size_t, 3, contentSentCount);
+    for (unsigned int i = 0; i < blocksCount; i++)
+    {
+        ASSERT_ARE_EQUAL(size_t, FILE_UPLOAD_SLICE_SIZE, sliceSizesOffered[i]);
+        ASSERT_ARE_EQUAL(void_ptr, (void*)slicesOffered[0], (void*)slicesOffered[i]); /*the same slice every time*/
+        ASSERT_ARE_EQUAL(void_ptr, (void*)slicesOffered[i], (void*)contentSent[i]); /*sent from the slice, as filled for that block*/
+    }
+
+    ///cleanup
+}
+
+/*Tests_SRS_BLOB_99_030: [ When `fillSliceCallback` is used, `Blob_UploadMultipleBlocksFromSasUri` shall allocate one slice of `sliceSize` bytes for the whole upload. ]*/
+/*Tests_SRS_BLOB_99_031: [ `fillSliceCallback` shall be called with the slice and `*size` set to `sliceSize`; the block is the first `*size` bytes of the slice when it returns, and a `*size` bigger than `sliceSize` shall make the upload fail with `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_offers_a_4MB_slice_when_asked_for_one)
+{
+    ///arrange
+    unsigned int blocksCount = 3;
+    slicesFilled = 0;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", NULL, FileUpload_FillSlice_Callback, &blocksCount, &httpResponse, testValidBufferHandle, NULL, NULL, BLOCK_SIZE);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 3, slicesFilled);
+    for (unsigned int i = 0; i < blocksCount; i++)
+    {
+        ASSERT_ARE_EQUAL(size_t, BLOCK_SIZE, sliceSizesOffered[i]);
+    }
+
+    ///cleanup
+}
+
+/*Tests_SRS_BLOB_99_031: [ `fillSliceCallback` shall be called with the slice and `*size` set to `sliceSize`; the block is the first `*size` bytes of the slice when it returns, and a `*size` bigger than `sliceSize` shall make the upload fail with `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_the_slice_is_overfilled_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", NULL, FileUpload_Overfill_Callback, NULL, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+
+    ///cleanup
+}
+
+/*Tests_SRS_BLOB_99_034: [ If both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, then `Blob_UploadMultipleBlocksFromSasUri` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_both_callbacks_fails)
+{
+    ///arrange
+    unsigned int blocksCount = 1;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, FileUpload_FillSlice_Callback, &blocksCount, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_010: [ If `SASURI` or `httpStatus` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or `maxBlocksInFlight` is 0, then `Blob_UploadMultipleBlocksFromSasUriParallel` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriParallel_with_both_callbacks_fails)
+{
+    ///arrange
+    unsigned int blocksCount = 1;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriParallel(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, FileUpload_FillSlice_Callback, &blocksCount, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, 4, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_010: [ If `SASURI` or `httpStatus` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or `maxBlocksInFlight` is 0, then `Blob_UploadMultipleBlocksFromSasUriParallel` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriParallel_with_NULL_SasUri_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriParallel(NULL, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, 4, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_010: [ If `SASURI` or `httpStatus` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or `maxBlocksInFlight` is 0, then `Blob_UploadMultipleBlocksFromSasUriParallel` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriParallel_with_NULL_getDataCallBack_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriParallel(TEST_VALID_SASURI_1, NULL, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, 4, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_010: [ If `SASURI` or `httpStatus` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or `maxBlocksInFlight` is 0, then `Blob_UploadMultipleBlocksFromSasUriParallel` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriParallel_with_0_maxBlocksInFlight_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriParallel(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, 0, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_010: [ If `SASURI` or `httpStatus` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or `maxBlocksInFlight` is 0, then `Blob_UploadMultipleBlocksFromSasUriParallel` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriParallel_with_0_sliceSize_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriParallel(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, 0, 4, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriParallel_when_SasUri_is_wrong_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriParallel("https:/h.h/doms", FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, 4, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_02_007: [ If HTTPAPIEX_Create fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriParallel_fails_when_HTTPAPIEX_Create_fails)
+{
+    ///arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*this is creating a copy of the hostname */
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is freeing the copy of the hostname*/
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriParallel(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, 4, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriParallel_fails_when_Lock_Init_fails)
+{
+    ///arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*this is creating a copy of the hostname */
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*this is the table of upload workers*/
+    STRICT_EXPECTED_CALL(Lock_Init())
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is the table of upload workers*/
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is freeing the copy of the hostname*/
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriParallel(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, 4, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_020: [ If `SASURI`, `httpStatus` or `resume` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or exactly one of `resume->blocksStored` and `resume->bytesStored` is 0, then `Blob_UploadMultipleBlocksFromSasUriResumable` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriResumable_with_no_callback_fails)
+{
+    ///arrange
+    BLOB_UPLOAD_RESUME resume;
+    memset(&resume, 0, sizeof(resume));
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriResumable(TEST_VALID_SASURI_1, NULL, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_020: [ If `SASURI`, `httpStatus` or `resume` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or exactly one of `resume->blocksStored` and `resume->bytesStored` is 0, then `Blob_UploadMultipleBlocksFromSasUriResumable` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriResumable_with_NULL_resume_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriResumable(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_020: [ If `SASURI`, `httpStatus` or `resume` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or exactly one of `resume->blocksStored` and `resume->bytesStored` is 0, then `Blob_UploadMultipleBlocksFromSasUriResumable` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriResumable_with_blocks_but_no_bytes_stored_fails)
+{
+    ///arrange
+    BLOB_UPLOAD_RESUME resume;
+    memset(&resume, 0, sizeof(resume));
+    resume.blocksStored = 2;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriResumable(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_020: [ If `SASURI`, `httpStatus` or `resume` is NULL, both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `sliceSize` is 0 or bigger than 4MB, or exactly one of `resume->blocksStored` and `resume->bytesStored` is 0, then `Blob_UploadMultipleBlocksFromSasUriResumable` shall fail and return `BLOB_INVALID_ARG`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriResumable_with_sliceSize_over_4MB_fails)
+{
+    ///arrange
+    BLOB_UPLOAD_RESUME resume;
+    memset(&resume, 0, sizeof(resume));
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriResumable(TEST_VALID_SASURI_1, FileUpload_GetData_Callback, NULL, &context, &httpResponse, testValidBufferHandle, NULL, NULL, BLOCK_SIZE + 1, &resume);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_99_024: [ A request that fails with a transport error, 408, 429 or 5xx shall be sent again up to `resume->blockRetries` times, waiting `resume->retryDelayMs` before the first retry and twice as long before each one after it. ]*/
+/*Tests_SRS_BLOB_99_025: [ After each block is stored, `resume->blocksStored` and `resume->bytesStored` shall be updated and `resume->onBlockStored`, if not NULL, shall be called with them. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriResumable_retries_a_block_after_a_transport_error)
+{
+    ///arrange
+    static const HTTPAPIEX_RESULT results[] = { HTTPAPIEX_ERROR, HTTPAPIEX_OK, HTTPAPIEX_OK };
+    static const unsigned int statuses[] = { 0, 201, 201 };
+    BLOB_UPLOAD_RESUME resume;
+    BLOB_UPLOAD_CONTEXT_FAKE fakeContext;
+    setup_resumable_upload(results, statuses, &resume, &fakeContext, 1);
+    resume.blockRetries = 2;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriResumable("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 201, httpResponse);
+    ASSERT_ARE_EQUAL(size_t, 3, scriptedCalls);
+    ASSERT_ARE_EQUAL(size_t, 1, sleepCount);
+    ASSERT_ARE_EQUAL(int, 10, sleeps[0]);
+    ASSERT_ARE_EQUAL(int, 1, resume.blocksStored);
+    ASSERT_ARE_EQUAL(size_t, 10, resume.bytesStored);
+    ASSERT_ARE_EQUAL(int, 1, blockStoredCalls);
+    ASSERT_ARE_EQUAL(int, 0, resume.isResumable);
+
+    ///cleanup
+    gballoc_free(fakeContext.fakeData);
+}
+
+/*Tests_SRS_BLOB_99_024: [ A request that fails with a transport error, 408, 429 or 5xx shall be sent again up to `resume->blockRetries` times, waiting `resume->retryDelayMs` before the first retry and twice as long before each one after it. ]*/
+/*Tests_SRS_BLOB_99_026: [ If a block still fails after its retries, `Blob_UploadMultipleBlocksFromSasUriResumable` shall stop and set `resume->isResumable` when the last failure was transient. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriResumable_backs_off_and_stops_resumable_when_retries_run_out)
+{
+    ///arrange
+    static const HTTPAPIEX_RESULT results[] = { HTTPAPIEX_OK, HTTPAPIEX_OK, HTTPAPIEX_OK, HTTPAPIEX_OK, HTTPAPIEX_OK };
+    static const unsigned int statuses[] = { 201, 503, 503, 503, 201 };
+    BLOB_UPLOAD_RESUME resume;
+    BLOB_UPLOAD_CONTEXT_FAKE fakeContext;
+    setup_resumable_upload(results, statuses, &resume, &fakeContext, 3);
+    resume.blockRetries = 2;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriResumable("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 503, httpResponse);
+    ASSERT_ARE_EQUAL(size_t, 4, scriptedCalls);
+    ASSERT_ARE_EQUAL(size_t, 2, sleepCount);
+    ASSERT_ARE_EQUAL(int, 10, sleeps[0]);
+    ASSERT_ARE_EQUAL(int, 20, sleeps[1]);
+    ASSERT_ARE_EQUAL(int, 1, resume.blocksStored);
+    ASSERT_ARE_EQUAL(size_t, 10, resume.bytesStored);
+    ASSERT_ARE_EQUAL(int, 1, resume.isResumable);
+
+    ///cleanup
+    gballoc_free(fakeContext.fakeData);
+}
+
+/*Tests_SRS_BLOB_99_026: [ If a block still fails after its retries, `Blob_UploadMultipleBlocksFromSasUriResumable` shall stop and set `resume->isResumable` when the last failure was transient. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriResumable_does_not_retry_403)
+{
+    ///arrange
+    static const HTTPAPIEX_RESULT results[] = { HTTPAPIEX_OK };
+    static const unsigned int statuses[] = { 403 };
+    BLOB_UPLOAD_RESUME resume;
+    BLOB_UPLOAD_CONTEXT_FAKE fakeContext;
+    setup_resumable_upload(results, statuses, &resume, &fakeContext, 3);
+    resume.blockRetries = 2;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriResumable("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 403, httpResponse);
+    ASSERT_ARE_EQUAL(size_t, 1, scriptedCalls);
+    ASSERT_ARE_EQUAL(size_t, 0, sleepCount);
+    ASSERT_ARE_EQUAL(int, 0, resume.blocksStored);
+    ASSERT_ARE_EQUAL(int, 0, resume.isResumable);
+
+    ///cleanup
+    gballoc_free(fakeContext.fakeData);
+}
+
+/*Tests_SRS_BLOB_99_022: [ The first `resume->blocksStored` blocks shall be added to the block list without being sent again. ]*/
+/*Tests_SRS_BLOB_99_027: [ Put Block List shall be retried like a block, and shall set `resume->isResumable` if it still fails for a transient reason. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriResumable_skips_the_blocks_already_stored)
+{
+    ///arrange
+    static const HTTPAPIEX_RESULT results[] = { HTTPAPIEX_OK, HTTPAPIEX_OK, HTTPAPIEX_OK };
+    static const unsigned int statuses[] = { 201, 500, 201 };
+    BLOB_UPLOAD_RESUME resume;
+    BLOB_UPLOAD_CONTEXT_FAKE fakeContext;
+    setup_resumable_upload(results, statuses, &resume, &fakeContext, 3);
+    resume.blockRetries = 1;
+    resume.blocksStored = 2;
+    resume.bytesStored = 20;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriResumable("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 201, httpResponse);
+    ASSERT_ARE_EQUAL(size_t, 3, scriptedCalls); /*the third block, then Put Block List twice*/
+    ASSERT_ARE_EQUAL(int, 3, resume.blocksStored);
+    ASSERT_ARE_EQUAL(size_t, 30, resume.bytesStored);
+    ASSERT_ARE_EQUAL(int, 1, blockStoredCalls);
+    ASSERT_ARE_EQUAL(int, 0, resume.isResumable);
+
+    ///cleanup
+    gballoc_free(fakeContext.fakeData);
+}
+
+/*Tests_SRS_BLOB_99_023: [ If the blocks returned by `getDataCallbackEx` do not match the `resume->blocksStored` blocks and `resume->bytesStored` bytes already stored, `Blob_UploadMultipleBlocksFromSasUriResumable` shall fail and return `BLOB_ERROR`. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUriResumable_fails_when_the_source_does_not_match_the_blocks_stored)
+{
+    ///arrange
+    static const HTTPAPIEX_RESULT results[] = { HTTPAPIEX_OK };
+    static const unsigned int statuses[] = { 201 };
+    BLOB_UPLOAD_RESUME resume;
+    BLOB_UPLOAD_CONTEXT_FAKE fakeContext;
+    setup_resumable_upload(results, statuses, &resume, &fakeContext, 3);
+    resume.blocksStored = 2;
+    resume.bytesStored = 25;
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUriResumable("https://h.h/something?a=b", FileUpload_GetFakeData_Callback, NULL, &fakeContext, &httpResponse, testValidBufferHandle, NULL, NULL, FILE_UPLOAD_SLICE_SIZE, &resume);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 0, scriptedCalls);
+    ASSERT_ARE_EQUAL(int, 0, resume.isResumable);
+
+    ///cleanup
+    gballoc_free(fakeContext.fakeData);
+}
+
 END_TEST_SUITE(blob_ut);
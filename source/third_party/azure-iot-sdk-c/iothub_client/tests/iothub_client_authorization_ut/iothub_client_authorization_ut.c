@@ -46,6 +46,7 @@ static const char* SCOPE_NAME = "Scope_name";
 static const char* TEST_SAS_TOKEN = "sas_token";
 static const char* TEST_STRING_VALUE = "Test_string_value";
 static size_t TEST_EXPIRY_TIME = 1;
+#define TEST_SAS_TOKEN_SIZE ((size_t)64)
 
 #define TEST_TIME_VALUE                     (time_t)123456
 
@@ -75,6 +76,27 @@ static STRING_HANDLE my_SASToken_CreateString(const char* key, const char* scope
     return (STRING_HANDLE)my_gballoc_malloc(1);
 }
 
+static SAS_SIGNER_HANDLE my_SASToken_CreateSigner(const char* key)
+{
+    (void)key;
+    return (SAS_SIGNER_HANDLE)my_gballoc_malloc(1);
+}
+
+static void my_SASToken_DestroySigner(SAS_SIGNER_HANDLE signer)
+{
+    my_gballoc_free(signer);
+}
+
+static int my_SASToken_SignInto(SAS_SIGNER_HANDLE signer, const char* scope, const char* keyName, size_t expiry, char* destination, size_t destinationSize)
+{
+    (void)signer;
+    (void)scope;
+    (void)keyName;
+    (void)expiry;
+    (void)snprintf(destination, destinationSize, "%s", TEST_STRING_VALUE);
+    return 0;
+}
+
 
 static STRING_HANDLE my_STRING_construct(const char* psz)
 {
@@ -115,6 +137,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_AUTHORIZATION_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(time_t, long long);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SAS_SIGNER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(XDA_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_SECURITY_HANDLE, void*);
 
@@ -127,6 +150,12 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_GLOBAL_MOCK_HOOK(SASToken_CreateString, my_SASToken_CreateString);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(SASToken_CreateString, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(SASToken_CreateSigner, my_SASToken_CreateSigner);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SASToken_CreateSigner, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(SASToken_DestroySigner, my_SASToken_DestroySigner);
+    REGISTER_GLOBAL_MOCK_RETURN(SASToken_GetMaxTokenSize, TEST_SAS_TOKEN_SIZE);
+    REGISTER_GLOBAL_MOCK_HOOK(SASToken_SignInto, my_SASToken_SignInto);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(SASToken_SignInto, __LINE__);
 
     REGISTER_GLOBAL_MOCK_RETURN(get_time, TEST_TIME_VALUE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(get_time, ((time_t)(-1)));
@@ -169,14 +198,17 @@ static void setup_IoTHubClient_Auth_Create_mocks(bool device_key)
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, DEVICE_ID));
 }
 
-static void setup_IoTHubClient_Auth_Get_ConnString_mocks()
+static void setup_IoTHubClient_Auth_Get_ConnString_mocks(bool create_signer)
 {
     STRICT_EXPECTED_CALL(get_time(NULL));
     STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(SASToken_CreateString(IGNORED_PTR_ARG, SCOPE_NAME, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    if (create_signer)
+    {
+        STRICT_EXPECTED_CALL(SASToken_CreateSigner(DEVICE_KEY));
+    }
+    STRICT_EXPECTED_CALL(SASToken_GetMaxTokenSize(SCOPE_NAME, ""));
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_SAS_TOKEN_SIZE));
+    STRICT_EXPECTED_CALL(SASToken_SignInto(IGNORED_PTR_ARG, SCOPE_NAME, "", IGNORED_NUM_ARG, IGNORED_PTR_ARG, TEST_SAS_TOKEN_SIZE));
 }
 
 static int should_skip_index(size_t current_index, const size_t skip_array[], size_t length)
@@ -487,7 +519,7 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_scope_NULL_fail)
 }
 
 /* Codes_SRS_IoTHub_Authorization_07_010: [ IoTHubClient_Auth_Get_ConnString shall construct the expiration time using the expire_time. ] */
-/* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_ConnString shall call SASToken_CreateString to construct the sas token. ] */
+/* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_ConnString shall call SASToken_SignInto with the device key signer to construct the sas token. ] */
 /* Codes_SRS_IoTHub_Authorization_07_012: [ On success IoTHubClient_Auth_Get_ConnString shall allocate and return the sas token in a char*. ] */
 TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_succeed)
 {
@@ -495,13 +527,14 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_succeed)
     IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
     umock_c_reset_all_calls();
 
-    setup_IoTHubClient_Auth_Get_ConnString_mocks();
+    setup_IoTHubClient_Auth_Get_ConnString_mocks(true);
 
     //act
     char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
 
     //assert
     ASSERT_IS_NOT_NULL(conn_string);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_STRING_VALUE, conn_string);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     //cleanup
@@ -509,21 +542,69 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_succeed)
     IoTHubClient_Auth_Destroy(handle);
 }
 
-/* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
-TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_fail)
+/* Codes_SRS_IoTHub_Authorization_99_001: [ The first time a sas token is requested for the device key, IoTHubClient_Auth_Get_SasToken shall create a signer for the device key by calling SASToken_CreateSigner and keep it for later requests. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_reuses_the_signer_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    char* first_conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
+    umock_c_reset_all_calls();
+
+    setup_IoTHubClient_Auth_Get_ConnString_mocks(false);
+
+    //act
+    char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
+
+    //assert
+    ASSERT_IS_NOT_NULL(first_conn_string);
+    ASSERT_IS_NOT_NULL(conn_string);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(first_conn_string);
+    free(conn_string);
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Codes_SRS_IoTHub_Authorization_07_006: [ IoTHubClient_Auth_Destroy shall free all resources associated with the IOTHUB_AUTHORIZATION_HANDLE handle. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Destroy_with_signer_succeed)
 {
     //arrange
     IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
     umock_c_reset_all_calls();
 
+#ifdef USE_PROV_MODULE
+    STRICT_EXPECTED_CALL(iothub_device_auth_destroy(IGNORED_PTR_ARG));
+#endif
+    STRICT_EXPECTED_CALL(SASToken_DestroySigner(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_Auth_Destroy(handle);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    free(conn_string);
+}
+
+/* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_fail)
+{
+    //arrange
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
-    setup_IoTHubClient_Auth_Get_ConnString_mocks();
+    setup_IoTHubClient_Auth_Get_ConnString_mocks(true);
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 3, 5 };
+    size_t calls_cannot_fail[] = { 1, 3 };
 
     //act
     size_t count = umock_c_negative_tests_call_count();
@@ -534,6 +615,8 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_fail)
             continue;
         }
 
+        /* a fresh handle each time, so that the signer is always created */
+        IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
@@ -544,10 +627,12 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_fail)
         char* conn_string = IoTHubClient_Auth_Get_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
 
         //assert
-        ASSERT_IS_NULL(conn_string);
+        ASSERT_IS_NULL_WITH_MSG(conn_string, tmp_msg);
+
+        //cleanup
+        IoTHubClient_Auth_Destroy(handle);
     }
     //cleanup
-    IoTHubClient_Auth_Destroy(handle);
     umock_c_negative_tests_deinit();
 }
 
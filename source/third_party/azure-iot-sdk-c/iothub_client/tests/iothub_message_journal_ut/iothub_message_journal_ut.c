@@ -0,0 +1,825 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#endif
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umock_c_negative_tests.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/map.h"
+#include "iothub_message.h"
+
+#undef ENABLE_MOCKS
+
+#include "iothub_message_journal.h"
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+static IOTHUB_MESSAGE_HANDLE TEST_MESSAGE_HANDLE = (IOTHUB_MESSAGE_HANDLE)0x12;
+static IOTHUB_MESSAGE_HANDLE TEST_REPLAYED_MESSAGE_HANDLE = (IOTHUB_MESSAGE_HANDLE)0x13;
+static MAP_HANDLE TEST_MAP_HANDLE = (MAP_HANDLE)0x14;
+static CONCRETE_JOURNAL_STORAGE_HANDLE TEST_STORAGE_HANDLE = (CONCRETE_JOURNAL_STORAGE_HANDLE)0x15;
+
+#define TEST_SEGMENT_SIZE 512
+#define TEST_MAX_SEGMENTS 4
+
+/*the message the IoTHubMessage mocks describe*/
+static unsigned char g_body[TEST_SEGMENT_SIZE];
+static size_t g_body_size;
+static const char* g_message_id;
+static const char* g_property_keys[1] = { "temperature" };
+static const char* g_property_values[1] = { "21" };
+static size_t g_property_count;
+
+/*what the last message rebuilt from the journal was created from*/
+static unsigned char g_replayed_body[TEST_SEGMENT_SIZE];
+static size_t g_replayed_body_size;
+
+/*storage that keeps the segments in RAM*/
+static unsigned char g_segments[TEST_MAX_SEGMENTS][TEST_SEGMENT_SIZE];
+static size_t g_segment_length[TEST_MAX_SEGMENTS];
+static bool g_segment_exists[TEST_MAX_SEGMENTS];
+static size_t g_write_segment;
+static bool g_writing;
+static size_t g_start_segment_calls;
+static size_t g_append_calls;
+static size_t g_remove_segment_calls;
+static bool g_fail_append;
+
+static CONCRETE_JOURNAL_STORAGE_HANDLE test_storage_create(const void* parameters)
+{
+    (void)parameters;
+    return TEST_STORAGE_HANDLE;
+}
+
+static void test_storage_destroy(CONCRETE_JOURNAL_STORAGE_HANDLE storage)
+{
+    (void)storage;
+    g_writing = false;
+}
+
+static int test_storage_start_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t max_size)
+{
+    (void)storage;
+    ASSERT_IS_FALSE(g_writing);
+    ASSERT_ARE_EQUAL(size_t, TEST_SEGMENT_SIZE, max_size);
+    g_segment_exists[segment] = true;
+    g_segment_length[segment] = 0;
+    g_write_segment = segment;
+    g_writing = true;
+    g_start_segment_calls++;
+    return 0;
+}
+
+static int test_storage_append(CONCRETE_JOURNAL_STORAGE_HANDLE storage, const unsigned char* bytes, size_t size)
+{
+    int result;
+    (void)storage;
+    ASSERT_IS_TRUE(g_writing);
+    g_append_calls++;
+    if (g_fail_append)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        ASSERT_IS_TRUE(g_segment_length[g_write_segment] + size <= TEST_SEGMENT_SIZE);
+        (void)memcpy(g_segments[g_write_segment] + g_segment_length[g_write_segment], bytes, size);
+        g_segment_length[g_write_segment] += size;
+        result = 0;
+    }
+    return result;
+}
+
+static int test_storage_seal_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage)
+{
+    (void)storage;
+    ASSERT_IS_TRUE(g_writing);
+    g_writing = false;
+    return 0;
+}
+
+static int test_storage_read(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment, size_t offset, unsigned char* buffer, size_t size, size_t* bytes_read)
+{
+    (void)storage;
+    ASSERT_IS_NOT_NULL(buffer);
+    ASSERT_IS_FALSE(g_writing && (segment == g_write_segment));
+    *bytes_read = 0;
+    if (g_segment_exists[segment] && (offset < g_segment_length[segment]))
+    {
+        *bytes_read = (g_segment_length[segment] - offset < size) ? g_segment_length[segment] - offset : size;
+        (void)memcpy(buffer, g_segments[segment] + offset, *bytes_read);
+    }
+    return 0;
+}
+
+static int test_storage_remove_segment(CONCRETE_JOURNAL_STORAGE_HANDLE storage, size_t segment)
+{
+    (void)storage;
+    g_segment_exists[segment] = false;
+    g_segment_length[segment] = 0;
+    g_remove_segment_calls++;
+    return 0;
+}
+
+static const JOURNAL_STORAGE_INTERFACE_DESCRIPTION test_storage_interface =
+{
+    test_storage_create,
+    test_storage_destroy,
+    test_storage_start_segment,
+    test_storage_append,
+    test_storage_seal_segment,
+    test_storage_read,
+    test_storage_remove_segment
+};
+
+static IOTHUB_MESSAGE_JOURNAL_CONFIG g_config;
+
+static IOTHUB_MESSAGE_RESULT my_IoTHubMessage_GetByteArray(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const unsigned char** buffer, size_t* size)
+{
+    (void)iotHubMessageHandle;
+    *buffer = g_body;
+    *size = g_body_size;
+    return IOTHUB_MESSAGE_OK;
+}
+
+static const char* my_IoTHubMessage_GetMessageId(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    (void)iotHubMessageHandle;
+    return g_message_id;
+}
+
+static MAP_RESULT my_Map_GetInternals(MAP_HANDLE handle, const char*const** keys, const char*const** values, size_t* count)
+{
+    (void)handle;
+    *keys = g_property_keys;
+    *values = g_property_values;
+    *count = g_property_count;
+    return MAP_OK;
+}
+
+static IOTHUB_MESSAGE_HANDLE my_IoTHubMessage_CreateFromByteArray(const unsigned char* byteArray, size_t size)
+{
+    (void)memcpy(g_replayed_body, byteArray, size);
+    g_replayed_body_size = size;
+    return TEST_REPLAYED_MESSAGE_HANDLE;
+}
+
+static void set_body(size_t size, unsigned char fill)
+{
+    (void)memset(g_body, fill, size);
+    g_body_size = size;
+}
+
+static uint32_t append_message(IOTHUB_MESSAGE_JOURNAL_HANDLE journal)
+{
+    uint32_t sequence_number = 0;
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessageJournal_Append(journal, TEST_MESSAGE_HANDLE, &sequence_number));
+    return sequence_number;
+}
+
+static uint32_t read_next(IOTHUB_MESSAGE_JOURNAL_HANDLE journal)
+{
+    IOTHUB_MESSAGE_HANDLE message;
+    uint32_t sequence_number = 0;
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessageJournal_ReadNext(journal, &message, &sequence_number));
+    return (message == NULL) ? 0 : sequence_number;
+}
+
+static IOTHUB_MESSAGE_JOURNAL_STATISTICS get_statistics(IOTHUB_MESSAGE_JOURNAL_HANDLE journal)
+{
+    IOTHUB_MESSAGE_JOURNAL_STATISTICS statistics;
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessageJournal_GetStatistics(journal, &statistics));
+    return statistics;
+}
+
+BEGIN_TEST_SUITE(iothub_message_journal_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    (void)umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUBMESSAGE_CONTENT_TYPE, int);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetContentType, IOTHUBMESSAGE_BYTEARRAY);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetByteArray, my_IoTHubMessage_GetByteArray);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetMessageId, my_IoTHubMessage_GetMessageId);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetCorrelationId, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetContentTypeSystemProperty, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetContentEncodingSystemProperty, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_Properties, TEST_MAP_HANDLE);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_GetInternals, my_Map_GetInternals);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_CreateFromByteArray, my_IoTHubMessage_CreateFromByteArray);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_CreateFromByteArray, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_SetMessageId, IOTHUB_MESSAGE_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_SetMessageId, IOTHUB_MESSAGE_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(Map_AddOrUpdate, MAP_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_AddOrUpdate, MAP_ERROR);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("Could not acquire test serialization mutex.");
+    }
+
+    (void)memset(g_segments, 0, sizeof(g_segments));
+    (void)memset(g_segment_length, 0, sizeof(g_segment_length));
+    (void)memset(g_segment_exists, 0, sizeof(g_segment_exists));
+    g_writing = false;
+    g_start_segment_calls = 0;
+    g_append_calls = 0;
+    g_remove_segment_calls = 0;
+    g_fail_append = false;
+
+    set_body(16, 'a');
+    g_message_id = NULL;
+    g_property_count = 0;
+    g_replayed_body_size = 0;
+
+    g_config.storage_interface = &test_storage_interface;
+    g_config.storage_parameters = "journal";
+    g_config.segment_size = TEST_SEGMENT_SIZE;
+    g_config.max_segments = TEST_MAX_SEGMENTS;
+    g_config.replay_batch = 8;
+
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_001: [ If `config` or its `storage_interface` is NULL, `segment_size` is less than 256 or `max_segments` is less than 2, `IoTHubMessageJournal_Create` shall fail and return NULL. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Create_with_invalid_config_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_JOURNAL_CONFIG no_storage = g_config;
+    IOTHUB_MESSAGE_JOURNAL_CONFIG small_segments = g_config;
+    IOTHUB_MESSAGE_JOURNAL_CONFIG one_segment = g_config;
+    no_storage.storage_interface = NULL;
+    small_segments.segment_size = 255;
+    one_segment.max_segments = 1;
+
+    //act
+    //assert
+    ASSERT_IS_NULL(IoTHubMessageJournal_Create(NULL));
+    ASSERT_IS_NULL(IoTHubMessageJournal_Create(&no_storage));
+    ASSERT_IS_NULL(IoTHubMessageJournal_Create(&small_segments));
+    ASSERT_IS_NULL(IoTHubMessageJournal_Create(&one_segment));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_004: [ `IoTHubMessageJournal_Create` shall remove the oldest segments whose messages are all acknowledged and start a new segment for the appends; recovered segments are never written again. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Create_on_empty_storage_starts_a_segment)
+{
+    //arrange
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_MAX_SEGMENTS * 40)).IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(gballoc_malloc(TEST_SEGMENT_SIZE));
+
+    //act
+    journal = IoTHubMessageJournal_Create(&g_config);
+
+    //assert
+    ASSERT_IS_NOT_NULL(journal);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_start_segment_calls);
+    ASSERT_IS_TRUE(g_writing);
+    ASSERT_ARE_EQUAL(size_t, 1, get_statistics(journal).segments_in_use);
+    ASSERT_ARE_EQUAL(uint32_t, 1, IoTHubMessageJournal_GetFirstSequenceNumber(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_002: [ If any failure occurs, `IoTHubMessageJournal_Create` shall fail and return NULL. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Create_fails_when_allocations_fail)
+{
+    //arrange
+    size_t count;
+    size_t index;
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    umock_c_negative_tests_snapshot();
+
+    //act
+    count = umock_c_negative_tests_call_count();
+    for (index = 0; index < count; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        //assert
+        ASSERT_IS_NULL_WITH_MSG(IoTHubMessageJournal_Create(&g_config), "IoTHubMessageJournal_Create shall fail");
+    }
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_006: [ If `journal`, `message` or `sequence_number` is NULL, `IoTHubMessageJournal_Append` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Append_with_NULL_arguments_fails)
+{
+    //arrange
+    uint32_t sequence_number;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    umock_c_reset_all_calls();
+
+    //act
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, IoTHubMessageJournal_Append(NULL, TEST_MESSAGE_HANDLE, &sequence_number));
+    ASSERT_ARE_NOT_EQUAL(int, 0, IoTHubMessageJournal_Append(journal, NULL, &sequence_number));
+    ASSERT_ARE_NOT_EQUAL(int, 0, IoTHubMessageJournal_Append(journal, TEST_MESSAGE_HANDLE, NULL));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_009: [ `IoTHubMessageJournal_Append` shall serialize the body, message id, correlation id, content type, content encoding and properties of the message in a MESSAGE record, return its sequence number in `sequence_number` and return 0. ]*/
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_019: [ `IoTHubMessageJournal_Flush` shall write the records appended since the last flush to the storage in a single append. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Append_serializes_the_message_and_Flush_writes_it)
+{
+    //arrange
+    uint32_t sequence_number;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetMessageId(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetCorrelationId(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentTypeSystemProperty(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentEncodingSystemProperty(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Properties(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(Map_GetInternals(TEST_MAP_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    int result = IoTHubMessageJournal_Append(journal, TEST_MESSAGE_HANDLE, &sequence_number);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(uint32_t, 1, sequence_number);
+    ASSERT_ARE_EQUAL(uint32_t, 2, append_message(journal));
+    ASSERT_ARE_EQUAL(size_t, 0, g_append_calls);
+
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessageJournal_Flush(journal));
+    ASSERT_ARE_EQUAL(size_t, 1, g_append_calls);
+    ASSERT_ARE_EQUAL(size_t, get_statistics(journal).bytes_written, g_segment_length[0]);
+    ASSERT_ARE_EQUAL(size_t, 2, get_statistics(journal).messages_appended);
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_007: [ If the record of the message does not fit in a segment next to the segment's first ACK record, `IoTHubMessageJournal_Append` shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Append_fails_for_a_message_larger_than_a_segment)
+{
+    //arrange
+    uint32_t sequence_number;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    set_body(TEST_SEGMENT_SIZE - 40, 'x');
+
+    //act
+    int result = IoTHubMessageJournal_Append(journal, TEST_MESSAGE_HANDLE, &sequence_number);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 0, get_statistics(journal).messages_appended);
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_015: [ Otherwise `IoTHubMessageJournal_ReadNext` shall return in `*message` a new message rebuilt from the record, its sequence number in `sequence_number`, and return 0. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_ReadNext_rebuilds_the_appended_message)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE message;
+    uint32_t sequence_number;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    set_body(5, 'b');
+    g_message_id = "message-1";
+    g_property_count = 1;
+    (void)append_message(journal);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_CreateFromByteArray(IGNORED_PTR_ARG, 5));
+    STRICT_EXPECTED_CALL(IoTHubMessage_SetMessageId(TEST_REPLAYED_MESSAGE_HANDLE, "message-1"));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Properties(TEST_REPLAYED_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(Map_AddOrUpdate(TEST_MAP_HANDLE, "temperature", "21"));
+
+    //act
+    int result = IoTHubMessageJournal_ReadNext(journal, &message, &sequence_number);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, TEST_REPLAYED_MESSAGE_HANDLE, message);
+    ASSERT_ARE_EQUAL(uint32_t, 1, sequence_number);
+    ASSERT_ARE_EQUAL(int, 0, memcmp("bbbbb", g_replayed_body, 5));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_012: [ When it reaches the end of the segment being written, `IoTHubMessageJournal_ReadNext` shall set `*message` to NULL and return 0. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_ReadNext_returns_no_message_once_caught_up)
+{
+    //arrange
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    (void)append_message(journal);
+    (void)append_message(journal);
+
+    //act
+    //assert
+    ASSERT_ARE_EQUAL(uint32_t, 1, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 2, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 0, read_next(journal));
+    (void)append_message(journal);
+    ASSERT_ARE_EQUAL(uint32_t, 3, read_next(journal));
+    ASSERT_ARE_EQUAL(size_t, 3, get_statistics(journal).messages_replayed);
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_014: [ If the message cannot be rebuilt, `IoTHubMessageJournal_ReadNext` shall fail, return a non-zero value and read the same record on the next call. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_ReadNext_reads_the_same_record_again_after_a_failure)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE message;
+    uint32_t sequence_number;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    (void)append_message(journal);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_CreateFromByteArray(IGNORED_PTR_ARG, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    //act
+    int result = IoTHubMessageJournal_ReadNext(journal, &message, &sequence_number);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    umock_c_reset_all_calls();
+    ASSERT_ARE_EQUAL(uint32_t, 1, read_next(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_003: [ `IoTHubMessageJournal_Create` shall read back the segments found in the storage in the order they were written, keeping every record up to the first one whose CRC does not match. ]*/
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_005: [ `IoTHubMessageJournal_Destroy` shall flush the journal, seal the segment being written and free all resources. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Create_recovers_the_messages_not_acknowledged)
+{
+    //arrange
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    (void)append_message(journal);
+    (void)append_message(journal);
+    (void)append_message(journal);
+    IoTHubMessageJournal_Acknowledge(journal, 1);
+    IoTHubMessageJournal_Destroy(journal);
+    ASSERT_IS_FALSE(g_writing);
+
+    //act
+    journal = IoTHubMessageJournal_Create(&g_config);
+
+    //assert
+    ASSERT_IS_NOT_NULL(journal);
+    ASSERT_ARE_EQUAL(uint32_t, 2, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 3, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 0, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 4, append_message(journal));
+    ASSERT_ARE_EQUAL(size_t, 2, get_statistics(journal).segments_in_use);
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_003: [ `IoTHubMessageJournal_Create` shall read back the segments found in the storage in the order they were written, keeping every record up to the first one whose CRC does not match. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Create_discards_a_torn_record)
+{
+    //arrange
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    (void)append_message(journal);
+    (void)append_message(journal);
+    IoTHubMessageJournal_Destroy(journal);
+    g_segments[0][g_segment_length[0] - 1] ^= 0xFF;
+
+    //act
+    journal = IoTHubMessageJournal_Create(&g_config);
+
+    //assert
+    ASSERT_IS_NOT_NULL(journal);
+    ASSERT_ARE_EQUAL(size_t, 1, get_statistics(journal).records_discarded);
+    ASSERT_ARE_EQUAL(uint32_t, 1, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 0, read_next(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_004: [ `IoTHubMessageJournal_Create` shall remove the oldest segments whose messages are all acknowledged and start a new segment for the appends; recovered segments are never written again. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Create_removes_segments_already_delivered)
+{
+    //arrange
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    (void)append_message(journal);
+    IoTHubMessageJournal_Acknowledge(journal, 1);
+    IoTHubMessageJournal_Destroy(journal);
+
+    //act
+    journal = IoTHubMessageJournal_Create(&g_config);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_remove_segment_calls);
+    ASSERT_ARE_EQUAL(size_t, 1, get_statistics(journal).segments_in_use);
+    ASSERT_ARE_EQUAL(uint32_t, 0, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 2, append_message(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_008: [ When the record does not fit in the segment being written, `IoTHubMessageJournal_Append` shall seal that segment and start the next one, first dropping the oldest segment if `max_segments` are in use. ]*/
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_021: [ `IoTHubMessageJournal_GetFirstSequenceNumber` shall return the sequence number of the oldest message kept, or the next sequence number to be given out if there is none. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Append_evicts_the_oldest_segment_when_full)
+{
+    //arrange
+    size_t i;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    set_body(200, 'c'); /*two messages per segment*/
+    for (i = 0; i < 2 * TEST_MAX_SEGMENTS; i++)
+    {
+        (void)append_message(journal);
+    }
+    ASSERT_ARE_EQUAL(size_t, 0, get_statistics(journal).messages_evicted);
+
+    //act
+    (void)append_message(journal);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 2, get_statistics(journal).messages_evicted);
+    ASSERT_ARE_EQUAL(size_t, TEST_MAX_SEGMENTS, get_statistics(journal).segments_in_use);
+    ASSERT_ARE_EQUAL(uint32_t, 3, IoTHubMessageJournal_GetFirstSequenceNumber(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 3, read_next(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_022: [ `IoTHubMessageJournal_GetPendingCount` shall return how many of the messages kept are not acknowledged. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_GetPendingCount_counts_the_messages_not_acknowledged)
+{
+    //arrange
+    size_t i;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    ASSERT_ARE_EQUAL(size_t, 0, IoTHubMessageJournal_GetPendingCount(journal));
+    set_body(200, 'e');
+    for (i = 0; i < 5; i++)
+    {
+        (void)append_message(journal);
+    }
+
+    //act
+    IoTHubMessageJournal_Acknowledge(journal, 2);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 3, IoTHubMessageJournal_GetPendingCount(journal));
+    IoTHubMessageJournal_Acknowledge(journal, 5);
+    ASSERT_ARE_EQUAL(size_t, 0, IoTHubMessageJournal_GetPendingCount(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_022: [ `IoTHubMessageJournal_GetPendingCount` shall return how many of the messages kept are not acknowledged. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_GetPendingCount_does_not_count_the_evicted_messages)
+{
+    //arrange
+    size_t i;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    set_body(200, 'f'); /*two messages per segment*/
+    for (i = 0; i < 2 * TEST_MAX_SEGMENTS + 1; i++)
+    {
+        (void)append_message(journal);
+    }
+
+    //act
+    size_t result = IoTHubMessageJournal_GetPendingCount(journal);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 2 * TEST_MAX_SEGMENTS - 1, result);
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_018: [ If messages were acknowledged since the last ACK record, `IoTHubMessageJournal_Flush` shall append an ACK record, starting the next segment if it does not fit. ]*/
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_020: [ `IoTHubMessageJournal_Flush` shall remove the oldest sealed segments whose messages are all acknowledged. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Flush_removes_the_segments_delivered)
+{
+    //arrange
+    size_t i;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    set_body(200, 'd');
+    for (i = 0; i < 5; i++)
+    {
+        (void)append_message(journal);
+    }
+    ASSERT_ARE_EQUAL(size_t, 3, get_statistics(journal).segments_in_use);
+    IoTHubMessageJournal_Acknowledge(journal, 4);
+
+    //act
+    int result = IoTHubMessageJournal_Flush(journal);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(size_t, 1, get_statistics(journal).segments_in_use);
+    ASSERT_ARE_EQUAL(size_t, 2, g_remove_segment_calls);
+    ASSERT_ARE_EQUAL(uint32_t, 5, IoTHubMessageJournal_GetFirstSequenceNumber(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 5, read_next(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_019: [ `IoTHubMessageJournal_Flush` shall write the records appended since the last flush to the storage in a single append. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Flush_fails_when_the_storage_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    (void)append_message(journal);
+    g_fail_append = true;
+
+    //act
+    int result = IoTHubMessageJournal_Flush(journal);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    g_fail_append = false;
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessageJournal_Flush(journal));
+    ASSERT_ARE_EQUAL(size_t, get_statistics(journal).bytes_written, g_segment_length[0]);
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_011: [ `IoTHubMessageJournal_ReadNext` shall skip ACK records, acknowledged messages and messages before the one given to the last `IoTHubMessageJournal_Rewind`. ]*/
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_016: [ `IoTHubMessageJournal_Rewind` shall move the replay position to the start of the segment holding `sequence_number` so that the next message read is the first one not older than `sequence_number`. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_Rewind_reads_again_from_the_given_message)
+{
+    //arrange
+    size_t i;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    set_body(200, 'e');
+    for (i = 0; i < 5; i++)
+    {
+        (void)append_message(journal);
+    }
+    for (i = 0; i < 5; i++)
+    {
+        (void)read_next(journal);
+    }
+
+    //act
+    IoTHubMessageJournal_Rewind(journal, 4);
+
+    //assert
+    ASSERT_ARE_EQUAL(uint32_t, 4, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 5, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 0, read_next(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_017: [ `IoTHubMessageJournal_Acknowledge` shall mark the messages up to `sequence_number` as delivered; acknowledgements never move back and the ACK record is only written by `IoTHubMessageJournal_Flush`. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_ReadNext_skips_acknowledged_messages)
+{
+    //arrange
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    (void)append_message(journal);
+    (void)append_message(journal);
+    (void)append_message(journal);
+
+    //act
+    IoTHubMessageJournal_Acknowledge(journal, 2);
+    IoTHubMessageJournal_Acknowledge(journal, 1);
+    IoTHubMessageJournal_Rewind(journal, 1);
+
+    //assert
+    ASSERT_ARE_EQUAL(uint32_t, 3, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 0, read_next(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+/* Tests_SRS_IOTHUB_MESSAGE_JOURNAL_99_013: [ If a record cannot be read back or its CRC does not match, `IoTHubMessageJournal_ReadNext` shall skip the rest of its segment. ]*/
+TEST_FUNCTION(IoTHubMessageJournal_ReadNext_skips_the_rest_of_a_corrupt_segment)
+{
+    //arrange
+    size_t i;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal = IoTHubMessageJournal_Create(&g_config);
+    set_body(200, 'f');
+    for (i = 0; i < 3; i++)
+    {
+        (void)append_message(journal);
+    }
+    /*the first segment is sealed, flip a byte of its second message*/
+    g_segments[0][g_segment_length[0] - 1] ^= 0xFF;
+
+    //act
+    //assert
+    ASSERT_ARE_EQUAL(uint32_t, 1, read_next(journal));
+    ASSERT_ARE_EQUAL(uint32_t, 3, read_next(journal));
+
+    //cleanup
+    IoTHubMessageJournal_Destroy(journal);
+}
+
+END_TEST_SUITE(iothub_message_journal_ut)
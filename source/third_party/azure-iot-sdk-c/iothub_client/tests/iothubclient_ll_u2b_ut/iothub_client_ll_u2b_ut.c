@@ -49,7 +49,7 @@ static void* my_gballoc_calloc(size_t nmemb, size_t size)
 #include "blob.h"
 #include "parson.h"
 
-MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string, const char *, string);
+MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string_with_arena, const char *, string);
 MOCKABLE_FUNCTION(, const char*, json_object_get_string, const JSON_Object *, object, const char *, name);
 MOCKABLE_FUNCTION(, void, json_value_free, JSON_Value *, value);
 MOCKABLE_FUNCTION(, JSON_Object*, json_value_get_object, const JSON_Value *, value);
@@ -84,12 +84,6 @@ static void my_STRING_delete(STRING_HANDLE handle)
     free(handle);
 }
 
-static STRING_HANDLE my_URL_EncodeString(const char* textEncode)
-{
-    (void)textEncode;
-    return (STRING_HANDLE)malloc(1);
-}
-
 static HTTP_HEADERS_HANDLE my_HTTPHeaders_Alloc(void)
 {
     return (HTTP_HEADERS_HANDLE)malloc(1);
@@ -149,7 +143,7 @@ static void my_HTTPAPIEX_SAS_Destroy(HTTPAPIEX_SAS_HANDLE handle)
     free(handle);
 }
 
-static JSON_Value * my_json_parse_string(const char *string)
+static JSON_Value * my_json_parse_string_with_arena(const char *string)
 {
     (void)string;
     return (JSON_Value *)malloc(1);
@@ -256,6 +250,25 @@ static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_GetData_Callback(IOT
     return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
 }
 
+/**
+ * FileUpload_FillSlice_Callback only records how it was called last,
+ * for the tests that never get as far as asking for a block.
+ */
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT FileUpload_FillSlice_Callback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char* slice, size_t* size, void* _uploadContext)
+{
+    BLOB_UPLOAD_CONTEXT* uploadContext = (BLOB_UPLOAD_CONTEXT*)_uploadContext;
+
+    uploadContext->lastResult = result;
+    uploadContext->lastData = (unsigned char const **)slice;
+    uploadContext->lastSize = size;
+    if (size != NULL)
+    {
+        *size = 0;
+    }
+
+    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+}
+
 #include "azure_c_shared_utility/gballoc.h"
 
 #undef ENABLE_MOCKS
@@ -379,6 +392,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK, void*);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
@@ -396,7 +410,8 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_concat_with_STRING, __FAILURE__);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_copy, __FAILURE__);
     REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
-    REGISTER_GLOBAL_MOCK_HOOK(URL_EncodeString, my_URL_EncodeString);
+    REGISTER_GLOBAL_MOCK_RETURN(URL_EncodeConcat, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(URL_EncodeConcat, __FAILURE__);
 
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
@@ -418,7 +433,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_build, my_BUFFER_build);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_build, 1);
 
-    REGISTER_GLOBAL_MOCK_HOOK(json_parse_string, my_json_parse_string);
+    REGISTER_GLOBAL_MOCK_HOOK(json_parse_string_with_arena, my_json_parse_string_with_arena);
     REGISTER_GLOBAL_MOCK_RETURN(json_value_get_object, (JSON_Object*)1);
     REGISTER_GLOBAL_MOCK_RETURN(json_object_get_string, "a");
     REGISTER_GLOBAL_MOCK_HOOK(json_value_free, my_json_value_free);
@@ -637,6 +652,70 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_with_NULL_source_and_non_zero_size_fa
     IoTHubClient_LL_UploadToBlob_Destroy(h);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_99_047: [ If both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_with_both_callbacks_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(h, "text.txt", FileUpload_GetData_Callback, FileUpload_FillSlice_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_047: [ If both or neither of `getDataCallbackEx` and `fillSliceCallback` are given, `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_with_no_callback_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(h, "text.txt", NULL, NULL, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_004: [ If `IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex)` does not return `IOTHUB_CLIENT_OK`, it shall call `getDataCallback` with `result` set to `FILE_UPLOAD_ERROR`, and `data` and `size` set to NULL. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_reports_a_failure_to_fillSliceCallback)
+{
+    ///arrange
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_SAS);
+    context.lastResult = FILE_UPLOAD_OK;
+    context.lastData = (unsigned char const **)&context;
+    context.lastSize = &context.size;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .SetReturn(NULL);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(h, "text.txt", NULL, FileUpload_FillSlice_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, FILE_UPLOAD_ERROR, context.lastResult);
+    ASSERT_IS_NULL(context.lastData);
+    ASSERT_IS_NULL(context.lastSize);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
 /*Tests_SRS_IOTHUBCLIENT_LL_99_001: [ IoTHubClient_LL_UploadToBlob shall create a struct containing the source, the size, and the remaining size to upload. ]*/
 /*Tests_SRS_IOTHUBCLIENT_LL_99_002: [ IoTHubClient_LL_UploadToBlob shall call IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl with FileUpload_GetData_Callback as getDataCallback and pass the struct created at step SRS_IOTHUBCLIENT_LL_99_001 as context ]*/
 /*Tests_SRS_IOTHUBCLIENT_LL_02_064: [ IoTHubClient_LL_UploadMultipleBlocksToBlob(Ex) shall create an HTTPAPIEX_HANDLE to the IoTHub hostname. ]*/
@@ -777,7 +856,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_happypath)
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -817,8 +896,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_happypath)
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://")) /*30*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -829,17 +906,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_happypath)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -862,10 +935,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_happypath)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             ;
         /*some snprintfs happen here... */
@@ -1105,7 +1178,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_with_certificates_happypath
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -1145,8 +1218,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_with_certificates_happypath
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://")) /*30*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -1157,17 +1228,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_with_certificates_happypath
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -1190,10 +1257,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_with_certificates_happypath
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, "some certificates", IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, "some certificates", IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             ;
         /*some snprintfs happen here... */
@@ -1603,7 +1670,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_httpStatusCode_i
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -1643,8 +1710,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_httpStatusCode_i
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://")) /*30*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -1655,17 +1720,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_httpStatusCode_i
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -1688,10 +1749,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_httpStatusCode_i
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&FourHundred, sizeof(FourHundred))
             ;
         /*some snprintfs happen here... */
@@ -1928,7 +1989,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_succeeds)
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -1968,8 +2029,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_succeeds)
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -1980,17 +2039,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_succeeds)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/")) /*40*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -2013,10 +2068,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_succeeds)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             .SetReturn(BLOB_ABORTED)
             ;
@@ -2242,7 +2297,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_unhappypa
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -2282,8 +2337,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_unhappypa
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://")) /*35*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -2294,17 +2347,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_unhappypa
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/")) /*40*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -2327,10 +2376,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_unhappypa
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             .SetReturn(BLOB_ABORTED)
             ;
@@ -2421,18 +2470,16 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step2_aborts_unhappypa
         24, /*BUFFER_u_char*/
         25, /*BUFFER_length*/
         27, /*STRING_c_str*/
-        42, /*STRING_c_str*/
-        45, /*STRING_delete*/
-        46, /*json_value_free*/
-        47, /*STRING_delete*/
-        48, /*BUFFER_delete*/
-        68, /*STRING_delete*/
+        43, /*json_value_free*/
+        44, /*STRING_delete*/
+        45, /*BUFFER_delete*/
+        65, /*STRING_delete*/
+        66, /*STRING_delete*/
+        67, /*BUFFER_delete*/
+        68, /*HTTPHeaders_Free*/
         69, /*STRING_delete*/
-        70, /*BUFFER_delete*/
-        71, /*HTTPHeaders_Free*/
-        72, /*STRING_delete*/
-        73, /*STRING_delete*/
-        74, /*HTTPAPIEX_Destroy*/
+        70, /*STRING_delete*/
+        71, /*HTTPAPIEX_Destroy*/
     };
 
     for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -2601,7 +2648,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step3_httpStatusCode_i
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -2641,8 +2688,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step3_httpStatusCode_i
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://")) /*30*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -2653,17 +2698,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step3_httpStatusCode_i
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -2686,10 +2727,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_when_step3_httpStatusCode_i
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             ;
         /*some snprintfs happen here... */
@@ -2936,7 +2977,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_unhappypaths)
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -2976,8 +3017,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_unhappypaths)
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://")) /*30*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -2988,17 +3027,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_unhappypaths)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -3021,10 +3056,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_unhappypaths)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             ;
         /*some snprintfs happen here... */
@@ -3133,29 +3168,27 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SAS_token_unhappypaths)
         24, /*BUFFER_u_char*/
         25, /*BUFFER_length*/
         27, /*STRING_c_str*/
-        42, /*STRING_c_str*/
-        45, /*STRING_delete*/
-        46, /*json_value_free*/
-        47, /*STRING_delete*/
-        48, /*BUFFER_delete*/
-        50, /*BUFFER_delete*/
-        51, /*STRING_delete*/
-        52, /*STRING_delete*/
-        54, /*STRING_c_str*/
-        56, /*BUFFER_u_char*/
-        58, /*BUFFER_u_char*/
+        43, /*json_value_free*/
+        44, /*STRING_delete*/
+        45, /*BUFFER_delete*/
+        47, /*BUFFER_delete*/
+        48, /*STRING_delete*/
+        49, /*STRING_delete*/
+        51, /*STRING_c_str*/
+        53, /*BUFFER_u_char*/
+        55, /*BUFFER_u_char*/
+        64, /*STRING_c_str*/
         67, /*STRING_c_str*/
-        70, /*STRING_c_str*/
+        68, /*BUFFER_delete*/
+        69, /*STRING_delete*/
+        70, /*STRING_delete*/
         71, /*BUFFER_delete*/
-        72, /*STRING_delete*/
-        73, /*STRING_delete*/
-        74, /*BUFFER_delete*/
-        75, /*gballoc_free*/
-        76, /*BUFFER_delete*/
-        77, /*HTTPHeaders_Free*/
-        78, /*STRING_delete*/
-        79, /*STRING_delete*/
-        80, /*HTTPAPIEX_Destroy*/
+        72, /*gballoc_free*/
+        73, /*BUFFER_delete*/
+        74, /*HTTPHeaders_Free*/
+        75, /*STRING_delete*/
+        76, /*STRING_delete*/
+        77, /*HTTPAPIEX_Destroy*/
     };
 
     for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3434,7 +3467,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_happypath)
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -3474,8 +3507,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_happypath)
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -3486,17 +3517,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_happypath)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/")) /*40*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -3519,10 +3546,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_happypath)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             ;
         /*some snprintfs happen here... */
@@ -3631,7 +3658,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_happypath)
         .IgnoreArgument(1);
 
     ///act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(h, "text.txt", FileUpload_GetData_Callback, NULL, &context);
 
     ///assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
@@ -3931,7 +3958,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_deviceKey_when_step3_httpStatusCode_i
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -3971,8 +3998,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_deviceKey_when_step3_httpStatusCode_i
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -3983,17 +4008,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_deviceKey_when_step3_httpStatusCode_i
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/")) /*40*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -4016,10 +4037,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_deviceKey_when_step3_httpStatusCode_i
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             ;
         /*some snprintfs happen here... */
@@ -4286,7 +4307,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_unhappypaths)
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -4326,8 +4347,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_unhappypaths)
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -4338,17 +4357,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_unhappypaths)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/")) /*40*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))/*48*/
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -4371,10 +4386,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_unhappypaths)
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             ;
         /*some snprintfs happen here... */
@@ -4492,30 +4507,28 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_unhappypaths)
         30, /*BUFFER_u_char*/
         31, /*BUFFER_length*/
         33, /*STRING_c_str*/
-        48, /*STRING_c_str*/
-        51, /*STRING_delete*/
-        52, /*json_value_free*/
+        49, /*json_value_free*/
+        50, /*STRING_delete*/
+        51, /*BUFFER_delete*/
+        52, /*BUFFER_delete*/
         53, /*STRING_delete*/
-        54, /*BUFFER_delete*/
-        55, /*BUFFER_delete*/
-        56, /*STRING_delete*/
-        57, /*STRING_delete*/
-        59, /*STRING_c_str*/
-        61, /*BUFFER_u_char*/
-        63, /*BUFFER_u_char*/
-        72, /*STRING_c_str*/
-        77, /*STRING_c_str*/
-        79, /*HTTPAPIEX_SAS_Destroy*/
-        80, /*STRING_delete*/
-        81, /*STRING_delete*/
-        82, /*STRING_delete*/
-        83, /*BUFFER_delete*/
-        84, /*gballoc_free*/
-        85, /*BUFFER_delete*/
-        86, /*HTTPHeaders_Free*/
-        87, /*STRING_delete*/
-        88, /*STRING_delete*/
-        89, /*HTTPAPIEX_Destroy*/
+        54, /*STRING_delete*/
+        56, /*STRING_c_str*/
+        58, /*BUFFER_u_char*/
+        60, /*BUFFER_u_char*/
+        69, /*STRING_c_str*/
+        74, /*STRING_c_str*/
+        76, /*HTTPAPIEX_SAS_Destroy*/
+        77, /*STRING_delete*/
+        78, /*STRING_delete*/
+        79, /*STRING_delete*/
+        80, /*BUFFER_delete*/
+        81, /*gballoc_free*/
+        82, /*BUFFER_delete*/
+        83, /*HTTPHeaders_Free*/
+        84, /*STRING_delete*/
+        85, /*STRING_delete*/
+        86, /*HTTPAPIEX_Destroy*/
     };
 
     for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -4537,7 +4550,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_deviceKey_unhappypaths)
         {
             /// assert
             sprintf(temp_str, "On failed call %zu", i);
-            IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(h, "text.txt", FileUpload_GetData_Callback, &context);
+            IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(h, "text.txt", FileUpload_GetData_Callback, NULL, &context);
             ASSERT_ARE_NOT_EQUAL_WITH_MSG(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result, temp_str);
 
             // Check parameters of the last call to getDataCallback
@@ -4683,7 +4696,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -4723,8 +4736,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://")) /*30*/
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -4735,17 +4746,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -4768,10 +4775,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             ;
         /*some snprintfs happen here... */
@@ -5013,7 +5020,7 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
             .IgnoreArgument(1);
 
         JSON_Value* allJson;
-        STRICT_EXPECTED_CALL(json_parse_string(iotHubHttpMessageBodyResponse1_as_const_char))
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(iotHubHttpMessageBodyResponse1_as_const_char))
             .CaptureReturn(&allJson)
             .IgnoreArgument(1);
 
@@ -5053,8 +5060,6 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
 
         STRICT_EXPECTED_CALL(STRING_copy(sasUri, "https://"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(URL_EncodeString(json_blobName))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_hostName)) /*30*/
             .IgnoreArgument(1)
             .IgnoreArgument(2);
@@ -5065,17 +5070,13 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, "/"))
             .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
-        STRICT_EXPECTED_CALL(STRING_concat(sasUri, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(sasUri, json_blobName))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
         STRICT_EXPECTED_CALL(STRING_concat(sasUri, json_sasToken))
             .IgnoreArgument(1)
             .IgnoreArgument(2);
 
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(json_value_free(allJson))
             .IgnoreArgument(1);
         STRICT_EXPECTED_CALL(STRING_delete(iotHubHttpMessageBodyResponse1_as_STRING_HANDLE))
@@ -5098,10 +5099,10 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
             .CaptureReturn(&sasUri_as_const_char)
             .IgnoreArgument(1);
 
-        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Blob_UploadMultipleBlocksFromSasUri(sasUri_as_const_char, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, FILE_UPLOAD_SLICE_SIZE))
             .IgnoreArgument(1)
-            .IgnoreArgument(4)
             .IgnoreArgument(5)
+            .IgnoreArgument(6)
             .CopyOutArgumentBuffer_httpStatus(&TwoHundred, sizeof(TwoHundred))
             ;
         /*some snprintfs happen here... */
@@ -5209,29 +5210,27 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_passes_x509_information_to_HTTPAPIEX_
         23, /*BUFFER_u_char*/
         24, /*BUFFER_length*/
         26, /*STRING_c_str*/
-        41, /*STRING_c_str*/
-        44, /*STRING_delete*/
-        45, /*json_value_free*/
+        42, /*json_value_free*/
+        43, /*STRING_delete*/
+        44, /*BUFFER_delete*/
+        45, /*BUFFER_delete*/
         46, /*STRING_delete*/
-        47, /*BUFFER_delete*/
-        48, /*BUFFER_delete*/
-        49, /*STRING_delete*/
-        50, /*STRING_delete*/
-        52, /*STRING_c_str*/
-        54, /*BUFFER_u_char*/
-        56, /*BUFFER_u_char*/
+        47, /*STRING_delete*/
+        49, /*STRING_c_str*/
+        51, /*BUFFER_u_char*/
+        53, /*BUFFER_u_char*/
+        62, /*STRING_c_str*/
         65, /*STRING_c_str*/
-        68, /*STRING_c_str*/
+        66, /*BUFFER_delete*/
+        67, /*STRING_delete*/
+        68, /*STRING_delete*/
         69, /*BUFFER_delete*/
-        70, /*STRING_delete*/
-        71, /*STRING_delete*/
-        72, /*BUFFER_delete*/
-        73, /*gballoc_free*/
-        74, /*BUFFER_delete*/
-        75, /*HTTPHeaders_Free*/
-        76, /*STRING_delete*/
-        77, /*STRING_delete*/
-        78, /*HTTPAPIEX_Destroy*/
+        70, /*gballoc_free*/
+        71, /*BUFFER_delete*/
+        72, /*HTTPHeaders_Free*/
+        73, /*STRING_delete*/
+        74, /*STRING_delete*/
+        75, /*HTTPAPIEX_Destroy*/
     };
 
     for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -5337,6 +5336,184 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_x509unknownoption_fails)
     IoTHubClient_LL_UploadToBlob_Destroy(h);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_99_010: [ OPTION_BLOB_UPLOAD_PARALLELISM - then `value` is a pointer to a `size_t` with the most blocks uploaded at once. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_parallelism_succeeds)
+{
+    ///arrange
+    size_t parallelism = 4;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_DEVICE_KEY);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_PARALLELISM, &parallelism);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_011: [ If the value is 0, `IoTHubClient_LL_UploadToBlob_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_parallelism_0_fails)
+{
+    ///arrange
+    size_t parallelism = 0;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_DEVICE_KEY);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_PARALLELISM, &parallelism);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_042: [ OPTION_BLOB_UPLOAD_SLICE_SIZE - then `value` is a pointer to a `size_t` with the size of the slice offered to `fillSliceCallback`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_slice_size_succeeds)
+{
+    ///arrange
+    size_t sliceSize = BLOCK_SIZE;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_DEVICE_KEY);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_SLICE_SIZE, &sliceSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_043: [ If the value is 0 or bigger than `BLOCK_SIZE`, `IoTHubClient_LL_UploadToBlob_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_slice_size_0_fails)
+{
+    ///arrange
+    size_t sliceSize = 0;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_DEVICE_KEY);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_SLICE_SIZE, &sliceSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_043: [ If the value is 0 or bigger than `BLOCK_SIZE`, `IoTHubClient_LL_UploadToBlob_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_slice_size_over_BLOCK_SIZE_fails)
+{
+    ///arrange
+    size_t sliceSize = BLOCK_SIZE + 1;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_DEVICE_KEY);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_SLICE_SIZE, &sliceSize);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_013: [ OPTION_BLOB_UPLOAD_BLOCK_RETRIES - then `value` is a pointer to a `size_t` with the times a block is sent again after a transient failure. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_block_retries_succeeds)
+{
+    ///arrange
+    size_t retries = 3;
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_DEVICE_KEY);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_BLOCK_RETRIES, &retries);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+static int test_checkpoint_save(const char* destinationFileName, const char* checkpoint, void* context)
+{
+    (void)destinationFileName;
+    (void)checkpoint;
+    (void)context;
+    return 0;
+}
+
+static int test_checkpoint_load(const char* destinationFileName, char* checkpoint, size_t checkpointSize, void* context)
+{
+    (void)destinationFileName;
+    (void)checkpoint;
+    (void)checkpointSize;
+    (void)context;
+    return __LINE__;
+}
+
+static void test_checkpoint_remove(const char* destinationFileName, void* context)
+{
+    (void)destinationFileName;
+    (void)context;
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_014: [ OPTION_BLOB_UPLOAD_CHECKPOINT_STORE - then `value` is a pointer to an `IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE` that is copied; a store with all callbacks NULL turns checkpoints off. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_checkpoint_store_succeeds)
+{
+    ///arrange
+    IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE store = { test_checkpoint_save, test_checkpoint_load, test_checkpoint_remove, NULL };
+    IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE noStore = { NULL, NULL, NULL, NULL };
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_DEVICE_KEY);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result1 = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CHECKPOINT_STORE, &store);
+    IOTHUB_CLIENT_RESULT result2 = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CHECKPOINT_STORE, &noStore);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_021: [ If `value` is NULL or only some of its callbacks are NULL, `IoTHubClient_LL_UploadToBlob_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_blob_upload_checkpoint_store_without_remove_fails)
+{
+    ///arrange
+    IOTHUB_BLOB_UPLOAD_CHECKPOINT_STORE store = { test_checkpoint_save, test_checkpoint_load, NULL, NULL };
+    IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h = IoTHubClient_LL_UploadToBlob_Create(&TEST_CONFIG_DEVICE_KEY);
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result1 = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CHECKPOINT_STORE, &store);
+    IOTHUB_CLIENT_RESULT result2 = IoTHubClient_LL_UploadToBlob_SetOption(h, OPTION_BLOB_UPLOAD_CHECKPOINT_STORE, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result2);
+
+    ///cleanup
+    IoTHubClient_LL_UploadToBlob_Destroy(h);
+}
+
 /*Tests_SRS_IOTHUBCLIENT_LL_02_109: [ If the authentication scheme is NOT x509 then IoTHubClient_LL_UploadToBlob_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
 TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_SetOption_x509cerfiticate_with_devicekey_auth_fails)
 {
@@ -47,6 +47,7 @@ void* my_gballoc_realloc(void* ptr, size_t size)
 #include "iothub_message.h"
 #include "iothub_client_authorization.h"
 #include "iothub_client_diagnostic.h"
+#include "iothub_message_journal.h"
 
 #undef ENABLE_MOCKS
 
@@ -171,6 +172,11 @@ static const char* TEST_STRING_VALUE = "Test string value";
 
 #define TEST_METHOD_ID                      (METHOD_HANDLE)0x61
 #define TEST_IOTHUB_AUTH_HANDLE        (IOTHUB_AUTHORIZATION_HANDLE)0x62
+#define TEST_MESSAGE_JOURNAL_HANDLE         (IOTHUB_MESSAGE_JOURNAL_HANDLE)0x63
+#define TEST_REPLAYED_MESSAGE_HANDLE        (IOTHUB_MESSAGE_HANDLE)0x64
+#define TEST_ALARM_MESSAGE_HANDLE           (IOTHUB_MESSAGE_HANDLE)0x65 /*IOTHUB_MESSAGE_PRIORITY_HIGH*/
+#define TEST_LOW_PRIORITY_MESSAGE_HANDLE    (IOTHUB_MESSAGE_HANDLE)0x66 /*IOTHUB_MESSAGE_PRIORITY_LOW*/
+#define TEST_LANE_MESSAGE_SIZE              100
 
 static const char* TEST_PROV_URI = "global.azure-devices-provisioning.net";
 
@@ -178,6 +184,13 @@ static const char* TEST_METHOD_NAME = "method_name";
 static const char* TEST_CHAR = "TestChar";
 static tickcounter_ms_t g_current_ms = 0;
 static const char* TEST_DEVICE_METHOD_RESPONSE = "{device:method, response:true}";
+static PDLIST_ENTRY g_waitingToSend;
+static size_t g_journal_messages; /*how many messages the journal mock holds for IoTHubMessageJournal_ReadNext*/
+static uint32_t g_journal_next_read;
+static size_t g_transport_sends_per_do_work; /*events the fake transport takes from waitingToSend in each _DoWork*/
+static size_t g_alarms_sent;
+static size_t g_lane_confirmations;
+static IOTHUB_CLIENT_CONFIRMATION_RESULT g_lane_last_confirmation;
 
 const unsigned char TEST_REPORTED_STATE[] = { 0x01, 0x02, 0x03 };
 const size_t TEST_REPORTED_SIZE = sizeof(TEST_REPORTED_STATE) / sizeof(TEST_REPORTED_STATE[0]);
@@ -381,10 +394,53 @@ static IOTHUB_DEVICE_HANDLE my_FAKE_IoTHubTransport_Register(TRANSPORT_LL_HANDLE
     (void)handle;
     (void)device;
     (void)iotHubClientHandle;
-    (void)waitingToSend;
+    g_waitingToSend = waitingToSend;
     return (IOTHUB_DEVICE_HANDLE)my_gballoc_malloc(1);
 }
 
+static int my_IoTHubMessageJournal_Append(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, IOTHUB_MESSAGE_HANDLE message, uint32_t* sequence_number)
+{
+    (void)journal;
+    (void)message;
+    *sequence_number = (uint32_t)++g_journal_messages;
+    return 0;
+}
+
+static int my_IoTHubMessageJournal_ReadNext(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, IOTHUB_MESSAGE_HANDLE* message, uint32_t* sequence_number)
+{
+    (void)journal;
+    if (g_journal_next_read > g_journal_messages)
+    {
+        *message = NULL;
+    }
+    else
+    {
+        *message = TEST_REPLAYED_MESSAGE_HANDLE;
+        *sequence_number = g_journal_next_read++;
+    }
+    return 0;
+}
+
+static void my_IoTHubMessageJournal_Rewind(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, uint32_t sequence_number)
+{
+    (void)journal;
+    g_journal_next_read = sequence_number;
+}
+
+static IOTHUB_MESSAGE_PRIORITY my_IoTHubMessage_GetPriority(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
+{
+    return (iotHubMessageHandle == TEST_ALARM_MESSAGE_HANDLE) ? IOTHUB_MESSAGE_PRIORITY_HIGH :
+        (iotHubMessageHandle == TEST_LOW_PRIORITY_MESSAGE_HANDLE) ? IOTHUB_MESSAGE_PRIORITY_LOW : IOTHUB_MESSAGE_PRIORITY_NORMAL;
+}
+
+static IOTHUB_MESSAGE_RESULT my_IoTHubMessage_GetByteArray(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle, const unsigned char** buffer, size_t* size)
+{
+    (void)iotHubMessageHandle;
+    *buffer = TEST_REPORTED_STATE;
+    *size = TEST_LANE_MESSAGE_SIZE;
+    return IOTHUB_MESSAGE_OK;
+}
+
 static void my_FAKE_IoTHubTransport_Unregister(IOTHUB_DEVICE_HANDLE deviceHandle)
 {
     my_gballoc_free(deviceHandle);
@@ -479,6 +535,15 @@ static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT my_FileUpload_GetData_CallbackE
     (void)result;
     return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
 }
+
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT my_FileUpload_FillSlice_Callback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char* slice, size_t* size, void* context)
+{
+    (void)slice;
+    (void)size;
+    (void)context;
+    (void)result;
+    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+}
 #endif /* DONT_USE_UPLOADTOBLOB */
 
 #ifdef __cplusplus
@@ -498,6 +563,25 @@ extern "C"
 }
 #endif
 
+/*a transport that can only get g_transport_sends_per_do_work events out per _DoWork, the way a slow link drains a backlog*/
+static void my_FAKE_IoTHubTransport_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
+{
+    size_t sent;
+    (void)handle;
+    (void)iotHubClientHandle;
+    for (sent = 0; (sent < g_transport_sends_per_do_work) && (g_waitingToSend->Flink != g_waitingToSend); sent++)
+    {
+        PDLIST_ENTRY entry = g_waitingToSend->Flink;
+        IOTHUB_MESSAGE_LIST* message = containingRecord(entry, IOTHUB_MESSAGE_LIST, entry);
+        if (message->context == (void*)TEST_ALARM_MESSAGE_HANDLE)
+        {
+            g_alarms_sent++;
+        }
+        (void)real_DList_RemoveEntryList(entry);
+        my_gballoc_free(message);
+    }
+}
+
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 
 static MESSAGE_CALLBACK_INFO* make_test_message_info(IOTHUB_MESSAGE_HANDLE message)
@@ -548,6 +632,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_CONFIRMATION_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(PDLIST_ENTRY, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const PDLIST_ENTRY, void*);
     REGISTER_UMOCK_ALIAS_TYPE(TRANSPORT_LL_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_TRANSPORT_PROVIDER, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_DEVICE_HANDLE, void*);
@@ -558,6 +643,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(METHOD_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_AUTHORIZATION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_JOURNAL_HANDLE, void*);
 
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUBMESSAGE_DISPOSITION_RESULT, int);
@@ -567,9 +653,14 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_CONNECTION_STATUS, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_CONNECTION_STATUS_REASON, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_RETRY_POLICY, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_PRIORITY, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUBMESSAGE_CONTENT_TYPE, int);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_RESULT, int);
 
 #ifndef DONT_USE_UPLOADTOBLOB
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK, void*);
 #endif // DONT_USE_UPLOADTOBLOB
 
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_GetVersionString, "version 1.0");
@@ -617,10 +708,23 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_CreateFromString, (IOTHUB_MESSAGE_HANDLE)0x44);
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_Clone, (IOTHUB_MESSAGE_HANDLE)0x44);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_Clone, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetPriority, my_IoTHubMessage_GetPriority);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_GetContentType, IOTHUBMESSAGE_BYTEARRAY);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_GetByteArray, my_IoTHubMessage_GetByteArray);
+    REGISTER_GLOBAL_MOCK_HOOK(FAKE_IoTHubTransport_DoWork, my_FAKE_IoTHubTransport_DoWork);
 
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_Diagnostic_AddIfNecessary, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_Diagnostic_AddIfNecessary, 100);
 
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessageJournal_Create, TEST_MESSAGE_JOURNAL_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessageJournal_Create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessageJournal_Append, my_IoTHubMessageJournal_Append);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessageJournal_Append, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessageJournal_ReadNext, my_IoTHubMessageJournal_ReadNext);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessageJournal_Rewind, my_IoTHubMessageJournal_Rewind);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessageJournal_Flush, 0);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessageJournal_GetFirstSequenceNumber, 1);
+
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_Auth_CreateFromDeviceAuth, my_IoTHubClient_Auth_CreateFromDeviceAuth);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_Auth_CreateFromDeviceAuth, NULL);
 
@@ -695,6 +799,11 @@ TEST_FUNCTION_INITIALIZE(method_init)
     g_fail_string_construct_sprintf = false;
     g_fail_platform_get_platform_info = false;
     g_fail_string_concat_with_string = false;
+    g_journal_messages = 0;
+    g_journal_next_read = 1;
+    g_transport_sends_per_do_work = 0;
+    g_alarms_sent = 0;
+    g_lane_confirmations = 0;
 }
 
 TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -3924,6 +4033,80 @@ TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlobEx_with_NULL_callback_fa
     IoTHubClient_LL_Destroy(h);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_99_048: [ If `iotHubClientHandle`, `destinationFileName` or `fillSliceCallback` is `NULL` then `IoTHubClient_LL_UploadSlicesToBlob` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadSlicesToBlob_with_NULL_handle_fails)
+{
+    //arrange
+    unsigned int context = 1;
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadSlicesToBlob(NULL, "irrelevantFileName", my_FileUpload_FillSlice_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+
+    ///cleanup
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_048: [ If `iotHubClientHandle`, `destinationFileName` or `fillSliceCallback` is `NULL` then `IoTHubClient_LL_UploadSlicesToBlob` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadSlicesToBlob_with_NULL_filename_fails)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadSlicesToBlob(h, NULL, my_FileUpload_FillSlice_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_048: [ If `iotHubClientHandle`, `destinationFileName` or `fillSliceCallback` is `NULL` then `IoTHubClient_LL_UploadSlicesToBlob` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadSlicesToBlob_with_NULL_callback_fails)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadSlicesToBlob(h, "irrelevantFileName", NULL, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_049: [ `IoTHubClient_LL_UploadSlicesToBlob` shall call `IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl` with `fillSliceCallback` and `context` and return what it returns. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadSlicesToBlob_calls_the_upload_with_fillSliceCallback)
+{
+    //arrange
+    unsigned int context = 1;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IGNORED_PTR_ARG, "irrelevantFileName", NULL, my_FileUpload_FillSlice_Callback, &context))
+        .IgnoreArgument_handle()
+        .SetReturn(IOTHUB_CLIENT_ERROR);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadSlicesToBlob(h, "irrelevantFileName", my_FileUpload_FillSlice_Callback, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
 #endif 
 
 /* Tests_SRS_IOTHUBCLIENT_LL_10_016: [ Otherwise IoTHubClient_LL_SendReportedState shall succeed and return IOTHUB_CLIENT_OK.] */
@@ -5013,5 +5196,803 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_diag_sampling_percentage_fails)
     IoTHubClient_LL_Destroy(h);
 }
 
+static IOTHUB_MESSAGE_JOURNAL_CONFIG TEST_MESSAGE_JOURNAL_CONFIG = { NULL, "journal", 4096, 8, 2 };
+
+static IOTHUB_CLIENT_LL_HANDLE create_client_with_message_journal(void)
+{
+    IOTHUB_CLIENT_LL_HANDLE result = IoTHubClient_LL_Create(&TEST_CONFIG);
+    (void)IoTHubClient_LL_SetOption(result, OPTION_MESSAGE_JOURNAL, &TEST_MESSAGE_JOURNAL_CONFIG);
+    return result;
+}
+
+/*moves what the client put in waitingToSend to completed, as the transport does once it has an answer*/
+static void take_waiting_to_send(PDLIST_ENTRY completed)
+{
+    PDLIST_ENTRY entry;
+    DList_InitializeListHead(completed);
+    while ((entry = DList_RemoveHeadList(g_waitingToSend)) != g_waitingToSend)
+    {
+        DList_InsertTailList(completed, entry);
+    }
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_024: [ `OPTION_MESSAGE_JOURNAL` - `value` is a pointer to an `IOTHUB_MESSAGE_JOURNAL_CONFIG`; `IoTHubClient_LL_SetOption` shall open the journal with `IoTHubMessageJournal_Create`, after which the messages it kept from a previous run are replayed too. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_message_journal_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Create(&TEST_MESSAGE_JOURNAL_CONFIG));
+    STRICT_EXPECTED_CALL(DList_InitializeListHead(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InitializeListHead(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_MESSAGE_JOURNAL, &TEST_MESSAGE_JOURNAL_CONFIG);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_025: [ If `replay_batch` is 0, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`; if a journal is already set or it cannot be opened, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_message_journal_with_0_replay_batch_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_JOURNAL_CONFIG config = TEST_MESSAGE_JOURNAL_CONFIG;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    config.replay_batch = 0;
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_MESSAGE_JOURNAL, &config);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_025: [ If `replay_batch` is 0, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`; if a journal is already set or it cannot be opened, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_message_journal_fails_when_the_journal_cannot_be_opened)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Create(&TEST_MESSAGE_JOURNAL_CONFIG))
+        .SetReturn(NULL);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_MESSAGE_JOURNAL, &TEST_MESSAGE_JOURNAL_CONFIG);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_025: [ If `replay_batch` is 0, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`; if a journal is already set or it cannot be opened, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_message_journal_twice_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_MESSAGE_JOURNAL, &TEST_MESSAGE_JOURNAL_CONFIG);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_022: [ If a message journal is set, `IoTHubClient_LL_SendEventAsync` shall append the message to the journal instead of waitingToSend, keep `eventConfirmationCallback` and `userContextCallback` until the message is delivered and return `IOTHUB_CLIENT_OK`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_with_message_journal_appends_to_the_journal)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Append(TEST_MESSAGE_JOURNAL_HANDLE, TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(DList_IsListEmpty(g_waitingToSend) != 0);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_023: [ If appending to the journal fails, `IoTHubClient_LL_SendEventAsync` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_with_message_journal_fails_when_append_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Append(TEST_MESSAGE_JOURNAL_HANDLE, TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG))
+        .SetReturn(__LINE__);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_027: [ Unless the transport reported `IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED`, `IoTHubClient_LL_DoWork` shall read messages from the journal into waitingToSend until `replay_batch` replayed messages are pending. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_99_030: [ `IoTHubClient_LL_DoWork` shall flush the journal once per call. ]*/
+TEST_FUNCTION(IoTHubClient_LL_DoWork_replays_the_message_journal)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, NULL, NULL);
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, NULL, NULL);
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_ReadNext(TEST_MESSAGE_JOURNAL_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Diagnostic_AddIfNecessary(IGNORED_PTR_ARG, TEST_REPLAYED_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_ReadNext(TEST_MESSAGE_JOURNAL_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Diagnostic_AddIfNecessary(IGNORED_PTR_ARG, TEST_REPLAYED_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Flush(TEST_MESSAGE_JOURNAL_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_GetFirstSequenceNumber(TEST_MESSAGE_JOURNAL_HANDLE));
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, h));
+
+    //act
+    IoTHubClient_LL_DoWork(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(uint32_t, 3, g_journal_next_read);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_032: [ `IoTHubClient_LL_ConnectionStatusCallBack` shall stop the replay of the message journal while `status` is `IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_DoWork_does_not_replay_the_message_journal_while_unauthenticated)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, NULL, NULL);
+    IoTHubClient_LL_ConnectionStatusCallBack(h, IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_NO_NETWORK);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Flush(TEST_MESSAGE_JOURNAL_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_GetFirstSequenceNumber(TEST_MESSAGE_JOURNAL_HANDLE));
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, h));
+
+    //act
+    IoTHubClient_LL_DoWork(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_028: [ Once a replayed message and all the replayed messages before it are delivered, the journal shall be acknowledged up to it and the confirmation callbacks up to it shall be called with `IOTHUB_CLIENT_CONFIRMATION_OK`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendComplete_of_a_replayed_message_acknowledges_the_journal)
+{
+    //arrange
+    DLIST_ENTRY completed;
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+    IoTHubClient_LL_DoWork(h);
+    take_waiting_to_send(&completed);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(&completed));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Acknowledge(TEST_MESSAGE_JOURNAL_HANDLE, 1));
+    STRICT_EXPECTED_CALL(DList_RemoveEntryList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_OK, (void*)1));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveEntryList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(TEST_REPLAYED_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(&completed));
+
+    //act
+    IoTHubClient_LL_SendComplete(h, &completed, IOTHUB_CLIENT_CONFIRMATION_OK);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_029: [ A replayed message that is not delivered (error, timeout or destroy) shall not be reported; once no replayed message is pending anymore, replay shall start over from the oldest one not delivered. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendComplete_of_a_failed_replayed_message_rewinds_the_journal)
+{
+    //arrange
+    DLIST_ENTRY completed;
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+    IoTHubClient_LL_DoWork(h);
+    take_waiting_to_send(&completed);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(&completed));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Rewind(TEST_MESSAGE_JOURNAL_HANDLE, 1));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(TEST_REPLAYED_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(&completed));
+
+    //act
+    IoTHubClient_LL_SendComplete(h, &completed, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(uint32_t, 1, g_journal_next_read);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_044: [ `OPTION_MESSAGE_JOURNAL_MAX_REPLAYS` - `value` is a pointer to a `size_t` with the times the oldest message not delivered is replayed before it is dropped; 0, the default, replays it until it is delivered. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_99_045: [ Once the oldest message not delivered has been replayed `OPTION_MESSAGE_JOURNAL_MAX_REPLAYS` times, the journal shall be acknowledged up to it, replay shall start over from the message after it and its confirmation callback shall be called with `IOTHUB_CLIENT_CONFIRMATION_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendComplete_drops_a_replayed_message_failed_max_replays_times)
+{
+    //arrange
+    DLIST_ENTRY completed;
+    size_t maxReplays = 2;
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_MESSAGE_JOURNAL_MAX_REPLAYS, &maxReplays);
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+    IoTHubClient_LL_DoWork(h);
+    take_waiting_to_send(&completed);
+    IoTHubClient_LL_SendComplete(h, &completed, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+    IoTHubClient_LL_DoWork(h);
+    take_waiting_to_send(&completed);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(&completed));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Acknowledge(TEST_MESSAGE_JOURNAL_HANDLE, 1));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Rewind(TEST_MESSAGE_JOURNAL_HANDLE, 2));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveEntryList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_ERROR, (void*)1));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(TEST_REPLAYED_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(&completed));
+
+    //act
+    IoTHubClient_LL_SendComplete(h, &completed, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(uint32_t, 2, g_journal_next_read);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_046: [ If the underlaying layer reports `IOTHUB_CLIENT_SEND_STATUS_IDLE` but the message journal still has messages not delivered, `IoTHubClient_LL_GetSendStatus` shall report `IOTHUB_CLIENT_SEND_STATUS_BUSY`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetSendStatus_is_BUSY_while_the_journal_has_messages_not_delivered)
+{
+    //arrange
+    IOTHUB_CLIENT_STATUS status = IOTHUB_CLIENT_SEND_STATUS_IDLE;
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_GetSendStatus(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_GetPendingCount(TEST_MESSAGE_JOURNAL_HANDLE))
+        .SetReturn(1);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetSendStatus(h, &status);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_STATUS, IOTHUB_CLIENT_SEND_STATUS_BUSY, status);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_046: [ If the underlaying layer reports `IOTHUB_CLIENT_SEND_STATUS_IDLE` but the message journal still has messages not delivered, `IoTHubClient_LL_GetSendStatus` shall report `IOTHUB_CLIENT_SEND_STATUS_BUSY`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetSendStatus_is_IDLE_once_the_journal_is_delivered)
+{
+    //arrange
+    IOTHUB_CLIENT_STATUS status = IOTHUB_CLIENT_SEND_STATUS_IDLE;
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_GetSendStatus(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_GetPendingCount(TEST_MESSAGE_JOURNAL_HANDLE))
+        .SetReturn(0);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetSendStatus(h, &status);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_STATUS, IOTHUB_CLIENT_SEND_STATUS_IDLE, status);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_031: [ The confirmation callbacks of the messages the journal evicted to make room shall be called with `IOTHUB_CLIENT_CONFIRMATION_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_DoWork_reports_the_messages_the_journal_evicted)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+    IoTHubClient_LL_ConnectionStatusCallBack(h, IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_NO_NETWORK);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Flush(TEST_MESSAGE_JOURNAL_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_GetFirstSequenceNumber(TEST_MESSAGE_JOURNAL_HANDLE))
+        .SetReturn(2);
+    STRICT_EXPECTED_CALL(DList_RemoveEntryList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_ERROR, (void*)1));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, h));
+
+    //act
+    IoTHubClient_LL_DoWork(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_026: [ `IoTHubClient_LL_Destroy` shall destroy the message journal, leaving the messages not yet delivered in it for the next run, and complete the callbacks of the journaled messages with `IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_Destroy_with_message_journal_completes_the_journaled_callbacks)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_message_journal();
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Unregister(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessageJournal_Destroy(TEST_MESSAGE_JOURNAL_HANDLE));
+    STRICT_EXPECTED_CALL(DList_RemoveEntryList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, (void*)1));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG)); /*journalInFlight*/
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(tickcounter_destroy(IGNORED_PTR_ARG));
+#ifndef DONT_USE_UPLOADTOBLOB
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadToBlob_Destroy(IGNORED_PTR_ARG));
+#endif
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_LL_Destroy(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*weights 4:2:1, a send window the fake transport drains in one _DoWork and no caps or timeouts of their own*/
+static const IOTHUB_CLIENT_PRIORITY_LANES_CONFIG TEST_PRIORITY_LANES_CONFIG =
+{
+    10,
+    {
+        { 1, 0, 0 }, /*IOTHUB_MESSAGE_PRIORITY_LOW*/
+        { 2, 0, 0 }, /*IOTHUB_MESSAGE_PRIORITY_NORMAL*/
+        { 4, 0, 0 }  /*IOTHUB_MESSAGE_PRIORITY_HIGH*/
+    }
+};
+
+#define TEST_BACKLOG_MESSAGES 1000
+
+static void count_lane_confirmation(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* userContextCallback)
+{
+    (void)userContextCallback;
+    g_lane_confirmations++;
+    g_lane_last_confirmation = result;
+}
+
+static IOTHUB_CLIENT_LL_HANDLE create_client_with_priority_lanes(const IOTHUB_CLIENT_PRIORITY_LANES_CONFIG* config)
+{
+    IOTHUB_CLIENT_LL_HANDLE result = IoTHubClient_LL_Create(&TEST_CONFIG);
+    (void)IoTHubClient_LL_SetOption(result, OPTION_PRIORITY_LANES, config);
+    return result;
+}
+
+static void send_events(IOTHUB_CLIENT_LL_HANDLE h, IOTHUB_MESSAGE_HANDLE message, size_t count)
+{
+    size_t i;
+    for (i = 0; i < count; i++)
+    {
+        (void)IoTHubClient_LL_SendEventAsync(h, message, count_lane_confirmation, (void*)message);
+    }
+}
+
+/*_DoWork calls until the fake transport got the alarm out*/
+static size_t do_work_until_the_alarm_is_sent(IOTHUB_CLIENT_LL_HANDLE h)
+{
+    size_t result = 0;
+    while ((g_alarms_sent == 0) && (result <= TEST_BACKLOG_MESSAGES))
+    {
+        IoTHubClient_LL_DoWork(h);
+        result++;
+    }
+    return result;
+}
+
+static size_t count_waiting_to_send(IOTHUB_MESSAGE_HANDLE message)
+{
+    size_t result = 0;
+    PDLIST_ENTRY entry;
+    for (entry = g_waitingToSend->Flink; entry != g_waitingToSend; entry = entry->Flink)
+    {
+        if (containingRecord(entry, IOTHUB_MESSAGE_LIST, entry)->context == (void*)message)
+        {
+            result++;
+        }
+    }
+    return result;
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_040: [ `OPTION_PRIORITY_LANES` - `value` is a pointer to an `IOTHUB_CLIENT_PRIORITY_LANES_CONFIG` that is copied; setting it again keeps the events already queued in the lanes. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_priority_lanes_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(DList_InitializeListHead(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InitializeListHead(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InitializeListHead(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_PRIORITY_LANES, &TEST_PRIORITY_LANES_CONFIG);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_040: [ `OPTION_PRIORITY_LANES` - `value` is a pointer to an `IOTHUB_CLIENT_PRIORITY_LANES_CONFIG` that is copied; setting it again keeps the events already queued in the lanes. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_priority_lanes_again_keeps_the_queued_events)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_priority_lanes(&TEST_PRIORITY_LANES_CONFIG);
+    send_events(h, TEST_MESSAGE_HANDLE, 3);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_PRIORITY_LANES, &TEST_PRIORITY_LANES_CONFIG);
+    IoTHubClient_LL_DoWork(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 3, count_waiting_to_send(TEST_MESSAGE_HANDLE));
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_041: [ If `send_window` or the `weight` of any lane is 0, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_priority_lanes_with_0_send_window_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PRIORITY_LANES_CONFIG config = TEST_PRIORITY_LANES_CONFIG;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    config.send_window = 0;
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_PRIORITY_LANES, &config);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_041: [ If `send_window` or the `weight` of any lane is 0, `IoTHubClient_LL_SetOption` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_priority_lanes_with_0_weight_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_PRIORITY_LANES_CONFIG config = TEST_PRIORITY_LANES_CONFIG;
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    config.lanes[IOTHUB_MESSAGE_PRIORITY_LOW].weight = 0;
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_PRIORITY_LANES, &config);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_034: [ If priority lanes are set, `IoTHubClient_LL_SendEventAsync` shall queue the new record in the lane of `IoTHubMessage_GetPriority` instead of waitingToSend, timing out after the `message_timeout_ms` of the lane unless that is 0. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_with_priority_lanes_queues_in_the_lane)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_priority_lanes(&TEST_PRIORITY_LANES_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPriority(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_Diagnostic_AddIfNecessary(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, count_lane_confirmation, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(DList_IsListEmpty(g_waitingToSend) != 0);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_034: [ If priority lanes are set, `IoTHubClient_LL_SendEventAsync` shall queue the new record in the lane of `IoTHubMessage_GetPriority` instead of waitingToSend, timing out after the `message_timeout_ms` of the lane unless that is 0. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_99_038: [ Events still in a priority lane shall time out the same way as the ones in waitingToSend. ]*/
+TEST_FUNCTION(IoTHubClient_LL_DoWork_times_out_events_with_the_timeout_of_their_lane)
+{
+    //arrange
+    IOTHUB_CLIENT_PRIORITY_LANES_CONFIG config = TEST_PRIORITY_LANES_CONFIG;
+    IOTHUB_CLIENT_LL_HANDLE h;
+    config.send_window = 1;
+    config.lanes[IOTHUB_MESSAGE_PRIORITY_LOW].message_timeout_ms = 1500;
+    h = create_client_with_priority_lanes(&config);
+    send_events(h, TEST_ALARM_MESSAGE_HANDLE, 1);
+    send_events(h, TEST_LOW_PRIORITY_MESSAGE_HANDLE, 1);
+    IoTHubClient_LL_DoWork(h); /*the alarm takes the window, the LOW event stays in its lane*/
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubClient_LL_DoWork(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 1, g_lane_confirmations);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_CONFIRMATION_RESULT, IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT, g_lane_last_confirmation);
+    ASSERT_ARE_EQUAL(size_t, 1, count_waiting_to_send(TEST_ALARM_MESSAGE_HANDLE));
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_035: [ If the lane would then hold more than `max_bytes` payload bytes, `IoTHubClient_LL_SendEventAsync` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_fails_when_the_lane_is_full)
+{
+    //arrange
+    IOTHUB_CLIENT_PRIORITY_LANES_CONFIG config = TEST_PRIORITY_LANES_CONFIG;
+    IOTHUB_CLIENT_LL_HANDLE h;
+    config.lanes[IOTHUB_MESSAGE_PRIORITY_NORMAL].max_bytes = 2 * TEST_LANE_MESSAGE_SIZE;
+    h = create_client_with_priority_lanes(&config);
+    send_events(h, TEST_MESSAGE_HANDLE, 2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetPriority(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, NULL, NULL);
+    IOTHUB_CLIENT_RESULT otherLane = IoTHubClient_LL_SendEventAsync(h, TEST_ALARM_MESSAGE_HANDLE, NULL, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, otherLane);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_035: [ If the lane would then hold more than `max_bytes` payload bytes, `IoTHubClient_LL_SendEventAsync` shall fail and return `IOTHUB_CLIENT_ERROR`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_has_room_again_once_the_lane_is_drained)
+{
+    //arrange
+    IOTHUB_CLIENT_PRIORITY_LANES_CONFIG config = TEST_PRIORITY_LANES_CONFIG;
+    IOTHUB_CLIENT_LL_HANDLE h;
+    config.lanes[IOTHUB_MESSAGE_PRIORITY_NORMAL].max_bytes = 2 * TEST_LANE_MESSAGE_SIZE;
+    h = create_client_with_priority_lanes(&config);
+    send_events(h, TEST_MESSAGE_HANDLE, 2);
+    IoTHubClient_LL_DoWork(h);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, NULL, NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_036: [ If priority lanes are set, `IoTHubClient_LL_DoWork` shall move events from the lanes to waitingToSend, in the order they were sent within a lane, until `send_window` events are in waitingToSend. ]*/
+TEST_FUNCTION(IoTHubClient_LL_DoWork_fills_waitingToSend_up_to_the_send_window)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_priority_lanes(&TEST_PRIORITY_LANES_CONFIG);
+    send_events(h, TEST_MESSAGE_HANDLE, 25);
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubClient_LL_DoWork(h);
+    IoTHubClient_LL_DoWork(h); /*the transport took nothing, so nothing more is moved*/
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, TEST_PRIORITY_LANES_CONFIG.send_window, count_waiting_to_send(TEST_MESSAGE_HANDLE));
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_037: [ Each event shall be taken from the highest lane that has events and credit left, using one credit of that lane; when no lane that has events has credit left, every lane shall get its `weight` as credit again. ]*/
+TEST_FUNCTION(IoTHubClient_LL_DoWork_sends_the_higher_lanes_first_without_starving_the_lower_ones)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_priority_lanes(&TEST_PRIORITY_LANES_CONFIG);
+    send_events(h, TEST_LOW_PRIORITY_MESSAGE_HANDLE, 20);
+    send_events(h, TEST_MESSAGE_HANDLE, 20);
+    send_events(h, TEST_ALARM_MESSAGE_HANDLE, 20);
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubClient_LL_DoWork(h);
+
+    //assert
+    /*a window of 10 with weights 4:2:1 is HIGH x4, NORMAL x2, LOW x1, then HIGH x3 on the new credit*/
+    ASSERT_ARE_EQUAL(size_t, 7, count_waiting_to_send(TEST_ALARM_MESSAGE_HANDLE));
+    ASSERT_ARE_EQUAL(size_t, 2, count_waiting_to_send(TEST_MESSAGE_HANDLE));
+    ASSERT_ARE_EQUAL(size_t, 1, count_waiting_to_send(TEST_LOW_PRIORITY_MESSAGE_HANDLE));
+    ASSERT_IS_TRUE(containingRecord(g_waitingToSend->Flink, IOTHUB_MESSAGE_LIST, entry)->context == (void*)TEST_ALARM_MESSAGE_HANDLE);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_039: [ If the underlaying layer reports `IOTHUB_CLIENT_SEND_STATUS_IDLE` but a priority lane still has events, `IoTHubClient_LL_GetSendStatus` shall report `IOTHUB_CLIENT_SEND_STATUS_BUSY`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetSendStatus_is_BUSY_while_a_lane_has_events)
+{
+    //arrange
+    IOTHUB_CLIENT_STATUS status = IOTHUB_CLIENT_SEND_STATUS_IDLE;
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_priority_lanes(&TEST_PRIORITY_LANES_CONFIG);
+    send_events(h, TEST_LOW_PRIORITY_MESSAGE_HANDLE, 1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_GetSendStatus(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetSendStatus(h, &status);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_STATUS, IOTHUB_CLIENT_SEND_STATUS_BUSY, status);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_033: [ `IoTHubClient_LL_Destroy` shall complete the event message callbacks still in the priority lanes with `IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY`. ]*/
+TEST_FUNCTION(IoTHubClient_LL_Destroy_completes_the_events_in_the_priority_lanes)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_priority_lanes(&TEST_PRIORITY_LANES_CONFIG);
+    send_events(h, TEST_LOW_PRIORITY_MESSAGE_HANDLE, 2);
+    send_events(h, TEST_ALARM_MESSAGE_HANDLE, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubClient_LL_Destroy(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 3, g_lane_confirmations);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_CONFIRMATION_RESULT, IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, g_lane_last_confirmation);
+}
+
+/*the latency of an alarm sent behind a backlog, in _DoWork calls of a transport that gets 10 events out per call*/
+TEST_FUNCTION(IoTHubClient_LL_alarm_latency_under_backlog_without_priority_lanes)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    send_events(h, TEST_MESSAGE_HANDLE, TEST_BACKLOG_MESSAGES);
+    send_events(h, TEST_ALARM_MESSAGE_HANDLE, 1);
+    g_transport_sends_per_do_work = TEST_PRIORITY_LANES_CONFIG.send_window;
+    umock_c_reset_all_calls();
+
+    //act
+    size_t latency = do_work_until_the_alarm_is_sent(h);
+
+    //assert
+    /*the single FIFO makes the alarm wait for the whole backlog*/
+    ASSERT_ARE_EQUAL(size_t, TEST_BACKLOG_MESSAGES / TEST_PRIORITY_LANES_CONFIG.send_window + 1, latency);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_99_037: [ Each event shall be taken from the highest lane that has events and credit left, using one credit of that lane; when no lane that has events has credit left, every lane shall get its `weight` as credit again. ]*/
+TEST_FUNCTION(IoTHubClient_LL_alarm_latency_under_backlog_with_priority_lanes)
+{
+    //arrange
+    size_t latency;
+    IOTHUB_CLIENT_LL_HANDLE h = create_client_with_priority_lanes(&TEST_PRIORITY_LANES_CONFIG);
+    send_events(h, TEST_MESSAGE_HANDLE, TEST_BACKLOG_MESSAGES);
+    send_events(h, TEST_LOW_PRIORITY_MESSAGE_HANDLE, TEST_BACKLOG_MESSAGES);
+    g_transport_sends_per_do_work = TEST_PRIORITY_LANES_CONFIG.send_window;
+    IoTHubClient_LL_DoWork(h); /*the backlog is being drained when the alarm comes*/
+    send_events(h, TEST_ALARM_MESSAGE_HANDLE, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    latency = do_work_until_the_alarm_is_sent(h);
+
+    //assert
+    /*the alarm only waits for the send window, which the transport takes in one _DoWork*/
+    ASSERT_ARE_EQUAL(size_t, 1, latency);
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
 
 END_TEST_SUITE(iothubclient_ll_ut)
@@ -122,6 +122,15 @@ static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT my_FileUpload_GetData_CallbackE
     return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
 }
 
+static IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_RESULT my_FileUpload_FillSlice_Callback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char* slice, size_t* size, void* context)
+{
+    (void)slice;
+    (void)size;
+    (void)context;
+    (void)result;
+    return IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_OK;
+}
+
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
@@ -425,6 +434,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK_EX, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_FILL_SLICE_CALLBACK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(THREADAPI_RESULT, int);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
@@ -2727,7 +2737,14 @@ TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_fails_when_getDataCal
     IoTHubClient_Destroy(iothub_handle);
 }
 
-static void IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(bool exCall)
+typedef enum UPLOAD_MULTIPLE_BLOCKS_CALL_TAG
+{
+    UPLOAD_MULTIPLE_BLOCKS,
+    UPLOAD_MULTIPLE_BLOCKS_EX,
+    UPLOAD_SLICES
+} UPLOAD_MULTIPLE_BLOCKS_CALL;
+
+static void IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(UPLOAD_MULTIPLE_BLOCKS_CALL call)
 {
     ///arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
@@ -2746,7 +2763,13 @@ static void IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(bool exCa
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     /* thread uploading function */
-    if (exCall)
+    if (call == UPLOAD_SLICES)
+    {
+        STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadSlicesToBlob(IGNORED_PTR_ARG, IGNORED_PTR_ARG, my_FileUpload_FillSlice_Callback, &context))
+            .IgnoreArgument_iotHubClientHandle()
+            .IgnoreArgument_destinationFileName();
+    }
+    else if (call == UPLOAD_MULTIPLE_BLOCKS_EX)
     {
         STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadMultipleBlocksToBlobEx(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     }
@@ -2760,7 +2783,11 @@ static void IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(bool exCa
 
     ///act
     IOTHUB_CLIENT_RESULT result;
-    if (exCall)
+    if (call == UPLOAD_SLICES)
+    {
+        result = IoTHubClient_UploadSlicesToBlobAsync(iothub_handle, "someFileName.txt", my_FileUpload_FillSlice_Callback, &context);
+    }
+    else if (call == UPLOAD_MULTIPLE_BLOCKS_EX)
     {
         result = IoTHubClient_UploadMultipleBlocksToBlobAsyncEx(iothub_handle, "someFileName.txt", my_FileUpload_GetData_CallbackEx, &context);
     }
@@ -2798,7 +2825,7 @@ static void IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(bool exCa
 /*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure and spawning the thread succeeds, then IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex) shall return IOTHUB_CLIENT_OK. ]*/
 TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds)
 {
-    IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(false);
+    IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(UPLOAD_MULTIPLE_BLOCKS);
 }
 
 /*Tests_SRS_IOTHUBCLIENT_99_075: [ IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex) shall copy the destinationFileName, getDataCallback, context  and iotHubClientHandle into a structure. ]*/
@@ -2807,7 +2834,32 @@ TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds)
 /*Tests_SRS_IOTHUBCLIENT_99_077: [ If copying to the structure and spawning the thread succeeds, then IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex) shall return IOTHUB_CLIENT_OK. ]*/
 TEST_FUNCTION(IoTHubClient_UploadMultipleBlocksToBlobAsyncEx_succeeds)
 {
-    IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(true);
+    IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(UPLOAD_MULTIPLE_BLOCKS_EX);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_99_078: [ The thread shall call `IoTHubClient_LL_UploadMultipleBlocksToBlob`, `IoTHubClient_LL_UploadMultipleBlocksToBlobEx` or `IoTHubClient_LL_UploadSlicesToBlob` passing the information packed in the structure. ]*/
+TEST_FUNCTION(IoTHubClient_UploadSlicesToBlobAsync_succeeds)
+{
+    IoTHubClient_UploadMultipleBlocksToBlobAsync_succeeds_Impl(UPLOAD_SLICES);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_99_074: [ If `getDataCallback` is `NULL` then `IoTHubClient_UploadMultipleBlocksToBlobAsync(Ex)` shall fail and return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_UploadSlicesToBlobAsync_with_NULL_callback_fails)
+{
+    ///arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    int context = 1;
+    umock_c_reset_all_calls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_UploadSlicesToBlobAsync(iothub_handle, "someFileName.txt", NULL, &context);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_Destroy(iothub_handle);
 }
 
 
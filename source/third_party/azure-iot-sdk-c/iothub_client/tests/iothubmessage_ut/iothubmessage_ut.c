@@ -72,6 +72,14 @@ static const char* TEST_INVALID_MAP_VALUE = "Inval\nd_value";
 static const char* TEST_CONTENT_TYPE = "text/plain";
 static const char* TEST_CONTENT_ENCODING = "utf8";
 
+static const LOCK_HANDLE TEST_LOCK_HANDLE = (LOCK_HANDLE)0x4242;
+static const unsigned char TEST_POOL_PAYLOAD[16] = { 'p', 'o', 'o', 'l', 'e', 'd', ' ', 'p', 'a', 'y', 'l', 'o', 'a', 'd', '!', '!' };
+#define TEST_POOL_SLOT_SIZE     96
+#define TEST_POOL_INLINE_SIZE   80
+#define TEST_MAP_IN_PLACE_SIZE  64
+static const char* TEST_PROPERTY_KEYS[] = { "temperature" };
+static const char* TEST_PROPERTY_VALUES[] = { "21.5" };
+
 static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA TEST_DIAGNOSTIC_DATA = { "12345678",  "1506054179"};
 static IOTHUB_MESSAGE_DIAGNOSTIC_PROPERTY_DATA TEST_DIAGNOSTIC_DATA2 = { "87654321", "1506054179.100" };
 
@@ -81,6 +89,9 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_RESULT_VALUES)
 TEST_DEFINE_ENUM_TYPE(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUES);
 IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUES);
 
+TEST_DEFINE_ENUM_TYPE(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_VALUES);
+
 DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
 
 static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
@@ -102,6 +113,26 @@ static MAP_HANDLE my_Map_Clone(MAP_HANDLE handle)
     return (MAP_HANDLE)my_gballoc_malloc(1);
 }
 
+static void* g_mapInPlaceStorage;
+
+static MAP_HANDLE my_Map_CreateInPlace(MAP_FILTER_CALLBACK mapFilterFunc, void* storage, size_t storageSize, size_t inlineEntries)
+{
+    (void)storageSize;
+    (void)inlineEntries;
+    g_mapFilterFunc = mapFilterFunc;
+    g_mapInPlaceStorage = storage;
+    return (MAP_HANDLE)my_gballoc_malloc(1);
+}
+
+static MAP_RESULT my_Map_GetInternals(MAP_HANDLE handle, const char*const** keys, const char*const** values, size_t* count)
+{
+    (void)handle;
+    *keys = TEST_PROPERTY_KEYS;
+    *values = TEST_PROPERTY_VALUES;
+    *count = sizeof(TEST_PROPERTY_KEYS) / sizeof(TEST_PROPERTY_KEYS[0]);
+    return MAP_OK;
+}
+
 static void my_Map_Destroy(MAP_HANDLE handle)
 {
     my_gballoc_free(handle);
@@ -138,6 +169,9 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(MAP_RESULT, int);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
@@ -162,11 +196,23 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(Map_Clone, my_Map_Clone);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_Clone, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(Map_Destroy, my_Map_Destroy);
+    REGISTER_GLOBAL_MOCK_RETURN(Map_GetInPlaceSize, TEST_MAP_IN_PLACE_SIZE);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_CreateInPlace, my_Map_CreateInPlace);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_CreateInPlace, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(Map_GetInternals, my_Map_GetInternals);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_GetInternals, MAP_ERROR);
+    REGISTER_GLOBAL_MOCK_RETURN(Map_Add, MAP_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_Add, MAP_ERROR);
     REGISTER_GLOBAL_MOCK_RETURN(Map_AddOrUpdate, MAP_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(Map_AddOrUpdate, MAP_ERROR);
 
     REGISTER_GLOBAL_MOCK_HOOK(mallocAndStrcpy_s, my_mallocAndStrcpy_s);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __FAILURE__);
+
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
 }
 
 TEST_SUITE_CLEANUP(suite_cleanup)
@@ -190,6 +236,7 @@ TEST_FUNCTION_INITIALIZE(method_init)
 
 TEST_FUNCTION_CLEANUP(method_cleanup)
 {
+    IoTHubMessage_DeinitPool();
     TEST_MUTEX_RELEASE(g_testByTest);
 }
 
@@ -1584,5 +1631,612 @@ TEST_FUNCTION(IoTHubMessage_SetDiagnosticPropertyData_SUCCEED)
     IoTHubMessage_Destroy(h);
 }
 
+/* Tests_SRS_IOTHUBMESSAGE_99_001: [ A new message shall have the priority IOTHUB_MESSAGE_PRIORITY_NORMAL. ]*/
+TEST_FUNCTION(IoTHubMessage_GetPriority_defaults_to_NORMAL)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h1 = IoTHubMessage_CreateFromByteArray(c, 1);
+    IOTHUB_MESSAGE_HANDLE h2 = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_PRIORITY result1 = IoTHubMessage_GetPriority(h1);
+    IOTHUB_MESSAGE_PRIORITY result2 = IoTHubMessage_GetPriority(h2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_NORMAL, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_NORMAL, result2);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h1);
+    IoTHubMessage_Destroy(h2);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_003: [ If iotHubMessageHandle is NULL or priority is not one of the IOTHUB_MESSAGE_PRIORITY values, IoTHubMessage_SetPriority shall return IOTHUB_MESSAGE_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubMessage_SetPriority_NULL_handle_fails)
+{
+    //arrange
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetPriority(NULL, IOTHUB_MESSAGE_PRIORITY_HIGH);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_003: [ If iotHubMessageHandle is NULL or priority is not one of the IOTHUB_MESSAGE_PRIORITY values, IoTHubMessage_SetPriority shall return IOTHUB_MESSAGE_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubMessage_SetPriority_unknown_priority_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetPriority(h, (IOTHUB_MESSAGE_PRIORITY)(IOTHUB_MESSAGE_PRIORITY_HIGH + 1));
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_NORMAL, IoTHubMessage_GetPriority(h));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_004: [ Otherwise IoTHubMessage_SetPriority shall store priority in the message and return IOTHUB_MESSAGE_OK. ]*/
+/* Tests_SRS_IOTHUBMESSAGE_99_006: [ Otherwise IoTHubMessage_GetPriority shall return the priority of the message. ]*/
+TEST_FUNCTION(IoTHubMessage_SetPriority_succeeds)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetPriority(h, IOTHUB_MESSAGE_PRIORITY_HIGH);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_HIGH, IoTHubMessage_GetPriority(h));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_005: [ If iotHubMessageHandle is NULL, IoTHubMessage_GetPriority shall return IOTHUB_MESSAGE_PRIORITY_NORMAL. ]*/
+TEST_FUNCTION(IoTHubMessage_GetPriority_NULL_handle_returns_NORMAL)
+{
+    //arrange
+
+    //act
+    IOTHUB_MESSAGE_PRIORITY result = IoTHubMessage_GetPriority(NULL);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_NORMAL, result);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_002: [ IoTHubMessage_Clone shall copy the priority of the source message. ]*/
+TEST_FUNCTION(IoTHubMessage_Clone_copies_priority)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(c, 1);
+    IOTHUB_MESSAGE_HANDLE clone;
+    (void)IoTHubMessage_SetPriority(h, IOTHUB_MESSAGE_PRIORITY_LOW);
+    umock_c_reset_all_calls();
+
+    //act
+    clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(clone);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_LOW, IoTHubMessage_GetPriority(clone));
+
+    //cleanup
+    IoTHubMessage_Destroy(clone);
+    IoTHubMessage_Destroy(h);
+}
+
+static void init_test_pool(size_t slot_count)
+{
+    IOTHUB_MESSAGE_POOL_CONFIG config;
+    config.slot_count = slot_count;
+    config.slot_size = TEST_POOL_SLOT_SIZE;
+    config.inline_size = TEST_POOL_INLINE_SIZE;
+    config.property_count = 0;
+    config.property_size = 0;
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessage_InitPool(&config));
+}
+
+static void init_test_pool_with_properties(size_t slot_count)
+{
+    IOTHUB_MESSAGE_POOL_CONFIG config;
+    config.slot_count = slot_count;
+    config.slot_size = TEST_POOL_SLOT_SIZE;
+    config.inline_size = TEST_POOL_INLINE_SIZE;
+    config.property_count = 2;
+    config.property_size = 32;
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessage_InitPool(&config));
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_007: [ If config is NULL, or slot_count is not 0 and slot_size is 0 or smaller than inline_size, IoTHubMessage_InitPool shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubMessage_InitPool_invalid_config_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_POOL_CONFIG config;
+    config.slot_count = 4;
+    config.slot_size = TEST_POOL_INLINE_SIZE - 1;
+    config.inline_size = TEST_POOL_INLINE_SIZE;
+    config.property_count = 0;
+    config.property_size = 0;
+
+    //act
+    int nullResult = IoTHubMessage_InitPool(NULL);
+    int smallResult = IoTHubMessage_InitPool(&config);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, nullResult);
+    ASSERT_ARE_NOT_EQUAL(int, 0, smallResult);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_009: [ IoTHubMessage_InitPool shall allocate the pool and all its slots in a single block and create a lock for it; if either fails it shall return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubMessage_InitPool_succeeds)
+{
+    //arrange
+    IOTHUB_MESSAGE_POOL_CONFIG config;
+    IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+    config.slot_count = 4;
+    config.slot_size = TEST_POOL_SLOT_SIZE;
+    config.inline_size = TEST_POOL_INLINE_SIZE;
+    config.property_count = 0;
+    config.property_size = 0;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    //act
+    int result = IoTHubMessage_InitPool(&config);
+
+    //assert
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessage_GetPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.slots_in_use);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.pool_allocations);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_009: [ IoTHubMessage_InitPool shall allocate the pool and all its slots in a single block and create a lock for it; if either fails it shall return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubMessage_InitPool_Lock_Init_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_POOL_CONFIG config;
+    IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+    config.slot_count = 4;
+    config.slot_size = TEST_POOL_SLOT_SIZE;
+    config.inline_size = TEST_POOL_INLINE_SIZE;
+    config.property_count = 0;
+    config.property_size = 0;
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init()).SetReturn(NULL);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    int result = IoTHubMessage_InitPool(&config);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, IoTHubMessage_GetPoolStatistics(&statistics));
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_008: [ If the pool is already set up, IoTHubMessage_InitPool shall fail and return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubMessage_InitPool_twice_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_POOL_CONFIG config;
+    init_test_pool(4);
+    config.slot_count = 4;
+    config.slot_size = TEST_POOL_SLOT_SIZE;
+    config.inline_size = TEST_POOL_INLINE_SIZE;
+    config.property_count = 0;
+    config.property_size = 0;
+    umock_c_reset_all_calls();
+
+    //act
+    int result = IoTHubMessage_InitPool(&config);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_010: [ Once the pool is set up, IoTHubMessage_CreateFromByteArray, IoTHubMessage_CreateFromString and IoTHubMessage_Clone shall place the handle, the content and inline_size bytes for the system properties in a single block. ]*/
+/* Tests_SRS_IOTHUBMESSAGE_99_011: [ The block shall be a free slot of the pool when the content and the inline storage fit in slot_size, otherwise it shall be allocated from the heap. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_with_pool_takes_a_slot)
+{
+    //arrange
+    IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+    const unsigned char* buffer;
+    size_t size;
+    init_test_pool(4);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(h, &buffer, &size));
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_POOL_PAYLOAD), size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, TEST_POOL_PAYLOAD, size));
+    ASSERT_IS_NOT_NULL(IoTHubMessage_Properties(h));
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessage_GetPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.slots_in_use);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.pool_allocations);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.heap_allocations);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_011: [ The block shall be a free slot of the pool when the content and the inline storage fit in slot_size, otherwise it shall be allocated from the heap. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_too_big_for_a_slot_uses_one_heap_block)
+{
+    //arrange
+    unsigned char payload[TEST_POOL_SLOT_SIZE];
+    IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+    const unsigned char* buffer;
+    size_t size;
+    memset(payload, 'x', sizeof(payload));
+    init_test_pool(4);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(payload, sizeof(payload));
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(h, &buffer, &size));
+    ASSERT_ARE_EQUAL(size_t, sizeof(payload), size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, payload, size));
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessage_GetPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.slots_in_use);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.heap_allocations);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_010: [ Once the pool is set up, IoTHubMessage_CreateFromByteArray, IoTHubMessage_CreateFromString and IoTHubMessage_Clone shall place the handle, the content and inline_size bytes for the system properties in a single block. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromString_without_slots_packs_the_message)
+{
+    //arrange
+    IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+    init_test_pool(0);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromString(TEST_STRING_VALUE);
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, TEST_STRING_VALUE, IoTHubMessage_GetString(h));
+    ASSERT_ARE_EQUAL(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_STRING, IoTHubMessage_GetContentType(h));
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessage_GetPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.heap_allocations);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_012: [ The system properties of a packed message shall be copied in its inline storage while it has room, and with mallocAndStrcpy_s otherwise. ]*/
+TEST_FUNCTION(IoTHubMessage_SetMessageId_on_a_packed_message_copies_inline)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h;
+    init_test_pool(4);
+    h = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT first = IoTHubMessage_SetMessageId(h, TEST_MESSAGE_ID);
+    IOTHUB_MESSAGE_RESULT second = IoTHubMessage_SetMessageId(h, TEST_MESSAGE_ID2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, first);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, second);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID2, IoTHubMessage_GetMessageId(h));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_012: [ The system properties of a packed message shall be copied in its inline storage while it has room, and with mallocAndStrcpy_s otherwise. ]*/
+TEST_FUNCTION(IoTHubMessage_SetContentTypeSystemProperty_on_a_full_packed_message_uses_mallocAndStrcpy_s)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h;
+    init_test_pool(0);
+    h = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+    (void)IoTHubMessage_SetMessageId(h, TEST_MESSAGE_ID);
+    (void)IoTHubMessage_SetCorrelationId(h, TEST_MESSAGE_ID2);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, TEST_CONTENT_TYPE));
+
+    //act
+    IOTHUB_MESSAGE_RESULT result = IoTHubMessage_SetContentTypeSystemProperty(h, TEST_CONTENT_TYPE);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID, IoTHubMessage_GetMessageId(h));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID2, IoTHubMessage_GetCorrelationId(h));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_CONTENT_TYPE, IoTHubMessage_GetContentTypeSystemProperty(h));
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_010: [ Once the pool is set up, IoTHubMessage_CreateFromByteArray, IoTHubMessage_CreateFromString and IoTHubMessage_Clone shall place the handle, the content and inline_size bytes for the system properties in a single block. ]*/
+/* Tests_SRS_IOTHUBMESSAGE_99_002: [ IoTHubMessage_Clone shall copy the priority of the source message. ]*/
+TEST_FUNCTION(IoTHubMessage_Clone_with_pool_copies_into_one_slot)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h;
+    IOTHUB_MESSAGE_HANDLE clone;
+    const unsigned char* buffer;
+    size_t size;
+    init_test_pool(4);
+    h = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+    (void)IoTHubMessage_SetMessageId(h, TEST_MESSAGE_ID);
+    (void)IoTHubMessage_SetDiagnosticPropertyData(h, &TEST_DIAGNOSTIC_DATA);
+    (void)IoTHubMessage_SetPriority(h, IOTHUB_MESSAGE_PRIORITY_HIGH);
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+
+    //act
+    clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(clone, &buffer, &size));
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_POOL_PAYLOAD), size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, TEST_POOL_PAYLOAD, size));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_MESSAGE_ID, IoTHubMessage_GetMessageId(clone));
+    ASSERT_ARE_EQUAL(char_ptr, TEST_DIAGNOSTIC_DATA.diagnosticId, IoTHubMessage_GetDiagnosticPropertyData(clone)->diagnosticId);
+    ASSERT_ARE_EQUAL(char_ptr, TEST_DIAGNOSTIC_DATA.diagnosticCreationTimeUtc, IoTHubMessage_GetDiagnosticPropertyData(clone)->diagnosticCreationTimeUtc);
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_PRIORITY, IOTHUB_MESSAGE_PRIORITY_HIGH, IoTHubMessage_GetPriority(clone));
+
+    //cleanup
+    IoTHubMessage_Destroy(clone);
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_018: [ When property_count is not 0, the properties of a packed message shall be created with Map_CreateInPlace in its block, and IoTHubMessage_Clone shall copy the properties of the source into them with Map_GetInternals and Map_Add. ]*/
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_with_a_property_table_creates_the_properties_in_the_slot)
+{
+    //arrange
+    const unsigned char* buffer;
+    size_t size;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Map_GetInPlaceSize(2));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    init_test_pool_with_properties(4);
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Map_CreateInPlace(IGNORED_PTR_ARG, IGNORED_PTR_ARG, TEST_MAP_IN_PLACE_SIZE + 32, 2));
+    g_mapInPlaceStorage = NULL;
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(h, &buffer, &size));
+    ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, TEST_POOL_PAYLOAD, size));
+    /*the table follows the content in the same block*/
+    ASSERT_ARE_EQUAL(void_ptr, (void*)(buffer + sizeof(TEST_POOL_PAYLOAD)), g_mapInPlaceStorage);
+    ASSERT_IS_NOT_NULL(g_mapFilterFunc);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_018: [ When property_count is not 0, the properties of a packed message shall be created with Map_CreateInPlace in its block, and IoTHubMessage_Clone shall copy the properties of the source into them with Map_GetInternals and Map_Add. ]*/
+TEST_FUNCTION(IoTHubMessage_Clone_with_a_property_table_copies_the_properties)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h;
+    IOTHUB_MESSAGE_HANDLE clone;
+    init_test_pool_with_properties(4);
+    h = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Map_CreateInPlace(IGNORED_PTR_ARG, IGNORED_PTR_ARG, TEST_MAP_IN_PLACE_SIZE + 32, 2));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_Add(IGNORED_PTR_ARG, "temperature", "21.5"));
+
+    //act
+    clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubMessage_Destroy(clone);
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_018: [ When property_count is not 0, the properties of a packed message shall be created with Map_CreateInPlace in its block, and IoTHubMessage_Clone shall copy the properties of the source into them with Map_GetInternals and Map_Add. ]*/
+TEST_FUNCTION(IoTHubMessage_Clone_with_a_property_table_fails_when_Map_Add_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h;
+    IOTHUB_MESSAGE_HANDLE clone;
+    IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+    init_test_pool_with_properties(4);
+    h = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Map_CreateInPlace(IGNORED_PTR_ARG, IGNORED_PTR_ARG, TEST_MAP_IN_PLACE_SIZE + 32, 2));
+    STRICT_EXPECTED_CALL(Map_GetInternals(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_Add(IGNORED_PTR_ARG, "temperature", "21.5")).SetReturn(MAP_ERROR);
+    STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessage_GetPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.slots_in_use);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_013: [ IoTHubMessage_Destroy shall give the slot of a packed message back to the pool, or free its block when it came from the heap. ]*/
+/* Tests_SRS_IOTHUBMESSAGE_99_016: [ Otherwise IoTHubMessage_GetPoolStatistics shall copy the counters of the pool in statistics and return 0. ]*/
+TEST_FUNCTION(IoTHubMessage_Destroy_gives_the_slot_back)
+{
+    //arrange
+    IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+    IOTHUB_MESSAGE_HANDLE first;
+    IOTHUB_MESSAGE_HANDLE second;
+    init_test_pool(1);
+    first = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+
+    //act
+    IoTHubMessage_Destroy(first);
+    second = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+
+    //assert
+    ASSERT_ARE_EQUAL(void_ptr, (void*)first, (void*)second);
+    ASSERT_ARE_EQUAL(int, 0, IoTHubMessage_GetPoolStatistics(&statistics));
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.slots_in_use);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.max_slots_in_use);
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.pool_allocations);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.heap_allocations);
+
+    //cleanup
+    IoTHubMessage_Destroy(second);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_014: [ IoTHubMessage_DeinitPool shall make new messages use separate allocations again and free the pool once no message is left in its slots. ]*/
+TEST_FUNCTION(IoTHubMessage_DeinitPool_frees_the_pool_when_the_last_slot_comes_back)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h;
+    init_test_pool(4);
+    h = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+    //act
+    IoTHubMessage_DeinitPool();
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //arrange
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(NULL));
+    STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IoTHubMessage_Destroy(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_017: [ When there is no pool, IoTHubMessage_Clone shall copy the content of a packed message with BUFFER_create or STRING_construct. ]*/
+TEST_FUNCTION(IoTHubMessage_Clone_of_a_packed_message_without_pool_uses_BUFFER_create)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h;
+    IOTHUB_MESSAGE_HANDLE clone;
+    const unsigned char* buffer;
+    size_t size;
+    init_test_pool(4);
+    h = IoTHubMessage_CreateFromByteArray(TEST_POOL_PAYLOAD, sizeof(TEST_POOL_PAYLOAD));
+    IoTHubMessage_DeinitPool();
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, sizeof(TEST_POOL_PAYLOAD)));
+    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+
+    //act
+    clone = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(clone);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(clone, &buffer, &size));
+    ASSERT_ARE_EQUAL(size_t, sizeof(TEST_POOL_PAYLOAD), size);
+    ASSERT_ARE_EQUAL(int, 0, memcmp(buffer, TEST_POOL_PAYLOAD, size));
+
+    //cleanup
+    IoTHubMessage_Destroy(clone);
+    IoTHubMessage_Destroy(h);
+}
+
+/* Tests_SRS_IOTHUBMESSAGE_99_015: [ If statistics is NULL or the pool is not set up, IoTHubMessage_GetPoolStatistics shall return a non-zero value. ]*/
+TEST_FUNCTION(IoTHubMessage_GetPoolStatistics_without_pool_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+
+    //act
+    int result = IoTHubMessage_GetPoolStatistics(&statistics);
+
+    //assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
 
 END_TEST_SUITE(iothubmessage_ut)
@@ -55,6 +55,7 @@ static int real_strcmp(const char* str1, const char* str2)
 #include "azure_c_shared_utility/umock_c_prod.h"
 #include "azure_c_shared_utility/agenttime.h" 
 #include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/gb_rand.h"
 #include "iothub_client_authorization.h"
 #undef ENABLE_MOCKS
 
@@ -1264,6 +1265,53 @@ TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh)
     authentication_destroy(handle);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_129: [If name matches AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, `value` shall be saved on `instance->sas_token_refresh_jitter_secs`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_130: [If `instance->sas_token_refresh_jitter_secs` is not zero, `instance->current_sas_token_refresh_advance_secs` shall be set to a random value between 0 and `instance->sas_token_refresh_jitter_secs` using gb_rand()]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_131: [The SAS token shall be refreshed `instance->current_sas_token_refresh_advance_secs` earlier than `instance->sas_token_refresh_time_secs`]
+TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh_with_jitter)
+{
+    // arrange
+    AUTHENTICATION_CONFIG* config = get_auth_config(USE_DEVICE_KEYS);
+    AUTHENTICATION_HANDLE handle = create_and_start_authentication(config);
+
+    time_t current_time = time(NULL);
+    time_t next_time = add_seconds(current_time, DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS - 45);
+    ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != next_time, "failed to computer 'next_time'");
+
+    size_t jitter_secs = 60;
+    int result = authentication_set_option(handle, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, &jitter_secs);
+    ASSERT_ARE_EQUAL_WITH_MSG(int, 0, result, "authentication_set_option(AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS) failed!");
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
+    set_expected_calls_for_put_SAS_token_to_cbs(handle, current_time, TEST_PRIMARY_DEVICE_KEY_STRING_HANDLE);
+    STRICT_EXPECTED_CALL(gb_rand()).SetReturn(45);
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(TEST_DEVICES_PATH_STRING_HANDLE));
+    authentication_do_work(handle);
+    ASSERT_ARE_EQUAL_WITH_MSG(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls(), "first SAS token put did not pick a refresh jitter");
+    saved_cbs_put_token_on_operation_complete(saved_cbs_put_token_context, CBS_OPERATION_RESULT_OK, 0, "all good");
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG)).SetReturn(IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY);
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(next_time);
+    STRICT_EXPECTED_CALL(get_difftime(next_time, current_time)).SetReturn(DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS - 45);
+    STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
+    set_expected_calls_for_put_SAS_token_to_cbs(handle, next_time, TEST_GENERATED_SAS_TOKEN_STRING_HANDLE);
+    STRICT_EXPECTED_CALL(gb_rand()).SetReturn(0);
+    STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_delete(TEST_DEVICES_PATH_STRING_HANDLE));
+
+    // act
+    authentication_do_work(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    authentication_destroy(handle);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_021: [authentication_create() shall set `instance->cbs_request_timeout_secs` with the default value of UINT32_MAX]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_038: [If `instance->is_cbs_put_token_in_progress` is TRUE, authentication_do_work() shall only verify the authentication timeout]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_043: [authentication_do_work() shall set `instance->is_cbs_put_token_in_progress` to TRUE]
@@ -1536,6 +1584,9 @@ TEST_FUNCTION(authentication_retrieve_options_succeeds)
     STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, AUTHENTICATION_OPTION_SAS_TOKEN_LIFETIME_SECS, IGNORED_PTR_ARG))
         .IgnoreArgument(3)
         .SetReturn(OPTIONHANDLER_OK);
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, IGNORED_PTR_ARG))
+        .IgnoreArgument(3)
+        .SetReturn(OPTIONHANDLER_OK);
 
     // act
     OPTIONHANDLER_HANDLE result = authentication_retrieve_options(handle);
@@ -1573,6 +1624,9 @@ TEST_FUNCTION(authentication_retrieve_options_failure_checks)
     STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, AUTHENTICATION_OPTION_SAS_TOKEN_LIFETIME_SECS, IGNORED_PTR_ARG))
         .IgnoreArgument(3)
         .SetReturn(OPTIONHANDLER_OK);
+    STRICT_EXPECTED_CALL(OptionHandler_AddOption(TEST_OPTIONHANDLER_HANDLE, AUTHENTICATION_OPTION_SAS_TOKEN_REFRESH_JITTER_SECS, IGNORED_PTR_ARG))
+        .IgnoreArgument(3)
+        .SetReturn(OPTIONHANDLER_OK);
     umock_c_negative_tests_snapshot();
 
     // act
@@ -163,6 +163,7 @@ static AMQP_CONNECTION_CONFIG* get_amqp_connection_config()
 	global_amqp_connection_config.is_trace_on = true;
     global_amqp_connection_config.svc2cl_keep_alive_timeout_secs = 123;
 	global_amqp_connection_config.cl2svc_keep_alive_send_ratio   = 0.5;
+	global_amqp_connection_config.cbs_max_outstanding_operations = 0;
 
 	return &global_amqp_connection_config;
 }
@@ -223,6 +224,12 @@ static void set_exp_calls_for_amqp_connection_create(AMQP_CONNECTION_CONFIG* amq
 	if (amqp_connection_config->create_cbs_connection)
 	{
 		STRICT_EXPECTED_CALL(cbs_create(TEST_SESSION_HANDLE));
+
+		if (amqp_connection_config->cbs_max_outstanding_operations != 0)
+		{
+			STRICT_EXPECTED_CALL(cbs_set_max_outstanding_operations(TEST_CBS_HANDLE, amqp_connection_config->cbs_max_outstanding_operations));
+		}
+
 		STRICT_EXPECTED_CALL(cbs_open_async(TEST_CBS_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 	}
 }
@@ -464,6 +471,47 @@ TEST_FUNCTION(amqp_connection_create_SASL_and_CBS_success)
 	amqp_connection_destroy(handle);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_CONNECTION_09_075: [If `config->cbs_max_outstanding_operations` is not zero, it shall be set on `instance->cbs_handle` using cbs_set_max_outstanding_operations()]
+TEST_FUNCTION(amqp_connection_create_with_cbs_max_outstanding_operations_success)
+{
+    // arrange
+	AMQP_CONNECTION_CONFIG* config = get_amqp_connection_config();
+	config->cbs_max_outstanding_operations = 8;
+
+	umock_c_reset_all_calls();
+	set_exp_calls_for_amqp_connection_create(config);
+
+    // act
+	AMQP_CONNECTION_HANDLE handle = amqp_connection_create(config);
+
+    // assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_IS_NOT_NULL(handle);
+
+    // cleanup
+	amqp_connection_destroy(handle);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_CONNECTION_09_076: [If cbs_set_max_outstanding_operations() fails, amqp_connection_create() shall fail and return NULL]
+TEST_FUNCTION(amqp_connection_create_cbs_set_max_outstanding_operations_fails)
+{
+    // arrange
+	AMQP_CONNECTION_CONFIG* config = get_amqp_connection_config();
+	config->cbs_max_outstanding_operations = 8;
+
+	REGISTER_GLOBAL_MOCK_RETURN(cbs_set_max_outstanding_operations, 1);
+	umock_c_reset_all_calls();
+
+    // act
+	AMQP_CONNECTION_HANDLE handle = amqp_connection_create(config);
+
+    // assert
+	ASSERT_IS_NULL(handle);
+
+    // cleanup
+	REGISTER_GLOBAL_MOCK_RETURN(cbs_set_max_outstanding_operations, 0);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_CONNECTION_09_028: [Only if `config->create_cbs_connection` is true, amqp_connection_create() shall create and open the CBS_HANDLE]
 TEST_FUNCTION(amqp_connection_create_SASL_only_success)
 {
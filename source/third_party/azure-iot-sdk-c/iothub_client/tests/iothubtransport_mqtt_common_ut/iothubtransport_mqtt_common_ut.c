@@ -107,12 +107,6 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
     return 0;
 }
 
-static STRING_HANDLE my_URL_Encode(STRING_HANDLE string)
-{
-    (void)string;
-    return (STRING_HANDLE)my_gballoc_malloc(1);
-}
-
 static IOTHUB_CLIENT_RESULT my_IoTHubClient_LL_GetOption(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const char* optionName, void** value)
 {
     (void)iotHubClientHandle;
@@ -344,11 +338,17 @@ static int my_IoTHubClient_LL_DeviceMethodComplete(IOTHUB_CLIENT_LL_HANDLE handl
     return 0;
 }
 
+static size_t g_completed_message_count;
+
 static void my_IoTHubClient_LL_SendComplete(IOTHUB_CLIENT_LL_HANDLE handle, PDLIST_ENTRY completed, IOTHUB_CLIENT_CONFIRMATION_RESULT result)
 {
+    PDLIST_ENTRY current;
     (void)handle;
-    (void)completed;
     (void)result;
+    for (current = completed->Flink; current != completed; current = current->Flink)
+    {
+        g_completed_message_count++;
+    }
 }
 
 static void my_IoTHubClient_LL_ConnectionStatusCallBack(IOTHUB_CLIENT_LL_HANDLE handle, IOTHUB_CLIENT_CONNECTION_STATUS status, IOTHUB_CLIENT_CONNECTION_STATUS_REASON reason)
@@ -655,7 +655,6 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_RETURN(STRING_concat, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_concat, __FAILURE__);
 
-    REGISTER_GLOBAL_MOCK_HOOK(URL_Encode, my_URL_Encode);
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_GetOption, my_IoTHubClient_LL_GetOption);
 
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_Auth_Get_DeviceKey, TEST_DEVICE_KEY);
@@ -812,6 +811,7 @@ TEST_FUNCTION_INITIALIZE(method_init)
     g_method_handle_value = NULL;
 
     g_current_ms = 0;
+    g_completed_message_count = 0;
     g_tokenizerIndex = 0;
     g_nullMapVariable = true;
 
@@ -1019,12 +1019,8 @@ static void setup_initialize_connection_mocks()
     STRICT_EXPECTED_CALL(IoTHubClient_LL_GetOption(IGNORED_PTR_ARG, OPTION_PRODUCT_INFO, IGNORED_PTR_ARG))
         .IgnoreArgument_iotHubClientHandle()
         .IgnoreArgument_value();
-    STRICT_EXPECTED_CALL(URL_Encode(IGNORED_PTR_ARG))
-        .IgnoreArgument_input();
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_s1()
-        .IgnoreArgument_s2();
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)).IgnoreArgument_handle();
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(URL_EncodeConcat(IGNORED_PTR_ARG, TEST_STRING_VALUE));
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_DEVICE_ID);
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
     
@@ -1119,10 +1115,7 @@ static void setup_IoTHubTransport_MQTT_Common_DoWork_events_mocks(
     bool validMessage = true;
     if (diag_id != NULL && creation_time_utc != NULL)
     {
-        STRICT_EXPECTED_CALL(URL_Encode(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeConcat(IGNORED_PTR_ARG, creation_time_utc));
     }
     else if (diag_id != NULL || creation_time_utc != NULL)
     {
@@ -1158,6 +1151,38 @@ static void setup_IoTHubTransport_MQTT_Common_DoWork_events_mocks(
     EXPECTED_CALL(mqtt_client_dowork(IGNORED_PTR_ARG));
 }
 
+static void setup_batched_message_payload_mocks(IOTHUB_MESSAGE_HANDLE msg_handle)
+{
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(msg_handle));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(msg_handle, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+}
+
+static void setup_batched_message_topic_mocks(IOTHUB_MESSAGE_HANDLE msg_handle)
+{
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_construct(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Properties(msg_handle));
+    EXPECTED_CALL(Map_GetInternals(TEST_MESSAGE_PROP_MAP, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetCorrelationId(msg_handle));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetMessageId(msg_handle));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentTypeSystemProperty(msg_handle));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentEncodingSystemProperty(msg_handle));
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetDiagnosticPropertyData(msg_handle)).SetReturn(NULL);
+}
+
+/*two messages with the same topic are looked at and compared, then the topic strings are released*/
+static void setup_batching_scan_mocks(IOTHUB_MESSAGE_HANDLE msg_handle)
+{
+    setup_batched_message_payload_mocks(msg_handle);
+    setup_batched_message_topic_mocks(msg_handle);
+    setup_batched_message_payload_mocks(msg_handle);
+    setup_batched_message_topic_mocks(msg_handle);
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+}
+
 static void setup_message_recv_device_method_mocks()
 {
     STRICT_EXPECTED_CALL(mqttmessage_getTopicName(TEST_MQTT_MESSAGE_HANDLE)).SetReturn(TEST_MQTT_DEV_METHOD_MSG);
@@ -3309,12 +3334,8 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_mqtt_client_connect_fail)
     STRICT_EXPECTED_CALL(IoTHubClient_LL_GetOption(IGNORED_PTR_ARG, OPTION_PRODUCT_INFO, IGNORED_PTR_ARG))
         .IgnoreArgument_iotHubClientHandle()
         .IgnoreArgument_value();
-    STRICT_EXPECTED_CALL(URL_Encode(IGNORED_PTR_ARG))
-        .IgnoreArgument_input();
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_s1()
-        .IgnoreArgument_s2();
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)).IgnoreArgument_handle();
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(URL_EncodeConcat(IGNORED_PTR_ARG, TEST_STRING_VALUE));
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_HOST_NAME);
@@ -3657,12 +3678,8 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_SAS_token_from_user_succeed)
     STRICT_EXPECTED_CALL(IoTHubClient_LL_GetOption(IGNORED_PTR_ARG, OPTION_PRODUCT_INFO, IGNORED_PTR_ARG))
         .IgnoreArgument_iotHubClientHandle()
         .IgnoreArgument_value();
-    STRICT_EXPECTED_CALL(URL_Encode(IGNORED_PTR_ARG))
-        .IgnoreArgument_input();
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_s1()
-        .IgnoreArgument_s2();
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)).IgnoreArgument_handle();
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(URL_EncodeConcat(IGNORED_PTR_ARG, TEST_STRING_VALUE));
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
@@ -3760,12 +3777,8 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_x509_succeed)
     STRICT_EXPECTED_CALL(IoTHubClient_LL_GetOption(IGNORED_PTR_ARG, OPTION_PRODUCT_INFO, IGNORED_PTR_ARG))
         .IgnoreArgument_iotHubClientHandle()
         .IgnoreArgument_value();
-    STRICT_EXPECTED_CALL(URL_Encode(IGNORED_PTR_ARG))
-        .IgnoreArgument_input();
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_s1()
-        .IgnoreArgument_s2();
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)).IgnoreArgument_handle();
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(URL_EncodeConcat(IGNORED_PTR_ARG, TEST_STRING_VALUE));
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
     EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
@@ -4803,6 +4816,252 @@ TEST_FUNCTION(IoTHubTransport_MQTT_Common_MqttOpCompleteCallback_PUBLISH_ACK_suc
     IoTHubTransport_MQTT_Common_Destroy(handle);
 }
 
+static TRANSPORT_LL_HANDLE create_connected_batching_transport(IOTHUBTRANSPORT_CONFIG* config, IOTHUB_MESSAGE_LIST* message1, IOTHUB_MESSAGE_LIST* message2, tickcounter_ms_t linger_ms)
+{
+    QOS_VALUE QosValue[] ={ DELIVER_AT_LEAST_ONCE };
+    SUBSCRIBE_ACK suback;
+    suback.packetId = 1234;
+    suback.qosCount = 1;
+    suback.qosReturn = QosValue;
+    bool batching = true;
+
+    SetupIothubTransportConfig(config, TEST_DEVICE_ID, TEST_DEVICE_KEY, TEST_IOTHUB_NAME, TEST_IOTHUB_SUFFIX, TEST_PROTOCOL_GATEWAY_HOSTNAME);
+
+    memset(message1, 0, sizeof(IOTHUB_MESSAGE_LIST));
+    message1->messageHandle = TEST_IOTHUB_MSG_BYTEARRAY;
+    memset(message2, 0, sizeof(IOTHUB_MESSAGE_LIST));
+    message2->messageHandle = TEST_IOTHUB_MSG_BYTEARRAY;
+    DList_InsertTailList(config->waitingToSend, &(message1->entry));
+    DList_InsertTailList(config->waitingToSend, &(message2->entry));
+
+    TRANSPORT_LL_HANDLE handle = IoTHubTransport_MQTT_Common_Create(config, get_IO_transport);
+    (void)IoTHubTransport_MQTT_Common_SetOption(handle, OPTION_MQTT_BATCHING, &batching);
+    (void)IoTHubTransport_MQTT_Common_SetOption(handle, OPTION_MQTT_BATCHING_LINGER_MS, &linger_ms);
+    g_fnMqttOperationCallback(TEST_MQTT_CLIENT_HANDLE, MQTT_CLIENT_ON_SUBSCRIBE_ACK, &suback, g_callbackCtx);
+    setup_initialize_connection_mocks();
+    IoTHubTransport_MQTT_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+    umock_c_reset_all_calls();
+    return handle;
+}
+
+/* Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_001: [ If the option parameter is set to "mqtt_batching" then the value shall be a bool_ptr and the value will determine if telemetry messages are packed into batches. ] */
+TEST_FUNCTION(IoTHubTransport_MQTT_Common_SetOption_batching_succeed)
+{
+    // arrange
+    IOTHUBTRANSPORT_CONFIG config ={ 0 };
+    SetupIothubTransportConfig(&config, TEST_DEVICE_ID, TEST_DEVICE_KEY, TEST_IOTHUB_NAME, TEST_IOTHUB_SUFFIX, TEST_PROTOCOL_GATEWAY_HOSTNAME);
+
+    TRANSPORT_LL_HANDLE handle = IoTHubTransport_MQTT_Common_Create(&config, get_IO_transport);
+    umock_c_reset_all_calls();
+
+    bool batching = true;
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_MQTT_Common_SetOption(handle, OPTION_MQTT_BATCHING, &batching);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransport_MQTT_Common_Destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_MQTT_TRANSPORT_07_032: [IoTHubTransport_MQTT_Common_SetOption shall pass down the option to xio_setoption if the option parameter is not a known option string for the MQTT transport.] */
+TEST_FUNCTION(IoTHubTransport_MQTT_Common_SetOption_http_batching_is_not_an_mqtt_option)
+{
+    // arrange
+    IOTHUBTRANSPORT_CONFIG config ={ 0 };
+    SetupIothubTransportConfig(&config, TEST_DEVICE_ID, TEST_DEVICE_KEY, TEST_IOTHUB_NAME, TEST_IOTHUB_SUFFIX, TEST_PROTOCOL_GATEWAY_HOSTNAME);
+
+    TRANSPORT_LL_HANDLE handle = IoTHubTransport_MQTT_Common_Create(&config, get_IO_transport);
+    umock_c_reset_all_calls();
+
+    bool batching = true;
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)).SetReturn(TEST_STRING_VALUE);
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(xio_setoption(IGNORED_PTR_ARG, OPTION_BATCHING, &batching))
+        .IgnoreArgument(1)
+        .SetReturn(__FAILURE__);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_MQTT_Common_SetOption(handle, OPTION_BATCHING, &batching);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransport_MQTT_Common_Destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_006: [ If the option parameter is set to "mqtt_batching_max_bytes" then the value shall be a size_t_ptr with the largest batch payload, IoTHubTransport_MQTT_Common_SetOption shall return IOTHUB_CLIENT_INVALID_ARG if it is 0. ] */
+TEST_FUNCTION(IoTHubTransport_MQTT_Common_SetOption_batching_max_bytes_0_fail)
+{
+    // arrange
+    IOTHUBTRANSPORT_CONFIG config ={ 0 };
+    SetupIothubTransportConfig(&config, TEST_DEVICE_ID, TEST_DEVICE_KEY, TEST_IOTHUB_NAME, TEST_IOTHUB_SUFFIX, TEST_PROTOCOL_GATEWAY_HOSTNAME);
+
+    TRANSPORT_LL_HANDLE handle = IoTHubTransport_MQTT_Common_Create(&config, get_IO_transport);
+    umock_c_reset_all_calls();
+
+    size_t max_bytes = 0;
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_MQTT_Common_SetOption(handle, OPTION_MQTT_BATCHING_MAX_BYTES, &max_bytes);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransport_MQTT_Common_Destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_007: [ If the option parameter is set to "mqtt_batching_max_messages" then the value shall be a size_t_ptr with the most messages in a batch, IoTHubTransport_MQTT_Common_SetOption shall return IOTHUB_CLIENT_INVALID_ARG if it is 0. ] */
+TEST_FUNCTION(IoTHubTransport_MQTT_Common_SetOption_batching_max_messages_0_fail)
+{
+    // arrange
+    IOTHUBTRANSPORT_CONFIG config ={ 0 };
+    SetupIothubTransportConfig(&config, TEST_DEVICE_ID, TEST_DEVICE_KEY, TEST_IOTHUB_NAME, TEST_IOTHUB_SUFFIX, TEST_PROTOCOL_GATEWAY_HOSTNAME);
+
+    TRANSPORT_LL_HANDLE handle = IoTHubTransport_MQTT_Common_Create(&config, get_IO_transport);
+    umock_c_reset_all_calls();
+
+    size_t max_messages = 0;
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Credential_Type(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_MQTT_Common_SetOption(handle, OPTION_MQTT_BATCHING_MAX_MESSAGES, &max_messages);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransport_MQTT_Common_Destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_002: [ When batching is on IoTHubTransport_MQTT_Common_DoWork shall pack consecutive messages of "waitingToSend" that have the same topic into one PUBLISH ... ] */
+/* Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_003: [ The payload of a batch shall be the payload of each message, in the order they were queued, each preceded by its length as 4 bytes in network byte order. ] */
+TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_batching_packs_messages_succeeds)
+{
+    // arrange
+    IOTHUBTRANSPORT_CONFIG config ={ 0 };
+    IOTHUB_MESSAGE_LIST message1;
+    IOTHUB_MESSAGE_LIST message2;
+    TRANSPORT_LL_HANDLE handle = create_connected_batching_transport(&config, &message1, &message2, 0);
+
+    unsigned char expectedPayload[2 * (4 + sizeof(appMessage))];
+    size_t index;
+    for (index = 0; index < 2; index++)
+    {
+        unsigned char* frame = expectedPayload + index * (4 + appMsgSize);
+        frame[0] = 0;
+        frame[1] = 0;
+        frame[2] = 0;
+        frame[3] = (unsigned char)appMsgSize;
+        memcpy(frame + 4, appMessage, appMsgSize);
+    }
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    setup_batching_scan_mocks(TEST_IOTHUB_MSG_BYTEARRAY);
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(expectedPayload)));
+    setup_batched_message_payload_mocks(TEST_IOTHUB_MSG_BYTEARRAY);
+    STRICT_EXPECTED_CALL(DList_RemoveEntryList(&(message1.entry)));
+    setup_batched_message_payload_mocks(TEST_IOTHUB_MSG_BYTEARRAY);
+    STRICT_EXPECTED_CALL(DList_RemoveEntryList(&(message2.entry)));
+    setup_batched_message_topic_mocks(TEST_IOTHUB_MSG_BYTEARRAY);
+    EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG));
+    EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mqttmessage_create(IGNORED_NUM_ARG, IGNORED_PTR_ARG, DELIVER_AT_LEAST_ONCE, IGNORED_PTR_ARG, sizeof(expectedPayload)))
+        .IgnoreArgument_packetId()
+        .IgnoreArgument_topicName()
+        .ValidateArgumentBuffer(4, expectedPayload, sizeof(expectedPayload));
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mqtt_client_publish(IGNORED_PTR_ARG, TEST_MQTT_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(mqttmessage_destroy(TEST_MQTT_MESSAGE_HANDLE));
+    EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mqtt_client_dowork(IGNORED_PTR_ARG));
+
+    // act
+    IoTHubTransport_MQTT_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(real_DList_IsListEmpty(config.waitingToSend) != 0);
+
+    //cleanup
+    IoTHubTransport_MQTT_Common_Destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_002: [ ... and shall hold a batch that is not full until "mqtt_batching_linger_ms" has passed. ... ] */
+TEST_FUNCTION(IoTHubTransport_MQTT_Common_DoWork_batching_holds_batch_until_linger_passes)
+{
+    // arrange
+    IOTHUBTRANSPORT_CONFIG config ={ 0 };
+    IOTHUB_MESSAGE_LIST message1;
+    IOTHUB_MESSAGE_LIST message2;
+    TRANSPORT_LL_HANDLE handle = create_connected_batching_transport(&config, &message1, &message2, 1000);
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    setup_batching_scan_mocks(TEST_IOTHUB_MSG_BYTEARRAY);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mqtt_client_dowork(IGNORED_PTR_ARG));
+
+    // act
+    IoTHubTransport_MQTT_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(void_ptr, &(message1.entry), config.waitingToSend->Flink);
+    ASSERT_ARE_EQUAL(void_ptr, &(message2.entry), config.waitingToSend->Blink);
+
+    //cleanup
+    IoTHubTransport_MQTT_Common_Destroy(handle);
+}
+
+/* Tests_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_99_005: [ When a batch is acknowledged, fails or is discarded every message packed into it shall be completed with the same result in a single call to IoTHubClient_LL_SendComplete. ] */
+TEST_FUNCTION(IoTHubTransport_MQTT_Common_MqttOpCompleteCallback_PUBLISH_ACK_batch_completes_every_message)
+{
+    // arrange
+    IOTHUBTRANSPORT_CONFIG config ={ 0 };
+    IOTHUB_MESSAGE_LIST message1;
+    IOTHUB_MESSAGE_LIST message2;
+    TRANSPORT_LL_HANDLE handle = create_connected_batching_transport(&config, &message1, &message2, 0);
+    IoTHubTransport_MQTT_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+    umock_c_reset_all_calls();
+
+    PUBLISH_ACK puback;
+    puback.packetId = 2;
+
+    STRICT_EXPECTED_CALL(DList_RemoveEntryList(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InitializeListHead(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, &(message1.entry)));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, &(message2.entry)));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SendComplete(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IOTHUB_CLIENT_CONFIRMATION_OK));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    g_fnMqttOperationCallback(TEST_MQTT_CLIENT_HANDLE, MQTT_CLIENT_ON_PUBLISH_ACK, &puback, g_callbackCtx);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 2, g_completed_message_count);
+
+    //cleanup
+    IoTHubTransport_MQTT_Common_Destroy(handle);
+}
+
 /* Tests_SRS_IOTHUB_MQTT_TRANSPORT_07_051: [ If msgHandle or callbackCtx is NULL, mqtt_notification_callback shall do nothing. ] */
 TEST_FUNCTION(IoTHubTransport_MQTT_Common_MessageRecv_message_NULL_fail)
 {
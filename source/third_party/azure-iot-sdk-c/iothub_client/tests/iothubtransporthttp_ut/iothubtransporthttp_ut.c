@@ -510,6 +510,12 @@ STRING_HANDLE my_URL_EncodeString(const char* textEncode)
     return real_STRING_construct(TEST_DEVICE_ID);
 }
 
+int my_URL_EncodeConcat(STRING_HANDLE destination, const char* text)
+{
+    (void)text;
+    return real_STRING_concat(destination, TEST_DEVICE_ID);
+}
+
 HTTPAPIEX_HANDLE my_HTTPAPIEX_Create(const char* hostName)
 {
     (void)hostName;
@@ -949,37 +955,30 @@ static void setupRegisterHappyPatheventHTTPrelativePath(bool deallocateCreated)
 {
     /*creating eventHTTPrelativePath*/
     STRICT_EXPECTED_CALL(STRING_construct("/devices/"));
-    STRICT_EXPECTED_CALL(URL_EncodeString(TEST_DEVICE_ID));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(URL_EncodeConcat(IGNORED_PTR_ARG, TEST_DEVICE_ID));
     STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, EVENT_ENDPOINT API_VERSION));
     if (deallocateCreated == true)
     {
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     }
-    /*the url encoded device id*/
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
 }
 
 static void setupRegisterHappyPathmessageHTTPrelativePath(bool deallocateCreated)
 {
     STRICT_EXPECTED_CALL(STRING_construct("/devices/"));
-    STRICT_EXPECTED_CALL(URL_EncodeString(TEST_DEVICE_ID));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(URL_EncodeConcat(IGNORED_PTR_ARG, TEST_DEVICE_ID));
     STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, MESSAGE_ENDPOINT_HTTP API_VERSION));
     if (deallocateCreated == true)
     {
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     }
-    /*the url encoded device id*/
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
 }
 
 static void setupRegisterHappyPatheventHTTPrequestHeaders(bool deallocateCreated, bool is_x509_used)
 {
     STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
     STRICT_EXPECTED_CALL(STRING_construct("/devices/"));
-    STRICT_EXPECTED_CALL(URL_EncodeString(TEST_DEVICE_ID));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(URL_EncodeConcat(IGNORED_PTR_ARG, TEST_DEVICE_ID));
     STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, EVENT_ENDPOINT));
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(HTTPHeaders_AddHeaderNameValuePair(IGNORED_PTR_ARG, "iothub-to", "/devices/"  TEST_DEVICE_ID  EVENT_ENDPOINT));
@@ -997,7 +996,6 @@ static void setupRegisterHappyPatheventHTTPrequestHeaders(bool deallocateCreated
         STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
     }
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
 }
 
 static void setupRegisterHappyPathmessageHTTPrequestHeaders(bool deallocateCreated, bool is_x509_used)
@@ -1019,14 +1017,12 @@ static void setupRegisterHappyPathmessageHTTPrequestHeaders(bool deallocateCreat
 static void setupRegisterHappyPathabandonHTTPrelativePathBegin(bool deallocateCreated)
 {
     STRICT_EXPECTED_CALL(STRING_construct("/devices/"));
-    STRICT_EXPECTED_CALL(URL_EncodeString(TEST_DEVICE_ID));
-    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(URL_EncodeConcat(IGNORED_PTR_ARG, TEST_DEVICE_ID));
     STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, MESSAGE_ENDPOINT_HTTP_ETAG));
     if (deallocateCreated == true)
     {
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     }
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
 }
 
 static void setupRegisterHappyPathsasObject(bool deallocateCreated, bool is_x509_used)
@@ -1194,6 +1190,8 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_GLOBAL_MOCK_HOOK(URL_EncodeString, my_URL_EncodeString);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(URL_EncodeString, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(URL_EncodeConcat, my_URL_EncodeConcat);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(URL_EncodeConcat, __LINE__);
 
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_CreateFromByteArray, my_IoTHubMessage_CreateFromByteArray);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_CreateFromByteArray, NULL);
@@ -1739,10 +1737,11 @@ TEST_FUNCTION(IoTHubTransportHttp_Register_HappyPath_with_deviceKey_fail)
     umock_c_reset_all_calls();
 
     setupRegisterHappyPath(false, false);
+    printf("CALLS:%s\n", umock_c_get_expected_calls());
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 0, 8, 13, 19, 24, 25, 27, 28, 30, 31, 38, 46, 47, 48, 50, 51 };
+    size_t calls_cannot_fail[] = { 0, 14, 19, 20, 22, 24, 25, 38, 39, 40, 42 };
 
     //act
     size_t count = umock_c_negative_tests_call_count();
@@ -0,0 +1,258 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*
+ * Measures the message journal on top of journal_storage_file. Telemetry is appended the way
+ * IoTHubClient_LL_DoWork does it, a few messages and then a Flush, while offline; the journal is then
+ * closed and opened again as after a reboot and everything is replayed, acknowledged in batches.
+ *
+ * Every flush is an fdatasync, so the append rate mostly shows how well the records of one DoWork
+ * are coalesced into a single write. The last run fills a small journal to show eviction.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "azure_c_shared_utility/journal_storage_file.h"
+#include "iothub_message_journal.h"
+
+#define PERF_MESSAGE_COUNT      4096
+#define PERF_BODY_SIZE          200
+#define PERF_SEGMENT_SIZE       (32 * 1024)
+#define PERF_MAX_SEGMENTS       64
+#define PERF_REPLAY_BATCH       16
+#define EVICTION_MAX_SEGMENTS   4
+
+static char segmentPrefix[64];
+
+static double elapsed_ms(const struct timespec* start)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static void remove_segments(void)
+{
+    char name[sizeof(segmentPrefix) + 21];
+    size_t i;
+    for (i = 0; i < PERF_MAX_SEGMENTS; i++)
+    {
+        (void)sprintf(name, "%s%lu", segmentPrefix, (unsigned long)i);
+        (void)unlink(name);
+    }
+}
+
+static IOTHUB_MESSAGE_HANDLE create_message(size_t index)
+{
+    unsigned char body[PERF_BODY_SIZE];
+    char value[16];
+    IOTHUB_MESSAGE_HANDLE result;
+
+    (void)memset(body, (int)('a' + index % 26), sizeof(body));
+    if ((result = IoTHubMessage_CreateFromByteArray(body, sizeof(body))) != NULL)
+    {
+        (void)sprintf(value, "%lu", (unsigned long)index);
+        if ((IoTHubMessage_SetMessageId(result, value) != IOTHUB_MESSAGE_OK) ||
+            (Map_AddOrUpdate(IoTHubMessage_Properties(result), "index", value) != MAP_OK))
+        {
+            IoTHubMessage_Destroy(result);
+            result = NULL;
+        }
+    }
+    return result;
+}
+
+static int append_messages(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, size_t count, size_t per_flush)
+{
+    int result = 0;
+    size_t i;
+    for (i = 0; (result == 0) && (i < count); i++)
+    {
+        uint32_t sequenceNumber;
+        IOTHUB_MESSAGE_HANDLE message = create_message(i);
+        if ((message == NULL) || (IoTHubMessageJournal_Append(journal, message, &sequenceNumber) != 0))
+        {
+            result = __LINE__;
+        }
+        else if ((((i + 1) % per_flush) == 0) && (IoTHubMessageJournal_Flush(journal) != 0))
+        {
+            result = __LINE__;
+        }
+        IoTHubMessage_Destroy(message);
+    }
+    if ((result == 0) && (IoTHubMessageJournal_Flush(journal) != 0))
+    {
+        result = __LINE__;
+    }
+    return result;
+}
+
+/*reads everything back, checking the ids come in order, and acknowledges each batch like the transport would*/
+static int replay_messages(IOTHUB_MESSAGE_JOURNAL_HANDLE journal, size_t* replayed)
+{
+    int result = 0;
+    uint32_t expected = IoTHubMessageJournal_GetFirstSequenceNumber(journal);
+    *replayed = 0;
+
+    while (result == 0)
+    {
+        IOTHUB_MESSAGE_HANDLE message;
+        uint32_t sequenceNumber;
+        if (IoTHubMessageJournal_ReadNext(journal, &message, &sequenceNumber) != 0)
+        {
+            result = __LINE__;
+        }
+        else if (message == NULL)
+        {
+            break;
+        }
+        else
+        {
+            if ((sequenceNumber != expected) || (IoTHubMessage_GetMessageId(message) == NULL))
+            {
+                result = __LINE__;
+            }
+            expected++;
+            (*replayed)++;
+            IoTHubMessage_Destroy(message);
+
+            if (((*replayed % PERF_REPLAY_BATCH) == 0) || (result != 0))
+            {
+                IoTHubMessageJournal_Acknowledge(journal, sequenceNumber);
+                (void)IoTHubMessageJournal_Flush(journal);
+            }
+        }
+    }
+
+    if (result == 0)
+    {
+        IoTHubMessageJournal_Acknowledge(journal, expected - 1);
+        result = IoTHubMessageJournal_Flush(journal);
+    }
+    return result;
+}
+
+static void print_statistics(const char* name, IOTHUB_MESSAGE_JOURNAL_HANDLE journal)
+{
+    IOTHUB_MESSAGE_JOURNAL_STATISTICS statistics;
+    if (IoTHubMessageJournal_GetStatistics(journal, &statistics) == 0)
+    {
+        (void)printf("%-12s appended %5zu  replayed %5zu  evicted %5zu  discarded %zu  written %7zu KB  segments %zu\r\n",
+            name, statistics.messages_appended, statistics.messages_replayed, statistics.messages_evicted,
+            statistics.records_discarded, statistics.bytes_written / 1024, statistics.segments_in_use);
+    }
+}
+
+static int run(size_t per_flush)
+{
+    int result;
+    IOTHUB_MESSAGE_JOURNAL_CONFIG config;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal;
+    struct timespec start;
+    char name[32];
+
+    remove_segments();
+    config.storage_interface = journal_storage_file_get_interface_description();
+    config.storage_parameters = segmentPrefix;
+    config.segment_size = PERF_SEGMENT_SIZE;
+    config.max_segments = PERF_MAX_SEGMENTS;
+    config.replay_batch = PERF_REPLAY_BATCH;
+
+    (void)sprintf(name, "flush/%lu", (unsigned long)per_flush);
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    if ((journal = IoTHubMessageJournal_Create(&config)) == NULL)
+    {
+        (void)printf("%-12s FAILED to create the journal\r\n", name);
+        result = __LINE__;
+    }
+    else if (append_messages(journal, PERF_MESSAGE_COUNT, per_flush) != 0)
+    {
+        (void)printf("%-12s FAILED appending\r\n", name);
+        IoTHubMessageJournal_Destroy(journal);
+        result = __LINE__;
+    }
+    else
+    {
+        double appendMs = elapsed_ms(&start);
+        size_t replayed;
+
+        print_statistics(name, journal);
+        IoTHubMessageJournal_Destroy(journal);
+
+        (void)clock_gettime(CLOCK_MONOTONIC, &start);
+        if ((journal = IoTHubMessageJournal_Create(&config)) == NULL)
+        {
+            (void)printf("%-12s FAILED to reopen the journal\r\n", name);
+            result = __LINE__;
+        }
+        else
+        {
+            double reopenMs = elapsed_ms(&start);
+            result = replay_messages(journal, &replayed);
+            if ((result != 0) || (replayed != PERF_MESSAGE_COUNT))
+            {
+                (void)printf("%-12s FAILED replaying (%zu of %d messages)\r\n", name, replayed, PERF_MESSAGE_COUNT);
+                result = __LINE__;
+            }
+            else
+            {
+                double replayMs = elapsed_ms(&start) - reopenMs;
+                (void)printf("%-12s append %8.0f msg/s %6.2f MB/s  reopen %6.1f ms  replay %8.0f msg/s\r\n",
+                    name, PERF_MESSAGE_COUNT * 1000.0 / appendMs, PERF_MESSAGE_COUNT * (double)PERF_BODY_SIZE / 1024.0 / 1024.0 * 1000.0 / appendMs,
+                    reopenMs, replayed * 1000.0 / replayMs);
+            }
+            IoTHubMessageJournal_Destroy(journal);
+        }
+    }
+
+    remove_segments();
+    return result;
+}
+
+static int run_eviction(void)
+{
+    int result;
+    IOTHUB_MESSAGE_JOURNAL_CONFIG config;
+    IOTHUB_MESSAGE_JOURNAL_HANDLE journal;
+
+    remove_segments();
+    config.storage_interface = journal_storage_file_get_interface_description();
+    config.storage_parameters = segmentPrefix;
+    config.segment_size = PERF_SEGMENT_SIZE;
+    config.max_segments = EVICTION_MAX_SEGMENTS;
+    config.replay_batch = PERF_REPLAY_BATCH;
+
+    if ((journal = IoTHubMessageJournal_Create(&config)) == NULL)
+    {
+        (void)printf("%-12s FAILED to create the journal\r\n", "eviction");
+        result = __LINE__;
+    }
+    else
+    {
+        result = append_messages(journal, PERF_MESSAGE_COUNT, 8);
+        (void)printf("%-12s %d segments of %d KB keep messages from %lu on\r\n",
+            "eviction", EVICTION_MAX_SEGMENTS, PERF_SEGMENT_SIZE / 1024, (unsigned long)IoTHubMessageJournal_GetFirstSequenceNumber(journal));
+        print_statistics("eviction", journal);
+        IoTHubMessageJournal_Destroy(journal);
+    }
+
+    remove_segments();
+    return result;
+}
+
+int main(void)
+{
+    int result = 0;
+
+    (void)sprintf(segmentPrefix, "/tmp/message_journal_perf_%ld_", (long)getpid());
+    (void)printf("%d messages of %d bytes, segments of %d KB\r\n", PERF_MESSAGE_COUNT, PERF_BODY_SIZE, PERF_SEGMENT_SIZE / 1024);
+    if (run(1) != 0) result = __LINE__;
+    if (run(8) != 0) result = __LINE__;
+    if (run(64) != 0) result = __LINE__;
+    if (run_eviction() != 0) result = __LINE__;
+    return result;
+}
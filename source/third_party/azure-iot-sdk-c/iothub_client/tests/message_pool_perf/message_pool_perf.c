@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/*
+ * Soaks IoTHubMessage the way a device sending telemetry does: every message is created, given its
+ * system properties and one application property, cloned as IoTHubClient_LL_SendEventAsync does and
+ * the original destroyed. The clone stays in flight for a random time, as if waiting for its
+ * acknowledgement, while the rest of the application keeps allocating blocks of its own.
+ *
+ * Each configuration runs in its own process so that it starts from a fresh heap. At the end of the
+ * soak the heap is inspected with mallinfo2: free bytes below the top of the heap cannot be given
+ * back and only serve requests that fit the holes, which is what fragmentation costs on an MCU.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <sys/wait.h>
+
+#include "iothub_message.h"
+
+#define SOAK_MESSAGES           200000
+#define SOAK_IN_FLIGHT          32
+#define SOAK_MIN_BODY           24
+#define SOAK_MAX_BODY           200
+#define SOAK_OTHER_BLOCKS       64
+#define SOAK_OTHER_MAX_SIZE     600
+#define SOAK_OTHER_EVERY        8
+#define POOL_INLINE_SIZE        96
+#define POOL_SLOT_SIZE          (SOAK_MAX_BODY + POOL_INLINE_SIZE)
+#define POOL_PROPERTY_COUNT     2
+#define POOL_PROPERTY_SIZE      32
+
+/*every allocation of the process goes through these, the soak reports how many were made*/
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static size_t allocationCount;
+
+void* malloc(size_t size)
+{
+    allocationCount++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size)
+{
+    allocationCount++;
+    return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    allocationCount++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr)
+{
+    __libc_free(ptr);
+}
+
+static unsigned long randomState = 12345;
+
+static size_t next_random(size_t range)
+{
+    randomState = randomState * 1103515245 + 12345;
+    return (size_t)((randomState >> 16) % range);
+}
+
+static double elapsed_ms(const struct timespec* start)
+{
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) * 1000.0 + (now.tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+static IOTHUB_MESSAGE_HANDLE send_message(size_t index)
+{
+    unsigned char body[SOAK_MAX_BODY];
+    size_t size = SOAK_MIN_BODY + next_random(SOAK_MAX_BODY - SOAK_MIN_BODY + 1);
+    char value[24];
+    IOTHUB_MESSAGE_HANDLE message;
+    IOTHUB_MESSAGE_HANDLE result = NULL;
+
+    (void)memset(body, (int)('a' + index % 26), size);
+    if ((message = IoTHubMessage_CreateFromByteArray(body, size)) != NULL)
+    {
+        (void)sprintf(value, "%lu", (unsigned long)index);
+        if ((IoTHubMessage_SetMessageId(message, value) == IOTHUB_MESSAGE_OK) &&
+            (IoTHubMessage_SetCorrelationId(message, "telemetry") == IOTHUB_MESSAGE_OK) &&
+            (Map_AddOrUpdate(IoTHubMessage_Properties(message), "temperature", "21.5") == MAP_OK))
+        {
+            result = IoTHubMessage_Clone(message);
+        }
+        IoTHubMessage_Destroy(message);
+    }
+    return result;
+}
+
+static int soak(const char* name, bool packed)
+{
+    int result = 0;
+    IOTHUB_MESSAGE_HANDLE inFlight[SOAK_IN_FLIGHT] = { NULL };
+    void* otherBlocks[SOAK_OTHER_BLOCKS] = { NULL };
+    size_t allocationsBefore = allocationCount;
+    struct timespec start;
+    double soakMs;
+    struct mallinfo2 heap;
+    size_t i;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; (result == 0) && (i < SOAK_MESSAGES); i++)
+    {
+        size_t slot = next_random(SOAK_IN_FLIGHT);
+        IOTHUB_MESSAGE_HANDLE message = send_message(i);
+        if (message == NULL)
+        {
+            (void)printf("%-8s FAILED sending message %lu\r\n", name, (unsigned long)i);
+            result = __LINE__;
+        }
+        else
+        {
+            /*the message that was waiting there is acknowledged*/
+            IoTHubMessage_Destroy(inFlight[slot]);
+            inFlight[slot] = message;
+        }
+
+        if ((i % SOAK_OTHER_EVERY) == 0)
+        {
+            slot = next_random(SOAK_OTHER_BLOCKS);
+            free(otherBlocks[slot]);
+            otherBlocks[slot] = malloc(16 + next_random(SOAK_OTHER_MAX_SIZE));
+        }
+    }
+    soakMs = elapsed_ms(&start);
+    heap = mallinfo2();
+
+    if (result == 0)
+    {
+        IOTHUB_MESSAGE_POOL_STATISTICS statistics;
+        size_t stranded = heap.fordblks - heap.keepcost;
+
+        (void)printf("%-8s %8.0f msg/s  %5.2f allocations/msg  heap %6zu KB  in use %5zu KB  free chunks %4zu  stranded %5zu KB (%4.1f%%)\r\n",
+            name, SOAK_MESSAGES * 1000.0 / soakMs, (double)(allocationCount - allocationsBefore) / SOAK_MESSAGES,
+            heap.arena / 1024, heap.uordblks / 1024, heap.ordblks, stranded / 1024,
+            (heap.arena == 0) ? 0.0 : stranded * 100.0 / heap.arena);
+        if (packed && (IoTHubMessage_GetPoolStatistics(&statistics) == 0))
+        {
+            (void)printf("%-8s slots in use %zu (max %zu)  from slots %zu  from heap %zu\r\n",
+                name, statistics.slots_in_use, statistics.max_slots_in_use, statistics.pool_allocations, statistics.heap_allocations);
+        }
+    }
+
+    for (i = 0; i < SOAK_IN_FLIGHT; i++)
+    {
+        IoTHubMessage_Destroy(inFlight[i]);
+    }
+    for (i = 0; i < SOAK_OTHER_BLOCKS; i++)
+    {
+        free(otherBlocks[i]);
+    }
+    return result;
+}
+
+static int run(const char* name, size_t slot_count, bool packed)
+{
+    int result;
+    pid_t child = fork();
+
+    if (child < 0)
+    {
+        (void)printf("%-8s FAILED to fork\r\n", name);
+        result = __LINE__;
+    }
+    else if (child == 0)
+    {
+        IOTHUB_MESSAGE_POOL_CONFIG config;
+        config.slot_count = slot_count;
+        config.slot_size = POOL_SLOT_SIZE;
+        config.inline_size = POOL_INLINE_SIZE;
+        config.property_count = POOL_PROPERTY_COUNT;
+        config.property_size = POOL_PROPERTY_SIZE;
+
+        if (packed && (IoTHubMessage_InitPool(&config) != 0))
+        {
+            (void)printf("%-8s FAILED to set up the pool\r\n", name);
+            result = __LINE__;
+        }
+        else
+        {
+            result = soak(name, packed);
+            IoTHubMessage_DeinitPool();
+        }
+        (void)fflush(stdout);
+        _exit(result == 0 ? 0 : 1);
+    }
+    else
+    {
+        int status;
+        result = ((waitpid(child, &status, 0) == child) && WIFEXITED(status) && (WEXITSTATUS(status) == 0)) ? 0 : __LINE__;
+    }
+    return result;
+}
+
+int main(void)
+{
+    int result = 0;
+
+    (void)printf("%d messages of %d to %d bytes, %d in flight, %d other blocks of up to %d bytes\r\n",
+        SOAK_MESSAGES, SOAK_MIN_BODY, SOAK_MAX_BODY, SOAK_IN_FLIGHT, SOAK_OTHER_BLOCKS, SOAK_OTHER_MAX_SIZE);
+    (void)fflush(stdout);
+    if (run("heap", 0, false) != 0) result = __LINE__;
+    if (run("packed", 0, true) != 0) result = __LINE__;
+    /*one slot more than in flight for the message being cloned*/
+    if (run("pool", SOAK_IN_FLIGHT + 2, true) != 0) result = __LINE__;
+    return result;
+}
@@ -229,9 +229,9 @@ static PROV_JSON_INFO* prov_transport_process_json_reply(const char* json_docume
         LogError("failure user_ctx is NULL");
         result = NULL;
     }
-    else if ((root_value = json_parse_string(json_document)) == NULL)
+    else if ((root_value = json_parse_string_with_arena(json_document)) == NULL)
     {
-        LogError("failure calling json_parse_string");
+        LogError("failure calling json_parse_string_with_arena");
         result = NULL;
     }
     else if ((json_object = json_value_get_object(root_value)) == NULL)
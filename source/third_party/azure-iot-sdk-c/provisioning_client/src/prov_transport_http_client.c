@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/platform.h"
 #include "azure_c_shared_utility/xlogging.h"
@@ -23,8 +24,12 @@
 #define HTTP_STATUS_CODE_OK_MAX         226
 #define HTTP_STATUS_CODE_UNAUTHORIZED   401
 
-static const char* PROV_REGISTRATION_URI_FMT = "/%s/registrations/%s/register?api-version=%s";
-static const char* PROV_OP_STATUS_URI_FMT = "/%s/registrations/%s/operations/%s?api-version=%s";
+/* the registration uri is "/" scope "/registrations/" reg_id "/register?api-version=" api_version and the
+   operation status uri is "/" scope "/registrations/" reg_id "/operations/" op_id "?api-version=" api_version */
+static const char* PROV_URI_REGISTRATIONS = "/registrations/";
+static const char* PROV_URI_REGISTER = "/register";
+static const char* PROV_URI_OPERATIONS = "/operations/";
+static const char* PROV_URI_API_VERSION = "?api-version=";
 
 static const char* HEADER_KEY_AUTHORIZATION = "Authorization";
 static const char* HEADER_USER_AGENT = "UserAgent";
@@ -295,72 +300,83 @@ static char* construct_json_data(PROV_TRANSPORT_HTTP_INFO* http_info)
     return result;
 }
 
+static int append_url_path(char* path, size_t path_size, size_t* position, const char* value, bool url_encode)
+{
+    int result;
+    size_t value_len = strlen(value);
+    if (url_encode)
+    {
+        size_t encoded_len;
+        if (URL_EncodeInto(value, value_len, path + *position, path_size - *position, &encoded_len) != 0)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            *position += encoded_len;
+            result = 0;
+        }
+    }
+    else if (value_len >= path_size - *position)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)memcpy(path + *position, value, value_len + 1);
+        *position += value_len;
+        result = 0;
+    }
+    return result;
+}
+
 static char* construct_url_path(PROV_TRANSPORT_HTTP_INFO* http_info)
 {
     char* result;
-    size_t path_len;
-    STRING_HANDLE encoded_scope;
 
-    STRING_HANDLE encoded_reg_id = URL_EncodeString(http_info->registration_id);
-    if (encoded_reg_id == NULL)
-    {
-        LogError("Failure encoding reg id");
-        result = NULL;
-    }
-    else if ((encoded_scope = URL_EncodeString(http_info->scope_id)) == NULL)
+    if (http_info->scope_id == NULL || http_info->registration_id == NULL)
     {
-        LogError("Failure encoding string value");
-        STRING_delete(encoded_reg_id);
+        LogError("Invalid scope or registration id");
         result = NULL;
     }
     else
     {
+        /* the ids are url encoded straight into the path, sized up front so a single allocation is made */
+        size_t path_size = 1 + URL_EncodedLength(http_info->scope_id, strlen(http_info->scope_id)) +
+            strlen(PROV_URI_REGISTRATIONS) + URL_EncodedLength(http_info->registration_id, strlen(http_info->registration_id)) +
+            strlen(PROV_URI_API_VERSION) + strlen(http_info->api_version) + 1;
         if (http_info->operation_id == NULL)
         {
-            path_len = strlen(PROV_REGISTRATION_URI_FMT) + STRING_length(encoded_scope) + STRING_length(encoded_reg_id) + strlen(http_info->api_version);
-            if ((result = malloc(path_len + 1)) == NULL)
-            {
-                LogError("Failure allocating url path");
-            }
-            else
-            {
-                if (sprintf(result, PROV_REGISTRATION_URI_FMT, STRING_c_str(encoded_scope), STRING_c_str(encoded_reg_id), http_info->api_version) == 0)
-                {
-                    LogError("Failure constructing url path");
-                    free(result);
-                    result = NULL;
-                }
-            }
+            path_size += strlen(PROV_URI_REGISTER);
+        }
+        else
+        {
+            path_size += strlen(PROV_URI_OPERATIONS) + URL_EncodedLength(http_info->operation_id, strlen(http_info->operation_id));
+        }
+
+        if ((result = malloc(path_size)) == NULL)
+        {
+            LogError("Failure allocating url path");
         }
         else
         {
-            STRING_HANDLE encoded_op_id = URL_EncodeString(http_info->operation_id);
-            if (encoded_op_id == NULL)
+            size_t position = 0;
+            if ((append_url_path(result, path_size, &position, "/", false) != 0) ||
+                (append_url_path(result, path_size, &position, http_info->scope_id, true) != 0) ||
+                (append_url_path(result, path_size, &position, PROV_URI_REGISTRATIONS, false) != 0) ||
+                (append_url_path(result, path_size, &position, http_info->registration_id, true) != 0) ||
+                ((http_info->operation_id == NULL) ?
+                    (append_url_path(result, path_size, &position, PROV_URI_REGISTER, false) != 0) :
+                    ((append_url_path(result, path_size, &position, PROV_URI_OPERATIONS, false) != 0) ||
+                    (append_url_path(result, path_size, &position, http_info->operation_id, true) != 0))) ||
+                (append_url_path(result, path_size, &position, PROV_URI_API_VERSION, false) != 0) ||
+                (append_url_path(result, path_size, &position, http_info->api_version, false) != 0))
             {
-                LogError("Failure encoding operation id");
+                LogError("Failure constructing url path");
+                free(result);
                 result = NULL;
             }
-            else
-            {
-                path_len = strlen(PROV_OP_STATUS_URI_FMT) + STRING_length(encoded_scope) + STRING_length(encoded_reg_id) + STRING_length(encoded_op_id) + strlen(http_info->api_version);
-                if ((result = malloc(path_len + 1)) == NULL)
-                {
-                    LogError("failure allocating retrieval path");
-                }
-                else
-                {
-                    if (sprintf(result, PROV_OP_STATUS_URI_FMT, STRING_c_str(encoded_scope), STRING_c_str(encoded_reg_id), STRING_c_str(encoded_op_id), http_info->api_version) == 0)
-                    {
-                        LogError("failure allocating retrieval path");
-                        free(result);
-                        result = NULL;
-                    }
-                }
-                STRING_delete(encoded_op_id);
-            }
         }
-        STRING_delete(encoded_scope);
-        STRING_delete(encoded_reg_id);
     }
     return result;
 }
@@ -64,7 +64,7 @@ MOCKABLE_FUNCTION(, int, prov_transport_x509_cert, PROV_DEVICE_TRANSPORT_HANDLE,
 MOCKABLE_FUNCTION(, int, prov_transport_set_trusted_cert, PROV_DEVICE_TRANSPORT_HANDLE, handle, const char*, certificate);
 MOCKABLE_FUNCTION(, int, prov_transport_set_proxy, PROV_DEVICE_TRANSPORT_HANDLE, handle, const HTTP_PROXY_OPTIONS*, proxy_option);
 
-MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string, const char *, string);
+MOCKABLE_FUNCTION(, JSON_Value*, json_parse_string_with_arena, const char *, string);
 MOCKABLE_FUNCTION(, JSON_Status, json_serialize_to_file, const JSON_Value*, value, const char *, filename);
 MOCKABLE_FUNCTION(, JSON_Value*, json_parse_file, const char*, string);
 MOCKABLE_FUNCTION(, JSON_Object*, json_value_get_object, const JSON_Value *, value);
@@ -355,7 +355,7 @@ static BUFFER_HANDLE my_Base64_Decoder(const char* source)
     return (BUFFER_HANDLE)my_gballoc_malloc(1);
 }
 
-static JSON_Value* my_json_parse_string(const char* string)
+static JSON_Value* my_json_parse_string_with_arena(const char* string)
 {
     (void)string;
     return (JSON_Value*)my_gballoc_malloc(1);
@@ -438,8 +438,8 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
         REGISTER_GLOBAL_MOCK_RETURN(prov_auth_construct_sas_token, "Sas_token");
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(prov_auth_construct_sas_token, NULL);
 
-        REGISTER_GLOBAL_MOCK_HOOK(json_parse_string, my_json_parse_string);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_parse_string, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(json_parse_string_with_arena, my_json_parse_string_with_arena);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_parse_string_with_arena, NULL);
         REGISTER_GLOBAL_MOCK_HOOK(json_value_free, my_json_value_free);
         REGISTER_GLOBAL_MOCK_RETURN(json_value_get_object, TEST_JSON_OBJECT_VALUE);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(json_value_get_object, NULL);
@@ -612,7 +612,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
 
     static void setup_parse_json_unassigned_mocks(void)
     {
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(json_object_get_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
@@ -628,7 +628,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
 
     static void setup_parse_json_assigning_mocks(void)
     {
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(json_object_get_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
@@ -640,7 +640,7 @@ BEGIN_TEST_SUITE(prov_device_client_ll_ut)
 
     static void setup_parse_json_assigned_mocks(void)
     {
-        STRICT_EXPECTED_CALL(json_parse_string(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(json_parse_string_with_arena(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(json_value_get_object(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(json_object_get_value(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
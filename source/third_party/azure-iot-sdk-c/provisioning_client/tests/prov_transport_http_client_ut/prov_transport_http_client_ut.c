@@ -4,9 +4,11 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstddef>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stddef.h>
+#include <string.h>
 #endif
 
 static void* my_gballoc_malloc(size_t size)
@@ -229,10 +231,27 @@ static BUFFER_HANDLE my_Base64_Decoder(const char* source)
     return (BUFFER_HANDLE)my_gballoc_malloc(1);
 }
 
-static STRING_HANDLE my_URL_EncodeString(const char* input)
+static size_t my_URL_EncodedLength(const char* text, size_t textLength)
 {
-    (void)input;
-    return (STRING_HANDLE)my_gballoc_malloc(1);
+    (void)text;
+    return textLength;
+}
+
+static int my_URL_EncodeInto(const char* text, size_t textLength, char* destination, size_t destinationSize, size_t* encodedLength)
+{
+    int result;
+    if (textLength >= destinationSize)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        memcpy(destination, text, textLength);
+        destination[textLength] = '\0';
+        *encodedLength = textLength;
+        result = 0;
+    }
+    return result;
 }
 
 static HTTP_CLIENT_HANDLE my_uhttp_client_create(const IO_INTERFACE_DESCRIPTION* io_interface_desc, const void* xio_param, ON_HTTP_ERROR_CALLBACK on_http_error, void* callback_ctx)
@@ -367,8 +386,9 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(mallocAndStrcpy_s, __LINE__);
         REGISTER_GLOBAL_MOCK_HOOK(Base64_Encoder, my_Base64_Encoder);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Base64_Encoder, NULL);
-        REGISTER_GLOBAL_MOCK_HOOK(URL_EncodeString, my_URL_EncodeString);
-        REGISTER_GLOBAL_MOCK_FAIL_RETURN(URL_EncodeString, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(URL_EncodedLength, my_URL_EncodedLength);
+        REGISTER_GLOBAL_MOCK_HOOK(URL_EncodeInto, my_URL_EncodeInto);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(URL_EncodeInto, __LINE__);
         REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, TEST_STRING_VALUE);
         REGISTER_GLOBAL_MOCK_RETURN(STRING_length, TEST_STRING_VALUE_LEN);
         REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
@@ -499,16 +519,11 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
     static void setup_dps_send_challenge_response_mocks(void)
     {
         setup_construct_header_mocks(true);
-        STRICT_EXPECTED_CALL(URL_EncodeString(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(URL_EncodeString(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_length(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_length(IGNORED_NUM_ARG));
-
+        STRICT_EXPECTED_CALL(URL_EncodedLength(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodedLength(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeInto(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeInto(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
 
         STRICT_EXPECTED_CALL(Base64_Encoder(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(Base64_Encoder(IGNORED_PTR_ARG));
@@ -530,11 +545,11 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
     static void setup_prov_dev_http_transport_register_device_mocks(void)
     {
         setup_construct_header_mocks(false);
-        STRICT_EXPECTED_CALL(URL_EncodeString(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_length(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodedLength(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodedLength(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeInto(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeInto(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
@@ -569,8 +584,11 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
     static void setup_prov_transport_http_register_device_mocks(void)
     {
         setup_construct_header_mocks(false);
-        STRICT_EXPECTED_CALL(URL_EncodeString(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodedLength(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodedLength(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeInto(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeInto(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_POST, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     }
 
@@ -600,19 +618,13 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
     static void setup_prov_dev_http_transport_get_op_status_mocks(void)
     {
         setup_construct_header_mocks(true);
-        STRICT_EXPECTED_CALL(URL_EncodeString(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(URL_EncodeString(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(URL_EncodeString(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_length(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_length(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_length(IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodedLength(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodedLength(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodedLength(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
         STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_NUM_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeInto(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeInto(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(URL_EncodeInto(IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(uhttp_client_execute_request(IGNORED_PTR_ARG, HTTP_CLIENT_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
@@ -1155,7 +1167,7 @@ BEGIN_TEST_SUITE(prov_transport_http_client_ut)
 
         umock_c_negative_tests_snapshot();
 
-        size_t calls_cannot_fail[] = { 8, 9, 11, 12, 13, 14, 16, 17 };
+        size_t calls_cannot_fail[] = { 6, 7, 8, 14, 15 };
 
         //act
         count = umock_c_negative_tests_call_count();
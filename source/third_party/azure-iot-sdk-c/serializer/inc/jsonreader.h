@@ -0,0 +1,44 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+#define JSON_READER_RESULT_VALUES   \
+JSON_READER_OK,                     \
+JSON_READER_INVALID_ARG,            \
+JSON_READER_PARSE_ERROR
+
+DEFINE_ENUM(JSON_READER_RESULT, JSON_READER_RESULT_VALUES);
+
+/* A JSON_READER walks a JSON text in place, one member at a time. It never writes to the text
+   and never allocates; names and values are returned as spans of the original text. */
+typedef struct JSON_READER_TAG
+{
+    const char* json;
+    bool isFirstMember;
+} JSON_READER;
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, JSON_READER_RESULT, JSONReader_Init, JSON_READER*, reader, const char*, json);
+MOCKABLE_FUNCTION(, JSON_READER_RESULT, JSONReader_BeginObject, JSON_READER*, reader);
+MOCKABLE_FUNCTION(, JSON_READER_RESULT, JSONReader_NextMember, JSON_READER*, reader, const char**, name, size_t*, nameLength, bool*, isEndOfObject);
+MOCKABLE_FUNCTION(, JSON_READER_RESULT, JSONReader_ReadValue, JSON_READER*, reader, const char**, value, size_t*, valueLength);
+MOCKABLE_FUNCTION(, JSON_READER_RESULT, JSONReader_End, JSON_READER*, reader);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSONREADER_H */
@@ -0,0 +1,54 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include "azure_c_shared_utility/macro_utils.h"
+
+#ifdef __cplusplus
+#include <cstddef>
+#include <cstdint>
+extern "C" {
+#else
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#endif
+
+#include "agenttypesystem.h"
+
+#define JSON_WRITER_RESULT_VALUES   \
+JSON_WRITER_OK,                     \
+JSON_WRITER_INVALID_ARG,            \
+JSON_WRITER_BUFFER_TOO_SMALL,       \
+JSON_WRITER_ERROR
+
+DEFINE_ENUM(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+
+/* A JSON_WRITER writes into a caller provided buffer. length keeps counting past size so
+   that after a JSON_WRITER_BUFFER_TOO_SMALL result it holds the size the output needs. */
+typedef struct JSON_WRITER_TAG
+{
+    char* buffer;
+    size_t size;
+    size_t length;
+} JSON_WRITER;
+
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_Init, JSON_WRITER*, writer, char*, destination, size_t, destinationSize);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendLiteral, JSON_WRITER*, writer, const char*, literal, size_t, literalLength);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendInt64, JSON_WRITER*, writer, int64_t, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendDouble, JSON_WRITER*, writer, double, value, int, digits);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendBool, JSON_WRITER*, writer, bool, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendString, JSON_WRITER*, writer, const char*, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendRaw, JSON_WRITER*, writer, const char*, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_AppendAgentDataType, JSON_WRITER*, writer, const AGENT_DATA_TYPE*, value);
+MOCKABLE_FUNCTION(, JSON_WRITER_RESULT, JSONWriter_Finish, JSON_WRITER*, writer, size_t*, destinationLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSONWRITER_H */
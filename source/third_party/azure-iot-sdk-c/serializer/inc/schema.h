@@ -72,6 +72,16 @@ typedef struct SCHEMA_MODEL_ELEMENT_TAG
     } elementHandle;
 }SCHEMA_MODEL_ELEMENT;
 
+/*what a desired property document member can be: a desired property or a model in model*/
+typedef struct SCHEMA_DESIRED_ELEMENT_TAG
+{
+    SCHEMA_ELEMENT_TYPE elementType; /*SCHEMA_DESIRED_PROPERTY, SCHEMA_MODEL_IN_MODEL, SCHEMA_NOT_FOUND or SCHEMA_SEARCH_INVALID_ARG*/
+    SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle; /*set for SCHEMA_DESIRED_PROPERTY*/
+    SCHEMA_MODEL_TYPE_HANDLE modelHandle; /*set for SCHEMA_MODEL_IN_MODEL*/
+    size_t offset; /*offset of the desired property or of the model in model in the parent model*/
+    pfOnDesiredProperty onDesiredProperty;
+}SCHEMA_DESIRED_ELEMENT;
+
 MOCKABLE_FUNCTION(, SCHEMA_HANDLE, Schema_Create, const char*, schemaNamespace, void*, metadata);
 MOCKABLE_FUNCTION(, void*, Schema_GetMetadata, SCHEMA_HANDLE, schemaHandle);
 MOCKABLE_FUNCTION(, size_t, Schema_GetSchemaCount);
@@ -114,6 +124,7 @@ MOCKABLE_FUNCTION(, pfDesiredPropertyDeinitialize, Schema_GetModelDesiredPropert
 MOCKABLE_FUNCTION(, pfDesiredPropertyInitialize, Schema_GetModelDesiredProperty_pfDesiredPropertyInitialize, SCHEMA_DESIRED_PROPERTY_HANDLE, desiredPropertyHandle);
 
 MOCKABLE_FUNCTION(, SCHEMA_MODEL_ELEMENT, Schema_GetModelElementByName, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, const char*, elementName);
+MOCKABLE_FUNCTION(, SCHEMA_DESIRED_ELEMENT, Schema_GetModelDesiredElementByName, SCHEMA_MODEL_TYPE_HANDLE, modelTypeHandle, const char*, elementName, size_t, elementNameLength);
 
 MOCKABLE_FUNCTION(, SCHEMA_RESULT, Schema_GetModelCount, SCHEMA_HANDLE, schemaHandle, size_t*, modelCount);
 MOCKABLE_FUNCTION(, SCHEMA_MODEL_TYPE_HANDLE, Schema_GetModelByName, SCHEMA_HANDLE, schemaHandle, const char*, modelName);
@@ -41,10 +41,12 @@
 #ifdef __cplusplus
 #include <cstdlib>
 #include <cstdarg>
+#include <cfloat>
 
 #else
 #include <stdlib.h>
 #include <stdarg.h>
+#include <float.h>
 #endif
 
 #include "azure_c_shared_utility/gballoc.h"
@@ -57,6 +59,7 @@
 #include "codefirst.h"
 #include "agenttypesystem.h"
 #include "schema.h"
+#include "jsonwriter.h"
 
 
 
@@ -139,6 +142,19 @@ extern "C"
     { \
         FOR_EACH_2_KEEP_2(GLOBAL_DEINITIALIZE_STRUCT_FIELD, name, destination, __VA_ARGS__); \
     } \
+    /*Codes_SRS_SERIALIZER_H_99_120:[ DECLARE_STRUCT shall declare a ToJSON_<name> function that writes all the fields of the struct as a JSON object, in declaration order.]*/ \
+    static JSON_WRITER_RESULT C2(ToJSON_, name)(JSON_WRITER* writer, const name* value) \
+    { \
+        JSON_WRITER_RESULT result = JSONWriter_AppendLiteral(writer, "{", 1); \
+        size_t separatorSkip = 1; \
+        FOR_EACH_2(WRITE_JSON_MEMBER, __VA_ARGS__) \
+        (void)separatorSkip; \
+        if (result == JSON_WRITER_OK) \
+        { \
+            result = JSONWriter_AppendLiteral(writer, "}", 1); \
+        } \
+        return result; \
+    } \
 
 
 /**
@@ -192,6 +208,7 @@ extern "C"
         (void)destination;                                                                   \
         FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT_GLOBAL_DEINITIALIZE, name, __VA_ARGS__)       \
     }                                                                                        \
+    CREATE_MODEL_TO_JSON(name, __VA_ARGS__)                                                  \
 
     
 
@@ -313,6 +330,24 @@ extern "C"
 #define IDENTITY_MACRO(x) ,x
 #define SERIALIZE_REPORTED_PROPERTIES_FROM_POINTERS(destination, destinationSize, ...) CodeFirst_SendAsyncReported(destination, destinationSize, COUNT_ARG(__VA_ARGS__) FOR_EACH_1(IDENTITY_MACRO, __VA_ARGS__))
 
+/**
+ * @def      SERIALIZE_MODEL_INTO(destination, destinationSize, destinationLength, modelName, device)
+ * This macro writes the JSON representation of all the WITH_DATA properties of
+ * a model instance straight into a caller provided buffer, without going
+ * through the data publisher, the multi tree or the JSON encoder. The values are
+ * formatted as SERIALIZE formats them; keys come in declaration order.
+ *
+ * @param   destination                  Buffer that receives the JSON text.
+ * @param   destinationSize              Size in bytes of destination.
+ * @param   destinationLength            Pointer to a @c size_t that receives the
+ *                                       length of the JSON text. When the buffer
+ *                                       is too small it receives the size needed.
+ * @param   modelName                    The model type (as given to DECLARE_MODEL).
+ * @param   device                       Pointer to the model instance.
+ */
+/*Codes_SRS_SERIALIZER_H_99_121:[ SERIALIZE_MODEL_INTO shall call the SerializeModelInto_<modelName> function generated by DECLARE_MODEL.]*/
+#define SERIALIZE_MODEL_INTO(destination, destinationSize, destinationLength, modelName, device) C2(SerializeModelInto_, modelName)(device, destination, destinationSize, destinationLength)
+
 /**
  * @def   EXECUTE_COMMAND(device, command)
  * Any action that is declared in a model must also have an implementation as
@@ -499,6 +534,83 @@ Actions are discarded, since no marshalling will be done for those when sending
 #define CREATE_ELEMENT_GLOBAL_DEINITIALIZATION(modelName, elem) EXPAND_ARGS(CREATE_SOMETHING_GLOBAL_DEINITIALIZATION(modelName, EXPAND_ARGS(EXPAND_##elem)))
 #define CREATE_MODEL_ELEMENT_GLOBAL_DEINITIALIZE(modelName, elem) EXPAND_ARGS(CREATE_ELEMENT_GLOBAL_DEINITIALIZATION(modelName, elem))
 
+#define CREATE_MODEL_ENTITY_TO_JSON(modelName, callType, ...) EXPAND_ARGS(CREATE_TO_JSON_##callType(modelName, __VA_ARGS__))
+#define CREATE_SOMETHING_TO_JSON(modelName, ...) EXPAND_ARGS(CREATE_MODEL_ENTITY_TO_JSON(modelName, __VA_ARGS__))
+#define CREATE_ELEMENT_TO_JSON(modelName, elem) EXPAND_ARGS(CREATE_SOMETHING_TO_JSON(modelName, EXPAND_ARGS(EXPAND_##elem)))
+#define CREATE_MODEL_ELEMENT_TO_JSON(modelName, elem) EXPAND_ARGS(CREATE_ELEMENT_TO_JSON(modelName, elem))
+
+/*only WITH_DATA is part of what SERIALIZE sends for a model*/
+#define CREATE_TO_JSON_MODEL_PROPERTY(modelName, type, name) WRITE_JSON_MEMBER(type, name)
+#define CREATE_TO_JSON_MODEL_REPORTED_PROPERTY(modelName, type, name) /*do nothing*/
+#define CREATE_TO_JSON_MODEL_DESIRED_PROPERTY(modelName, type, name, ...) /*do nothing*/
+#define CREATE_TO_JSON_MODEL_ACTION(...) /*do nothing*/
+#define CREATE_TO_JSON_MODEL_METHOD(...) /*do nothing*/
+
+/*the key literal carries its leading comma, the first member skips it*/
+#define WRITE_JSON_MEMBER(type, name) \
+    if (result == JSON_WRITER_OK) \
+    { \
+        result = JSONWriter_AppendLiteral(writer, (",\"" TOSTRING(name) "\":") + separatorSkip, sizeof(",\"" TOSTRING(name) "\":") - 1 - separatorSkip); \
+        separatorSkip = 0; \
+    } \
+    if (result == JSON_WRITER_OK) \
+    { \
+        result = C2(ToJSON_, type)(writer, &(value->name)); \
+    }
+
+/*Codes_SRS_SERIALIZER_H_99_122:[ DECLARE_MODEL shall declare a ToJSON_<name> function that writes the WITH_DATA properties of the model as a JSON object, in declaration order.]*/
+/*Codes_SRS_SERIALIZER_H_99_123:[ DECLARE_MODEL shall declare a SerializeModelInto_<name> function that writes the model instance into destination and returns CODEFIRST_OK.]*/
+/*Codes_SRS_SERIALIZER_H_99_124:[ If device, destination or destinationLength are NULL, SerializeModelInto_<name> shall return CODEFIRST_INVALID_ARG.]*/
+/*Codes_SRS_SERIALIZER_H_99_125:[ If the JSON text does not fit in destinationSize bytes, SerializeModelInto_<name> shall set *destinationLength to the size needed and return CODEFIRST_NOT_ENOUGH_MEMORY.]*/
+/*Codes_SRS_SERIALIZER_H_99_126:[ If writing any of the values fails, SerializeModelInto_<name> shall return CODEFIRST_ERROR.]*/
+#define CREATE_MODEL_TO_JSON(name, ...) \
+    static JSON_WRITER_RESULT C2(ToJSON_, name)(JSON_WRITER* writer, const name* value) \
+    { \
+        JSON_WRITER_RESULT result = JSONWriter_AppendLiteral(writer, "{", 1); \
+        size_t separatorSkip = 1; \
+        (void)value; \
+        FOR_EACH_1_KEEP_1(CREATE_MODEL_ELEMENT_TO_JSON, name, __VA_ARGS__) \
+        (void)separatorSkip; \
+        if (result == JSON_WRITER_OK) \
+        { \
+            result = JSONWriter_AppendLiteral(writer, "}", 1); \
+        } \
+        return result; \
+    } \
+    static CODEFIRST_RESULT C2(SerializeModelInto_, name)(const name* device, unsigned char* destination, size_t destinationSize, size_t* destinationLength) \
+    { \
+        CODEFIRST_RESULT result; \
+        JSON_WRITER writer; \
+        if ((device == NULL) || (destination == NULL) || (destinationLength == NULL) || \
+            (JSONWriter_Init(&writer, (char*)destination, destinationSize) != JSON_WRITER_OK)) \
+        { \
+            result = CODEFIRST_INVALID_ARG; \
+            LogError("invalid arg const " TOSTRING(name) "* device=%p, unsigned char* destination=%p, size_t* destinationLength=%p", device, destination, destinationLength); \
+        } \
+        else \
+        { \
+            JSON_WRITER_RESULT writerResult = C2(ToJSON_, name)(&writer, device); \
+            if (writerResult == JSON_WRITER_OK) \
+            { \
+                writerResult = JSONWriter_Finish(&writer, destinationLength); \
+            } \
+            if (writerResult == JSON_WRITER_OK) \
+            { \
+                result = CODEFIRST_OK; \
+            } \
+            else if (writerResult == JSON_WRITER_BUFFER_TOO_SMALL) \
+            { \
+                result = CODEFIRST_NOT_ENOUGH_MEMORY; \
+            } \
+            else \
+            { \
+                result = CODEFIRST_ERROR; \
+                LogError("failure writing " TOSTRING(name) " as JSON"); \
+            } \
+        } \
+        return result; \
+    }
+
 #define INSERT_FIELD_INTO_STRUCT(x, y) x y;
 
 
@@ -1511,10 +1623,118 @@ static void C2(destroyLocalParameter, ascii_char_ptr_no_quotes)(ascii_char_ptr_n
     }
 }
 
+/*Codes_SRS_SERIALIZER_H_99_119:[ For every WITH_DATA type, serializer.h shall provide a ToJSON_<type> function that writes the value straight into a JSON_WRITER, formatted the same way AgentDataTypes_ToString formats it.]*/
+static JSON_WRITER_RESULT C2(ToJSON_, double)(JSON_WRITER* writer, const double* value)
+{
+    return JSONWriter_AppendDouble(writer, *value, DBL_DIG);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, float)(JSON_WRITER* writer, const float* value)
+{
+    return JSONWriter_AppendDouble(writer, (double)*value, FLT_DIG);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int)(JSON_WRITER* writer, const int* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, long)(JSON_WRITER* writer, const long* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int8_t)(JSON_WRITER* writer, const int8_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, uint8_t)(JSON_WRITER* writer, const uint8_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int16_t)(JSON_WRITER* writer, const int16_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int32_t)(JSON_WRITER* writer, const int32_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, int64_t)(JSON_WRITER* writer, const int64_t* value)
+{
+    return JSONWriter_AppendInt64(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, bool)(JSON_WRITER* writer, const bool* value)
+{
+    return JSONWriter_AppendBool(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, ascii_char_ptr)(JSON_WRITER* writer, const ascii_char_ptr* value)
+{
+    return JSONWriter_AppendString(writer, *value);
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, ascii_char_ptr_no_quotes)(JSON_WRITER* writer, const ascii_char_ptr_no_quotes* value)
+{
+    return JSONWriter_AppendRaw(writer, *value);
+}
+
+/*the EDM types below are rarely used in telemetry, they go through AGENT_DATA_TYPE so the text is produced by the very same code*/
+static JSON_WRITER_RESULT C2(ToJSON_, EDM_DATE_TIME_OFFSET)(JSON_WRITER* writer, const EDM_DATE_TIME_OFFSET* value)
+{
+    JSON_WRITER_RESULT result;
+    AGENT_DATA_TYPE agentData;
+    if (C2(ToAGENT_DATA_TYPE_, EDM_DATE_TIME_OFFSET)(&agentData, *value) != AGENT_DATA_TYPES_OK)
+    {
+        result = JSON_WRITER_ERROR;
+    }
+    else
+    {
+        result = JSONWriter_AppendAgentDataType(writer, &agentData);
+        Destroy_AGENT_DATA_TYPE(&agentData);
+    }
+    return result;
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, EDM_GUID)(JSON_WRITER* writer, const EDM_GUID* value)
+{
+    JSON_WRITER_RESULT result;
+    AGENT_DATA_TYPE agentData;
+    if (C2(ToAGENT_DATA_TYPE_, EDM_GUID)(&agentData, *value) != AGENT_DATA_TYPES_OK)
+    {
+        result = JSON_WRITER_ERROR;
+    }
+    else
+    {
+        result = JSONWriter_AppendAgentDataType(writer, &agentData);
+        Destroy_AGENT_DATA_TYPE(&agentData);
+    }
+    return result;
+}
+
+static JSON_WRITER_RESULT C2(ToJSON_, EDM_BINARY)(JSON_WRITER* writer, const EDM_BINARY* value)
+{
+    JSON_WRITER_RESULT result;
+    AGENT_DATA_TYPE agentData;
+    if (C2(ToAGENT_DATA_TYPE_, EDM_BINARY)(&agentData, *value) != AGENT_DATA_TYPES_OK)
+    {
+        result = JSON_WRITER_ERROR;
+    }
+    else
+    {
+        result = JSONWriter_AppendAgentDataType(writer, &agentData);
+        Destroy_AGENT_DATA_TYPE(&agentData);
+    }
+    return result;
+}
+
 #ifdef __cplusplus
     }
 #endif
 
 #endif /*SERIALIZER_H*/
-
-
@@ -6,6 +6,7 @@
 #include "azure_c_shared_utility/gballoc.h"
 
 #include <stddef.h>
+#include <string.h>
 
 #include "commanddecoder.h"
 #include "multitree.h"
@@ -14,6 +15,7 @@
 #include "schema.h"
 #include "codefirst.h"
 #include "jsondecoder.h"
+#include "jsonreader.h"
 
 DEFINE_ENUM_STRINGS(COMMANDDECODER_RESULT, COMMANDDECODER_RESULT_VALUES);
 
@@ -795,184 +797,249 @@ void CommandDecoder_Destroy(COMMAND_DECODER_HANDLE commandDecoderHandle)
 
 DEFINE_ENUM_STRINGS(AGENT_DATA_TYPE_TYPE, AGENT_DATA_TYPE_TYPE_VALUES);
 
-/*validates that the multitree (coming from a JSON) is actually a serialization of the model (complete or incomplete)*/
-/*if the serialization contains more than the model, then it fails.*/
-/*if the serialization does not contain mandatory items from the model, it fails*/
-static bool validateModel_vs_Multitree(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, MULTITREE_HANDLE desiredPropertiesTree, size_t offset)
+static int DecodeValueFromString(SCHEMA_HANDLE schemaHandle, AGENT_DATA_TYPE* agentDataType, char* value, const char* edmTypeName)
 {
-    
-    bool result;
-    size_t nChildren;
-    size_t nProcessedChildren = 0;
-    (void)MultiTree_GetChildCount(desiredPropertiesTree, &nChildren);
-    for (size_t i = 0;i < nChildren;i++)
+    int result;
+    AGENT_DATA_TYPE_TYPE primitiveType = CodeFirst_GetPrimitiveType(edmTypeName);
+
+    if (primitiveType == EDM_NO_TYPE)
     {
-        MULTITREE_HANDLE child;
-        if (MultiTree_GetChild(desiredPropertiesTree, i, &child) != MULTITREE_OK)
+        /*Codes_SRS_COMMAND_DECODER_99_041: [ A struct value shall be decoded from a MULTITREE built out of that value only. ]*/
+        MULTITREE_HANDLE valueTree;
+        if (JSONDecoder_JSON_To_MultiTree(value, &valueTree) != JSON_DECODER_OK)
         {
-            LogError("failure in MultiTree_GetChild");
-            i = nChildren;
+            LogError("failure decoding the struct value");
+            result = __FAILURE__;
         }
         else
         {
-            STRING_HANDLE childName = STRING_new();
-            if (childName == NULL)
+            result = DecodeValueFromNode(schemaHandle, agentDataType, valueTree, edmTypeName);
+            MultiTree_Destroy(valueTree);
+        }
+    }
+    /*Codes_SRS_COMMAND_DECODER_99_042: [ A primitive value shall be decoded by CreateAgentDataType_From_String. ]*/
+    else if (CreateAgentDataType_From_String(value, primitiveType, agentDataType) != AGENT_DATA_TYPES_OK)
+    {
+        LogError("failed parsing value %s", value);
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static EXECUTE_COMMAND_RESULT IngestDesiredProperty(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, JSON_READER* reader, size_t offset, const SCHEMA_DESIRED_ELEMENT* element)
+{
+    EXECUTE_COMMAND_RESULT result;
+    const char* valueBegin;
+    size_t valueLength;
+
+    if (JSONReader_ReadValue(reader, &valueBegin, &valueLength) != JSON_READER_OK)
+    {
+        /*Codes_SRS_COMMAND_DECODER_99_043: [ If jsonPayload is not valid JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+        LogError("failure reading the value of a desired property");
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else
+    {
+        /*Codes_SRS_COMMAND_DECODER_99_040: [ The value of the desired property shall be copied to a zero terminated buffer of the size of the value. ]*/
+        char* value = (char*)malloc(valueLength + 1);
+        if (value == NULL)
+        {
+            LogError("failure in malloc");
+            result = EXECUTE_COMMAND_FAILED;
+        }
+        else
+        {
+            AGENT_DATA_TYPE output;
+            const char* desiredPropertyType;
+
+            (void)memcpy(value, valueBegin, valueLength);
+            value[valueLength] = '\0';
+
+            /*Codes_SRS_COMMAND_DECODER_02_007: [ If the member name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the member value. ]*/
+            desiredPropertyType = Schema_GetModelDesiredPropertyType(element->desiredPropertyHandle);
+            if (DecodeValueFromString(Schema_GetSchemaForModelType(modelHandle), &output, value, desiredPropertyType) != 0)
             {
-                LogError("failure to STRING_new");
-                i = nChildren;
+                LogError("failure in DecodeValueFromString");
+                result = EXECUTE_COMMAND_FAILED;
             }
             else
             {
-                if (MultiTree_GetName(child, childName) != MULTITREE_OK)
+                /*Codes_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
+                pfDesiredPropertyFromAGENT_DATA_TYPE leFunction = Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(element->desiredPropertyHandle);
+                if (leFunction(&output, (char*)startAddress + offset + element->offset) != 0)
                 {
-                    LogError("failure to MultiTree_GetName");
-                    i = nChildren;
+                    LogError("failure in a function that converts from AGENT_DATA_TYPE to C data");
+                    result = EXECUTE_COMMAND_FAILED;
                 }
                 else
                 {
-                    const char *childName_str = STRING_c_str(childName);
-                    SCHEMA_MODEL_ELEMENT elementType = Schema_GetModelElementByName(modelHandle, childName_str);
-                    switch (elementType.elementType)
+                    /*Codes_SRS_COMMAND_DECODER_02_013: [ If the desired property has a non-NULL pfOnDesiredProperty then it shall be called. ]*/
+                    if (element->onDesiredProperty != NULL)
                     {
-                        default:
-                        {
-                            LogError("INTERNAL ERROR: unexpected function return");
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_PROPERTY):
-                        {
-                            LogError("cannot ingest name (WITH_DATA instead of WITH_DESIRED_PROPERTY): %s", STRING_c_str);
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_REPORTED_PROPERTY):
-                        {
-                            LogError("cannot ingest name (WITH_REPORTED_PROPERTY instead of WITH_DESIRED_PROPERTY): %s", STRING_c_str);
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_DESIRED_PROPERTY):
+                        element->onDesiredProperty((char*)startAddress + offset);
+                    }
+                    result = EXECUTE_COMMAND_SUCCESS;
+                }
+                Destroy_AGENT_DATA_TYPE(&output);
+            }
+            free(value);
+        }
+    }
+
+    return result;
+}
+
+/*reads one JSON object and applies its members to the model at startAddress + offset*/
+/*if the object contains more than the model, then it fails.*/
+static EXECUTE_COMMAND_RESULT IngestDesiredPropertiesObject(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, JSON_READER* reader, size_t offset, bool skipVersion)
+{
+    EXECUTE_COMMAND_RESULT result;
+
+    if (JSONReader_BeginObject(reader) != JSON_READER_OK)
+    {
+        /*Codes_SRS_COMMAND_DECODER_99_043: [ If jsonPayload is not valid JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+        LogError("desired properties are not a JSON object");
+        result = EXECUTE_COMMAND_ERROR;
+    }
+    else
+    {
+        bool isEndOfObject = false;
+
+        result = EXECUTE_COMMAND_SUCCESS;
+        while ((result == EXECUTE_COMMAND_SUCCESS) && !isEndOfObject)
+        {
+            const char* name;
+            size_t nameLength;
+
+            if (JSONReader_NextMember(reader, &name, &nameLength, &isEndOfObject) != JSON_READER_OK)
+            {
+                /*Codes_SRS_COMMAND_DECODER_99_043: [ If jsonPayload is not valid JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+                LogError("failure reading a member of the desired properties");
+                result = EXECUTE_COMMAND_ERROR;
+            }
+            else if (isEndOfObject)
+            {
+                /*Codes_SRS_COMMAND_DECODER_02_010: [ If every member has been ingested then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
+            }
+            else if (skipVersion && (nameLength == sizeof("$version") - 1) && (memcmp(name, "$version", nameLength) == 0))
+            {
+                /*Codes_SRS_COMMAND_DECODER_02_015: [ The `$version` member of the desired properties shall be skipped, if it is present. It not being present is not an error. ]*/
+                if (JSONReader_ReadValue(reader, NULL, NULL) != JSON_READER_OK)
+                {
+                    LogError("failure reading $version");
+                    result = EXECUTE_COMMAND_ERROR;
+                }
+            }
+            else
+            {
+                SCHEMA_DESIRED_ELEMENT element = Schema_GetModelDesiredElementByName(modelHandle, name, nameLength);
+                switch (element.elementType)
+                {
+                    default:
+                    {
+                        /*Codes_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+                        LogError("cannot ingest name %.*s, it is not a desired property (WITH_DESIRED_PROPERTY) of the model", (int)nameLength, name);
+                        result = EXECUTE_COMMAND_FAILED;
+                        break;
+                    }
+                    case (SCHEMA_DESIRED_PROPERTY):
+                    {
+                        result = IngestDesiredProperty(startAddress, modelHandle, reader, offset, &element);
+                        break;
+                    }
+                    case (SCHEMA_MODEL_IN_MODEL):
+                    {
+                        /*Codes_SRS_COMMAND_DECODER_02_009: [ If the member name corresponds to a model in model then the function shall call itself recursively on the member value. ]*/
+                        result = IngestDesiredPropertiesObject(startAddress, element.modelHandle, reader, offset + element.offset, false);
+                        if (result != EXECUTE_COMMAND_SUCCESS)
                         {
-                            /*Codes_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the MULTITREE node. ]*/
-                            SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle = elementType.elementHandle.desiredPropertyHandle;
-                            
-                            const char* desiredPropertyType = Schema_GetModelDesiredPropertyType(desiredPropertyHandle);
-                            AGENT_DATA_TYPE output;
-                            if (DecodeValueFromNode(Schema_GetSchemaForModelType(modelHandle), &output, child, desiredPropertyType) != 0)
-                            {
-                                LogError("failure in DecodeValueFromNode");
-                                i = nChildren;
-                            }
-                            else
-                            {
-                                /*Codes_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
-                                pfDesiredPropertyFromAGENT_DATA_TYPE leFunction = Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(desiredPropertyHandle);
-                                if (leFunction(&output, (char*)startAddress + offset + Schema_GetModelDesiredProperty_offset(desiredPropertyHandle)) != 0)
-                                {
-                                    LogError("failure in a function that converts from AGENT_DATA_TYPE to C data");
-                                }
-                                else
-                                {
-                                    /*Codes_SRS_COMMAND_DECODER_02_013: [ If the desired property has a non-NULL pfOnDesiredProperty then it shall be called. ]*/
-                                    pfOnDesiredProperty onDesiredProperty = Schema_GetModelDesiredProperty_pfOnDesiredProperty(desiredPropertyHandle);
-                                    if (onDesiredProperty != NULL)
-                                    {
-                                        onDesiredProperty((char*)startAddress + offset);
-                                    }
-                                    nProcessedChildren++;
-                                }
-                                Destroy_AGENT_DATA_TYPE(&output);
-                            }
-                            
-                            break;
+                            LogError("failure in IngestDesiredPropertiesObject");
                         }
-                        case(SCHEMA_MODEL_IN_MODEL):
+                        else
                         {
-                            SCHEMA_MODEL_TYPE_HANDLE modelModel = elementType.elementHandle.modelHandle;
-                            
-                            /*Codes_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
-                            if (!validateModel_vs_Multitree(startAddress, modelModel, child, offset + Schema_GetModelModelByName_Offset(modelHandle, childName_str)))
+                            /*if the model in model so happened to be a WITH_DESIRED_PROPERTY... (only those has non_NULL pfOnDesiredProperty) */
+                            /*Codes_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called. ]*/
+                            if (element.onDesiredProperty != NULL)
                             {
-                                LogError("failure in validateModel_vs_Multitree");
-                                i = nChildren;
-                            }
-                            else
-                            {
-                                /*if the model in model so happened to be a WITH_DESIRED_PROPERTY... (only those has non_NULL pfOnDesiredProperty) */
-                                /*Codes_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called. ]*/
-                                pfOnDesiredProperty onDesiredProperty = Schema_GetModelModelByName_OnDesiredProperty(modelHandle, childName_str);
-                                if (onDesiredProperty != NULL)
-                                {
-                                    onDesiredProperty((char*)startAddress + offset);
-                                }
-                                
-                                nProcessedChildren++;
+                                element.onDesiredProperty((char*)startAddress + offset);
                             }
-                            
-                            break;
                         }
-
-                    } /*switch*/
-                }
-                STRING_delete(childName);
+                        break;
+                    }
+                } /*switch*/
             }
         }
     }
 
-    if(nProcessedChildren == nChildren)
+    return result;
+}
+
+/* Raw JSON has properties we don't need: for a full TWIN everything but "desired" is skipped */
+static bool SeekDesiredNode(JSON_READER* reader)
+{
+    bool result = false;
+
+    if (JSONReader_BeginObject(reader) != JSON_READER_OK)
     {
-        /*Codes_SRS_COMMAND_DECODER_02_010: [ If the complete MULTITREE has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
-        result = true;
+        LogError("twin is not a JSON object");
     }
     else
     {
-        /*Codes_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
-        LogError("not all constituents of the JSON have been ingested");
-        result = false;
+        bool isEndOfObject = false;
+
+        while (!isEndOfObject)
+        {
+            const char* name;
+            size_t nameLength;
+
+            if (JSONReader_NextMember(reader, &name, &nameLength, &isEndOfObject) != JSON_READER_OK)
+            {
+                LogError("failure reading a member of the twin");
+                break;
+            }
+            else if (isEndOfObject)
+            {
+                LogError("Unable to find 'desired' in the twin");
+            }
+            else if ((nameLength == sizeof("desired") - 1) && (memcmp(name, "desired", nameLength) == 0))
+            {
+                result = true;
+                break;
+            }
+            else if (JSONReader_ReadValue(reader, NULL, NULL) != JSON_READER_OK)
+            {
+                LogError("failure skipping a member of the twin");
+                break;
+            }
+        }
     }
-    return result;
-}
 
-static EXECUTE_COMMAND_RESULT DecodeDesiredProperties(void* startAddress, COMMAND_DECODER_HANDLE_DATA* handle, MULTITREE_HANDLE desiredPropertiesTree)
-{
-    /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-    return validateModel_vs_Multitree(startAddress, handle->ModelHandle, desiredPropertiesTree, 0 )?EXECUTE_COMMAND_SUCCESS:EXECUTE_COMMAND_FAILED;
+    return result;
 }
 
-/* Raw JSON has properties we don't need; potentially nodes other than "desired" for full TWIN as well as a $version we don't pass to callees */
-static bool RemoveUnneededTwinProperties(MULTITREE_HANDLE initialParsedTree, bool parseDesiredNode, MULTITREE_HANDLE *desiredPropertiesTree)
+/* the members that follow "desired" are not ingested, but the twin still has to be valid JSON */
+static bool SkipRemainingTwinMembers(JSON_READER* reader)
 {
-    MULTITREE_HANDLE updateTree;
-    bool result;
+    bool result = true;
+    bool isEndOfObject = false;
 
-    if (parseDesiredNode)
+    while (result && !isEndOfObject)
     {
-        /*Codes_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, parse only the `desired` part of JSON tree ]*/
-        if (MultiTree_GetChildByName(initialParsedTree, "desired", &updateTree) != MULTITREE_OK)
+        const char* name;
+        size_t nameLength;
+
+        if ((JSONReader_NextMember(reader, &name, &nameLength, &isEndOfObject) != JSON_READER_OK) ||
+            (!isEndOfObject && (JSONReader_ReadValue(reader, NULL, NULL) != JSON_READER_OK)))
         {
-            LogError("Unable to find 'desired' in tree");
-            return false;
+            LogError("failure reading the members after 'desired'");
+            result = false;
         }
     }
-    else
-    {
-        // Tree already starts on node we want so just use it.
-        updateTree = initialParsedTree;
-    }
-
-    /*Codes_COMMAND_DECODER_02_015: [ Remove '$version' string from node, if it is present.  It not being present is not an error ]*/
-    MULTITREE_RESULT deleteChildResult = MultiTree_DeleteChild(updateTree, "$version");
-    if ((deleteChildResult == MULTITREE_OK) || (deleteChildResult == MULTITREE_CHILD_NOT_FOUND))
-    {
-        *desiredPropertiesTree = updateTree;
-        result = true;
-    }
-    else
-    {
-        *desiredPropertiesTree = NULL;
-        result = false;
-    }
 
     return result;
 }
@@ -995,43 +1062,32 @@ EXECUTE_COMMAND_RESULT CommandDecoder_IngestDesiredProperties(void* startAddress
     }
     else
     {
-        /*Codes_SRS_COMMAND_DECODER_02_004: [ CommandDecoder_IngestDesiredProperties shall clone desiredProperties. ]*/
-        char* copy;
-        if (mallocAndStrcpy_s(&copy, jsonPayload) != 0)
+        COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
+        JSON_READER reader;
+
+        /*Codes_SRS_COMMAND_DECODER_99_038: [ CommandDecoder_IngestDesiredProperties shall read jsonPayload in place, in a single pass, without copying it. ]*/
+        (void)JSONReader_Init(&reader, jsonPayload);
+
+        /*Codes_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, only the value of the `desired` member of the twin shall be ingested. ]*/
+        if (parseDesiredNode && !SeekDesiredNode(&reader))
         {
-            LogError("failure in mallocAndStrcpy_s");
-            result = EXECUTE_COMMAND_FAILED;
+            /*Codes_SRS_COMMAND_DECODER_99_039: [ If parseDesiredNode is TRUE and the twin has no `desired` member then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+            LogError("Unable to find 'desired' in the twin");
+            result = EXECUTE_COMMAND_ERROR;
         }
         else
         {
-            /*Codes_SRS_COMMAND_DECODER_02_005: [ CommandDecoder_IngestDesiredProperties shall create a MULTITREE_HANDLE ouf of the clone of desiredProperties. ]*/
-            MULTITREE_HANDLE initialParsedTree;
-            MULTITREE_HANDLE desiredPropertiesTree;
-
-            if (JSONDecoder_JSON_To_MultiTree(copy, &initialParsedTree) != JSON_DECODER_OK)
-            {
-                LogError("Decoding JSON to a multi tree failed");
-                result = EXECUTE_COMMAND_ERROR;
-            }
-            else
+            result = IngestDesiredPropertiesObject(startAddress, commandDecoderInstance->ModelHandle, &reader, 0, true);
+            if (result == EXECUTE_COMMAND_SUCCESS)
             {
-                if (RemoveUnneededTwinProperties(initialParsedTree, parseDesiredNode, &desiredPropertiesTree) == false)
+                if ((parseDesiredNode && !SkipRemainingTwinMembers(&reader)) ||
+                    (JSONReader_End(&reader) != JSON_READER_OK))
                 {
-                    LogError("Removing unneeded twin properties failed");
+                    /*Codes_SRS_COMMAND_DECODER_99_043: [ If jsonPayload is not valid JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+                    LogError("desired properties are followed by malformed JSON");
                     result = EXECUTE_COMMAND_ERROR;
                 }
-                else
-                {
-                    COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
-
-                    /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-                    result = DecodeDesiredProperties(startAddress, commandDecoderInstance, desiredPropertiesTree);
-
-                    // Do NOT free desiredPropertiesTree.  It is only a pointer into initialParsedTree.
-                    MultiTree_Destroy(initialParsedTree);
-                }
             }
-            free(copy);
         }
     }
     return result;
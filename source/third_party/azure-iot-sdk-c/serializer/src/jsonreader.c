@@ -0,0 +1,419 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <string.h>
+
+#include "jsonreader.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+DEFINE_ENUM_STRINGS(JSON_READER_RESULT, JSON_READER_RESULT_VALUES);
+
+#define IsWhiteSpace(A) (((A) == 0x20) || ((A) == 0x09) || ((A) == 0x0A) || ((A) == 0x0D))
+
+static const char* SkipWhiteSpaces(const char* json)
+{
+    while ((*json != '\0') && IsWhiteSpace(*json))
+    {
+        json++;
+    }
+    return json;
+}
+
+/* the scanners below accept the same grammar as jsondecoder.c. Each returns a pointer past the scanned token, or NULL */
+static const char* ScanString(const char* json)
+{
+    const char* result;
+
+    if (*json != '"')
+    {
+        result = NULL;
+    }
+    else
+    {
+        json++;
+        while ((*json != '"') && (*json != '\0'))
+        {
+            if (*json == '\\')
+            {
+                json++;
+                if ((*json == '\\') || (*json == '"') || (*json == '/') ||
+                    (*json == 'b') || (*json == 'f') || (*json == 'n') || (*json == 'r') || (*json == 't'))
+                {
+                    json++;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            else
+            {
+                json++;
+            }
+        }
+
+        result = (*json == '"') ? json + 1 : NULL;
+    }
+
+    return result;
+}
+
+static const char* ScanDigits(const char* json, size_t* digitCount)
+{
+    *digitCount = 0;
+    while (ISDIGIT(*json))
+    {
+        (*digitCount)++;
+        json++;
+    }
+    return json;
+}
+
+static const char* ScanNumber(const char* json)
+{
+    const char* result;
+    size_t digitCount;
+
+    if (*json == '-')
+    {
+        json++;
+    }
+
+    result = ScanDigits(json, &digitCount);
+    if ((digitCount == 0) ||
+        ((digitCount > 1) && (*json == '0')))
+    {
+        result = NULL;
+    }
+    else
+    {
+        if (*result == '.')
+        {
+            result = ScanDigits(result + 1, &digitCount);
+            if (digitCount == 0)
+            {
+                result = NULL;
+            }
+        }
+
+        if ((result != NULL) &&
+            ((*result == 'e') || (*result == 'E')))
+        {
+            result++;
+            if ((*result == '-') || (*result == '+'))
+            {
+                result++;
+            }
+
+            result = ScanDigits(result, &digitCount);
+            if (digitCount == 0)
+            {
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+static const char* ScanValue(const char* json);
+
+static const char* ScanObject(const char* json)
+{
+    const char* result = SkipWhiteSpaces(json + 1);
+
+    if (*result == '}')
+    {
+        result++;
+    }
+    else
+    {
+        while (result != NULL)
+        {
+            if (((result = ScanString(result)) == NULL) ||
+                (*(result = SkipWhiteSpaces(result)) != ':') ||
+                ((result = ScanValue(result + 1)) == NULL))
+            {
+                result = NULL;
+            }
+            else
+            {
+                result = SkipWhiteSpaces(result);
+                if (*result == ',')
+                {
+                    result = SkipWhiteSpaces(result + 1);
+                }
+                else if (*result == '}')
+                {
+                    result++;
+                    break;
+                }
+                else
+                {
+                    result = NULL;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static const char* ScanArray(const char* json)
+{
+    const char* result = SkipWhiteSpaces(json + 1);
+
+    if (*result == ']')
+    {
+        result++;
+    }
+    else
+    {
+        while (result != NULL)
+        {
+            if ((result = ScanValue(result)) != NULL)
+            {
+                result = SkipWhiteSpaces(result);
+                if (*result == ',')
+                {
+                    result++;
+                }
+                else if (*result == ']')
+                {
+                    result++;
+                    break;
+                }
+                else
+                {
+                    result = NULL;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static const char* ScanValue(const char* json)
+{
+    const char* result;
+
+    json = SkipWhiteSpaces(json);
+
+    if (*json == '"')
+    {
+        result = ScanString(json);
+    }
+    else if (*json == '{')
+    {
+        result = ScanObject(json);
+    }
+    else if (*json == '[')
+    {
+        result = ScanArray(json);
+    }
+    else if (strncmp(json, "false", 5) == 0)
+    {
+        result = json + 5;
+    }
+    else if ((strncmp(json, "true", 4) == 0) || (strncmp(json, "null", 4) == 0))
+    {
+        result = json + 4;
+    }
+    else if (ISDIGIT(*json) || (*json == '-'))
+    {
+        result = ScanNumber(json);
+    }
+    else
+    {
+        result = NULL;
+    }
+
+    return result;
+}
+
+JSON_READER_RESULT JSONReader_Init(JSON_READER* reader, const char* json)
+{
+    JSON_READER_RESULT result;
+
+    /*Codes_SRS_JSON_READER_99_001: [ If reader or json is NULL, JSONReader_Init shall return JSON_READER_INVALID_ARG. ]*/
+    if ((reader == NULL) ||
+        (json == NULL))
+    {
+        result = JSON_READER_INVALID_ARG;
+        LogError("invalid arg JSON_READER* reader=%p, const char* json=%p", reader, json);
+    }
+    else
+    {
+        /*Codes_SRS_JSON_READER_99_002: [ JSONReader_Init shall set the reader to read from the beginning of json and return JSON_READER_OK. ]*/
+        reader->json = json;
+        reader->isFirstMember = false;
+        result = JSON_READER_OK;
+    }
+
+    return result;
+}
+
+JSON_READER_RESULT JSONReader_BeginObject(JSON_READER* reader)
+{
+    JSON_READER_RESULT result;
+
+    /*Codes_SRS_JSON_READER_99_003: [ If reader is NULL, JSONReader_BeginObject shall return JSON_READER_INVALID_ARG. ]*/
+    if (reader == NULL)
+    {
+        result = JSON_READER_INVALID_ARG;
+        LogError("invalid arg JSON_READER* reader=%p", reader);
+    }
+    else
+    {
+        const char* json = SkipWhiteSpaces(reader->json);
+        if (*json != '{')
+        {
+            /*Codes_SRS_JSON_READER_99_004: [ If the next value is not an object, JSONReader_BeginObject shall return JSON_READER_PARSE_ERROR. ]*/
+            result = JSON_READER_PARSE_ERROR;
+            LogError("expected '{' at \"%.16s\"", json);
+        }
+        else
+        {
+            /*Codes_SRS_JSON_READER_99_005: [ Otherwise JSONReader_BeginObject shall consume the opening curly bracket and return JSON_READER_OK. ]*/
+            reader->json = json + 1;
+            reader->isFirstMember = true;
+            result = JSON_READER_OK;
+        }
+    }
+
+    return result;
+}
+
+JSON_READER_RESULT JSONReader_NextMember(JSON_READER* reader, const char** name, size_t* nameLength, bool* isEndOfObject)
+{
+    JSON_READER_RESULT result;
+
+    /*Codes_SRS_JSON_READER_99_006: [ If reader, name, nameLength or isEndOfObject is NULL, JSONReader_NextMember shall return JSON_READER_INVALID_ARG. ]*/
+    if ((reader == NULL) ||
+        (name == NULL) ||
+        (nameLength == NULL) ||
+        (isEndOfObject == NULL))
+    {
+        result = JSON_READER_INVALID_ARG;
+        LogError("invalid arg JSON_READER* reader=%p, const char** name=%p, size_t* nameLength=%p, bool* isEndOfObject=%p", reader, name, nameLength, isEndOfObject);
+    }
+    else
+    {
+        const char* json = SkipWhiteSpaces(reader->json);
+        if (*json == '}')
+        {
+            /*Codes_SRS_JSON_READER_99_007: [ If the object ends, JSONReader_NextMember shall consume the closing curly bracket, set isEndOfObject to true and return JSON_READER_OK. ]*/
+            reader->json = json + 1;
+            reader->isFirstMember = false;
+            *isEndOfObject = true;
+            result = JSON_READER_OK;
+        }
+        else
+        {
+            const char* nameEnd = NULL;
+            const char* colon = NULL;
+
+            /*Codes_SRS_JSON_READER_99_008: [ Every member except the first one shall be preceded by a comma. ]*/
+            if (!reader->isFirstMember)
+            {
+                json = (*json == ',') ? SkipWhiteSpaces(json + 1) : NULL;
+            }
+
+            if (json != NULL)
+            {
+                nameEnd = ScanString(json);
+                if (nameEnd != NULL)
+                {
+                    colon = SkipWhiteSpaces(nameEnd);
+                }
+            }
+
+            if ((colon == NULL) ||
+                (*colon != ':'))
+            {
+                /*Codes_SRS_JSON_READER_99_009: [ If the member name or the colon that follows it is malformed, JSONReader_NextMember shall return JSON_READER_PARSE_ERROR. ]*/
+                result = JSON_READER_PARSE_ERROR;
+                LogError("malformed member at \"%.16s\"", reader->json);
+            }
+            else
+            {
+                /*Codes_SRS_JSON_READER_99_010: [ Otherwise JSONReader_NextMember shall set name to the first character of the member name as it appears between the quotes, nameLength to its length, isEndOfObject to false, consume the colon and return JSON_READER_OK. ]*/
+                *name = json + 1;
+                *nameLength = (size_t)(nameEnd - json - 2);
+                *isEndOfObject = false;
+                reader->json = colon + 1;
+                reader->isFirstMember = false;
+                result = JSON_READER_OK;
+            }
+        }
+    }
+
+    return result;
+}
+
+JSON_READER_RESULT JSONReader_ReadValue(JSON_READER* reader, const char** value, size_t* valueLength)
+{
+    JSON_READER_RESULT result;
+
+    /*Codes_SRS_JSON_READER_99_011: [ If reader is NULL, JSONReader_ReadValue shall return JSON_READER_INVALID_ARG. ]*/
+    if (reader == NULL)
+    {
+        result = JSON_READER_INVALID_ARG;
+        LogError("invalid arg JSON_READER* reader=%p", reader);
+    }
+    else
+    {
+        const char* valueBegin = SkipWhiteSpaces(reader->json);
+        const char* valueEnd = ScanValue(valueBegin);
+        if (valueEnd == NULL)
+        {
+            /*Codes_SRS_JSON_READER_99_012: [ If the next value is malformed, JSONReader_ReadValue shall return JSON_READER_PARSE_ERROR. ]*/
+            result = JSON_READER_PARSE_ERROR;
+            LogError("malformed value at \"%.16s\"", valueBegin);
+        }
+        else
+        {
+            /*Codes_SRS_JSON_READER_99_013: [ JSONReader_ReadValue shall consume the complete next value, including nested objects and arrays. ]*/
+            /*Codes_SRS_JSON_READER_99_014: [ If value is not NULL, JSONReader_ReadValue shall set it to the first character of the value and set valueLength (if not NULL) to the length of the value. String values keep their quotes. ]*/
+            if (value != NULL)
+            {
+                *value = valueBegin;
+            }
+            if (valueLength != NULL)
+            {
+                *valueLength = (size_t)(valueEnd - valueBegin);
+            }
+            reader->json = valueEnd;
+            result = JSON_READER_OK;
+        }
+    }
+
+    return result;
+}
+
+JSON_READER_RESULT JSONReader_End(JSON_READER* reader)
+{
+    JSON_READER_RESULT result;
+
+    /*Codes_SRS_JSON_READER_99_015: [ If reader is NULL, JSONReader_End shall return JSON_READER_INVALID_ARG. ]*/
+    if (reader == NULL)
+    {
+        result = JSON_READER_INVALID_ARG;
+        LogError("invalid arg JSON_READER* reader=%p", reader);
+    }
+    else if (*SkipWhiteSpaces(reader->json) != '\0')
+    {
+        /*Codes_SRS_JSON_READER_99_016: [ If anything but white spaces follows the last value, JSONReader_End shall return JSON_READER_PARSE_ERROR. ]*/
+        result = JSON_READER_PARSE_ERROR;
+        LogError("unexpected characters after the JSON text at \"%.16s\"", reader->json);
+    }
+    else
+    {
+        /*Codes_SRS_JSON_READER_99_017: [ Otherwise JSONReader_End shall return JSON_READER_OK. ]*/
+        result = JSON_READER_OK;
+    }
+
+    return result;
+}
@@ -0,0 +1,382 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/gballoc.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#include "jsonwriter.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+DEFINE_ENUM_STRINGS(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+
+#define NaN_STRING "NaN"
+#define MINUSINF_STRING "-INF"
+#define PLUSINF_STRING "INF"
+
+/* same bound agenttypesystem uses when printing doubles */
+#define MAX_FLOATING_POINT_STRING_LENGTH (DECIMAL_DIG * 2 + 2)
+
+static const char jsonWriterHexDigits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+/* 0 - copied as is, 1 - escaped with a backslash, 2 - escaped as \u00XX. Matches AgentDataTypes_ToString */
+static const unsigned char jsonWriterEscapeTable[128] =
+{
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static void write_bytes(JSON_WRITER* writer, const char* source, size_t sourceLength)
+{
+    if (writer->length < writer->size)
+    {
+        size_t available = writer->size - writer->length;
+        (void)memcpy(writer->buffer + writer->length, source, (sourceLength < available) ? sourceLength : available);
+    }
+
+    writer->length += sourceLength;
+}
+
+static void write_char(JSON_WRITER* writer, char c)
+{
+    if (writer->length < writer->size)
+    {
+        writer->buffer[writer->length] = c;
+    }
+
+    writer->length++;
+}
+
+JSON_WRITER_RESULT JSONWriter_Init(JSON_WRITER* writer, char* destination, size_t destinationSize)
+{
+    JSON_WRITER_RESULT result;
+
+    /*Codes_SRS_JSON_WRITER_99_001: [ If writer is NULL, or destination is NULL while destinationSize is not 0, JSONWriter_Init shall return JSON_WRITER_INVALID_ARG. ]*/
+    if ((writer == NULL) ||
+        ((destination == NULL) && (destinationSize != 0)))
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER* writer=%p, char* destination=%p, size_t destinationSize=%zu", writer, destination, destinationSize);
+    }
+    else
+    {
+        /*Codes_SRS_JSON_WRITER_99_002: [ JSONWriter_Init shall set the writer to write at the beginning of destination and return JSON_WRITER_OK. ]*/
+        writer->buffer = destination;
+        writer->size = destinationSize;
+        writer->length = 0;
+        result = JSON_WRITER_OK;
+    }
+
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendLiteral(JSON_WRITER* writer, const char* literal, size_t literalLength)
+{
+    JSON_WRITER_RESULT result;
+
+    /*Codes_SRS_JSON_WRITER_99_003: [ If writer or literal is NULL, JSONWriter_AppendLiteral shall return JSON_WRITER_INVALID_ARG. ]*/
+    if ((writer == NULL) || (literal == NULL))
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER* writer=%p, const char* literal=%p", writer, literal);
+    }
+    else
+    {
+        /*Codes_SRS_JSON_WRITER_99_004: [ JSONWriter_AppendLiteral shall copy literalLength characters of literal without any encoding. ]*/
+        write_bytes(writer, literal, literalLength);
+        result = JSON_WRITER_OK;
+    }
+
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendInt64(JSON_WRITER* writer, int64_t value)
+{
+    JSON_WRITER_RESULT result;
+
+    /*Codes_SRS_JSON_WRITER_99_005: [ If writer is NULL, JSONWriter_AppendInt64 shall return JSON_WRITER_INVALID_ARG. ]*/
+    if (writer == NULL)
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER* writer=NULL");
+    }
+    else
+    {
+        /*Codes_SRS_JSON_WRITER_99_006: [ JSONWriter_AppendInt64 shall write value in decimal, with a leading '-' for negative values. ]*/
+        char digits[21]; /*19 digits and sign*/
+        size_t pos = sizeof(digits);
+        uint64_t positiveValue = (value < 0) ? (0 - (uint64_t)value) : (uint64_t)value;
+
+        do
+        {
+            digits[--pos] = (char)('0' + (positiveValue % 10));
+            positiveValue /= 10;
+        } while (positiveValue != 0);
+
+        if (value < 0)
+        {
+            digits[--pos] = '-';
+        }
+
+        write_bytes(writer, digits + pos, sizeof(digits) - pos);
+        result = JSON_WRITER_OK;
+    }
+
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendDouble(JSON_WRITER* writer, double value, int digits)
+{
+    JSON_WRITER_RESULT result;
+
+    /*Codes_SRS_JSON_WRITER_99_007: [ If writer is NULL or digits is negative, JSONWriter_AppendDouble shall return JSON_WRITER_INVALID_ARG. ]*/
+    if ((writer == NULL) || (digits < 0))
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER* writer=%p, int digits=%d", writer, digits);
+    }
+    /*Codes_SRS_JSON_WRITER_99_008: [ NaN, -INF and INF shall be written as NaN, -INF and INF, unquoted. ]*/
+    else if (ISNAN(value))
+    {
+        write_bytes(writer, NaN_STRING, sizeof(NaN_STRING) - 1);
+        result = JSON_WRITER_OK;
+    }
+    else if (ISNEGATIVEINFINITY(value))
+    {
+        write_bytes(writer, MINUSINF_STRING, sizeof(MINUSINF_STRING) - 1);
+        result = JSON_WRITER_OK;
+    }
+    else if (ISPOSITIVEINFINITY(value))
+    {
+        write_bytes(writer, PLUSINF_STRING, sizeof(PLUSINF_STRING) - 1);
+        result = JSON_WRITER_OK;
+    }
+    else
+    {
+        /*Codes_SRS_JSON_WRITER_99_009: [ Otherwise JSONWriter_AppendDouble shall write value using the "%.*f" format with digits as the precision. ]*/
+        char temp[MAX_FLOATING_POINT_STRING_LENGTH + DBL_MAX_10_EXP];
+        int printed = snprintf(temp, sizeof(temp), "%.*f", digits, value);
+        if ((printed < 0) || ((size_t)printed >= sizeof(temp)))
+        {
+            /*Codes_SRS_JSON_WRITER_99_010: [ If formatting the value fails, JSONWriter_AppendDouble shall return JSON_WRITER_ERROR. ]*/
+            result = JSON_WRITER_ERROR;
+            LogError("failure formatting double value");
+        }
+        else
+        {
+            write_bytes(writer, temp, (size_t)printed);
+            result = JSON_WRITER_OK;
+        }
+    }
+
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendBool(JSON_WRITER* writer, bool value)
+{
+    JSON_WRITER_RESULT result;
+
+    /*Codes_SRS_JSON_WRITER_99_011: [ If writer is NULL, JSONWriter_AppendBool shall return JSON_WRITER_INVALID_ARG. ]*/
+    if (writer == NULL)
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER* writer=NULL");
+    }
+    else
+    {
+        /*Codes_SRS_JSON_WRITER_99_012: [ JSONWriter_AppendBool shall write true or false. ]*/
+        if (value)
+        {
+            write_bytes(writer, "true", sizeof("true") - 1);
+        }
+        else
+        {
+            write_bytes(writer, "false", sizeof("false") - 1);
+        }
+        result = JSON_WRITER_OK;
+    }
+
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendString(JSON_WRITER* writer, const char* value)
+{
+    JSON_WRITER_RESULT result;
+
+    /*Codes_SRS_JSON_WRITER_99_013: [ If writer or value is NULL, JSONWriter_AppendString shall return JSON_WRITER_INVALID_ARG. ]*/
+    if ((writer == NULL) || (value == NULL))
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER* writer=%p, const char* value=%p", writer, value);
+    }
+    else
+    {
+        size_t startLength = writer->length;
+        const char* runStart = value;
+        const char* current = value;
+
+        /*Codes_SRS_JSON_WRITER_99_014: [ JSONWriter_AppendString shall write value between quotes, escaping '"', '\\' and '/' with a backslash and control characters as \u00XX. ]*/
+        write_char(writer, '"');
+
+        result = JSON_WRITER_OK;
+        while (*current != '\0')
+        {
+            unsigned char c = (unsigned char)*current;
+            if (c >= 128)
+            {
+                /*Codes_SRS_JSON_WRITER_99_015: [ If value contains characters above 127, JSONWriter_AppendString shall return JSON_WRITER_INVALID_ARG and leave the writer unchanged. ]*/
+                result = JSON_WRITER_INVALID_ARG;
+                LogError("string contains non-ASCII characters");
+                break;
+            }
+            else if (jsonWriterEscapeTable[c] == 0)
+            {
+                current++;
+            }
+            else
+            {
+                write_bytes(writer, runStart, (size_t)(current - runStart));
+                if (jsonWriterEscapeTable[c] == 1)
+                {
+                    char escaped[2];
+                    escaped[0] = '\\';
+                    escaped[1] = (char)c;
+                    write_bytes(writer, escaped, sizeof(escaped));
+                }
+                else
+                {
+                    char escaped[6];
+                    escaped[0] = '\\';
+                    escaped[1] = 'u';
+                    escaped[2] = '0';
+                    escaped[3] = '0';
+                    escaped[4] = jsonWriterHexDigits[(c & 0xF0) >> 4];
+                    escaped[5] = jsonWriterHexDigits[c & 0x0F];
+                    write_bytes(writer, escaped, sizeof(escaped));
+                }
+                current++;
+                runStart = current;
+            }
+        }
+
+        if (result != JSON_WRITER_OK)
+        {
+            writer->length = startLength;
+        }
+        else
+        {
+            write_bytes(writer, runStart, (size_t)(current - runStart));
+            write_char(writer, '"');
+        }
+    }
+
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendRaw(JSON_WRITER* writer, const char* value)
+{
+    JSON_WRITER_RESULT result;
+
+    /*Codes_SRS_JSON_WRITER_99_016: [ If writer or value is NULL, JSONWriter_AppendRaw shall return JSON_WRITER_INVALID_ARG. ]*/
+    if ((writer == NULL) || (value == NULL))
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER* writer=%p, const char* value=%p", writer, value);
+    }
+    else
+    {
+        /*Codes_SRS_JSON_WRITER_99_017: [ JSONWriter_AppendRaw shall copy value as is, without quotes. ]*/
+        write_bytes(writer, value, strlen(value));
+        result = JSON_WRITER_OK;
+    }
+
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_AppendAgentDataType(JSON_WRITER* writer, const AGENT_DATA_TYPE* value)
+{
+    JSON_WRITER_RESULT result;
+
+    /*Codes_SRS_JSON_WRITER_99_018: [ If writer or value is NULL, JSONWriter_AppendAgentDataType shall return JSON_WRITER_INVALID_ARG. ]*/
+    if ((writer == NULL) || (value == NULL))
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER* writer=%p, const AGENT_DATA_TYPE* value=%p", writer, value);
+    }
+    else
+    {
+        /*Codes_SRS_JSON_WRITER_99_019: [ JSONWriter_AppendAgentDataType shall convert value with AgentDataTypes_ToString and copy the result. ]*/
+        STRING_HANDLE valueAsString = STRING_new();
+        if (valueAsString == NULL)
+        {
+            /*Codes_SRS_JSON_WRITER_99_020: [ If any of the conversion steps fail, JSONWriter_AppendAgentDataType shall return JSON_WRITER_ERROR. ]*/
+            result = JSON_WRITER_ERROR;
+            LogError("failure in STRING_new");
+        }
+        else
+        {
+            if (AgentDataTypes_ToString(valueAsString, value) != AGENT_DATA_TYPES_OK)
+            {
+                result = JSON_WRITER_ERROR;
+                LogError("failure in AgentDataTypes_ToString");
+            }
+            else
+            {
+                const char* valueText = STRING_c_str(valueAsString);
+                size_t valueLength = STRING_length(valueAsString);
+                write_bytes(writer, valueText, valueLength);
+                result = JSON_WRITER_OK;
+            }
+
+            STRING_delete(valueAsString);
+        }
+    }
+
+    return result;
+}
+
+JSON_WRITER_RESULT JSONWriter_Finish(JSON_WRITER* writer, size_t* destinationLength)
+{
+    JSON_WRITER_RESULT result;
+
+    /*Codes_SRS_JSON_WRITER_99_021: [ If writer or destinationLength is NULL, JSONWriter_Finish shall return JSON_WRITER_INVALID_ARG. ]*/
+    if ((writer == NULL) || (destinationLength == NULL))
+    {
+        result = JSON_WRITER_INVALID_ARG;
+        LogError("invalid arg JSON_WRITER* writer=%p, size_t* destinationLength=%p", writer, destinationLength);
+    }
+    else
+    {
+        /*Codes_SRS_JSON_WRITER_99_022: [ JSONWriter_Finish shall set *destinationLength to the number of characters the output needs. ]*/
+        *destinationLength = writer->length;
+
+        if (writer->length > writer->size)
+        {
+            /*Codes_SRS_JSON_WRITER_99_023: [ If the output did not fit in the destination, JSONWriter_Finish shall return JSON_WRITER_BUFFER_TOO_SMALL. ]*/
+            result = JSON_WRITER_BUFFER_TOO_SMALL;
+        }
+        else
+        {
+            /*Codes_SRS_JSON_WRITER_99_024: [ If there is room after the output, JSONWriter_Finish shall zero terminate it. ]*/
+            if (writer->length < writer->size)
+            {
+                writer->buffer[writer->length] = '\0';
+            }
+            result = JSON_WRITER_OK;
+        }
+    }
+
+    return result;
+}
@@ -68,6 +68,12 @@ typedef struct MODEL_IN_MODEL_TAG
     SCHEMA_MODEL_TYPE_HANDLE modelHandle;
 } MODEL_IN_MODEL;
 
+typedef struct DESIRED_ELEMENT_INDEX_ENTRY_TAG
+{
+    const char* name; /*points to the name owned by the desired property or by the model in model*/
+    SCHEMA_DESIRED_ELEMENT element;
+} DESIRED_ELEMENT_INDEX_ENTRY;
+
 typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
 {
     VECTOR_HANDLE methods; /*holds SCHEMA_METHOD_HANDLE*/
@@ -81,6 +87,8 @@ typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
     size_t ActionCount;
     VECTOR_HANDLE models;
     size_t DeviceCount;
+    DESIRED_ELEMENT_INDEX_ENTRY* desiredElementIndex; /*desired properties and models in model sorted by name, built on first lookup*/
+    size_t desiredElementIndexCount;
 } SCHEMA_MODEL_TYPE_HANDLE_DATA;
 
 typedef struct SCHEMA_STRUCT_TYPE_HANDLE_DATA_TAG
@@ -191,6 +199,16 @@ static void DestroyStruct(SCHEMA_STRUCT_TYPE_HANDLE structTypeHandle)
     }
 }
 
+static void InvalidateDesiredElementIndex(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    if (modelType->desiredElementIndex != NULL)
+    {
+        free(modelType->desiredElementIndex);
+        modelType->desiredElementIndex = NULL;
+        modelType->desiredElementIndexCount = 0;
+    }
+}
+
 static void DestroyModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
 {
     SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
@@ -243,6 +261,8 @@ static void DestroyModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
     VECTOR_clear(modelType->models);
     VECTOR_destroy(modelType->models);
 
+    InvalidateDesiredElementIndex(modelType);
+
     free(modelType->Actions);
     free(modelType);
 }
@@ -705,6 +725,8 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_CreateModelType(SCHEMA_HANDLE schemaHandle, cons
                                     modelType->Actions = NULL;
                                     modelType->SchemaHandle = schemaHandle;
                                     modelType->DeviceCount = 0;
+                                    modelType->desiredElementIndex = NULL;
+                                    modelType->desiredElementIndexCount = 0;
 
                                     schema->ModelTypes[schema->ModelTypeCount] = modelType;
                                     schema->ModelTypeCount++;
@@ -2294,7 +2316,7 @@ SCHEMA_RESULT Schema_AddModelModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, con
         else
         {
             /*Codes_SRS_SCHEMA_99_164: [If the function succeeds, then the return value shall be SCHEMA_OK.]*/
-            
+            InvalidateDesiredElementIndex(parentModel);
             result = SCHEMA_OK;
         }
     }
@@ -2773,6 +2795,7 @@ SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                             desiredProperty->desiredPropertDeinitialize = desiredPropertyDeinitialize;
                             desiredProperty->onDesiredProperty = onDesiredProperty; /*NULL is a perfectly fine value*/
                             desiredProperty->offset = offset;
+                            InvalidateDesiredElementIndex(handleData);
                             result = SCHEMA_OK;
                         }
                     }
@@ -3130,6 +3153,187 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
     return result;
 }
 
+/*compares a name that is not zero terminated with a zero terminated one, the same way strcmp would*/
+static int compareDesiredElementName(const char* name, size_t nameLength, const char* indexedName)
+{
+    int result = strncmp(name, indexedName, nameLength);
+    if ((result == 0) && (indexedName[nameLength] != '\0'))
+    {
+        result = -1;
+    }
+    return result;
+}
+
+static int compareDesiredElementIndexEntries(const void* left, const void* right)
+{
+    const DESIRED_ELEMENT_INDEX_ENTRY* leftEntry = (const DESIRED_ELEMENT_INDEX_ENTRY*)left;
+    const DESIRED_ELEMENT_INDEX_ENTRY* rightEntry = (const DESIRED_ELEMENT_INDEX_ENTRY*)right;
+    int result = strcmp(leftEntry->name, rightEntry->name);
+    if (result == 0)
+    {
+        /*desired properties come first, the same precedence Schema_GetModelElementByName has*/
+        result = (int)leftEntry->element.elementType - (int)rightEntry->element.elementType;
+    }
+    return result;
+}
+
+static void fillDesiredPropertyElement(SCHEMA_DESIRED_ELEMENT* element, SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty)
+{
+    element->elementType = SCHEMA_DESIRED_PROPERTY;
+    element->desiredPropertyHandle = desiredProperty;
+    element->modelHandle = NULL;
+    element->offset = desiredProperty->offset;
+    element->onDesiredProperty = desiredProperty->onDesiredProperty;
+}
+
+static void fillModelInModelElement(SCHEMA_DESIRED_ELEMENT* element, const MODEL_IN_MODEL* modelInModel)
+{
+    element->elementType = SCHEMA_MODEL_IN_MODEL;
+    element->desiredPropertyHandle = NULL;
+    element->modelHandle = modelInModel->modelHandle;
+    element->offset = modelInModel->offset;
+    element->onDesiredProperty = modelInModel->onDesiredProperty;
+}
+
+static int buildDesiredElementIndex(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    int result;
+    size_t nDesiredProperties = VECTOR_size(modelType->desiredProperties);
+    size_t nModels = VECTOR_size(modelType->models);
+
+    if (nDesiredProperties + nModels == 0)
+    {
+        /*nothing to index, every lookup is SCHEMA_NOT_FOUND*/
+        result = 0;
+    }
+    else
+    {
+        DESIRED_ELEMENT_INDEX_ENTRY* index = (DESIRED_ELEMENT_INDEX_ENTRY*)malloc((nDesiredProperties + nModels) * sizeof(DESIRED_ELEMENT_INDEX_ENTRY));
+        if (index == NULL)
+        {
+            LogError("failure in malloc");
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t i;
+            for (i = 0; i < nDesiredProperties; i++)
+            {
+                SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty = *(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->desiredProperties, i);
+                index[i].name = desiredProperty->desiredPropertyName;
+                fillDesiredPropertyElement(&index[i].element, desiredProperty);
+            }
+            for (i = 0; i < nModels; i++)
+            {
+                MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+                index[nDesiredProperties + i].name = modelInModel->propertyName;
+                fillModelInModelElement(&index[nDesiredProperties + i].element, modelInModel);
+            }
+
+            qsort(index, nDesiredProperties + nModels, sizeof(DESIRED_ELEMENT_INDEX_ENTRY), compareDesiredElementIndexEntries);
+
+            modelType->desiredElementIndex = index;
+            modelType->desiredElementIndexCount = nDesiredProperties + nModels;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static SCHEMA_DESIRED_ELEMENT findDesiredElementLinear(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, const char* elementName, size_t elementNameLength)
+{
+    SCHEMA_DESIRED_ELEMENT result;
+    size_t nDesiredProperties = VECTOR_size(modelType->desiredProperties);
+    size_t nModels = VECTOR_size(modelType->models);
+    size_t i;
+
+    result.elementType = SCHEMA_NOT_FOUND;
+
+    for (i = 0; i < nDesiredProperties; i++)
+    {
+        SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* desiredProperty = *(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->desiredProperties, i);
+        if (compareDesiredElementName(elementName, elementNameLength, desiredProperty->desiredPropertyName) == 0)
+        {
+            fillDesiredPropertyElement(&result, desiredProperty);
+            break;
+        }
+    }
+
+    if (result.elementType == SCHEMA_NOT_FOUND)
+    {
+        for (i = 0; i < nModels; i++)
+        {
+            MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+            if (compareDesiredElementName(elementName, elementNameLength, modelInModel->propertyName) == 0)
+            {
+                fillModelInModelElement(&result, modelInModel);
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+SCHEMA_DESIRED_ELEMENT Schema_GetModelDesiredElementByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* elementName, size_t elementNameLength)
+{
+    SCHEMA_DESIRED_ELEMENT result;
+    /*Codes_SRS_SCHEMA_99_184: [ If modelTypeHandle or elementName is NULL then Schema_GetModelDesiredElementByName shall fail and set SCHEMA_DESIRED_ELEMENT.elementType to SCHEMA_SEARCH_INVALID_ARG. ]*/
+    if (
+        (modelTypeHandle == NULL) ||
+        (elementName == NULL)
+        )
+    {
+        LogError("invalid argument SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle=%p, const char* elementName=%p", modelTypeHandle, elementName);
+        result.elementType = SCHEMA_SEARCH_INVALID_ARG;
+    }
+    else
+    {
+        SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
+
+        /*Codes_SRS_SCHEMA_99_185: [ On the first call after a desired property or a model in model has been added, Schema_GetModelDesiredElementByName shall build an index of the desired properties and models in model of the model, sorted by name. ]*/
+        if ((handleData->desiredElementIndex == NULL) &&
+            (buildDesiredElementIndex(handleData) != 0))
+        {
+            /*Codes_SRS_SCHEMA_99_186: [ If building the index fails, Schema_GetModelDesiredElementByName shall search the desired properties and models in model one by one. ]*/
+            result = findDesiredElementLinear(handleData, elementName, elementNameLength);
+        }
+        else
+        {
+            /*Codes_SRS_SCHEMA_99_187: [ Schema_GetModelDesiredElementByName shall look up the first elementNameLength characters of elementName in the index with a binary search. ]*/
+            size_t low = 0;
+            size_t high = handleData->desiredElementIndexCount;
+            while (low < high)
+            {
+                size_t middle = low + (high - low) / 2;
+                if (compareDesiredElementName(elementName, elementNameLength, handleData->desiredElementIndex[middle].name) > 0)
+                {
+                    low = middle + 1;
+                }
+                else
+                {
+                    high = middle;
+                }
+            }
+
+            if ((low < handleData->desiredElementIndexCount) &&
+                (compareDesiredElementName(elementName, elementNameLength, handleData->desiredElementIndex[low].name) == 0))
+            {
+                /*Codes_SRS_SCHEMA_99_188: [ If the name is a desired property, Schema_GetModelDesiredElementByName shall set elementType to SCHEMA_DESIRED_PROPERTY, desiredPropertyHandle to the desired property and offset and onDesiredProperty to the values the desired property was added with. ]*/
+                /*Codes_SRS_SCHEMA_99_189: [ If the name is a model in model, Schema_GetModelDesiredElementByName shall set elementType to SCHEMA_MODEL_IN_MODEL, modelHandle to the model and offset and onDesiredProperty to the values the model in model was added with. ]*/
+                result = handleData->desiredElementIndex[low].element;
+            }
+            else
+            {
+                /*Codes_SRS_SCHEMA_99_190: [ Otherwise Schema_GetModelDesiredElementByName shall set elementType to SCHEMA_NOT_FOUND. ]*/
+                result.elementType = SCHEMA_NOT_FOUND;
+            }
+        }
+    }
+    return result;
+}
+
 pfDesiredPropertyDeinitialize Schema_GetModelDesiredProperty_pfDesiredPropertyDeinitialize(SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle)
 {
     pfDesiredPropertyDeinitialize result;
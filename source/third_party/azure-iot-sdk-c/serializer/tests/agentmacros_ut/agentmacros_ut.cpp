@@ -249,6 +249,25 @@ public:
     MOCK_STATIC_METHOD_2(, int, mallocAndStrcpy_s, char**, destination, const char*, source)
         int result2 = BASEIMPLEMENTATION::mallocAndStrcpy_s(destination, source);
     MOCK_METHOD_END(int, result2);
+    /* JSONWriter mocks */
+    MOCK_STATIC_METHOD_3(, JSON_WRITER_RESULT, JSONWriter_Init, JSON_WRITER*, writer, char*, destination, size_t, destinationSize)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_3(, JSON_WRITER_RESULT, JSONWriter_AppendLiteral, JSON_WRITER*, writer, const char*, literal, size_t, literalLength)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendInt64, JSON_WRITER*, writer, int64_t, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_3(, JSON_WRITER_RESULT, JSONWriter_AppendDouble, JSON_WRITER*, writer, double, value, int, digits)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendBool, JSON_WRITER*, writer, bool, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendString, JSON_WRITER*, writer, const char*, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendRaw, JSON_WRITER*, writer, const char*, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendAgentDataType, JSON_WRITER*, writer, const AGENT_DATA_TYPE*, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_Finish, JSON_WRITER*, writer, size_t*, destinationLength)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
 };
 
 DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_SINT32, AGENT_DATA_TYPE*, agentData, int32_t, v);
@@ -256,6 +275,15 @@ DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , AGENT_DATA_TYPES_RESULT, Create_
 DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_charz_no_quotes, AGENT_DATA_TYPE*, agentData, const char*, v);
 DECLARE_GLOBAL_MOCK_METHOD_5(AgentMacroMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_Members, AGENT_DATA_TYPE*, agentData, const char*, typeName, size_t, nMembers, const char* const *, memberNames, const AGENT_DATA_TYPE*, memberValues);
 DECLARE_GLOBAL_MOCK_METHOD_1(AgentMacroMocks, , void, Destroy_AGENT_DATA_TYPE, AGENT_DATA_TYPE*, agentData);
+DECLARE_GLOBAL_MOCK_METHOD_3(AgentMacroMocks, , JSON_WRITER_RESULT, JSONWriter_Init, JSON_WRITER*, writer, char*, destination, size_t, destinationSize);
+DECLARE_GLOBAL_MOCK_METHOD_3(AgentMacroMocks, , JSON_WRITER_RESULT, JSONWriter_AppendLiteral, JSON_WRITER*, writer, const char*, literal, size_t, literalLength);
+DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , JSON_WRITER_RESULT, JSONWriter_AppendInt64, JSON_WRITER*, writer, int64_t, value);
+DECLARE_GLOBAL_MOCK_METHOD_3(AgentMacroMocks, , JSON_WRITER_RESULT, JSONWriter_AppendDouble, JSON_WRITER*, writer, double, value, int, digits);
+DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , JSON_WRITER_RESULT, JSONWriter_AppendBool, JSON_WRITER*, writer, bool, value);
+DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , JSON_WRITER_RESULT, JSONWriter_AppendString, JSON_WRITER*, writer, const char*, value);
+DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , JSON_WRITER_RESULT, JSONWriter_AppendRaw, JSON_WRITER*, writer, const char*, value);
+DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , JSON_WRITER_RESULT, JSONWriter_AppendAgentDataType, JSON_WRITER*, writer, const AGENT_DATA_TYPE*, value);
+DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , JSON_WRITER_RESULT, JSONWriter_Finish, JSON_WRITER*, writer, size_t*, destinationLength);
 DECLARE_GLOBAL_MOCK_METHOD_3(AgentMacroMocks, , EXECUTE_COMMAND_RESULT, lotsOfAction, modelWithAction*, device, double, x, ascii_char_ptr, y);
 DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , EXECUTE_COMMAND_RESULT, simpleAction, modelWithEachElement*, device, int, actionArg1);
 DECLARE_GLOBAL_MOCK_METHOD_2(AgentMacroMocks, , SCHEMA_HANDLE, CodeFirst_RegisterSchema, const char*, schemaNamespace, const REFLECTED_DATA_FROM_DATAPROVIDER*, metadata);
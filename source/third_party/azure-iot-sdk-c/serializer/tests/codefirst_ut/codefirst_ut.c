@@ -37,6 +37,7 @@ void my_gballoc_free(void * t)
 #include "schema.h"
 #include "iotdevice.h"
 #include "azure_c_shared_utility/strings.h"
+#include "jsonwriter.h"
 #undef ENABLE_MOCKS
 
 #include "real_strings.h"
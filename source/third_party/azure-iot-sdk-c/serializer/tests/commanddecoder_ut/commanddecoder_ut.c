@@ -49,6 +49,7 @@ MOCKABLE_FUNCTION(, void, onDesiredPropertyModelInModel, void*, v);
 #undef ENABLE_MOCKS
 
 #include "commanddecoder.h"
+#include "jsonreader.h"
 
 #define ENABLE_MOCKS
 #include "codefirst.h" 
@@ -214,9 +215,10 @@ static AGENT_DATA_TYPES_RESULT my_Create_AGENT_DATA_TYPE_from_Members(AGENT_DATA
 }
 
 static SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName_notFound; 
-static SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName_desiredProperty_int_field;
 
-static SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName_modelInModel;
+static SCHEMA_DESIRED_ELEMENT Schema_GetModelDesiredElementByName_notFound;
+static SCHEMA_DESIRED_ELEMENT Schema_GetModelDesiredElementByName_desiredProperty_int_field;
+static SCHEMA_DESIRED_ELEMENT Schema_GetModelDesiredElementByName_modelInModel;
 
 
 char* umockvalue_stringify_SCHEMA_MODEL_ELEMENT(const SCHEMA_MODEL_ELEMENT* value)
@@ -275,6 +277,51 @@ void umockvalue_free_SCHEMA_MODEL_ELEMENT(SCHEMA_MODEL_ELEMENT* value)
     //my_gballoc_free(value);
 }
 
+char* umockvalue_stringify_SCHEMA_DESIRED_ELEMENT(const SCHEMA_DESIRED_ELEMENT* value)
+{
+    char* result;
+    size_t needed = snprintf(NULL, 0, "{.elementType=%s, .desiredPropertyHandle=%p, .modelHandle=%p, .offset=%zu}", ENUM_TO_STRING(SCHEMA_ELEMENT_TYPE, value->elementType), value->desiredPropertyHandle, value->modelHandle, value->offset);
+    result = (char*)malloc(needed + 1);
+    if (result == NULL)
+    {
+        ASSERT_FAIL("unable to malloc");
+    }
+    else
+    {
+        (void) snprintf(result, needed + 1, "{.elementType=%s, .desiredPropertyHandle=%p, .modelHandle=%p, .offset=%zu}", ENUM_TO_STRING(SCHEMA_ELEMENT_TYPE, value->elementType), value->desiredPropertyHandle, value->modelHandle, value->offset);
+    }
+    return result;
+}
+
+int umockvalue_are_equal_SCHEMA_DESIRED_ELEMENT(const SCHEMA_DESIRED_ELEMENT* left, const SCHEMA_DESIRED_ELEMENT* right)
+{
+    int result;
+    if ((left == NULL) || (right == NULL))
+    {
+        result = (left == right);
+    }
+    else
+    {
+        result = (left->elementType == right->elementType) &&
+            (left->desiredPropertyHandle == right->desiredPropertyHandle) &&
+            (left->modelHandle == right->modelHandle) &&
+            (left->offset == right->offset) &&
+            (left->onDesiredProperty == right->onDesiredProperty);
+    }
+    return result;
+}
+
+int umockvalue_copy_SCHEMA_DESIRED_ELEMENT(SCHEMA_DESIRED_ELEMENT* destination, const SCHEMA_DESIRED_ELEMENT* source)
+{
+    (void)memcpy(destination, source, sizeof(*destination));
+    return 0;
+}
+
+void umockvalue_free_SCHEMA_DESIRED_ELEMENT(SCHEMA_DESIRED_ELEMENT* value)
+{
+    (void)(value);
+}
+
 static METHODRETURN_HANDLE g_methodReturnValue = (METHODRETURN_HANDLE)0x3;
 
 BEGIN_TEST_SUITE(CommandDecoder_ut)
@@ -285,10 +332,14 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         Schema_GetModelElementByName_notFound.elementType = SCHEMA_NOT_FOUND;
 
-        Schema_GetModelElementByName_desiredProperty_int_field.elementType = SCHEMA_DESIRED_PROPERTY;
-        Schema_GetModelElementByName_desiredProperty_int_field.elementHandle.desiredPropertyHandle = TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD;
-        Schema_GetModelElementByName_modelInModel.elementType = SCHEMA_MODEL_IN_MODEL;
-        Schema_GetModelElementByName_modelInModel.elementHandle.modelHandle = SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL;
+        Schema_GetModelDesiredElementByName_notFound.elementType = SCHEMA_NOT_FOUND;
+
+        Schema_GetModelDesiredElementByName_desiredProperty_int_field.elementType = SCHEMA_DESIRED_PROPERTY;
+        Schema_GetModelDesiredElementByName_desiredProperty_int_field.desiredPropertyHandle = TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD;
+        Schema_GetModelDesiredElementByName_desiredProperty_int_field.offset = 2;
+        Schema_GetModelDesiredElementByName_modelInModel.elementType = SCHEMA_MODEL_IN_MODEL;
+        Schema_GetModelDesiredElementByName_modelInModel.modelHandle = SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL;
+        Schema_GetModelDesiredElementByName_modelInModel.offset = 10;
 
         g_testByTest = TEST_MUTEX_CREATE();
         ASSERT_IS_NOT_NULL(g_testByTest);
@@ -337,6 +388,13 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
             umockvalue_free_SCHEMA_MODEL_ELEMENT
         );
 
+        REGISTER_UMOCK_VALUE_TYPE(SCHEMA_DESIRED_ELEMENT,
+            umockvalue_stringify_SCHEMA_DESIRED_ELEMENT,
+            umockvalue_are_equal_SCHEMA_DESIRED_ELEMENT,
+            umockvalue_copy_SCHEMA_DESIRED_ELEMENT,
+            umockvalue_free_SCHEMA_DESIRED_ELEMENT
+        );
+
         REGISTER_GLOBAL_MOCK_HOOK(JSONDecoder_JSON_To_MultiTree, my_JSONDecoder_JSON_To_MultiTree);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_JSON_To_MultiTree, JSON_DECODER_ERROR);
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Destroy, my_MultiTree_Destroy);
@@ -375,6 +433,7 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_new, NULL);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(MultiTree_GetName, MULTITREE_ERROR);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Schema_GetModelElementByName, Schema_GetModelElementByName_notFound);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(Schema_GetModelDesiredElementByName, Schema_GetModelDesiredElementByName_notFound);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(Schema_GetModelDesiredPropertyByName, NULL);
         
         REGISTER_GLOBAL_MOCK_RETURN(CreateAgentDataType_From_String, AGENT_DATA_TYPES_OK);
@@ -2991,95 +3050,61 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    void CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, size_t one, MULTITREE_HANDLE childHandle, bool desiredPropertyHasCallback)
+    static void CommandDecoder_IngestDesiredProperties_int_field_inert_path(unsigned char* deviceMemoryArea, SCHEMA_MODEL_TYPE_HANDLE modelHandle, size_t modelOffset, bool desiredPropertyHasCallback)
     {
-        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
-            .IgnoreArgument_destination();
-
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
-
-        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_childName();
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*2*/
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_count(&one, sizeof(one));
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
-
-        STRICT_EXPECTED_CALL(STRING_new())
-            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
+        SCHEMA_DESIRED_ELEMENT desiredProperty_int_field = Schema_GetModelDesiredElementByName_desiredProperty_int_field;
+        desiredProperty_int_field.onDesiredProperty = desiredPropertyHasCallback ? onDesiredPropertySimpleProperty : NULL;
 
-        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "int_field"*/
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredElementByName(modelHandle, IGNORED_PTR_ARG, sizeof("int_field") - 1))
+            .IgnoreArgument_elementName()
+            .SetReturn(desiredProperty_int_field);
 
-        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*6*/
-            .SetReturn("int_field");
-
-        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "int_field"))
-            .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
+        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof("3"))); /*the copy of the value*/
 
         STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
             .SetReturn("int");
 
-        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE))
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(modelHandle))
             .SetReturn(TEST_SCHEMA);
 
-        /*this is DecodeValueFromNode expected calls*/
-
         STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
             .SetReturn(EDM_INT32_TYPE);
 
-        STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_destination(&three, sizeof(three));
-
-        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(IGNORED_PTR_ARG, EDM_INT32_TYPE, IGNORED_PTR_ARG))
-            .IgnoreArgument_source()
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String("3", EDM_INT32_TYPE, IGNORED_PTR_ARG))
             .IgnoreArgument_agentData()
             .SetReturn(AGENT_DATA_TYPES_OK);
 
         STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
             .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
 
-        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
-            .SetReturn(2);
-
-        STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 2))
+        STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + modelOffset + 2))
             .IgnoreArgument_source();
 
-        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG))
-            .IgnoreArgument_desiredPropertyHandle()
-            .SetReturn(desiredPropertyHasCallback ? onDesiredPropertySimpleProperty : NULL);
-
         if (desiredPropertyHasCallback)
         {
-            STRICT_EXPECTED_CALL(onDesiredPropertySimpleProperty(IGNORED_PTR_ARG))
-                .IgnoreArgument_v();
+            STRICT_EXPECTED_CALL(onDesiredPropertySimpleProperty((unsigned char*)deviceMemoryArea + modelOffset));
         }
 
         STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
             .IgnoreArgument_agentData();
 
-        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
             .IgnoreArgument_ptr();
     }
 
+    static void CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(unsigned char* deviceMemoryArea, bool desiredPropertyHasCallback)
+    {
+        CommandDecoder_IngestDesiredProperties_int_field_inert_path(deviceMemoryArea, TEST_MODEL_HANDLE, 0, desiredPropertyHasCallback);
+    }
+
     /*case1: a simple property (non-recursive) is ingested*/
     /*the property is called "int_field" and shall have the value 3*/
-    /*Tests_SRS_COMMAND_DECODER_02_005: [ CommandDecoder_IngestDesiredProperties shall create a MULTITREE_HANDLE ouf of the clone of desiredProperties. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the MULTITREE node. ]*/
+    /*Tests_SRS_COMMAND_DECODER_99_038: [ CommandDecoder_IngestDesiredProperties shall read jsonPayload in place, in a single pass, without copying it. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_007: [ If the member name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the member value. ]*/
+    /*Tests_SRS_COMMAND_DECODER_99_040: [ The value of the desired property shall be copied to a zero terminated buffer of the size of the value. ]*/
+    /*Tests_SRS_COMMAND_DECODER_99_042: [ A primitive value shall be decoded by CreateAgentDataType_From_String. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_010: [ If the complete MULTITREE has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_010: [ If every member has been ingested then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
     TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_happy_path)
     {
         ///arrange
@@ -3087,11 +3112,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, false);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3112,33 +3134,21 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
         (void)umock_c_negative_tests_init();
         umock_c_reset_all_calls();
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, false);
 
         umock_c_negative_tests_snapshot();
 
         size_t calls_that_cannot_fail[] =
         {
-            2, /*MultiTree_DeleteChild*/
-        
-            3,/*MultiTree_GetChildCount*/
-            7, /*STRING_c_str*/
-
-            9, /*Schema_GetModelDesiredPropertyType*/
-            10, /*Schema_GetSchemaForModelType*/
-            11, /*CodeFirst_GetPrimitiveType*/
-            14, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            15, /*Schema_GetModelDesiredProperty_offset*/
-            17, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            18, /*Destroy_AGENT_DATA_TYPE*/
-            19, /*STRING_delete*/
-            20, /*MultiTree_Destroy*/
-            21 /*gballoc_free*/
+            2, /*Schema_GetModelDesiredPropertyType*/
+            3, /*Schema_GetSchemaForModelType*/
+            4, /*CodeFirst_GetPrimitiveType*/
+            6, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
+            8, /*Destroy_AGENT_DATA_TYPE*/
+            9 /*gballoc_free*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3163,7 +3173,7 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
                 EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
 
                 ///assert
-                ASSERT_ARE_NOT_EQUAL_WITH_MSG(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result, temp_str);
+                ASSERT_ARE_EQUAL_WITH_MSG(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result, temp_str);
             }
         }
 
@@ -3173,129 +3183,25 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    void CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, size_t one, MULTITREE_HANDLE childHandle, bool desiredPropertiesHaveCallbacks)
+    static void CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(unsigned char* deviceMemoryArea, bool desiredPropertiesHaveCallbacks)
     {
-        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
-            .IgnoreArgument_destination();
-
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
-
-        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_childName();
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*2*/
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_count(&one, sizeof(one));
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
-
-        STRICT_EXPECTED_CALL(STRING_new())
-            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
-
-        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "modelInModel"*/
-
-        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*6*/
-            .SetReturn("modelInModel");
+        SCHEMA_DESIRED_ELEMENT modelInModel = Schema_GetModelDesiredElementByName_modelInModel;
+        modelInModel.onDesiredProperty = desiredPropertiesHaveCallbacks ? onDesiredPropertyModelInModel : NULL;
 
-        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "modelInModel"))
-            .SetReturn(Schema_GetModelElementByName_modelInModel);
-
-        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel")) /*9*/
-            .SetReturn(10);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredElementByName(TEST_MODEL_HANDLE, IGNORED_PTR_ARG, sizeof("modelInModel") - 1))
+            .IgnoreArgument_elementName()
+            .SetReturn(modelInModel);
 
         /*here recursion happens*/
-
-        {
-            STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*10*/
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_count(&one, sizeof(one));
-
-            STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
-
-            STRICT_EXPECTED_CALL(STRING_new())
-                .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
-
-            STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*13*/ /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "int_field"*/
-
-            STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*14*/
-                .SetReturn("int_field");
-
-            STRICT_EXPECTED_CALL(Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, "int_field"))
-                .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
-
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*17*/
-                .SetReturn("int");
-
-            STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL)) /*18*/
-                .SetReturn(TEST_SCHEMA);
-
-            /*this is DecodeValueFromNodea expected calls*/
-
-            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int")) /*19*/
-                .SetReturn(EDM_INT32_TYPE);
-
-            STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_destination(&three, sizeof(three));
-
-            STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(IGNORED_PTR_ARG, EDM_INT32_TYPE, IGNORED_PTR_ARG))
-                .IgnoreArgument_source()
-                .IgnoreArgument_agentData()
-                .SetReturn(AGENT_DATA_TYPES_OK);
-
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*22*/
-                .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
-
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*23*/
-                .SetReturn(2);
-
-            STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 12))  /*notice here the new offset (2+10)*/
-                .IgnoreArgument_source();
-
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG)) /*24*/
-                .IgnoreArgument_desiredPropertyHandle()
-                .SetReturn(desiredPropertiesHaveCallbacks ? onDesiredPropertySimpleProperty : NULL);
-
-            if (desiredPropertiesHaveCallbacks)
-            {
-                STRICT_EXPECTED_CALL(onDesiredPropertySimpleProperty(IGNORED_PTR_ARG))
-                    .IgnoreArgument_v();
-            }
-
-
-            STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
-                .IgnoreArgument_agentData();
-
-            STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-        }
-
-        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_OnDesiredProperty(IGNORED_PTR_ARG, "modelInModel")) /*27*/
-            .IgnoreArgument_modelTypeHandle()
-            .SetReturn(desiredPropertiesHaveCallbacks ? onDesiredPropertyModelInModel : NULL);
+        CommandDecoder_IngestDesiredProperties_int_field_inert_path(deviceMemoryArea, SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, 10, desiredPropertiesHaveCallbacks); /*notice here the new offset (2+10)*/
 
         if (desiredPropertiesHaveCallbacks)
         {
-            STRICT_EXPECTED_CALL(onDesiredPropertyModelInModel(IGNORED_PTR_ARG))
-                .IgnoreArgument_v();
+            STRICT_EXPECTED_CALL(onDesiredPropertyModelInModel(deviceMemoryArea));
         }
-
-        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
-    /*Tests_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_009: [ If the member name corresponds to a model in model then the function shall call itself recursively on the member value. ]*/
     TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_happy_path)
     {
         ///arrange
@@ -3303,11 +3209,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, false);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3328,37 +3231,21 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
         (void)umock_c_negative_tests_init();
         umock_c_reset_all_calls();
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, false);
 
         umock_c_negative_tests_snapshot();
 
         size_t calls_that_cannot_fail[] =
         {
-            2, /*MultiTree_DeleteChild*/
-            3, /*MultiTree_GetChildCount*/
-            7, /*STRING_c_str*/
-            9, /*Schema_GetModelModelByName_Offset*/
-            10, /*MultiTree_GetChildCount*/
-            13, /*MultiTree_GetName*/
-            14, /*STRING_c_str*/
-            16, /*Schema_GetModelDesiredPropertyType*/
-            17, /*Schema_GetSchemaForModelType*/
-            18, /*CodeFirst_GetPrimitiveType*/
-            21, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            22, /*Schema_GetModelDesiredProperty_offset*/
-            24, /*Destroy_AGENT_DATA_TYPE*/
-            25, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            26, /*STRING_delete*/
-            27, /*STRING_delete*/
-            28, /*Schema_GetModelModelByName_OnDesiredProperty*/
-            29, /*MultiTree_Destroy*/
-            30, /*gballoc_free*/
+            3, /*Schema_GetModelDesiredPropertyType*/
+            4, /*Schema_GetSchemaForModelType*/
+            5, /*CodeFirst_GetPrimitiveType*/
+            7, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
+            9, /*Destroy_AGENT_DATA_TYPE*/
+            10, /*gballoc_free*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3383,7 +3270,7 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
                 EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
 
                 ///assert
-                ASSERT_ARE_NOT_EQUAL_WITH_MSG(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result, temp_str);
+                ASSERT_ARE_EQUAL_WITH_MSG(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result, temp_str);
             }
             
         }
@@ -3402,11 +3289,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, true);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, true);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3429,11 +3313,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         umock_c_reset_all_calls();
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
-        const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, true);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, true);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3446,6 +3327,160 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
 
     }
+
+    /*Tests_SRS_COMMAND_DECODER_02_015: [ The `$version` member of the desired properties shall be skipped, if it is present. It not being present is not an error. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_skips_version)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"$version\":7,\"int_field\":3}";
+
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, false);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, only the value of the `desired` member of the twin shall be ingested. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_parseDesiredNode_ingests_only_desired)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* twinJSON = "{\"reported\":{\"int_field\":4},\"desired\":{\"int_field\":3,\"$version\":7},\"other\":[1,{\"int_field\":5}]}";
+
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, false);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, twinJSON, true);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_99_039: [ If parseDesiredNode is TRUE and the twin has no `desired` member then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_parseDesiredNode_and_no_desired_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* twinJSON = "{\"reported\":{\"int_field\":4}}";
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, twinJSON, true);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_unknown_member_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"no_such_field\":3}";
+
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredElementByName(TEST_MODEL_HANDLE, IGNORED_PTR_ARG, sizeof("no_such_field") - 1))
+            .IgnoreArgument_elementName()
+            .SetReturn(Schema_GetModelDesiredElementByName_notFound);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_FAILED, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_99_043: [ If jsonPayload is not valid JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_malformed_value_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":}";
+
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredElementByName(TEST_MODEL_HANDLE, IGNORED_PTR_ARG, sizeof("int_field") - 1))
+            .IgnoreArgument_elementName()
+            .SetReturn(Schema_GetModelDesiredElementByName_desiredProperty_int_field);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_99_043: [ If jsonPayload is not valid JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_malformed_member_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\" 3}";
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_99_043: [ If jsonPayload is not valid JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_trailing_characters_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":3} }";
+
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, false);
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
     
     /*Tests_SRS_COMMAND_DECODER_02_014: [ If handle is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
     TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_handle_fails)
@@ -0,0 +1,428 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#endif
+
+#include "testrunnerswitcher.h"
+
+#include "jsonreader.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+TEST_DEFINE_ENUM_TYPE(JSON_READER_RESULT, JSON_READER_RESULT_VALUES);
+
+static void assert_next_member(JSON_READER* reader, const char* expectedName)
+{
+    const char* name;
+    size_t nameLength;
+    bool isEndOfObject;
+
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, JSONReader_NextMember(reader, &name, &nameLength, &isEndOfObject));
+    ASSERT_IS_FALSE(isEndOfObject);
+    ASSERT_ARE_EQUAL(size_t, strlen(expectedName), nameLength);
+    ASSERT_IS_TRUE(strncmp(expectedName, name, nameLength) == 0);
+}
+
+static void assert_end_of_object(JSON_READER* reader)
+{
+    const char* name;
+    size_t nameLength;
+    bool isEndOfObject;
+
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, JSONReader_NextMember(reader, &name, &nameLength, &isEndOfObject));
+    ASSERT_IS_TRUE(isEndOfObject);
+}
+
+static void assert_value(JSON_READER* reader, const char* expectedValue)
+{
+    const char* value;
+    size_t valueLength;
+
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, JSONReader_ReadValue(reader, &value, &valueLength));
+    ASSERT_ARE_EQUAL(size_t, strlen(expectedValue), valueLength);
+    ASSERT_IS_TRUE(strncmp(expectedValue, value, valueLength) == 0);
+}
+
+/*reads {"a":<value>} and returns the result of reading <value>*/
+static JSON_READER_RESULT read_single_member_value(const char* json)
+{
+    JSON_READER reader;
+
+    (void)JSONReader_Init(&reader, json);
+    ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, JSONReader_BeginObject(&reader));
+    assert_next_member(&reader, "a");
+    return JSONReader_ReadValue(&reader, NULL, NULL);
+}
+
+BEGIN_TEST_SUITE(jsonreader_ut)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    /*Tests_SRS_JSON_READER_99_001: [ If reader or json is NULL, JSONReader_Init shall return JSON_READER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONReader_Init_with_NULL_reader_fails)
+    {
+        ///act
+        JSON_READER_RESULT result = JSONReader_Init(NULL, "{}");
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_READER_99_001: [ If reader or json is NULL, JSONReader_Init shall return JSON_READER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONReader_Init_with_NULL_json_fails)
+    {
+        ///arrange
+        JSON_READER reader;
+
+        ///act
+        JSON_READER_RESULT result = JSONReader_Init(&reader, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_READER_99_002: [ JSONReader_Init shall set the reader to read from the beginning of json and return JSON_READER_OK. ]*/
+    /*Tests_SRS_JSON_READER_99_005: [ Otherwise JSONReader_BeginObject shall consume the opening curly bracket and return JSON_READER_OK. ]*/
+    /*Tests_SRS_JSON_READER_99_007: [ If the object ends, JSONReader_NextMember shall consume the closing curly bracket, set isEndOfObject to true and return JSON_READER_OK. ]*/
+    /*Tests_SRS_JSON_READER_99_017: [ Otherwise JSONReader_End shall return JSON_READER_OK. ]*/
+    TEST_FUNCTION(JSONReader_reads_an_empty_object)
+    {
+        ///arrange
+        JSON_READER reader;
+
+        ///act
+        JSON_READER_RESULT result = JSONReader_Init(&reader, " { } ");
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, result);
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, JSONReader_BeginObject(&reader));
+        assert_end_of_object(&reader);
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, JSONReader_End(&reader));
+    }
+
+    /*Tests_SRS_JSON_READER_99_003: [ If reader is NULL, JSONReader_BeginObject shall return JSON_READER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONReader_BeginObject_with_NULL_reader_fails)
+    {
+        ///act
+        JSON_READER_RESULT result = JSONReader_BeginObject(NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_READER_99_004: [ If the next value is not an object, JSONReader_BeginObject shall return JSON_READER_PARSE_ERROR. ]*/
+    TEST_FUNCTION(JSONReader_BeginObject_on_an_array_fails)
+    {
+        ///arrange
+        JSON_READER reader;
+        (void)JSONReader_Init(&reader, "[1]");
+
+        ///act
+        JSON_READER_RESULT result = JSONReader_BeginObject(&reader);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, result);
+    }
+
+    /*Tests_SRS_JSON_READER_99_006: [ If reader, name, nameLength or isEndOfObject is NULL, JSONReader_NextMember shall return JSON_READER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONReader_NextMember_with_NULL_arguments_fails)
+    {
+        ///arrange
+        JSON_READER reader;
+        const char* name;
+        size_t nameLength;
+        bool isEndOfObject;
+        (void)JSONReader_Init(&reader, "{\"a\":1}");
+        (void)JSONReader_BeginObject(&reader);
+
+        ///act
+        JSON_READER_RESULT result1 = JSONReader_NextMember(NULL, &name, &nameLength, &isEndOfObject);
+        JSON_READER_RESULT result2 = JSONReader_NextMember(&reader, NULL, &nameLength, &isEndOfObject);
+        JSON_READER_RESULT result3 = JSONReader_NextMember(&reader, &name, NULL, &isEndOfObject);
+        JSON_READER_RESULT result4 = JSONReader_NextMember(&reader, &name, &nameLength, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, result1);
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, result2);
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, result3);
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, result4);
+    }
+
+    /*Tests_SRS_JSON_READER_99_008: [ Every member except the first one shall be preceded by a comma. ]*/
+    /*Tests_SRS_JSON_READER_99_010: [ Otherwise JSONReader_NextMember shall set name to the first character of the member name as it appears between the quotes, nameLength to its length, isEndOfObject to false, consume the colon and return JSON_READER_OK. ]*/
+    /*Tests_SRS_JSON_READER_99_014: [ If value is not NULL, JSONReader_ReadValue shall set it to the first character of the value and set valueLength (if not NULL) to the length of the value. String values keep their quotes. ]*/
+    TEST_FUNCTION(JSONReader_reads_members_and_values_in_place)
+    {
+        ///arrange
+        const char* json = "{ \"int\" : -12.5e+3 , \"str\":\"a\\\"b\", \"t\":true,\"f\":false,\"n\":null }";
+        JSON_READER reader;
+        (void)JSONReader_Init(&reader, json);
+
+        ///act
+        JSON_READER_RESULT result = JSONReader_BeginObject(&reader);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, result);
+        assert_next_member(&reader, "int");
+        assert_value(&reader, "-12.5e+3");
+        assert_next_member(&reader, "str");
+        assert_value(&reader, "\"a\\\"b\"");
+        assert_next_member(&reader, "t");
+        assert_value(&reader, "true");
+        assert_next_member(&reader, "f");
+        assert_value(&reader, "false");
+        assert_next_member(&reader, "n");
+        assert_value(&reader, "null");
+        assert_end_of_object(&reader);
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, JSONReader_End(&reader));
+    }
+
+    /*Tests_SRS_JSON_READER_99_010: [ Otherwise JSONReader_NextMember shall set name to the first character of the member name as it appears between the quotes, nameLength to its length, isEndOfObject to false, consume the colon and return JSON_READER_OK. ]*/
+    TEST_FUNCTION(JSONReader_NextMember_returns_escaped_names_as_they_appear)
+    {
+        ///arrange
+        JSON_READER reader;
+        (void)JSONReader_Init(&reader, "{\"a\\\\b\":1}");
+        (void)JSONReader_BeginObject(&reader);
+
+        ///act & assert
+        assert_next_member(&reader, "a\\\\b");
+    }
+
+    /*Tests_SRS_JSON_READER_99_013: [ JSONReader_ReadValue shall consume the complete next value, including nested objects and arrays. ]*/
+    TEST_FUNCTION(JSONReader_ReadValue_returns_nested_objects_and_arrays_as_one_value)
+    {
+        ///arrange
+        JSON_READER reader;
+        (void)JSONReader_Init(&reader, "{\"o\":{\"x\":[1,{\"y\":\"}\"}],\"z\":{}},\"a\":[ ],\"b\":2}");
+        (void)JSONReader_BeginObject(&reader);
+
+        ///act & assert
+        assert_next_member(&reader, "o");
+        assert_value(&reader, "{\"x\":[1,{\"y\":\"}\"}],\"z\":{}}");
+        assert_next_member(&reader, "a");
+        assert_value(&reader, "[ ]");
+        assert_next_member(&reader, "b");
+        assert_value(&reader, "2");
+        assert_end_of_object(&reader);
+    }
+
+    /*Tests_SRS_JSON_READER_99_005: [ Otherwise JSONReader_BeginObject shall consume the opening curly bracket and return JSON_READER_OK. ]*/
+    TEST_FUNCTION(JSONReader_BeginObject_descends_into_a_member_value)
+    {
+        ///arrange
+        JSON_READER reader;
+        (void)JSONReader_Init(&reader, "{\"inner\":{\"a\":1,\"b\":2},\"c\":3}");
+        (void)JSONReader_BeginObject(&reader);
+        assert_next_member(&reader, "inner");
+
+        ///act
+        JSON_READER_RESULT result = JSONReader_BeginObject(&reader);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, result);
+        assert_next_member(&reader, "a");
+        assert_value(&reader, "1");
+        assert_next_member(&reader, "b");
+        assert_value(&reader, "2");
+        assert_end_of_object(&reader);
+        assert_next_member(&reader, "c");
+        assert_value(&reader, "3");
+        assert_end_of_object(&reader);
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_OK, JSONReader_End(&reader));
+    }
+
+    /*Tests_SRS_JSON_READER_99_009: [ If the member name or the colon that follows it is malformed, JSONReader_NextMember shall return JSON_READER_PARSE_ERROR. ]*/
+    TEST_FUNCTION(JSONReader_NextMember_with_malformed_members_fails)
+    {
+        const char* malformed[] =
+        {
+            "{a:1}",
+            "{\"a\" 1}",
+            "{\"a",
+            "{,\"a\":1}",
+            "{\"\\x\":1}",
+        };
+        size_t i;
+
+        for (i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+        {
+            ///arrange
+            JSON_READER reader;
+            const char* name;
+            size_t nameLength;
+            bool isEndOfObject;
+            (void)JSONReader_Init(&reader, malformed[i]);
+            (void)JSONReader_BeginObject(&reader);
+
+            ///act
+            JSON_READER_RESULT result = JSONReader_NextMember(&reader, &name, &nameLength, &isEndOfObject);
+
+            ///assert
+            ASSERT_ARE_EQUAL_WITH_MSG(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, result, malformed[i]);
+        }
+    }
+
+    /*Tests_SRS_JSON_READER_99_008: [ Every member except the first one shall be preceded by a comma. ]*/
+    TEST_FUNCTION(JSONReader_NextMember_without_a_comma_fails)
+    {
+        ///arrange
+        JSON_READER reader;
+        const char* name;
+        size_t nameLength;
+        bool isEndOfObject;
+        (void)JSONReader_Init(&reader, "{\"a\":1 \"b\":2}");
+        (void)JSONReader_BeginObject(&reader);
+        assert_next_member(&reader, "a");
+        assert_value(&reader, "1");
+
+        ///act
+        JSON_READER_RESULT result = JSONReader_NextMember(&reader, &name, &nameLength, &isEndOfObject);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, result);
+    }
+
+    /*Tests_SRS_JSON_READER_99_009: [ If the member name or the colon that follows it is malformed, JSONReader_NextMember shall return JSON_READER_PARSE_ERROR. ]*/
+    TEST_FUNCTION(JSONReader_NextMember_after_a_trailing_comma_fails)
+    {
+        ///arrange
+        JSON_READER reader;
+        const char* name;
+        size_t nameLength;
+        bool isEndOfObject;
+        (void)JSONReader_Init(&reader, "{\"a\":1,}");
+        (void)JSONReader_BeginObject(&reader);
+        assert_next_member(&reader, "a");
+        assert_value(&reader, "1");
+
+        ///act
+        JSON_READER_RESULT result = JSONReader_NextMember(&reader, &name, &nameLength, &isEndOfObject);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, result);
+    }
+
+    /*Tests_SRS_JSON_READER_99_011: [ If reader is NULL, JSONReader_ReadValue shall return JSON_READER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONReader_ReadValue_with_NULL_reader_fails)
+    {
+        ///act
+        JSON_READER_RESULT result = JSONReader_ReadValue(NULL, NULL, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_READER_99_012: [ If the next value is malformed, JSONReader_ReadValue shall return JSON_READER_PARSE_ERROR. ]*/
+    TEST_FUNCTION(JSONReader_ReadValue_with_malformed_values_fails)
+    {
+        const char* malformed[] =
+        {
+            "{\"a\":}",
+            "{\"a\":01}",
+            "{\"a\":-}",
+            "{\"a\":1.}",
+            "{\"a\":1e}",
+            "{\"a\":\"unterminated}",
+            "{\"a\":\"\\u0041\"}",
+            "{\"a\":True}",
+            "{\"a\":[1,]}",
+            "{\"a\":[1 2]}",
+            "{\"a\":{\"b\":1,}}",
+            "{\"a\":{\"b\" 1}}",
+            "{\"a\":{\"b\":1",
+        };
+        size_t i;
+
+        for (i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++)
+        {
+            ///act
+            JSON_READER_RESULT result = read_single_member_value(malformed[i]);
+
+            ///assert
+            ASSERT_ARE_EQUAL_WITH_MSG(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, result, malformed[i]);
+        }
+    }
+
+    /*Tests_SRS_JSON_READER_99_013: [ JSONReader_ReadValue shall consume the complete next value, including nested objects and arrays. ]*/
+    TEST_FUNCTION(JSONReader_ReadValue_accepts_numbers)
+    {
+        const char* numbers[] =
+        {
+            "{\"a\":0}",
+            "{\"a\":-0.5}",
+            "{\"a\":10E-2}",
+            "{\"a\":3e7}",
+        };
+        size_t i;
+
+        for (i = 0; i < sizeof(numbers) / sizeof(numbers[0]); i++)
+        {
+            ///act
+            JSON_READER_RESULT result = read_single_member_value(numbers[i]);
+
+            ///assert
+            ASSERT_ARE_EQUAL_WITH_MSG(JSON_READER_RESULT, JSON_READER_OK, result, numbers[i]);
+        }
+    }
+
+    /*Tests_SRS_JSON_READER_99_015: [ If reader is NULL, JSONReader_End shall return JSON_READER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONReader_End_with_NULL_reader_fails)
+    {
+        ///act
+        JSON_READER_RESULT result = JSONReader_End(NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_READER_99_016: [ If anything but white spaces follows the last value, JSONReader_End shall return JSON_READER_PARSE_ERROR. ]*/
+    TEST_FUNCTION(JSONReader_End_with_trailing_characters_fails)
+    {
+        ///arrange
+        JSON_READER reader;
+        (void)JSONReader_Init(&reader, "{} x");
+        (void)JSONReader_BeginObject(&reader);
+        assert_end_of_object(&reader);
+
+        ///act
+        JSON_READER_RESULT result = JSONReader_End(&reader);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_READER_RESULT, JSON_READER_PARSE_ERROR, result);
+    }
+
+END_TEST_SUITE(jsonreader_ut)
@@ -0,0 +1,496 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstddef>
+#include <cstring>
+#include <cmath>
+#else
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#endif
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umock_c_negative_tests.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/strings.h"
+#include "agenttypesystem.h"
+#undef ENABLE_MOCKS
+
+#include "jsonwriter.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+TEST_DEFINE_ENUM_TYPE(JSON_WRITER_RESULT, JSON_WRITER_RESULT_VALUES);
+IMPLEMENT_UMOCK_C_ENUM_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT_VALUES);
+
+#define TEST_STRING_HANDLE ((STRING_HANDLE)0x42)
+#define TEST_AGENT_DATA_TYPE_AS_STRING "\"2017-01-02T03:04:05Z\""
+
+static STRING_HANDLE my_STRING_new(void)
+{
+    return TEST_STRING_HANDLE;
+}
+
+static const char* my_STRING_c_str(STRING_HANDLE handle)
+{
+    (void)handle;
+    return TEST_AGENT_DATA_TYPE_AS_STRING;
+}
+
+static size_t my_STRING_length(STRING_HANDLE handle)
+{
+    (void)handle;
+    return sizeof(TEST_AGENT_DATA_TYPE_AS_STRING) - 1;
+}
+
+static char output[128];
+
+static void writer_init(JSON_WRITER* writer, size_t size)
+{
+    (void)memset(output, 'x', sizeof(output));
+    (void)JSONWriter_Init(writer, output, size);
+}
+
+static void assert_output(JSON_WRITER* writer, const char* expected)
+{
+    size_t length;
+    ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_Finish(writer, &length));
+    ASSERT_ARE_EQUAL(size_t, strlen(expected), length);
+    ASSERT_ARE_EQUAL(char_ptr, expected, output);
+}
+
+BEGIN_TEST_SUITE(jsonwriter_ut)
+
+    TEST_SUITE_INITIALIZE(TestClassInitialize)
+    {
+        TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+        g_testByTest = TEST_MUTEX_CREATE();
+        ASSERT_IS_NOT_NULL(g_testByTest);
+
+        (void)umock_c_init(on_umock_c_error);
+        (void)umocktypes_charptr_register_types();
+
+        REGISTER_TYPE(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_RESULT);
+        REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+
+        REGISTER_GLOBAL_MOCK_HOOK(STRING_new, my_STRING_new);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(STRING_new, NULL);
+        REGISTER_GLOBAL_MOCK_HOOK(STRING_c_str, my_STRING_c_str);
+        REGISTER_GLOBAL_MOCK_HOOK(STRING_length, my_STRING_length);
+        REGISTER_GLOBAL_MOCK_RETURN(AgentDataTypes_ToString, AGENT_DATA_TYPES_OK);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(AgentDataTypes_ToString, AGENT_DATA_TYPES_ERROR);
+    }
+
+    TEST_SUITE_CLEANUP(TestClassCleanup)
+    {
+        umock_c_deinit();
+
+        TEST_MUTEX_DESTROY(g_testByTest);
+        TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    }
+
+    TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+    {
+        if (TEST_MUTEX_ACQUIRE(g_testByTest))
+        {
+            ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+        }
+
+        umock_c_reset_all_calls();
+    }
+
+    TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+    {
+        TEST_MUTEX_RELEASE(g_testByTest);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_001: [ If writer is NULL, or destination is NULL while destinationSize is not 0, JSONWriter_Init shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_Init_with_NULL_writer_fails)
+    {
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_Init(NULL, output, sizeof(output));
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_001: [ If writer is NULL, or destination is NULL while destinationSize is not 0, JSONWriter_Init shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_Init_with_NULL_destination_and_non_zero_size_fails)
+    {
+        ///arrange
+        JSON_WRITER writer;
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_Init(&writer, NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_002: [ JSONWriter_Init shall set the writer to write at the beginning of destination and return JSON_WRITER_OK. ]*/
+    /*Tests_SRS_JSON_WRITER_99_022: [ JSONWriter_Finish shall set *destinationLength to the number of characters the output needs. ]*/
+    /*Tests_SRS_JSON_WRITER_99_023: [ If the output did not fit in the destination, JSONWriter_Finish shall return JSON_WRITER_BUFFER_TOO_SMALL. ]*/
+    TEST_FUNCTION(JSONWriter_with_NULL_destination_and_zero_size_measures_the_output)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        size_t length;
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, JSONWriter_Init(&writer, NULL, 0));
+        (void)JSONWriter_AppendLiteral(&writer, "{\"a\":", 5);
+        (void)JSONWriter_AppendInt64(&writer, 42);
+        (void)JSONWriter_AppendLiteral(&writer, "}", 1);
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_Finish(&writer, &length);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_BUFFER_TOO_SMALL, result);
+        ASSERT_ARE_EQUAL(size_t, 8, length);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_003: [ If writer or literal is NULL, JSONWriter_AppendLiteral shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_AppendLiteral_with_NULL_literal_fails)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendLiteral(&writer, NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(size_t, 0, writer.length);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_004: [ JSONWriter_AppendLiteral shall copy literalLength characters of literal without any encoding. ]*/
+    TEST_FUNCTION(JSONWriter_AppendLiteral_copies_literalLength_characters)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendLiteral(&writer, ",\"a/b\":", 7);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, result);
+        assert_output(&writer, ",\"a/b\":");
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_005: [ If writer is NULL, JSONWriter_AppendInt64 shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_AppendInt64_with_NULL_writer_fails)
+    {
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendInt64(NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_006: [ JSONWriter_AppendInt64 shall write value in decimal, with a leading '-' for negative values. ]*/
+    TEST_FUNCTION(JSONWriter_AppendInt64_writes_limits_and_zero)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        (void)JSONWriter_AppendInt64(&writer, INT64_MIN);
+        (void)JSONWriter_AppendLiteral(&writer, ",", 1);
+        (void)JSONWriter_AppendInt64(&writer, 0);
+        (void)JSONWriter_AppendLiteral(&writer, ",", 1);
+        (void)JSONWriter_AppendInt64(&writer, INT64_MAX);
+
+        ///assert
+        assert_output(&writer, "-9223372036854775808,0,9223372036854775807");
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_007: [ If writer is NULL or digits is negative, JSONWriter_AppendDouble shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_AppendDouble_with_negative_digits_fails)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendDouble(&writer, 1.0, -1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_008: [ NaN, -INF and INF shall be written as NaN, -INF and INF, unquoted. ]*/
+    TEST_FUNCTION(JSONWriter_AppendDouble_writes_NaN_and_infinities)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        (void)JSONWriter_AppendDouble(&writer, NAN, 15);
+        (void)JSONWriter_AppendDouble(&writer, -INFINITY, 15);
+        (void)JSONWriter_AppendDouble(&writer, INFINITY, 15);
+
+        ///assert
+        assert_output(&writer, "NaN-INFINF");
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_009: [ Otherwise JSONWriter_AppendDouble shall write value using the "%.*f" format with digits as the precision. ]*/
+    TEST_FUNCTION(JSONWriter_AppendDouble_uses_digits_as_precision)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendDouble(&writer, -1.5, 3);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, result);
+        assert_output(&writer, "-1.500");
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_011: [ If writer is NULL, JSONWriter_AppendBool shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_AppendBool_with_NULL_writer_fails)
+    {
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendBool(NULL, true);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_012: [ JSONWriter_AppendBool shall write true or false. ]*/
+    TEST_FUNCTION(JSONWriter_AppendBool_writes_true_and_false)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        (void)JSONWriter_AppendBool(&writer, true);
+        (void)JSONWriter_AppendBool(&writer, false);
+
+        ///assert
+        assert_output(&writer, "truefalse");
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_013: [ If writer or value is NULL, JSONWriter_AppendString shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_AppendString_with_NULL_value_fails)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendString(&writer, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_014: [ JSONWriter_AppendString shall write value between quotes, escaping '"', '\\' and '/' with a backslash and control characters as \u00XX. ]*/
+    TEST_FUNCTION(JSONWriter_AppendString_escapes_like_AgentDataTypes_ToString)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendString(&writer, "a\"b\\c/d\ne\x1f");
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, result);
+        assert_output(&writer, "\"a\\\"b\\\\c\\/d\\u000Ae\\u001F\"");
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_015: [ If value contains characters above 127, JSONWriter_AppendString shall return JSON_WRITER_INVALID_ARG and leave the writer unchanged. ]*/
+    TEST_FUNCTION(JSONWriter_AppendString_with_non_ASCII_characters_fails_and_leaves_writer_unchanged)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+        (void)JSONWriter_AppendLiteral(&writer, "[", 1);
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendString(&writer, "abc\xC3\xA9");
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+        assert_output(&writer, "[");
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_016: [ If writer or value is NULL, JSONWriter_AppendRaw shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_AppendRaw_with_NULL_value_fails)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendRaw(&writer, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_017: [ JSONWriter_AppendRaw shall copy value as is, without quotes. ]*/
+    TEST_FUNCTION(JSONWriter_AppendRaw_copies_value_as_is)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendRaw(&writer, "{\"a\":[1,2]}");
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, result);
+        assert_output(&writer, "{\"a\":[1,2]}");
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_018: [ If writer or value is NULL, JSONWriter_AppendAgentDataType shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_AppendAgentDataType_with_NULL_value_fails)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendAgentDataType(&writer, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_019: [ JSONWriter_AppendAgentDataType shall convert value with AgentDataTypes_ToString and copy the result. ]*/
+    TEST_FUNCTION(JSONWriter_AppendAgentDataType_copies_AgentDataTypes_ToString_output)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        AGENT_DATA_TYPE value;
+        writer_init(&writer, sizeof(output));
+
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(TEST_STRING_HANDLE, &value));
+        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_length(TEST_STRING_HANDLE));
+        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_AppendAgentDataType(&writer, &value);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, result);
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        assert_output(&writer, TEST_AGENT_DATA_TYPE_AS_STRING);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_020: [ If any of the conversion steps fail, JSONWriter_AppendAgentDataType shall return JSON_WRITER_ERROR. ]*/
+    TEST_FUNCTION(JSONWriter_AppendAgentDataType_unhappy_paths)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        AGENT_DATA_TYPE value;
+        size_t i;
+
+        (void)umock_c_negative_tests_init();
+
+        STRICT_EXPECTED_CALL(STRING_new());
+        STRICT_EXPECTED_CALL(AgentDataTypes_ToString(TEST_STRING_HANDLE, &value));
+
+        umock_c_negative_tests_snapshot();
+
+        for (i = 0; i < umock_c_negative_tests_call_count(); i++)
+        {
+            char temp_str[128];
+            JSON_WRITER_RESULT result;
+
+            umock_c_negative_tests_reset();
+            umock_c_negative_tests_fail_call(i);
+            writer_init(&writer, sizeof(output));
+
+            ///act
+            result = JSONWriter_AppendAgentDataType(&writer, &value);
+
+            ///assert
+            (void)sprintf(temp_str, "On failed call %zu", i);
+            ASSERT_ARE_EQUAL_WITH_MSG(JSON_WRITER_RESULT, JSON_WRITER_ERROR, result, temp_str);
+            ASSERT_ARE_EQUAL_WITH_MSG(size_t, 0, writer.length, temp_str);
+        }
+
+        ///cleanup
+        umock_c_negative_tests_deinit();
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_021: [ If writer or destinationLength is NULL, JSONWriter_Finish shall return JSON_WRITER_INVALID_ARG. ]*/
+    TEST_FUNCTION(JSONWriter_Finish_with_NULL_destinationLength_fails)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        writer_init(&writer, sizeof(output));
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_Finish(&writer, NULL);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_INVALID_ARG, result);
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_022: [ JSONWriter_Finish shall set *destinationLength to the number of characters the output needs. ]*/
+    /*Tests_SRS_JSON_WRITER_99_023: [ If the output did not fit in the destination, JSONWriter_Finish shall return JSON_WRITER_BUFFER_TOO_SMALL. ]*/
+    TEST_FUNCTION(JSONWriter_Finish_with_truncated_output_returns_needed_length_and_does_not_overrun)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        size_t length;
+        writer_init(&writer, 4);
+        (void)JSONWriter_AppendString(&writer, "abcdef");
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_Finish(&writer, &length);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_BUFFER_TOO_SMALL, result);
+        ASSERT_ARE_EQUAL(size_t, 8, length);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(output, "\"abcx", 5));
+    }
+
+    /*Tests_SRS_JSON_WRITER_99_024: [ If there is room after the output, JSONWriter_Finish shall zero terminate it. ]*/
+    TEST_FUNCTION(JSONWriter_Finish_with_output_filling_destination_exactly_succeeds_without_terminator)
+    {
+        ///arrange
+        JSON_WRITER writer;
+        size_t length;
+        writer_init(&writer, 4);
+        (void)JSONWriter_AppendBool(&writer, true);
+
+        ///act
+        JSON_WRITER_RESULT result = JSONWriter_Finish(&writer, &length);
+
+        ///assert
+        ASSERT_ARE_EQUAL(JSON_WRITER_RESULT, JSON_WRITER_OK, result);
+        ASSERT_ARE_EQUAL(size_t, 4, length);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(output, "truex", 5));
+    }
+
+END_TEST_SUITE(jsonwriter_ut)
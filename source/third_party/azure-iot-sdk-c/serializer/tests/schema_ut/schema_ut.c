@@ -5643,6 +5643,171 @@ BEGIN_TEST_SUITE(Schema_ut)
         Schema_Destroy(schemaHandle);
     }
 
+    /*Tests_SRS_SCHEMA_99_184: [ If modelTypeHandle or elementName is NULL then Schema_GetModelDesiredElementByName shall fail and set SCHEMA_DESIRED_ELEMENT.elementType to SCHEMA_SEARCH_INVALID_ARG. ]*/
+    TEST_FUNCTION(Schema_GetModelDesiredElementByName_with_NULL_modelTypeHandle_fails)
+    {
+        ///arrange
+
+        ///act
+        SCHEMA_DESIRED_ELEMENT element = Schema_GetModelDesiredElementByName(NULL, "a", 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_SEARCH_INVALID_ARG, element.elementType);
+    }
+
+    /*Tests_SRS_SCHEMA_99_184: [ If modelTypeHandle or elementName is NULL then Schema_GetModelDesiredElementByName shall fail and set SCHEMA_DESIRED_ELEMENT.elementType to SCHEMA_SEARCH_INVALID_ARG. ]*/
+    TEST_FUNCTION(Schema_GetModelDesiredElementByName_with_NULL_elementName_fails)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE modelType = Schema_CreateModelType(schemaHandle, "Model");
+
+        ///act
+        SCHEMA_DESIRED_ELEMENT element = Schema_GetModelDesiredElementByName(modelType, NULL, 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_SEARCH_INVALID_ARG, element.elementType);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*Tests_SRS_SCHEMA_99_187: [ Schema_GetModelDesiredElementByName shall look up the first elementNameLength characters of elementName in the index with a binary search. ]*/
+    /*Tests_SRS_SCHEMA_99_188: [ If the name is a desired property, Schema_GetModelDesiredElementByName shall set elementType to SCHEMA_DESIRED_PROPERTY, desiredPropertyHandle to the desired property and offset and onDesiredProperty to the values the desired property was added with. ]*/
+    /*Tests_SRS_SCHEMA_99_189: [ If the name is a model in model, Schema_GetModelDesiredElementByName shall set elementType to SCHEMA_MODEL_IN_MODEL, modelHandle to the model and offset and onDesiredProperty to the values the model in model was added with. ]*/
+    /*Tests_SRS_SCHEMA_99_190: [ Otherwise Schema_GetModelDesiredElementByName shall set elementType to SCHEMA_NOT_FOUND. ]*/
+    TEST_FUNCTION(Schema_GetModelDesiredElementByName_succeeds)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE modelType = Schema_CreateModelType(schemaHandle, "Model");
+        SCHEMA_MODEL_TYPE_HANDLE minerModel = Schema_CreateModelType(schemaHandle, "someMinerModel");
+        (void)Schema_AddModelDesiredProperty(modelType, "temperature", "double", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 3, g_onDesiredProperty);
+        (void)Schema_AddModelDesiredProperty(modelType, "temp", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 7, NULL);
+        (void)Schema_AddModelDesiredProperty(modelType, "alpha", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 11, NULL);
+        (void)Schema_AddModelModel(modelType, "ManicMiner", minerModel, 5, g_onDesiredProperty);
+        (void)Schema_AddModelReportedProperty(modelType, "reported", "int");
+        const char* json = "{\"temp\":1,\"temperature\":2,\"ManicMiner\":{},\"alpha\":3}";
+
+        ///act
+        SCHEMA_DESIRED_ELEMENT temp = Schema_GetModelDesiredElementByName(modelType, json + 2, 4);
+        SCHEMA_DESIRED_ELEMENT temperature = Schema_GetModelDesiredElementByName(modelType, json + 11, 11);
+        SCHEMA_DESIRED_ELEMENT manicMiner = Schema_GetModelDesiredElementByName(modelType, json + 27, 10);
+        SCHEMA_DESIRED_ELEMENT alpha = Schema_GetModelDesiredElementByName(modelType, json + 43, 5);
+        SCHEMA_DESIRED_ELEMENT tempe = Schema_GetModelDesiredElementByName(modelType, "temperature", 5);
+        SCHEMA_DESIRED_ELEMENT reported = Schema_GetModelDesiredElementByName(modelType, "reported", 8);
+        SCHEMA_DESIRED_ELEMENT empty = Schema_GetModelDesiredElementByName(modelType, "", 0);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_DESIRED_PROPERTY, temp.elementType);
+        ASSERT_IS_TRUE(temp.desiredPropertyHandle == Schema_GetModelDesiredPropertyByName(modelType, "temp"));
+        ASSERT_ARE_EQUAL(size_t, 7, temp.offset);
+        ASSERT_IS_TRUE(temp.onDesiredProperty == NULL);
+
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_DESIRED_PROPERTY, temperature.elementType);
+        ASSERT_IS_TRUE(temperature.desiredPropertyHandle == Schema_GetModelDesiredPropertyByName(modelType, "temperature"));
+        ASSERT_ARE_EQUAL(size_t, 3, temperature.offset);
+        ASSERT_IS_TRUE(temperature.onDesiredProperty == g_onDesiredProperty);
+
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_MODEL_IN_MODEL, manicMiner.elementType);
+        ASSERT_IS_TRUE(manicMiner.modelHandle == minerModel);
+        ASSERT_ARE_EQUAL(size_t, 5, manicMiner.offset);
+        ASSERT_IS_TRUE(manicMiner.onDesiredProperty == g_onDesiredProperty);
+
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_DESIRED_PROPERTY, alpha.elementType);
+        ASSERT_ARE_EQUAL(size_t, 11, alpha.offset);
+
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_NOT_FOUND, tempe.elementType);
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_NOT_FOUND, reported.elementType);
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_NOT_FOUND, empty.elementType);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*Tests_SRS_SCHEMA_99_185: [ On the first call after a desired property or a model in model has been added, Schema_GetModelDesiredElementByName shall build an index of the desired properties and models in model of the model, sorted by name. ]*/
+    TEST_FUNCTION(Schema_GetModelDesiredElementByName_builds_the_index_only_once)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE modelType = Schema_CreateModelType(schemaHandle, "Model");
+        (void)Schema_AddModelDesiredProperty(modelType, "b", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 3, NULL);
+        (void)Schema_AddModelDesiredProperty(modelType, "a", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 7, NULL);
+        (void)Schema_GetModelDesiredElementByName(modelType, "a", 1);
+        umock_c_reset_all_calls();
+
+        ///act
+        SCHEMA_DESIRED_ELEMENT a = Schema_GetModelDesiredElementByName(modelType, "a", 1);
+        SCHEMA_DESIRED_ELEMENT b = Schema_GetModelDesiredElementByName(modelType, "b", 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_DESIRED_PROPERTY, a.elementType);
+        ASSERT_ARE_EQUAL(size_t, 7, a.offset);
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_DESIRED_PROPERTY, b.elementType);
+        ASSERT_ARE_EQUAL(size_t, 3, b.offset);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*Tests_SRS_SCHEMA_99_185: [ On the first call after a desired property or a model in model has been added, Schema_GetModelDesiredElementByName shall build an index of the desired properties and models in model of the model, sorted by name. ]*/
+    TEST_FUNCTION(Schema_GetModelDesiredElementByName_finds_elements_added_after_a_lookup)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE modelType = Schema_CreateModelType(schemaHandle, "Model");
+        SCHEMA_MODEL_TYPE_HANDLE minerModel = Schema_CreateModelType(schemaHandle, "someMinerModel");
+        (void)Schema_AddModelDesiredProperty(modelType, "b", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 3, NULL);
+        SCHEMA_DESIRED_ELEMENT notYetThere = Schema_GetModelDesiredElementByName(modelType, "a", 1);
+        (void)Schema_AddModelDesiredProperty(modelType, "a", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 7, NULL);
+        (void)Schema_GetModelDesiredElementByName(modelType, "a", 1);
+        (void)Schema_AddModelModel(modelType, "m", minerModel, 5, NULL);
+
+        ///act
+        SCHEMA_DESIRED_ELEMENT a = Schema_GetModelDesiredElementByName(modelType, "a", 1);
+        SCHEMA_DESIRED_ELEMENT m = Schema_GetModelDesiredElementByName(modelType, "m", 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_NOT_FOUND, notYetThere.elementType);
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_DESIRED_PROPERTY, a.elementType);
+        ASSERT_ARE_EQUAL(size_t, 7, a.offset);
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_MODEL_IN_MODEL, m.elementType);
+        ASSERT_IS_TRUE(m.modelHandle == minerModel);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
+    /*Tests_SRS_SCHEMA_99_186: [ If building the index fails, Schema_GetModelDesiredElementByName shall search the desired properties and models in model one by one. ]*/
+    TEST_FUNCTION(Schema_GetModelDesiredElementByName_when_building_the_index_fails_still_finds_elements)
+    {
+        ///arrange
+        SCHEMA_HANDLE schemaHandle = Schema_Create(SCHEMA_NAMESPACE, TEST_SCHEMA_METADATA);
+        SCHEMA_MODEL_TYPE_HANDLE modelType = Schema_CreateModelType(schemaHandle, "Model");
+        SCHEMA_MODEL_TYPE_HANDLE minerModel = Schema_CreateModelType(schemaHandle, "someMinerModel");
+        (void)Schema_AddModelDesiredProperty(modelType, "b", "int", g_pfDesiredPropertyFromAGENT_DATA_TYPE, g_pfDesiredPropertyInitialize, g_pfDesiredPropertyDeinitialize, 3, NULL);
+        (void)Schema_AddModelModel(modelType, "m", minerModel, 5, g_onDesiredProperty);
+        umock_c_reset_all_calls();
+
+        STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+            .SetReturn(NULL);
+
+        ///act
+        SCHEMA_DESIRED_ELEMENT m = Schema_GetModelDesiredElementByName(modelType, "m", 1);
+
+        ///assert
+        ASSERT_ARE_EQUAL(SCHEMA_ELEMENT_TYPE, SCHEMA_MODEL_IN_MODEL, m.elementType);
+        ASSERT_IS_TRUE(m.modelHandle == minerModel);
+        ASSERT_ARE_EQUAL(size_t, 5, m.offset);
+        ASSERT_IS_TRUE(m.onDesiredProperty == g_onDesiredProperty);
+
+        ///clean
+        Schema_Destroy(schemaHandle);
+    }
+
     /*Tests_SRS_SCHEMA_02_084: [ If desiredPropertyHandle is NULL then Schema_GetModelDesiredProperty_pfOnDesiredProperty shall return NULL. ]*/
     TEST_FUNCTION(Schema_GetModelDesiredProperty_pfOnDesiredProperty_with_NULL_desiredPropertyHandle_returns_NULL)
     {
@@ -373,6 +373,25 @@ public:
     MOCK_STATIC_METHOD_2(, int, mallocAndStrcpy_s, char**, destination, const char*, source);
         int result2 = BASEIMPLEMENTATION::mallocAndStrcpy_s(destination, source);
     MOCK_METHOD_END(int, result2);
+    /* JSONWriter mocks */
+    MOCK_STATIC_METHOD_3(, JSON_WRITER_RESULT, JSONWriter_Init, JSON_WRITER*, writer, char*, destination, size_t, destinationSize)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_3(, JSON_WRITER_RESULT, JSONWriter_AppendLiteral, JSON_WRITER*, writer, const char*, literal, size_t, literalLength)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendInt64, JSON_WRITER*, writer, int64_t, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_3(, JSON_WRITER_RESULT, JSONWriter_AppendDouble, JSON_WRITER*, writer, double, value, int, digits)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendBool, JSON_WRITER*, writer, bool, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendString, JSON_WRITER*, writer, const char*, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendRaw, JSON_WRITER*, writer, const char*, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_AppendAgentDataType, JSON_WRITER*, writer, const AGENT_DATA_TYPE*, value)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
+    MOCK_STATIC_METHOD_2(, JSON_WRITER_RESULT, JSONWriter_Finish, JSON_WRITER*, writer, size_t*, destinationLength)
+    MOCK_METHOD_END(JSON_WRITER_RESULT, JSON_WRITER_OK)
 };
 
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , CODEFIRST_RESULT, CodeFirst_Init, const char*, overrideSchemaNamespace);
@@ -397,6 +416,15 @@ DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_charz, AGENT_DATA_TYPE*, agentData, const char*, v);
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_charz_no_quotes, AGENT_DATA_TYPE*, agentData, const char*, v);
 DECLARE_GLOBAL_MOCK_METHOD_1(CIoTHubSchemaClientMocks, , void, Destroy_AGENT_DATA_TYPE, AGENT_DATA_TYPE*, agentData);
+DECLARE_GLOBAL_MOCK_METHOD_3(CIoTHubSchemaClientMocks, , JSON_WRITER_RESULT, JSONWriter_Init, JSON_WRITER*, writer, char*, destination, size_t, destinationSize);
+DECLARE_GLOBAL_MOCK_METHOD_3(CIoTHubSchemaClientMocks, , JSON_WRITER_RESULT, JSONWriter_AppendLiteral, JSON_WRITER*, writer, const char*, literal, size_t, literalLength);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , JSON_WRITER_RESULT, JSONWriter_AppendInt64, JSON_WRITER*, writer, int64_t, value);
+DECLARE_GLOBAL_MOCK_METHOD_3(CIoTHubSchemaClientMocks, , JSON_WRITER_RESULT, JSONWriter_AppendDouble, JSON_WRITER*, writer, double, value, int, digits);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , JSON_WRITER_RESULT, JSONWriter_AppendBool, JSON_WRITER*, writer, bool, value);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , JSON_WRITER_RESULT, JSONWriter_AppendString, JSON_WRITER*, writer, const char*, value);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , JSON_WRITER_RESULT, JSONWriter_AppendRaw, JSON_WRITER*, writer, const char*, value);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , JSON_WRITER_RESULT, JSONWriter_AppendAgentDataType, JSON_WRITER*, writer, const AGENT_DATA_TYPE*, value);
+DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , JSON_WRITER_RESULT, JSONWriter_Finish, JSON_WRITER*, writer, size_t*, destinationLength);
 DECLARE_GLOBAL_MOCK_METHOD_5(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_Members, AGENT_DATA_TYPE*, agentData, const char*, typeName, size_t, nMembers, const char* const *, memberNames, const AGENT_DATA_TYPE*, memberValues);
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_EDM_DATE_TIME_OFFSET, AGENT_DATA_TYPE*, agentData, EDM_DATE_TIME_OFFSET, v);
 DECLARE_GLOBAL_MOCK_METHOD_2(CIoTHubSchemaClientMocks, , AGENT_DATA_TYPES_RESULT, Create_AGENT_DATA_TYPE_from_EDM_GUID, AGENT_DATA_TYPE*, agentData, EDM_GUID, v);
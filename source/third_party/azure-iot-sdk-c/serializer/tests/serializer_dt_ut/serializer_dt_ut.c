@@ -44,6 +44,7 @@ static void my_gballoc_free(void* s)
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "schema.h"
 #include "codefirst.h"
+#include "jsonwriter.h"
 #undef ENABLE_MOCKS
 
 #include "commanddecoder.h"
@@ -1289,6 +1289,154 @@ BEGIN_TEST_SUITE(serializer_int)
         DESTROY_MODEL_INSTANCE(modelWithModel);
     }
 
+    /*the following tests check that SERIALIZE_MODEL_INTO produces the same JSON as SERIALIZE (keys come in declaration order and without whitespace)*/
+    TEST_FUNCTION(SERIALIZE_MODEL_INTO_WITH_DATA_IN_ROOT_MODEL_produces_same_json_as_SERIALIZE)
+    {
+        ///arrange
+        basicModel_WithData1 *modelWithData = CREATE_MODEL_INSTANCE(basic1, basicModel_WithData1, true);
+        unsigned char edmBinary[3] = { '3', '4', '5' };
+        unsigned char* expected;
+        size_t expectedSize;
+        unsigned char destination[1024];
+        size_t destinationLength;
+        int i;
+
+        modelWithData->with_data_double1 = -1.5;
+        modelWithData->with_data_int1 = -2;
+        modelWithData->with_data_float1 = 3.25f;
+        modelWithData->with_data_long1 = 4;
+        modelWithData->with_data_sint8_t1 = -128;
+        modelWithData->with_data_uint8_t1 = 255;
+        modelWithData->with_data_int16_t1 = 7;
+        modelWithData->with_data_int32_t1 = 8;
+        modelWithData->with_data_int64_t1 = INT64_MIN;
+        modelWithData->with_data_bool1 = true;
+        modelWithData->with_data_ascii_char_ptr1 = "e/le\"v\\en\x01";
+        modelWithData->with_data_ascii_char_ptr_no_quotes1 = "\"twelve\"";
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_year = 114;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_mon = 6 - 1;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_mday = 17;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_hour = 8;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_min = 51;
+        modelWithData->with_data_EdmDateTimeOffset1.dateTime.tm_sec = 23;
+        modelWithData->with_data_EdmDateTimeOffset1.hasFractionalSecond = 0;
+        modelWithData->with_data_EdmDateTimeOffset1.hasTimeZone = 1;
+        modelWithData->with_data_EdmDateTimeOffset1.timeZoneHour = 2;
+        modelWithData->with_data_EdmDateTimeOffset1.timeZoneMinute = 30;
+        for (i = 0; i < 16; i++)
+        {
+            modelWithData->with_data_EdmGuid1.GUID[i] = (unsigned char)(i * 0x11);
+        }
+        modelWithData->with_data_EdmBinary1.data = edmBinary;
+        modelWithData->with_data_EdmBinary1.size = 3;
+
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, SERIALIZE(&expected, &expectedSize, *modelWithData));
+
+        ///act
+        CODEFIRST_RESULT result = SERIALIZE_MODEL_INTO(destination, sizeof(destination), &destinationLength, basicModel_WithData1, modelWithData);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_ARE_EQUAL(char, '\0', (char)destination[destinationLength]);
+        ASSERT_IS_TRUE(areTwoJsonsEqual(expected, expectedSize, (const char*)destination));
+
+        ///clean
+        free(expected);
+        DESTROY_MODEL_INSTANCE(modelWithData);
+    }
+
+    TEST_FUNCTION(SERIALIZE_MODEL_INTO_WITH_DATA_IN_STRUCT_IN_MODEL_IN_MODEL_produces_same_json_as_SERIALIZE)
+    {
+        ///arrange
+        outerModel4 *modelWithModel = CREATE_MODEL_INSTANCE(basic4, outerModel4, true);
+        unsigned char edmBinary[2] = { 'a', 'b' };
+        unsigned char* expected;
+        size_t expectedSize;
+        unsigned char destination[1024];
+        size_t destinationLength;
+
+        modelWithModel->inner_model4.structure4.with_data_double4 = 1.0;
+        modelWithModel->inner_model4.structure4.with_data_int4 = 2;
+        modelWithModel->inner_model4.structure4.with_data_float4 = 3.0;
+        modelWithModel->inner_model4.structure4.with_data_long4 = 4;
+        modelWithModel->inner_model4.structure4.with_data_sint8_t4 = 5;
+        modelWithModel->inner_model4.structure4.with_data_uint8_t4 = 6;
+        modelWithModel->inner_model4.structure4.with_data_int16_t4 = 7;
+        modelWithModel->inner_model4.structure4.with_data_int32_t4 = 8;
+        modelWithModel->inner_model4.structure4.with_data_int64_t4 = 9;
+        modelWithModel->inner_model4.structure4.with_data_bool4 = false;
+        modelWithModel->inner_model4.structure4.with_data_ascii_char_ptr4 = "eleven";
+        modelWithModel->inner_model4.structure4.with_data_ascii_char_ptr_no_quotes4 = "12";
+        modelWithModel->inner_model4.structure4.with_data_EdmDateTimeOffset4.dateTime.tm_year = 114;
+        modelWithModel->inner_model4.structure4.with_data_EdmDateTimeOffset4.dateTime.tm_mon = 0;
+        modelWithModel->inner_model4.structure4.with_data_EdmDateTimeOffset4.dateTime.tm_mday = 1;
+        modelWithModel->inner_model4.structure4.with_data_EdmDateTimeOffset4.dateTime.tm_hour = 0;
+        modelWithModel->inner_model4.structure4.with_data_EdmDateTimeOffset4.dateTime.tm_min = 0;
+        modelWithModel->inner_model4.structure4.with_data_EdmDateTimeOffset4.dateTime.tm_sec = 0;
+        modelWithModel->inner_model4.structure4.with_data_EdmDateTimeOffset4.hasFractionalSecond = 1;
+        modelWithModel->inner_model4.structure4.with_data_EdmDateTimeOffset4.fractionalSecond = 5;
+        modelWithModel->inner_model4.structure4.with_data_EdmDateTimeOffset4.hasTimeZone = 0;
+        (void)memset(modelWithModel->inner_model4.structure4.with_data_EdmGuid4.GUID, 0xA5, 16);
+        modelWithModel->inner_model4.structure4.with_data_EdmBinary4.data = edmBinary;
+        modelWithModel->inner_model4.structure4.with_data_EdmBinary4.size = 2;
+
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, SERIALIZE(&expected, &expectedSize, *modelWithModel));
+
+        ///act
+        CODEFIRST_RESULT result = SERIALIZE_MODEL_INTO(destination, sizeof(destination), &destinationLength, outerModel4, modelWithModel);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, result);
+        ASSERT_IS_TRUE(areTwoJsonsEqual(expected, expectedSize, (const char*)destination));
+
+        ///clean
+        free(expected);
+        DESTROY_MODEL_INSTANCE(modelWithModel);
+    }
+
+    TEST_FUNCTION(SERIALIZE_MODEL_INTO_with_too_small_buffer_returns_needed_length)
+    {
+        ///arrange
+        model_WithData3 *modelWithData = CREATE_MODEL_INSTANCE(basic3, model_WithData3, true);
+        unsigned char destination[1024];
+        size_t destinationLength;
+        size_t neededLength;
+
+        modelWithData->with_data_ascii_char_ptr3 = "eleven";
+        modelWithData->with_data_ascii_char_ptr_no_quotes3 = "12";
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_OK, SERIALIZE_MODEL_INTO(destination, sizeof(destination), &neededLength, model_WithData3, modelWithData));
+
+        ///act
+        CODEFIRST_RESULT result = SERIALIZE_MODEL_INTO(destination, neededLength - 1, &destinationLength, model_WithData3, modelWithData);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_NOT_ENOUGH_MEMORY, result);
+        ASSERT_ARE_EQUAL(size_t, neededLength, destinationLength);
+
+        ///clean
+        DESTROY_MODEL_INSTANCE(modelWithData);
+    }
+
+    TEST_FUNCTION(SERIALIZE_MODEL_INTO_with_NULL_string_fails)
+    {
+        ///arrange
+        model_WithData3 *modelWithData = CREATE_MODEL_INSTANCE(basic3, model_WithData3, true);
+        unsigned char destination[1024];
+        size_t destinationLength;
+
+        modelWithData->with_data_ascii_char_ptr3 = NULL;
+        modelWithData->with_data_ascii_char_ptr_no_quotes3 = "12";
+
+        ///act
+        CODEFIRST_RESULT result = SERIALIZE_MODEL_INTO(destination, sizeof(destination), &destinationLength, model_WithData3, modelWithData);
+
+        ///assert
+        ASSERT_ARE_EQUAL(CODEFIRST_RESULT, CODEFIRST_ERROR, result);
+
+        ///clean
+        DESTROY_MODEL_INSTANCE(modelWithData);
+    }
+
     /*the following test has a model consisting only of root level WITH_REPORTED_PROPERTY properties of all types*/
     /*conceptually:
     MODEL
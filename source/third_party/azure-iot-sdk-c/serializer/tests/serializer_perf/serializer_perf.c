@@ -0,0 +1,211 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Serializes the same telemetry model with SERIALIZE (CodeFirst/DataPublisher/MultiTree/JSONEncoder)
+   and with SERIALIZE_MODEL_INTO (generated writer into a caller buffer), reporting messages per second
+   and allocations per message for each path. */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "serializer.h"
+
+#define DEFAULT_ITERATIONS 100000
+
+BEGIN_NAMESPACE(PerfNamespace)
+
+DECLARE_STRUCT(Location,
+    double, Latitude,
+    double, Longitude
+)
+
+DECLARE_MODEL(Telemetry,
+    WITH_DATA(ascii_char_ptr, DeviceId),
+    WITH_DATA(int, WindSpeed),
+    WITH_DATA(double, Temperature),
+    WITH_DATA(double, Humidity),
+    WITH_DATA(int64_t, SequenceNumber),
+    WITH_DATA(bool, IsOnline),
+    WITH_DATA(Location, Position)
+)
+
+END_NAMESPACE(PerfNamespace)
+
+typedef struct PERF_RESULT_TAG
+{
+    size_t messages;
+    size_t bytes;
+    clock_t elapsed;
+    size_t allocations;
+} PERF_RESULT;
+
+static void print_result(const char* label, const PERF_RESULT* perf_result)
+{
+    double seconds = (perf_result->elapsed == 0) ? (1.0 / CLOCKS_PER_SEC) : ((double)perf_result->elapsed / CLOCKS_PER_SEC);
+
+    (void)printf("%s: %lu messages, %lu bytes each, %.0f ms, %.0f messages/sec, ", label,
+        (unsigned long)perf_result->messages, (unsigned long)(perf_result->bytes / perf_result->messages),
+        seconds * 1000.0, (double)perf_result->messages / seconds);
+
+    if (perf_result->allocations == SIZE_MAX)
+    {
+        (void)printf("allocations n/a (configure with -Dmemory_trace=ON to count allocations)\r\n");
+    }
+    else
+    {
+        (void)printf("%.2f allocations/message\r\n", (double)perf_result->allocations / (double)perf_result->messages);
+    }
+}
+
+static size_t get_allocation_count(void)
+{
+    return gballoc_getAllocationCount();
+}
+
+static size_t allocations_between(size_t before, size_t after)
+{
+    return ((before == SIZE_MAX) || (after == SIZE_MAX)) ? SIZE_MAX : (after - before);
+}
+
+static int run_serialize(Telemetry* telemetry, size_t iterations, PERF_RESULT* perf_result)
+{
+    int result = 0;
+    clock_t start_time;
+    size_t allocations_before = get_allocation_count();
+    size_t i;
+
+    perf_result->messages = 0;
+    perf_result->bytes = 0;
+
+    start_time = clock();
+    for (i = 0; i < iterations; i++)
+    {
+        unsigned char* destination;
+        size_t destinationSize;
+
+        telemetry->SequenceNumber = (int64_t)i;
+        if (SERIALIZE(&destination, &destinationSize, *telemetry) != CODEFIRST_OK)
+        {
+            (void)printf("SERIALIZE failed at message %lu\r\n", (unsigned long)i);
+            result = __LINE__;
+            break;
+        }
+
+        perf_result->messages++;
+        perf_result->bytes += destinationSize;
+        free(destination);
+    }
+    perf_result->elapsed = clock() - start_time;
+    perf_result->allocations = allocations_between(allocations_before, get_allocation_count());
+
+    return result;
+}
+
+static int run_serialize_model_into(Telemetry* telemetry, size_t iterations, PERF_RESULT* perf_result)
+{
+    int result = 0;
+    unsigned char destination[512];
+    clock_t start_time;
+    size_t allocations_before = get_allocation_count();
+    size_t i;
+
+    perf_result->messages = 0;
+    perf_result->bytes = 0;
+
+    start_time = clock();
+    for (i = 0; i < iterations; i++)
+    {
+        size_t destinationLength;
+
+        telemetry->SequenceNumber = (int64_t)i;
+        if (SERIALIZE_MODEL_INTO(destination, sizeof(destination), &destinationLength, Telemetry, telemetry) != CODEFIRST_OK)
+        {
+            (void)printf("SERIALIZE_MODEL_INTO failed at message %lu\r\n", (unsigned long)i);
+            result = __LINE__;
+            break;
+        }
+
+        perf_result->messages++;
+        perf_result->bytes += destinationLength;
+    }
+    perf_result->elapsed = clock() - start_time;
+    perf_result->allocations = allocations_between(allocations_before, get_allocation_count());
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    size_t iterations = DEFAULT_ITERATIONS;
+
+    if (argc > 1)
+    {
+        iterations = (size_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (iterations == 0)
+    {
+        (void)printf("usage: serializer_perf [iterations]\r\n");
+        result = __LINE__;
+    }
+    else if (gballoc_init() != 0)
+    {
+        (void)printf("gballoc_init failed\r\n");
+        result = __LINE__;
+    }
+    else
+    {
+        if (serializer_init(NULL) != SERIALIZER_OK)
+        {
+            (void)printf("serializer_init failed\r\n");
+            result = __LINE__;
+        }
+        else
+        {
+            Telemetry* telemetry = CREATE_MODEL_INSTANCE(PerfNamespace, Telemetry);
+
+            if (telemetry == NULL)
+            {
+                (void)printf("CREATE_MODEL_INSTANCE failed\r\n");
+                result = __LINE__;
+            }
+            else
+            {
+                PERF_RESULT serialize_result;
+                PERF_RESULT serialize_model_into_result;
+
+                telemetry->DeviceId = "myFirstDevice";
+                telemetry->WindSpeed = 12;
+                telemetry->Temperature = 21.5;
+                telemetry->Humidity = 0.43;
+                telemetry->IsOnline = true;
+                telemetry->Position.Latitude = 47.64;
+                telemetry->Position.Longitude = -122.13;
+
+                result = run_serialize(telemetry, iterations, &serialize_result);
+                if (result == 0)
+                {
+                    result = run_serialize_model_into(telemetry, iterations, &serialize_model_into_result);
+                    if (result == 0)
+                    {
+                        print_result("SERIALIZE", &serialize_result);
+                        print_result("SERIALIZE_MODEL_INTO", &serialize_model_into_result);
+                    }
+                }
+            }
+
+            if (telemetry != NULL)
+            {
+                DESTROY_MODEL_INSTANCE(telemetry);
+            }
+
+            serializer_deinit();
+        }
+
+        gballoc_deinit();
+    }
+
+    return result;
+}
@@ -20,12 +20,29 @@ extern "C" {
 
     typedef struct DISPOSITION_INSTANCE_TAG* DISPOSITION_HANDLE;
 
+    typedef struct DISPOSITION_FIELDS_TAG
+    {
+        role role_value;
+        bool role_is_set;
+        delivery_number first_value;
+        bool first_is_set;
+        delivery_number last_value;
+        bool last_is_set;
+        bool settled_value;
+        bool settled_is_set;
+        AMQP_VALUE state_value;
+        bool state_is_set;
+        bool batchable_value;
+        bool batchable_is_set;
+    } DISPOSITION_FIELDS;
+
     MOCKABLE_FUNCTION(, DISPOSITION_HANDLE, disposition_create , role, role_value, delivery_number, first_value);
     MOCKABLE_FUNCTION(, DISPOSITION_HANDLE, disposition_clone, DISPOSITION_HANDLE, value);
     MOCKABLE_FUNCTION(, void, disposition_destroy, DISPOSITION_HANDLE, disposition);
     MOCKABLE_FUNCTION(, bool, is_disposition_type_by_descriptor, AMQP_VALUE, descriptor);
     MOCKABLE_FUNCTION(, int, amqpvalue_get_disposition, AMQP_VALUE, value, DISPOSITION_HANDLE*, DISPOSITION_handle);
     MOCKABLE_FUNCTION(, AMQP_VALUE, amqpvalue_create_disposition, DISPOSITION_HANDLE, disposition);
+    MOCKABLE_FUNCTION(, int, disposition_get_fields, DISPOSITION_HANDLE, disposition, DISPOSITION_FIELDS*, disposition_fields);
 
     MOCKABLE_FUNCTION(, int, disposition_get_role, DISPOSITION_HANDLE, disposition, role*, role_value);
     MOCKABLE_FUNCTION(, int, disposition_set_role, DISPOSITION_HANDLE, disposition, role, role_value);
@@ -20,12 +20,39 @@ extern "C" {
 
     typedef struct FLOW_INSTANCE_TAG* FLOW_HANDLE;
 
+    typedef struct FLOW_FIELDS_TAG
+    {
+        transfer_number next_incoming_id_value;
+        bool next_incoming_id_is_set;
+        uint32_t incoming_window_value;
+        bool incoming_window_is_set;
+        transfer_number next_outgoing_id_value;
+        bool next_outgoing_id_is_set;
+        uint32_t outgoing_window_value;
+        bool outgoing_window_is_set;
+        handle handle_value;
+        bool handle_is_set;
+        sequence_no delivery_count_value;
+        bool delivery_count_is_set;
+        uint32_t link_credit_value;
+        bool link_credit_is_set;
+        uint32_t available_value;
+        bool available_is_set;
+        bool drain_value;
+        bool drain_is_set;
+        bool echo_value;
+        bool echo_is_set;
+        fields properties_value;
+        bool properties_is_set;
+    } FLOW_FIELDS;
+
     MOCKABLE_FUNCTION(, FLOW_HANDLE, flow_create , uint32_t, incoming_window_value, transfer_number, next_outgoing_id_value, uint32_t, outgoing_window_value);
     MOCKABLE_FUNCTION(, FLOW_HANDLE, flow_clone, FLOW_HANDLE, value);
     MOCKABLE_FUNCTION(, void, flow_destroy, FLOW_HANDLE, flow);
     MOCKABLE_FUNCTION(, bool, is_flow_type_by_descriptor, AMQP_VALUE, descriptor);
     MOCKABLE_FUNCTION(, int, amqpvalue_get_flow, AMQP_VALUE, value, FLOW_HANDLE*, FLOW_handle);
     MOCKABLE_FUNCTION(, AMQP_VALUE, amqpvalue_create_flow, FLOW_HANDLE, flow);
+    MOCKABLE_FUNCTION(, int, flow_get_fields, FLOW_HANDLE, flow, FLOW_FIELDS*, flow_fields);
 
     MOCKABLE_FUNCTION(, int, flow_get_next_incoming_id, FLOW_HANDLE, flow, transfer_number*, next_incoming_id_value);
     MOCKABLE_FUNCTION(, int, flow_set_next_incoming_id, FLOW_HANDLE, flow, transfer_number, next_incoming_id_value);
@@ -20,12 +20,39 @@ extern "C" {
 
     typedef struct TRANSFER_INSTANCE_TAG* TRANSFER_HANDLE;
 
+    typedef struct TRANSFER_FIELDS_TAG
+    {
+        handle handle_value;
+        bool handle_is_set;
+        delivery_number delivery_id_value;
+        bool delivery_id_is_set;
+        delivery_tag delivery_tag_value;
+        bool delivery_tag_is_set;
+        message_format message_format_value;
+        bool message_format_is_set;
+        bool settled_value;
+        bool settled_is_set;
+        bool more_value;
+        bool more_is_set;
+        receiver_settle_mode rcv_settle_mode_value;
+        bool rcv_settle_mode_is_set;
+        AMQP_VALUE state_value;
+        bool state_is_set;
+        bool resume_value;
+        bool resume_is_set;
+        bool aborted_value;
+        bool aborted_is_set;
+        bool batchable_value;
+        bool batchable_is_set;
+    } TRANSFER_FIELDS;
+
     MOCKABLE_FUNCTION(, TRANSFER_HANDLE, transfer_create , handle, handle_value);
     MOCKABLE_FUNCTION(, TRANSFER_HANDLE, transfer_clone, TRANSFER_HANDLE, value);
     MOCKABLE_FUNCTION(, void, transfer_destroy, TRANSFER_HANDLE, transfer);
     MOCKABLE_FUNCTION(, bool, is_transfer_type_by_descriptor, AMQP_VALUE, descriptor);
     MOCKABLE_FUNCTION(, int, amqpvalue_get_transfer, AMQP_VALUE, value, TRANSFER_HANDLE*, TRANSFER_handle);
     MOCKABLE_FUNCTION(, AMQP_VALUE, amqpvalue_create_transfer, TRANSFER_HANDLE, transfer);
+    MOCKABLE_FUNCTION(, int, transfer_get_fields, TRANSFER_HANDLE, transfer, TRANSFER_FIELDS*, transfer_fields);
 
     MOCKABLE_FUNCTION(, int, transfer_get_handle, TRANSFER_HANDLE, transfer, handle*, handle_value);
     MOCKABLE_FUNCTION(, int, transfer_set_handle, TRANSFER_HANDLE, transfer, handle, handle_value);
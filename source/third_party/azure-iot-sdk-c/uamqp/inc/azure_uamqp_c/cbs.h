@@ -10,8 +10,10 @@
 
 #ifdef __cplusplus
 extern "C" {
+#include <cstddef>
 #else
 #include <stdbool.h>
+#include <stddef.h>
 #endif /* __cplusplus */
 
 #define CBS_OPERATION_RESULT_VALUES \
@@ -41,6 +43,7 @@ DEFINE_ENUM(CBS_OPEN_COMPLETE_RESULT, CBS_OPEN_COMPLETE_RESULT_VALUES)
     MOCKABLE_FUNCTION(, int, cbs_put_token_async, CBS_HANDLE, cbs, const char*, type, const char*, audience, const char*, token, ON_CBS_OPERATION_COMPLETE, on_cbs_put_token_complete, void*, on_cbs_put_token_complete_context);
     MOCKABLE_FUNCTION(, int, cbs_delete_token_async, CBS_HANDLE, cbs, const char*, type, const char*, audience, ON_CBS_OPERATION_COMPLETE, on_cbs_delete_token_complete, void*, on_cbs_delete_token_complete_context);
     MOCKABLE_FUNCTION(, int, cbs_set_trace, CBS_HANDLE, cbs, bool, trace_on);
+    MOCKABLE_FUNCTION(, int, cbs_set_max_outstanding_operations, CBS_HANDLE, cbs, size_t, max_outstanding_operations);
 
 #ifdef __cplusplus
 }
@@ -4,6 +4,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <string.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_uamqp_c/amqpvalue.h"
@@ -6786,6 +6787,202 @@ int flow_set_properties(FLOW_HANDLE flow, fields properties_value)
 }
 
 
+int flow_get_fields(FLOW_HANDLE flow, FLOW_FIELDS* flow_fields)
+{
+    int result;
+
+    if ((flow == NULL) ||
+        (flow_fields == NULL))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        uint32_t item_count;
+        FLOW_INSTANCE* flow_instance = (FLOW_INSTANCE*)flow;
+        if (amqpvalue_get_composite_item_count(flow_instance->composite_value, &item_count) != 0)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            (void)memset(flow_fields, 0, sizeof(FLOW_FIELDS));
+            result = 0;
+
+            do
+            {
+                AMQP_VALUE item_value;
+
+                /* next-incoming-id */
+                item_value = (item_count > 0) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 0) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_transfer_number(item_value, &flow_fields->next_incoming_id_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->next_incoming_id_is_set = true;
+                }
+
+                /* incoming-window */
+                item_value = (item_count > 1) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 1) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_uint(item_value, &flow_fields->incoming_window_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->incoming_window_is_set = true;
+                }
+
+                /* next-outgoing-id */
+                item_value = (item_count > 2) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 2) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_transfer_number(item_value, &flow_fields->next_outgoing_id_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->next_outgoing_id_is_set = true;
+                }
+
+                /* outgoing-window */
+                item_value = (item_count > 3) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 3) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_uint(item_value, &flow_fields->outgoing_window_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->outgoing_window_is_set = true;
+                }
+
+                /* handle */
+                item_value = (item_count > 4) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 4) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_handle(item_value, &flow_fields->handle_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->handle_is_set = true;
+                }
+
+                /* delivery-count */
+                item_value = (item_count > 5) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 5) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_sequence_no(item_value, &flow_fields->delivery_count_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->delivery_count_is_set = true;
+                }
+
+                /* link-credit */
+                item_value = (item_count > 6) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 6) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_uint(item_value, &flow_fields->link_credit_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->link_credit_is_set = true;
+                }
+
+                /* available */
+                item_value = (item_count > 7) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 7) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_uint(item_value, &flow_fields->available_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->available_is_set = true;
+                }
+
+                /* drain */
+                item_value = (item_count > 8) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 8) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_boolean(item_value, &flow_fields->drain_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->drain_is_set = true;
+                }
+                else
+                {
+                    flow_fields->drain_value = false;
+                    flow_fields->drain_is_set = true;
+                }
+
+                /* echo */
+                item_value = (item_count > 9) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 9) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_boolean(item_value, &flow_fields->echo_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->echo_is_set = true;
+                }
+                else
+                {
+                    flow_fields->echo_value = false;
+                    flow_fields->echo_is_set = true;
+                }
+
+                /* properties */
+                item_value = (item_count > 10) ? amqpvalue_get_composite_item_in_place(flow_instance->composite_value, 10) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_fields(item_value, &flow_fields->properties_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    flow_fields->properties_is_set = true;
+                }
+            } while (0);
+        }
+    }
+
+    return result;
+}
+
 /* transfer */
 
 typedef struct TRANSFER_INSTANCE_TAG
@@ -8205,6 +8402,207 @@ int transfer_set_batchable(TRANSFER_HANDLE transfer, bool batchable_value)
 }
 
 
+int transfer_get_fields(TRANSFER_HANDLE transfer, TRANSFER_FIELDS* transfer_fields)
+{
+    int result;
+
+    if ((transfer == NULL) ||
+        (transfer_fields == NULL))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        uint32_t item_count;
+        TRANSFER_INSTANCE* transfer_instance = (TRANSFER_INSTANCE*)transfer;
+        if (amqpvalue_get_composite_item_count(transfer_instance->composite_value, &item_count) != 0)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            (void)memset(transfer_fields, 0, sizeof(TRANSFER_FIELDS));
+            result = 0;
+
+            do
+            {
+                AMQP_VALUE item_value;
+
+                /* handle */
+                item_value = (item_count > 0) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 0) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_handle(item_value, &transfer_fields->handle_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->handle_is_set = true;
+                }
+
+                /* delivery-id */
+                item_value = (item_count > 1) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 1) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_delivery_number(item_value, &transfer_fields->delivery_id_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->delivery_id_is_set = true;
+                }
+
+                /* delivery-tag */
+                item_value = (item_count > 2) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 2) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_delivery_tag(item_value, &transfer_fields->delivery_tag_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->delivery_tag_is_set = true;
+                }
+
+                /* message-format */
+                item_value = (item_count > 3) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 3) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_message_format(item_value, &transfer_fields->message_format_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->message_format_is_set = true;
+                }
+
+                /* settled */
+                item_value = (item_count > 4) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 4) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_boolean(item_value, &transfer_fields->settled_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->settled_is_set = true;
+                }
+
+                /* more */
+                item_value = (item_count > 5) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 5) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_boolean(item_value, &transfer_fields->more_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->more_is_set = true;
+                }
+                else
+                {
+                    transfer_fields->more_value = false;
+                    transfer_fields->more_is_set = true;
+                }
+
+                /* rcv-settle-mode */
+                item_value = (item_count > 6) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 6) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_receiver_settle_mode(item_value, &transfer_fields->rcv_settle_mode_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->rcv_settle_mode_is_set = true;
+                }
+
+                /* state */
+                item_value = (item_count > 7) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 7) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    transfer_fields->state_value = item_value;
+                    transfer_fields->state_is_set = true;
+                }
+
+                /* resume */
+                item_value = (item_count > 8) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 8) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_boolean(item_value, &transfer_fields->resume_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->resume_is_set = true;
+                }
+                else
+                {
+                    transfer_fields->resume_value = false;
+                    transfer_fields->resume_is_set = true;
+                }
+
+                /* aborted */
+                item_value = (item_count > 9) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 9) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_boolean(item_value, &transfer_fields->aborted_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->aborted_is_set = true;
+                }
+                else
+                {
+                    transfer_fields->aborted_value = false;
+                    transfer_fields->aborted_is_set = true;
+                }
+
+                /* batchable */
+                item_value = (item_count > 10) ? amqpvalue_get_composite_item_in_place(transfer_instance->composite_value, 10) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_boolean(item_value, &transfer_fields->batchable_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    transfer_fields->batchable_is_set = true;
+                }
+                else
+                {
+                    transfer_fields->batchable_value = false;
+                    transfer_fields->batchable_is_set = true;
+                }
+            } while (0);
+        }
+    }
+
+    return result;
+}
+
 /* disposition */
 
 typedef struct DISPOSITION_INSTANCE_TAG
@@ -9062,6 +9460,127 @@ int disposition_set_batchable(DISPOSITION_HANDLE disposition, bool batchable_val
 }
 
 
+int disposition_get_fields(DISPOSITION_HANDLE disposition, DISPOSITION_FIELDS* disposition_fields)
+{
+    int result;
+
+    if ((disposition == NULL) ||
+        (disposition_fields == NULL))
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        uint32_t item_count;
+        DISPOSITION_INSTANCE* disposition_instance = (DISPOSITION_INSTANCE*)disposition;
+        if (amqpvalue_get_composite_item_count(disposition_instance->composite_value, &item_count) != 0)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            (void)memset(disposition_fields, 0, sizeof(DISPOSITION_FIELDS));
+            result = 0;
+
+            do
+            {
+                AMQP_VALUE item_value;
+
+                /* role */
+                item_value = (item_count > 0) ? amqpvalue_get_composite_item_in_place(disposition_instance->composite_value, 0) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_role(item_value, &disposition_fields->role_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    disposition_fields->role_is_set = true;
+                }
+
+                /* first */
+                item_value = (item_count > 1) ? amqpvalue_get_composite_item_in_place(disposition_instance->composite_value, 1) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_delivery_number(item_value, &disposition_fields->first_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    disposition_fields->first_is_set = true;
+                }
+
+                /* last */
+                item_value = (item_count > 2) ? amqpvalue_get_composite_item_in_place(disposition_instance->composite_value, 2) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_delivery_number(item_value, &disposition_fields->last_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    disposition_fields->last_is_set = true;
+                }
+
+                /* settled */
+                item_value = (item_count > 3) ? amqpvalue_get_composite_item_in_place(disposition_instance->composite_value, 3) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_boolean(item_value, &disposition_fields->settled_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    disposition_fields->settled_is_set = true;
+                }
+                else
+                {
+                    disposition_fields->settled_value = false;
+                    disposition_fields->settled_is_set = true;
+                }
+
+                /* state */
+                item_value = (item_count > 4) ? amqpvalue_get_composite_item_in_place(disposition_instance->composite_value, 4) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    disposition_fields->state_value = item_value;
+                    disposition_fields->state_is_set = true;
+                }
+
+                /* batchable */
+                item_value = (item_count > 5) ? amqpvalue_get_composite_item_in_place(disposition_instance->composite_value, 5) : NULL;
+                if ((item_value != NULL) &&
+                    (amqpvalue_get_type(item_value) != AMQP_TYPE_NULL))
+                {
+                    if (amqpvalue_get_boolean(item_value, &disposition_fields->batchable_value) != 0)
+                    {
+                        result = __FAILURE__;
+                        break;
+                    }
+
+                    disposition_fields->batchable_is_set = true;
+                }
+                else
+                {
+                    disposition_fields->batchable_value = false;
+                    disposition_fields->batchable_is_set = true;
+                }
+            } while (0);
+        }
+    }
+
+    return result;
+}
+
 /* detach */
 
 typedef struct DETACH_INSTANCE_TAG
@@ -35,10 +35,17 @@ typedef struct AMQP_MAP_KEY_VALUE_PAIR_TAG
     AMQP_VALUE value;
 } AMQP_MAP_KEY_VALUE_PAIR;
 
+/* Maps with at least this many pairs get a hashed key index built on the first key lookup.
+Smaller maps are scanned linearly, which is cheaper than hashing for a handful of keys. */
+#define AMQP_MAP_INDEX_MIN_PAIR_COUNT   8
+
 typedef struct AMQP_MAP_VALUE_TAG
 {
     AMQP_MAP_KEY_VALUE_PAIR* pairs;
     uint32_t pair_count;
+    /* open addressing table, each slot holds (pair index + 1) or 0 if the slot is empty */
+    uint32_t* index_slots;
+    uint32_t index_slot_count;
 } AMQP_MAP_VALUE;
 
 typedef struct AMQP_STRING_VALUE_TAG
@@ -1516,6 +1523,215 @@ AMQP_VALUE amqpvalue_create_map(void)
         /* Codes_SRS_AMQPVALUE_01_180: [The number of key/value pairs in the newly created map shall be zero.] */
         result->value.map_value.pairs = NULL;
         result->value.map_value.pair_count = 0;
+        result->value.map_value.index_slots = NULL;
+        result->value.map_value.index_slot_count = 0;
+    }
+
+    return result;
+}
+
+static uint32_t hash_bytes(uint32_t hash, const unsigned char* bytes, size_t length)
+{
+    /* FNV-1a */
+    size_t i;
+    for (i = 0; i < length; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 16777619U;
+    }
+
+    return hash;
+}
+
+/* Values that amqpvalue_are_equal considers equal shall produce the same hash */
+static uint32_t amqpvalue_hash(AMQP_VALUE value)
+{
+    AMQP_VALUE_DATA* value_data = (AMQP_VALUE_DATA*)value;
+    uint32_t result = hash_bytes(2166136261U, (const unsigned char*)&value_data->type, sizeof(value_data->type));
+
+    switch (value_data->type)
+    {
+    default:
+        break;
+
+    case AMQP_TYPE_BOOL:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.bool_value, sizeof(value_data->value.bool_value));
+        break;
+    case AMQP_TYPE_UBYTE:
+        result = hash_bytes(result, &value_data->value.ubyte_value, sizeof(value_data->value.ubyte_value));
+        break;
+    case AMQP_TYPE_USHORT:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.ushort_value, sizeof(value_data->value.ushort_value));
+        break;
+    case AMQP_TYPE_UINT:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.uint_value, sizeof(value_data->value.uint_value));
+        break;
+    case AMQP_TYPE_ULONG:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.ulong_value, sizeof(value_data->value.ulong_value));
+        break;
+    case AMQP_TYPE_BYTE:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.byte_value, sizeof(value_data->value.byte_value));
+        break;
+    case AMQP_TYPE_SHORT:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.short_value, sizeof(value_data->value.short_value));
+        break;
+    case AMQP_TYPE_INT:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.int_value, sizeof(value_data->value.int_value));
+        break;
+    case AMQP_TYPE_LONG:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.long_value, sizeof(value_data->value.long_value));
+        break;
+    case AMQP_TYPE_FLOAT:
+        /* 0.0 and -0.0 compare equal, so they only contribute the type to the hash */
+        if (value_data->value.float_value != 0.0f)
+        {
+            result = hash_bytes(result, (const unsigned char*)&value_data->value.float_value, sizeof(value_data->value.float_value));
+        }
+        break;
+    case AMQP_TYPE_DOUBLE:
+        if (value_data->value.double_value != 0.0)
+        {
+            result = hash_bytes(result, (const unsigned char*)&value_data->value.double_value, sizeof(value_data->value.double_value));
+        }
+        break;
+    case AMQP_TYPE_CHAR:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.char_value, sizeof(value_data->value.char_value));
+        break;
+    case AMQP_TYPE_TIMESTAMP:
+        result = hash_bytes(result, (const unsigned char*)&value_data->value.timestamp_value, sizeof(value_data->value.timestamp_value));
+        break;
+    case AMQP_TYPE_UUID:
+        result = hash_bytes(result, value_data->value.uuid_value, sizeof(value_data->value.uuid_value));
+        break;
+    case AMQP_TYPE_BINARY:
+        result = hash_bytes(result, (const unsigned char*)value_data->value.binary_value.bytes, value_data->value.binary_value.length);
+        break;
+    case AMQP_TYPE_STRING:
+        result = hash_bytes(result, (const unsigned char*)value_data->value.string_value.chars, strlen(value_data->value.string_value.chars));
+        break;
+    case AMQP_TYPE_SYMBOL:
+        result = hash_bytes(result, (const unsigned char*)value_data->value.symbol_value.chars, strlen(value_data->value.symbol_value.chars));
+        break;
+    case AMQP_TYPE_LIST:
+    {
+        uint32_t i;
+        for (i = 0; i < value_data->value.list_value.count; i++)
+        {
+            result = (result * 31U) ^ amqpvalue_hash(value_data->value.list_value.items[i]);
+        }
+        break;
+    }
+    case AMQP_TYPE_MAP:
+    {
+        uint32_t i;
+        for (i = 0; i < value_data->value.map_value.pair_count; i++)
+        {
+            result = (result * 31U) ^ amqpvalue_hash(value_data->value.map_value.pairs[i].key);
+            result = (result * 31U) ^ amqpvalue_hash(value_data->value.map_value.pairs[i].value);
+        }
+        break;
+    }
+    }
+
+    return result;
+}
+
+static void map_index_insert(AMQP_MAP_VALUE* map_value, uint32_t pair_index)
+{
+    uint32_t mask = map_value->index_slot_count - 1;
+    uint32_t slot = amqpvalue_hash(map_value->pairs[pair_index].key) & mask;
+
+    while (map_value->index_slots[slot] != 0)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    map_value->index_slots[slot] = pair_index + 1;
+}
+
+static void map_index_destroy(AMQP_MAP_VALUE* map_value)
+{
+    if (map_value->index_slots != NULL)
+    {
+        free(map_value->index_slots);
+        map_value->index_slots = NULL;
+        map_value->index_slot_count = 0;
+    }
+}
+
+static int map_index_create(AMQP_MAP_VALUE* map_value)
+{
+    int result;
+    uint32_t slot_count = 16;
+    uint32_t i;
+
+    /* keep the load factor at or below 1/2 */
+    while (slot_count < map_value->pair_count * 2)
+    {
+        slot_count *= 2;
+    }
+
+    map_value->index_slots = (uint32_t*)malloc(slot_count * sizeof(uint32_t));
+    if (map_value->index_slots == NULL)
+    {
+        LogError("Could not allocate map index");
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)memset(map_value->index_slots, 0, slot_count * sizeof(uint32_t));
+        map_value->index_slot_count = slot_count;
+        for (i = 0; i < map_value->pair_count; i++)
+        {
+            map_index_insert(map_value, i);
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
+
+/* Returns the index of the pair with the given key, or pair_count if the key is not in the map */
+static uint32_t map_find_pair(AMQP_MAP_VALUE* map_value, AMQP_VALUE key)
+{
+    uint32_t result;
+
+    if ((map_value->index_slots == NULL) &&
+        (map_value->pair_count >= AMQP_MAP_INDEX_MIN_PAIR_COUNT))
+    {
+        /* Codes_SRS_AMQPVALUE_01_404: [For maps with 8 or more key/value pairs amqpvalue_get_map_value shall look up the key through a hashed index of the map keys, built on the first lookup.] */
+        /* Codes_SRS_AMQPVALUE_01_405: [If allocating the hashed index fails, amqpvalue_get_map_value shall look up the key by comparing it with each key in the map.] */
+        (void)map_index_create(map_value);
+    }
+
+    if (map_value->index_slots == NULL)
+    {
+        for (result = 0; result < map_value->pair_count; result++)
+        {
+            if (amqpvalue_are_equal(map_value->pairs[result].key, key))
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        uint32_t mask = map_value->index_slot_count - 1;
+        uint32_t slot = amqpvalue_hash(key) & mask;
+
+        result = map_value->pair_count;
+        while (map_value->index_slots[slot] != 0)
+        {
+            uint32_t pair_index = map_value->index_slots[slot] - 1;
+            if (amqpvalue_are_equal(map_value->pairs[pair_index].key, key))
+            {
+                result = pair_index;
+                break;
+            }
+
+            slot = (slot + 1) & mask;
+        }
     }
 
     return result;
@@ -1561,15 +1777,7 @@ int amqpvalue_set_map_value(AMQP_VALUE map, AMQP_VALUE key, AMQP_VALUE value)
                 uint32_t i;
                 AMQP_VALUE cloned_key;
 
-                for (i = 0; i < value_data->value.map_value.pair_count; i++)
-                {
-                    if (amqpvalue_are_equal(value_data->value.map_value.pairs[i].key, key))
-                    {
-                        LogError("Could not allocate NULL value for map entries");
-                        break;
-                    }
-                }
-
+                i = map_find_pair(&value_data->value.map_value, key);
                 if (i < value_data->value.map_value.pair_count)
                 {
                     /* Codes_SRS_AMQPVALUE_01_184: [If the key already exists in the map, its value shall be replaced with the value provided by the value argument.] */
@@ -1611,6 +1819,19 @@ int amqpvalue_set_map_value(AMQP_VALUE map, AMQP_VALUE key, AMQP_VALUE value)
                             value_data->value.map_value.pairs[value_data->value.map_value.pair_count].value = cloned_value;
                             value_data->value.map_value.pair_count++;
 
+                            if (value_data->value.map_value.index_slots != NULL)
+                            {
+                                if (value_data->value.map_value.pair_count * 2 > value_data->value.map_value.index_slot_count)
+                                {
+                                    /* the index is rebuilt with more slots on the next lookup */
+                                    map_index_destroy(&value_data->value.map_value);
+                                }
+                                else
+                                {
+                                    map_index_insert(&value_data->value.map_value, value_data->value.map_value.pair_count - 1);
+                                }
+                            }
+
                             /* Codes_SRS_AMQPVALUE_01_182: [On success amqpvalue_set_map_value shall return 0.] */
                             result = 0;
                         }
@@ -1647,15 +1868,7 @@ AMQP_VALUE amqpvalue_get_map_value(AMQP_VALUE map, AMQP_VALUE key)
         }
         else
         {
-            uint32_t i;
-
-            for (i = 0; i < value_data->value.map_value.pair_count; i++)
-            {
-                if (amqpvalue_are_equal(value_data->value.map_value.pairs[i].key, key))
-                {
-                    break;
-                }
-            }
+            uint32_t i = map_find_pair(&value_data->value.map_value, key);
 
             if (i == value_data->value.map_value.pair_count)
             {
@@ -3270,6 +3483,7 @@ static void amqpvalue_clear(AMQP_VALUE_DATA* value_data)
 
         free(value_data->value.map_value.pairs);
         value_data->value.map_value.pairs = NULL;
+        map_index_destroy(&value_data->value.map_value);
         break;
     }
     case AMQP_TYPE_ARRAY:
@@ -3804,6 +4018,8 @@ static int internal_decoder_decode_bytes(INTERNAL_DECODER_DATA* internal_decoder
                     internal_decoder_data->decoder_state = DECODER_STATE_TYPE_DATA;
                     internal_decoder_data->decode_to_value->value.map_value.pair_count = 0;
                     internal_decoder_data->decode_to_value->value.map_value.pairs = NULL;
+                    internal_decoder_data->decode_to_value->value.map_value.index_slots = NULL;
+                    internal_decoder_data->decode_to_value->value.map_value.index_slot_count = 0;
                     internal_decoder_data->bytes_decoded = 0;
                     internal_decoder_data->decode_value_state.map_value_state.map_value_state = DECODE_MAP_STEP_SIZE;
 
@@ -26,6 +26,13 @@ typedef struct CBS_OPERATION_TAG
     ON_CBS_OPERATION_COMPLETE on_cbs_operation_complete;
     void* on_cbs_operation_complete_context;
     SINGLYLINKEDLIST_HANDLE pending_operations;
+    struct CBS_INSTANCE_TAG* cbs;
+    const char* operation;
+    char* type;
+    /* non-NULL only while the operation is queued and not yet handed to AMQP management */
+    MESSAGE_HANDLE message;
+    /* links queued operations that failed to start until their callbacks are called */
+    struct CBS_OPERATION_TAG* next_failed;
 } CBS_OPERATION;
 
 typedef struct CBS_INSTANCE_TAG
@@ -37,6 +44,9 @@ typedef struct CBS_INSTANCE_TAG
     ON_CBS_ERROR on_cbs_error;
     void* on_cbs_error_context;
     SINGLYLINKEDLIST_HANDLE pending_operations;
+    size_t max_outstanding_operations;
+    size_t outstanding_operation_count;
+    size_t queued_operation_count;
 } CBS_INSTANCE;
 
 static int add_string_key_value_pair_to_map(AMQP_VALUE map, const char* key, const char* value)
@@ -183,6 +193,9 @@ static void on_underlying_amqp_management_error(void* context)
     }
 }
 
+static void start_queued_operations(CBS_INSTANCE* cbs);
+static void free_operation(CBS_OPERATION* cbs_operation);
+
 static void on_amqp_management_execute_operation_complete(void* context, AMQP_MANAGEMENT_EXECUTE_OPERATION_RESULT execute_operation_result, unsigned int status_code, const char* status_description, MESSAGE_HANDLE message)
 {
     if (context == NULL)
@@ -204,6 +217,10 @@ static void on_amqp_management_execute_operation_complete(void* context, AMQP_MA
         }
         else
         {
+            CBS_INSTANCE* cbs = cbs_operation->cbs;
+            ON_CBS_OPERATION_COMPLETE on_cbs_operation_complete = cbs_operation->on_cbs_operation_complete;
+            void* on_cbs_operation_complete_context = cbs_operation->on_cbs_operation_complete_context;
+
             switch (execute_operation_result)
             {
             default:
@@ -231,6 +248,27 @@ static void on_amqp_management_execute_operation_complete(void* context, AMQP_MA
                 break;
             }
 
+            /* Codes_SRS_CBS_01_102: [ The pending operation shall be removed from the pending operations list by calling `singlylinkedlist_remove`. ]*/
+            if (singlylinkedlist_remove(cbs_operation->pending_operations, (LIST_ITEM_HANDLE)context) != 0)
+            {
+                LogError("Failed removing operation from the pending list");
+            }
+
+            /* Codes_SRS_CBS_01_096: [ The `context` for the operation shall also be freed. ]*/
+            free_operation(cbs_operation);
+
+            if (cbs->outstanding_operation_count > 0)
+            {
+                cbs->outstanding_operation_count--;
+            }
+
+            /* Codes_SRS_CBS_01_125: [ When an operation completes with any result other than `AMQP_MANAGEMENT_EXECUTE_OPERATION_INSTANCE_CLOSED`, queued operations shall be started in the order they were requested until the outstanding operations limit is reached again. ]*/
+            if (execute_operation_result != AMQP_MANAGEMENT_EXECUTE_OPERATION_INSTANCE_CLOSED)
+            {
+                start_queued_operations(cbs);
+            }
+
+            /* Codes_SRS_CBS_01_129: [ The cbs operation complete callback shall be called only after the operation has been removed and freed and queued operations have been started, so that the callback may destroy the CBS instance. ]*/
             /* Codes_SRS_CBS_01_095: [ `status_code` and `status_description` shall be passed as they are to the cbs operation complete callback. ]*/
             /* Codes_SRS_CBS_01_014: [ The response message has the following application-properties: ]*/
             /* Codes_SRS_CBS_01_013: [ status-code    No    int    HTTP response code [RFC2616]. ]*/
@@ -240,17 +278,133 @@ static void on_amqp_management_execute_operation_complete(void* context, AMQP_MA
             /* Codes_SRS_CBS_01_027: [ status-code    Yes    int    HTTP response code [RFC2616]. ]*/
             /* Codes_SRS_CBS_01_028: [ status-description    No    string    Description of the status. ]*/
             /* Codes_SRS_CBS_01_029: [ The body of the message MUST be empty. ]*/
-            cbs_operation->on_cbs_operation_complete(cbs_operation->on_cbs_operation_complete_context, cbs_operation_result, status_code, status_description);
+            on_cbs_operation_complete(on_cbs_operation_complete_context, cbs_operation_result, status_code, status_description);
+        }
+    }
+}
 
-            /* Codes_SRS_CBS_01_102: [ The pending operation shall be removed from the pending operations list by calling `singlylinkedlist_remove`. ]*/
-            if (singlylinkedlist_remove(cbs_operation->pending_operations, (LIST_ITEM_HANDLE)context) != 0)
+static int queue_operation(CBS_OPERATION* cbs_operation, const char* type, MESSAGE_HANDLE message)
+{
+    int result;
+    size_t type_length = strlen(type);
+
+    cbs_operation->type = (char*)malloc(type_length + 1);
+    if (cbs_operation->type == NULL)
+    {
+        LogError("Cannot allocate memory for the queued operation type");
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)memcpy(cbs_operation->type, type, type_length + 1);
+
+        /* the queued operation takes ownership of the request message */
+        cbs_operation->message = message;
+        cbs_operation->cbs->queued_operation_count++;
+        result = 0;
+    }
+
+    return result;
+}
+
+static void free_operation(CBS_OPERATION* cbs_operation)
+{
+    if (cbs_operation->message != NULL)
+    {
+        message_destroy(cbs_operation->message);
+    }
+
+    if (cbs_operation->type != NULL)
+    {
+        free(cbs_operation->type);
+    }
+
+    free(cbs_operation);
+}
+
+static void start_queued_operations(CBS_INSTANCE* cbs)
+{
+    CBS_OPERATION* failed_operations = NULL;
+    CBS_OPERATION** last_failed_operation = &failed_operations;
+    LIST_ITEM_HANDLE list_item = (cbs->queued_operation_count > 0) ? singlylinkedlist_get_head_item(cbs->pending_operations) : NULL;
+
+    while ((list_item != NULL) &&
+        (cbs->queued_operation_count > 0) &&
+        ((cbs->max_outstanding_operations == 0) || (cbs->outstanding_operation_count < cbs->max_outstanding_operations)))
+    {
+        LIST_ITEM_HANDLE next_list_item = singlylinkedlist_get_next_item(list_item);
+        CBS_OPERATION* cbs_operation = (CBS_OPERATION*)singlylinkedlist_item_get_value(list_item);
+
+        if ((cbs_operation != NULL) &&
+            (cbs_operation->message != NULL))
+        {
+            MESSAGE_HANDLE message = cbs_operation->message;
+            cbs_operation->message = NULL;
+            cbs->queued_operation_count--;
+
+            /* Codes_SRS_CBS_01_126: [ A queued operation shall be started by calling `amqp_management_execute_operation_async` with the operation name, type and message captured when it was requested. ]*/
+            if (amqp_management_execute_operation_async(cbs->amqp_management, cbs_operation->operation, cbs_operation->type, NULL, message, on_amqp_management_execute_operation_complete, list_item) != 0)
+            {
+                /* Codes_SRS_CBS_01_127: [ If starting a queued operation fails, the operation shall be removed from the pending operations list and its complete callback shall be called with `CBS_OPERATION_RESULT_CBS_ERROR`. ]*/
+                LogError("Failed starting queued AMQP management operation");
+                if (singlylinkedlist_remove(cbs->pending_operations, list_item) != 0)
+                {
+                    LogError("Failed removing operation from the pending list");
+                }
+
+                cbs_operation->next_failed = NULL;
+                *last_failed_operation = cbs_operation;
+                last_failed_operation = &cbs_operation->next_failed;
+            }
+            else
+            {
+                cbs->outstanding_operation_count++;
+            }
+
+            message_destroy(message);
+        }
+
+        list_item = next_list_item;
+    }
+
+    /* Codes_SRS_CBS_01_130: [ The complete callbacks of queued operations that failed to start shall be called, each after its operation has been freed, only once every other queued operation has been started, so that the callback may destroy the CBS instance. ]*/
+    while (failed_operations != NULL)
+    {
+        CBS_OPERATION* next_failed_operation = failed_operations->next_failed;
+        ON_CBS_OPERATION_COMPLETE on_cbs_operation_complete = failed_operations->on_cbs_operation_complete;
+        void* on_cbs_operation_complete_context = failed_operations->on_cbs_operation_complete_context;
+
+        free_operation(failed_operations);
+        on_cbs_operation_complete(on_cbs_operation_complete_context, CBS_OPERATION_RESULT_CBS_ERROR, 0, NULL);
+
+        failed_operations = next_failed_operation;
+    }
+}
+
+static void complete_queued_operations(CBS_INSTANCE* cbs, CBS_OPERATION_RESULT operation_result)
+{
+    LIST_ITEM_HANDLE list_item = (cbs->queued_operation_count > 0) ? singlylinkedlist_get_head_item(cbs->pending_operations) : NULL;
+
+    while ((list_item != NULL) &&
+        (cbs->queued_operation_count > 0))
+    {
+        LIST_ITEM_HANDLE next_list_item = singlylinkedlist_get_next_item(list_item);
+        CBS_OPERATION* cbs_operation = (CBS_OPERATION*)singlylinkedlist_item_get_value(list_item);
+
+        if ((cbs_operation != NULL) &&
+            (cbs_operation->message != NULL))
+        {
+            cbs->queued_operation_count--;
+            cbs_operation->on_cbs_operation_complete(cbs_operation->on_cbs_operation_complete_context, operation_result, 0, NULL);
+            if (singlylinkedlist_remove(cbs->pending_operations, list_item) != 0)
             {
                 LogError("Failed removing operation from the pending list");
             }
 
-            /* Codes_SRS_CBS_01_096: [ The `context` for the operation shall also be freed. ]*/
-            free(cbs_operation);
+            free_operation(cbs_operation);
         }
+
+        list_item = next_list_item;
     }
 }
 
@@ -311,6 +465,9 @@ CBS_HANDLE cbs_create(SESSION_HANDLE session)
                         {
                             /* Codes_SRS_CBS_01_001: [ `cbs_create` shall create a new CBS instance and on success return a non-NULL handle to it. ]*/
                             cbs->cbs_state = CBS_STATE_CLOSED;
+                            cbs->max_outstanding_operations = 0;
+                            cbs->outstanding_operation_count = 0;
+                            cbs->queued_operation_count = 0;
 
                             goto all_ok;
                         }
@@ -359,7 +516,7 @@ void cbs_destroy(CBS_HANDLE cbs)
             if (pending_operation != NULL)
             {
                 pending_operation->on_cbs_operation_complete(pending_operation->on_cbs_operation_complete_context, CBS_OPERATION_RESULT_INSTANCE_CLOSED, 0, NULL);
-                free(pending_operation);
+                free_operation(pending_operation);
             }
 
             singlylinkedlist_remove(cbs->pending_operations, first_pending_operation);
@@ -452,6 +609,9 @@ int cbs_close(CBS_HANDLE cbs)
 
             cbs->cbs_state = CBS_STATE_CLOSED;
 
+            /* Codes_SRS_CBS_01_128: [ On success, `cbs_close` shall call the complete callback of every queued operation with `CBS_OPERATION_RESULT_INSTANCE_CLOSED` and free it. ]*/
+            complete_queued_operations(cbs, CBS_OPERATION_RESULT_INSTANCE_CLOSED);
+
             /* Codes_SRS_CBS_01_080: [ On success, `cbs_close` shall return 0. ]*/
             result = 0;
         }
@@ -549,6 +709,10 @@ int cbs_put_token_async(CBS_HANDLE cbs, const char* type, const char* audience,
                                     cbs_operation->on_cbs_operation_complete = on_cbs_put_token_complete;
                                     cbs_operation->on_cbs_operation_complete_context = on_cbs_put_token_complete_context;
                                     cbs_operation->pending_operations = cbs->pending_operations;
+                                    cbs_operation->cbs = cbs;
+                                    cbs_operation->operation = "put-token";
+                                    cbs_operation->type = NULL;
+                                    cbs_operation->message = NULL;
 
                                     list_item = singlylinkedlist_add(cbs->pending_operations, cbs_operation);
                                     if (list_item == NULL)
@@ -557,6 +721,24 @@ int cbs_put_token_async(CBS_HANDLE cbs, const char* type, const char* audience,
                                         LogError("Failed adding pending operation to list");
                                         result = __FAILURE__;
                                     }
+                                    else if ((cbs->max_outstanding_operations != 0) &&
+                                        (cbs->outstanding_operation_count >= cbs->max_outstanding_operations))
+                                    {
+                                        /* Codes_SRS_CBS_01_122: [ If the number of outstanding operations has reached the limit set by `cbs_set_max_outstanding_operations`, `cbs_put_token_async` shall queue the operation by taking ownership of the constructed message and keeping a copy of `type`, and return 0 without calling `amqp_management_execute_operation_async`. ]*/
+                                        if (queue_operation(cbs_operation, type, message) != 0)
+                                        {
+                                            /* Codes_SRS_CBS_01_124: [ If queueing the operation fails, the operation shall fail and return a non-zero value. ]*/
+                                            singlylinkedlist_remove(cbs->pending_operations, list_item);
+                                            free(cbs_operation);
+                                            LogError("Failed queueing operation");
+                                            result = __FAILURE__;
+                                        }
+                                        else
+                                        {
+                                            message = NULL;
+                                            result = 0;
+                                        }
+                                    }
                                     else
                                     {
                                         /* Codes_SRS_CBS_01_051: [ `cbs_put_token_async` shall start the AMQP management operation by calling `amqp_management_execute_operation_async`, while passing to it: ]*/
@@ -579,6 +761,8 @@ int cbs_put_token_async(CBS_HANDLE cbs, const char* type, const char* audience,
                                         }
                                         else
                                         {
+                                            cbs->outstanding_operation_count++;
+
                                             /* Codes_SRS_CBS_01_081: [ On success `cbs_put_token_async` shall return 0. ]*/
                                             result = 0;
                                         }
@@ -594,7 +778,10 @@ int cbs_put_token_async(CBS_HANDLE cbs, const char* type, const char* audience,
                 }
             }
 
-            message_destroy(message);
+            if (message != NULL)
+            {
+                message_destroy(message);
+            }
         }
     }
 
@@ -673,6 +860,10 @@ int cbs_delete_token_async(CBS_HANDLE cbs, const char* type, const char* audienc
                             cbs_operation->on_cbs_operation_complete = on_cbs_delete_token_complete;
                             cbs_operation->on_cbs_operation_complete_context = on_cbs_delete_token_complete_context;
                             cbs_operation->pending_operations = cbs->pending_operations;
+                            cbs_operation->cbs = cbs;
+                            cbs_operation->operation = "delete-token";
+                            cbs_operation->type = NULL;
+                            cbs_operation->message = NULL;
 
                             list_item = singlylinkedlist_add(cbs->pending_operations, cbs_operation);
                             if (list_item == NULL)
@@ -681,6 +872,24 @@ int cbs_delete_token_async(CBS_HANDLE cbs, const char* type, const char* audienc
                                 LogError("Failed adding pending operation to list");
                                 result = __FAILURE__;
                             }
+                            else if ((cbs->max_outstanding_operations != 0) &&
+                                (cbs->outstanding_operation_count >= cbs->max_outstanding_operations))
+                            {
+                                /* Codes_SRS_CBS_01_123: [ If the number of outstanding operations has reached the limit set by `cbs_set_max_outstanding_operations`, `cbs_delete_token_async` shall queue the operation by taking ownership of the constructed message and keeping a copy of `type`, and return 0 without calling `amqp_management_execute_operation_async`. ]*/
+                                if (queue_operation(cbs_operation, type, message) != 0)
+                                {
+                                    /* Codes_SRS_CBS_01_124: [ If queueing the operation fails, the operation shall fail and return a non-zero value. ]*/
+                                    singlylinkedlist_remove(cbs->pending_operations, list_item);
+                                    free(cbs_operation);
+                                    LogError("Failed queueing operation");
+                                    result = __FAILURE__;
+                                }
+                                else
+                                {
+                                    message = NULL;
+                                    result = 0;
+                                }
+                            }
                             else
                             {
                                 /* Codes_SRS_CBS_01_061: [ `cbs_delete_token_async` shall start the AMQP management operation by calling `amqp_management_execute_operation_async`, while passing to it: ]*/
@@ -704,6 +913,8 @@ int cbs_delete_token_async(CBS_HANDLE cbs, const char* type, const char* audienc
                                 }
                                 else
                                 {
+                                    cbs->outstanding_operation_count++;
+
                                     /* Codes_SRS_CBS_01_082: [ On success `cbs_delete_token_async` shall return 0. ]*/
                                     result = 0;
                                 }
@@ -715,7 +926,10 @@ int cbs_delete_token_async(CBS_HANDLE cbs, const char* type, const char* audienc
                 amqpvalue_destroy(application_properties);
             }
 
-            message_destroy(message);
+            if (message != NULL)
+            {
+                message_destroy(message);
+            }
         }
     }
     return result;
@@ -742,3 +956,31 @@ int cbs_set_trace(CBS_HANDLE cbs, bool trace_on)
 
     return result;
 }
+
+int cbs_set_max_outstanding_operations(CBS_HANDLE cbs, size_t max_outstanding_operations)
+{
+    int result;
+
+    if (cbs == NULL)
+    {
+        /* Codes_SRS_CBS_01_120: [ If the argument `cbs` is NULL, `cbs_set_max_outstanding_operations` shall fail and return a non-zero value. ]*/
+        LogError("NULL cbs handle");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_CBS_01_119: [ `cbs_set_max_outstanding_operations` shall set the maximum number of put-token/delete-token operations that are handed to AMQP management at the same time; 0 means no limit. ]*/
+        cbs->max_outstanding_operations = max_outstanding_operations;
+
+        /* Codes_SRS_CBS_01_121: [ If the CBS instance is OPENING or OPEN, operations queued under the previous limit shall be started up to the new limit. ]*/
+        if ((cbs->cbs_state == CBS_STATE_OPENING) ||
+            (cbs->cbs_state == CBS_STATE_OPEN))
+        {
+            start_queued_operations(cbs);
+        }
+
+        result = 0;
+    }
+
+    return result;
+}
@@ -330,11 +330,11 @@ static void link_frame_received(void* context, AMQP_VALUE performative, uint32_t
         {
             if (link_instance->role == role_sender)
             {
-                delivery_number rcv_delivery_count;
-                uint32_t rcv_link_credit;
+                FLOW_FIELDS flow_fields;
 
-                if ((flow_get_link_credit(flow_handle, &rcv_link_credit) != 0) ||
-                    (flow_get_delivery_count(flow_handle, &rcv_delivery_count) != 0))
+                if ((flow_get_fields(flow_handle, &flow_fields) != 0) ||
+                    (!flow_fields.link_credit_is_set) ||
+                    (!flow_fields.delivery_count_is_set))
                 {
                     /* error */
                     remove_all_pending_deliveries(link_instance, true);
@@ -342,7 +342,7 @@ static void link_frame_received(void* context, AMQP_VALUE performative, uint32_t
                 }
                 else
                 {
-                    link_instance->link_credit = rcv_delivery_count + rcv_link_credit - link_instance->delivery_count;
+                    link_instance->link_credit = flow_fields.delivery_count_value + flow_fields.link_credit_value - link_instance->delivery_count;
                     if (link_instance->link_credit > 0)
                     {
                         link_instance->on_link_flow_on(link_instance->callback_context);
@@ -361,6 +361,7 @@ static void link_frame_received(void* context, AMQP_VALUE performative, uint32_t
             if (amqpvalue_get_transfer(performative, &transfer_handle) == 0)
             {
                 AMQP_VALUE delivery_state;
+                TRANSFER_FIELDS transfer_fields;
                 bool more;
                 bool is_error;
 
@@ -372,12 +373,22 @@ static void link_frame_received(void* context, AMQP_VALUE performative, uint32_t
                     send_flow(link_instance);
                 }
 
-                more = false;
-                /* Attempt to get more flag, default to false */
-                (void)transfer_get_more(transfer_handle, &more);
+                /* decode all transfer fields in one pass, the more flag defaults to false */
+                if (transfer_get_fields(transfer_handle, &transfer_fields) != 0)
+                {
+                    LogError("Could not decode the transfer performative fields");
+                    transfer_fields.more_value = false;
+                    transfer_fields.delivery_id_is_set = false;
+                }
+
+                more = transfer_fields.more_value;
                 is_error = false;
 
-                if (transfer_get_delivery_id(transfer_handle, &link_instance->received_delivery_id) != 0)
+                if (transfer_fields.delivery_id_is_set)
+                {
+                    link_instance->received_delivery_id = transfer_fields.delivery_id_value;
+                }
+                else
                 {
                     /* is this not a continuation transfer? */
                     if (link_instance->received_payload_size == 0)
@@ -455,29 +466,19 @@ static void link_frame_received(void* context, AMQP_VALUE performative, uint32_t
         }
         else
         {
-            delivery_number first;
-            delivery_number last;
+            DISPOSITION_FIELDS disposition_fields;
 
-            if (disposition_get_first(disposition, &first) != 0)
+            if ((disposition_get_fields(disposition, &disposition_fields) != 0) ||
+                (!disposition_fields.first_is_set))
             {
                 /* error */
             }
             else
             {
-                bool settled;
-
-                if (disposition_get_last(disposition, &last) != 0)
-                {
-                    last = first;
-                }
-
-                if (disposition_get_settled(disposition, &settled) != 0)
-                {
-                    /* Error */
-                    settled = false;
-                }
+                delivery_number first = disposition_fields.first_value;
+                delivery_number last = disposition_fields.last_is_set ? disposition_fields.last_value : first;
 
-                if (settled)
+                if (disposition_fields.settled_value)
                 {
                     LIST_ITEM_HANDLE pending_delivery = singlylinkedlist_get_head_item(link_instance->pending_deliveries);
                     while (pending_delivery != NULL)
@@ -495,14 +496,13 @@ static void link_frame_received(void* context, AMQP_VALUE performative, uint32_t
 
                             if ((delivery_instance->delivery_id >= first) && (delivery_instance->delivery_id <= last))
                             {
-                                AMQP_VALUE delivery_state;
-                                if (disposition_get_state(disposition, &delivery_state) != 0)
+                                if (!disposition_fields.state_is_set)
                                 {
                                     /* error */
                                 }
                                 else
                                 {
-                                    delivery_instance->on_delivery_settled(delivery_instance->callback_context, delivery_instance->delivery_id, LINK_DELIVERY_SETTLE_REASON_DISPOSITION_RECEIVED, delivery_state);
+                                    delivery_instance->on_delivery_settled(delivery_instance->callback_context, delivery_instance->delivery_id, LINK_DELIVERY_SETTLE_REASON_DISPOSITION_RECEIVED, disposition_fields.state_value);
                                     async_operation_destroy(pending_delivery_operation);
                                     if (singlylinkedlist_remove(link_instance->pending_deliveries, pending_delivery) != 0)
                                     {
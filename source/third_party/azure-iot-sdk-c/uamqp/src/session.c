@@ -32,6 +32,8 @@ typedef struct SESSION_INSTANCE_TAG
     ENDPOINT_HANDLE endpoint;
     LINK_ENDPOINT_INSTANCE** link_endpoints;
     uint32_t link_endpoint_count;
+    LINK_ENDPOINT_INSTANCE** input_handle_table;
+    uint32_t input_handle_table_size;
 
     ON_LINK_ATTACHED on_link_attached;
     void* on_link_attached_callback_context;
@@ -51,6 +53,10 @@ typedef struct SESSION_INSTANCE_TAG
 #define UNDERLYING_CONNECTION_NOT_OPEN 0
 #define UNDERLYING_CONNECTION_OPEN 1
 
+/* input handles are chosen by the peer, usually as the lowest free handle, so a table indexed directly by handle stays small */
+#define INPUT_HANDLE_TABLE_MIN_SIZE 16
+#define INPUT_HANDLE_TABLE_MAX_SIZE 16384
+
 static void session_set_state(SESSION_INSTANCE* session_instance, SESSION_STATE session_state)
 {
     uint64_t i;
@@ -266,27 +272,83 @@ static LINK_ENDPOINT_INSTANCE* find_link_endpoint_by_name(SESSION_INSTANCE* sess
 
 static LINK_ENDPOINT_INSTANCE* find_link_endpoint_by_input_handle(SESSION_INSTANCE* session, handle input_handle)
 {
-    uint32_t i;
     LINK_ENDPOINT_INSTANCE* result;
 
-    for (i = 0; i < session->link_endpoint_count; i++)
+    /* Codes_SRS_SESSION_01_064: [Incoming frames carrying a handle shall be dispatched to their link endpoint by indexing a table keyed by input handle.] */
+    if ((input_handle < session->input_handle_table_size) &&
+        (session->input_handle_table[input_handle] != NULL) &&
+        (session->input_handle_table[input_handle]->input_handle == input_handle))
+    {
+        result = session->input_handle_table[input_handle];
+    }
+    else
     {
-        if (session->link_endpoints[i]->input_handle == input_handle)
+        uint32_t i;
+
+        /* Codes_SRS_SESSION_01_066: [If the handle is not in the table, the link endpoints shall be searched linearly.] */
+        for (i = 0; i < session->link_endpoint_count; i++)
         {
-            break;
+            if (session->link_endpoints[i]->input_handle == input_handle)
+            {
+                break;
+            }
+        }
+
+        if (i == session->link_endpoint_count)
+        {
+            result = NULL;
+        }
+        else
+        {
+            result = session->link_endpoints[i];
         }
     }
 
-    if (i == session->link_endpoint_count)
+    return result;
+}
+
+static void set_link_endpoint_input_handle(SESSION_INSTANCE* session, LINK_ENDPOINT_INSTANCE* link_endpoint, handle input_handle)
+{
+    if ((link_endpoint->input_handle < session->input_handle_table_size) &&
+        (session->input_handle_table[link_endpoint->input_handle] == link_endpoint))
     {
-        result = NULL;
+        session->input_handle_table[link_endpoint->input_handle] = NULL;
     }
-    else
+
+    link_endpoint->input_handle = input_handle;
+
+    if (input_handle < INPUT_HANDLE_TABLE_MAX_SIZE)
     {
-        result = session->link_endpoints[i];
-    }
+        if (input_handle >= session->input_handle_table_size)
+        {
+            uint32_t new_size = (session->input_handle_table_size == 0) ? INPUT_HANDLE_TABLE_MIN_SIZE : session->input_handle_table_size;
+            LINK_ENDPOINT_INSTANCE** new_table;
 
-    return result;
+            while (new_size <= input_handle)
+            {
+                new_size *= 2;
+            }
+
+            new_table = (LINK_ENDPOINT_INSTANCE**)realloc(session->input_handle_table, sizeof(LINK_ENDPOINT_INSTANCE*) * new_size);
+            if (new_table == NULL)
+            {
+                /* Codes_SRS_SESSION_01_067: [If growing the table fails, the endpoint shall still be found by the linear search.] */
+                LogError("Cannot grow input handle table, falling back to linear lookup");
+            }
+            else
+            {
+                (void)memset(&new_table[session->input_handle_table_size], 0, sizeof(LINK_ENDPOINT_INSTANCE*) * (new_size - session->input_handle_table_size));
+                session->input_handle_table = new_table;
+                session->input_handle_table_size = new_size;
+            }
+        }
+
+        /* Codes_SRS_SESSION_01_065: [When an ATTACH frame assigns an input handle to a link endpoint, the table entry for that handle shall be set to the endpoint.] */
+        if (input_handle < session->input_handle_table_size)
+        {
+            session->input_handle_table[input_handle] = link_endpoint;
+        }
+    }
 }
 
 static void on_connection_state_changed(void* context, CONNECTION_STATE new_connection_state, CONNECTION_STATE previous_connection_state)
@@ -374,6 +436,7 @@ static void on_frame_received(void* context, AMQP_VALUE performative, uint32_t p
             role role;
             AMQP_VALUE source;
             AMQP_VALUE target;
+            handle input_handle;
 
             if (attach_get_name(attach_handle, &name) != 0)
             {
@@ -404,12 +467,14 @@ static void on_frame_received(void* context, AMQP_VALUE performative, uint32_t p
                         {
                             end_session_with_error(session_instance, "amqp:internal-error", "Cannot create link endpoint");
                         }
-                        else if (attach_get_handle(attach_handle, &new_link_endpoint->input_handle) != 0)
+                        else if (attach_get_handle(attach_handle, &input_handle) != 0)
                         {
                             end_session_with_error(session_instance, "amqp:decode-error", "Cannot get input handle from ATTACH frame");
                         }
                         else
                         {
+                            set_link_endpoint_input_handle(session_instance, new_link_endpoint, input_handle);
+
                             if (!session_instance->on_link_attached(session_instance->on_link_attached_callback_context, new_link_endpoint, name, role, source, target))
                             {
                                 session_destroy_link_endpoint(new_link_endpoint);
@@ -427,12 +492,13 @@ static void on_frame_received(void* context, AMQP_VALUE performative, uint32_t p
                 }
                 else
                 {
-                    if (attach_get_handle(attach_handle, &link_endpoint->input_handle) != 0)
+                    if (attach_get_handle(attach_handle, &input_handle) != 0)
                     {
                         end_session_with_error(session_instance, "amqp:decode-error", "Cannot get input handle from ATTACH frame");
                     }
                     else
                     {
+                        set_link_endpoint_input_handle(session_instance, link_endpoint, input_handle);
                         link_endpoint->frame_received_callback(link_endpoint->callback_context, performative, payload_size, payload_bytes);
                     }
                 }
@@ -485,22 +551,11 @@ static void on_frame_received(void* context, AMQP_VALUE performative, uint32_t p
         }
         else
         {
-            uint32_t remote_handle;
-            transfer_number flow_next_incoming_id;
-            uint32_t flow_incoming_window;
+            FLOW_FIELDS flow_fields;
 
-            if (flow_get_next_incoming_id(flow_handle, &flow_next_incoming_id) != 0)
-            {
-                /*
-                If the next-incoming-id field of the flow frame is not set,
-                then remote-incomingwindow is computed as follows:
-                initial-outgoing-id(endpoint) + incoming-window(flow) - next-outgoing-id(endpoint)
-                */
-                flow_next_incoming_id = session_instance->next_outgoing_id;
-            }
-
-            if ((flow_get_next_outgoing_id(flow_handle, &session_instance->next_incoming_id) != 0) ||
-                (flow_get_incoming_window(flow_handle, &flow_incoming_window) != 0))
+            if ((flow_get_fields(flow_handle, &flow_fields) != 0) ||
+                (!flow_fields.next_outgoing_id_is_set) ||
+                (!flow_fields.incoming_window_is_set))
             {
                 flow_destroy(flow_handle);
 
@@ -509,13 +564,29 @@ static void on_frame_received(void* context, AMQP_VALUE performative, uint32_t p
             else
             {
                 LINK_ENDPOINT_INSTANCE* link_endpoint_instance = NULL;
+                transfer_number flow_next_incoming_id;
                 size_t i;
 
-                session_instance->remote_incoming_window = flow_next_incoming_id + flow_incoming_window - session_instance->next_outgoing_id;
+                if (flow_fields.next_incoming_id_is_set)
+                {
+                    flow_next_incoming_id = flow_fields.next_incoming_id_value;
+                }
+                else
+                {
+                    /*
+                    If the next-incoming-id field of the flow frame is not set,
+                    then remote-incomingwindow is computed as follows:
+                    initial-outgoing-id(endpoint) + incoming-window(flow) - next-outgoing-id(endpoint)
+                    */
+                    flow_next_incoming_id = session_instance->next_outgoing_id;
+                }
 
-                if (flow_get_handle(flow_handle, &remote_handle) == 0)
+                session_instance->next_incoming_id = flow_fields.next_outgoing_id_value;
+                session_instance->remote_incoming_window = flow_next_incoming_id + flow_fields.incoming_window_value - session_instance->next_outgoing_id;
+
+                if (flow_fields.handle_is_set)
                 {
-                    link_endpoint_instance = find_link_endpoint_by_input_handle(session_instance, remote_handle);
+                    link_endpoint_instance = find_link_endpoint_by_input_handle(session_instance, flow_fields.handle_value);
                 }
 
                 flow_destroy(flow_handle);
@@ -550,9 +621,7 @@ static void on_frame_received(void* context, AMQP_VALUE performative, uint32_t p
         else
         {
             uint32_t remote_handle;
-            delivery_number delivery_id;
 
-            transfer_get_delivery_id(transfer_handle, &delivery_id);
             if (transfer_get_handle(transfer_handle, &remote_handle) != 0)
             {
                 transfer_destroy(transfer_handle);
@@ -641,6 +710,8 @@ SESSION_HANDLE session_create(CONNECTION_HANDLE connection, ON_LINK_ATTACHED on_
             result->connection = connection;
             result->link_endpoints = NULL;
             result->link_endpoint_count = 0;
+            result->input_handle_table = NULL;
+            result->input_handle_table_size = 0;
             result->handle_max = 4294967295u;
 
             /* Codes_SRS_SESSION_01_057: [The delivery ids shall be assigned starting at 0.] */
@@ -693,6 +764,8 @@ SESSION_HANDLE session_create_from_endpoint(CONNECTION_HANDLE connection, ENDPOI
             result->connection = connection;
             result->link_endpoints = NULL;
             result->link_endpoint_count = 0;
+            result->input_handle_table = NULL;
+            result->input_handle_table_size = 0;
             result->handle_max = 4294967295u;
 
             result->next_outgoing_id = 0;
@@ -734,6 +807,11 @@ void session_destroy(SESSION_HANDLE session)
             free(session_instance->link_endpoints);
         }
 
+        if (session_instance->input_handle_table != NULL)
+        {
+            free(session_instance->input_handle_table);
+        }
+
         free(session);
     }
 }
@@ -1054,6 +1132,12 @@ void session_destroy_link_endpoint(LINK_ENDPOINT_HANDLE link_endpoint)
         SESSION_INSTANCE* session_instance = endpoint_instance->session;
         uint64_t i;
 
+        if ((endpoint_instance->input_handle < session_instance->input_handle_table_size) &&
+            (session_instance->input_handle_table[endpoint_instance->input_handle] == endpoint_instance))
+        {
+            session_instance->input_handle_table[endpoint_instance->input_handle] = NULL;
+        }
+
         /* Codes_SRS_SESSION_01_049: [session_destroy_link_endpoint shall free all resources associated with the endpoint.] */
         for (i = 0; i < session_instance->link_endpoint_count; i++)
         {
@@ -4299,6 +4299,150 @@ TEST_FUNCTION(amqpvalue_get_map_value_for_a_non_map_value_fails)
     amqpvalue_destroy(key);
 }
 
+/* Tests_SRS_AMQPVALUE_01_404: [For maps with 8 or more key/value pairs amqpvalue_get_map_value shall look up the key through a hashed index of the map keys, built on the first lookup.] */
+TEST_FUNCTION(amqpvalue_get_map_value_on_a_large_map_builds_the_index_and_finds_all_keys)
+{
+    // arrange
+    AMQP_VALUE map = amqpvalue_create_map();
+    AMQP_VALUE missing_key = amqpvalue_create_string("missing");
+    AMQP_VALUE result;
+    char key_string[16];
+    uint32_t i;
+
+    for (i = 0; i < 8; i++)
+    {
+        AMQP_VALUE key;
+        AMQP_VALUE value = amqpvalue_create_uint(i);
+        (void)sprintf(key_string, "key%u", (unsigned int)i);
+        key = amqpvalue_create_string(key_string);
+        (void)amqpvalue_set_map_value(map, key, value);
+        amqpvalue_destroy(key);
+        amqpvalue_destroy(value);
+    }
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+
+    // act
+    result = amqpvalue_get_map_value(map, missing_key);
+
+    // assert
+    ASSERT_IS_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    for (i = 8; i < 40; i++)
+    {
+        AMQP_VALUE key;
+        AMQP_VALUE value = amqpvalue_create_uint(i);
+        (void)sprintf(key_string, "key%u", (unsigned int)i);
+        key = amqpvalue_create_string(key_string);
+        (void)amqpvalue_set_map_value(map, key, value);
+        amqpvalue_destroy(key);
+        amqpvalue_destroy(value);
+    }
+    for (i = 0; i < 40; i++)
+    {
+        uint32_t uint_value;
+        AMQP_VALUE key;
+        (void)sprintf(key_string, "key%u", (unsigned int)i);
+        key = amqpvalue_create_string(key_string);
+        result = amqpvalue_get_map_value(map, key);
+        ASSERT_IS_NOT_NULL(result);
+        (void)amqpvalue_get_uint(result, &uint_value);
+        ASSERT_ARE_EQUAL(uint32_t, i, uint_value);
+        amqpvalue_destroy(result);
+        amqpvalue_destroy(key);
+    }
+
+    // cleanup
+    amqpvalue_destroy(map);
+    amqpvalue_destroy(missing_key);
+}
+
+/* Tests_SRS_AMQPVALUE_01_404: [For maps with 8 or more key/value pairs amqpvalue_get_map_value shall look up the key through a hashed index of the map keys, built on the first lookup.] */
+/* Tests_SRS_AMQPVALUE_01_184: [If the key already exists in the map, its value shall be replaced with the value provided by the value argument.] */
+TEST_FUNCTION(amqpvalue_set_map_value_on_an_indexed_map_replaces_and_appends_values)
+{
+    // arrange
+    AMQP_VALUE map = amqpvalue_create_map();
+    AMQP_VALUE new_value = amqpvalue_create_uint(1000);
+    AMQP_VALUE result;
+    uint32_t pair_count;
+    uint32_t uint_value;
+    uint32_t i;
+
+    for (i = 0; i < 8; i++)
+    {
+        AMQP_VALUE key = amqpvalue_create_ulong(i);
+        (void)amqpvalue_set_map_value(map, key, key);
+        amqpvalue_destroy(key);
+    }
+    result = amqpvalue_get_map_value(map, new_value);
+    umock_c_reset_all_calls();
+
+    // act
+    for (i = 0; i < 64; i++)
+    {
+        AMQP_VALUE key = amqpvalue_create_ulong(i);
+        (void)amqpvalue_set_map_value(map, key, new_value);
+        amqpvalue_destroy(key);
+    }
+
+    // assert
+    ASSERT_IS_NULL(result);
+    (void)amqpvalue_get_map_pair_count(map, &pair_count);
+    ASSERT_ARE_EQUAL(uint32_t, 64, pair_count);
+    for (i = 0; i < 64; i++)
+    {
+        AMQP_VALUE key = amqpvalue_create_ulong(i);
+        result = amqpvalue_get_map_value(map, key);
+        ASSERT_IS_NOT_NULL(result);
+        (void)amqpvalue_get_uint(result, &uint_value);
+        ASSERT_ARE_EQUAL(uint32_t, 1000, uint_value);
+        amqpvalue_destroy(result);
+        amqpvalue_destroy(key);
+    }
+
+    // cleanup
+    amqpvalue_destroy(map);
+    amqpvalue_destroy(new_value);
+}
+
+/* Tests_SRS_AMQPVALUE_01_405: [If allocating the hashed index fails, amqpvalue_get_map_value shall look up the key by comparing it with each key in the map.] */
+TEST_FUNCTION(when_allocating_the_index_fails_amqpvalue_get_map_value_still_finds_the_key)
+{
+    // arrange
+    AMQP_VALUE map = amqpvalue_create_map();
+    AMQP_VALUE key = amqpvalue_create_uint(5);
+    AMQP_VALUE result;
+    uint32_t uint_value;
+    uint32_t i;
+
+    for (i = 0; i < 8; i++)
+    {
+        AMQP_VALUE value = amqpvalue_create_uint(i);
+        (void)amqpvalue_set_map_value(map, value, value);
+        amqpvalue_destroy(value);
+    }
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+
+    // act
+    result = amqpvalue_get_map_value(map, key);
+
+    // assert
+    ASSERT_IS_NOT_NULL(result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    (void)amqpvalue_get_uint(result, &uint_value);
+    ASSERT_ARE_EQUAL(uint32_t, 5, uint_value);
+
+    // cleanup
+    amqpvalue_destroy(map);
+    amqpvalue_destroy(key);
+    amqpvalue_destroy(result);
+}
+
 /* amqpvalue_get_map_pair_count */
 
 /* Tests_SRS_AMQPVALUE_01_193: [amqpvalue_get_map_pair_count shall fill in the number of key/value pairs in the map in the pair_count argument.] */
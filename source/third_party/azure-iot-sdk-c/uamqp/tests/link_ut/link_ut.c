@@ -0,0 +1,643 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#else
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#endif
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_bool.h"
+#include "umocktypes_stdint.h"
+
+static void* my_gballoc_malloc(size_t size)
+{
+    return malloc(size);
+}
+
+static void* my_gballoc_realloc(void* ptr, size_t size)
+{
+    return realloc(ptr, size);
+}
+
+static void my_gballoc_free(void* ptr)
+{
+    free(ptr);
+}
+
+#define ENABLE_MOCKS
+
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/singlylinkedlist.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_uamqp_c/session.h"
+#include "azure_uamqp_c/amqpvalue.h"
+#include "azure_uamqp_c/amqp_definitions.h"
+#include "azure_uamqp_c/amqp_frame_codec.h"
+#include "azure_uamqp_c/async_operation.h"
+
+#undef ENABLE_MOCKS
+
+#include "azure_uamqp_c/link.h"
+
+#define TEST_SESSION_HANDLE             (SESSION_HANDLE)0x4242
+#define TEST_LINK_ENDPOINT              (LINK_ENDPOINT_HANDLE)0x4243
+#define TEST_TICK_COUNTER               (TICK_COUNTER_HANDLE)0x4244
+#define TEST_LIST_HANDLE                (SINGLYLINKEDLIST_HANDLE)0x4245
+#define TEST_TRANSFER_AMQP_VALUE        (AMQP_VALUE)0x4246
+#define TEST_DELIVERY_STATE             (AMQP_VALUE)0x4247
+#define TEST_CONTEXT                    (void*)0x4444
+#define TEST_ATTACH_PERFORMATIVE        (AMQP_VALUE)0x5000
+#define TEST_FLOW_PERFORMATIVE          (AMQP_VALUE)0x5001
+#define TEST_TRANSFER_PERFORMATIVE      (AMQP_VALUE)0x5002
+#define TEST_DISPOSITION_PERFORMATIVE   (AMQP_VALUE)0x5003
+
+static ATTACH_HANDLE test_attach_handle = (ATTACH_HANDLE)0x6001;
+static FLOW_HANDLE test_flow_handle = (FLOW_HANDLE)0x6002;
+static TRANSFER_HANDLE test_transfer_handle = (TRANSFER_HANDLE)0x6003;
+static DISPOSITION_HANDLE test_disposition_handle = (DISPOSITION_HANDLE)0x6004;
+static const unsigned char test_payload[] = { 0x42, 0x43 };
+
+static ON_ENDPOINT_FRAME_RECEIVED saved_frame_received_callback;
+static ON_SESSION_STATE_CHANGED saved_on_session_state_changed;
+static void* saved_callback_context;
+static delivery_number test_delivery_id;
+
+MOCK_FUNCTION_WITH_CODE(, AMQP_VALUE, test_on_transfer_received, void*, context, TRANSFER_HANDLE, transfer, uint32_t, payload_size, const unsigned char*, payload_bytes)
+MOCK_FUNCTION_END(NULL);
+MOCK_FUNCTION_WITH_CODE(, void, test_on_link_state_changed, void*, context, LINK_STATE, new_link_state, LINK_STATE, previous_link_state)
+MOCK_FUNCTION_END();
+MOCK_FUNCTION_WITH_CODE(, void, test_on_link_flow_on, void*, context)
+MOCK_FUNCTION_END();
+MOCK_FUNCTION_WITH_CODE(, void, test_on_delivery_settled, void*, context, delivery_number, delivery_no, LINK_DELIVERY_SETTLE_REASON, reason, AMQP_VALUE, delivery_state)
+MOCK_FUNCTION_END();
+
+static AMQP_VALUE my_amqpvalue_get_inplace_descriptor(AMQP_VALUE value)
+{
+    /*every test performative is its own descriptor*/
+    return value;
+}
+
+static bool my_is_attach_type_by_descriptor(AMQP_VALUE descriptor)
+{
+    return descriptor == TEST_ATTACH_PERFORMATIVE;
+}
+
+static bool my_is_flow_type_by_descriptor(AMQP_VALUE descriptor)
+{
+    return descriptor == TEST_FLOW_PERFORMATIVE;
+}
+
+static bool my_is_transfer_type_by_descriptor(AMQP_VALUE descriptor)
+{
+    return descriptor == TEST_TRANSFER_PERFORMATIVE;
+}
+
+static bool my_is_disposition_type_by_descriptor(AMQP_VALUE descriptor)
+{
+    return descriptor == TEST_DISPOSITION_PERFORMATIVE;
+}
+
+static int my_amqpvalue_get_attach(AMQP_VALUE value, ATTACH_HANDLE* attach_handle)
+{
+    (void)value;
+    *attach_handle = test_attach_handle;
+    return 0;
+}
+
+static int my_amqpvalue_get_flow(AMQP_VALUE value, FLOW_HANDLE* flow_handle)
+{
+    (void)value;
+    *flow_handle = test_flow_handle;
+    return 0;
+}
+
+static int my_amqpvalue_get_transfer(AMQP_VALUE value, TRANSFER_HANDLE* transfer_handle)
+{
+    (void)value;
+    *transfer_handle = test_transfer_handle;
+    return 0;
+}
+
+static int my_amqpvalue_get_disposition(AMQP_VALUE value, DISPOSITION_HANDLE* disposition_handle)
+{
+    (void)value;
+    *disposition_handle = test_disposition_handle;
+    return 0;
+}
+
+static int my_session_start_link_endpoint(LINK_ENDPOINT_HANDLE link_endpoint, ON_ENDPOINT_FRAME_RECEIVED frame_received_callback, ON_SESSION_STATE_CHANGED on_session_state_changed, ON_SESSION_FLOW_ON on_session_flow_on, void* context)
+{
+    (void)link_endpoint;
+    (void)on_session_flow_on;
+    saved_frame_received_callback = frame_received_callback;
+    saved_on_session_state_changed = on_session_state_changed;
+    saved_callback_context = context;
+    return 0;
+}
+
+static SESSION_SEND_TRANSFER_RESULT my_session_send_transfer(LINK_ENDPOINT_HANDLE link_endpoint, TRANSFER_HANDLE transfer, PAYLOAD* payloads, size_t payload_count, delivery_number* delivery_id, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    (void)link_endpoint;
+    (void)transfer;
+    (void)payloads;
+    (void)payload_count;
+    (void)on_send_complete;
+    (void)callback_context;
+    *delivery_id = test_delivery_id;
+    return SESSION_SEND_TRANSFER_OK;
+}
+
+static ASYNC_OPERATION_HANDLE my_async_operation_create(ASYNC_OPERATION_CANCEL_HANDLER_FUNC async_operation_cancel_handler, size_t context_size)
+{
+    (void)async_operation_cancel_handler;
+    return (ASYNC_OPERATION_HANDLE)my_gballoc_malloc(context_size);
+}
+
+static void my_async_operation_destroy(ASYNC_OPERATION_HANDLE async_operation)
+{
+    my_gballoc_free(async_operation);
+}
+
+static const void** list_items = NULL;
+static size_t list_item_count = 0;
+
+static LIST_ITEM_HANDLE my_singlylinkedlist_add(SINGLYLINKEDLIST_HANDLE list, const void* item)
+{
+    const void** items = (const void**)my_gballoc_realloc((void*)list_items, (list_item_count + 1) * sizeof(item));
+    (void)list;
+    if (items != NULL)
+    {
+        list_items = items;
+        list_items[list_item_count++] = item;
+    }
+    return (LIST_ITEM_HANDLE)list_item_count;
+}
+
+static int my_singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item)
+{
+    size_t index = (size_t)item - 1;
+    (void)list;
+    (void)memmove((void*)&list_items[index], &list_items[index + 1], sizeof(const void*) * (list_item_count - index - 1));
+    list_item_count--;
+    if (list_item_count == 0)
+    {
+        my_gballoc_free((void*)list_items);
+        list_items = NULL;
+    }
+    return 0;
+}
+
+static LIST_ITEM_HANDLE my_singlylinkedlist_get_head_item(SINGLYLINKEDLIST_HANDLE list)
+{
+    (void)list;
+    return (list_item_count > 0) ? (LIST_ITEM_HANDLE)1 : NULL;
+}
+
+static LIST_ITEM_HANDLE my_singlylinkedlist_get_next_item(LIST_ITEM_HANDLE item_handle)
+{
+    return ((size_t)item_handle < list_item_count) ? (LIST_ITEM_HANDLE)((size_t)item_handle + 1) : NULL;
+}
+
+static const void* my_singlylinkedlist_item_get_value(LIST_ITEM_HANDLE item_handle)
+{
+    return (const void*)list_items[(size_t)item_handle - 1];
+}
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+static int umocktypes_copy_amqp_binary(amqp_binary* destination, const amqp_binary* source)
+{
+    int result;
+
+    if (source->length > 0)
+    {
+        destination->bytes = (unsigned char*)my_gballoc_malloc(source->length);
+        if (destination->bytes == NULL)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            if (source->length > 0)
+            {
+                (void)memcpy((void*)destination->bytes, source->bytes, source->length);
+            }
+
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        destination->length = source->length;
+    }
+
+    return result;
+}
+
+static void umocktypes_free_amqp_binary(amqp_binary* value)
+{
+    if (value->bytes != NULL)
+    {
+        my_gballoc_free((void*)value->bytes);
+    }
+}
+
+static char* umocktypes_stringify_amqp_binary(const amqp_binary* value)
+{
+    char* result;
+
+    result = (char*)my_gballoc_malloc(3 + (5 * value->length));
+    if (result != NULL)
+    {
+        size_t pos = 0;
+        size_t i;
+
+        result[pos++] = '[';
+        for (i = 0; i < value->length; i++)
+        {
+            (void)sprintf(&result[pos], "0x%02X ", ((const unsigned char*)value->bytes)[i]);
+            pos += 5;
+        }
+        result[pos++] = ']';
+        result[pos++] = '\0';
+    }
+
+    return result;
+}
+
+static int umocktypes_are_equal_amqp_binary(amqp_binary* left, amqp_binary* right)
+{
+    int result;
+
+    if (left->length != right->length)
+    {
+        result = 0;
+    }
+    else
+    {
+        if (left->length == 0)
+        {
+            result = 1;
+        }
+        else
+        {
+            result = (memcmp(left->bytes, right->bytes, left->length) == 0) ? 1 : 0;
+        }
+    }
+
+    return result;
+}
+
+/* creates a link and takes it through the ATTACH exchange so that frames reach link_frame_received */
+static LINK_HANDLE create_attached_link(role link_role)
+{
+    LINK_HANDLE link = link_create(TEST_SESSION_HANDLE, "test_link", link_role, NULL, NULL);
+    (void)link_attach(link, test_on_transfer_received, test_on_link_state_changed, test_on_link_flow_on, TEST_CONTEXT);
+    saved_on_session_state_changed(saved_callback_context, SESSION_STATE_MAPPED, SESSION_STATE_BEGIN_SENT);
+    saved_frame_received_callback(saved_callback_context, TEST_ATTACH_PERFORMATIVE, 0, NULL);
+    umock_c_reset_all_calls();
+    return link;
+}
+
+static void give_link_credit(uint32_t link_credit)
+{
+    FLOW_FIELDS flow_fields;
+    (void)memset(&flow_fields, 0, sizeof(flow_fields));
+    flow_fields.link_credit_value = link_credit;
+    flow_fields.link_credit_is_set = true;
+    flow_fields.delivery_count_is_set = true;
+    STRICT_EXPECTED_CALL(flow_get_fields(test_flow_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &flow_fields, sizeof(flow_fields));
+    saved_frame_received_callback(saved_callback_context, TEST_FLOW_PERFORMATIVE, 0, NULL);
+    umock_c_reset_all_calls();
+}
+
+BEGIN_TEST_SUITE(link_ut)
+
+TEST_SUITE_INITIALIZE(suite_init)
+{
+    int result;
+
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+    result = umocktypes_charptr_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_create, TEST_TICK_COUNTER);
+    REGISTER_GLOBAL_MOCK_RETURN(tickcounter_get_current_ms, 0);
+    REGISTER_GLOBAL_MOCK_RETURN(singlylinkedlist_create, TEST_LIST_HANDLE);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_add, my_singlylinkedlist_add);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_remove, my_singlylinkedlist_remove);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_head_item, my_singlylinkedlist_get_head_item);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_next_item, my_singlylinkedlist_get_next_item);
+    REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_item_get_value, my_singlylinkedlist_item_get_value);
+    REGISTER_GLOBAL_MOCK_HOOK(async_operation_create, my_async_operation_create);
+    REGISTER_GLOBAL_MOCK_HOOK(async_operation_destroy, my_async_operation_destroy);
+    REGISTER_GLOBAL_MOCK_RETURN(session_create_link_endpoint, TEST_LINK_ENDPOINT);
+    REGISTER_GLOBAL_MOCK_RETURN(session_begin, 0);
+    REGISTER_GLOBAL_MOCK_RETURN(session_send_attach, 0);
+    REGISTER_GLOBAL_MOCK_HOOK(session_start_link_endpoint, my_session_start_link_endpoint);
+    REGISTER_GLOBAL_MOCK_HOOK(session_send_transfer, my_session_send_transfer);
+    REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_get_inplace_descriptor, my_amqpvalue_get_inplace_descriptor);
+    REGISTER_GLOBAL_MOCK_HOOK(is_attach_type_by_descriptor, my_is_attach_type_by_descriptor);
+    REGISTER_GLOBAL_MOCK_HOOK(is_flow_type_by_descriptor, my_is_flow_type_by_descriptor);
+    REGISTER_GLOBAL_MOCK_HOOK(is_transfer_type_by_descriptor, my_is_transfer_type_by_descriptor);
+    REGISTER_GLOBAL_MOCK_HOOK(is_disposition_type_by_descriptor, my_is_disposition_type_by_descriptor);
+    REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_get_attach, my_amqpvalue_get_attach);
+    REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_get_flow, my_amqpvalue_get_flow);
+    REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_get_transfer, my_amqpvalue_get_transfer);
+    REGISTER_GLOBAL_MOCK_HOOK(amqpvalue_get_disposition, my_amqpvalue_get_disposition);
+    REGISTER_GLOBAL_MOCK_RETURN(attach_create, test_attach_handle);
+    REGISTER_GLOBAL_MOCK_RETURN(transfer_create, test_transfer_handle);
+    REGISTER_GLOBAL_MOCK_RETURN(amqpvalue_create_transfer, TEST_TRANSFER_AMQP_VALUE);
+
+    REGISTER_TYPE(amqp_binary, amqp_binary);
+
+    REGISTER_UMOCK_ALIAS_TYPE(delivery_tag, amqp_binary);
+    REGISTER_UMOCK_ALIAS_TYPE(SESSION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LINK_ENDPOINT_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TICK_COUNTER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SINGLYLINKEDLIST_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LIST_ITEM_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ASYNC_OPERATION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ASYNC_OPERATION_CANCEL_HANDLER_FUNC, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(AMQP_VALUE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ATTACH_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(FLOW_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(TRANSFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(DISPOSITION_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(DETACH_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ERROR_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(fields, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_ENDPOINT_FRAME_RECEIVED, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_SESSION_STATE_CHANGED, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_SESSION_FLOW_ON, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_SEND_COMPLETE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(PAYLOAD*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(const unsigned char*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(role, bool);
+    REGISTER_UMOCK_ALIAS_TYPE(handle, uint32_t);
+    REGISTER_UMOCK_ALIAS_TYPE(sequence_no, uint32_t);
+    REGISTER_UMOCK_ALIAS_TYPE(transfer_number, uint32_t);
+    REGISTER_UMOCK_ALIAS_TYPE(delivery_number, uint32_t);
+    REGISTER_UMOCK_ALIAS_TYPE(message_format, uint32_t);
+    REGISTER_UMOCK_ALIAS_TYPE(sender_settle_mode, uint8_t);
+    REGISTER_UMOCK_ALIAS_TYPE(receiver_settle_mode, uint8_t);
+    REGISTER_UMOCK_ALIAS_TYPE(LINK_STATE, int);
+    REGISTER_UMOCK_ALIAS_TYPE(SESSION_STATE, int);
+    REGISTER_UMOCK_ALIAS_TYPE(LINK_DELIVERY_SETTLE_REASON, int);
+}
+
+TEST_SUITE_CLEANUP(suite_cleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(method_init)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    test_delivery_id = 0;
+    umock_c_reset_all_calls();
+}
+
+TEST_FUNCTION_CLEANUP(method_cleanup)
+{
+    /* link_destroy drops the whole pending delivery list without removing the items one by one */
+    my_gballoc_free((void*)list_items);
+    list_items = NULL;
+    list_item_count = 0;
+
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+/* link_frame_received */
+
+TEST_FUNCTION(a_FLOW_frame_decoded_with_flow_get_fields_gives_the_sender_credit)
+{
+    // arrange
+    LINK_HANDLE link = create_attached_link(role_sender);
+    FLOW_FIELDS flow_fields;
+    (void)memset(&flow_fields, 0, sizeof(flow_fields));
+    flow_fields.link_credit_value = 5;
+    flow_fields.link_credit_is_set = true;
+    flow_fields.delivery_count_value = 0;
+    flow_fields.delivery_count_is_set = true;
+
+    STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_FLOW_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_attach_type_by_descriptor(TEST_FLOW_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_flow_type_by_descriptor(TEST_FLOW_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(amqpvalue_get_flow(TEST_FLOW_PERFORMATIVE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(flow_get_fields(test_flow_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &flow_fields, sizeof(flow_fields));
+    STRICT_EXPECTED_CALL(test_on_link_flow_on(TEST_CONTEXT));
+    STRICT_EXPECTED_CALL(flow_destroy(test_flow_handle));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_FLOW_PERFORMATIVE, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    link_destroy(link);
+}
+
+TEST_FUNCTION(when_flow_get_fields_fails_the_sender_link_is_detached)
+{
+    // arrange
+    LINK_HANDLE link = create_attached_link(role_sender);
+
+    STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_FLOW_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_attach_type_by_descriptor(TEST_FLOW_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_flow_type_by_descriptor(TEST_FLOW_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(amqpvalue_get_flow(TEST_FLOW_PERFORMATIVE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(flow_get_fields(test_flow_handle, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_LIST_HANDLE));
+    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_LIST_HANDLE));
+    STRICT_EXPECTED_CALL(test_on_link_state_changed(TEST_CONTEXT, LINK_STATE_DETACHED, LINK_STATE_ATTACHED));
+    STRICT_EXPECTED_CALL(flow_destroy(test_flow_handle));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_FLOW_PERFORMATIVE, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    link_destroy(link);
+}
+
+TEST_FUNCTION(a_TRANSFER_frame_decoded_with_transfer_get_fields_is_indicated_with_its_delivery_id)
+{
+    // arrange
+    LINK_HANDLE link = create_attached_link(role_receiver);
+    TRANSFER_FIELDS transfer_fields;
+    delivery_number message_id;
+    (void)memset(&transfer_fields, 0, sizeof(transfer_fields));
+    transfer_fields.delivery_id_value = 42;
+    transfer_fields.delivery_id_is_set = true;
+
+    STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_TRANSFER_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_attach_type_by_descriptor(TEST_TRANSFER_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_flow_type_by_descriptor(TEST_TRANSFER_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_transfer_type_by_descriptor(TEST_TRANSFER_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(amqpvalue_get_transfer(TEST_TRANSFER_PERFORMATIVE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(transfer_get_fields(test_transfer_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &transfer_fields, sizeof(transfer_fields));
+    STRICT_EXPECTED_CALL(test_on_transfer_received(TEST_CONTEXT, test_transfer_handle, sizeof(test_payload), test_payload));
+    STRICT_EXPECTED_CALL(transfer_destroy(test_transfer_handle));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_TRANSFER_PERFORMATIVE, sizeof(test_payload), test_payload);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, link_get_received_message_id(link, &message_id));
+    ASSERT_ARE_EQUAL(uint32_t, 42, message_id);
+
+    // cleanup
+    link_destroy(link);
+}
+
+TEST_FUNCTION(when_transfer_get_fields_fails_on_a_first_TRANSFER_frame_it_is_not_indicated)
+{
+    // arrange
+    LINK_HANDLE link = create_attached_link(role_receiver);
+
+    STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_TRANSFER_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_attach_type_by_descriptor(TEST_TRANSFER_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_flow_type_by_descriptor(TEST_TRANSFER_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_transfer_type_by_descriptor(TEST_TRANSFER_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(amqpvalue_get_transfer(TEST_TRANSFER_PERFORMATIVE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(transfer_get_fields(test_transfer_handle, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(transfer_destroy(test_transfer_handle));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_TRANSFER_PERFORMATIVE, sizeof(test_payload), test_payload);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    link_destroy(link);
+}
+
+TEST_FUNCTION(a_DISPOSITION_frame_decoded_with_disposition_get_fields_settles_the_pending_delivery)
+{
+    // arrange
+    LINK_HANDLE link = create_attached_link(role_sender);
+    LINK_TRANSFER_RESULT link_transfer_result;
+    DISPOSITION_FIELDS disposition_fields;
+    give_link_credit(1);
+    test_delivery_id = 7;
+    (void)link_transfer_async(link, 0, NULL, 0, test_on_delivery_settled, TEST_CONTEXT, &link_transfer_result, 0);
+    umock_c_reset_all_calls();
+
+    (void)memset(&disposition_fields, 0, sizeof(disposition_fields));
+    disposition_fields.first_value = 7;
+    disposition_fields.first_is_set = true;
+    disposition_fields.settled_value = true;
+    disposition_fields.settled_is_set = true;
+    disposition_fields.state_value = TEST_DELIVERY_STATE;
+    disposition_fields.state_is_set = true;
+
+    STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_attach_type_by_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_flow_type_by_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_transfer_type_by_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_disposition_type_by_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(amqpvalue_get_disposition(TEST_DISPOSITION_PERFORMATIVE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(disposition_get_fields(test_disposition_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &disposition_fields, sizeof(disposition_fields));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_LIST_HANDLE));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(test_on_delivery_settled(TEST_CONTEXT, 7, LINK_DELIVERY_SETTLE_REASON_DISPOSITION_RECEIVED, TEST_DELIVERY_STATE));
+    STRICT_EXPECTED_CALL(async_operation_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_LIST_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(disposition_destroy(test_disposition_handle));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_DISPOSITION_PERFORMATIVE, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    link_destroy(link);
+}
+
+TEST_FUNCTION(when_disposition_get_fields_fails_the_pending_delivery_is_not_settled)
+{
+    // arrange
+    LINK_HANDLE link = create_attached_link(role_sender);
+    LINK_TRANSFER_RESULT link_transfer_result;
+    give_link_credit(1);
+    test_delivery_id = 7;
+    (void)link_transfer_async(link, 0, NULL, 0, test_on_delivery_settled, TEST_CONTEXT, &link_transfer_result, 0);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_attach_type_by_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_flow_type_by_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_transfer_type_by_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_disposition_type_by_descriptor(TEST_DISPOSITION_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(amqpvalue_get_disposition(TEST_DISPOSITION_PERFORMATIVE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(disposition_get_fields(test_disposition_handle, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(disposition_destroy(test_disposition_handle));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_DISPOSITION_PERFORMATIVE, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    STRICT_EXPECTED_CALL(test_on_delivery_settled(TEST_CONTEXT, 7, LINK_DELIVERY_SETTLE_REASON_NOT_DELIVERED, NULL));
+    link_destroy(link);
+}
+
+END_TEST_SUITE(link_ut)
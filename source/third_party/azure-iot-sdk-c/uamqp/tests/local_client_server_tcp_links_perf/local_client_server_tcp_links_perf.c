@@ -0,0 +1,547 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+/* Multiplexes many sender links (one per simulated device) over a single connection and session
+   against an in-process AMQP listener, reporting per-link memory and per-frame dispatch cost. */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/platform.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/socketio.h"
+#include "azure_uamqp_c/uamqp.h"
+
+#define DEFAULT_LINK_COUNT 500
+#define TEST_PORT 5673
+#define ATTACH_TIMEOUT 30000 // ms
+#define TEST_RUNTIME 5000 // ms
+
+typedef struct SERVER_TAG
+{
+    CONNECTION_HANDLE connection;
+    SESSION_HANDLE session;
+    XIO_HANDLE io;
+    LINK_HANDLE* links;
+    MESSAGE_RECEIVER_HANDLE* message_receivers;
+    size_t attached_link_count;
+    size_t max_link_count;
+} SERVER;
+
+typedef struct CLIENT_LINK_TAG
+{
+    LINK_HANDLE link;
+    MESSAGE_SENDER_HANDLE message_sender;
+    bool is_open;
+    bool is_message_outstanding;
+} CLIENT_LINK;
+
+static SERVER server;
+static size_t total_messages_received;
+static size_t open_sender_count;
+
+static size_t get_memory_used(void)
+{
+    return gballoc_getCurrentMemoryUsed();
+}
+
+static void print_memory_per_link(const char* label, size_t before, size_t after, size_t link_count)
+{
+    if ((before == SIZE_MAX) || (after == SIZE_MAX))
+    {
+        (void)printf("%s: n/a (configure with -Dmemory_trace=ON to measure memory)\r\n", label);
+    }
+    else
+    {
+        (void)printf("%s: %lu bytes total, %lu bytes per link\r\n", label,
+            (unsigned long)(after - before), (unsigned long)((after - before) / link_count));
+    }
+}
+
+static AMQP_VALUE on_message_received(const void* context, MESSAGE_HANDLE message)
+{
+    (void)context;
+    (void)message;
+
+    total_messages_received++;
+
+    return messaging_delivery_accepted();
+}
+
+static bool on_new_link_attached(void* context, LINK_ENDPOINT_HANDLE new_link_endpoint, const char* name, role role, AMQP_VALUE source, AMQP_VALUE target)
+{
+    SERVER* server_instance = (SERVER*)context;
+    bool result;
+
+    if (server_instance->attached_link_count == server_instance->max_link_count)
+    {
+        LogError("Too many links");
+        result = false;
+    }
+    else
+    {
+        LINK_HANDLE link = link_create_from_endpoint(server_instance->session, new_link_endpoint, name, role, source, target);
+        if (link == NULL)
+        {
+            LogError("Cannot create link");
+            result = false;
+        }
+        else
+        {
+            MESSAGE_RECEIVER_HANDLE message_receiver;
+
+            if ((link_set_rcv_settle_mode(link, receiver_settle_mode_first) != 0) ||
+                ((message_receiver = messagereceiver_create(link, NULL, NULL)) == NULL))
+            {
+                link_destroy(link);
+                LogError("Cannot create message receiver");
+                result = false;
+            }
+            else if (messagereceiver_open(message_receiver, on_message_received, NULL) != 0)
+            {
+                messagereceiver_destroy(message_receiver);
+                link_destroy(link);
+                LogError("Cannot open message receiver");
+                result = false;
+            }
+            else
+            {
+                server_instance->links[server_instance->attached_link_count] = link;
+                server_instance->message_receivers[server_instance->attached_link_count] = message_receiver;
+                server_instance->attached_link_count++;
+                result = true;
+            }
+        }
+    }
+
+    return result;
+}
+
+static bool on_new_session_endpoint(void* context, ENDPOINT_HANDLE new_endpoint)
+{
+    SERVER* server_instance = (SERVER*)context;
+    bool result;
+
+    server_instance->session = session_create_from_endpoint(server_instance->connection, new_endpoint, on_new_link_attached, server_instance);
+    if (server_instance->session == NULL)
+    {
+        LogError("Cannot create session");
+        result = false;
+    }
+    else if ((session_set_incoming_window(server_instance->session, 10000) != 0) ||
+        (session_begin(server_instance->session) != 0))
+    {
+        session_destroy(server_instance->session);
+        server_instance->session = NULL;
+        LogError("Cannot begin session");
+        result = false;
+    }
+    else
+    {
+        result = true;
+    }
+
+    return result;
+}
+
+static void on_socket_accepted(void* context, const IO_INTERFACE_DESCRIPTION* interface_description, void* io_parameters)
+{
+    SERVER* server_instance = (SERVER*)context;
+    HEADER_DETECT_IO_CONFIG header_detect_io_config;
+    HEADER_DETECT_ENTRY header_detect_entries[1] = { { header_detect_io_get_amqp_header(), NULL } };
+    XIO_HANDLE underlying_io;
+
+    if (server_instance->connection != NULL)
+    {
+        LogError("Only one connection is accepted");
+    }
+    else if ((underlying_io = xio_create(interface_description, io_parameters)) == NULL)
+    {
+        LogError("Cannot create accepted socket IO");
+    }
+    else
+    {
+        header_detect_io_config.underlying_io = underlying_io;
+        header_detect_io_config.header_detect_entry_count = 1;
+        header_detect_io_config.header_detect_entries = header_detect_entries;
+
+        server_instance->io = xio_create(header_detect_io_get_interface_description(), &header_detect_io_config);
+        if (server_instance->io == NULL)
+        {
+            xio_destroy(underlying_io);
+            LogError("Cannot create header detect IO");
+        }
+        else
+        {
+            server_instance->connection = connection_create(server_instance->io, NULL, "1", on_new_session_endpoint, server_instance);
+            if (server_instance->connection == NULL)
+            {
+                xio_destroy(server_instance->io);
+                server_instance->io = NULL;
+                LogError("Cannot create server connection");
+            }
+            else if (connection_listen(server_instance->connection) != 0)
+            {
+                connection_destroy(server_instance->connection);
+                server_instance->connection = NULL;
+                xio_destroy(server_instance->io);
+                server_instance->io = NULL;
+                LogError("Cannot listen on server connection");
+            }
+        }
+    }
+}
+
+static void on_message_sender_state_changed(void* context, MESSAGE_SENDER_STATE new_state, MESSAGE_SENDER_STATE previous_state)
+{
+    CLIENT_LINK* client_link = (CLIENT_LINK*)context;
+    (void)previous_state;
+
+    if ((new_state == MESSAGE_SENDER_STATE_OPEN) && !client_link->is_open)
+    {
+        client_link->is_open = true;
+        open_sender_count++;
+    }
+}
+
+static void on_message_send_complete(void* context, MESSAGE_SEND_RESULT send_result)
+{
+    CLIENT_LINK* client_link = (CLIENT_LINK*)context;
+    (void)send_result;
+
+    client_link->is_message_outstanding = false;
+}
+
+static void run_dowork(SOCKET_LISTENER_HANDLE socket_listener, CONNECTION_HANDLE client_connection)
+{
+    socketlistener_dowork(socket_listener);
+    connection_dowork(client_connection);
+    if (server.connection != NULL)
+    {
+        connection_dowork(server.connection);
+    }
+}
+
+static int create_client_links(SESSION_HANDLE session, CLIENT_LINK* client_links, size_t link_count)
+{
+    int result = 0;
+    size_t i;
+    AMQP_VALUE source = messaging_create_source("ingress");
+    AMQP_VALUE target = messaging_create_target("localhost/ingress");
+
+    for (i = 0; i < link_count; i++)
+    {
+        char link_name[32];
+
+        (void)sprintf(link_name, "device-link-%lu", (unsigned long)i);
+
+        client_links[i].is_open = false;
+        client_links[i].is_message_outstanding = false;
+        client_links[i].link = link_create(session, link_name, role_sender, source, target);
+        if (client_links[i].link == NULL)
+        {
+            LogError("Cannot create client link %lu", (unsigned long)i);
+            result = __FAILURE__;
+            break;
+        }
+
+        if ((link_set_snd_settle_mode(client_links[i].link, sender_settle_mode_settled) != 0) ||
+            ((client_links[i].message_sender = messagesender_create(client_links[i].link, on_message_sender_state_changed, &client_links[i])) == NULL))
+        {
+            LogError("Cannot create message sender %lu", (unsigned long)i);
+            link_destroy(client_links[i].link);
+            result = __FAILURE__;
+            break;
+        }
+    }
+
+    amqpvalue_destroy(source);
+    amqpvalue_destroy(target);
+
+    if (result != 0)
+    {
+        while (i > 0)
+        {
+            i--;
+            messagesender_destroy(client_links[i].message_sender);
+            link_destroy(client_links[i].link);
+        }
+    }
+
+    return result;
+}
+
+static void destroy_client_links(CLIENT_LINK* client_links, size_t link_count)
+{
+    size_t i;
+
+    for (i = 0; i < link_count; i++)
+    {
+        messagesender_destroy(client_links[i].message_sender);
+        link_destroy(client_links[i].link);
+    }
+}
+
+static void destroy_server(void)
+{
+    size_t i;
+
+    for (i = 0; i < server.attached_link_count; i++)
+    {
+        messagereceiver_destroy(server.message_receivers[i]);
+        link_destroy(server.links[i]);
+    }
+
+    if (server.session != NULL)
+    {
+        session_destroy(server.session);
+    }
+
+    if (server.connection != NULL)
+    {
+        connection_destroy(server.connection);
+    }
+
+    if (server.io != NULL)
+    {
+        xio_destroy(server.io);
+    }
+}
+
+static void run_test(SOCKET_LISTENER_HANDLE socket_listener, TICK_COUNTER_HANDLE tick_counter, size_t link_count)
+{
+    SOCKETIO_CONFIG socketio_config = { "localhost", TEST_PORT, NULL };
+    XIO_HANDLE client_io;
+    CONNECTION_HANDLE client_connection;
+    SESSION_HANDLE client_session;
+    CLIENT_LINK* client_links;
+
+    if ((client_links = (CLIENT_LINK*)malloc(sizeof(CLIENT_LINK) * link_count)) == NULL)
+    {
+        LogError("Cannot allocate client links");
+    }
+    else if ((client_io = xio_create(socketio_get_interface_description(), &socketio_config)) == NULL)
+    {
+        LogError("Cannot create client IO");
+        free(client_links);
+    }
+    else if ((client_connection = connection_create(client_io, "localhost", "some", NULL, NULL)) == NULL)
+    {
+        LogError("Cannot create client connection");
+        xio_destroy(client_io);
+        free(client_links);
+    }
+    else if ((client_session = session_create(client_connection, NULL, NULL)) == NULL)
+    {
+        LogError("Cannot create client session");
+        connection_destroy(client_connection);
+        xio_destroy(client_io);
+        free(client_links);
+    }
+    else
+    {
+        size_t memory_before_links = get_memory_used();
+
+        if ((session_set_outgoing_window(client_session, 10000) != 0) ||
+            (create_client_links(client_session, client_links, link_count) != 0))
+        {
+            LogError("Cannot create client links");
+        }
+        else
+        {
+            size_t i;
+            size_t memory_after_links = get_memory_used();
+            size_t memory_after_attach;
+            tickcounter_ms_t start_ms = 0;
+            tickcounter_ms_t current_ms = 0;
+
+            print_memory_per_link("Client memory", memory_before_links, memory_after_links, link_count);
+
+            for (i = 0; i < link_count; i++)
+            {
+                if (messagesender_open(client_links[i].message_sender) != 0)
+                {
+                    LogError("Cannot open message sender %lu", (unsigned long)i);
+                    break;
+                }
+            }
+
+            (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+            current_ms = start_ms;
+            while ((i == link_count) &&
+                ((open_sender_count < link_count) || (server.attached_link_count < link_count)) &&
+                (current_ms - start_ms < ATTACH_TIMEOUT))
+            {
+                run_dowork(socket_listener, client_connection);
+                (void)tickcounter_get_current_ms(tick_counter, &current_ms);
+            }
+
+            memory_after_attach = get_memory_used();
+
+            if (open_sender_count < link_count)
+            {
+                LogError("Only %lu of %lu links attached", (unsigned long)open_sender_count, (unsigned long)link_count);
+            }
+            else
+            {
+                bool is_error = false;
+                size_t frames_sent = 0;
+
+                (void)printf("Attached %lu links in %lu ms\r\n", (unsigned long)link_count, (unsigned long)(current_ms - start_ms));
+                print_memory_per_link("Client and server memory after attach", memory_before_links, memory_after_attach, link_count);
+
+                (void)tickcounter_get_current_ms(tick_counter, &start_ms);
+                current_ms = start_ms;
+                while (!is_error && (current_ms - start_ms < TEST_RUNTIME))
+                {
+                    for (i = 0; i < link_count; i++)
+                    {
+                        if (!client_links[i].is_message_outstanding)
+                        {
+                            MESSAGE_HANDLE message = message_create();
+                            unsigned char hello[] = { 'H', 'e', 'l', 'l', 'o' };
+                            BINARY_DATA binary_data;
+
+                            if (message == NULL)
+                            {
+                                LogError("Error creating message");
+                                is_error = true;
+                                break;
+                            }
+
+                            binary_data.bytes = hello;
+                            binary_data.length = sizeof(hello);
+                            (void)message_add_body_amqp_data(message, binary_data);
+
+                            client_links[i].is_message_outstanding = true;
+                            if (messagesender_send_async(client_links[i].message_sender, message, on_message_send_complete, &client_links[i], 0) == NULL)
+                            {
+                                client_links[i].is_message_outstanding = false;
+                                LogError("Error sending message");
+                                is_error = true;
+                            }
+                            else
+                            {
+                                frames_sent++;
+                            }
+
+                            message_destroy(message);
+
+                            if (is_error)
+                            {
+                                break;
+                            }
+                        }
+                    }
+
+                    run_dowork(socket_listener, client_connection);
+                    (void)tickcounter_get_current_ms(tick_counter, &current_ms);
+                }
+
+                (void)printf("Sent %lu and received %lu transfers over %lu links in %.2f s: %.0f transfers/s, %.2f us per received transfer\r\n",
+                    (unsigned long)frames_sent,
+                    (unsigned long)total_messages_received,
+                    (unsigned long)link_count,
+                    ((double)current_ms - start_ms) / 1000,
+                    total_messages_received / (((double)current_ms - start_ms) / 1000),
+                    (total_messages_received == 0) ? 0.0 : (((double)current_ms - start_ms) * 1000) / total_messages_received);
+            }
+
+            destroy_client_links(client_links, link_count);
+        }
+
+        session_destroy(client_session);
+        connection_destroy(client_connection);
+        xio_destroy(client_io);
+        free(client_links);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int result;
+    size_t link_count = DEFAULT_LINK_COUNT;
+
+    if (argc > 1)
+    {
+        link_count = (size_t)strtoul(argv[1], NULL, 10);
+    }
+
+    if (link_count == 0)
+    {
+        LogError("Usage: %s [link_count]", argv[0]);
+        result = -1;
+    }
+    else if (gballoc_init() != 0)
+    {
+        LogError("gballoc_init failed");
+        result = -1;
+    }
+    else
+    {
+        if (platform_init() != 0)
+        {
+            LogError("platform_init failed");
+            result = -1;
+        }
+        else
+        {
+            SOCKET_LISTENER_HANDLE socket_listener;
+            TICK_COUNTER_HANDLE tick_counter;
+
+            server.links = (LINK_HANDLE*)malloc(sizeof(LINK_HANDLE) * link_count);
+            server.message_receivers = (MESSAGE_RECEIVER_HANDLE*)malloc(sizeof(MESSAGE_RECEIVER_HANDLE) * link_count);
+            server.max_link_count = link_count;
+
+            if ((server.links == NULL) || (server.message_receivers == NULL))
+            {
+                LogError("Cannot allocate server link arrays");
+                result = -1;
+            }
+            else if ((tick_counter = tickcounter_create()) == NULL)
+            {
+                LogError("Cannot create tick counter");
+                result = -1;
+            }
+            else
+            {
+                if ((socket_listener = socketlistener_create(TEST_PORT)) == NULL)
+                {
+                    LogError("Cannot create socket listener");
+                    result = -1;
+                }
+                else
+                {
+                    if (socketlistener_start(socket_listener, on_socket_accepted, &server) != 0)
+                    {
+                        LogError("socketlistener_start failed");
+                        result = -1;
+                    }
+                    else
+                    {
+                        run_test(socket_listener, tick_counter, link_count);
+                        destroy_server();
+
+                        (void)socketlistener_stop(socket_listener);
+                        result = 0;
+                    }
+
+                    socketlistener_destroy(socket_listener);
+                }
+
+                tickcounter_destroy(tick_counter);
+            }
+
+            free(server.links);
+            free(server.message_receivers);
+
+            platform_deinit();
+        }
+
+        gballoc_deinit();
+    }
+
+    return result;
+}
@@ -11,6 +11,8 @@
 #include "testrunnerswitcher.h"
 #include "umock_c.h"
 #include "umocktypes_charptr.h"
+#include "umocktypes_bool.h"
+#include "umocktypes_stdint.h"
 
 static void* my_gballoc_malloc(size_t size)
 {
@@ -47,8 +49,16 @@ static void my_gballoc_free(void* ptr)
 #define TEST_CONTEXT                    (void*)0x4444
 #define TEST_ATTACH_PERFORMATIVE        (AMQP_VALUE)0x5000
 #define TEST_BEGIN_PERFORMATIVE            (AMQP_VALUE)0x5001
+#define TEST_DETACH_PERFORMATIVE        (AMQP_VALUE)0x5002
+#define TEST_FLOW_PERFORMATIVE          (AMQP_VALUE)0x5003
+#define TEST_END_PERFORMATIVE           (AMQP_VALUE)0x5004
+#define TEST_ERROR_HANDLE               (ERROR_HANDLE)0x4250
+#define TEST_END_HANDLE                 (END_HANDLE)0x4251
 
 static TRANSFER_HANDLE test_transfer_handle = (TRANSFER_HANDLE)0x6001;
+static ATTACH_HANDLE test_attach_handle = (ATTACH_HANDLE)0x6002;
+static DETACH_HANDLE test_detach_handle = (DETACH_HANDLE)0x6003;
+static FLOW_HANDLE test_flow_handle = (FLOW_HANDLE)0x6004;
 static ON_ENDPOINT_FRAME_RECEIVED saved_frame_received_callback;
 static ON_CONNECTION_STATE_CHANGED saved_connection_state_changed_callback;
 static void* saved_callback_context;
@@ -107,6 +117,10 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     result = umocktypes_charptr_register_types();
     ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_bool_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
+    result = umocktypes_stdint_register_types();
+    ASSERT_ARE_EQUAL(int, 0, result);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
@@ -129,6 +143,17 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(SESSION_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(CONNECTION_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ENDPOINT_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(AMQP_VALUE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ATTACH_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(DETACH_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(FLOW_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ERROR_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(END_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(SESSION_STATE, int);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_SEND_COMPLETE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(PAYLOAD*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_ENDPOINT_FRAME_RECEIVED, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(ON_CONNECTION_STATE_CHANGED, void*);
 }
 
 TEST_SUITE_CLEANUP(suite_cleanup)
@@ -918,4 +943,242 @@ TEST_FUNCTION(when_if_sending_the_frame_to_the_connection_fails_the_next_outgoin
 }
 #endif
 
+/* Incoming frame dispatch */
+
+static void setup_attach_frame(const char* name, handle input_handle)
+{
+    STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_ATTACH_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_begin_type_by_descriptor(TEST_DESCRIPTOR_AMQP_VALUE));
+    STRICT_EXPECTED_CALL(is_attach_type_by_descriptor(TEST_DESCRIPTOR_AMQP_VALUE))
+        .SetReturn(true);
+    STRICT_EXPECTED_CALL(amqpvalue_get_attach(TEST_ATTACH_PERFORMATIVE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &test_attach_handle, sizeof(test_attach_handle));
+    STRICT_EXPECTED_CALL(attach_get_name(test_attach_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &name, sizeof(name));
+    STRICT_EXPECTED_CALL(attach_get_role(test_attach_handle, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(attach_get_source(test_attach_handle, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(attach_get_target(test_attach_handle, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(attach_get_handle(test_attach_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &input_handle, sizeof(input_handle));
+}
+
+static void setup_detach_frame(handle remote_handle)
+{
+    STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_DETACH_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_begin_type_by_descriptor(TEST_DESCRIPTOR_AMQP_VALUE));
+    STRICT_EXPECTED_CALL(is_attach_type_by_descriptor(TEST_DESCRIPTOR_AMQP_VALUE));
+    STRICT_EXPECTED_CALL(is_detach_type_by_descriptor(TEST_DESCRIPTOR_AMQP_VALUE))
+        .SetReturn(true);
+    STRICT_EXPECTED_CALL(amqpvalue_get_detach(TEST_DETACH_PERFORMATIVE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &test_detach_handle, sizeof(test_detach_handle));
+    STRICT_EXPECTED_CALL(detach_get_handle(test_detach_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &remote_handle, sizeof(remote_handle));
+    STRICT_EXPECTED_CALL(detach_destroy(test_detach_handle));
+}
+
+/* Tests_SRS_SESSION_01_064: [Incoming frames carrying a handle shall be dispatched to their link endpoint by indexing a table keyed by input handle.] */
+/* Tests_SRS_SESSION_01_065: [When an ATTACH frame assigns an input handle to a link endpoint, the table entry for that handle shall be set to the endpoint.] */
+TEST_FUNCTION(a_DETACH_frame_is_dispatched_to_the_link_endpoint_attached_with_that_input_handle)
+{
+    // arrange
+    SESSION_HANDLE session = session_create(TEST_CONNECTION_HANDLE, NULL, NULL);
+    (void)session_begin(session);
+    LINK_ENDPOINT_HANDLE link_endpoint0 = session_create_link_endpoint(session, "1");
+    LINK_ENDPOINT_HANDLE link_endpoint1 = session_create_link_endpoint(session, "2");
+    (void)session_start_link_endpoint(link_endpoint0, test_frame_received_callback, NULL, test_on_flow_on, (void*)0x1000);
+    (void)session_start_link_endpoint(link_endpoint1, test_frame_received_callback, NULL, test_on_flow_on, (void*)0x1001);
+    umock_c_reset_all_calls();
+    setup_attach_frame("1", 3);
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1000, TEST_ATTACH_PERFORMATIVE, 0, NULL));
+    STRICT_EXPECTED_CALL(attach_destroy(test_attach_handle));
+    setup_attach_frame("2", 100);
+    STRICT_EXPECTED_CALL(gballoc_realloc(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1001, TEST_ATTACH_PERFORMATIVE, 0, NULL));
+    STRICT_EXPECTED_CALL(attach_destroy(test_attach_handle));
+    saved_frame_received_callback(saved_callback_context, TEST_ATTACH_PERFORMATIVE, 0, NULL);
+    saved_frame_received_callback(saved_callback_context, TEST_ATTACH_PERFORMATIVE, 0, NULL);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    umock_c_reset_all_calls();
+
+    setup_detach_frame(100);
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1001, TEST_DETACH_PERFORMATIVE, 0, NULL));
+    setup_detach_frame(3);
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1000, TEST_DETACH_PERFORMATIVE, 0, NULL));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_DETACH_PERFORMATIVE, 0, NULL);
+    saved_frame_received_callback(saved_callback_context, TEST_DETACH_PERFORMATIVE, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    session_destroy_link_endpoint(link_endpoint0);
+    session_destroy_link_endpoint(link_endpoint1);
+    session_destroy(session);
+}
+
+/* Tests_SRS_SESSION_01_066: [If the handle is not in the table, the link endpoints shall be searched linearly.] */
+/* Tests_SRS_SESSION_01_067: [If growing the table fails, the endpoint shall still be found by the linear search.] */
+TEST_FUNCTION(when_growing_the_input_handle_table_fails_a_DETACH_frame_is_still_dispatched_to_the_link_endpoint)
+{
+    // arrange
+    SESSION_HANDLE session = session_create(TEST_CONNECTION_HANDLE, NULL, NULL);
+    (void)session_begin(session);
+    LINK_ENDPOINT_HANDLE link_endpoint = session_create_link_endpoint(session, "1");
+    (void)session_start_link_endpoint(link_endpoint, test_frame_received_callback, NULL, test_on_flow_on, (void*)0x1000);
+    umock_c_reset_all_calls();
+    setup_attach_frame("1", 3);
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1000, TEST_ATTACH_PERFORMATIVE, 0, NULL));
+    STRICT_EXPECTED_CALL(attach_destroy(test_attach_handle));
+    saved_frame_received_callback(saved_callback_context, TEST_ATTACH_PERFORMATIVE, 0, NULL);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    umock_c_reset_all_calls();
+
+    setup_detach_frame(3);
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1000, TEST_DETACH_PERFORMATIVE, 0, NULL));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_DETACH_PERFORMATIVE, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    session_destroy_link_endpoint(link_endpoint);
+    session_destroy(session);
+}
+
+/* Tests_SRS_SESSION_01_064: [Incoming frames carrying a handle shall be dispatched to their link endpoint by indexing a table keyed by input handle.] */
+TEST_FUNCTION(a_DETACH_frame_for_the_handle_of_a_destroyed_link_endpoint_is_not_dispatched)
+{
+    // arrange
+    SESSION_HANDLE session = session_create(TEST_CONNECTION_HANDLE, NULL, NULL);
+    (void)session_begin(session);
+    LINK_ENDPOINT_HANDLE link_endpoint0 = session_create_link_endpoint(session, "1");
+    LINK_ENDPOINT_HANDLE link_endpoint1 = session_create_link_endpoint(session, "2");
+    (void)session_start_link_endpoint(link_endpoint0, test_frame_received_callback, NULL, test_on_flow_on, (void*)0x1000);
+    (void)session_start_link_endpoint(link_endpoint1, test_frame_received_callback, NULL, test_on_flow_on, (void*)0x1001);
+    umock_c_reset_all_calls();
+    setup_attach_frame("1", 3);
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1000, TEST_ATTACH_PERFORMATIVE, 0, NULL));
+    STRICT_EXPECTED_CALL(attach_destroy(test_attach_handle));
+    setup_attach_frame("2", 4);
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1001, TEST_ATTACH_PERFORMATIVE, 0, NULL));
+    STRICT_EXPECTED_CALL(attach_destroy(test_attach_handle));
+    saved_frame_received_callback(saved_callback_context, TEST_ATTACH_PERFORMATIVE, 0, NULL);
+    saved_frame_received_callback(saved_callback_context, TEST_ATTACH_PERFORMATIVE, 0, NULL);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    session_destroy_link_endpoint(link_endpoint0);
+    umock_c_reset_all_calls();
+
+    setup_detach_frame(4);
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1001, TEST_DETACH_PERFORMATIVE, 0, NULL));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_DETACH_PERFORMATIVE, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    session_destroy_link_endpoint(link_endpoint1);
+    session_destroy(session);
+}
+
+static void setup_flow_frame(void)
+{
+    STRICT_EXPECTED_CALL(amqpvalue_get_inplace_descriptor(TEST_FLOW_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(is_begin_type_by_descriptor(TEST_DESCRIPTOR_AMQP_VALUE));
+    STRICT_EXPECTED_CALL(is_attach_type_by_descriptor(TEST_DESCRIPTOR_AMQP_VALUE));
+    STRICT_EXPECTED_CALL(is_detach_type_by_descriptor(TEST_DESCRIPTOR_AMQP_VALUE));
+    STRICT_EXPECTED_CALL(is_flow_type_by_descriptor(TEST_DESCRIPTOR_AMQP_VALUE))
+        .SetReturn(true);
+    STRICT_EXPECTED_CALL(amqpvalue_get_flow(TEST_FLOW_PERFORMATIVE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &test_flow_handle, sizeof(test_flow_handle));
+}
+
+/* Tests_SRS_SESSION_01_064: [Incoming frames carrying a handle shall be dispatched to their link endpoint by indexing a table keyed by input handle.] */
+TEST_FUNCTION(a_FLOW_frame_decoded_with_flow_get_fields_is_dispatched_and_turns_the_flow_on)
+{
+    // arrange
+    SESSION_HANDLE session = session_create(TEST_CONNECTION_HANDLE, NULL, NULL);
+    LINK_ENDPOINT_HANDLE link_endpoint;
+    FLOW_FIELDS flow_fields;
+    (void)session_begin(session);
+    link_endpoint = session_create_link_endpoint(session, "1");
+    (void)session_start_link_endpoint(link_endpoint, test_frame_received_callback, NULL, test_on_flow_on, (void*)0x1000);
+    umock_c_reset_all_calls();
+    setup_attach_frame("1", 3);
+    saved_frame_received_callback(saved_callback_context, TEST_ATTACH_PERFORMATIVE, 0, NULL);
+    umock_c_reset_all_calls();
+
+    (void)memset(&flow_fields, 0, sizeof(flow_fields));
+    flow_fields.next_outgoing_id_value = 10;
+    flow_fields.next_outgoing_id_is_set = true;
+    flow_fields.incoming_window_value = 100;
+    flow_fields.incoming_window_is_set = true;
+    flow_fields.handle_value = 3;
+    flow_fields.handle_is_set = true;
+    setup_flow_frame();
+    STRICT_EXPECTED_CALL(flow_get_fields(test_flow_handle, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer(2, &flow_fields, sizeof(flow_fields));
+    STRICT_EXPECTED_CALL(flow_destroy(test_flow_handle));
+    STRICT_EXPECTED_CALL(test_frame_received_callback((void*)0x1000, TEST_FLOW_PERFORMATIVE, 0, NULL));
+    STRICT_EXPECTED_CALL(test_on_flow_on((void*)0x1000));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_FLOW_PERFORMATIVE, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    session_destroy_link_endpoint(link_endpoint);
+    session_destroy(session);
+}
+
+TEST_FUNCTION(when_flow_get_fields_fails_the_session_is_ended_with_a_decode_error)
+{
+    // arrange
+    SESSION_HANDLE session = session_create(TEST_CONNECTION_HANDLE, NULL, NULL);
+    LINK_ENDPOINT_HANDLE link_endpoint;
+    (void)session_begin(session);
+    link_endpoint = session_create_link_endpoint(session, "1");
+    (void)session_start_link_endpoint(link_endpoint, test_frame_received_callback, test_on_session_state_changed, test_on_flow_on, (void*)0x1000);
+    umock_c_reset_all_calls();
+
+    setup_flow_frame();
+    STRICT_EXPECTED_CALL(flow_get_fields(test_flow_handle, IGNORED_PTR_ARG))
+        .SetReturn(1);
+    STRICT_EXPECTED_CALL(flow_destroy(test_flow_handle));
+    STRICT_EXPECTED_CALL(error_create("amqp:decode-error"))
+        .SetReturn(TEST_ERROR_HANDLE);
+    STRICT_EXPECTED_CALL(error_set_description(TEST_ERROR_HANDLE, "Cannot decode FLOW frame"));
+    STRICT_EXPECTED_CALL(end_create())
+        .SetReturn(TEST_END_HANDLE);
+    STRICT_EXPECTED_CALL(end_set_error(TEST_END_HANDLE, TEST_ERROR_HANDLE));
+    STRICT_EXPECTED_CALL(amqpvalue_create_end(TEST_END_HANDLE))
+        .SetReturn(TEST_END_PERFORMATIVE);
+    STRICT_EXPECTED_CALL(connection_encode_frame(TEST_ENDPOINT_HANDLE, TEST_END_PERFORMATIVE, NULL, 0, NULL, NULL));
+    STRICT_EXPECTED_CALL(amqpvalue_destroy(TEST_END_PERFORMATIVE));
+    STRICT_EXPECTED_CALL(end_destroy(TEST_END_HANDLE));
+    STRICT_EXPECTED_CALL(test_on_session_state_changed((void*)0x1000, SESSION_STATE_DISCARDING, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(error_destroy(TEST_ERROR_HANDLE));
+
+    // act
+    saved_frame_received_callback(saved_callback_context, TEST_FLOW_PERFORMATIVE, 0, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    session_destroy_link_endpoint(link_endpoint);
+    session_destroy(session);
+}
+
 END_TEST_SUITE(session_ut)
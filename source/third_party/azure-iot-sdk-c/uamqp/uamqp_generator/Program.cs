@@ -113,6 +113,14 @@ namespace amqplib_generator
             return result;
         }
 
+        /* performatives decoded on every received frame also get a <type>_get_fields function that decodes all fields in one pass */
+        private static readonly string[] fields_decoder_types = { "flow", "transfer", "disposition" };
+
+        public static bool HasFieldsDecoder(type type)
+        {
+            return fields_decoder_types.Contains(type.name);
+        }
+
         public static descriptor GetDescriptor(type type)
         {
             descriptor result;